@@ -667,6 +667,11 @@ void ExportCommand::startCommand()
       }
     }
     Frame::TagVersion tagMask = getTagMaskParameter(3);
+    if (path == QLatin1String("-")) {
+      // The exported text is written to standard output after the output
+      // which is already buffered.
+      cli()->flushStandardOutput();
+    }
     if (!cli()->app()->exportTags(tagMask, path, fmtIdx)) {
       setError(tr("Error"));
     }
@@ -1061,6 +1066,42 @@ void RemoveCommand::startCommand()
 }
 
 
+StatsCommand::StatsCommand(Kid3Cli* processor) :
+  CliCommand(processor, QLatin1String("stats"), tr("Operation statistics"),
+             QLatin1String("[S] [P]\n"
+             "S = \"on\" | \"off\" | \"reset\" | \"trace\""))
+{
+}
+
+void StatsCommand::startCommand()
+{
+  Kid3Application* app = cli()->app();
+  QString param;
+  if (args().size() > 1) {
+    param = args().at(1);
+  }
+  if (param == QLatin1String("on")) {
+    app->setStatisticsEnabled(true);
+  } else if (param == QLatin1String("off")) {
+    app->setStatisticsEnabled(false);
+  } else if (param == QLatin1String("reset")) {
+    app->resetStatistics();
+  } else if (param == QLatin1String("trace")) {
+    if (args().size() > 2) {
+      if (!app->writeStatisticsTrace(args().at(2))) {
+        setError(tr("Error"));
+      }
+    } else {
+      showUsage();
+    }
+  } else if (param.isEmpty()) {
+    cli()->writeLine(app->getStatisticsText());
+  } else {
+    showUsage();
+  }
+}
+
+
 #if defined HAVE_PHONON || QT_VERSION >= 0x050000
 PlayCommand::PlayCommand(Kid3Cli* processor) :
   CliCommand(processor, QLatin1String("play"), tr("Play"),
@@ -597,6 +597,17 @@ protected:
   virtual void startCommand();
 };
 
+/** Show operation statistics. */
+class StatsCommand : public CliCommand {
+  Q_OBJECT
+public:
+  /** Constructor. */
+  explicit StatsCommand(Kid3Cli* processor);
+
+protected:
+  virtual void startCommand();
+};
+
 #if defined HAVE_PHONON || QT_VERSION >= 0x050000
 /** Play audio file. */
 class PlayCommand : public CliCommand {
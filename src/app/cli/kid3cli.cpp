@@ -32,6 +32,7 @@
 #include <QBrush>
 #include "kid3application.h"
 #include "fileproxymodel.h"
+#include "fileproxymodeliterator.h"
 #include "frametablemodel.h"
 #include "taggedfileselection.h"
 #include "clicommand.h"
@@ -275,6 +276,7 @@ Kid3Cli::Kid3Cli(Kid3Application* app,
          << new CopyCommand(this)
          << new PasteCommand(this)
          << new RemoveCommand(this)
+         << new StatsCommand(this)
 #if defined HAVE_PHONON || QT_VERSION >= 0x050000
          << new PlayCommand(this)
 #endif
@@ -285,6 +287,9 @@ Kid3Cli::Kid3Cli(Kid3Application* app,
           this, SLOT(updateSelection()));
   connect(m_app, SIGNAL(selectedFilesChanged(QItemSelection,QItemSelection)),
           this, SLOT(updateSelection()));
+  // No file list has to be updated while the directories are traversed,
+  // so they can be scanned in parallel.
+  m_app->getFileProxyModelIterator()->setDirectoryScannerEnabled(true);
 #ifdef HAVE_READLINE
   m_completer = new Kid3CliCompleter(m_cmds);
   m_completer->install();
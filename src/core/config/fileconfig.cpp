@@ -83,10 +83,14 @@ FileConfig::FileConfig() :
   m_formatFromFilenameItem(0),
   m_defaultCoverFileName(QLatin1String("folder.jpg")),
   m_textEncoding(QLatin1String("System")),
+  m_concurrentWrites(1),
+  m_maxOpenFiles(0),
   m_preserveTime(false),
   m_markChanges(true),
   m_loadLastOpenedFile(true),
-  m_showHiddenFiles(false)
+  m_showHiddenFiles(false),
+  m_useTagCache(true),
+  m_useTagSearchIndex(true)
 {
 }
 
@@ -114,6 +118,10 @@ void FileConfig::writeToConfig(ISettings* config) const
   config->setValue(QLatin1String("FormatFromFilenameItems"), QVariant(m_formatFromFilenameItems));
   config->setValue(QLatin1String("FormatFromFilenameText"), QVariant(m_formatFromFilenameText));
   config->setValue(QLatin1String("PreserveTime"), QVariant(m_preserveTime));
+  config->setValue(QLatin1String("ConcurrentWrites"), QVariant(m_concurrentWrites));
+  config->setValue(QLatin1String("UseTagCache"), QVariant(m_useTagCache));
+  config->setValue(QLatin1String("UseTagSearchIndex"), QVariant(m_useTagSearchIndex));
+  config->setValue(QLatin1String("MaxOpenFiles"), QVariant(m_maxOpenFiles));
   config->setValue(QLatin1String("MarkChanges"), QVariant(m_markChanges));
   config->setValue(QLatin1String("LoadLastOpenedFile"), QVariant(m_loadLastOpenedFile));
   config->setValue(QLatin1String("TextEncoding"), QVariant(m_textEncoding));
@@ -148,6 +156,10 @@ void FileConfig::readFromConfig(ISettings* config)
       config->value(QLatin1String("FormatFromFilenameItems"),
                     m_formatFromFilenameItems).toStringList();
   m_preserveTime = config->value(QLatin1String("PreserveTime"), m_preserveTime).toBool();
+  m_concurrentWrites = config->value(QLatin1String("ConcurrentWrites"), m_concurrentWrites).toInt();
+  m_useTagCache = config->value(QLatin1String("UseTagCache"), m_useTagCache).toBool();
+  m_useTagSearchIndex = config->value(QLatin1String("UseTagSearchIndex"), m_useTagSearchIndex).toBool();
+  m_maxOpenFiles = config->value(QLatin1String("MaxOpenFiles"), m_maxOpenFiles).toInt();
   m_markChanges = config->value(QLatin1String("MarkChanges"), m_markChanges).toBool();
 
   m_formatText =
@@ -321,3 +333,41 @@ void FileConfig::setLoadLastOpenedFile(bool loadLastOpenedFile)
     emit loadLastOpenedFileChanged(m_loadLastOpenedFile);
   }
 }
+
+void FileConfig::setConcurrentWrites(int concurrentWrites)
+{
+  if (concurrentWrites < 1) {
+    concurrentWrites = 1;
+  }
+  if (m_concurrentWrites != concurrentWrites) {
+    m_concurrentWrites = concurrentWrites;
+    emit concurrentWritesChanged(m_concurrentWrites);
+  }
+}
+
+void FileConfig::setUseTagCache(bool useTagCache)
+{
+  if (m_useTagCache != useTagCache) {
+    m_useTagCache = useTagCache;
+    emit useTagCacheChanged(m_useTagCache);
+  }
+}
+
+void FileConfig::setUseTagSearchIndex(bool useTagSearchIndex)
+{
+  if (m_useTagSearchIndex != useTagSearchIndex) {
+    m_useTagSearchIndex = useTagSearchIndex;
+    emit useTagSearchIndexChanged(m_useTagSearchIndex);
+  }
+}
+
+void FileConfig::setMaxOpenFiles(int maxOpenFiles)
+{
+  if (maxOpenFiles < 0) {
+    maxOpenFiles = 0;
+  }
+  if (m_maxOpenFiles != maxOpenFiles) {
+    m_maxOpenFiles = maxOpenFiles;
+    emit maxOpenFilesChanged(m_maxOpenFiles);
+  }
+}
@@ -70,6 +70,14 @@ class KID3_CORE_EXPORT FileConfig : public StoredConfig<FileConfig> {
   Q_PROPERTY(bool markChanges READ markChanges WRITE setMarkChanges NOTIFY markChangesChanged)
   /** true to open last opened file on startup */
   Q_PROPERTY(bool loadLastOpenedFile READ loadLastOpenedFile WRITE setLoadLastOpenedFile NOTIFY loadLastOpenedFileChanged)
+  /** maximum number of files written concurrently when saving */
+  Q_PROPERTY(int concurrentWrites READ concurrentWrites WRITE setConcurrentWrites NOTIFY concurrentWritesChanged)
+  /** true to cache tags of unchanged files on disk */
+  Q_PROPERTY(bool useTagCache READ useTagCache WRITE setUseTagCache NOTIFY useTagCacheChanged)
+  /** true to index file names and tags of read files for searching */
+  Q_PROPERTY(bool useTagSearchIndex READ useTagSearchIndex WRITE setUseTagSearchIndex NOTIFY useTagSearchIndexChanged)
+  /** maximum number of open file handles, 0 for automatic */
+  Q_PROPERTY(int maxOpenFiles READ maxOpenFiles WRITE setMaxOpenFiles NOTIFY maxOpenFilesChanged)
 
 public:
   /**
@@ -200,6 +208,30 @@ public:
   /** Set if the last opened file is loaded on startup. */
   void setLoadLastOpenedFile(bool loadLastOpenedFile);
 
+  /** Get maximum number of files written concurrently, 1 if sequential. */
+  int concurrentWrites() const { return m_concurrentWrites; }
+
+  /** Set maximum number of files written concurrently. */
+  void setConcurrentWrites(int concurrentWrites);
+
+  /** Check if tags of unchanged files are cached on disk. */
+  bool useTagCache() const { return m_useTagCache; }
+
+  /** Set if tags of unchanged files are cached on disk. */
+  void setUseTagCache(bool useTagCache);
+
+  /** Check if file names and tags of read files are indexed for searching. */
+  bool useTagSearchIndex() const { return m_useTagSearchIndex; }
+
+  /** Set if file names and tags of read files are indexed for searching. */
+  void setUseTagSearchIndex(bool useTagSearchIndex);
+
+  /** Get maximum number of open file handles, 0 if automatic. */
+  int maxOpenFiles() const { return m_maxOpenFiles; }
+
+  /** Set maximum number of open file handles, 0 for automatic. */
+  void setMaxOpenFiles(int maxOpenFiles);
+
 signals:
   /** Emitted when @a nameFilter changed. */
   void nameFilterChanged(const QString& nameFilter);
@@ -249,6 +281,18 @@ signals:
   /** Emitted when @a loadLastOpenedFile changed. */
   void loadLastOpenedFileChanged(bool loadLastOpenedFile);
 
+  /** Emitted when @a concurrentWrites changed. */
+  void concurrentWritesChanged(int concurrentWrites);
+
+  /** Emitted when @a useTagCache changed. */
+  void useTagCacheChanged(bool useTagCache);
+
+  /** Emitted when @a useTagSearchIndex changed. */
+  void useTagSearchIndexChanged(bool useTagSearchIndex);
+
+  /** Emitted when @a maxOpenFiles changed. */
+  void maxOpenFilesChanged(int maxOpenFiles);
+
 private:
   friend FileConfig& StoredConfig<FileConfig>::instance();
 
@@ -264,10 +308,14 @@ private:
   QString m_defaultCoverFileName;
   QString m_lastOpenedFile;
   QString m_textEncoding;
+  int m_concurrentWrites;
+  int m_maxOpenFiles;
   bool m_preserveTime;
   bool m_markChanges;
   bool m_loadLastOpenedFile;
   bool m_showHiddenFiles;
+  bool m_useTagCache;
+  bool m_useTagSearchIndex;
 
   /** Index in configuration storage */
   static int s_index;
@@ -46,7 +46,9 @@ int NetworkConfig::s_index = -1;
 NetworkConfig::NetworkConfig() :
   StoredConfig<NetworkConfig>(QLatin1String("Network")),
   m_useProxy(false),
-  m_useProxyAuthentication(false)
+  m_useProxyAuthentication(false),
+  m_httpCacheSize(50),
+  m_httpCacheTimeToLive(24)
 {
 }
 
@@ -69,6 +71,8 @@ void NetworkConfig::writeToConfig(ISettings* config) const
   config->setValue(QLatin1String("ProxyUserName"), QVariant(m_proxyUserName));
   config->setValue(QLatin1String("ProxyPassword"), QVariant(m_proxyPassword));
   config->setValue(QLatin1String("Browser"), QVariant(m_browser));
+  config->setValue(QLatin1String("HttpCacheSize"), QVariant(m_httpCacheSize));
+  config->setValue(QLatin1String("HttpCacheTimeToLive"), QVariant(m_httpCacheTimeToLive));
   config->endGroup();
 }
 
@@ -85,6 +89,8 @@ void NetworkConfig::readFromConfig(ISettings* config)
   m_useProxyAuthentication = config->value(QLatin1String("UseProxyAuthentication"), m_useProxyAuthentication).toBool();
   m_proxyUserName = config->value(QLatin1String("ProxyUserName"), m_proxyUserName).toString();
   m_proxyPassword = config->value(QLatin1String("ProxyPassword"), m_proxyPassword).toString();
+  m_httpCacheSize = config->value(QLatin1String("HttpCacheSize"), m_httpCacheSize).toInt();
+  m_httpCacheTimeToLive = config->value(QLatin1String("HttpCacheTimeToLive"), m_httpCacheTimeToLive).toInt();
   m_browser = config->value(QLatin1String("Browser"), QString()).toString();
   if (m_browser.isEmpty()) {
     setDefaultBrowser();
@@ -151,3 +157,25 @@ void NetworkConfig::setUseProxyAuthentication(bool useProxyAuthentication)
     emit useProxyAuthenticationChanged(m_useProxyAuthentication);
   }
 }
+
+void NetworkConfig::setHttpCacheSize(int httpCacheSize)
+{
+  if (httpCacheSize < 0) {
+    httpCacheSize = 0;
+  }
+  if (m_httpCacheSize != httpCacheSize) {
+    m_httpCacheSize = httpCacheSize;
+    emit httpCacheSizeChanged(m_httpCacheSize);
+  }
+}
+
+void NetworkConfig::setHttpCacheTimeToLive(int httpCacheTimeToLive)
+{
+  if (httpCacheTimeToLive < 0) {
+    httpCacheTimeToLive = 0;
+  }
+  if (m_httpCacheTimeToLive != httpCacheTimeToLive) {
+    m_httpCacheTimeToLive = httpCacheTimeToLive;
+    emit httpCacheTimeToLiveChanged(m_httpCacheTimeToLive);
+  }
+}
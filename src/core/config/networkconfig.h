@@ -47,6 +47,10 @@ class KID3_CORE_EXPORT NetworkConfig : public StoredConfig<NetworkConfig> {
   Q_PROPERTY(bool useProxy READ useProxy WRITE setUseProxy NOTIFY useProxyChanged)
   /** true to use proxy authentication */
   Q_PROPERTY(bool useProxyAuthentication READ useProxyAuthentication WRITE setUseProxyAuthentication NOTIFY useProxyAuthenticationChanged)
+  /** maximum size of HTTP response cache in MiB, 0 to disable */
+  Q_PROPERTY(int httpCacheSize READ httpCacheSize WRITE setHttpCacheSize NOTIFY httpCacheSizeChanged)
+  /** hours for which cached HTTP responses are used without revalidation */
+  Q_PROPERTY(int httpCacheTimeToLive READ httpCacheTimeToLive WRITE setHttpCacheTimeToLive NOTIFY httpCacheTimeToLiveChanged)
 
 public:
   /**
@@ -109,6 +113,18 @@ public:
   /** Set if proxy authentication is used. */
   void setUseProxyAuthentication(bool useProxyAuthentication);
 
+  /** Get maximum size of HTTP response cache in MiB, 0 if disabled. */
+  int httpCacheSize() const { return m_httpCacheSize; }
+
+  /** Set maximum size of HTTP response cache in MiB, 0 to disable. */
+  void setHttpCacheSize(int httpCacheSize);
+
+  /** Get hours for which cached HTTP responses are used. */
+  int httpCacheTimeToLive() const { return m_httpCacheTimeToLive; }
+
+  /** Set hours for which cached HTTP responses are used. */
+  void setHttpCacheTimeToLive(int httpCacheTimeToLive);
+
   /**
    * Set default web browser.
    */
@@ -133,6 +149,12 @@ signals:
   /** Emitted when @a useProxyAuthentication changed. */
   void useProxyAuthenticationChanged(bool useProxyAuthentication);
 
+  /** Emitted when @a httpCacheSize changed. */
+  void httpCacheSizeChanged(int httpCacheSize);
+
+  /** Emitted when @a httpCacheTimeToLive changed. */
+  void httpCacheTimeToLiveChanged(int httpCacheTimeToLive);
+
 private:
   friend NetworkConfig& StoredConfig<NetworkConfig>::instance();
 
@@ -142,6 +164,8 @@ private:
   QString m_browser;
   bool m_useProxy;
   bool m_useProxyAuthentication;
+  int m_httpCacheSize;
+  int m_httpCacheTimeToLive;
 
   /** Index in configuration storage */
   static int s_index;
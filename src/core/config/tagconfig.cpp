@@ -246,13 +246,15 @@ TagConfig::TagConfig() :
   m_trackNumberDigits(1),
   m_taggedFileFeatures(0),
   m_maximumPictureSize(131072),
+  m_tagPaddingSize(4096),
   m_markOversizedPictures(false),
   m_markStandardViolations(true),
   m_onlyCustomGenres(false),
   m_markTruncations(true),
   m_enableTotalNumberOfTracks(false),
   m_genreNotNumeric(true),
-  m_lowercaseId3RiffChunk(false)
+  m_lowercaseId3RiffChunk(false),
+  m_growTagPaddingOnce(false)
 {
   m_disabledPlugins << QLatin1String("Id3libMetadata")
                     << QLatin1String("Mp4v2Metadata");
@@ -281,6 +283,8 @@ void TagConfig::writeToConfig(ISettings* config) const
   config->setValue(QLatin1String("EnableTotalNumberOfTracks"), QVariant(m_enableTotalNumberOfTracks));
   config->setValue(QLatin1String("GenreNotNumeric"), QVariant(m_genreNotNumeric));
   config->setValue(QLatin1String("LowercaseId3RiffChunk"), QVariant(m_lowercaseId3RiffChunk));
+  config->setValue(QLatin1String("TagPaddingSize"), QVariant(m_tagPaddingSize));
+  config->setValue(QLatin1String("GrowTagPaddingOnce"), QVariant(m_growTagPaddingOnce));
   config->setValue(QLatin1String("CommentName"), QVariant(m_commentName));
   config->setValue(QLatin1String("PictureNameItem"), QVariant(m_pictureNameItem));
   config->setValue(QLatin1String("RiffTrackName"), QVariant(m_riffTrackName));
@@ -319,6 +323,8 @@ void TagConfig::readFromConfig(ISettings* config)
   m_enableTotalNumberOfTracks = config->value(QLatin1String("EnableTotalNumberOfTracks"), m_enableTotalNumberOfTracks).toBool();
   m_genreNotNumeric = config->value(QLatin1String("GenreNotNumeric"), m_genreNotNumeric).toBool();
   m_lowercaseId3RiffChunk = config->value(QLatin1String("LowercaseId3RiffChunk"), m_lowercaseId3RiffChunk).toBool();
+  m_tagPaddingSize = config->value(QLatin1String("TagPaddingSize"), m_tagPaddingSize).toInt();
+  m_growTagPaddingOnce = config->value(QLatin1String("GrowTagPaddingOnce"), m_growTagPaddingOnce).toBool();
   m_commentName = config->value(QLatin1String("CommentName"), QString::fromLatin1(defaultCommentName)).toString();
   m_pictureNameItem = config->value(QLatin1String("PictureNameItem"), VP_METADATA_BLOCK_PICTURE).toInt();
   m_riffTrackName = config->value(QLatin1String("RiffTrackName"), QString::fromLatin1(defaultRiffTrackName)).toString();
@@ -456,6 +462,24 @@ void TagConfig::setLowercaseId3RiffChunk(bool lowercaseId3RiffChunk)
   }
 }
 
+/** Set padding in bytes reserved when a tag has to be moved. */
+void TagConfig::setTagPaddingSize(int tagPaddingSize)
+{
+  if (m_tagPaddingSize != tagPaddingSize) {
+    m_tagPaddingSize = tagPaddingSize;
+    emit tagPaddingSizeChanged(m_tagPaddingSize);
+  }
+}
+
+/** Set true to reserve padding as large as the tag when a tag is moved. */
+void TagConfig::setGrowTagPaddingOnce(bool growTagPaddingOnce)
+{
+  if (m_growTagPaddingOnce != growTagPaddingOnce) {
+    m_growTagPaddingOnce = growTagPaddingOnce;
+    emit growTagPaddingOnceChanged(m_growTagPaddingOnce);
+  }
+}
+
 /** Set field name used for Vorbis comment entries. */
 void TagConfig::setCommentName(const QString& commentName)
 {
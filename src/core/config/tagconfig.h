@@ -54,6 +54,10 @@ class KID3_CORE_EXPORT TagConfig : public StoredConfig<TagConfig> {
   Q_PROPERTY(bool genreNotNumeric READ genreNotNumeric WRITE setGenreNotNumeric NOTIFY genreNotNumericChanged)
   /** true to use "id3 " instead of "ID3 " chunk names in WAV files */
   Q_PROPERTY(bool lowercaseId3RiffChunk READ lowercaseId3RiffChunk WRITE setLowercaseId3RiffChunk NOTIFY lowercaseId3RiffChunkChanged)
+  /** padding in bytes reserved when a tag has to be moved, 0 for default */
+  Q_PROPERTY(int tagPaddingSize READ tagPaddingSize WRITE setTagPaddingSize NOTIFY tagPaddingSizeChanged)
+  /** true to reserve padding as large as the tag when a tag is moved */
+  Q_PROPERTY(bool growTagPaddingOnce READ growTagPaddingOnce WRITE setGrowTagPaddingOnce NOTIFY growTagPaddingOnceChanged)
   /** field name used for Vorbis comment entries */
   Q_PROPERTY(QString commentName READ commentName WRITE setCommentName NOTIFY commentNameChanged)
   /** index of field name used for Vorbis picture entries */
@@ -193,6 +197,26 @@ public:
   /** Set true to use "id3 " instead of "ID3 " chunk names in WAV files */
   void setLowercaseId3RiffChunk(bool lowercaseId3RiffChunk);
 
+  /**
+   * Padding in bytes reserved when a tag does not fit into the space of the
+   * existing tag and the audio data has to be moved, 0 to let the metadata
+   * library decide.
+   */
+  int tagPaddingSize() const { return m_tagPaddingSize; }
+
+  /** Set padding in bytes reserved when a tag has to be moved. */
+  void setTagPaddingSize(int tagPaddingSize);
+
+  /**
+   * true to reserve padding as large as the tag itself (up to 1 MB) when a
+   * tag has to be moved, so that it can grow without moving the audio data
+   * again.
+   */
+  bool growTagPaddingOnce() const { return m_growTagPaddingOnce; }
+
+  /** Set true to reserve padding as large as the tag when a tag is moved. */
+  void setGrowTagPaddingOnce(bool growTagPaddingOnce);
+
   /** field name used for Vorbis comment entries */
   QString commentName() const { return m_commentName; }
 
@@ -402,6 +426,12 @@ signals:
   /** Emitted when @a lowercaseId3RiffChunk changed. */
   void lowercaseId3RiffChunkChanged(bool lowercaseId3RiffChunk);
 
+  /** Emitted when @a tagPaddingSize changed. */
+  void tagPaddingSizeChanged(int tagPaddingSize);
+
+  /** Emitted when @a growTagPaddingOnce changed. */
+  void growTagPaddingOnceChanged(bool growTagPaddingOnce);
+
   /** Emitted when @a commentName changed. */
   void commentNameChanged(const QString& commentName);
 
@@ -467,6 +497,7 @@ private:
   QStringList m_availablePlugins;
   int m_taggedFileFeatures;
   int m_maximumPictureSize;
+  int m_tagPaddingSize;
   bool m_markOversizedPictures;
   bool m_markStandardViolations;
   bool m_onlyCustomGenres;
@@ -474,6 +505,7 @@ private:
   bool m_enableTotalNumberOfTracks;
   bool m_genreNotNumeric;
   bool m_lowercaseId3RiffChunk;
+  bool m_growTagPaddingOnce;
 
   /** Index in configuration storage */
   static int s_index;
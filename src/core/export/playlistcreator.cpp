@@ -45,8 +45,21 @@
  */
 PlaylistCreator::PlaylistCreator(const QString& topLevelDir,
                                  const PlaylistConfig& cfg) :
-  m_cfg(cfg)
+  m_cfg(cfg),
+  m_fileNameFormat(TrackData::compileFormat(m_cfg.fileNameFormat())),
+  m_sortKeyFormat(TrackData::compileFormat(m_cfg.sortTagField()))
 {
+  // The formats are compiled once and then used for all files.
+  if (m_cfg.format() != PlaylistConfig::PF_XSPF) {
+    m_infoFormat = TrackData::compileFormat(m_cfg.infoFormat());
+  } else {
+    m_infoFormat = TrackData::compileFormat(QLatin1String(
+      "      <title>%{title}</title>\n"
+      "      <creator>%{artist}</creator>\n"
+      "      <album>%{album}</album>\n"
+      "      <trackNum>%{track.1}</trackNum>\n"
+      "      <duration>%{seconds}000</duration>\n"));
+  }
   if (m_cfg.location() == PlaylistConfig::PL_TopLevelDirectory) {
     m_playlistDirName = topLevelDir;
     if (!m_playlistDirName.endsWith(QLatin1Char('/'))) {
@@ -185,11 +198,12 @@ PlaylistCreator::Item::~Item()
 /**
  * Format string using tags and properties of item.
  *
- * @param format format string
+ * @param format format compiled with TrackData::compileFormat()
  *
  * @return string with percent codes replaced.
  */
-QString PlaylistCreator::Item::formatString(const QString& format)
+QString PlaylistCreator::Item::formatString(
+    const FormatReplacer::Template& format)
 {
   if (!m_trackData) {
     m_taggedFile = FileProxyModel::readTagsFromTaggedFile(m_taggedFile);
@@ -218,7 +232,7 @@ bool PlaylistCreator::Item::add()
     if (!m_ctr.m_cfg.useFileNameFormat()) {
       m_ctr.m_playlistFileName = QDir(m_ctr.m_playlistDirName).dirName();
     } else {
-      m_ctr.m_playlistFileName = formatString(m_ctr.m_cfg.fileNameFormat());
+      m_ctr.m_playlistFileName = formatString(m_ctr.m_fileNameFormat);
 
       // Replace illegal characters in the playlist file name.
       // Use replacements from the file name format config if enabled,
@@ -263,22 +277,13 @@ bool PlaylistCreator::Item::add()
   }
   QString sortKey;
   if (m_ctr.m_cfg.useSortTagField()) {
-    sortKey = formatString(m_ctr.m_cfg.sortTagField());
+    sortKey = formatString(m_ctr.m_sortKeyFormat);
   }
   sortKey += filePath;
   PlaylistCreator::Entry entry;
   entry.filePath = filePath;
   if (m_ctr.m_cfg.writeInfo()) {
-    if (m_ctr.m_cfg.format() != PlaylistConfig::PF_XSPF) {
-      entry.info = formatString(m_ctr.m_cfg.infoFormat());
-    } else {
-      entry.info = formatString(QLatin1String(
-        "      <title>%{title}</title>\n"
-        "      <creator>%{artist}</creator>\n"
-        "      <album>%{album}</album>\n"
-        "      <trackNum>%{track.1}</trackNum>\n"
-        "      <duration>%{seconds}000</duration>\n"));
-    }
+    entry.info = formatString(m_ctr.m_infoFormat);
     TaggedFile::DetailInfo detailInfo;
     m_taggedFile->getDetailInfo(detailInfo);
     entry.duration = detailInfo.duration;
@@ -29,6 +29,7 @@
 
 #include <QString>
 #include <QMap>
+#include "formatreplacer.h"
 
 class QModelIndex;
 class TaggedFile;
@@ -91,11 +92,11 @@ public:
     /**
      * Format string using tags and properties of item.
      *
-     * @param format format string
+     * @param format format compiled with TrackData::compileFormat()
      *
      * @return string with percent codes replaced.
      */
-    QString formatString(const QString& format);
+    QString formatString(const FormatReplacer::Template& format);
 
     PlaylistCreator& m_ctr;
     TaggedFile* m_taggedFile;
@@ -129,6 +130,9 @@ private:
   };
 
   const PlaylistConfig& m_cfg;
+  FormatReplacer::Template m_fileNameFormat;
+  FormatReplacer::Template m_sortKeyFormat;
+  FormatReplacer::Template m_infoFormat;
   QString m_playlistDirName;
   QString m_playlistFileName;
   QMap<QString, Entry> m_entries;
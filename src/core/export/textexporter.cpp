@@ -29,17 +29,30 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QTextStream>
+#include <QQueue>
 #include <QApplication>
 #include <QClipboard>
+#include "fileproxymodel.h"
+#include "modeliterator.h"
 #include "exportconfig.h"
 #include "importconfig.h"
 #include "fileconfig.h"
 
+namespace {
+
+/** Maximum number of bytes buffered by the export device. */
+const qint64 MaxPendingBytes = 1024 * 1024;
+/** Maximum time in milliseconds before exported text is flushed. */
+const qint64 FlushIntervalMs = 200;
+
+}
+
 /**
  * Constructor.
  * @param parent parent object
  */
-TextExporter::TextExporter(QObject* parent) : QObject(parent)
+TextExporter::TextExporter(QObject* parent) : QObject(parent),
+  m_device(0), m_hasExportedTracks(false)
 {
   setObjectName(QLatin1String("TextExporter"));
 }
@@ -63,21 +76,27 @@ void TextExporter::updateText(
   const QString& trailerFormat)
 {
   m_text.clear();
+  const FormatReplacer::Template headerTemplate =
+      TrackData::compileFormat(headerFormat);
+  const FormatReplacer::Template trackTemplate =
+      TrackData::compileFormat(trackFormat);
+  const FormatReplacer::Template trailerTemplate =
+      TrackData::compileFormat(trailerFormat);
   const int numTracks = m_trackDataVector.size();
   int trackNr = 0;
   for (ImportTrackDataVector::const_iterator it = m_trackDataVector.begin();
        it != m_trackDataVector.end();
        ++it) {
     if (trackNr == 0 && !headerFormat.isEmpty()) {
-      m_text.append((*it).formatString(headerFormat));
+      m_text.append((*it).formatString(headerTemplate));
       m_text.append(QLatin1Char('\n'));
     }
     if (!trackFormat.isEmpty()) {
-      m_text.append((*it).formatString(trackFormat));
+      m_text.append((*it).formatString(trackTemplate));
       m_text.append(QLatin1Char('\n'));
     }
     if (trackNr == numTracks - 1 && !trailerFormat.isEmpty()) {
-      m_text.append((*it).formatString(trailerFormat));
+      m_text.append((*it).formatString(trailerTemplate));
       m_text.append(QLatin1Char('\n'));
     }
     ++trackNr;
@@ -128,6 +147,174 @@ bool TextExporter::exportToFile(const QString& fn)
   return false;
 }
 
+/**
+ * Start exporting directly to a device.
+ * Instead of building the text of all tracks in memory using
+ * updateText(), the tracks are passed one after the other to
+ * exportTrack() and the formatted text is written to the device
+ * right away. The export has to be finished with endExport().
+ *
+ * @param device device opened for writing, must exist until endExport()
+ * @param fmtIdx index of format from the configuration, nothing is
+ * written for an invalid index
+ *
+ * @return true if ok.
+ */
+bool TextExporter::beginExport(QIODevice* device, int fmtIdx)
+{
+  if (!device)
+    return false;
+
+  m_device = device;
+  m_stream.reset(new QTextStream(device));
+  QString codecName = FileConfig::instance().textEncoding();
+  if (codecName != QLatin1String("System")) {
+    m_stream->setCodec(codecName.toLatin1());
+  }
+  // Like updateTextUsingConfig(), an invalid format index does not fail.
+  const ExportConfig& exportCfg = ExportConfig::instance();
+  const QStringList headerFmts = exportCfg.exportFormatHeaders();
+  const QStringList trackFmts = exportCfg.exportFormatTracks();
+  const QStringList trailerFmts = exportCfg.exportFormatTrailers();
+  const bool validIdx = fmtIdx >= 0 && fmtIdx < headerFmts.size() &&
+      fmtIdx < trackFmts.size() && fmtIdx < trailerFmts.size();
+  m_headerFormat = TrackData::compileFormat(
+        validIdx ? headerFmts.at(fmtIdx) : QString());
+  m_trackFormat = TrackData::compileFormat(
+        validIdx ? trackFmts.at(fmtIdx) : QString());
+  m_trailerFormat = TrackData::compileFormat(
+        validIdx ? trailerFmts.at(fmtIdx) : QString());
+  m_lastTrackData = ImportTrackData();
+  m_hasExportedTracks = false;
+  m_flushTimer.start();
+  return true;
+}
+
+/**
+ * Export a track to the device given in beginExport().
+ * The header is written before the first track. If the device cannot
+ * take more data, this method waits until buffered data has been written.
+ *
+ * @param trackData track data
+ *
+ * @return true if ok.
+ */
+bool TextExporter::exportTrack(const ImportTrackData& trackData)
+{
+  if (!m_stream)
+    return false;
+
+  if (!m_hasExportedTracks) {
+    writeFormatted(trackData, m_headerFormat);
+    m_hasExportedTracks = true;
+  }
+  writeFormatted(trackData, m_trackFormat);
+  // Only the last track is kept for the trailer.
+  m_lastTrackData = trackData;
+
+  // Flush regularly, so that the output appears while the export is
+  // running, and wait if a sequential device such as a pipe or socket
+  // cannot take the data as fast as it is produced.
+  if (m_flushTimer.elapsed() >= FlushIntervalMs ||
+      m_device->bytesToWrite() > MaxPendingBytes) {
+    m_stream->flush();
+    while (m_device->bytesToWrite() > MaxPendingBytes &&
+           m_device->waitForBytesWritten(-1)) {
+    }
+    m_flushTimer.start();
+  }
+  return m_stream->status() == QTextStream::Ok;
+}
+
+/**
+ * Finish exporting to a device.
+ * The trailer is written using the last exported track.
+ *
+ * @return true if ok, false if writing to the device failed.
+ */
+bool TextExporter::endExport()
+{
+  if (!m_stream)
+    return false;
+
+  if (m_hasExportedTracks) {
+    writeFormatted(m_lastTrackData, m_trailerFormat);
+  }
+  m_stream->flush();
+  bool ok = m_stream->status() == QTextStream::Ok;
+  m_stream.reset();
+  m_device = 0;
+  m_lastTrackData = ImportTrackData();
+  m_hasExportedTracks = false;
+  return ok;
+}
+
+/**
+ * Export the tagged files of a directory to a device.
+ * The files are exported while iterating and the tags of only a window
+ * of files are read ahead, so the output starts immediately and the
+ * memory used does not depend on the number of files. Tags which were
+ * not read before are freed after exporting them.
+ *
+ * @param index index of the directory or a file in it
+ * @param tagVersion tag version
+ * @param device device opened for writing
+ * @param fmtIdx index of format from the configuration, nothing is
+ * written for an invalid index
+ *
+ * @return true if ok.
+ */
+bool TextExporter::exportDirectory(const QPersistentModelIndex& index,
+                                   Frame::TagVersion tagVersion,
+                                   QIODevice* device, int fmtIdx)
+{
+  if (!beginExport(device, fmtIdx))
+    return false;
+
+  FileProxyModel* model = qobject_cast<FileProxyModel*>(
+        const_cast<QAbstractItemModel*>(index.model()));
+  const int windowSize = model ? model->tagPrefetchWindowSize() : 0;
+  QQueue<QPersistentModelIndex> indexes;
+  bool ok = true;
+  TaggedFileOfDirectoryIterator it(index);
+  while (ok && (it.hasNext() || !indexes.isEmpty())) {
+    if (it.hasNext()) {
+      QPersistentModelIndex fileIndex(it.next()->getIndex());
+      if (model) {
+        model->prefetchTaggedFile(fileIndex);
+      }
+      indexes.enqueue(fileIndex);
+      if (indexes.size() <= windowSize && it.hasNext())
+        continue;
+    }
+    if (TaggedFile* taggedFile =
+        FileProxyModel::getTaggedFileOfIndex(indexes.dequeue())) {
+      const bool tagInfoRead = taggedFile->isTagInformationRead();
+      taggedFile = FileProxyModel::readTagsFromTaggedFile(taggedFile);
+      ok = exportTrack(ImportTrackData(*taggedFile, tagVersion));
+      // Free resources if tags were not read before exporting
+      if (!tagInfoRead) {
+        taggedFile->clearTags(false);
+      }
+    }
+  }
+  return endExport() && ok;
+}
+
+/**
+ * Write formatted track data to the stream of the export.
+ *
+ * @param trackData track data
+ * @param tmpl compiled format
+ */
+void TextExporter::writeFormatted(const ImportTrackData& trackData,
+                                  const FormatReplacer::Template& tmpl)
+{
+  if (!tmpl.getString().isEmpty()) {
+    *m_stream << trackData.formatString(tmpl) << QLatin1Char('\n');
+  }
+}
+
 /**
  * Export to clipboard.
  */
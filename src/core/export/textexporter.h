@@ -28,9 +28,15 @@
 #define TEXTEXPORTER_H
 
 #include <QObject>
+#include <QScopedPointer>
+#include <QElapsedTimer>
 #include "trackdata.h"
 #include "kid3api.h"
 
+class QIODevice;
+class QTextStream;
+class QPersistentModelIndex;
+
 /**
  * Export text from tags.
  */
@@ -101,9 +107,81 @@ public:
    */
   void exportToClipboard();
 
+  /**
+   * Start exporting directly to a device.
+   * Instead of building the text of all tracks in memory using
+   * updateText(), the tracks are passed one after the other to
+   * exportTrack() and the formatted text is written to the device
+   * right away. The export has to be finished with endExport().
+   *
+   * @param device device opened for writing, must exist until endExport()
+   * @param fmtIdx index of format from the configuration, nothing is
+   * written for an invalid index
+   *
+   * @return true if ok.
+   */
+  bool beginExport(QIODevice* device, int fmtIdx);
+
+  /**
+   * Export a track to the device given in beginExport().
+   * The header is written before the first track. If the device cannot
+   * take more data, this method waits until buffered data has been written.
+   *
+   * @param trackData track data
+   *
+   * @return true if ok.
+   */
+  bool exportTrack(const ImportTrackData& trackData);
+
+  /**
+   * Finish exporting to a device.
+   * The trailer is written using the last exported track.
+   *
+   * @return true if ok, false if writing to the device failed.
+   */
+  bool endExport();
+
+  /**
+   * Export the tagged files of a directory to a device.
+   * The files are exported while iterating and the tags of only a window
+   * of files are read ahead, so the output starts immediately and the
+   * memory used does not depend on the number of files. Tags which were
+   * not read before are freed after exporting them.
+   *
+   * @param index index of the directory or a file in it
+   * @param tagVersion tag version
+   * @param device device opened for writing
+   * @param fmtIdx index of format from the configuration, nothing is
+   * written for an invalid index
+   *
+   * @return true if ok.
+   */
+  bool exportDirectory(const QPersistentModelIndex& index,
+                       Frame::TagVersion tagVersion,
+                       QIODevice* device, int fmtIdx);
+
 private:
+  /**
+   * Write formatted track data to the stream of the export.
+   *
+   * @param trackData track data
+   * @param tmpl compiled format
+   */
+  void writeFormatted(const ImportTrackData& trackData,
+                      const FormatReplacer::Template& tmpl);
+
   ImportTrackDataVector m_trackDataVector;
   QString m_text;
+
+  // State of export started with beginExport()
+  QScopedPointer<QTextStream> m_stream;
+  QIODevice* m_device;
+  FormatReplacer::Template m_headerFormat;
+  FormatReplacer::Template m_trackFormat;
+  FormatReplacer::Template m_trailerFormat;
+  ImportTrackData m_lastTrackData;
+  QElapsedTimer m_flushTimer;
+  bool m_hasExportedTracks;
 };
 
 #endif // TEXTEXPORTER_H
@@ -1,6 +1,8 @@
 set(import_SRCS
   import/batchimporter.cpp
   import/httpclient.cpp
+  import/httprequestscheduler.cpp
+  import/httpresponsecache.cpp
   import/importclient.cpp
   import/importparser.cpp
   import/iserverimporterfactory.cpp
@@ -15,6 +17,8 @@ set(import_SRCS
 set(import_MOC_HDRS
   import/batchimporter.h
   import/httpclient.h
+  import/httprequestscheduler.h
+  import/httpresponsecache.h
   import/importclient.h
   import/serverimporter.h
   import/servertrackimporter.h
@@ -31,6 +31,7 @@
 #include "pictureframe.h"
 #include "fileconfig.h"
 #include "formatconfig.h"
+#include "operationprofiler.h"
 
 /**
  * Flags to store types of data which have to be imported.
@@ -46,14 +47,13 @@ enum DataFlags {
  * @param netMgr network access manager
  */
 BatchImporter::BatchImporter(QNetworkAccessManager* netMgr) : QObject(netMgr),
-  m_downloadClient(new DownloadClient(netMgr)),
+  m_netMgr(netMgr),
   m_currentImporter(0), m_trackDataModel(0), m_albumModel(0),
   m_albumListItem(0), m_tagVersion(Frame::TagNone), m_state(Idle),
-  m_trackListNr(-1), m_sourceNr(-1), m_albumNr(-1),
-  m_requestedData(0), m_importedData(0)
+  m_trackListNr(-1), m_sourceNr(-1), m_albumNr(-1), m_firstAlbumNr(0),
+  m_requestedData(0), m_importedData(0), m_pendingData(0),
+  m_retryingCoverArt(false)
 {
-  connect(m_downloadClient, SIGNAL(downloadFinished(QByteArray,QString,QString)),
-          this, SLOT(onImageDownloaded(QByteArray,QString,QString)));
   m_frameFilter.enableAll();
 }
 
@@ -91,6 +91,9 @@ void BatchImporter::start(const QList<ImportTrackDataVector>& trackLists,
   m_tagVersion = tagVersion;
   emit reportImportEvent(Started, profile.getName());
   m_trackListNr = -1;
+  m_firstAlbumNr = 0;
+  m_retryingCoverArt = false;
+  m_coverRetries.clear();
   m_state = CheckNextTrackList;
   stateTransition();
 }
@@ -123,10 +126,8 @@ void BatchImporter::abort()
 {
   State oldState = m_state;
   m_state = ImportAborted;
-  if (oldState == Idle) {
-    stateTransition();
-  } else if (oldState == GettingCover) {
-    m_downloadClient->cancelDownload();
+  cancelCoverDownloads();
+  if (oldState == Idle || oldState == WaitingForCovers) {
     stateTransition();
   }
 }
@@ -139,6 +140,11 @@ void BatchImporter::stateTransition()
     break;
   case CheckNextTrackList:
     if (m_trackDataModel) {
+      if (m_retryingCoverArt) {
+        // The track lists after the retried one have already been processed.
+        m_retryingCoverArt = false;
+        m_trackListNr = m_trackLists.size();
+      }
       bool searchKeyFound = false;
       forever {
         ++m_trackListNr;
@@ -169,10 +175,28 @@ void BatchImporter::stateTransition()
       if (searchKeyFound) {
         m_sourceNr = -1;
         m_importedData = 0;
+        m_pendingData = 0;
+        m_state = CheckNextSource;
+      } else if (!m_coverRetries.isEmpty()) {
+        // Continue with the album after the one whose cover art could not
+        // be downloaded, only the cover art is still missing.
+        CoverDownload retry = m_coverRetries.takeFirst();
+        m_retryingCoverArt = true;
+        m_trackListNr = retry.trackListNr;
+        m_currentArtist = retry.artist;
+        m_currentAlbum = retry.album;
+        m_trackDataModel->setTrackData(m_trackLists.at(m_trackListNr));
+        m_sourceNr = retry.sourceNr - 1;
+        m_firstAlbumNr = retry.albumNr + 1;
+        m_importedData = StandardTags | AdditionalTags;
+        m_pendingData = 0;
         m_state = CheckNextSource;
+      } else if (!m_coverDownloads.isEmpty()) {
+        m_state = WaitingForCovers;
       } else {
         emit reportImportEvent(Finished, QString());
         emit finished();
+        OperationProfiler::end("batchImport");
         m_state = Idle;
       }
       stateTransition();
@@ -213,7 +237,8 @@ void BatchImporter::stateTransition()
     if (m_currentImporter) {
       emit reportImportEvent(QueryingAlbumList,
                              m_currentArtist + QLatin1String(" - ") + m_currentAlbum);
-      m_albumNr = -1;
+      m_albumNr = m_firstAlbumNr - 1;
+      m_firstAlbumNr = 0;
       m_albumModel = 0;
       connect(m_currentImporter, SIGNAL(findFinished(QByteArray)),
               this, SLOT(onFindFinished(QByteArray)));
@@ -273,26 +298,30 @@ void BatchImporter::stateTransition()
           if (!imgUrl.isEmpty()) {
             emit reportImportEvent(FetchingCoverArt,
                                    coverArtUrl.toString());
-            m_downloadClient->startDownload(imgUrl);
+            // The cover art is downloaded while the next albums are
+            // processed, if it fails, the next album is tried later.
+            startCoverDownload(imgUrl);
+            m_pendingData |= CoverArt;
           }
         }
       }
-      if (imgUrl.isEmpty()) {
-        m_state = CheckIfDone;
-        stateTransition();
-      }
+      m_state = CheckIfDone;
+      stateTransition();
     }
     break;
   case CheckIfDone:
-    if (m_requestedData & ~m_importedData) {
+    if (m_requestedData & ~(m_importedData | m_pendingData)) {
       m_state = CheckNextAlbum;
     } else {
       m_state = CheckNextTrackList;
     }
     stateTransition();
     break;
+  case WaitingForCovers:
+    break;
   case ImportAborted:
     emit reportImportEvent(Aborted, QString());
+    OperationProfiler::end("batchImport");
     break;
   }
 }
@@ -400,34 +429,87 @@ void BatchImporter::onAlbumProgress(const QString& text, int step, int total)
 void BatchImporter::onImageDownloaded(const QByteArray& data,
                                     const QString& mimeType, const QString& url)
 {
-  if (m_state == ImportAborted) {
-    stateTransition();
-  } else {
-    if (data.size() >= 1024) {
-      if (mimeType.startsWith(QLatin1String("image")) && m_trackDataModel) {
-        emit reportImportEvent(CoverArtReceived, url);
-        PictureFrame frame(data, url, PictureFrame::PT_CoverFront, mimeType);
-        ImportTrackDataVector trackDataVector(m_trackDataModel->getTrackData());
-        for (ImportTrackDataVector::iterator it = trackDataVector.begin();
-             it != trackDataVector.end();
-             ++it) {
-          if (TaggedFile* taggedFile = it->getTaggedFile()) {
-            taggedFile->readTags(false);
-            taggedFile->addFrame(Frame::Tag_Picture, frame);
-          }
+  DownloadClient* downloadClient = qobject_cast<DownloadClient*>(sender());
+  if (!downloadClient || !m_coverDownloads.contains(downloadClient))
+    return;
+
+  CoverDownload download(m_coverDownloads.take(downloadClient));
+  bool received = false;
+  if (data.size() >= 1024) {
+    if (mimeType.startsWith(QLatin1String("image"))) {
+      emit reportImportEvent(CoverArtReceived, url);
+      PictureFrame frame(data, url, PictureFrame::PT_CoverFront, mimeType);
+      for (ImportTrackDataVector::iterator it = download.trackData.begin();
+           it != download.trackData.end();
+           ++it) {
+        if (TaggedFile* taggedFile = it->getTaggedFile()) {
+          taggedFile->readTags(false);
+          taggedFile->addFrame(Frame::Tag_Picture, frame);
         }
-        m_importedData |= CoverArt;
       }
-    } else {
-      // Probably an invalid 1x1 picture from Amazon
-      emit reportImportEvent(CoverArtReceived,
-                             tr("Invalid File"));
+      received = true;
     }
-    m_state = CheckIfDone;
+  } else {
+    // Probably an invalid 1x1 picture from Amazon
+    emit reportImportEvent(CoverArtReceived,
+                           tr("Invalid File"));
+  }
+  if (!received) {
+    m_coverRetries.append(download);
+  }
+  if (m_state == WaitingForCovers && m_coverDownloads.isEmpty()) {
+    m_state = CheckNextTrackList;
     stateTransition();
   }
 }
 
+/**
+ * Start downloading cover art for the album in the track data model.
+ * Several downloads can be in flight, a new download client is only created
+ * if all existing clients are busy.
+ * @param url URL of image
+ */
+void BatchImporter::startCoverDownload(const QUrl& url)
+{
+  DownloadClient* downloadClient = 0;
+  foreach (DownloadClient* client, m_downloadClients) {
+    if (!m_coverDownloads.contains(client)) {
+      downloadClient = client;
+      break;
+    }
+  }
+  if (!downloadClient) {
+    downloadClient = new DownloadClient(m_netMgr);
+    // Requests for the track lists are more important.
+    downloadClient->setPriority(HttpClient::LowPriority);
+    connect(downloadClient, SIGNAL(downloadFinished(QByteArray,QString,QString)),
+            this, SLOT(onImageDownloaded(QByteArray,QString,QString)));
+    m_downloadClients.append(downloadClient);
+  }
+  CoverDownload download;
+  download.trackData = m_trackDataModel->getTrackData();
+  download.artist = m_currentArtist;
+  download.album = m_currentAlbum;
+  download.trackListNr = m_trackListNr;
+  download.sourceNr = m_sourceNr;
+  download.albumNr = m_albumNr;
+  m_coverDownloads.insert(downloadClient, download);
+  downloadClient->startDownload(url);
+}
+
+/**
+ * Cancel all cover art downloads.
+ */
+void BatchImporter::cancelCoverDownloads()
+{
+  QList<DownloadClient*> downloadClients = m_coverDownloads.keys();
+  m_coverDownloads.clear();
+  m_coverRetries.clear();
+  foreach (DownloadClient* downloadClient, downloadClients) {
+    downloadClient->cancelDownload();
+  }
+}
+
 ServerImporter* BatchImporter::getImporter(const QString& name)
 {
   foreach (ServerImporter* importer, m_importers) {
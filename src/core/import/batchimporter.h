@@ -28,6 +28,7 @@
 #define BATCHIMPORTER_H
 
 #include <QObject>
+#include <QMap>
 #include "trackdata.h"
 #include "batchimportprofile.h"
 #include "iabortable.h"
@@ -155,13 +156,32 @@ private:
     GettingTracks,
     GettingCover,
     CheckIfDone,
+    WaitingForCovers,
     ImportAborted
   };
 
+  /** Cover art download for a track list. */
+  struct CoverDownload {
+    ImportTrackDataVector trackData; /**< track data of album */
+    QString artist;                  /**< artist searched for */
+    QString album;                   /**< album searched for */
+    int trackListNr;                 /**< index in m_trackLists */
+    int sourceNr;                    /**< index of source in profile */
+    int albumNr;                     /**< index in album list of source */
+  };
+
   void stateTransition();
   ServerImporter* getImporter(const QString& name);
-
-  DownloadClient* m_downloadClient;
+  void startCoverDownload(const QUrl& url);
+  void cancelCoverDownloads();
+
+  QNetworkAccessManager* m_netMgr;
+  /** Download clients, reused when their download is finished */
+  QList<DownloadClient*> m_downloadClients;
+  /** Albums for which cover art is being downloaded */
+  QMap<DownloadClient*, CoverDownload> m_coverDownloads;
+  /** Failed cover art downloads, the next albums are tried */
+  QList<CoverDownload> m_coverRetries;
   QList<ServerImporter*> m_importers;
   ServerImporter* m_currentImporter;
   TrackDataModel* m_trackDataModel;
@@ -174,8 +194,14 @@ private:
   int m_trackListNr;
   int m_sourceNr;
   int m_albumNr;
+  /** Index of first album checked, > 0 when retrying cover art */
+  int m_firstAlbumNr;
   int m_requestedData;
   int m_importedData;
+  /** Data being imported in the background, e.g. cover art */
+  int m_pendingData;
+  /** true if the track list is processed again for cover art */
+  bool m_retryingCoverArt;
   QString m_currentArtist;
   QString m_currentAlbum;
   FrameFilter m_frameFilter;
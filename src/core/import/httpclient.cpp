@@ -29,37 +29,13 @@
 #include <QNetworkRequest>
 #include <QNetworkProxy>
 #include <QByteArray>
+#include <QCryptographicHash>
 #include "networkconfig.h"
+#include "httprequestscheduler.h"
+#include "httpresponsecache.h"
+#include "operationprofiler.h"
 
 
-/** Time when last request was sent to server */
-QMap<QString, QDateTime> HttpClient::s_lastRequestTime;
-/** Minimum interval between two requests to server in ms */
-QMap<QString, int> HttpClient::s_minimumRequestInterval;
-
-/**
- * Used to initialize the minimum interval for some servers
- * at static initialization time.
- *
- * Rate limit requests to servers, MusicBrainz and Discogs impose a limit of
- * one request per second
- * http://musicbrainz.org/doc/XML_Web_Service/Rate_Limiting#Source_IP_address
- * http://www.discogs.com/developers/accessing.html#rate-limiting
- */
-static struct MinimumRequestIntervalInitializer {
-  MinimumRequestIntervalInitializer() {
-    HttpClient::s_minimumRequestInterval[QLatin1String("musicbrainz.org")] = 1000;
-    HttpClient::s_minimumRequestInterval[QLatin1String("api.discogs.com")] = 1000;
-    HttpClient::s_minimumRequestInterval[QLatin1String("www.discogs.com")] = 1000;
-    HttpClient::s_minimumRequestInterval[QLatin1String("www.amazon.com")] = 1000;
-    HttpClient::s_minimumRequestInterval[QLatin1String("images.amazon.com")] = 1000;
-    HttpClient::s_minimumRequestInterval[QLatin1String("www.gnudb.org")] = 1000;
-    HttpClient::s_minimumRequestInterval[QLatin1String("gnudb.gnudb.org")] = 1000;
-    HttpClient::s_minimumRequestInterval[QLatin1String("tracktype.org")] = 1000;
-    HttpClient::s_minimumRequestInterval[QLatin1String("api.acoustid.org")] = 1000;
-  }
-} minimumRequestIntervalInitializer;
-
 /**
  * Constructor.
  *
@@ -67,11 +43,9 @@ static struct MinimumRequestIntervalInitializer {
  */
 HttpClient::HttpClient(QNetworkAccessManager* netMgr) :
   QObject(netMgr), m_netMgr(netMgr), m_rcvBodyLen(0),
-  m_requestTimer(new QTimer(this))
+  m_priority(NormalPriority), m_requestStartTime(-1)
 {
   setObjectName(QLatin1String("HttpClient"));
-  m_requestTimer->setSingleShot(true);
-  connect(m_requestTimer, SIGNAL(timeout()), this, SLOT(delayedSendRequest()));
 }
 
 /**
@@ -79,6 +53,9 @@ HttpClient::HttpClient(QNetworkAccessManager* netMgr) :
  */
 HttpClient::~HttpClient()
 {
+  if (HttpRequestScheduler* scheduler = HttpRequestScheduler::instance()) {
+    scheduler->cancel(this, true);
+  }
   if (m_reply) {
     m_reply->close();
     m_reply->disconnect();
@@ -115,7 +92,10 @@ void HttpClient::networkReplyFinished()
           reply->deleteLater();
 
           QNetworkRequest request(redirectUrl);
+          OperationProfiler::count(OperationProfiler::HttpRequests);
+          QVariant requestId = reply->property("requestId");
           reply = m_netMgr->get(request);
+          reply->setProperty("requestId", requestId);
           m_reply = reply;
           connect(reply, SIGNAL(finished()),
                   this, SLOT(networkReplyFinished()));
@@ -127,12 +107,42 @@ void HttpClient::networkReplyFinished()
         }
       }
     }
+    reply->deleteLater();
+    if (m_requestStartTime >= 0 && OperationProfiler::isEnabled()) {
+      OperationProfiler::instance().addDuration(
+            "httpRequest", m_requestUrl.host(), m_requestStartTime);
+      OperationProfiler::count(OperationProfiler::HttpBytesReceived,
+                               data.size());
+    }
+    if (HttpRequestScheduler* scheduler = HttpRequestScheduler::instance()) {
+      scheduler->requestFinished(reply->property("requestId").toULongLong(),
+                                 data, m_rcvBodyType, m_rcvBodyLen, msg);
+    }
     emit bytesReceived(data);
     emitProgress(msg, data.size(), data.size());
-    reply->deleteLater();
   }
 }
 
+/**
+ * Receive the response to an identical request of another client,
+ * called by the HttpRequestScheduler.
+ *
+ * @param data received data
+ * @param contentType content type
+ * @param contentLength content length
+ * @param msg state message
+ */
+void HttpClient::receiveResponse(const QByteArray& data,
+                                 const QString& contentType,
+                                 unsigned long contentLength,
+                                 const QString& msg)
+{
+  m_rcvBodyType = contentType;
+  m_rcvBodyLen = contentLength;
+  emit bytesReceived(data);
+  emitProgress(msg, data.size(), data.size());
+}
+
 /**
  * Called to report connection progress.
  *
@@ -164,23 +174,44 @@ void HttpClient::networkReplyError(QNetworkReply::NetworkError)
  */
 void HttpClient::sendRequest(const QUrl& url, const RawHeaderMap& headers)
 {
-  QString host = url.host();
-  qint64 msSinceLastRequest;
-  int minimumRequestInterval;
-  QDateTime now = QDateTime::currentDateTime();
-  QDateTime lastRequestTime = s_lastRequestTime.value(host);
-  if (lastRequestTime.isValid() &&
-      (minimumRequestInterval = s_minimumRequestInterval.value(host)) > 0 &&
-      (msSinceLastRequest = lastRequestTime.msecsTo(now)) <
-      minimumRequestInterval) {
-    // Delay request to comply with minimum interval
-    m_delayedSendRequestContext.url = url;
-    m_delayedSendRequestContext.headers = headers;
-    m_requestTimer->start(minimumRequestInterval -
-                          static_cast<int>(msSinceLastRequest));
-    return;
+  m_requestUrl = url;
+  m_requestHeaders = headers;
+  m_requestData.clear();
+  if (HttpRequestScheduler* scheduler = HttpRequestScheduler::instance()) {
+    scheduler->enqueue(this);
+  }
+}
+
+/**
+ * Send a HTTP POST request.
+ * If no content type header is given, the data is sent as
+ * "application/x-www-form-urlencoded".
+ *
+ * @param url URL
+ * @param data data to post
+ * @param headers optional raw headers to send
+ */
+void HttpClient::sendPostRequest(const QUrl& url, const QByteArray& data,
+                                 const RawHeaderMap& headers)
+{
+  m_requestUrl = url;
+  m_requestHeaders = headers;
+  m_requestData = data;
+  if (m_requestData.isNull()) {
+    m_requestData = "";
+  }
+  if (HttpRequestScheduler* scheduler = HttpRequestScheduler::instance()) {
+    scheduler->enqueue(this);
   }
+}
 
+/**
+ * Send the request, called by the HttpRequestScheduler.
+ * @param requestId ID which is passed back to the scheduler with the
+ * response
+ */
+void HttpClient::startRequest(quint64 requestId)
+{
   m_rcvBodyLen = 0;
   m_rcvBodyType = QLatin1String("");
   QString proxy, username, password;
@@ -199,14 +230,37 @@ void HttpClient::sendRequest(const QUrl& url, const RawHeaderMap& headers)
                                    static_cast<quint16>(proxyPort),
                                    username, password));
 
-  QNetworkRequest request(url);
+  QNetworkRequest request(m_requestUrl);
   for (RawHeaderMap::const_iterator it =
-         headers.constBegin();
-       it != headers.constEnd();
+         m_requestHeaders.constBegin();
+       it != m_requestHeaders.constEnd();
        ++it) {
     request.setRawHeader(it.key(), it.value());
   }
-  QNetworkReply* reply = m_netMgr->get(request);
+  if (hasCredentials()) {
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute,
+                         QNetworkRequest::AlwaysNetwork);
+    request.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
+  }
+  if (OperationProfiler::isEnabled()) {
+    OperationProfiler::count(OperationProfiler::HttpRequests);
+    m_requestStartTime = OperationProfiler::instance().timestamp();
+  } else {
+    m_requestStartTime = -1;
+  }
+  QNetworkReply* reply;
+  if (m_requestData.isNull()) {
+    reply = m_netMgr->get(request);
+  } else {
+    if (request.header(QNetworkRequest::ContentTypeHeader).isNull()) {
+      request.setHeader(QNetworkRequest::ContentTypeHeader,
+                        QLatin1String("application/x-www-form-urlencoded"));
+    }
+    reply = m_netMgr->post(request, m_requestData);
+  }
+  // The ID identifies the request also if the reply finishes after another
+  // request has been started.
+  reply->setProperty("requestId", requestId);
   m_reply = reply;
   connect(reply, SIGNAL(finished()),
           this, SLOT(networkReplyFinished()));
@@ -214,7 +268,6 @@ void HttpClient::sendRequest(const QUrl& url, const RawHeaderMap& headers)
           this, SLOT(networkReplyProgress(qint64,qint64)));
   connect(reply, SIGNAL(error(QNetworkReply::NetworkError)),
           this, SLOT(networkReplyError(QNetworkReply::NetworkError)));
-  s_lastRequestTime[host] = now;
   emitProgress(tr("Request sent..."), 0, 0);
 }
 
@@ -243,12 +296,58 @@ void HttpClient::sendRequest(const QString& server, const QString& path,
 }
 
 /**
- * Called to start delayed sendRequest().
+ * Check if the response to the request can be taken from the cache
+ * without contacting the server.
+ * @return true if a fresh response is cached.
  */
-void HttpClient::delayedSendRequest()
+bool HttpClient::isResponseCached() const
 {
-  sendRequest(m_delayedSendRequestContext.url,
-              m_delayedSendRequestContext.headers);
+  HttpResponseCache* cache =
+      qobject_cast<HttpResponseCache*>(m_netMgr->cache());
+  return cache && m_requestData.isNull() && !hasCredentials() &&
+      cache->isFresh(m_requestUrl);
+}
+
+/**
+ * Check if the request contains credentials in its headers.
+ * Such requests are not cached.
+ * @return true if an authorization or cookie header is set.
+ */
+bool HttpClient::hasCredentials() const
+{
+  for (RawHeaderMap::const_iterator it = m_requestHeaders.constBegin();
+       it != m_requestHeaders.constEnd();
+       ++it) {
+    QByteArray name = it.key().toLower();
+    if (name == "authorization" || name == "cookie") {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Get key identifying the request.
+ * @return URL and headers of request.
+ */
+QString HttpClient::requestKey() const
+{
+  QString key = m_requestUrl.toString();
+  for (RawHeaderMap::const_iterator it = m_requestHeaders.constBegin();
+       it != m_requestHeaders.constEnd();
+       ++it) {
+    key += QLatin1Char('\n');
+    key += QString::fromLatin1(it.key());
+    key += QLatin1String(": ");
+    key += QString::fromLatin1(it.value());
+  }
+  if (!m_requestData.isNull()) {
+    key += QLatin1String("\nPOST ");
+    key += QString::fromLatin1(
+          QCryptographicHash::hash(m_requestData,
+                                   QCryptographicHash::Sha1).toHex());
+  }
+  return key;
 }
 
 /**
@@ -256,6 +355,11 @@ void HttpClient::delayedSendRequest()
  */
 void HttpClient::abort()
 {
+  // Pending requests are dropped, identical requests of other clients
+  // are sent by one of them.
+  if (HttpRequestScheduler* scheduler = HttpRequestScheduler::instance()) {
+    scheduler->cancel(this, true);
+  }
   if (m_reply) {
     m_reply->abort();
   }
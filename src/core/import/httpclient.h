@@ -32,8 +32,7 @@
 #include <QNetworkReply>
 #include <QPointer>
 #include <QMap>
-#include <QDateTime>
-#include <QTimer>
+#include <QUrl>
 #include "kid3api.h"
 
 class QByteArray;
@@ -49,6 +48,13 @@ public:
   /** Name-value map for raw HTTP headers. */
   typedef QMap<QByteArray, QByteArray> RawHeaderMap;
 
+  /** Priorities of requests to the same host. */
+  enum Priority {
+    LowPriority = -1,   /**< Background requests, e.g. batch cover art */
+    NormalPriority = 0, /**< Default priority */
+    HighPriority = 1    /**< Interactive requests */
+  };
+
   /**
    * Constructor.
    *
@@ -63,6 +69,8 @@ public:
 
   /**
    * Send a HTTP GET request.
+   * The request is sent by the HttpRequestScheduler, it may be delayed to
+   * comply with the rate limit of the server.
    *
    * @param url URL
    * @param headers optional raw headers to send
@@ -82,11 +90,44 @@ public:
                    const QString& scheme = QLatin1String("http"),
                    const RawHeaderMap& headers = RawHeaderMap());
 
+  /**
+   * Send a HTTP POST request.
+   * If no content type header is given, the data is sent as
+   * "application/x-www-form-urlencoded".
+   *
+   * @param url URL
+   * @param data data to post
+   * @param headers optional raw headers to send
+   */
+  void sendPostRequest(const QUrl& url, const QByteArray& data,
+                       const RawHeaderMap& headers = RawHeaderMap());
+
   /**
    * Abort request.
    */
   void abort();
 
+  /**
+   * Set priority of requests.
+   * Requests with higher priority are sent first when requests to the same
+   * host have to be delayed.
+   *
+   * @param priority priority, see Priority
+   */
+  void setPriority(int priority) { m_priority = priority; }
+
+  /**
+   * Get priority of requests.
+   * @return priority, see Priority.
+   */
+  int priority() const { return m_priority; }
+
+  /**
+   * Get URL of last request.
+   * @return URL.
+   */
+  QUrl requestUrl() const { return m_requestUrl; }
+
   /**
    * Get content length.
    * @return size of body in bytes, 0 if unknown.
@@ -143,12 +184,48 @@ private slots:
    */
   void networkReplyError(QNetworkReply::NetworkError code);
 
+private:
+  friend class HttpRequestScheduler;
+
   /**
-   * Called to start delayed sendRequest().
+   * Send the request, called by the HttpRequestScheduler.
+   * @param requestId ID which is passed back to the scheduler with the
+   * response
    */
-  void delayedSendRequest();
+  void startRequest(quint64 requestId);
+
+  /**
+   * Receive the response to an identical request of another client,
+   * called by the HttpRequestScheduler.
+   *
+   * @param data received data
+   * @param contentType content type
+   * @param contentLength content length
+   * @param msg state message
+   */
+  void receiveResponse(const QByteArray& data, const QString& contentType,
+                       unsigned long contentLength, const QString& msg);
+
+  /**
+   * Check if the response to the request can be taken from the cache
+   * without contacting the server.
+   * @return true if a fresh response is cached.
+   */
+  bool isResponseCached() const;
+
+  /**
+   * Check if the request contains credentials in its headers.
+   * Such requests are not cached.
+   * @return true if an authorization or cookie header is set.
+   */
+  bool hasCredentials() const;
+
+  /**
+   * Get key identifying the request.
+   * @return URL and headers of request.
+   */
+  QString requestKey() const;
 
-private:
   /**
    * Emit a progress signal with step/total steps.
    *
@@ -188,20 +265,16 @@ private:
   unsigned long m_rcvBodyLen;
   /** content type */
   QString m_rcvBodyType;
-  /** Timer used to delay requests */
-  QTimer* m_requestTimer;
-  /** Context for delayedSendRequest() */
-  struct {
-    QUrl url;
-    RawHeaderMap headers;
-  } m_delayedSendRequestContext;
-
-  friend struct MinimumRequestIntervalInitializer;
-
-  /** Time when last request was sent to server */
-  static QMap<QString, QDateTime> s_lastRequestTime;
-  /** Minimum interval between two requests to server in ms */
-  static QMap<QString, int> s_minimumRequestInterval;
+  /** URL of request */
+  QUrl m_requestUrl;
+  /** headers of request */
+  RawHeaderMap m_requestHeaders;
+  /** data of POST request, null for GET request */
+  QByteArray m_requestData;
+  /** priority of requests */
+  int m_priority;
+  /** OperationProfiler timestamp when request was sent, -1 if unknown */
+  qint64 m_requestStartTime;
 };
 
 #endif
@@ -0,0 +1,313 @@
+/**
+ * \file httprequestscheduler.cpp
+ * Scheduler for HTTP requests with per host rate limits.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "httprequestscheduler.h"
+#include <QCoreApplication>
+#include <QTimer>
+#include <QPair>
+#include <qmath.h>
+#include "httpclient.h"
+
+HttpRequestScheduler* HttpRequestScheduler::s_self = 0;
+bool HttpRequestScheduler::s_deleted = false;
+
+/**
+ * Get the scheduler.
+ * The scheduler is created on first use and deleted with the application
+ * object, it is not created again after it has been deleted.
+ * @return scheduler of the application, 0 if already deleted.
+ */
+HttpRequestScheduler* HttpRequestScheduler::instance()
+{
+  if (!s_self && !s_deleted) {
+    s_self = new HttpRequestScheduler(QCoreApplication::instance());
+  }
+  return s_self;
+}
+
+/**
+ * Constructor.
+ *
+ * Rate limit requests to servers, MusicBrainz and Discogs impose a limit of
+ * one request per second
+ * http://musicbrainz.org/doc/XML_Web_Service/Rate_Limiting#Source_IP_address
+ * http://www.discogs.com/developers/accessing.html#rate-limiting
+ *
+ * @param parent parent object
+ */
+HttpRequestScheduler::HttpRequestScheduler(QObject* parent) : QObject(parent),
+  m_timer(new QTimer(this)), m_coalescedCount(0), m_lastRequestId(0)
+{
+  setObjectName(QLatin1String("HttpRequestScheduler"));
+  m_timer->setSingleShot(true);
+  connect(m_timer, SIGNAL(timeout()), this, SLOT(processQueues()));
+  m_clock.start();
+
+  static const char* const rateLimitedHosts[] = {
+    "musicbrainz.org",
+    "api.discogs.com",
+    "www.discogs.com",
+    "www.amazon.com",
+    "images.amazon.com",
+    "www.gnudb.org",
+    "gnudb.gnudb.org",
+    "tracktype.org",
+    "api.acoustid.org",
+    0
+  };
+  for (const char* const* host = rateLimitedHosts; *host; ++host) {
+    setMinimumRequestInterval(QString::fromLatin1(*host), 1000);
+  }
+}
+
+/**
+ * Destructor.
+ */
+HttpRequestScheduler::~HttpRequestScheduler()
+{
+  // Clients deleted later must not create a new scheduler.
+  s_self = 0;
+  s_deleted = true;
+  qDeleteAll(m_requests);
+}
+
+/**
+ * Set minimum interval between two requests to a host.
+ * @param host host name
+ * @param msec interval in milliseconds, 0 to disable the rate limit
+ * @param burst number of requests which may be sent without delay
+ */
+void HttpRequestScheduler::setMinimumRequestInterval(const QString& host,
+                                                     int msec, int burst)
+{
+  Host& h = m_hosts[host];
+  h.interval = qMax(msec, 0);
+  h.burst = qMax(burst, 1);
+  h.tokens = h.burst;
+  h.lastRefill = m_clock.elapsed();
+  if (!h.queue.isEmpty()) {
+    m_timer->start(0);
+  }
+}
+
+/**
+ * Get minimum interval between two requests to a host.
+ * @param host host name
+ * @return interval in milliseconds, 0 if host has no rate limit.
+ */
+int HttpRequestScheduler::minimumRequestInterval(const QString& host) const
+{
+  return m_hosts.value(host).interval;
+}
+
+/**
+ * Enqueue the request of a client.
+ * The request of the client has to be set before calling this method.
+ * Pending requests of the client are replaced.
+ *
+ * @param client HTTP client
+ */
+void HttpRequestScheduler::enqueue(HttpClient* client)
+{
+  cancel(client, false);
+  const QString key = client->requestKey();
+  if (Request* request = m_requests.value(key)) {
+    // The same request is already pending or in flight, the response will
+    // be delivered to this client too.
+    if (request->leader != client) {
+      request->followers.append(client);
+      ++m_coalescedCount;
+    }
+    return;
+  }
+
+  Request* request = new Request;
+  request->leader = client;
+  m_requests.insert(key, request);
+  if (client->isResponseCached()) {
+    // Answered from the local cache, does not count for the rate limit.
+    request->id = ++m_lastRequestId;
+    request->started = true;
+    client->startRequest(request->id);
+    return;
+  }
+  addToQueue(request);
+  processQueues();
+}
+
+/**
+ * Remove a client from the scheduler.
+ * If the client sends a request for other clients, one of them will
+ * send it instead.
+ *
+ * @param client HTTP client
+ * @param inFlight true to also remove a request which has been sent
+ */
+void HttpRequestScheduler::cancel(HttpClient* client, bool inFlight)
+{
+  bool promoted = false;
+  QHash<QString, Request*>::iterator it = m_requests.begin();
+  while (it != m_requests.end()) {
+    Request* request = *it;
+    request->followers.removeAll(client);
+    if (request->leader == client && (!request->started || inFlight)) {
+      if (!request->started) {
+        for (QMap<QString, Host>::iterator hostIt = m_hosts.begin();
+             hostIt != m_hosts.end();
+             ++hostIt) {
+          hostIt->queue.removeAll(request);
+        }
+      }
+      HttpClient* newLeader = 0;
+      while (!newLeader && !request->followers.isEmpty()) {
+        newLeader = request->followers.takeFirst();
+      }
+      if (newLeader) {
+        request->leader = newLeader;
+        request->started = false;
+        addToQueue(request);
+        promoted = true;
+        ++it;
+      } else {
+        delete request;
+        it = m_requests.erase(it);
+      }
+    } else {
+      ++it;
+    }
+  }
+  if (promoted) {
+    m_timer->start(0);
+  }
+}
+
+/**
+ * Called by a client when the response to its request was received.
+ * The response is delivered to the clients with an identical request.
+ *
+ * Responses to requests which have been cancelled or taken over by
+ * another client are ignored.
+ *
+ * @param requestId ID passed to HttpClient::startRequest()
+ * @param data received data
+ * @param contentType content type
+ * @param contentLength content length
+ * @param msg state message
+ */
+void HttpRequestScheduler::requestFinished(
+    quint64 requestId, const QByteArray& data, const QString& contentType,
+    unsigned long contentLength, const QString& msg)
+{
+  QList<QPointer<HttpClient> > followers;
+  for (QHash<QString, Request*>::iterator it = m_requests.begin();
+       it != m_requests.end();
+       ++it) {
+    Request* request = *it;
+    if (request->id == requestId && request->started) {
+      followers = request->followers;
+      delete request;
+      m_requests.erase(it);
+      break;
+    }
+  }
+  foreach (const QPointer<HttpClient>& follower, followers) {
+    if (follower) {
+      follower->receiveResponse(data, contentType, contentLength, msg);
+    }
+  }
+}
+
+/**
+ * Add a request to the queue of the host of its leader.
+ * A new ID is assigned, so that responses to previous requests of the
+ * same or a previous leader are not taken for the response to this
+ * request.
+ * @param request request
+ */
+void HttpRequestScheduler::addToQueue(Request* request)
+{
+  HttpClient* client = request->leader;
+  request->id = ++m_lastRequestId;
+  QList<Request*>& queue = m_hosts[client->requestUrl().host()].queue;
+  int pos = queue.size();
+  for (int i = 0; i < queue.size(); ++i) {
+    if (queue.at(i)->leader->priority() < client->priority()) {
+      pos = i;
+      break;
+    }
+  }
+  queue.insert(pos, request);
+}
+
+/**
+ * Send queued requests for which tokens are available.
+ */
+void HttpRequestScheduler::processQueues()
+{
+  const qint64 now = m_clock.elapsed();
+  qint64 wait = -1;
+  typedef QPair<QPointer<HttpClient>, quint64> ClientRequestId;
+  QList<ClientRequestId> clientsToStart;
+  for (QMap<QString, Host>::iterator it = m_hosts.begin();
+       it != m_hosts.end();
+       ++it) {
+    Host& host = *it;
+    if (host.interval > 0) {
+      host.tokens = qMin<double>(
+            host.burst,
+            host.tokens + static_cast<double>(now - host.lastRefill) /
+            host.interval);
+    }
+    host.lastRefill = now;
+    while (!host.queue.isEmpty() &&
+           (host.interval <= 0 || host.tokens >= 1.0)) {
+      Request* request = host.queue.takeFirst();
+      if (host.interval > 0) {
+        host.tokens -= 1.0;
+      }
+      request->started = true;
+      clientsToStart.append(qMakePair(QPointer<HttpClient>(request->leader),
+                                      request->id));
+    }
+    if (!host.queue.isEmpty()) {
+      qint64 hostWait = qCeil((1.0 - host.tokens) * host.interval);
+      if (wait < 0 || hostWait < wait) {
+        wait = hostWait;
+      }
+    }
+  }
+  if (wait >= 0) {
+    m_timer->start(static_cast<int>(qMax<qint64>(wait, 1)));
+  }
+
+  // The requests are started after the queues have been processed because
+  // the signals emitted when starting can cause new requests to be enqueued.
+  foreach (const ClientRequestId& clientRequest, clientsToStart) {
+    if (HttpClient* client = clientRequest.first) {
+      client->startRequest(clientRequest.second);
+    }
+  }
+}
@@ -0,0 +1,192 @@
+/**
+ * \file httprequestscheduler.h
+ * Scheduler for HTTP requests with per host rate limits.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTTPREQUESTSCHEDULER_H
+#define HTTPREQUESTSCHEDULER_H
+
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QElapsedTimer>
+#include "kid3api.h"
+
+class QTimer;
+class HttpClient;
+
+/**
+ * Scheduler for the requests of all HTTP clients.
+ *
+ * Servers such as MusicBrainz and Discogs only allow a limited rate of
+ * requests. The scheduler keeps a token bucket for every host with a rate
+ * limit, a request is sent when a token is available, otherwise it waits
+ * in a queue ordered by priority. Requests to different hosts and to hosts
+ * without rate limit are sent concurrently.
+ *
+ * Identical requests of different clients are coalesced: while a request
+ * is pending or in flight, other clients requesting the same URL with the
+ * same headers do not send a request, they get a copy of the response.
+ * Requests which can be answered from the HttpResponseCache are sent
+ * without waiting for a token.
+ */
+class KID3_CORE_EXPORT HttpRequestScheduler : public QObject {
+  Q_OBJECT
+public:
+  /**
+   * Destructor.
+   */
+  virtual ~HttpRequestScheduler();
+
+  /**
+   * Get the scheduler.
+   * The scheduler is created on first use and deleted with the application
+   * object, it is not created again after it has been deleted.
+   * @return scheduler of the application, 0 if already deleted.
+   */
+  static HttpRequestScheduler* instance();
+
+  /**
+   * Set minimum interval between two requests to a host.
+   * @param host host name
+   * @param msec interval in milliseconds, 0 to disable the rate limit
+   * @param burst number of requests which may be sent without delay
+   *
+   * Requests waiting for the host are sent again according to the new
+   * rate limit.
+   */
+  void setMinimumRequestInterval(const QString& host, int msec, int burst = 1);
+
+  /**
+   * Get minimum interval between two requests to a host.
+   * @param host host name
+   * @return interval in milliseconds, 0 if host has no rate limit.
+   */
+  int minimumRequestInterval(const QString& host) const;
+
+  /**
+   * Get number of requests which were answered with the response to an
+   * identical request.
+   * @return number of coalesced requests.
+   */
+  quint64 coalescedCount() const { return m_coalescedCount; }
+
+private slots:
+  /**
+   * Send queued requests for which tokens are available.
+   */
+  void processQueues();
+
+private:
+  friend class HttpClient;
+
+  /** Request which is sent once for one or more clients. */
+  struct Request {
+    /** Constructor. */
+    Request() : leader(0), id(0), started(false) {}
+    HttpClient* leader;                   /**< client sending the request */
+    QList<QPointer<HttpClient> > followers; /**< clients getting a copy */
+    quint64 id;                           /**< ID passed to leader */
+    bool started;                         /**< true if request is sent */
+  };
+
+  /** Rate limit and queue of a host. */
+  struct Host {
+    /** Constructor. */
+    Host() : interval(0), burst(1), tokens(1.0), lastRefill(0) {}
+    int interval;        /**< milliseconds per token, 0 if unlimited */
+    int burst;           /**< maximum number of tokens */
+    double tokens;       /**< available tokens */
+    qint64 lastRefill;   /**< time of last refill */
+    QList<Request*> queue; /**< pending requests by leader priority */
+  };
+
+  /**
+   * Constructor.
+   * @param parent parent object
+   */
+  explicit HttpRequestScheduler(QObject* parent = 0);
+
+  /**
+   * Enqueue the request of a client.
+   * The request of the client has to be set before calling this method.
+   * Pending requests of the client are replaced.
+   *
+   * @param client HTTP client
+   */
+  void enqueue(HttpClient* client);
+
+  /**
+   * Remove a client from the scheduler.
+   * If the client sends a request for other clients, one of them will
+   * send it instead.
+   *
+   * @param client HTTP client
+   * @param inFlight true to also remove a request which has been sent
+   */
+  void cancel(HttpClient* client, bool inFlight);
+
+  /**
+   * Called by a client when the response to its request was received.
+   * The response is delivered to the clients with an identical request.
+   * Responses to requests which have been cancelled or taken over by
+   * another client are ignored.
+   *
+   * @param requestId ID passed to HttpClient::startRequest()
+   * @param data received data
+   * @param contentType content type
+   * @param contentLength content length
+   * @param msg state message
+   */
+  void requestFinished(quint64 requestId, const QByteArray& data,
+                       const QString& contentType, unsigned long contentLength,
+                       const QString& msg);
+
+  /**
+   * Add a request to the queue of the host of its leader.
+   * A new ID is assigned, so that responses to previous requests of the
+   * same or a previous leader are not taken for the response to this
+   * request.
+   * @param request request
+   */
+  void addToQueue(Request* request);
+
+  /** Scheduler instance, 0 if not created or deleted */
+  static HttpRequestScheduler* s_self;
+  /** true if the scheduler instance has been deleted */
+  static bool s_deleted;
+
+  QTimer* m_timer;
+  QElapsedTimer m_clock;
+  /** Hosts indexed by name */
+  QMap<QString, Host> m_hosts;
+  /** Pending and sent requests indexed by key */
+  QHash<QString, Request*> m_requests;
+  quint64 m_coalescedCount;
+  quint64 m_lastRequestId;
+};
+
+#endif // HTTPREQUESTSCHEDULER_H
@@ -0,0 +1,156 @@
+/**
+ * \file httpresponsecache.cpp
+ * Disk cache for HTTP responses.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "httpresponsecache.h"
+#include <QDateTime>
+
+namespace {
+
+/**
+ * Get the Cache-Control directives of a response.
+ * @param metaData meta data of response
+ * @return directives in lower case, including their values, e.g.
+ *         "max-age=0".
+ */
+QList<QByteArray> cacheControlDirectives(
+    const QNetworkCacheMetaData& metaData)
+{
+  QList<QByteArray> directives;
+  foreach (const QNetworkCacheMetaData::RawHeader& header,
+           metaData.rawHeaders()) {
+    if (header.first.toLower() == "cache-control") {
+      foreach (const QByteArray& directive, header.second.split(',')) {
+        directives.append(directive.trimmed().toLower());
+      }
+    }
+  }
+  return directives;
+}
+
+}
+
+/**
+ * Constructor.
+ * @param parent parent object
+ */
+HttpResponseCache::HttpResponseCache(QObject* parent)
+  : QNetworkDiskCache(parent), m_timeToLive(24 * 60 * 60)
+{
+  setObjectName(QLatin1String("HttpResponseCache"));
+}
+
+/**
+ * Destructor.
+ */
+HttpResponseCache::~HttpResponseCache()
+{
+}
+
+/**
+ * Check if a fresh response is available for a URL.
+ * Such a request can be answered without contacting the server.
+ *
+ * @param url URL
+ *
+ * @return true if the cached response has not expired.
+ */
+bool HttpResponseCache::isFresh(const QUrl& url)
+{
+  QNetworkCacheMetaData md = metaData(url);
+  return md.isValid() && md.expirationDate().isValid() &&
+      md.expirationDate() > QDateTime::currentDateTimeUtc();
+}
+
+/**
+ * Prepare storing a response.
+ * @param metaData meta data of response
+ * @return device to write the data to, 0 if not stored.
+ */
+QIODevice* HttpResponseCache::prepare(const QNetworkCacheMetaData& metaData)
+{
+  return QNetworkDiskCache::prepare(withTimeToLive(metaData));
+}
+
+/**
+ * Update meta data of a cached response, e.g. after it was revalidated.
+ * @param metaData meta data of response
+ */
+void HttpResponseCache::updateMetaData(const QNetworkCacheMetaData& metaData)
+{
+  QNetworkCacheMetaData md = withTimeToLive(metaData);
+  if (md.saveToDisk()) {
+    QNetworkDiskCache::updateMetaData(md);
+  } else {
+    // The revalidated response must no longer be stored.
+    remove(md.url());
+  }
+}
+
+/**
+ * Extend the expiration date to the time to live.
+ * The Cache-Control directives of the server are honored: Responses with
+ * "no-store" are not stored, responses with "no-cache" are always
+ * revalidated and responses with "max-age" expire after the given
+ * lifetime. Only responses without such directives get the time to live.
+ * @param metaData meta data of response
+ * @return meta data with adapted expiration date.
+ */
+QNetworkCacheMetaData HttpResponseCache::withTimeToLive(
+    const QNetworkCacheMetaData& metaData) const
+{
+  QNetworkCacheMetaData md(metaData);
+  if (!md.saveToDisk())
+    return md;
+
+  const QList<QByteArray> directives = cacheControlDirectives(md);
+  if (directives.contains("no-store")) {
+    md.setSaveToDisk(false);
+    return md;
+  }
+  if (directives.contains("no-cache")) {
+    md.setExpirationDate(QDateTime::currentDateTimeUtc());
+    return md;
+  }
+  foreach (const QByteArray& directive, directives) {
+    if (directive.startsWith("max-age=")) {
+      bool ok;
+      int maxAge = directive.mid(8).trimmed().toInt(&ok);
+      if (ok) {
+        md.setExpirationDate(
+              QDateTime::currentDateTimeUtc().addSecs(qMax(maxAge, 0)));
+        return md;
+      }
+    }
+  }
+  if (m_timeToLive > 0) {
+    QDateTime expiration =
+        QDateTime::currentDateTimeUtc().addSecs(m_timeToLive);
+    if (!md.expirationDate().isValid() || md.expirationDate() < expiration) {
+      md.setExpirationDate(expiration);
+    }
+  }
+  return md;
+}
@@ -0,0 +1,111 @@
+/**
+ * \file httpresponsecache.h
+ * Disk cache for HTTP responses.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTTPRESPONSECACHE_H
+#define HTTPRESPONSECACHE_H
+
+#include <QNetworkDiskCache>
+#include "kid3api.h"
+
+/**
+ * Size bounded disk cache for HTTP responses.
+ *
+ * The responses of the import servers usually do not contain expiration
+ * information, so they would have to be fetched again for every import.
+ * This cache keeps responses for a configurable time to live unless the
+ * server requests a longer lifetime. Cache-Control directives of the
+ * server are honored, "no-store" responses are not stored, "no-cache" and
+ * "max-age" responses are revalidated when they expire. When the
+ * time to live is over, the network access manager revalidates the entry
+ * using its ETag or Last-Modified header, so that unchanged data is not
+ * transferred again.
+ *
+ * The cache is installed on the network access manager shared by all
+ * importers and download clients. Responses are stored by URL, requests
+ * with credentials in their headers bypass the cache.
+ */
+class KID3_CORE_EXPORT HttpResponseCache : public QNetworkDiskCache {
+  Q_OBJECT
+public:
+  /**
+   * Constructor.
+   * @param parent parent object
+   */
+  explicit HttpResponseCache(QObject* parent = 0);
+
+  /**
+   * Destructor.
+   */
+  virtual ~HttpResponseCache();
+
+  /**
+   * Set time for which responses are used without revalidation.
+   * @param seconds time to live in seconds
+   */
+  void setTimeToLive(int seconds) { m_timeToLive = seconds; }
+
+  /**
+   * Get time for which responses are used without revalidation.
+   * @return time to live in seconds.
+   */
+  int timeToLive() const { return m_timeToLive; }
+
+  /**
+   * Check if a fresh response is available for a URL.
+   * Such a request can be answered without contacting the server.
+   *
+   * @param url URL
+   *
+   * @return true if the cached response has not expired.
+   */
+  bool isFresh(const QUrl& url);
+
+  /**
+   * Prepare storing a response.
+   * @param metaData meta data of response
+   * @return device to write the data to, 0 if not stored.
+   */
+  virtual QIODevice* prepare(const QNetworkCacheMetaData& metaData);
+
+  /**
+   * Update meta data of a cached response, e.g. after it was revalidated.
+   * @param metaData meta data of response
+   */
+  virtual void updateMetaData(const QNetworkCacheMetaData& metaData);
+
+private:
+  /**
+   * Extend the expiration date to the time to live.
+   * @param metaData meta data of response
+   * @return meta data with adapted expiration date.
+   */
+  QNetworkCacheMetaData withTimeToLive(
+      const QNetworkCacheMetaData& metaData) const;
+
+  int m_timeToLive;
+};
+
+#endif // HTTPRESPONSECACHE_H
@@ -200,11 +200,13 @@ void TextImporter::importFromTags(
 {
   ImportParser parser;
   parser.setFormat(extractionFormat);
+  const FormatReplacer::Template sourceTemplate =
+      TrackData::compileFormat(sourceFormat);
   for (ImportTrackDataVector::iterator it = trackDataVector.begin();
        it != trackDataVector.end();
        ++it) {
     if (it->isEnabled()) {
-      QString text(it->formatString(sourceFormat));
+      QString text(it->formatString(sourceTemplate));
       int pos = 0;
       parser.getNextTags(text, *it, pos);
     }
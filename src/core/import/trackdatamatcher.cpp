@@ -25,137 +25,356 @@
  */
 
 #include "trackdatamatcher.h"
-#include <QDir>
-#include <limits.h>
+#include <QHash>
+#include <limits>
 #include "trackdatamodel.h"
 
+namespace {
+
+/** Maximum duration difference distinguished when matching with length. */
+const int MaxLengthDiff = 24 * 60 * 60;
+/** Maximum duration difference distinguished when breaking ties. */
+const int MaxTieLengthDiff = 60 * 60;
+/** Maximum number of common words distinguished. */
+const int MaxCommonWords = 255;
+
 /**
- * Match import data with length.
- *
- * @param trackDataModel tracks to match
- * @param diffCheckEnable true if time difference check is enabled
- * @param maxDiff maximum allowed time difference
+ * Count the bits which are set.
+ * @param bits bit set
+ * @return number of one bits.
  */
-bool TrackDataMatcher::matchWithLength(TrackDataModel* trackDataModel,
-                                       bool diffCheckEnable, int maxDiff)
+inline int popCount(quint64 bits)
 {
-  struct MatchData {
-    int fileLen;      // length of file
-    int importLen;    // length of import
-    int assignedTo;   // number of file import is assigned to, -1 if not assigned
-    int assignedFrom; // number of import assigned to file, -1 if not assigned
-  };
+#if defined __GNUC__
+  return __builtin_popcountll(bits);
+#else
+  bits = bits - ((bits >> 1) & Q_UINT64_C(0x5555555555555555));
+  bits = (bits & Q_UINT64_C(0x3333333333333333)) +
+         ((bits >> 2) & Q_UINT64_C(0x3333333333333333));
+  bits = (bits + (bits >> 4)) & Q_UINT64_C(0x0f0f0f0f0f0f0f0f);
+  return static_cast<int>((bits * Q_UINT64_C(0x0101010101010101)) >> 56);
+#endif
+}
 
-  bool failed = false;
-  ImportTrackDataVector trackDataVector(trackDataModel->getTrackData());
-  const int numTracks = trackDataVector.size();
-  if (numTracks > 0) {
-    MatchData* md = new MatchData[numTracks];
-    int numFiles = 0, numImports = 0;
-    int i = 0;
-    for (ImportTrackDataVector::const_iterator it = trackDataVector.begin();
-         it != trackDataVector.end();
-         ++it) {
-      if (i >= numTracks) {
-        break;
-      }
-      md[i].fileLen = (*it).getFileDuration();
-      if (md[i].fileLen > 0) {
-        ++numFiles;
+/**
+ * Sets of words stored as bit sets over interned word IDs.
+ * All sets are added before build() is called, afterwards the number
+ * of common words of two sets can be counted without string comparisons.
+ */
+class WordBitSets {
+public:
+  /**
+   * Constructor.
+   */
+  WordBitSets() : m_numBlocks(0) {}
+
+  /**
+   * Add a set of words.
+   * @param words words
+   * @return index of set.
+   */
+  int add(const QSet<QString>& words) {
+    QVector<int> ids;
+    ids.reserve(words.size());
+    foreach (const QString& word, words) {
+      QHash<QString, int>::const_iterator it = m_wordIds.constFind(word);
+      if (it == m_wordIds.constEnd()) {
+        it = m_wordIds.insert(word, m_wordIds.size());
       }
-      md[i].importLen = (*it).getImportDuration();
-      if (md[i].importLen > 0) {
-        ++numImports;
+      ids.append(it.value());
+    }
+    m_ids.append(ids);
+    return m_ids.size() - 1;
+  }
+
+  /**
+   * Create the bit sets, has to be called after all sets have been added.
+   */
+  void build() {
+    m_numBlocks = (m_wordIds.size() + 63) / 64;
+    m_bits.fill(0, m_ids.size() * m_numBlocks);
+    quint64* bits = m_bits.data();
+    for (int i = 0; i < m_ids.size(); ++i) {
+      quint64* setBits = bits + i * m_numBlocks;
+      foreach (int id, m_ids.at(i)) {
+        setBits[id >> 6] |= Q_UINT64_C(1) << (id & 63);
       }
-      md[i].assignedTo = -1;
-      md[i].assignedFrom = -1;
-      // If time difference checking is enabled and the time difference
-      // is not larger then the allowed limit, do not reassign the track.
-      if (diffCheckEnable) {
-        if (md[i].fileLen != 0 && md[i].importLen != 0) {
-          int diff = md[i].fileLen > md[i].importLen ?
-            md[i].fileLen - md[i].importLen : md[i].importLen - md[i].fileLen;
-          if (diff <= maxDiff) {
-            md[i].assignedTo = i;
-            md[i].assignedFrom = i;
-          }
+    }
+  }
+
+  /**
+   * Count the words which are in two sets.
+   * @param set1 index of first set
+   * @param set2 index of second set
+   * @return number of common words.
+   */
+  int commonWords(int set1, int set2) const {
+    const quint64* bits1 = m_bits.constData() + set1 * m_numBlocks;
+    const quint64* bits2 = m_bits.constData() + set2 * m_numBlocks;
+    const QVector<int>& ids1 = m_ids.at(set1);
+    if (ids1.size() < m_numBlocks) {
+      // Probing the few words of a set is faster than scanning all blocks.
+      int count = 0;
+      for (QVector<int>::const_iterator it = ids1.constBegin();
+           it != ids1.constEnd();
+           ++it) {
+        if (bits2[*it >> 6] & (Q_UINT64_C(1) << (*it & 63))) {
+          ++count;
         }
       }
-      ++i;
+      return count;
+    }
+    int count = 0;
+    for (int i = 0; i < m_numBlocks; ++i) {
+      count += popCount(bits1[i] & bits2[i]);
     }
+    return count;
+  }
 
-    if (numFiles <= numImports) {
-      // more imports than files => first look through all imports
-      for (i = 0; i < numTracks; ++i) {
-        if (md[i].assignedFrom == -1) {
-          int bestTrack = -1;
-          int bestDiff = INT_MAX;
-          // Find the unassigned import with the best difference
-          for (int comparedTrack = 0; comparedTrack < numTracks; ++comparedTrack) {
-            if (md[comparedTrack].assignedTo == -1) {
-              int comparedDiff = md[i].fileLen > md[comparedTrack].importLen ?
-                md[i].fileLen - md[comparedTrack].importLen :
-                md[comparedTrack].importLen - md[i].fileLen;
-              if (comparedDiff < bestDiff) {
-                bestDiff = comparedDiff;
-                bestTrack = comparedTrack;
-              }
-            }
+private:
+  QHash<QString, int> m_wordIds;
+  QVector<QVector<int> > m_ids;
+  QVector<quint64> m_bits;
+  int m_numBlocks;
+};
+
+/**
+ * Solve the assignment problem with the Hungarian algorithm.
+ * @param cost n x n cost matrix, cost[row * n + column] is the cost of
+ *             assigning column to row
+ * @param n number of rows and columns
+ * @return column assigned to each row with minimum total cost.
+ */
+QVector<int> solveAssignment(const QVector<qint64>& cost, int n)
+{
+  // Potentials u, v and the matching p are 1-based, index 0 is used
+  // as a virtual column while augmenting.
+  const qint64 inf = std::numeric_limits<qint64>::max() / 4;
+  QVector<qint64> u(n + 1, 0), v(n + 1, 0), minv(n + 1);
+  QVector<int> p(n + 1, 0), way(n + 1, 0);
+  QVector<char> used(n + 1);
+  const qint64* c = cost.constData();
+  qint64* pu = u.data();
+  qint64* pv = v.data();
+  int* pp = p.data();
+  int* pway = way.data();
+  for (int i = 1; i <= n; ++i) {
+    pp[0] = i;
+    int j0 = 0;
+    minv.fill(inf);
+    used.fill(0);
+    qint64* pminv = minv.data();
+    char* pused = used.data();
+    do {
+      pused[j0] = 1;
+      const int i0 = pp[j0];
+      const qint64* row = c + (i0 - 1) * n - 1;
+      qint64 delta = inf;
+      int j1 = 0;
+      for (int j = 1; j <= n; ++j) {
+        if (!pused[j]) {
+          qint64 cur = row[j] - pu[i0] - pv[j];
+          if (cur < pminv[j]) {
+            pminv[j] = cur;
+            pway[j] = j0;
           }
-          if (bestTrack >= 0 && bestTrack < static_cast<int>(numTracks)) {
-            md[i].assignedFrom = bestTrack;
-            md[bestTrack].assignedTo = i;
-          } else {
-            qDebug("No match for track %d", i);
-            failed = true;
-            break;
+          if (pminv[j] < delta) {
+            delta = pminv[j];
+            j1 = j;
           }
         }
       }
-    } else {
-      // more files than imports => first look through all files
-      for (i = 0; i < numTracks; ++i) {
-        if (md[i].assignedTo == -1) {
-          int bestTrack = -1;
-          int bestDiff = INT_MAX;
-          // Find the unassigned file with the best difference
-          for (int comparedTrack = 0; comparedTrack < numTracks; ++comparedTrack) {
-            if (md[comparedTrack].assignedFrom == -1) {
-              int comparedDiff = md[comparedTrack].fileLen > md[i].importLen ?
-                md[comparedTrack].fileLen - md[i].importLen :
-                md[i].importLen - md[comparedTrack].fileLen;
-              if (comparedDiff < bestDiff) {
-                bestDiff = comparedDiff;
-                bestTrack = comparedTrack;
-              }
-            }
-          }
-          if (bestTrack >= 0 && bestTrack < static_cast<int>(numTracks)) {
-            md[i].assignedTo = bestTrack;
-            md[bestTrack].assignedFrom = i;
-          } else {
-            qDebug("No match for track %d", i);
-            failed = true;
-            break;
-          }
+      for (int j = 0; j <= n; ++j) {
+        if (pused[j]) {
+          pu[pp[j]] += delta;
+          pv[j] -= delta;
+        } else {
+          pminv[j] -= delta;
         }
       }
+      j0 = j1;
+    } while (pp[j0] != 0);
+    do {
+      const int j1 = pway[j0];
+      pp[j0] = pp[j1];
+      j0 = j1;
+    } while (j0);
+  }
+
+  QVector<int> assignment(n);
+  for (int j = 1; j <= n; ++j) {
+    assignment[pp[j] - 1] = j - 1;
+  }
+  return assignment;
+}
+
+/**
+ * Get absolute difference of two durations.
+ * @param duration1 first duration
+ * @param duration2 second duration
+ * @return difference.
+ */
+inline int durationDiff(int duration1, int duration2)
+{
+  return duration1 > duration2
+      ? duration1 - duration2 : duration2 - duration1;
+}
+
+/**
+ * Get track properties from track data.
+ * @param trackDataVector track data
+ * @return properties of tracks.
+ */
+QVector<TrackDataMatcher::TrackProperties> getTrackProperties(
+    const ImportTrackDataVector& trackDataVector)
+{
+  QVector<TrackDataMatcher::TrackProperties> tracks(trackDataVector.size());
+  TrackDataMatcher::TrackProperties* track = tracks.data();
+  for (ImportTrackDataVector::const_iterator it = trackDataVector.constBegin();
+       it != trackDataVector.constEnd();
+       ++it, ++track) {
+    track->fileWords = it->getFilenameWords();
+    track->titleWords = it->getTitleWords();
+    track->fileDuration = it->getFileDuration();
+    track->importDuration = it->getImportDuration();
+  }
+  return tracks;
+}
+
+/**
+ * Reorder imported data of tracks.
+ * @param trackDataModel track data model to update
+ * @param trackDataVector track data of model
+ * @param assignedFrom index of track whose imported data is assigned to
+ *                     each track
+ */
+void applyAssignment(TrackDataModel* trackDataModel,
+                     ImportTrackDataVector& trackDataVector,
+                     const QVector<int>& assignedFrom)
+{
+  ImportTrackDataVector oldTrackDataVector(trackDataVector);
+  for (int i = 0; i < trackDataVector.size(); ++i) {
+    trackDataVector[i].setFrameCollection(
+      oldTrackDataVector[assignedFrom.at(i)].getFrameCollection());
+    trackDataVector[i].setImportDuration(
+      oldTrackDataVector[assignedFrom.at(i)].getImportDuration());
+  }
+  trackDataModel->setTrackData(trackDataVector);
+}
+
+}
+
+/**
+ * Find the assignment of imported data to files with the best total match.
+ * Words are interned to integer IDs and stored as bit sets, the optimal
+ * assignment is found with the Hungarian algorithm in O(n^3).
+ *
+ * @param tracks properties of tracks
+ * @param criterion primary criterion, the other criterion is only used
+ *        to decide between assignments which are equally good
+ * @param maxDiff if not negative, tracks with known durations differing
+ *        by at most @a maxDiff seconds keep their imported data
+ *
+ * @return index of the track whose imported data is assigned to each track.
+ */
+QVector<int> TrackDataMatcher::findAssignment(
+    const QVector<TrackProperties>& tracks, MatchCriterion criterion,
+    int maxDiff)
+{
+  const int numTracks = tracks.size();
+  QVector<int> assignedFrom(numTracks, -1);
+
+  // Tracks which are already assigned keep their imported data, so the
+  // remaining rows and columns of the cost matrix are the same tracks.
+  QVector<int> freeTracks;
+  freeTracks.reserve(numTracks);
+  for (int i = 0; i < numTracks; ++i) {
+    const TrackProperties& track = tracks.at(i);
+    if (maxDiff >= 0 && track.fileDuration != 0 && track.importDuration != 0 &&
+        durationDiff(track.fileDuration, track.importDuration) <= maxDiff) {
+      assignedFrom[i] = i;
+    } else {
+      freeTracks.append(i);
     }
+  }
+  const int n = freeTracks.size();
+  if (n == 0) {
+    return assignedFrom;
+  }
 
-    if (!failed) {
-      ImportTrackDataVector oldTrackDataVector(trackDataVector);
-      for (i = 0; i < numTracks; ++i) {
-        trackDataVector[i].setFrameCollection(
-          oldTrackDataVector[md[i].assignedFrom].getFrameCollection());
-        trackDataVector[i].setImportDuration(
-          oldTrackDataVector[md[i].assignedFrom].getImportDuration());
+  WordBitSets words;
+  int maxWords = 0;
+  foreach (int i, freeTracks) {
+    words.add(tracks.at(i).fileWords);
+    maxWords = qMax(maxWords, qMin(tracks.at(i).fileWords.size(),
+                                   MaxCommonWords));
+  }
+  foreach (int i, freeTracks) {
+    words.add(tracks.at(i).titleWords);
+  }
+  words.build();
+
+  // The cost of an assignment combines the primary criterion, the
+  // secondary criterion and a penalty for moving imported data. Each term
+  // is scaled to be larger than the sum of all lower terms, so the lower
+  // terms only decide between assignments which are equal otherwise.
+  const qint64 maxSecondary = criterion == MatchTitle
+      ? MaxTieLengthDiff : maxWords;
+  const qint64 secondaryScale = n + 1;
+  const qint64 primaryScale = n * (maxSecondary * secondaryScale + 1) + 1;
+  QVector<qint64> cost(n * n);
+  qint64* c = cost.data();
+  for (int row = 0; row < n; ++row) {
+    const TrackProperties& file = tracks.at(freeTracks.at(row));
+    for (int col = 0; col < n; ++col) {
+      const TrackProperties& import = tracks.at(freeTracks.at(col));
+      const int wordCost = maxWords -
+          qMin(words.commonWords(row, n + col), MaxCommonWords);
+      qint64 primary, secondary;
+      if (criterion == MatchTitle) {
+        primary = wordCost;
+        secondary = file.fileDuration != 0 && import.importDuration != 0
+            ? qMin(durationDiff(file.fileDuration, import.importDuration),
+                   MaxTieLengthDiff)
+            : MaxTieLengthDiff;
+      } else {
+        primary = qMin(durationDiff(file.fileDuration, import.importDuration),
+                       MaxLengthDiff);
+        secondary = wordCost;
       }
-      trackDataModel->setTrackData(trackDataVector);
+      *c++ = primary * primaryScale + secondary * secondaryScale +
+          (row != col ? 1 : 0);
     }
+  }
 
-    delete [] md;
+  const QVector<int> assignment = solveAssignment(cost, n);
+  for (int row = 0; row < n; ++row) {
+    assignedFrom[freeTracks.at(row)] = freeTracks.at(assignment.at(row));
   }
-  return !failed;
+  return assignedFrom;
+}
+
+/**
+ * Match import data with length.
+ *
+ * @param trackDataModel tracks to match
+ * @param diffCheckEnable true if time difference check is enabled
+ * @param maxDiff maximum allowed time difference
+ */
+bool TrackDataMatcher::matchWithLength(TrackDataModel* trackDataModel,
+                                       bool diffCheckEnable, int maxDiff)
+{
+  ImportTrackDataVector trackDataVector(trackDataModel->getTrackData());
+  if (!trackDataVector.isEmpty()) {
+    // If time difference checking is enabled and the time difference
+    // is not larger then the allowed limit, do not reassign the track.
+    applyAssignment(trackDataModel, trackDataVector,
+                    findAssignment(getTrackProperties(trackDataVector),
+                                   MatchLength,
+                                   diffCheckEnable && maxDiff >= 0
+                                   ? maxDiff : -1));
+  }
+  return true;
 }
 
 /**
@@ -252,106 +471,11 @@ bool TrackDataMatcher::matchWithTrack(TrackDataModel* trackDataModel)
  */
 bool TrackDataMatcher::matchWithTitle(TrackDataModel* trackDataModel)
 {
-  struct MatchData {
-    QSet<QString> fileWords;  // words in file name
-    QSet<QString> titleWords; // words in title
-    int assignedTo;   // number of file import is assigned to, -1 if not assigned
-    int assignedFrom; // number of import assigned to file, -1 if not assigned
-  };
-
-  bool failed = false;
   ImportTrackDataVector trackDataVector(trackDataModel->getTrackData());
-  const int numTracks = trackDataVector.size();
-  if (numTracks > 0) {
-    MatchData* md = new MatchData[numTracks];
-    int numFiles = 0, numImports = 0;
-    int i = 0;
-    for (ImportTrackDataVector::const_iterator it = trackDataVector.begin();
-         it != trackDataVector.end();
-         ++it) {
-      if (i >= numTracks) {
-        break;
-      }
-      md[i].fileWords = it->getFilenameWords();
-      if (!md[i].fileWords.isEmpty()) {
-        ++numFiles;
-      }
-      md[i].titleWords = it->getTitleWords();
-      if (!md[i].titleWords.isEmpty()) {
-        ++numImports;
-      }
-      md[i].assignedTo = -1;
-      md[i].assignedFrom = -1;
-      ++i;
-    }
-
-    if (numFiles <= numImports) {
-      // more imports than files => first look through all imports
-      for (i = 0; i < numTracks; ++i) {
-        if (md[i].assignedFrom == -1) {
-          int bestTrack = -1;
-          int bestMatch = -1;
-          // Find the unassigned import with the best match
-          for (int comparedTrack = 0; comparedTrack < numTracks; ++comparedTrack) {
-            if (md[comparedTrack].assignedTo == -1) {
-              int comparedMatch =
-                  (md[i].fileWords & md[comparedTrack].titleWords).size();
-              if (comparedMatch > bestMatch) {
-                bestMatch = comparedMatch;
-                bestTrack = comparedTrack;
-              }
-            }
-          }
-          if (bestTrack >= 0 && bestTrack < static_cast<int>(numTracks)) {
-            md[i].assignedFrom = bestTrack;
-            md[bestTrack].assignedTo = i;
-          } else {
-            qDebug("No match for track %d", i);
-            failed = true;
-            break;
-          }
-        }
-      }
-    } else {
-      // more files than imports => first look through all files
-      for (i = 0; i < numTracks; ++i) {
-        if (md[i].assignedTo == -1) {
-          int bestTrack = -1;
-          int bestMatch = -1;
-          // Find the unassigned file with the best match
-          for (int comparedTrack = 0; comparedTrack < numTracks; ++comparedTrack) {
-            if (md[comparedTrack].assignedFrom == -1) {
-              int comparedMatch =
-                  (md[comparedTrack].fileWords & md[i].titleWords).size();
-              if (comparedMatch > bestMatch) {
-                bestMatch = comparedMatch;
-                bestTrack = comparedTrack;
-              }
-            }
-          }
-          if (bestTrack >= 0 && bestTrack < static_cast<int>(numTracks)) {
-            md[i].assignedTo = bestTrack;
-            md[bestTrack].assignedFrom = i;
-          } else {
-            qDebug("No match for track %d", i);
-            failed = true;
-            break;
-          }
-        }
-      }
-    }
-    if (!failed) {
-      ImportTrackDataVector oldTrackDataVector(trackDataVector);
-      for (i = 0; i < numTracks; ++i) {
-        trackDataVector[i].setFrameCollection(
-          oldTrackDataVector[md[i].assignedFrom].getFrameCollection());
-        trackDataVector[i].setImportDuration(
-          oldTrackDataVector[md[i].assignedFrom].getImportDuration());
-      }
-      trackDataModel->setTrackData(trackDataVector);
-    }
-
-    delete [] md;
+  if (!trackDataVector.isEmpty()) {
+    applyAssignment(trackDataModel, trackDataVector,
+                    findAssignment(getTrackProperties(trackDataVector),
+                                   MatchTitle));
   }
-  return !failed;
+  return true;
 }
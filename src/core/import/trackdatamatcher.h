@@ -27,6 +27,9 @@
 #ifndef TRACKDATAMATCHER_H
 #define TRACKDATAMATCHER_H
 
+#include <QSet>
+#include <QString>
+#include <QVector>
 #include "kid3api.h"
 
 class TrackDataModel;
@@ -36,6 +39,44 @@ class TrackDataModel;
  */
 namespace TrackDataMatcher {
 
+/** Criterion used to assign imported data to files. */
+enum MatchCriterion {
+  MatchLength, /**< duration, title words are used to break ties */
+  MatchTitle   /**< title words, duration is used to break ties */
+};
+
+/**
+ * Properties of a track used to match the file with imported data.
+ */
+struct TrackProperties {
+  /**
+   * Constructor.
+   */
+  TrackProperties() : fileDuration(0), importDuration(0) {}
+
+  QSet<QString> fileWords;  /**< lower case words in file name */
+  QSet<QString> titleWords; /**< lower case words in imported title */
+  int fileDuration;         /**< duration of file in seconds, 0 if unknown */
+  int importDuration;       /**< imported duration in seconds, 0 if unknown */
+};
+
+/**
+ * Find the assignment of imported data to files with the best total match.
+ * Words are interned to integer IDs and stored as bit sets, the optimal
+ * assignment is found with the Hungarian algorithm in O(n^3).
+ *
+ * @param tracks properties of tracks
+ * @param criterion primary criterion, the other criterion is only used
+ *        to decide between assignments which are equally good
+ * @param maxDiff if not negative, tracks with known durations differing
+ *        by at most @a maxDiff seconds keep their imported data
+ *
+ * @return index of the track whose imported data is assigned to each track.
+ */
+QVector<int> KID3_CORE_EXPORT findAssignment(
+    const QVector<TrackProperties>& tracks, MatchCriterion criterion,
+    int maxDiff = -1);
+
 /**
  * Match import data with length.
  *
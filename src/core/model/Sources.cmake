@@ -23,10 +23,13 @@ set(model_SRCS
   model/trackdatamodel.cpp
   model/checkablestringlistmodel.cpp
   model/tagsearcher.cpp
+  model/tagsearchindex.cpp
   model/timeeventmodel.cpp
   model/eventtimingcode.cpp
   model/tracknumbervalidator.cpp
   model/taggedfileselection.cpp
+  model/tagreaderpool.cpp
+  model/tagwriterpool.cpp
   model/genremodel.cpp
   model/pixmapprovider.cpp
   model/frameeditorobject.cpp
@@ -37,7 +37,7 @@
 BiDirFileProxyModelIterator::BiDirFileProxyModelIterator(FileProxyModel* model,
                                                          QObject *parent) :
   QObject(parent), m_model(model), m_backwards(false),
-  m_aborted(false), m_suspended(false)
+  m_aborted(false), m_suspended(false), m_prefetchTags(false)
 {
 }
 
@@ -183,6 +183,15 @@ void BiDirFileProxyModelIterator::fetchNext()
         return;
       }
       m_currentIndex = next;
+      if (m_prefetchTags && !m_backwards) {
+        // Read the following siblings in the background.
+        QModelIndex parent = next.parent();
+        int lastRow = qMin(next.row() + m_model->tagPrefetchWindowSize(),
+                           m_model->rowCount(parent) - 1);
+        for (int row = next.row() + 1; row <= lastRow; ++row) {
+          m_model->prefetchTaggedFile(m_model->index(row, 0, parent));
+        }
+      }
       emit nextReady(m_currentIndex);
     } else {
       break;
@@ -99,6 +99,16 @@ public:
     m_backwards = backwards;
   }
 
+  /**
+   * Enable reading the tags of the next files in the background.
+   * This should be set if the tags of the files are read when nextReady()
+   * is emitted.
+   *
+   * @param prefetchTags true to read tags of the next siblings in the tag
+   * reader pool of the model
+   */
+  void setPrefetchTags(bool prefetchTags) { m_prefetchTags = prefetchTags; }
+
   /**
    * Start iteration.
    */
@@ -141,6 +151,7 @@ private:
   bool m_backwards;
   bool m_aborted;
   bool m_suspended;
+  bool m_prefetchTags;
 };
 
 #endif // FILEPROXYMODELITERATOR_H
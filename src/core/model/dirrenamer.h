@@ -82,7 +82,9 @@ public:
    * Set format to generate directory names.
    * @param format format
    */
-  void setFormat(const QString& format) { m_format = format; }
+  void setFormat(const QString& format) {
+    m_format = TrackData::compileFilenameFormat(format, true);
+  }
 
   /**
    * Generate new directory name according to current settings.
@@ -295,7 +297,7 @@ private:
 
   RenameActionList m_actions;
   Frame::TagVersion m_tagVersion;
-  QString m_format;
+  FormatReplacer::Template m_format;
   QString m_dirName;
   bool m_aborted;
   bool m_actionCreate;
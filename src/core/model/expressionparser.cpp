@@ -148,7 +148,7 @@ void ExpressionParser::tokenizeRpn(const QString& expr)
  *
  * @return true if ok.
  */
-static bool stringToBool(const QString& str, bool& b)
+bool ExpressionParser::stringToBool(const QString& str, bool& b)
 {
   if (str == QLatin1String("1") || str == QLatin1String("true") || str == QLatin1String("on") || str == QLatin1String("yes")) {
     b = true;
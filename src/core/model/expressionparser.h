@@ -103,6 +103,31 @@ public:
    */
   bool popBool(bool& var);
 
+  /**
+   * Get the tokens of the expression in reverse polish notation.
+   * @return tokens set by tokenizeRpn().
+   */
+  const QStringList& getRpnTokens() const { return m_rpnStack; }
+
+  /**
+   * Check if a token is an operator.
+   * @param token token from getRpnTokens()
+   * @return true if @a token is an operator, including not, and, or.
+   */
+  bool isOperator(const QString& token) const {
+    return m_operators.contains(token);
+  }
+
+  /**
+   * Convert a string to a boolean.
+   *
+   * @param str string
+   * @param b   the boolean is returned here
+   *
+   * @return true if ok.
+   */
+  static bool stringToBool(const QString& str, bool& b);
+
 private:
   /**
    * Compare operator priority.
@@ -26,13 +26,107 @@
 
 #include "filefilter.h"
 #include "taggedfile.h"
-#if QT_VERSION >= 0x050100
-#include <QRegularExpression>
-#else
-#include <QRegExp>
-#endif
 #include <QCoreApplication>
 
+namespace {
+
+/**
+ * Format replacer providing access to the replacement of single codes.
+ */
+class FilterFormatReplacer : public TrackDataFormatReplacer {
+public:
+  /**
+   * Constructor.
+   * @param trackData track data
+   */
+  explicit FilterFormatReplacer(const TrackData& trackData)
+    : TrackDataFormatReplacer(trackData) {}
+
+  /**
+   * Get replacement for a format code.
+   * @param code format code without leading '%'
+   * @return replacement string, null if code not found.
+   */
+  QString getCodeReplacement(const QString& code) const {
+    return getReplacement(code);
+  }
+};
+
+}
+
+/**
+ * Track data of a file used while evaluating the filter for it.
+ * The track data for a tag version is only fetched from the file when
+ * a format code referencing it is evaluated.
+ */
+class FileFilter::EvaluationContext : public FormatReplacer {
+public:
+  /**
+   * Constructor.
+   * @param taggedFile file to check
+   */
+  explicit EvaluationContext(TaggedFile& taggedFile)
+    : m_taggedFile(taggedFile) {
+    for (int i = 0; i < NumTrackData; ++i) {
+      m_trackData[i] = 0;
+    }
+  }
+
+  /**
+   * Destructor.
+   */
+  ~EvaluationContext() {
+    for (int i = 0; i < NumTrackData; ++i) {
+      delete m_trackData[i];
+    }
+  }
+
+protected:
+  /**
+   * Get replacement for a format code using tag 2 and tag 1.
+   * @param code format code without leading '%'
+   * @return replacement string, null if code not found.
+   */
+  virtual QString getReplacement(const QString& code) const {
+    return getTrackDataReplacement(Frame::TagV2V1, code);
+  }
+
+  /**
+   * Get replacement for a format code of "%1c" or "%2c".
+   * @param tagNumber 1 for tag 1, 2 for tag 2
+   * @param code format code without leading '%' and tag number
+   * @return replacement string, null if code not found.
+   */
+  virtual QString getTagReplacement(int tagNumber, const QString& code) const {
+    return getTrackDataReplacement(
+          tagNumber == 1 ? Frame::TagV1 : Frame::TagV2, code);
+  }
+
+private:
+  Q_DISABLE_COPY(EvaluationContext)
+
+  /** Number of track data entries, indexed by tag version. */
+  enum { NumTrackData = Frame::TagV2V1 + 1 };
+
+  /**
+   * Get replacement for a format code.
+   * @param tagVersion tags used for replacement, TagV1, TagV2 or TagV2V1
+   * @param code format code without leading '%'
+   * @return replacement string, null if code not found.
+   */
+  QString getTrackDataReplacement(Frame::TagVersion tagVersion,
+                                  const QString& code) const {
+    ImportTrackData*& trackData = m_trackData[tagVersion & Frame::TagV2V1];
+    if (!trackData) {
+      trackData = new ImportTrackData(m_taggedFile, tagVersion);
+    }
+    return FilterFormatReplacer(*trackData).getCodeReplacement(code);
+  }
+
+  TaggedFile& m_taggedFile;
+  mutable ImportTrackData* m_trackData[NumTrackData];
+};
+
 /**
  * Constructor.
  * @param parent parent object
@@ -41,7 +135,7 @@ FileFilter::FileFilter(QObject* parent) : QObject(parent),
   m_parser(QStringList() << QLatin1String("equals")
                          << QLatin1String("contains")
                          << QLatin1String("matches")),
-  m_aborted(false)
+  m_rootNode(-1), m_compileError(false), m_aborted(false)
 {
 }
 
@@ -54,43 +148,136 @@ FileFilter::~FileFilter()
 
 /**
  * Initialize the parser.
- * This method has to be called before the first call to parse()
- * and afterwards when the expression has been changed.
+ * This method has to be called before the first call to filter()
+ * and afterwards when the expression has been changed. The expression
+ * is compiled into a tree which is then evaluated for every file.
  */
 void FileFilter::initParser()
 {
   m_parser.tokenizeRpn(m_filterExpression);
+  m_compileError = !compile();
 }
 
 /**
- * Format a string from tag data.
- *
- * @param format format specification
- *
- * @return formatted string.
+ * Compile the tokens of the parser into m_nodes.
+ * @return true if ok, false if the expression is invalid.
  */
-QString FileFilter::formatString(const QString& format)
+bool FileFilter::compile()
 {
-  if (format.indexOf(QLatin1Char('%')) == -1) {
-    return format;
+  m_nodes.clear();
+  m_rootNode = -1;
+
+  QVector<int> stack;
+  foreach (const QString& token, m_parser.getRpnTokens()) {
+    if (token == QLatin1String("and") || token == QLatin1String("or")) {
+      if (stack.size() < 2)
+        return false;
+      Node node(token == QLatin1String("and") ? And : Or);
+      node.rhs = stack.last();
+      stack.removeLast();
+      node.lhs = stack.last();
+      stack.removeLast();
+      if (!convertToBoolNode(node.rhs) || !convertToBoolNode(node.lhs))
+        return false;
+      stack.append(m_nodes.size());
+      m_nodes.append(node);
+    } else if (token == QLatin1String("not")) {
+      if (stack.isEmpty())
+        return false;
+      Node node(Not);
+      node.lhs = stack.last();
+      stack.removeLast();
+      if (!convertToBoolNode(node.lhs))
+        return false;
+      stack.append(m_nodes.size());
+      m_nodes.append(node);
+    } else if (m_parser.isOperator(token)) {
+      if (stack.size() < 2)
+        return false;
+      Node node(token == QLatin1String("equals") ? Equals
+              : token == QLatin1String("contains") ? Contains : Matches);
+      node.rhs = stack.last();
+      stack.removeLast();
+      node.lhs = stack.last();
+      stack.removeLast();
+      const Node& pattern = m_nodes.at(node.rhs);
+      if (node.type == Matches && pattern.type == StringOperand &&
+          !pattern.hasCodes) {
+        // Constant regular expression, compile it only once.
+        node.regExp.setPattern(pattern.token);
+#if QT_VERSION >= 0x050400
+        node.regExp.optimize();
+#endif
+        node.hasRegExp = true;
+      }
+      stack.append(m_nodes.size());
+      m_nodes.append(node);
+    } else {
+      Node node(StringOperand);
+      node.token = token;
+      if (token.indexOf(QLatin1Char('%')) != -1) {
+        node.format = compileFormat(token);
+        node.hasCodes = true;
+      }
+      stack.append(m_nodes.size());
+      m_nodes.append(node);
+    }
   }
-  QString str(format);
-  str.replace(QLatin1String("%1"), QLatin1String("\v1"));
-  str.replace(QLatin1String("%2"), QLatin1String("\v2"));
-  str = m_trackData12.formatString(str);
-  if (str.indexOf(QLatin1Char('\v')) != -1) {
-    str.replace(QLatin1String("\v2"), QLatin1String("%"));
-    str = m_trackData2.formatString(str);
-    if (str.indexOf(QLatin1Char('\v')) != -1) {
-      str.replace(QLatin1String("\v1"), QLatin1String("%"));
-      str = m_trackData1.formatString(str);
+
+  if (!stack.isEmpty()) {
+    // A string result which is not a boolean makes the filter fail without
+    // an error.
+    int top = stack.last();
+    if (m_nodes.at(top).type != StringOperand || convertToBoolNode(top)) {
+      m_rootNode = top;
     }
   }
-  return str;
+  return true;
+}
+
+/**
+ * Compile a string operand with format codes.
+ * @param token string operand
+ * @return compiled format.
+ */
+FormatReplacer::Template FileFilter::compileFormat(const QString& token)
+{
+  // Format codes can be preceded by a tag number, "%1a" is replaced with
+  // the artist from tag 1, "%2a" with the artist from tag 2.
+  ImportTrackData noTrackData;
+  FilterFormatReplacer unescaper(noTrackData);
+  unescaper.setString(token);
+  unescaper.replaceEscapedChars();
+  return FormatReplacer::Template(unescaper.getString(),
+                                  FormatReplacer::FSF_SupportHtmlEscape |
+                                  FormatReplacer::FSF_SupportTagNumber);
 }
 
 /**
- * Get help text for format codes supported by formatString().
+ * Make sure that a node has a boolean value.
+ * String operands which can be converted to a boolean are replaced by
+ * a constant.
+ * @param nodeIndex index of node
+ * @return true if ok, false if node cannot be used as a boolean.
+ */
+bool FileFilter::convertToBoolNode(int nodeIndex)
+{
+  Node& node = m_nodes[nodeIndex];
+  if (node.type != StringOperand)
+    return true;
+
+  // Like in ExpressionParser, operands of boolean operations are not
+  // formatted.
+  bool value;
+  if (!ExpressionParser::stringToBool(node.token, value))
+    return false;
+  node = Node(BoolConstant);
+  node.value = value;
+  return true;
+}
+
+/**
+ * Get help text for format codes supported in filter expressions.
  *
  * @param onlyRows if true only the tr elements are returned,
  *                 not the surrounding table
@@ -156,64 +343,94 @@ QString FileFilter::getFormatToolTip(bool onlyRows)
 }
 
 /**
- * Evaluate the expression to a boolean result.
- * @see initParser()
- * @return result of expression.
+ * Evaluate a node to a boolean result.
+ * @param nodeIndex index of node
+ * @param ctx evaluation context
+ * @return result of node.
  */
-bool FileFilter::parse()
+bool FileFilter::evaluateBool(int nodeIndex, EvaluationContext& ctx) const
 {
-  QString op, var1, var2;
-  bool result = false;
-  m_parser.clearEvaluation();
-  while (m_parser.evaluate(op, var1, var2)) {
-    var1 = formatString(var1);
-    var2 = formatString(var2);
-    if (op == QLatin1String("equals")) {
-      m_parser.pushBool(var1 == var2);
-    } else if (op == QLatin1String("contains")) {
-      m_parser.pushBool(var2.indexOf(var1) >= 0);
-    } else if (op == QLatin1String("matches")) {
-      m_parser.pushBool(
+  const Node& node = m_nodes.at(nodeIndex);
+  switch (node.type) {
+  case BoolConstant:
+    return node.value;
+  case StringOperand:
+    // Not reached, string operands are converted to constants by compile().
+    return false;
+  case Equals:
+    return evaluateString(node.lhs, ctx) == evaluateString(node.rhs, ctx);
+  case Contains:
+    return evaluateString(node.lhs, ctx).indexOf(
+          evaluateString(node.rhs, ctx)) >= 0;
+  case Matches:
+  {
+    const QString str = evaluateString(node.lhs, ctx);
 #if QT_VERSION >= 0x050100
-            QRegularExpression(var1).match(var2).hasMatch()
+    if (node.hasRegExp) {
+      return node.regExp.match(str).hasMatch();
+    }
+    return QRegularExpression(evaluateString(node.rhs, ctx))
+        .match(str).hasMatch();
 #else
-            QRegExp(var1).indexIn(var2) != -1
+    // QRegExp stores the match state, so a copy is used to keep the filter
+    // constant.
+    QRegExp re(node.hasRegExp ? node.regExp
+                              : QRegExp(evaluateString(node.rhs, ctx)));
+    return re.indexIn(str) != -1;
 #endif
-            );
-    }
   }
-  if (!m_parser.hasError()) {
-    m_parser.popBool(result);
+  case And:
+    return evaluateBool(node.lhs, ctx) && evaluateBool(node.rhs, ctx);
+  case Or:
+    return evaluateBool(node.lhs, ctx) || evaluateBool(node.rhs, ctx);
+  case Not:
+    return !evaluateBool(node.lhs, ctx);
   }
-  return result;
+  return false;
+}
+
+/**
+ * Evaluate a node to a string.
+ * @param nodeIndex index of node
+ * @param ctx evaluation context
+ * @return string value of node, "1" or "0" for boolean nodes.
+ */
+QString FileFilter::evaluateString(int nodeIndex, EvaluationContext& ctx) const
+{
+  const Node& node = m_nodes.at(nodeIndex);
+  if (node.type != StringOperand) {
+    return evaluateBool(nodeIndex, ctx)
+        ? QLatin1String("1") : QLatin1String("0");
+  }
+  return node.hasCodes ? ctx.format(node.format) : node.token;
 }
 
 /**
  * Check if file passes through filter.
+ * The filter is not modified, so multiple files can be checked
+ * concurrently once initParser() has been called.
  *
  * @param taggedFile file to check
  * @param ok         if not 0, false is returned here when parsing fails
  *
  * @return true if file passes through filter.
  */
-bool FileFilter::filter(TaggedFile& taggedFile, bool* ok)
+bool FileFilter::filter(TaggedFile& taggedFile, bool* ok) const
 {
   if (m_filterExpression.isEmpty()) {
     if (ok) *ok = true;
     return true;
   }
-  m_trackData1 = ImportTrackData(taggedFile, Frame::TagV1);
-  m_trackData2 = ImportTrackData(taggedFile, Frame::TagV2);
-  m_trackData12 = ImportTrackData(taggedFile, Frame::TagV2V1);
-
-  bool result = parse();
-  if (m_parser.hasError()) {
+  if (m_compileError) {
     if (ok) *ok = false;
     return false;
-  } else {
-    if (ok) *ok = true;
-    return result;
   }
+  if (ok) *ok = true;
+  if (m_rootNode < 0) {
+    return false;
+  }
+  EvaluationContext ctx(taggedFile);
+  return evaluateBool(m_rootNode, ctx);
 }
 
 /**
@@ -32,6 +32,12 @@
 #include "iabortable.h"
 #include <QObject>
 #include <QString>
+#include <QVector>
+#if QT_VERSION >= 0x050100
+#include <QRegularExpression>
+#else
+#include <QRegExp>
+#endif
 
 class TaggedFile;
 
@@ -75,20 +81,23 @@ public:
 
   /**
    * Initialize the parser.
-   * This method has to be called before the first call to parse()
-   * and afterwards when the expression has been changed.
+   * This method has to be called before the first call to filter()
+   * and afterwards when the expression has been changed. The expression
+   * is compiled into a tree which is then evaluated for every file.
    */
   void initParser();
 
   /**
    * Check if file passes through filter.
+   * The filter is not modified, so multiple files can be checked
+   * concurrently once initParser() has been called.
    *
    * @param taggedFile file to check
    * @param ok         if not 0, false is returned here when parsing fails
    *
    * @return true if file passes through filter.
    */
-  bool filter(TaggedFile& taggedFile, bool* ok = 0);
+  bool filter(TaggedFile& taggedFile, bool* ok = 0) const;
 
   /**
    * Clear abort flag.
@@ -102,7 +111,7 @@ public:
   virtual bool isAborted() const;
 
   /**
-   * Get help text for format codes supported by formatString().
+   * Get help text for format codes supported in filter expressions.
    *
    * @param onlyRows if true only the tr elements are returned,
    *                 not the surrounding table
@@ -118,27 +127,80 @@ public slots:
   virtual void abort();
 
 private:
+  class EvaluationContext;
+
+  /** Type of node in compiled expression. */
+  enum NodeType {
+    BoolConstant, StringOperand, Equals, Contains, Matches, And, Or, Not
+  };
+
   /**
-   * Format a string from tag data.
-   *
-   * @param format format specification
-   *
-   * @return formatted string.
+   * Node in compiled expression.
+   */
+  struct Node {
+    /** Constructor. */
+    explicit Node(NodeType t = BoolConstant)
+      : type(t), lhs(-1), rhs(-1), value(false), hasCodes(false),
+        hasRegExp(false) {}
+
+    NodeType type;      /**< type of node */
+    int lhs;            /**< index of left operand node, -1 if none */
+    int rhs;            /**< index of right operand node, -1 if none */
+    bool value;         /**< value of BoolConstant */
+    QString token;      /**< token of StringOperand */
+    bool hasCodes;      /**< true if token of StringOperand is formatted */
+    FormatReplacer::Template format; /**< compiled token if hasCodes */
+#if QT_VERSION >= 0x050100
+    QRegularExpression regExp; /**< precompiled constant regexp of Matches */
+#else
+    QRegExp regExp;     /**< precompiled constant regexp of Matches */
+#endif
+    bool hasRegExp;     /**< true if regExp is used */
+  };
+
+  /**
+   * Compile the tokens of the parser into m_nodes.
+   * @return true if ok, false if the expression is invalid.
+   */
+  bool compile();
+
+  /**
+   * Compile a string operand with format codes.
+   * @param token string operand
+   * @return compiled format.
+   */
+  static FormatReplacer::Template compileFormat(const QString& token);
+
+  /**
+   * Make sure that a node has a boolean value.
+   * String operands which can be converted to a boolean are replaced by
+   * a constant.
+   * @param nodeIndex index of node
+   * @return true if ok, false if node cannot be used as a boolean.
+   */
+  bool convertToBoolNode(int nodeIndex);
+
+  /**
+   * Evaluate a node to a boolean result.
+   * @param nodeIndex index of node
+   * @param ctx evaluation context
+   * @return result of node.
    */
-  QString formatString(const QString& format);
+  bool evaluateBool(int nodeIndex, EvaluationContext& ctx) const;
 
   /**
-   * Evaluate the expression to a boolean result.
-   * @see initParser()
-   * @return result of expression.
+   * Evaluate a node to a string.
+   * @param nodeIndex index of node
+   * @param ctx evaluation context
+   * @return string value of node, "1" or "0" for boolean nodes.
    */
-  bool parse();
+  QString evaluateString(int nodeIndex, EvaluationContext& ctx) const;
 
   QString m_filterExpression;
   ExpressionParser m_parser;
-  ImportTrackData m_trackData1;
-  ImportTrackData m_trackData2;
-  ImportTrackData m_trackData12;
+  QVector<Node> m_nodes;
+  int m_rootNode;
+  bool m_compileError;
   bool m_aborted;
 };
 
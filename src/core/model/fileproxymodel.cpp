@@ -27,7 +27,14 @@
 #include "fileproxymodel.h"
 #include <QFileSystemModel>
 #include <QTimer>
+#include "operationprofiler.h"
 #include "taggedfileiconprovider.h"
+#include "tagreaderpool.h"
+#include "tagcache.h"
+#include "cachedtaggedfile.h"
+#include "tagsearchindex.h"
+#include "directoryscanner.h"
+#include "directorywatcher.h"
 #include "itaggedfilefactory.h"
 #include "tagconfig.h"
 #include "config.h"
@@ -68,9 +75,12 @@ QHash<int,QByteArray> getRoleHash()
  * @param parent parent object
  */
 FileProxyModel::FileProxyModel(QObject* parent) : QSortFilterProxyModel(parent),
-  m_iconProvider(new TaggedFileIconProvider), m_fsModel(0),
+  m_iconProvider(new TaggedFileIconProvider),
+  m_tagReaderPool(new TagReaderPool(this)), m_tagCache(new TagCache),
+  m_tagSearchIndex(new TagSearchIndex),
+  m_directoryWatcher(new DirectoryWatcher(this)), m_fsModel(0),
   m_loadTimer(new QTimer(this)), m_sortTimer(new QTimer(this)),
-  m_numModifiedFiles(0), m_isLoading(false)
+  m_numModifiedFiles(0), m_isLoading(false), m_watchingEnabled(true)
 {
   setObjectName(QLatin1String("FileProxyModel"));
   connect(this, SIGNAL(rowsInserted(QModelIndex,int,int)),
@@ -81,6 +91,10 @@ FileProxyModel::FileProxyModel(QObject* parent) : QSortFilterProxyModel(parent),
   m_sortTimer->setSingleShot(true);
   m_sortTimer->setInterval(100);
   connect(m_sortTimer, SIGNAL(timeout()), this, SLOT(emitSortingFinished()));
+  connect(m_directoryWatcher, SIGNAL(filesChanged(QStringList)),
+          this, SLOT(onWatchedFilesChanged(QStringList)));
+  connect(m_directoryWatcher, SIGNAL(directoriesChanged(QStringList)),
+          this, SLOT(onWatchedDirectoriesChanged(QStringList)));
 #if QT_VERSION < 0x050000
   setRoleNames(getRoleHash());
 #endif
@@ -91,7 +105,11 @@ FileProxyModel::FileProxyModel(QObject* parent) : QSortFilterProxyModel(parent),
  */
 FileProxyModel::~FileProxyModel()
 {
+  m_tagReaderPool->clear();
   clearTaggedFileStore();
+  deleteRemovedTaggedFiles();
+  delete m_tagSearchIndex;
+  delete m_tagCache;
   delete m_iconProvider;
 }
 
@@ -202,6 +220,44 @@ QModelIndex FileProxyModel::index(const QString& path, int column) const
   return QModelIndex();
 }
 
+/**
+ * Get index for a path found by a directory scanner.
+ * The node is added to the file system model without loading its
+ * directory, a tagged file is created if the path is a file.
+ *
+ * @param path path to file or directory
+ * @return model index, invalid if not found or filtered out.
+ */
+QModelIndex FileProxyModel::indexOfScannedPath(const QString& path)
+{
+  QModelIndex idx = index(path);
+  if (idx.isValid()) {
+    initTaggedFileData(idx);
+  }
+  return idx;
+}
+
+/**
+ * Set the name, folder and hidden file filters of a directory scanner to
+ * the filters of this model.
+ * @param scanner directory scanner
+ */
+void FileProxyModel::configureDirectoryScanner(
+    DirectoryScanner* scanner) const
+{
+  QStringList includeFolders, excludeFolders;
+  foreach (const QRegExp& re, m_includeFolderFilters) {
+    includeFolders.append(re.pattern());
+  }
+  foreach (const QRegExp& re, m_excludeFolderFilters) {
+    excludeFolders.append(re.pattern());
+  }
+  scanner->setExtensions(m_extensions);
+  scanner->setFolderFilters(includeFolders, excludeFolders);
+  scanner->setShowHiddenFiles(m_fsModel &&
+                              (m_fsModel->filter() & QDir::Hidden));
+}
+
 /**
  * Update the TaggedFile contents for rows inserted into the model.
  * @param parent parent model index
@@ -217,6 +273,10 @@ void FileProxyModel::updateInsertedRows(const QModelIndex& parent,
     QModelIndex index(model->index(row, 0, parent));
     initTaggedFileData(index);
   }
+  if (m_watchingEnabled) {
+    // One watch per directory with files in the model.
+    m_directoryWatcher->addDirectory(filePath(parent));
+  }
 }
 
 /**
@@ -329,6 +389,8 @@ void FileProxyModel::setSourceModel(QAbstractItemModel* sourceModel)
                  this, SLOT(onStartLoading()));
       disconnect(m_fsModel, SIGNAL(directoryLoaded(QString)),
                  this, SLOT(onDirectoryLoaded()));
+      disconnect(m_fsModel, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+                 this, SLOT(onSourceRowsAboutToBeRemoved(QModelIndex,int,int)));
     }
     m_fsModel = fsModel;
     if (m_fsModel) {
@@ -336,6 +398,8 @@ void FileProxyModel::setSourceModel(QAbstractItemModel* sourceModel)
               this, SLOT(onStartLoading()));
       connect(m_fsModel, SIGNAL(directoryLoaded(QString)),
               this, SLOT(onDirectoryLoaded()));
+      connect(m_fsModel, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+              this, SLOT(onSourceRowsAboutToBeRemoved(QModelIndex,int,int)));
     }
   }
   QSortFilterProxyModel::setSourceModel(sourceModel);
@@ -456,7 +520,10 @@ void FileProxyModel::resetInternalData()
 #if QT_VERSION >= 0x040800 && QT_VERSION != 0x050000
   QSortFilterProxyModel::resetInternalData();
 #endif
+  m_tagReaderPool->clear();
   clearTaggedFileStore();
+  m_directoryWatcher->clear();
+  m_writtenFiles.clear();
   m_filteredOut.clear();
   m_loadTimer->stop();
   m_sortTimer->stop();
@@ -607,6 +674,7 @@ bool FileProxyModel::storeTaggedFileVariant(const QPersistentModelIndex& index,
     if (value.isValid()) {
       if (value.canConvert<TaggedFile*>()) {
         TaggedFile* oldItem = m_taggedFiles.value(index, 0);
+        m_tagSearchIndex->removeFile(oldItem);
         delete oldItem;
         m_taggedFiles.insert(index, value.value<TaggedFile*>());
         return true;
@@ -614,6 +682,7 @@ bool FileProxyModel::storeTaggedFileVariant(const QPersistentModelIndex& index,
     } else {
       if (TaggedFile* oldFile = m_taggedFiles.value(index, 0)) {
         m_taggedFiles.remove(index);
+        m_tagSearchIndex->removeFile(oldFile);
         delete oldFile;
       }
     }
@@ -625,8 +694,14 @@ bool FileProxyModel::storeTaggedFileVariant(const QPersistentModelIndex& index,
  * Clear store with tagged files.
  */
 void FileProxyModel::clearTaggedFileStore() {
+  m_tagSearchIndex->clear();
   qDeleteAll(m_taggedFiles);
   m_taggedFiles.clear();
+  // Files which are currently written are deleted when they are finished.
+  foreach (TaggedFile* taggedFile, m_writingTaggedFiles) {
+    m_removedWritingTaggedFiles.insert(taggedFile);
+  }
+  m_writingTaggedFiles.clear();
 }
 
 /**
@@ -635,7 +710,8 @@ void FileProxyModel::clearTaggedFileStore() {
  */
 void FileProxyModel::initTaggedFileData(const QModelIndex& index) {
   QVariant dat = data(index, TaggedFileRole);
-  if (dat.isValid() || isDir(index))
+  if (dat.isValid() || isDir(index) ||
+      m_writingTaggedFiles.contains(index))
     return;
 
   dat.setValue(createTaggedFile(fileName(index), index));
@@ -716,6 +792,9 @@ TaggedFile* FileProxyModel::readWithId3V24(TaggedFile* taggedFile)
       if (setDataModel) {
         setDataModel->setData(index, data, FileProxyModel::TaggedFileRole);
       }
+    } else {
+      // Detached tagged file, the caller has to delete the old tagged file.
+      tagLibFile->setDetachedFilePath(taggedFile->getAbsFilename());
     }
     taggedFile = tagLibFile;
     taggedFile->readTags(false);
@@ -794,6 +873,9 @@ TaggedFile* FileProxyModel::readWithId3V23(TaggedFile* taggedFile)
       if (setDataModel) {
         setDataModel->setData(index, data, FileProxyModel::TaggedFileRole);
       }
+    } else {
+      // Detached tagged file, the caller has to delete the old tagged file.
+      id3libFile->setDetachedFilePath(taggedFile->getAbsFilename());
     }
     taggedFile = id3libFile;
     taggedFile->readTags(false);
@@ -847,6 +929,9 @@ TaggedFile* FileProxyModel::readWithOggFlac(TaggedFile* taggedFile)
       if (setDataModel) {
         setDataModel->setData(index, data, FileProxyModel::TaggedFileRole);
       }
+    } else {
+      // Detached tagged file, the caller has to delete the old tagged file.
+      tagLibFile->setDetachedFilePath(taggedFile->getAbsFilename());
     }
     taggedFile = tagLibFile;
     taggedFile->readTags(false);
@@ -889,12 +974,135 @@ TaggedFile* FileProxyModel::readWithOggFlacIfInvalidOgg(TaggedFile* taggedFile)
  */
 TaggedFile* FileProxyModel::readTagsFromTaggedFile(TaggedFile* taggedFile)
 {
+  FileProxyModel* model = qobject_cast<FileProxyModel*>(
+        const_cast<QAbstractItemModel*>(taggedFile->getIndex().model()));
+  // Only files read with the tagged file created by the model are cached,
+  // so that a cached entry can be used with such a tagged file.
+  bool cacheable = model && model->m_tagCache->isEnabled() &&
+      !taggedFile->isTagInformationRead() && !taggedFile->isChanged();
+  QString key, absFilename;
+  int features = 0;
+  if (cacheable) {
+    key = taggedFile->taggedFileKey();
+    features = taggedFile->activeTaggedFileFeatures();
+    absFilename = taggedFile->getAbsFilename();
+  }
+  if (model) {
+    taggedFile = model->takePrefetchedTaggedFile(taggedFile);
+    if (cacheable && !taggedFile->isTagInformationRead()) {
+      TaggedFile* cachedFile = model->takeCachedTaggedFile(taggedFile);
+      if (cachedFile != taggedFile) {
+        return cachedFile;
+      }
+    }
+  }
+  const bool profiled = OperationProfiler::isEnabled() &&
+      !taggedFile->isTagInformationRead();
+  const qint64 startTime =
+      profiled ? OperationProfiler::instance().timestamp() : 0;
   taggedFile->readTags(false);
   taggedFile = readWithId3V24IfId3V24(taggedFile);
   taggedFile = readWithOggFlacIfInvalidOgg(taggedFile);
+  if (profiled) {
+    OperationProfiler::instance().addDuration(
+          "readTags", taggedFile->taggedFileKey(), startTime);
+    OperationProfiler::count(OperationProfiler::FilesRead);
+    OperationProfiler::count(OperationProfiler::FileBytesRead,
+                             QFileInfo(taggedFile->getAbsFilename()).size());
+  }
+  if (cacheable && !taggedFile->isChanged() &&
+      taggedFile->isTagInformationRead() &&
+      taggedFile->taggedFileKey() == key &&
+      taggedFile->activeTaggedFileFeatures() == features) {
+    model->m_tagCache->insert(absFilename, taggedFile);
+  }
+  return taggedFile;
+}
+
+/**
+ * Replace tagged file by the tagged file read in the background.
+ * @param taggedFile tagged file with unread tags
+ * @return tagged file from tag reader pool if available, else @a taggedFile.
+ */
+TaggedFile* FileProxyModel::takePrefetchedTaggedFile(TaggedFile* taggedFile)
+{
+  QPersistentModelIndex index(taggedFile->getIndex());
+  if (!m_tagReaderPool->contains(index))
+    return taggedFile;
+
+  if (TaggedFile* prefetchedFile = m_tagReaderPool->take(index)) {
+    if (!taggedFile->isTagInformationRead() && !taggedFile->isChanged() &&
+        prefetchedFile->getFilename() == taggedFile->getFilename()) {
+      // Store before attaching, so that the model already returns the new
+      // tagged file when dataChanged() is emitted. The old tagged file is
+      // deleted by storeTaggedFileVariant().
+      QVariant data;
+      data.setValue(prefetchedFile);
+      storeTaggedFileVariant(index, data);
+      prefetchedFile->attachToIndex(index);
+      return prefetchedFile;
+    }
+    m_tagReaderPool->discardFilterResult(index);
+    delete prefetchedFile;
+  }
   return taggedFile;
 }
 
+/**
+ * Replace tagged file by a tagged file with the tags from the tag cache.
+ * @param taggedFile tagged file with unread tags
+ * @return tagged file with cached tags if available, else @a taggedFile.
+ */
+TaggedFile* FileProxyModel::takeCachedTaggedFile(TaggedFile* taggedFile)
+{
+  TagCache::Entry entry;
+  if (!m_tagCache->find(taggedFile->getAbsFilename(), entry) ||
+      entry.taggedFileKey != taggedFile->taggedFileKey() ||
+      entry.taggedFileFeatures != taggedFile->activeTaggedFileFeatures())
+    return taggedFile;
+
+  // The cached tagged file takes ownership of the detached tagged file,
+  // so it is replaced in the store without deleting it.
+  QPersistentModelIndex index = taggedFile->detachFromIndex();
+  CachedTaggedFile* cachedFile = new CachedTaggedFile(index, taggedFile, entry);
+  m_taggedFiles.insert(index, cachedFile);
+  notifyModelDataChanged(index);
+  return cachedFile;
+}
+
+/**
+ * Start reading the tags of a file in the background.
+ * This can be called for files which will be processed soon, so that
+ * the tags are already read when readTagsFromTaggedFile() is called.
+ * Nothing is done if @a index is not a file with unread tags.
+ *
+ * @param index model index of file
+ */
+void FileProxyModel::prefetchTaggedFile(const QPersistentModelIndex& index)
+{
+  if (!m_tagReaderPool->isEnabled() || m_tagReaderPool->contains(index))
+    return;
+
+  TaggedFile* taggedFile = m_taggedFiles.value(index, 0);
+  if (taggedFile && !taggedFile->isTagInformationRead() &&
+      !taggedFile->isChanged()) {
+    QString absFilename = taggedFile->getAbsFilename();
+    if (!m_tagCache->contains(absFilename)) {
+      m_tagReaderPool->enqueue(index, absFilename);
+    }
+  }
+}
+
+/**
+ * Get number of files which should be read ahead in the background.
+ * @return number of files, 0 if background reading is disabled.
+ */
+int FileProxyModel::tagPrefetchWindowSize() const
+{
+  return m_tagReaderPool->isEnabled()
+      ? 4 * m_tagReaderPool->maxThreadCount() : 0;
+}
+
 /**
  * Called from tagged file to notify modification state changes.
  * @param index model index
@@ -905,6 +1113,18 @@ void FileProxyModel::notifyModificationChanged(const QModelIndex& index,
 {
   emit fileModificationChanged(index, modified);
   emit dataChanged(index, index);
+  // Only files with unchanged tags are indexed, they are added again when
+  // their tags are read the next time.
+  m_tagSearchIndex->removeFile(m_taggedFiles.value(index, 0));
+  if (!modified) {
+    // The file has been written or reverted, cached tags may be outdated.
+    QString path = filePath(index);
+    m_tagCache->remove(path);
+    if (m_watchingEnabled) {
+      // Do not read the file again when its change is reported.
+      m_writtenFiles.insert(path);
+    }
+  }
   bool lastIsModified = isModified();
   if (modified) {
     ++m_numModifiedFiles;
@@ -917,6 +1137,226 @@ void FileProxyModel::notifyModificationChanged(const QModelIndex& index,
   }
 }
 
+/**
+ * Enable watching the loaded directories for changes by other programs.
+ * The tags of changed files are read again when they are used the next
+ * time, new files are added to the model.
+ *
+ * @param enable true to watch directories
+ */
+void FileProxyModel::setWatchingEnabled(bool enable)
+{
+  m_watchingEnabled = enable;
+  if (!enable) {
+    m_directoryWatcher->clear();
+    m_writtenFiles.clear();
+  }
+}
+
+/**
+ * Hide a detached tagged file from the model while it is written in
+ * another thread.
+ * Until endWritingTaggedFile() is called, the model returns no tagged
+ * file for @a index, does not refresh it when its file is changed and
+ * does not delete it when its row is removed.
+ *
+ * @param index model index returned by TaggedFile::detachFromIndex()
+ */
+void FileProxyModel::beginWritingTaggedFile(const QPersistentModelIndex& index)
+{
+  TaggedFile* taggedFile = m_taggedFiles.take(index);
+  if (!taggedFile)
+    return;
+
+  if (m_tagReaderPool->contains(index)) {
+    delete m_tagReaderPool->take(index);
+    m_tagReaderPool->discardFilterResult(index);
+  }
+  m_tagSearchIndex->removeFile(taggedFile);
+  m_writingTaggedFiles.insert(index, taggedFile);
+  emit dataChanged(index, index);
+}
+
+/**
+ * Store a tagged file in the model again after it has been written in
+ * another thread.
+ *
+ * @param index model index passed to beginWritingTaggedFile()
+ * @param taggedFile tagged file which has been written
+ *
+ * @return true if the tagged file is stored and has to be attached to
+ * @a index, false if its row has been removed in the meantime, the
+ * tagged file is deleted later then.
+ */
+bool FileProxyModel::endWritingTaggedFile(const QPersistentModelIndex& index,
+                                          TaggedFile* taggedFile)
+{
+  if (m_removedWritingTaggedFiles.remove(taggedFile) || !index.isValid()) {
+    if (m_removedTaggedFiles.isEmpty()) {
+      QTimer::singleShot(0, this, SLOT(deleteRemovedTaggedFiles()));
+    }
+    m_removedTaggedFiles.append(taggedFile);
+    return false;
+  }
+
+  m_writingTaggedFiles.remove(index);
+  m_taggedFiles.insert(index, taggedFile);
+  if (m_watchingEnabled) {
+    // The path recorded when the file was detached may have been cleared
+    // by a change notification received while it was written.
+    m_writtenFiles.insert(filePath(index));
+  }
+  return true;
+}
+
+/**
+ * Called when the directory watcher reports changed files.
+ * @param paths paths of changed files
+ */
+void FileProxyModel::onWatchedFilesChanged(const QStringList& paths)
+{
+  QList<QPersistentModelIndex> changedIndexes;
+  foreach (const QString& path, paths) {
+    if (m_writtenFiles.remove(path) || !QFileInfo(path).exists())
+      continue;
+
+    // Rows of deleted files are removed by the file system model, new
+    // files are added immediately by getting their index. Files which are
+    // being written in another thread are hidden and thus not refreshed.
+    QModelIndex idx = index(path);
+    if (hasReadTags(idx)) {
+      changedIndexes.append(idx);
+    }
+  }
+  m_writtenFiles.clear();
+  refreshTaggedFiles(changedIndexes);
+}
+
+/**
+ * Called when the directory watcher reports changed directories.
+ * @param dirPaths paths of directories with unknown changes
+ */
+void FileProxyModel::onWatchedDirectoriesChanged(const QStringList& dirPaths)
+{
+  // All files of the directories are marked, the tag cache will avoid
+  // reading those which have not been modified.
+  QList<QPersistentModelIndex> changedIndexes;
+  foreach (const QString& dirPath, dirPaths) {
+    QModelIndex parent = index(dirPath);
+    if (!parent.isValid())
+      continue;
+
+    for (int row = 0; row < rowCount(parent); ++row) {
+      QModelIndex idx = index(row, 0, parent);
+      if (hasReadTags(idx) &&
+          !m_writtenFiles.contains(filePath(idx))) {
+        changedIndexes.append(idx);
+      }
+    }
+  }
+  m_writtenFiles.clear();
+  refreshTaggedFiles(changedIndexes);
+}
+
+/**
+ * Check if a tagged file has read tags which may be outdated.
+ * @param index model index
+ * @return true if the file has tags which were read or are being read.
+ */
+bool FileProxyModel::hasReadTags(const QModelIndex& index) const
+{
+  if (!index.isValid())
+    return false;
+
+  QPersistentModelIndex persistentIndex(index);
+  TaggedFile* taggedFile = m_taggedFiles.value(persistentIndex, 0);
+  return taggedFile && (taggedFile->isTagInformationRead() ||
+                        m_tagReaderPool->contains(persistentIndex));
+}
+
+/**
+ * Mark the tags of files changed by other programs to be read again.
+ * @param indexes model indexes of files with tagged files
+ */
+void FileProxyModel::refreshTaggedFiles(
+    const QList<QPersistentModelIndex>& indexes)
+{
+  if (indexes.isEmpty())
+    return;
+
+  emit filesChangedExternally(indexes);
+  foreach (const QPersistentModelIndex& index, indexes) {
+    if (m_tagReaderPool->contains(index)) {
+      delete m_tagReaderPool->take(index);
+      m_tagReaderPool->discardFilterResult(index);
+    }
+    TaggedFile* taggedFile = m_taggedFiles.value(index, 0);
+    if (taggedFile && !taggedFile->isChanged()) {
+      m_tagSearchIndex->removeFile(taggedFile);
+      // The tags are read again when they are used the next time.
+      taggedFile->clearTags(false);
+    }
+    emit dataChanged(index, index);
+  }
+}
+
+/**
+ * Release the tagged files of rows removed from the file system model.
+ * @param parent parent source model index
+ * @param start starting row
+ * @param end ending row
+ */
+void FileProxyModel::onSourceRowsAboutToBeRemoved(const QModelIndex& parent,
+                                                  int start, int end)
+{
+  if (!m_fsModel)
+    return;
+
+  bool lastIsModified = isModified();
+  for (int row = start; row <= end; ++row) {
+    QModelIndex srcIndex = m_fsModel->index(row, 0, parent);
+    if (m_fsModel->isDir(srcIndex))
+      continue;
+
+    QPersistentModelIndex index(mapFromSource(srcIndex));
+    if (TaggedFile* writingFile = m_writingTaggedFiles.take(index)) {
+      // Deleted by endWritingTaggedFile() when it has been written.
+      m_removedWritingTaggedFiles.insert(writingFile);
+      continue;
+    }
+    TaggedFile* taggedFile = m_taggedFiles.take(index);
+    if (!taggedFile)
+      continue;
+
+    if (m_tagReaderPool->contains(index)) {
+      delete m_tagReaderPool->take(index);
+      m_tagReaderPool->discardFilterResult(index);
+    }
+    m_tagSearchIndex->removeFile(taggedFile);
+    if (taggedFile->isChanged() && m_numModifiedFiles > 0) {
+      --m_numModifiedFiles;
+    }
+    // Deleted later, the current selection may still refer to it.
+    if (m_removedTaggedFiles.isEmpty()) {
+      QTimer::singleShot(0, this, SLOT(deleteRemovedTaggedFiles()));
+    }
+    m_removedTaggedFiles.append(taggedFile);
+  }
+  bool newIsModified = isModified();
+  if (newIsModified != lastIsModified) {
+    emit modifiedChanged(newIsModified);
+  }
+}
+
+/**
+ * Delete tagged files of removed rows.
+ */
+void FileProxyModel::deleteRemovedTaggedFiles()
+{
+  qDeleteAll(m_removedTaggedFiles);
+  m_removedTaggedFiles.clear();
+}
+
 /**
  * Called from tagged file to notify changes in extra model data, e.g. the
  * information on which the TaggedFileIconProvider depends.
@@ -39,6 +39,11 @@ class QFileSystemModel;
 class QTimer;
 class TaggedFileIconProvider;
 class ITaggedFileFactory;
+class TagReaderPool;
+class TagCache;
+class TagSearchIndex;
+class DirectoryScanner;
+class DirectoryWatcher;
 
 /**
  * Proxy for filesystem model which filters files.
@@ -217,6 +222,23 @@ public:
 
   using QSortFilterProxyModel::index;
 
+  /**
+   * Get index for a path found by a directory scanner.
+   * The node is added to the file system model without loading its
+   * directory, a tagged file is created if the path is a file.
+   *
+   * @param path path to file or directory
+   * @return model index, invalid if not found or filtered out.
+   */
+  QModelIndex indexOfScannedPath(const QString& path);
+
+  /**
+   * Set the name, folder and hidden file filters of a directory scanner to
+   * the filters of this model.
+   * @param scanner directory scanner
+   */
+  void configureDirectoryScanner(DirectoryScanner* scanner) const;
+
   /**
    * Called from tagged file to notify modification state changes.
    * @param index model index
@@ -243,6 +265,86 @@ public:
    */
   TaggedFileIconProvider* getIconProvider() const { return m_iconProvider; }
 
+  /**
+   * Get pool of worker threads reading tags in the background.
+   * @return tag reader pool.
+   */
+  TagReaderPool* getTagReaderPool() const { return m_tagReaderPool; }
+
+  /**
+   * Get persistent cache with the tags of files.
+   * @return tag cache.
+   */
+  TagCache* getTagCache() const { return m_tagCache; }
+
+  /**
+   * Get index with the trigrams of the files with read tags.
+   * @return tag search index.
+   */
+  TagSearchIndex* getTagSearchIndex() const { return m_tagSearchIndex; }
+
+  /**
+   * Get watcher for changes in the loaded directories.
+   * @return directory watcher.
+   */
+  DirectoryWatcher* getDirectoryWatcher() const { return m_directoryWatcher; }
+
+  /**
+   * Enable watching the loaded directories for changes by other programs.
+   * The tags of changed files are read again when they are used the next
+   * time, new files are added to the model.
+   *
+   * @param enable true to watch directories
+   */
+  void setWatchingEnabled(bool enable);
+
+  /**
+   * Hide a detached tagged file from the model while it is written in
+   * another thread.
+   * Until endWritingTaggedFile() is called, the model returns no tagged
+   * file for @a index, does not refresh it when its file is changed and
+   * does not delete it when its row is removed.
+   *
+   * @param index model index returned by TaggedFile::detachFromIndex()
+   */
+  void beginWritingTaggedFile(const QPersistentModelIndex& index);
+
+  /**
+   * Store a tagged file in the model again after it has been written in
+   * another thread.
+   *
+   * @param index model index passed to beginWritingTaggedFile()
+   * @param taggedFile tagged file which has been written
+   *
+   * @return true if the tagged file is stored and has to be attached to
+   * @a index, false if its row has been removed in the meantime, the
+   * tagged file is deleted later then.
+   */
+  bool endWritingTaggedFile(const QPersistentModelIndex& index,
+                            TaggedFile* taggedFile);
+
+  /**
+   * Check if loaded directories are watched for changes.
+   * @return true if watching is enabled.
+   */
+  bool isWatchingEnabled() const { return m_watchingEnabled; }
+
+  /**
+   * Start reading the tags of a file in the background.
+   * This can be called for files which will be processed soon, so that
+   * the tags are already read when readTagsFromTaggedFile() is called.
+   * Nothing is done if @a index is not a file with unread tags.
+   *
+   * @param index model index of file
+   */
+  void prefetchTaggedFile(const QPersistentModelIndex& index);
+
+  /**
+   * Get number of files which should be read ahead in the background.
+   * @return number of files, 0 if background reading is disabled.
+   */
+  int tagPrefetchWindowSize() const;
+
   /**
    * Access to tagged file factories.
    * @return reference to tagged file factories.
@@ -356,6 +458,8 @@ public:
 
   /**
    * Call readTags() on tagged file.
+   * If the tags have already been read in the background, the tagged file
+   * is replaced by the tagged file from the tag reader pool.
    * Reread file with other metadata plugin if it is not supported by current
    * plugin.
    *
@@ -396,6 +500,14 @@ signals:
    */
   void modifiedChanged(bool modified);
 
+  /**
+   * Emitted when files have been changed by other programs, before their
+   * tags are marked to be read again.
+   * Files with unsaved modifications keep their tags.
+   * @param indexes model indexes of changed files
+   */
+  void filesChangedExternally(const QList<QPersistentModelIndex>& indexes);
+
 protected slots:
   /**
    * Reset internal data of the model.
@@ -422,6 +534,32 @@ private slots:
    */
   void emitSortingFinished();
 
+  /**
+   * Called when the directory watcher reports changed files.
+   * @param paths paths of changed files
+   */
+  void onWatchedFilesChanged(const QStringList& paths);
+
+  /**
+   * Called when the directory watcher reports changed directories.
+   * @param dirPaths paths of directories with unknown changes
+   */
+  void onWatchedDirectoriesChanged(const QStringList& dirPaths);
+
+  /**
+   * Release the tagged files of rows removed from the file system model.
+   * @param parent parent source model index
+   * @param start starting row
+   * @param end ending row
+   */
+  void onSourceRowsAboutToBeRemoved(const QModelIndex& parent,
+                                    int start, int end);
+
+  /**
+   * Delete tagged files of removed rows.
+   */
+  void deleteRemovedTaggedFiles();
+
   /**
    * Called when loading the directory starts.
    */
@@ -466,6 +604,20 @@ private:
    */
   void initTaggedFileData(const QModelIndex& index);
 
+  /**
+   * Replace tagged file by the tagged file read in the background.
+   * @param taggedFile tagged file with unread tags
+   * @return tagged file from tag reader pool if available, else @a taggedFile.
+   */
+  TaggedFile* takePrefetchedTaggedFile(TaggedFile* taggedFile);
+
+  /**
+   * Replace tagged file by a tagged file with the tags from the tag cache.
+   * @param taggedFile tagged file with unread tags
+   * @return tagged file with cached tags if available, else @a taggedFile.
+   */
+  TaggedFile* takeCachedTaggedFile(TaggedFile* taggedFile);
+
   /**
    * Check if a directory path passes the include folder filters.
    * @param dirPath absolute path to directory
@@ -480,17 +632,42 @@ private:
    */
   bool passesExcludeFolderFilters(const QString& dirPath) const;
 
+  /**
+   * Mark the tags of files changed by other programs to be read again.
+   * @param indexes model indexes of files with tagged files
+   */
+  void refreshTaggedFiles(const QList<QPersistentModelIndex>& indexes);
+
+  /**
+   * Check if a tagged file has read tags which may be outdated.
+   * @param index model index
+   * @return true if the file has tags which were read or are being read.
+   */
+  bool hasReadTags(const QModelIndex& index) const;
+
   QHash<QPersistentModelIndex, TaggedFile*> m_taggedFiles;
+  QList<TaggedFile*> m_removedTaggedFiles;
+  /** Tagged files hidden while they are written in another thread */
+  QHash<QPersistentModelIndex, TaggedFile*> m_writingTaggedFiles;
+  /** Tagged files being written whose rows have been removed */
+  QSet<TaggedFile*> m_removedWritingTaggedFiles;
+  /** Files written by the application since the last change notification */
+  QSet<QString> m_writtenFiles;
   QSet<QPersistentModelIndex> m_filteredOut;
   QList<QRegExp> m_includeFolderFilters;
   QList<QRegExp> m_excludeFolderFilters;
   TaggedFileIconProvider* m_iconProvider;
+  TagReaderPool* m_tagReaderPool;
+  TagCache* m_tagCache;
+  TagSearchIndex* m_tagSearchIndex;
+  DirectoryWatcher* m_directoryWatcher;
   QFileSystemModel* m_fsModel;
   QTimer* m_loadTimer;
   QTimer* m_sortTimer;
   QStringList m_extensions;
   unsigned int m_numModifiedFiles;
   bool m_isLoading;
+  bool m_watchingEnabled;
 
   static QList<ITaggedFileFactory*> s_taggedFileFactories;
 };
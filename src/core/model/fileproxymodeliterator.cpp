@@ -27,6 +27,14 @@
 #include "fileproxymodeliterator.h"
 #include <QTimer>
 #include "fileproxymodel.h"
+#include "directoryscanner.h"
+
+namespace {
+
+/** Number of scanned nodes delivered before other events are processed. */
+const int ScannedNodesPerBatch = 100;
+
+}
 
 /**
  * GreaterThan functor to sort modex indexes by string data.
@@ -52,7 +60,8 @@ public:
  * @param model file proxy model
  */
 FileProxyModelIterator::FileProxyModelIterator(FileProxyModel* model) :
-  QObject(model), m_model(model), m_numDone(0), m_aborted(false)
+  QObject(model), m_model(model), m_scanner(0), m_scanPos(0),
+  m_prefetchPos(0), m_numDone(0), m_aborted(false), m_prefetchTags(false)
 {
 }
 
@@ -69,6 +78,9 @@ FileProxyModelIterator::~FileProxyModelIterator()
 void FileProxyModelIterator::abort()
 {
   m_aborted = true;
+  if (m_scanner) {
+    m_scanner->abort();
+  }
 }
 
 /**
@@ -89,6 +101,28 @@ void FileProxyModelIterator::clearAborted()
   m_aborted = false;
 }
 
+/**
+ * Read the directories with a directory scanner.
+ * All directories are read in parallel before the first node is
+ * delivered, the nodes are then added to the model without waiting for
+ * the file system model to load their directories. This is much faster
+ * for large directory trees, but the GUI is not updated while scanning,
+ * so it should only be used in batch and command line modes.
+ *
+ * @param enable true to use a directory scanner
+ */
+void FileProxyModelIterator::setDirectoryScannerEnabled(bool enable)
+{
+  if (enable && !m_scanner) {
+    m_scanner = new DirectoryScanner(this);
+    connect(m_scanner, SIGNAL(finished()),
+            this, SLOT(onDirectoriesScanned()));
+  } else if (!enable && m_scanner) {
+    delete m_scanner;
+    m_scanner = 0;
+  }
+}
+
 /**
  * Start iteration.
  *
@@ -96,12 +130,7 @@ void FileProxyModelIterator::clearAborted()
  */
 void FileProxyModelIterator::start(const QPersistentModelIndex& rootIdx)
 {
-  m_nodes.clear();
-  m_rootIndexes.clear();
-  m_rootIndexes.append(rootIdx);
-  m_numDone = 0;
-  m_aborted = false;
-  fetchNext();
+  start(QList<QPersistentModelIndex>() << rootIdx);
 }
 
 /**
@@ -112,9 +141,24 @@ void FileProxyModelIterator::start(const QPersistentModelIndex& rootIdx)
 void FileProxyModelIterator::start(const QList<QPersistentModelIndex>& indexes)
 {
   m_nodes.clear();
-  m_rootIndexes = indexes;
+  m_scannedPaths.clear();
+  m_scanPos = 0;
+  m_prefetchPos = 0;
   m_numDone = 0;
   m_aborted = false;
+  if (m_scanner) {
+    m_rootIndexes.clear();
+    QStringList rootPaths;
+    foreach (const QPersistentModelIndex& index, indexes) {
+      if (index.isValid()) {
+        rootPaths.append(m_model->filePath(index));
+      }
+    }
+    m_model->configureDirectoryScanner(m_scanner);
+    m_scanner->start(rootPaths);
+    return;
+  }
+  m_rootIndexes = indexes;
   fetchNext();
 }
 
@@ -123,6 +167,11 @@ void FileProxyModelIterator::start(const QList<QPersistentModelIndex>& indexes)
  */
 void FileProxyModelIterator::fetchNext()
 {
+  if (m_scanner) {
+    fetchNextScanned();
+    return;
+  }
+
   int count = 0;
   while (!m_aborted) {
     if (m_nodes.isEmpty()) {
@@ -154,6 +203,9 @@ void FileProxyModelIterator::fetchNext()
       qStableSort(childNodes.begin(), childNodes.end(),
                   PersistentModelIndexGreaterThan());
       m_nodes += childNodes;
+      if (m_prefetchTags) {
+        prefetchNextNodes();
+      }
       emit nextReady(m_nextIdx);
     }
   }
@@ -172,3 +224,74 @@ void FileProxyModelIterator::onDirectoryLoaded()
              this, SLOT(onDirectoryLoaded()));
   fetchNext();
 }
+
+/**
+ * Called when the directory scanner has finished.
+ */
+void FileProxyModelIterator::onDirectoriesScanned()
+{
+  m_scannedPaths = m_scanner->paths();
+  m_scanPos = 0;
+  m_prefetchPos = 0;
+  fetchNextScanned();
+}
+
+/**
+ * Deliver the next nodes found by the directory scanner.
+ */
+void FileProxyModelIterator::fetchNextScanned()
+{
+  int count = 0;
+  while (!m_aborted && m_scanPos < m_scannedPaths.size()) {
+    if (++count > ScannedNodesPerBatch) {
+      // Process other events, e.g. the results of the tag reader pool.
+      QTimer::singleShot(0, this, SLOT(fetchNext()));
+      return;
+    }
+    if (m_prefetchTags) {
+      prefetchNextScannedNodes();
+    }
+    m_nextIdx = m_model->indexOfScannedPath(m_scannedPaths.at(m_scanPos++));
+    if (m_nextIdx.isValid()) {
+      ++m_numDone;
+      emit nextReady(m_nextIdx);
+    }
+  }
+  m_scannedPaths.clear();
+  m_scanPos = 0;
+  m_prefetchPos = 0;
+  m_nextIdx = QPersistentModelIndex();
+  emit nextReady(m_nextIdx);
+}
+
+/**
+ * Start reading the tags of the scanned files which will be processed
+ * next.
+ */
+void FileProxyModelIterator::prefetchNextScannedNodes()
+{
+  int endPos = qMin(m_scanPos + m_model->tagPrefetchWindowSize(),
+                    m_scannedPaths.size());
+  for (m_prefetchPos = qMax(m_prefetchPos, m_scanPos);
+       m_prefetchPos < endPos;
+       ++m_prefetchPos) {
+    QModelIndex idx =
+        m_model->indexOfScannedPath(m_scannedPaths.at(m_prefetchPos));
+    if (idx.isValid()) {
+      m_model->prefetchTaggedFile(idx);
+    }
+  }
+}
+
+/**
+ * Start reading the tags of the nodes which will be processed next.
+ */
+void FileProxyModelIterator::prefetchNextNodes()
+{
+  // The next nodes are on the top of the stack.
+  int numNodes = m_nodes.size();
+  int firstIdx = qMax(numNodes - m_model->tagPrefetchWindowSize(), 0);
+  for (int i = numNodes - 1; i >= firstIdx; --i) {
+    m_model->prefetchTaggedFile(m_nodes.at(i));
+  }
+}
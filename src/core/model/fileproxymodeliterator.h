@@ -30,10 +30,12 @@
 #include <QObject>
 #include <QStack>
 #include <QPersistentModelIndex>
+#include <QStringList>
 #include "iabortable.h"
 #include "kid3api.h"
 
 class FileProxyModel;
+class DirectoryScanner;
 
 /**
  * Iterator for FileProxyModel.
@@ -46,6 +48,10 @@ class FileProxyModel;
  * some files so that other slots can be processed and the GUI remains
  * responsive. If the iteration shall stop before all files are processed,
  * abort() shall be called.
+ *
+ * Without a GUI, setDirectoryScannerEnabled() can be used to read the
+ * directories with a DirectoryScanner instead of loading them one after the
+ * other into the file system model.
  */
 class KID3_CORE_EXPORT FileProxyModelIterator : public QObject, public IAbortable {
   Q_OBJECT
@@ -93,11 +99,42 @@ public:
    */
   void start(const QList<QPersistentModelIndex>& indexes);
 
+  /**
+   * Enable reading the tags of the next files in the background.
+   * This should be set before start() if the tags of the files are read when
+   * nextReady() is emitted.
+   *
+   * @param prefetchTags true to read tags of the next files in the tag
+   * reader pool of the model
+   */
+  void setPrefetchTags(bool prefetchTags) { m_prefetchTags = prefetchTags; }
+
+  /**
+   * Read the directories with a directory scanner.
+   * All directories are read in parallel before the first node is
+   * delivered, the nodes are then added to the model without waiting for
+   * the file system model to load their directories. This is much faster
+   * for large directory trees, but the GUI is not updated while scanning,
+   * so it should only be used in batch and command line modes.
+   *
+   * @param enable true to use a directory scanner
+   */
+  void setDirectoryScannerEnabled(bool enable);
+
+  /**
+   * Check if directories are read with a directory scanner.
+   * @return true if directory scanner is used.
+   */
+  bool isDirectoryScannerEnabled() const { return m_scanner != 0; }
+
   /**
    * Get amount of work to do.
    * @return number of nodes which have to be processed.
    */
-  int getWorkToDo() const { return m_nodes.size() + m_rootIndexes.size(); }
+  int getWorkToDo() const {
+    return m_nodes.size() + m_rootIndexes.size() +
+        m_scannedPaths.size() - m_scanPos;
+  }
 
   /**
    * Get amount of work done.
@@ -119,18 +156,44 @@ private slots:
    */
   void onDirectoryLoaded();
 
+  /**
+   * Called when the directory scanner has finished.
+   */
+  void onDirectoriesScanned();
+
   /**
    * Fetch next index.
    */
   void fetchNext();
 
 private:
+  /**
+   * Start reading the tags of the nodes which will be processed next.
+   */
+  void prefetchNextNodes();
+
+  /**
+   * Deliver the next nodes found by the directory scanner.
+   */
+  void fetchNextScanned();
+
+  /**
+   * Start reading the tags of the scanned files which will be processed
+   * next.
+   */
+  void prefetchNextScannedNodes();
+
   QList<QPersistentModelIndex> m_rootIndexes;
   QStack<QPersistentModelIndex> m_nodes;
   FileProxyModel* m_model;
+  DirectoryScanner* m_scanner;
+  QStringList m_scannedPaths;
+  int m_scanPos;
+  int m_prefetchPos;
   QPersistentModelIndex m_nextIdx;
   int m_numDone;
   bool m_aborted;
+  bool m_prefetchTags;
 };
 
 #endif // FILEPROXYMODELITERATOR_H
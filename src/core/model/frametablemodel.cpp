@@ -354,8 +354,18 @@ bool FrameTableModel::removeRows(int row, int count,
 {
   if (count > 0) {
     beginRemoveRows(QModelIndex(), row, row + count - 1);
+    // Erasing invalidates the iterators after the erased frame, so the
+    // frames are erased starting with the last one in the collection.
+    QVector<FrameCollection::iterator> frameIts;
     for (int i = row; i < row + count; ++i) {
-      m_frames.erase(frameAt(i));
+      FrameCollection::iterator it = frameAt(i);
+      if (it != m_frames.end()) {
+        frameIts.append(it);
+      }
+    }
+    std::sort(frameIts.begin(), frameIts.end());
+    for (int i = frameIts.size() - 1; i >= 0; --i) {
+      m_frames.erase(frameIts.at(i));
     }
     updateFrameRowMapping();
     resizeFrameSelected();
@@ -36,12 +36,21 @@
 #include <QPluginLoader>
 #include <QAction>
 #include <QElapsedTimer>
+#include <QScopedPointer>
+#include <QVector>
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <cstdio>
 #if defined Q_OS_MAC && QT_VERSION >= 0x050200
 #include <CoreFoundation/CFURL.h>
 #endif
 #include <QFileIconProvider>
-#if QT_VERSION >= 0x050000 && defined Q_OS_ANDROID
+#if QT_VERSION >= 0x050000
 #include <QStandardPaths>
+#else
+#include <QDesktopServices>
 #endif
 #ifdef HAVE_QTDBUS
 #include <QDBusConnection>
@@ -57,6 +66,14 @@
 #include "genremodel.h"
 #include "frametablemodel.h"
 #include "taggedfileselection.h"
+#include "tagwriterpool.h"
+#include "filehandlepool.h"
+#include "operationprofiler.h"
+#include "httpresponsecache.h"
+#include "networkconfig.h"
+#include "tagcache.h"
+#include "tagsearchindex.h"
+#include "tagreaderpool.h"
 #include "timeeventmodel.h"
 #include "framelist.h"
 #include "frameeditorobject.h"
@@ -142,6 +159,25 @@ Frame::TextEncoding frameTextEncodingFromConfig()
   return encoding;
 }
 
+/**
+ * Get fingerprint of the tag settings which affect the frames read from
+ * files and stored in the tag cache.
+ * @return settings fingerprint.
+ */
+QByteArray tagCacheFingerprint()
+{
+  const TagConfig& tagCfg = TagConfig::instance();
+  QByteArray data;
+  QDataStream ds(&data, QIODevice::WriteOnly);
+  ds.setVersion(QDataStream::Qt_4_7);
+  ds << tagCfg.textEncodingV1() << tagCfg.genreNotNumeric()
+     << tagCfg.riffTrackName() << tagCfg.commentName()
+     << static_cast<qint32>(tagCfg.pictureNameIndex())
+     << tagCfg.enableTotalNumberOfTracks()
+     << static_cast<qint32>(tagCfg.trackNumberDigits());
+  return QCryptographicHash::hash(data, QCryptographicHash::Md5);
+}
+
 /**
  * Extract file path, field name and index from frame name.
  *
@@ -258,7 +294,8 @@ Kid3Application::Kid3Application(ICorePlatformTools* platformTools,
 #ifdef HAVE_QTDBUS
   m_dbusEnabled(false),
 #endif
-  m_filtered(false), m_selectionOperationRunning(false)
+  m_filtered(false), m_selectionOperationRunning(false),
+  m_numRewrittenFiles(0)
 {
   const TagConfig& tagCfg = TagConfig::instance();
   FOR_ALL_TAGS(tagNr) {
@@ -300,6 +337,9 @@ Kid3Application::Kid3Application(ICorePlatformTools* platformTools,
           this, SIGNAL(fileSelectionChanged()));
   connect(m_fileProxyModel, SIGNAL(modifiedChanged(bool)),
           this, SIGNAL(modifiedChanged(bool)));
+  connect(m_fileProxyModel,
+          SIGNAL(filesChangedExternally(QList<QPersistentModelIndex>)),
+          this, SLOT(onFilesChangedExternally(QList<QPersistentModelIndex>)));
 
   connect(m_selection, SIGNAL(singleFileChanged()),
           this, SLOT(updateCoverArtImageId()));
@@ -308,6 +348,11 @@ Kid3Application::Kid3Application(ICorePlatformTools* platformTools,
 
   initPlugins();
   m_batchImporter->setImporters(m_importers, m_trackDataModel);
+  applyTagCacheConfig();
+  applyHttpCacheConfig();
+  m_fileProxyModel->getTagSearchIndex()->setEnabled(
+        FileConfig::instance().useTagSearchIndex());
+  FileHandlePool::instance().setCapacity(FileConfig::instance().maxOpenFiles());
 }
 
 /**
@@ -712,6 +757,11 @@ void Kid3Application::applyChangedConfiguration()
   m_fileProxyModel->setNameFilters(nameFilters);
   m_fileProxyModel->setFolderFilters(fileCfg.includeFolders(),
                                      fileCfg.excludeFolders());
+  applyTagCacheConfig();
+  applyHttpCacheConfig();
+  m_fileProxyModel->getTagSearchIndex()->setEnabled(
+        fileCfg.useTagSearchIndex());
+  FileHandlePool::instance().setCapacity(fileCfg.maxOpenFiles());
 
   QDir::Filters oldFilter = m_fileSystemModel->filter();
   QDir::Filters filter = oldFilter;
@@ -751,6 +801,62 @@ void Kid3Application::readConfig()
         TagConfig::instance().quickAccessFrames());
 }
 
+/**
+ * Enable or disable the tag cache depending on configuration.
+ */
+void Kid3Application::applyTagCacheConfig()
+{
+  QString cachePath;
+  if (FileConfig::instance().useTagCache()) {
+#if QT_VERSION >= 0x050000
+    QString cacheDir =
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+#else
+    QString cacheDir =
+        QDesktopServices::storageLocation(QDesktopServices::CacheLocation);
+#endif
+    if (!cacheDir.isEmpty()) {
+      cachePath = QDir(cacheDir).filePath(QLatin1String("tagcache.dat"));
+    }
+  }
+  TagCache* tagCache = m_fileProxyModel->getTagCache();
+  tagCache->setFilePath(cachePath);
+  tagCache->setSettingsFingerprint(tagCacheFingerprint());
+}
+
+/**
+ * Set up the HTTP response cache depending on configuration.
+ */
+void Kid3Application::applyHttpCacheConfig()
+{
+  const NetworkConfig& networkCfg = NetworkConfig::instance();
+  QString cacheDir;
+  if (networkCfg.httpCacheSize() > 0) {
+#if QT_VERSION >= 0x050000
+    cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+#else
+    cacheDir =
+        QDesktopServices::storageLocation(QDesktopServices::CacheLocation);
+#endif
+  }
+  if (cacheDir.isEmpty()) {
+    // The network access manager deletes the old cache.
+    m_netMgr->setCache(0);
+    return;
+  }
+
+  HttpResponseCache* cache =
+      qobject_cast<HttpResponseCache*>(m_netMgr->cache());
+  if (!cache) {
+    cache = new HttpResponseCache;
+    cache->setCacheDirectory(QDir(cacheDir).filePath(QLatin1String("http")));
+    m_netMgr->setCache(cache);
+  }
+  cache->setMaximumCacheSize(
+        static_cast<qint64>(networkCfg.httpCacheSize()) * 1024 * 1024);
+  cache->setTimeToLive(networkCfg.httpCacheTimeToLive() * 60 * 60);
+}
+
 /**
  * Open directory.
  * When finished directoryOpened() is emitted, also if false is returned.
@@ -763,6 +869,7 @@ void Kid3Application::readConfig()
  */
 bool Kid3Application::openDirectory(const QStringList& paths, bool fileCheck)
 {
+  OperationProfiler::begin("openDirectory");
   QStringList pathList(paths);
 #if QT_VERSION >= 0x050000 && defined Q_OS_ANDROID
   if (pathList.isEmpty()) {
@@ -832,6 +939,11 @@ bool Kid3Application::openDirectory(const QStringList& paths, bool fileCheck)
       filter |= QDir::Hidden;
     }
     m_fileSystemModel->setFilter(filter);
+    TagCache* tagCache = m_fileProxyModel->getTagCache();
+    if (dir != m_dirName && tagCache->isModified()) {
+      // Store the tags read from the directory which is closed.
+      tagCache->save();
+    }
     rootIndex = m_fileSystemModel->setRootPath(dir);
     foreach (const QString& filePath, filePaths) {
       fileIndexes.append(m_fileSystemModel->index(filePath));
@@ -862,6 +974,25 @@ bool Kid3Application::openDirectory(const QStringList& paths, bool fileCheck)
   return ok;
 }
 
+/**
+ * Called when files have been changed by other programs.
+ * If a selected file is affected, the frame models are updated with the
+ * tags read again.
+ * @param indexes model indexes of changed files
+ */
+void Kid3Application::onFilesChangedExternally(
+    const QList<QPersistentModelIndex>& indexes)
+{
+  foreach (const QPersistentModelIndex& index, indexes) {
+    if (m_currentSelection.contains(index)) {
+      // Store edits first, files with unsaved modifications keep their tags.
+      frameModelsToTags();
+      QTimer::singleShot(0, this, SLOT(tagsToFrameModels()));
+      break;
+    }
+  }
+}
+
 /**
  * Update selection and emit signals when directory is opened.
  */
@@ -890,6 +1021,7 @@ void Kid3Application::onDirectoryOpened()
     }
   }
 
+  OperationProfiler::end("openDirectory");
   emit directoryOpened();
 
   if (m_dirUpIndex.isValid()) {
@@ -935,39 +1067,111 @@ QModelIndex Kid3Application::currentOrRootIndex() const
 /**
  * Save all changed files.
  * longRunningOperationProgress() is emitted while saving files.
+ * If FileConfig::concurrentWrites() is greater than one, files which are
+ * not renamed are written concurrently by a TagWriterPool. Renamed files
+ * are always written in the order of the model from this thread.
  *
  * @return list of files with error, empty if ok.
  */
 QStringList Kid3Application::saveDirectory()
 {
-  QStringList errorFiles;
-  int numFiles = 0, totalFiles = 0;
-  // Get number of files to be saved to display correct progressbar
+  OperationProfiler::Scope profilerScope("saveDirectory");
+  // Get files to be saved to display correct progressbar
+  QList<TaggedFile*> changedFiles;
   TaggedFileIterator countIt(m_fileProxyModelRootIndex);
   while (countIt.hasNext()) {
-    if (countIt.next()->isChanged()) {
-      ++totalFiles;
+    TaggedFile* taggedFile = countIt.next();
+    if (taggedFile->isChanged()) {
+      changedFiles.append(taggedFile);
     }
   }
+  int numFiles = 0, totalFiles = changedFiles.size();
+  m_numRewrittenFiles = 0;
   QString operationName = tr("Saving directory...");
   bool aborted = false;
   emit longRunningOperationProgress(operationName, -1, totalFiles, &aborted);
 
-  TaggedFileIterator it(m_fileProxyModelRootIndex);
-  while (it.hasNext()) {
-    TaggedFile* taggedFile = it.next();
-    bool renamed = false;
-    if (taggedFile->isChanged() &&
-        !taggedFile->writeTags(false, &renamed,
-                               FileConfig::instance().preserveTime())) {
-      QString errorMsg = taggedFile->getAbsFilename();
-      errorFiles.push_back(errorMsg);
-    }
-    ++numFiles;
-    emit longRunningOperationProgress(operationName, numFiles, totalFiles,
-                                      &aborted);
-    if (aborted) {
-      break;
+  const bool preserve = FileConfig::instance().preserveTime();
+  // The paths are stored when the files are written, tagged files whose
+  // rows are removed while they are written are deleted afterwards.
+  QVector<QString> failedPaths(totalFiles);
+  QScopedPointer<TagWriterPool> writerPool;
+  int concurrentWrites = FileConfig::instance().concurrentWrites();
+  if (concurrentWrites > 1 && totalFiles > 1) {
+    writerPool.reset(new TagWriterPool);
+    writerPool->setMaxThreadCount(qMin(concurrentWrites, totalFiles));
+  }
+
+  for (int i = 0; i < totalFiles && !aborted; ++i) {
+    TaggedFile* taggedFile = changedFiles.at(i);
+    if (writerPool && !taggedFile->isFilenameChanged()) {
+      writerPool->enqueue(taggedFile, i, preserve);
+    } else {
+      bool renamed = false;
+      OperationProfiler::Scope scope("writeTags");
+      if (!taggedFile->writeTags(false, &renamed, preserve)) {
+        failedPaths[i] = taggedFile->getAbsFilename();
+      } else if (taggedFile->isFileRewritten()) {
+        ++m_numRewrittenFiles;
+      }
+      if (scope.isActive()) {
+        scope.setCategory(taggedFile->taggedFileKey());
+        OperationProfiler::count(OperationProfiler::FilesWritten);
+        OperationProfiler::count(
+              OperationProfiler::FileBytesWritten,
+              QFileInfo(taggedFile->getAbsFilename()).size());
+      }
+      ++numFiles;
+      emit longRunningOperationProgress(operationName, numFiles, totalFiles,
+                                        &aborted);
+    }
+    if (writerPool) {
+      // Collect the files which have been written in the meantime.
+      int id;
+      TagWriterPool::WriteResult result;
+      while (TaggedFile* writtenFile =
+             writerPool->takeResult(false, &id, &result)) {
+        if (result == TagWriterPool::WriteFailed) {
+          failedPaths[id] = writtenFile->getAbsFilename();
+        } else if (result == TagWriterPool::Written &&
+                   writtenFile->isFileRewritten()) {
+          ++m_numRewrittenFiles;
+        }
+        ++numFiles;
+        emit longRunningOperationProgress(operationName, numFiles, totalFiles,
+                                          &aborted);
+      }
+    }
+  }
+  if (writerPool) {
+    int id;
+    TagWriterPool::WriteResult result;
+    while (writerPool->hasOutstandingResults()) {
+      if (aborted) {
+        writerPool->cancelPending();
+      }
+      if (TaggedFile* writtenFile =
+          writerPool->takeResult(true, &id, &result)) {
+        if (result == TagWriterPool::WriteFailed) {
+          failedPaths[id] = writtenFile->getAbsFilename();
+        } else if (result == TagWriterPool::Written &&
+                   writtenFile->isFileRewritten()) {
+          ++m_numRewrittenFiles;
+        }
+        if (result != TagWriterPool::NotWritten) {
+          ++numFiles;
+          emit longRunningOperationProgress(operationName, numFiles,
+                                            totalFiles, &aborted);
+        }
+      }
+    }
+  }
+
+  // Report errors in the order of the files in the model.
+  QStringList errorFiles;
+  foreach (const QString& path, failedPaths) {
+    if (!path.isEmpty()) {
+      errorFiles.append(path);
     }
   }
   if (totalFiles == 0) {
@@ -1110,6 +1314,8 @@ void Kid3Application::revertFileModifications()
                                 true);
   while (it.hasNext()) {
     TaggedFile* taggedFile = it.next();
+    // The file may have been changed on disk.
+    m_fileProxyModel->getTagSearchIndex()->removeFile(taggedFile);
     taggedFile->readTags(true);
   }
   if (!it.hasNoSelection()) {
@@ -1130,6 +1336,70 @@ void Kid3Application::setFiltered(bool val)
   }
 }
 
+/**
+ * Enable or disable collection of operation statistics.
+ *
+ * @param enable true to enable the OperationProfiler
+ */
+void Kid3Application::setStatisticsEnabled(bool enable)
+{
+  if (OperationProfiler::isEnabled() != enable) {
+    OperationProfiler::instance().setEnabled(enable);
+    emit statisticsEnabledChanged(enable);
+  }
+}
+
+/**
+ * Check if operation statistics are collected.
+ *
+ * @return true if the OperationProfiler is enabled.
+ */
+bool Kid3Application::isStatisticsEnabled() const
+{
+  return OperationProfiler::isEnabled();
+}
+
+/**
+ * Get operation statistics.
+ *
+ * @return map with counters and durations of operations,
+ *         see OperationProfiler::toVariantMap().
+ */
+QVariantMap Kid3Application::getStatistics() const
+{
+  return OperationProfiler::instance().toVariantMap();
+}
+
+/**
+ * Get operation statistics as text.
+ *
+ * @return text with a line per counter and operation.
+ */
+QString Kid3Application::getStatisticsText() const
+{
+  return OperationProfiler::instance().toText();
+}
+
+/**
+ * Clear operation statistics.
+ */
+void Kid3Application::resetStatistics()
+{
+  OperationProfiler::instance().reset();
+}
+
+/**
+ * Write recorded operations to a file in Chrome trace event format.
+ *
+ * @param path path to JSON file
+ *
+ * @return true if ok.
+ */
+bool Kid3Application::writeStatisticsTrace(const QString& path) const
+{
+  return OperationProfiler::instance().writeChromeTrace(path);
+}
+
 /**
  * Import.
  *
@@ -1195,7 +1465,8 @@ void Kid3Application::importFromTags(Frame::TagVersion tagMask,
  * Export.
  *
  * @param tagVersion tag version
- * @param path   path of file, "clipboard" for export to clipboard
+ * @param path   path of file, "clipboard" for export to clipboard,
+ *               "-" for export to standard output
  * @param fmtIdx index of format
  *
  * @return true if ok.
@@ -1203,16 +1474,29 @@ void Kid3Application::importFromTags(Frame::TagVersion tagMask,
 bool Kid3Application::exportTags(Frame::TagVersion tagVersion,
                                  const QString& path, int fmtIdx)
 {
-  ImportTrackDataVector trackDataVector;
-  filesToTrackData(tagVersion, trackDataVector);
-  m_textExporter->setTrackData(trackDataVector);
-  m_textExporter->updateTextUsingConfig(fmtIdx);
   if (path == QLatin1String("clipboard")) {
+    ImportTrackDataVector trackDataVector;
+    filesToTrackData(tagVersion, trackDataVector);
+    m_textExporter->setTrackData(trackDataVector);
+    m_textExporter->updateTextUsingConfig(fmtIdx);
     m_textExporter->exportToClipboard();
     return true;
+  }
+
+  QFile file;
+  if (path == QLatin1String("-")) {
+    if (!file.open(stdout, QIODevice::WriteOnly))
+      return false;
   } else {
-    return m_textExporter->exportToFile(path);
+    if (path.isEmpty())
+      return false;
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly))
+      return false;
+    ImportConfig::instance().setImportDir(QFileInfo(file).dir().path());
   }
+  return m_textExporter->exportDirectory(currentOrRootIndex(), tagVersion,
+                                         &file, fmtIdx);
 }
 
 /**
@@ -1307,11 +1591,18 @@ bool Kid3Application::writePlaylist()
 void Kid3Application::filesToTrackData(Frame::TagVersion tagVersion,
                                        ImportTrackDataVector& trackDataList)
 {
+  QList<QPersistentModelIndex> indexes;
   TaggedFileOfDirectoryIterator it(currentOrRootIndex());
   while (it.hasNext()) {
-    TaggedFile* taggedFile = it.next();
-    taggedFile = FileProxyModel::readTagsFromTaggedFile(taggedFile);
-    trackDataList.push_back(ImportTrackData(*taggedFile, tagVersion));
+    QPersistentModelIndex index(it.next()->getIndex());
+    m_fileProxyModel->prefetchTaggedFile(index);
+    indexes.append(index);
+  }
+  foreach (const QPersistentModelIndex& index, indexes) {
+    if (TaggedFile* taggedFile = FileProxyModel::getTaggedFileOfIndex(index)) {
+      taggedFile = FileProxyModel::readTagsFromTaggedFile(taggedFile);
+      trackDataList.push_back(ImportTrackData(*taggedFile, tagVersion));
+    }
   }
 }
 
@@ -1416,6 +1707,7 @@ void Kid3Application::downloadImage(const QString& url, bool allFilesInDir)
 void Kid3Application::batchImport(const BatchImportProfile& profile,
                                   Frame::TagVersion tagVersion)
 {
+  OperationProfiler::begin("batchImport");
   m_batchImportProfile = &profile;
   m_batchImportTagVersion = tagVersion;
   m_batchImportAlbums.clear();
@@ -1437,6 +1729,7 @@ void Kid3Application::batchImport(const BatchImportProfile& profile,
 
   connect(m_fileProxyModelIterator, SIGNAL(nextReady(QPersistentModelIndex)),
           this, SLOT(batchImportNextFile(QPersistentModelIndex)));
+  m_fileProxyModelIterator->setPrefetchTags(true);
   m_fileProxyModelIterator->start(indexes);
 }
 
@@ -1822,12 +2115,15 @@ void Kid3Application::getFilenameFromTags(Frame::TagVersion tagVersion)
   SelectedTaggedFileIterator it(getRootIndex(),
                                 selectModel,
                                 false);
+  const FormatReplacer::Template filenameTemplate =
+      TrackData::compileFilenameFormat(
+        FileConfig::instance().toFilenameFormat());
   while (it.hasNext()) {
     TaggedFile* taggedFile = it.next();
     TrackData trackData(*taggedFile, tagVersion);
     if (!trackData.isEmptyOrInactive()) {
       taggedFile->setFilename(
-        trackData.formatFilenameFromTags(FileConfig::instance().toFilenameFormat()));
+        trackData.formatFilenameFromTags(filenameTemplate));
       formatFileNameIfEnabled(taggedFile);
     }
   }
@@ -2565,6 +2861,7 @@ void Kid3Application::replaceAll(const TagSearcher::Parameters& params)
  */
 void Kid3Application::scheduleRenameActions()
 {
+  OperationProfiler::begin("scheduleRenameActions");
   m_dirRenamer->clearActions();
   m_dirRenamer->clearAborted();
   // If directories are selected, rename them, else process files of the
@@ -2581,6 +2878,7 @@ void Kid3Application::scheduleRenameActions()
 
   connect(m_fileProxyModelIterator, SIGNAL(nextReady(QPersistentModelIndex)),
           this, SLOT(scheduleNextRenameAction(QPersistentModelIndex)));
+  m_fileProxyModelIterator->setPrefetchTags(true);
   m_fileProxyModelIterator->start(indexes);
 }
 
@@ -2605,6 +2903,7 @@ void Kid3Application::scheduleNextRenameAction(const QPersistentModelIndex& inde
     m_fileProxyModelIterator->abort();
     disconnect(m_fileProxyModelIterator, SIGNAL(nextReady(QPersistentModelIndex)),
                this, SLOT(scheduleNextRenameAction(QPersistentModelIndex)));
+    OperationProfiler::end("scheduleRenameActions");
     emit renameActionsScheduled();
   }
 }
@@ -2658,6 +2957,7 @@ void Kid3Application::applyFilterAfterReset()
  */
 void Kid3Application::applyFilter(FileFilter& fileFilter)
 {
+  OperationProfiler::begin("applyFilter");
   m_fileFilter = &fileFilter;
   /*
    * When a lot of files are filtered out,
@@ -2693,10 +2993,16 @@ void Kid3Application::proceedApplyingFilter()
 
   m_lastProcessedDirName.clear();
   if (!justClearingFilter) {
+    // Files prefetched by the iterator are checked by the tag reader pool
+    // in its worker threads, the results are merged in iteration order in
+    // filterNextFile().
+    m_fileProxyModel->getTagReaderPool()->setFileFilter(m_fileFilter);
     connect(m_fileProxyModelIterator, SIGNAL(nextReady(QPersistentModelIndex)),
             this, SLOT(filterNextFile(QPersistentModelIndex)));
+    m_fileProxyModelIterator->setPrefetchTags(true);
     m_fileProxyModelIterator->start(m_fileProxyModelRootIndex);
   } else {
+    OperationProfiler::end("applyFilter");
     emit fileFiltered(FileFilter::Finished, QString(),
                       m_filterPassed, m_filterTotal);
   }
@@ -2722,8 +3028,11 @@ void Kid3Application::filterNextFile(const QPersistentModelIndex& index)
         emit fileFiltered(FileFilter::Directory, m_lastProcessedDirName,
                           m_filterPassed, m_filterTotal);
       }
-      bool ok;
-      bool pass = m_fileFilter->filter(*taggedFile, &ok);
+      bool pass, ok;
+      if (!m_fileProxyModel->getTagReaderPool()->takeFilterResult(
+            index, pass, ok)) {
+        pass = m_fileFilter->filter(*taggedFile, &ok);
+      }
       if (ok) {
         ++m_filterTotal;
         if (pass) {
@@ -2753,12 +3062,14 @@ void Kid3Application::filterNextFile(const QPersistentModelIndex& index)
     }
   }
   if (terminated) {
+    OperationProfiler::end("applyFilter");
     if (!m_fileFilter->isAborted()) {
       emit fileFiltered(FileFilter::Finished, QString(),
                         m_filterPassed, m_filterTotal);
     }
 
     m_fileProxyModelIterator->abort();
+    m_fileProxyModel->getTagReaderPool()->setFileFilter(0);
     m_fileProxyModel->applyFilteringOutIndexes();
     setFiltered(!m_fileFilter->isEmptyFilterExpression());
 
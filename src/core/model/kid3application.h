@@ -103,6 +103,9 @@ class KID3_CORE_EXPORT Kid3Application : public QObject {
   Q_PROPERTY(int filterPassedCount READ filterPassedCount NOTIFY fileFiltered)
   /** Total number of files checked by filter. */
   Q_PROPERTY(int filterTotalCount READ filterTotalCount NOTIFY fileFiltered)
+  /** Collection of operation statistics. */
+  Q_PROPERTY(bool statisticsEnabled READ isStatisticsEnabled
+             WRITE setStatisticsEnabled NOTIFY statisticsEnabledChanged)
   /** Frame editor. */
   Q_PROPERTY(FrameEditorObject* frameEditor READ frameEditor WRITE setFrameEditor
              NOTIFY frameEditorChanged)
@@ -392,6 +395,13 @@ public:
    */
   Q_INVOKABLE QStringList saveDirectory();
 
+  /**
+   * Get number of files which had to be rewritten completely by the last
+   * saveDirectory() because their tags did not fit into the reserved space.
+   * @return number of rewritten files.
+   */
+  int numberOfRewrittenFiles() const { return m_numRewrittenFiles; }
+
   /**
    * Update tags of selected files to contain contents of frame models.
    */
@@ -446,7 +456,8 @@ public:
    * Export.
    *
    * @param tagVersion tag version
-   * @param path   path of file, "clipboard" for export to clipboard
+   * @param path   path of file, "clipboard" for export to clipboard,
+   *               "-" for export to standard output
    * @param fmtIdx index of format
    *
    * @return true if ok.
@@ -715,6 +726,49 @@ public:
    */
   int filterTotalCount() const { return m_filterTotal; }
 
+  /**
+   * Enable or disable collection of operation statistics.
+   *
+   * @param enable true to enable the OperationProfiler
+   */
+  void setStatisticsEnabled(bool enable);
+
+  /**
+   * Check if operation statistics are collected.
+   *
+   * @return true if the OperationProfiler is enabled.
+   */
+  bool isStatisticsEnabled() const;
+
+  /**
+   * Get operation statistics.
+   *
+   * @return map with counters and durations of operations,
+   *         see OperationProfiler::toVariantMap().
+   */
+  Q_INVOKABLE QVariantMap getStatistics() const;
+
+  /**
+   * Get operation statistics as text.
+   *
+   * @return text with a line per counter and operation.
+   */
+  Q_INVOKABLE QString getStatisticsText() const;
+
+  /**
+   * Clear operation statistics.
+   */
+  Q_INVOKABLE void resetStatistics();
+
+  /**
+   * Write recorded operations to a file in Chrome trace event format.
+   *
+   * @param path path to JSON file
+   *
+   * @return true if ok.
+   */
+  Q_INVOKABLE bool writeStatisticsTrace(const QString& path) const;
+
   /**
    * Get the selected file.
    *
@@ -1243,6 +1297,12 @@ signals:
    */
   void dirNameChanged(const QString& name);
 
+  /**
+   * Emitted when the collection of operation statistics is switched.
+   * @param enabled true if statistics are collected
+   */
+  void statisticsEnabledChanged(bool enabled);
+
   /**
    * Emitted when a file is filtered.
    * @param type filter event type, enum FileFilter::FilterEventType
@@ -1357,6 +1417,14 @@ private slots:
    */
   void onDirectoryOpened();
 
+  /**
+   * Called when files have been changed by other programs.
+   * If a selected file is affected, the frame models are updated with the
+   * tags read again.
+   * @param indexes model indexes of changed files
+   */
+  void onFilesChangedExternally(const QList<QPersistentModelIndex>& indexes);
+
   /**
    * Called when the gatherer thread has finished to load the directory.
    */
@@ -1388,6 +1456,16 @@ private:
    */
   void initPlugins();
 
+  /**
+   * Enable or disable the tag cache depending on configuration.
+   */
+  void applyTagCacheConfig();
+
+  /**
+   * Set up the HTTP response cache depending on configuration.
+   */
+  void applyHttpCacheConfig();
+
   /**
    * Check type of a loaded plugin and register it.
    * @param plugin instance returned by plugin loader
@@ -1544,6 +1622,8 @@ private:
   bool m_filtered;
   /** true if a selection operation is running */
   bool m_selectionOperationRunning;
+  /** Number of files rewritten by last saveDirectory() */
+  int m_numRewrittenFiles;
 
   /** Fallback for path to search for plugins */
   static QString s_pluginsPathFallback;
@@ -623,6 +623,46 @@ void ScriptInterface::reparseConfiguration()
   m_app->readConfig();
 }
 
+/**
+ * Enable or disable collection of operation statistics.
+ *
+ * @param enable true to enable
+ */
+void ScriptInterface::setStatisticsEnabled(bool enable)
+{
+  m_app->setStatisticsEnabled(enable);
+}
+
+/**
+ * Get operation statistics.
+ *
+ * @return text with a line per counter and operation.
+ */
+QString ScriptInterface::getStatistics()
+{
+  return m_app->getStatisticsText();
+}
+
+/**
+ * Clear operation statistics.
+ */
+void ScriptInterface::resetStatistics()
+{
+  m_app->resetStatistics();
+}
+
+/**
+ * Write recorded operations in Chrome trace event format.
+ *
+ * @param path path to JSON file
+ *
+ * @return true if ok.
+ */
+bool ScriptInterface::writeStatisticsTrace(const QString& path)
+{
+  return m_app->writeStatisticsTrace(path);
+}
+
 #if defined HAVE_PHONON || QT_VERSION >= 0x050000
 /**
  * Play selected audio files.
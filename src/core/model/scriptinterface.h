@@ -398,6 +398,34 @@ public slots:
    */
   void reparseConfiguration();
 
+  /**
+   * Enable or disable collection of operation statistics.
+   *
+   * @param enable true to enable
+   */
+  void setStatisticsEnabled(bool enable);
+
+  /**
+   * Get operation statistics.
+   *
+   * @return text with a line per counter and operation.
+   */
+  QString getStatistics();
+
+  /**
+   * Clear operation statistics.
+   */
+  void resetStatistics();
+
+  /**
+   * Write recorded operations in Chrome trace event format.
+   *
+   * @param path path to JSON file
+   *
+   * @return true if ok.
+   */
+  bool writeStatisticsTrace(const QString& path);
+
 #if defined HAVE_PHONON || QT_VERSION >= 0x050000
   /**
    * Play selected audio files.
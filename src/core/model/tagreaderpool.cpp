@@ -0,0 +1,307 @@
+/**
+ * \file tagreaderpool.cpp
+ * Pool of worker threads reading tags in the background.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tagreaderpool.h"
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include "fileproxymodel.h"
+#include "filefilter.h"
+#include "operationprofiler.h"
+
+/**
+ * Runnable reading the tags of a job in a worker thread.
+ */
+class TagReaderPool::ReadTask : public QRunnable {
+public:
+  /**
+   * Constructor.
+   * @param pool tag reader pool
+   * @param job job to process
+   */
+  ReadTask(TagReaderPool* pool, const QSharedPointer<Job>& job)
+    : m_pool(pool), m_job(job) {}
+
+  /**
+   * Read tags of job.
+   */
+  virtual void run() { m_pool->readJob(m_job); }
+
+private:
+  TagReaderPool* m_pool;
+  QSharedPointer<Job> m_job;
+};
+
+
+/**
+ * Destructor, deletes tagged file which was not taken.
+ */
+TagReaderPool::Job::~Job()
+{
+  delete taggedFile;
+}
+
+/**
+ * Constructor.
+ * @param parent parent object
+ */
+TagReaderPool::TagReaderPool(QObject* parent) : QObject(parent),
+  m_threadPool(new QThreadPool(this)), m_fileFilter(0), m_filterGeneration(0),
+  m_numFiltering(0)
+{
+  setObjectName(QLatin1String("TagReaderPool"));
+  m_threadPool->setMaxThreadCount(QThread::idealThreadCount());
+}
+
+/**
+ * Destructor.
+ */
+TagReaderPool::~TagReaderPool()
+{
+  clear();
+}
+
+/**
+ * Check if tags are read in the background.
+ * @return true if worker threads are available.
+ */
+bool TagReaderPool::isEnabled() const
+{
+  return m_threadPool->maxThreadCount() > 1;
+}
+
+/**
+ * Set maximum number of worker threads.
+ * @param maxThreadCount number of threads, a value less than 2 disables
+ * background reading
+ */
+void TagReaderPool::setMaxThreadCount(int maxThreadCount)
+{
+  m_threadPool->setMaxThreadCount(maxThreadCount);
+}
+
+/**
+ * Get maximum number of worker threads.
+ * @return number of threads.
+ */
+int TagReaderPool::maxThreadCount() const
+{
+  return m_threadPool->maxThreadCount();
+}
+
+/**
+ * Start reading the tags of a file in the background.
+ * Nothing is done if the file is already enqueued.
+ *
+ * @param index model index of file
+ * @param filePath absolute path to file
+ */
+void TagReaderPool::enqueue(const QPersistentModelIndex& index,
+                            const QString& filePath)
+{
+  if (!isEnabled() || !index.isValid() || m_jobs.contains(index))
+    return;
+
+  QSharedPointer<Job> job(new Job(filePath, m_filterGeneration));
+  m_jobs.insert(index, job);
+  m_threadPool->start(new ReadTask(this, job));
+}
+
+/**
+ * Take the tagged file read in the background.
+ * If the file is currently being read, this method waits until the worker
+ * has finished. If the worker has not yet started to read the file, the
+ * job is cancelled.
+ *
+ * @param index model index of file
+ *
+ * @return detached tagged file with tags read, the caller takes ownership,
+ * 0 if not available.
+ */
+TaggedFile* TagReaderPool::take(const QPersistentModelIndex& index)
+{
+  QSharedPointer<Job> job = m_jobs.take(index);
+  if (!job)
+    return 0;
+
+  QMutexLocker locker(&m_mutex);
+  if (job->state == Pending) {
+    // Reading it in this thread is faster than waiting for the worker.
+    job->state = Cancelled;
+    return 0;
+  }
+  while (job->state == Running) {
+    m_jobFinished.wait(&m_mutex);
+  }
+  TaggedFile* taggedFile = job->taggedFile;
+  job->taggedFile = 0;
+  if (taggedFile && job->filtered &&
+      job->filterGeneration == m_filterGeneration) {
+    m_filterResults.insert(index,
+                           FilterResult(job->filterPassed, job->filterOk));
+  }
+  return taggedFile;
+}
+
+/**
+ * Set file filter which is evaluated in the worker threads.
+ * Files enqueued after this call are checked with @a filter after their
+ * tags have been read, the result can be taken with takeFilterResult()
+ * after the file has been taken. If filters are currently evaluated,
+ * this method waits until they are finished.
+ *
+ * @param filter file filter with initialized parser, 0 to stop
+ * evaluating filters
+ */
+void TagReaderPool::setFileFilter(const FileFilter* filter)
+{
+  QMutexLocker locker(&m_mutex);
+  // The filter may be modified after it has been replaced, so it must no
+  // longer be in use.
+  while (m_numFiltering > 0) {
+    m_jobFinished.wait(&m_mutex);
+  }
+  m_fileFilter = filter;
+  ++m_filterGeneration;
+  m_filterResults.clear();
+}
+
+/**
+ * Take the filter result of a file which was taken using take().
+ * @param index model index of file
+ * @param pass true is returned here if file passes through the filter
+ * @param ok false is returned here if parsing the filter failed
+ * @return true if the filter set with setFileFilter() has been evaluated
+ * for the file, false if it has to be evaluated by the caller.
+ */
+bool TagReaderPool::takeFilterResult(const QPersistentModelIndex& index,
+                                     bool& pass, bool& ok)
+{
+  QHash<QPersistentModelIndex, FilterResult>::iterator it =
+      m_filterResults.find(index);
+  if (it == m_filterResults.end())
+    return false;
+
+  pass = it->passed;
+  ok = it->ok;
+  m_filterResults.erase(it);
+  return true;
+}
+
+/**
+ * Cancel all pending jobs and delete results which were not taken.
+ */
+void TagReaderPool::clear()
+{
+  m_mutex.lock();
+  for (QHash<QPersistentModelIndex, QSharedPointer<Job> >::const_iterator it =
+       m_jobs.constBegin();
+       it != m_jobs.constEnd();
+       ++it) {
+    if ((*it)->state == Pending) {
+      (*it)->state = Cancelled;
+    }
+  }
+  m_mutex.unlock();
+  m_threadPool->waitForDone();
+  m_jobs.clear();
+  m_filterResults.clear();
+}
+
+/**
+ * Read tags of a job, called in a worker thread.
+ * @param job read job
+ */
+void TagReaderPool::readJob(const QSharedPointer<Job>& job)
+{
+  m_mutex.lock();
+  if (job->state != Pending) {
+    m_mutex.unlock();
+    return;
+  }
+  job->state = Running;
+  m_mutex.unlock();
+
+  TaggedFile* taggedFile = FileProxyModel::createTaggedFile(
+        QFileInfo(job->filePath).fileName(), QPersistentModelIndex());
+  if (taggedFile) {
+    taggedFile->setDetachedFilePath(job->filePath);
+    const bool profiled = OperationProfiler::isEnabled();
+    const qint64 startTime =
+        profiled ? OperationProfiler::instance().timestamp() : 0;
+    taggedFile->readTags(false);
+    // Each fallback can replace the detached tagged file by a new one,
+    // the replaced file has to be deleted after every step.
+    TaggedFile* readFile = FileProxyModel::readWithId3V24IfId3V24(taggedFile);
+    if (readFile != taggedFile) {
+      delete taggedFile;
+      taggedFile = readFile;
+    }
+    readFile = FileProxyModel::readWithOggFlacIfInvalidOgg(taggedFile);
+    if (readFile != taggedFile) {
+      delete taggedFile;
+      taggedFile = readFile;
+    }
+    if (profiled) {
+      OperationProfiler::instance().addDuration(
+            "readTags", taggedFile->taggedFileKey(), startTime);
+      OperationProfiler::count(OperationProfiler::FilesRead);
+      OperationProfiler::count(OperationProfiler::FileBytesRead,
+                               QFileInfo(job->filePath).size());
+    }
+  }
+
+  m_mutex.lock();
+  const FileFilter* filter =
+      taggedFile && job->filterGeneration == m_filterGeneration
+      ? m_fileFilter : 0;
+  if (filter) {
+    ++m_numFiltering;
+  }
+  m_mutex.unlock();
+
+  if (filter) {
+    // The filter is not modified by filter(), so it can be evaluated
+    // concurrently for different files.
+    job->filterPassed = filter->filter(*taggedFile, &job->filterOk);
+    job->filtered = true;
+  }
+  if (taggedFile) {
+    // Do not keep file descriptors open until the file is taken.
+    taggedFile->closeFileHandle();
+  }
+
+  m_mutex.lock();
+  if (filter) {
+    --m_numFiltering;
+  }
+  job->taggedFile = taggedFile;
+  job->state = Finished;
+  m_jobFinished.wakeAll();
+  m_mutex.unlock();
+}
@@ -0,0 +1,202 @@
+/**
+ * \file tagreaderpool.h
+ * Pool of worker threads reading tags in the background.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAGREADERPOOL_H
+#define TAGREADERPOOL_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSharedPointer>
+#include <QPersistentModelIndex>
+#include "kid3api.h"
+
+class QThreadPool;
+class TaggedFile;
+class FileFilter;
+
+/**
+ * Pool of worker threads reading tags in the background.
+ *
+ * Files which will be processed soon (e.g. by the file filter) are enqueued
+ * with their model index. A worker thread creates a detached tagged file for
+ * each of them (see TaggedFile::setDetachedFilePath()) and reads its tags.
+ * When the file is needed in the model thread, the read tagged file is taken
+ * from the pool using take() and replaces the unread tagged file in the model.
+ * All methods except the worker functions must be called from the thread of
+ * the model.
+ */
+class KID3_CORE_EXPORT TagReaderPool : public QObject {
+public:
+  /**
+   * Constructor.
+   * @param parent parent object
+   */
+  explicit TagReaderPool(QObject* parent = 0);
+
+  /**
+   * Destructor.
+   */
+  virtual ~TagReaderPool();
+
+  /**
+   * Check if tags are read in the background.
+   * @return true if worker threads are available.
+   */
+  bool isEnabled() const;
+
+  /**
+   * Set maximum number of worker threads.
+   * @param maxThreadCount number of threads, a value less than 2 disables
+   * background reading
+   */
+  void setMaxThreadCount(int maxThreadCount);
+
+  /**
+   * Get maximum number of worker threads.
+   * @return number of threads.
+   */
+  int maxThreadCount() const;
+
+  /**
+   * Start reading the tags of a file in the background.
+   * Nothing is done if the file is already enqueued.
+   *
+   * @param index model index of file
+   * @param filePath absolute path to file
+   */
+  void enqueue(const QPersistentModelIndex& index, const QString& filePath);
+
+  /**
+   * Check if a file is enqueued.
+   * @param index model index of file
+   * @return true if file is enqueued, being read or has been read.
+   */
+  bool contains(const QPersistentModelIndex& index) const {
+    return m_jobs.contains(index);
+  }
+
+  /**
+   * Take the tagged file read in the background.
+   * If the file is currently being read, this method waits until the worker
+   * has finished. If the worker has not yet started to read the file, the
+   * job is cancelled.
+   *
+   * @param index model index of file
+   *
+   * @return detached tagged file with tags read, the caller takes ownership,
+   * 0 if not available.
+   */
+  TaggedFile* take(const QPersistentModelIndex& index);
+
+  /**
+   * Set file filter which is evaluated in the worker threads.
+   * Files enqueued after this call are checked with @a filter after their
+   * tags have been read, the result can be taken with takeFilterResult()
+   * after the file has been taken. If filters are currently evaluated,
+   * this method waits until they are finished.
+   *
+   * @param filter file filter with initialized parser, 0 to stop
+   * evaluating filters
+   */
+  void setFileFilter(const FileFilter* filter);
+
+  /**
+   * Take the filter result of a file which was taken using take().
+   * @param index model index of file
+   * @param pass true is returned here if file passes through the filter
+   * @param ok false is returned here if parsing the filter failed
+   * @return true if the filter set with setFileFilter() has been evaluated
+   * for the file, false if it has to be evaluated by the caller.
+   */
+  bool takeFilterResult(const QPersistentModelIndex& index,
+                        bool& pass, bool& ok);
+
+  /**
+   * Discard the filter result of a file which was taken using take() but
+   * is not used.
+   * @param index model index of file
+   */
+  void discardFilterResult(const QPersistentModelIndex& index) {
+    m_filterResults.remove(index);
+  }
+
+  /**
+   * Cancel all pending jobs and delete results which were not taken.
+   */
+  void clear();
+
+private:
+  class ReadTask;
+
+  /** State of a read job. */
+  enum JobState {
+    Pending, Running, Finished, Cancelled
+  };
+
+  /** Job shared between model thread and worker thread. */
+  struct Job {
+    Job(const QString& path, int generation) : filePath(path), taggedFile(0),
+      state(Pending), filterGeneration(generation), filtered(false),
+      filterPassed(false), filterOk(false) {}
+    ~Job();
+
+    QString filePath;
+    TaggedFile* taggedFile;
+    JobState state;
+    int filterGeneration; /**< value of m_filterGeneration when enqueued */
+    bool filtered;        /**< true if filter was evaluated */
+    bool filterPassed;    /**< true if file passed the filter */
+    bool filterOk;        /**< false if filter could not be parsed */
+  };
+
+  /** Result of a filter evaluated by a worker. */
+  struct FilterResult {
+    FilterResult(bool p = false, bool o = false) : passed(p), ok(o) {}
+    bool passed;
+    bool ok;
+  };
+
+  /**
+   * Read tags of a job, called in a worker thread.
+   * @param job read job
+   */
+  void readJob(const QSharedPointer<Job>& job);
+
+  QHash<QPersistentModelIndex, QSharedPointer<Job> > m_jobs;
+  QHash<QPersistentModelIndex, FilterResult> m_filterResults;
+  QThreadPool* m_threadPool;
+  QMutex m_mutex;
+  QWaitCondition m_jobFinished;
+  const FileFilter* m_fileFilter;
+  /** Incremented when the filter is changed to detect outdated jobs */
+  int m_filterGeneration;
+  /** Number of workers currently evaluating m_fileFilter */
+  int m_numFiltering;
+};
+
+#endif // TAGREADERPOOL_H
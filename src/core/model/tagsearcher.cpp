@@ -28,6 +28,7 @@
 #include "trackdatamodel.h"
 #include "fileproxymodel.h"
 #include "bidirfileproxymodeliterator.h"
+#include "tagsearchindex.h"
 
 /**
  * Constructor.
@@ -105,6 +106,7 @@ void TagSearcher::setModel(FileProxyModel* model)
   m_fileProxyModel = model;
   if (m_fileProxyModel && !m_iterator) {
     m_iterator = new BiDirFileProxyModelIterator(m_fileProxyModel, this);
+    m_iterator->setPrefetchTags(true);
     connect(m_iterator, SIGNAL(nextReady(QPersistentModelIndex)),
             this, SLOT(searchNextFile(QPersistentModelIndex)));
   }
@@ -185,8 +187,20 @@ void TagSearcher::searchNextFile(const QPersistentModelIndex& index)
 {
   if (index.isValid()) {
     if (TaggedFile* taggedFile = FileProxyModel::getTaggedFileOfIndex(index)) {
+      if (!m_indexTrigrams.isEmpty() && m_fileProxyModel &&
+          !m_fileProxyModel->getTagSearchIndex()->mayContain(
+            taggedFile, m_indexTrigrams)) {
+        // The index knows that the file does not contain the text, so its
+        // tags are not read.
+        return;
+      }
       emit progress(taggedFile->getFilename());
       taggedFile = FileProxyModel::readTagsFromTaggedFile(taggedFile);
+      if (m_fileProxyModel && !taggedFile->isChanged()) {
+        // The index is built while searching, so that reading tags does
+        // not have to get all frames, the next search can skip the file.
+        m_fileProxyModel->getTagSearchIndex()->addFile(taggedFile);
+      }
 
       Position pos;
       if (searchInFile(taggedFile, &pos, 1)) {
@@ -452,6 +466,9 @@ void TagSearcher::setParameters(Parameters params)
   if (m_iterator) {
     m_iterator->setDirectionBackwards(flags & Backwards);
   }
+  m_indexTrigrams = flags & RegExp
+      ? TagSearchIndex::regExpTrigrams(m_params.getSearchText())
+      : TagSearchIndex::textTrigrams(m_params.getSearchText());
 #if QT_VERSION >= 0x050100
   if (flags & RegExp) {
     m_regExp.setPattern(m_params.getSearchText());
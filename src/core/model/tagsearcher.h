@@ -35,6 +35,7 @@
 #include <QRegExp>
 #endif
 #include <QPersistentModelIndex>
+#include <QVector>
 #include "iabortable.h"
 #include "frame.h"
 #include "kid3api.h"
@@ -361,6 +362,8 @@ private:
 #else
   QRegExp m_regExp;
 #endif
+  /** Trigrams required in files matching the search, empty if unknown */
+  QVector<quint32> m_indexTrigrams;
   bool m_aborted;
   bool m_started;
 };
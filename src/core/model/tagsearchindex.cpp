@@ -0,0 +1,372 @@
+/**
+ * \file tagsearchindex.cpp
+ * Index with the trigrams of file names and tag values.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tagsearchindex.h"
+#include <algorithm>
+#include "taggedfile.h"
+
+namespace {
+
+/** Minimum length of a literal usable with the index. */
+const int TrigramLength = 3;
+
+/**
+ * Get trigram code of three case folded characters.
+ * Characters above U+03FF can share codes, which only makes the index
+ * return more files to be searched.
+ * @param a first character
+ * @param b second character
+ * @param c third character
+ * @return trigram code.
+ */
+inline quint32 trigramCode(QChar a, QChar b, QChar c)
+{
+  return (static_cast<quint32>(a.unicode() & 0x3ff) << 20) |
+         (static_cast<quint32>(b.unicode() & 0x3ff) << 10) |
+          static_cast<quint32>(c.unicode() & 0x3ff);
+}
+
+/**
+ * Check if a character is a hexadecimal digit.
+ * @param ch character
+ * @return true if ch is 0-9, a-f or A-F.
+ */
+inline bool isHexDigit(QChar ch)
+{
+  const ushort c = ch.unicode();
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+         (c >= 'A' && c <= 'F');
+}
+
+}
+
+/**
+ * Constructor.
+ */
+TagSearchIndex::TagSearchIndex() : m_enabled(false)
+{
+}
+
+/**
+ * Destructor.
+ */
+TagSearchIndex::~TagSearchIndex()
+{
+}
+
+/**
+ * Enable or disable the index.
+ * All entries are removed when the index is disabled.
+ * @param enable true to enable
+ */
+void TagSearchIndex::setEnabled(bool enable)
+{
+  m_enabled = enable;
+  if (!m_enabled) {
+    clear();
+  }
+}
+
+/**
+ * Add a file with read and unchanged tags to the index.
+ * Nothing is done if the index is disabled or the file is already
+ * indexed.
+ * @param taggedFile tagged file
+ */
+void TagSearchIndex::addFile(TaggedFile* taggedFile)
+{
+  if (!m_enabled || m_trigramsOfFile.contains(taggedFile))
+    return;
+
+  QStringList strings;
+  strings.append(taggedFile->getFilename());
+  FOR_ALL_TAGS(tagNr) {
+    if (taggedFile->isTagSupported(tagNr)) {
+      FrameCollection frames;
+      taggedFile->getAllFrames(tagNr, frames);
+      for (FrameCollection::const_iterator it = frames.begin();
+           it != frames.end();
+           ++it) {
+        strings.append(it->getValue());
+      }
+    }
+  }
+  insert(taggedFile, strings);
+}
+
+/**
+ * Add the strings of a file to the index.
+ * @param taggedFile tagged file used as a key
+ * @param strings file name and frame values of @a taggedFile
+ */
+void TagSearchIndex::insert(const TaggedFile* taggedFile,
+                            const QStringList& strings)
+{
+  QVector<quint32> trigrams;
+  foreach (const QString& str, strings) {
+    addTrigrams(str, trigrams);
+  }
+  sortUnique(trigrams);
+  m_trigramsOfFile.insert(taggedFile, trigrams);
+}
+
+/**
+ * Remove a file from the index.
+ * @param taggedFile tagged file
+ */
+void TagSearchIndex::removeFile(const TaggedFile* taggedFile)
+{
+  m_trigramsOfFile.remove(taggedFile);
+}
+
+/**
+ * Remove all files from the index.
+ */
+void TagSearchIndex::clear()
+{
+  m_trigramsOfFile.clear();
+}
+
+/**
+ * Check if a file can contain a search text.
+ * @param taggedFile tagged file
+ * @param trigrams trigrams of search text, see textTrigrams() and
+ *                 regExpTrigrams()
+ * @return false if the file is indexed and does not contain all
+ *         @a trigrams, true if it has to be searched.
+ */
+bool TagSearchIndex::mayContain(const TaggedFile* taggedFile,
+                                const QVector<quint32>& trigrams) const
+{
+  QHash<const TaggedFile*, QVector<quint32> >::const_iterator it =
+      m_trigramsOfFile.constFind(taggedFile);
+  if (it == m_trigramsOfFile.constEnd())
+    return true;
+
+  const QVector<quint32>& fileTrigrams = *it;
+  foreach (quint32 trigram, trigrams) {
+    if (!std::binary_search(fileTrigrams.constBegin(), fileTrigrams.constEnd(),
+                            trigram))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Get trigrams of a plain search text.
+ * @param text search text
+ * @return sorted trigrams, empty if the text is too short to be used
+ *         with the index.
+ */
+QVector<quint32> TagSearchIndex::textTrigrams(const QString& text)
+{
+  QVector<quint32> trigrams;
+  addTrigrams(text, trigrams);
+  sortUnique(trigrams);
+  return trigrams;
+}
+
+/**
+ * Get trigrams which are required for a regular expression to match.
+ * @param pattern regular expression
+ * @return sorted trigrams of requiredLiterals(), empty if the index
+ *         cannot be used with the regular expression.
+ */
+QVector<quint32> TagSearchIndex::regExpTrigrams(const QString& pattern)
+{
+  QVector<quint32> trigrams;
+  foreach (const QString& literal, requiredLiterals(pattern)) {
+    addTrigrams(literal, trigrams);
+  }
+  sortUnique(trigrams);
+  return trigrams;
+}
+
+/**
+ * Get literal strings which must be contained in a string matching a
+ * regular expression.
+ * The extraction is conservative, alternatives, groups, character
+ * classes and optional characters are not used, no literals are
+ * returned for patterns with alternatives or inline options.
+ * @param pattern regular expression
+ * @return literals with at least three characters.
+ */
+QStringList TagSearchIndex::requiredLiterals(const QString& pattern)
+{
+  QStringList literals;
+  if (pattern.contains(QLatin1Char('|')) ||
+      pattern.contains(QLatin1String("(?")))
+    return literals;
+
+  QString literal;
+  int depth = 0;
+  const int len = pattern.length();
+  for (int i = 0; i < len; ++i) {
+    QChar ch = pattern.at(i);
+    bool isLiteral = false;
+    if (ch == QLatin1Char('\\')) {
+      // Escaped letters and digits are character classes, anchors, back
+      // references or character codes.
+      if (i + 1 < len && !pattern.at(i + 1).isLetterOrNumber()) {
+        ch = pattern.at(++i);
+        isLiteral = true;
+      } else if (i + 1 < len) {
+        i = skipEscape(pattern, i + 1);
+      }
+    } else if (ch == QLatin1Char('{')) {
+      // Skip quantifier, the quantified character has already been dropped.
+      int closingBracePos = pattern.indexOf(QLatin1Char('}'), i + 1);
+      if (closingBracePos != -1) {
+        i = closingBracePos;
+      }
+    } else if (ch == QLatin1Char('[')) {
+      // Skip character class, a closing bracket at the start is literal.
+      ++i;
+      if (i < len && pattern.at(i) == QLatin1Char('^'))
+        ++i;
+      if (i < len && pattern.at(i) == QLatin1Char(']'))
+        ++i;
+      while (i < len && pattern.at(i) != QLatin1Char(']')) {
+        if (pattern.at(i) == QLatin1Char('\\'))
+          ++i;
+        ++i;
+      }
+    } else if (ch == QLatin1Char('(')) {
+      ++depth;
+    } else if (ch == QLatin1Char(')')) {
+      --depth;
+    } else {
+      isLiteral = QString(QLatin1String(".^$*+?{")).indexOf(ch) == -1;
+    }
+
+    if (isLiteral && depth == 0) {
+      QChar next = i + 1 < len ? pattern.at(i + 1) : QChar();
+      if (next == QLatin1Char('?') || next == QLatin1Char('*') ||
+          next == QLatin1Char('{')) {
+        // Optional character ends the literal.
+        isLiteral = false;
+      } else {
+        literal += ch;
+        if (next == QLatin1Char('+')) {
+          // The repeated character is the last one known to follow.
+          isLiteral = false;
+        }
+      }
+    } else {
+      isLiteral = false;
+    }
+    if (!isLiteral) {
+      if (literal.length() >= TrigramLength) {
+        literals.append(literal);
+      }
+      literal.clear();
+    }
+  }
+  if (literal.length() >= TrigramLength) {
+    literals.append(literal);
+  }
+  return literals;
+}
+
+/**
+ * Skip the characters of an escape sequence starting with a letter or
+ * digit.
+ * Skipping more characters than the escape sequence has only loses
+ * literal text, so all characters which could be part of it are skipped.
+ * @param pattern regular expression
+ * @param pos position of the letter or digit after the backslash
+ * @return position of the last character of the escape sequence.
+ */
+int TagSearchIndex::skipEscape(const QString& pattern, int pos)
+{
+  const int len = pattern.length();
+  const QChar esc = pattern.at(pos);
+  if (pos + 1 < len && pattern.at(pos + 1) == QLatin1Char('{')) {
+    // \x{hhh}, \p{Property}, \g{1}, ...
+    int closingBracePos = pattern.indexOf(QLatin1Char('}'), pos + 2);
+    return closingBracePos != -1 ? closingBracePos : len - 1;
+  }
+  if (esc == QLatin1Char('x') || esc == QLatin1Char('u')) {
+    // Hexadecimal character code
+    while (pos + 1 < len && isHexDigit(pattern.at(pos + 1))) {
+      ++pos;
+    }
+  } else if (esc.isDigit()) {
+    // Octal character code or back reference
+    while (pos + 1 < len && pattern.at(pos + 1).isDigit()) {
+      ++pos;
+    }
+  } else if (esc == QLatin1Char('c')) {
+    // Control character
+    if (pos + 1 < len) {
+      ++pos;
+    }
+  } else if (esc == QLatin1Char('k') || esc == QLatin1Char('g')) {
+    // Named back reference \k<name>
+    if (pos + 1 < len && (pattern.at(pos + 1) == QLatin1Char('<') ||
+                          pattern.at(pos + 1) == QLatin1Char('\''))) {
+      int endPos = pattern.indexOf(
+            pattern.at(pos + 1) == QLatin1Char('<')
+            ? QLatin1Char('>') : QLatin1Char('\''), pos + 2);
+      return endPos != -1 ? endPos : len - 1;
+    }
+  } else if (esc == QLatin1Char('Q')) {
+    // Quoted text up to \E, it is not used as literal.
+    int endPos = pattern.indexOf(QLatin1String("\\E"), pos + 1);
+    return endPos != -1 ? endPos + 1 : len - 1;
+  }
+  return pos;
+}
+
+/**
+ * Add the trigrams of a string.
+ * @param str string
+ * @param trigrams the trigrams of @a str are appended here
+ */
+void TagSearchIndex::addTrigrams(const QString& str,
+                                 QVector<quint32>& trigrams)
+{
+  if (str.length() < TrigramLength)
+    return;
+
+  const QString folded = str.toCaseFolded();
+  const QChar* chars = folded.constData();
+  for (int i = 0; i + TrigramLength <= folded.length(); ++i) {
+    trigrams.append(trigramCode(chars[i], chars[i + 1], chars[i + 2]));
+  }
+}
+
+/**
+ * Sort trigrams and remove duplicates.
+ * @param trigrams trigrams
+ */
+void TagSearchIndex::sortUnique(QVector<quint32>& trigrams)
+{
+  std::sort(trigrams.begin(), trigrams.end());
+  trigrams.erase(std::unique(trigrams.begin(), trigrams.end()),
+                 trigrams.end());
+  trigrams.squeeze();
+}
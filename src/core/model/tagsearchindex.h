@@ -0,0 +1,186 @@
+/**
+ * \file tagsearchindex.h
+ * Index with the trigrams of file names and tag values.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAGSEARCHINDEX_H
+#define TAGSEARCHINDEX_H
+
+#include <QHash>
+#include <QVector>
+#include <QStringList>
+#include "kid3api.h"
+
+class TaggedFile;
+
+/**
+ * Index with the trigrams of file names and tag values.
+ *
+ * For every indexed tagged file, the sorted trigrams (sequences of three
+ * case folded characters) of its file name and of the values of all its
+ * frames are stored. A file can only contain a search text if it contains
+ * all trigrams of the text, so files which do not match can be skipped
+ * without reading their tags. Files which are not in the index always
+ * have to be searched. Files are added when they are searched, so
+ * that reading tags in other operations does not have to get all their
+ * frames.
+ *
+ * Only files with unchanged tags shall be added, the owner of the index
+ * has to remove files when they are modified, reread or deleted.
+ */
+class KID3_CORE_EXPORT TagSearchIndex {
+public:
+  /**
+   * Constructor.
+   */
+  TagSearchIndex();
+
+  /**
+   * Destructor.
+   */
+  ~TagSearchIndex();
+
+  /**
+   * Enable or disable the index.
+   * All entries are removed when the index is disabled.
+   * @param enable true to enable
+   */
+  void setEnabled(bool enable);
+
+  /**
+   * Check if index is enabled.
+   * @return true if enabled.
+   */
+  bool isEnabled() const { return m_enabled; }
+
+  /**
+   * Get number of indexed files.
+   * @return number of files.
+   */
+  int size() const { return m_trigramsOfFile.size(); }
+
+  /**
+   * Check if a file is indexed.
+   * @param taggedFile tagged file
+   * @return true if @a taggedFile is in the index.
+   */
+  bool contains(const TaggedFile* taggedFile) const {
+    return m_trigramsOfFile.contains(taggedFile);
+  }
+
+  /**
+   * Add a file with read and unchanged tags to the index.
+   * Nothing is done if the index is disabled or the file is already
+   * indexed.
+   * @param taggedFile tagged file
+   */
+  void addFile(TaggedFile* taggedFile);
+
+  /**
+   * Add the strings of a file to the index.
+   * @param taggedFile tagged file used as a key
+   * @param strings file name and frame values of @a taggedFile
+   */
+  void insert(const TaggedFile* taggedFile, const QStringList& strings);
+
+  /**
+   * Remove a file from the index.
+   * @param taggedFile tagged file
+   */
+  void removeFile(const TaggedFile* taggedFile);
+
+  /**
+   * Remove all files from the index.
+   */
+  void clear();
+
+  /**
+   * Check if a file can contain a search text.
+   * @param taggedFile tagged file
+   * @param trigrams trigrams of search text, see textTrigrams() and
+   *                 regExpTrigrams()
+   * @return false if the file is indexed and does not contain all
+   *         @a trigrams, true if it has to be searched.
+   */
+  bool mayContain(const TaggedFile* taggedFile,
+                  const QVector<quint32>& trigrams) const;
+
+  /**
+   * Get trigrams of a plain search text.
+   * @param text search text
+   * @return sorted trigrams, empty if the text is too short to be used
+   *         with the index.
+   */
+  static QVector<quint32> textTrigrams(const QString& text);
+
+  /**
+   * Get trigrams which are required for a regular expression to match.
+   * @param pattern regular expression
+   * @return sorted trigrams of requiredLiterals(), empty if the index
+   *         cannot be used with the regular expression.
+   */
+  static QVector<quint32> regExpTrigrams(const QString& pattern);
+
+  /**
+   * Get literal strings which must be contained in a string matching a
+   * regular expression.
+   * The extraction is conservative, alternatives, groups, character
+   * classes and optional characters are not used, no literals are
+   * returned for patterns with alternatives or inline options.
+   * @param pattern regular expression
+   * @return literals with at least three characters.
+   */
+  static QStringList requiredLiterals(const QString& pattern);
+
+private:
+  TagSearchIndex(const TagSearchIndex&);
+  TagSearchIndex& operator=(const TagSearchIndex&);
+
+  /**
+   * Add the trigrams of a string.
+   * @param str string
+   * @param trigrams the trigrams of @a str are appended here
+   */
+  static void addTrigrams(const QString& str, QVector<quint32>& trigrams);
+
+  /**
+   * Sort trigrams and remove duplicates.
+   * @param trigrams trigrams
+   */
+  static void sortUnique(QVector<quint32>& trigrams);
+
+  /**
+   * Skip the characters of an escape sequence starting with a letter or
+   * digit.
+   * @param pattern regular expression
+   * @param pos position of the letter or digit after the backslash
+   * @return position of the last character of the escape sequence.
+   */
+  static int skipEscape(const QString& pattern, int pos);
+
+  QHash<const TaggedFile*, QVector<quint32> > m_trigramsOfFile;
+  bool m_enabled;
+};
+
+#endif // TAGSEARCHINDEX_H
@@ -0,0 +1,225 @@
+/**
+ * \file tagwriterpool.cpp
+ * Pool of worker threads writing tags concurrently.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tagwriterpool.h"
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutexLocker>
+#include <QFileInfo>
+#include "taggedfile.h"
+#include "fileproxymodel.h"
+#include "operationprofiler.h"
+
+/**
+ * Runnable writing the tags of a job in a worker thread.
+ */
+class TagWriterPool::WriteTask : public QRunnable {
+public:
+  /**
+   * Constructor.
+   * @param pool tag writer pool
+   * @param job job to process
+   */
+  WriteTask(TagWriterPool* pool, const QSharedPointer<Job>& job)
+    : m_pool(pool), m_job(job) {}
+
+  /**
+   * Write tags of job.
+   */
+  virtual void run() { m_pool->writeJob(m_job); }
+
+private:
+  TagWriterPool* m_pool;
+  QSharedPointer<Job> m_job;
+};
+
+
+/**
+ * Constructor.
+ * @param parent parent object
+ */
+TagWriterPool::TagWriterPool(QObject* parent) : QObject(parent),
+  m_threadPool(new QThreadPool(this)), m_numOutstanding(0)
+{
+  setObjectName(QLatin1String("TagWriterPool"));
+  m_threadPool->setMaxThreadCount(QThread::idealThreadCount());
+}
+
+/**
+ * Destructor.
+ * Pending jobs are cancelled, results which were not taken are attached
+ * to the model.
+ */
+TagWriterPool::~TagWriterPool()
+{
+  cancelPending();
+  int id;
+  WriteResult result;
+  while (takeResult(true, &id, &result)) {
+  }
+  m_threadPool->waitForDone();
+}
+
+/**
+ * Set maximum number of files written concurrently.
+ * @param maxThreadCount number of threads
+ */
+void TagWriterPool::setMaxThreadCount(int maxThreadCount)
+{
+  m_threadPool->setMaxThreadCount(maxThreadCount);
+}
+
+/**
+ * Get maximum number of files written concurrently.
+ * @return number of threads.
+ */
+int TagWriterPool::maxThreadCount() const
+{
+  return m_threadPool->maxThreadCount();
+}
+
+/**
+ * Start writing the tags of a file in a worker thread.
+ * The tagged file is detached from the model until its result is taken
+ * with takeResult().
+ *
+ * @param taggedFile tagged file with changed tags, the file name must not
+ * be changed
+ * @param id identifier returned with the result
+ * @param preserve true to preserve file time stamps
+ */
+void TagWriterPool::enqueue(TaggedFile* taggedFile, int id, bool preserve)
+{
+  Q_ASSERT(!taggedFile->isFilenameChanged());
+  // File handles are registered by the model thread, reopen in the worker.
+  taggedFile->closeFileHandle();
+  QPersistentModelIndex index = taggedFile->detachFromIndex();
+  FileProxyModel* model = const_cast<FileProxyModel*>(
+        qobject_cast<const FileProxyModel*>(index.model()));
+  if (model) {
+    model->beginWritingTaggedFile(index);
+  }
+  QSharedPointer<Job> job(new Job(taggedFile, model, index, id, preserve));
+  m_jobs.append(job);
+  ++m_numOutstanding;
+  m_threadPool->start(new WriteTask(this, job));
+}
+
+/**
+ * Take the result of a finished job.
+ * The tagged file is attached to the model again. If its row has been
+ * removed while it was written, it is deleted when control returns to
+ * the event loop.
+ *
+ * @param wait true to wait until a job is finished if none is available
+ * @param id the identifier passed to enqueue() is returned here
+ * @param result the result of the job is returned here
+ *
+ * @return tagged file, 0 if no result is available.
+ */
+TaggedFile* TagWriterPool::takeResult(bool wait, int* id, WriteResult* result)
+{
+  if (m_numOutstanding <= 0)
+    return 0;
+
+  QMutexLocker locker(&m_mutex);
+  while (wait && m_finishedJobs.isEmpty()) {
+    m_jobFinished.wait(&m_mutex);
+  }
+  if (m_finishedJobs.isEmpty())
+    return 0;
+
+  QSharedPointer<Job> job = m_finishedJobs.dequeue();
+  locker.unlock();
+  if (--m_numOutstanding == 0) {
+    m_jobs.clear();
+  }
+  *id = job->id;
+  *result = job->state == Cancelled
+      ? NotWritten : job->ok ? Written : WriteFailed;
+  TaggedFile* taggedFile = job->taggedFile;
+  if (job->model &&
+      job->model->endWritingTaggedFile(job->index, taggedFile)) {
+    taggedFile->attachToIndex(job->index);
+  }
+  return taggedFile;
+}
+
+/**
+ * Cancel all jobs which have not been started yet.
+ * Their results are returned by takeResult() as NotWritten.
+ */
+void TagWriterPool::cancelPending()
+{
+  QMutexLocker locker(&m_mutex);
+  foreach (const QSharedPointer<Job>& job, m_jobs) {
+    if (job->state == Pending) {
+      job->state = Cancelled;
+      m_finishedJobs.enqueue(job);
+    }
+  }
+  m_jobs.clear();
+  m_jobFinished.wakeAll();
+}
+
+/**
+ * Write tags of a job, called in a worker thread.
+ * @param job write job
+ */
+void TagWriterPool::writeJob(const QSharedPointer<Job>& job)
+{
+  m_mutex.lock();
+  if (job->state != Pending) {
+    m_mutex.unlock();
+    return;
+  }
+  job->state = Running;
+  m_mutex.unlock();
+
+  bool renamed = false;
+  bool ok;
+  {
+    OperationProfiler::Scope scope("writeTags");
+    ok = job->taggedFile->writeTags(false, &renamed, job->preserve);
+    if (scope.isActive()) {
+      scope.setCategory(job->taggedFile->taggedFileKey());
+      OperationProfiler::count(OperationProfiler::FilesWritten);
+      OperationProfiler::count(
+            OperationProfiler::FileBytesWritten,
+            QFileInfo(job->taggedFile->getAbsFilename()).size());
+    }
+  }
+  // Do not keep file descriptors open which are not registered.
+  job->taggedFile->closeFileHandle();
+
+  m_mutex.lock();
+  job->ok = ok;
+  job->state = Finished;
+  m_finishedJobs.enqueue(job);
+  m_jobFinished.wakeAll();
+  m_mutex.unlock();
+}
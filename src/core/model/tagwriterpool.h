@@ -0,0 +1,168 @@
+/**
+ * \file tagwriterpool.h
+ * Pool of worker threads writing tags concurrently.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAGWRITERPOOL_H
+#define TAGWRITERPOOL_H
+
+#include <QObject>
+#include <QList>
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSharedPointer>
+#include <QPersistentModelIndex>
+#include "kid3api.h"
+
+class QThreadPool;
+class TaggedFile;
+class FileProxyModel;
+
+/**
+ * Pool of worker threads writing tags concurrently.
+ *
+ * Changed tagged files are enqueued from the thread of the model. They are
+ * detached from the model (see TaggedFile::detachFromIndex()), hidden from
+ * it (see FileProxyModel::beginWritingTaggedFile()) and written in a worker
+ * thread. As long as a worker owns a tagged file, the model thread can
+ * process events without accessing it. The results are taken back in the
+ * model thread using takeResult(), which attaches the tagged files to the
+ * model again.
+ * Files whose name is changed must not be enqueued, renaming is left to the
+ * model thread to keep it in a deterministic order.
+ * All methods except the worker functions must be called from the thread of
+ * the model.
+ */
+class KID3_CORE_EXPORT TagWriterPool : public QObject {
+public:
+  /** Result of a write job. */
+  enum WriteResult {
+    Written,     /**< Tags written successfully */
+    WriteFailed, /**< Writing tags failed */
+    NotWritten   /**< Job cancelled before tags were written */
+  };
+
+  /**
+   * Constructor.
+   * @param parent parent object
+   */
+  explicit TagWriterPool(QObject* parent = 0);
+
+  /**
+   * Destructor.
+   * Pending jobs are cancelled, results which were not taken are attached
+   * to the model.
+   */
+  virtual ~TagWriterPool();
+
+  /**
+   * Set maximum number of files written concurrently.
+   * @param maxThreadCount number of threads
+   */
+  void setMaxThreadCount(int maxThreadCount);
+
+  /**
+   * Get maximum number of files written concurrently.
+   * @return number of threads.
+   */
+  int maxThreadCount() const;
+
+  /**
+   * Start writing the tags of a file in a worker thread.
+   * The tagged file is detached from the model until its result is taken
+   * with takeResult().
+   *
+   * @param taggedFile tagged file with changed tags, the file name must not
+   * be changed
+   * @param id identifier returned with the result
+   * @param preserve true to preserve file time stamps
+   */
+  void enqueue(TaggedFile* taggedFile, int id, bool preserve);
+
+  /**
+   * Check if there are enqueued jobs whose result has not been taken.
+   * @return true if results are outstanding.
+   */
+  bool hasOutstandingResults() const { return m_numOutstanding > 0; }
+
+  /**
+   * Take the result of a finished job.
+   * The tagged file is attached to the model again. If its row has been
+   * removed while it was written, it is deleted when control returns to
+   * the event loop.
+   *
+   * @param wait true to wait until a job is finished if none is available
+   * @param id the identifier passed to enqueue() is returned here
+   * @param result the result of the job is returned here
+   *
+   * @return tagged file, 0 if no result is available.
+   */
+  TaggedFile* takeResult(bool wait, int* id, WriteResult* result);
+
+  /**
+   * Cancel all jobs which have not been started yet.
+   * Their results are returned by takeResult() as NotWritten.
+   */
+  void cancelPending();
+
+private:
+  class WriteTask;
+
+  /** State of a write job. */
+  enum JobState {
+    Pending, Running, Finished, Cancelled
+  };
+
+  /** Job shared between model thread and worker thread. */
+  struct Job {
+    Job(TaggedFile* tf, FileProxyModel* fpm, const QPersistentModelIndex& idx,
+        int jobId, bool preserveTime)
+      : taggedFile(tf), model(fpm), index(idx), id(jobId),
+        preserve(preserveTime), ok(false), state(Pending) {}
+
+    TaggedFile* taggedFile;
+    FileProxyModel* model;
+    QPersistentModelIndex index;
+    int id;
+    bool preserve;
+    bool ok;
+    JobState state;
+  };
+
+  /**
+   * Write tags of a job, called in a worker thread.
+   * @param job write job
+   */
+  void writeJob(const QSharedPointer<Job>& job);
+
+  QList<QSharedPointer<Job> > m_jobs;
+  QQueue<QSharedPointer<Job> > m_finishedJobs;
+  QThreadPool* m_threadPool;
+  QMutex m_mutex;
+  QWaitCondition m_jobFinished;
+  int m_numOutstanding;
+};
+
+#endif // TAGWRITERPOOL_H
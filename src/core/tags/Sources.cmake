@@ -3,9 +3,13 @@ set(tags_SRCS
   tags/genres.cpp
   tags/formatreplacer.cpp
   tags/frame.cpp
+  tags/framenameregistry.cpp
   tags/framenotice.cpp
   tags/pictureframe.cpp
+  tags/picturestore.cpp
   tags/taggedfile.cpp
+  tags/tagcache.cpp
+  tags/cachedtaggedfile.cpp
   tags/itaggedfilefactory.cpp
   tags/trackdata.cpp
 )
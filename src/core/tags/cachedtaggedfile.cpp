@@ -0,0 +1,477 @@
+/**
+ * \file cachedtaggedfile.cpp
+ * Tagged file with tags from the tag cache.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cachedtaggedfile.h"
+#include <QDir>
+#include <QStringList>
+
+/**
+ * Constructor.
+ *
+ * @param idx index in file proxy model
+ * @param taggedFile detached tagged file with unread tags, ownership is
+ * taken
+ * @param entry cached information about the file
+ */
+CachedTaggedFile::CachedTaggedFile(const QPersistentModelIndex& idx,
+                                   TaggedFile* taggedFile,
+                                   const TagCache::Entry& entry) :
+  TaggedFile(idx), m_taggedFile(taggedFile), m_entry(entry), m_cached(true)
+{
+}
+
+/**
+ * Destructor.
+ */
+CachedTaggedFile::~CachedTaggedFile()
+{
+  delete m_taggedFile;
+}
+
+/**
+ * Get key of tagged file format.
+ * @return key.
+ */
+QString CachedTaggedFile::taggedFileKey() const
+{
+  return m_taggedFile->taggedFileKey();
+}
+
+/**
+ * Get features supported.
+ * @return bit mask with Feature flags set.
+ */
+int CachedTaggedFile::taggedFileFeatures() const
+{
+  return m_taggedFile->taggedFileFeatures();
+}
+
+/**
+ * Get currently active tagged file features.
+ * @return active tagged file features.
+ */
+int CachedTaggedFile::activeTaggedFileFeatures() const
+{
+  return m_taggedFile->activeTaggedFileFeatures();
+}
+
+/**
+ * Activate some features provided by the tagged file.
+ * @param features bit mask with some of the Feature flags
+ */
+void CachedTaggedFile::setActiveTaggedFileFeatures(int features)
+{
+  m_taggedFile->setActiveTaggedFileFeatures(features);
+}
+
+/**
+ * Read tags from file.
+ * Cached tags are only replaced if @a force is true.
+ *
+ * @param force true to force reading even if tags were already read.
+ */
+void CachedTaggedFile::readTags(bool force)
+{
+  bool priorIsTagInformationRead = isTagInformationRead();
+  if (m_cached) {
+    if (!force)
+      return;
+
+    m_cached = false;
+    m_entry = TagCache::Entry();
+  }
+  pushState();
+  m_taggedFile->readTags(force);
+  pullState();
+  notifyModelDataChanged(priorIsTagInformationRead);
+}
+
+/**
+ * Write tags to file and rename it if necessary.
+ *
+ * @param force   true to force writing even if file was not changed.
+ * @param renamed will be set to true if the file was renamed,
+ *                i.e. the file name is no longer valid, else *renamed
+ *                is left unchanged
+ * @param preserve true to preserve file time stamps
+ *
+ * @return true if ok, false if the file could not be written or renamed.
+ */
+bool CachedTaggedFile::writeTags(bool force, bool* renamed, bool preserve)
+{
+  parseFile();
+  pushState();
+  bool ok = m_taggedFile->writeTags(force, renamed, preserve);
+  pullState();
+  return ok;
+}
+
+/**
+ * Free resources allocated when calling readTags().
+ *
+ * @param force true to force clearing even if the tags are modified
+ */
+void CachedTaggedFile::clearTags(bool force)
+{
+  bool priorIsTagInformationRead = isTagInformationRead();
+  if (m_cached) {
+    if (!force && isChanged())
+      return;
+
+    m_cached = false;
+    m_entry = TagCache::Entry();
+  } else {
+    pushState();
+    m_taggedFile->clearTags(force);
+    pullState();
+  }
+  notifyModelDataChanged(priorIsTagInformationRead);
+}
+
+/**
+ * Remove frames.
+ *
+ * @param tagNr tag number
+ * @param flt filter specifying which frames to remove
+ */
+void CachedTaggedFile::deleteFrames(Frame::TagNumber tagNr,
+                                    const FrameFilter& flt)
+{
+  parseFile();
+  pushState();
+  m_taggedFile->deleteFrames(tagNr, flt);
+  pullState();
+}
+
+/**
+ * Check if file has a tag.
+ *
+ * @param tagNr tag number
+ * @return true if a tag is available.
+ */
+bool CachedTaggedFile::hasTag(Frame::TagNumber tagNr) const
+{
+  if (m_cached) {
+    return tagNr < Frame::Tag_NumValues && m_entry.tags[tagNr].hasTag;
+  }
+  return m_taggedFile->hasTag(tagNr);
+}
+
+/**
+ * Check if tags are supported by the format of this file.
+ *
+ * @param tagNr tag number
+ * @return true if tags are supported.
+ */
+bool CachedTaggedFile::isTagSupported(Frame::TagNumber tagNr) const
+{
+  if (m_cached) {
+    return tagNr < Frame::Tag_NumValues && m_entry.tags[tagNr].isSupported;
+  }
+  return m_taggedFile->isTagSupported(tagNr);
+}
+
+/**
+ * Check if tag information has already been read.
+ *
+ * @return true if information is available.
+ */
+bool CachedTaggedFile::isTagInformationRead() const
+{
+  return m_cached || m_taggedFile->isTagInformationRead();
+}
+
+/**
+ * Get technical detail information.
+ *
+ * @param info the detail information is returned here
+ */
+void CachedTaggedFile::getDetailInfo(DetailInfo& info) const
+{
+  if (m_cached && !m_entry.detailInfoRead) {
+    parseFile();
+  }
+  if (m_cached) {
+    info = m_entry.detailInfo;
+  } else {
+    m_taggedFile->getDetailInfo(info);
+  }
+}
+
+/**
+ * Get duration of file.
+ *
+ * @return duration in seconds,
+ *         0 if unknown.
+ */
+unsigned CachedTaggedFile::getDuration() const
+{
+  if (m_cached && !m_entry.detailInfoRead) {
+    parseFile();
+  }
+  return m_cached ? m_entry.duration : m_taggedFile->getDuration();
+}
+
+/**
+ * Check if technical detail information is available without reading
+ * more of the file.
+ *
+ * @return true if detail information has been read.
+ */
+bool CachedTaggedFile::isDetailInfoRead() const
+{
+  return m_cached ? m_entry.detailInfoRead : m_taggedFile->isDetailInfoRead();
+}
+
+/**
+ * Check if the pictures are available without reading more of the file.
+ *
+ * @return false if the cached frames do not contain the binary data.
+ */
+bool CachedTaggedFile::arePicturesRead() const
+{
+  if (m_cached) {
+    FOR_ALL_TAGS(tagNr) {
+      if (!areCachedFramesComplete(tagNr))
+        return false;
+    }
+    return true;
+  }
+  return m_taggedFile->arePicturesRead();
+}
+
+/**
+ * Get file extension including the dot.
+ *
+ * @return file extension, e.g. ".mp3".
+ */
+QString CachedTaggedFile::getFileExtension() const
+{
+  return m_cached ? m_entry.fileExtension : m_taggedFile->getFileExtension();
+}
+
+/**
+ * Get the format of tag.
+ *
+ * @param tagNr tag number
+ * @return string describing format of tag.
+ */
+QString CachedTaggedFile::getTagFormat(Frame::TagNumber tagNr) const
+{
+  if (m_cached) {
+    return tagNr < Frame::Tag_NumValues
+        ? m_entry.tags[tagNr].format : QString();
+  }
+  return m_taggedFile->getTagFormat(tagNr);
+}
+
+/**
+ * Get a specific frame from the tags.
+ *
+ * @param tagNr tag number
+ * @param type  frame type
+ * @param frame the frame is returned here
+ *
+ * @return true if ok.
+ */
+bool CachedTaggedFile::getFrame(Frame::TagNumber tagNr, Frame::Type type,
+                                Frame& frame) const
+{
+  if (m_cached && type > Frame::FT_LastV1Frame &&
+      !areCachedFramesComplete(tagNr)) {
+    parseFile();
+  }
+  if (m_cached) {
+    if (tagNr >= Frame::Tag_NumValues)
+      return false;
+
+    const FrameCollection& frames = type <= Frame::FT_LastV1Frame
+        ? m_entry.tags[tagNr].standardFrames : m_entry.tags[tagNr].frames;
+    FrameCollection::const_iterator it =
+        frames.find(Frame(type, QLatin1String(""), QString(), -1));
+    if (it == frames.end())
+      return false;
+
+    frame = *it;
+    return true;
+  }
+  return m_taggedFile->getFrame(tagNr, type, frame);
+}
+
+/**
+ * Set a frame in the tags.
+ *
+ * @param tagNr tag number
+ * @param frame frame to set.
+ *
+ * @return true if ok.
+ */
+bool CachedTaggedFile::setFrame(Frame::TagNumber tagNr, const Frame& frame)
+{
+  parseFile();
+  pushState();
+  bool ok = m_taggedFile->setFrame(tagNr, frame);
+  pullState();
+  return ok;
+}
+
+/**
+ * Add a frame in the tags.
+ *
+ * @param tagNr tag number
+ * @param frame frame to add, a field list may be added by this method
+ *
+ * @return true if ok.
+ */
+bool CachedTaggedFile::addFrame(Frame::TagNumber tagNr, Frame& frame)
+{
+  parseFile();
+  pushState();
+  bool ok = m_taggedFile->addFrame(tagNr, frame);
+  pullState();
+  return ok;
+}
+
+/**
+ * Delete a frame from the tags.
+ *
+ * @param tagNr tag number
+ * @param frame frame to delete
+ *
+ * @return true if ok.
+ */
+bool CachedTaggedFile::deleteFrame(Frame::TagNumber tagNr, const Frame& frame)
+{
+  parseFile();
+  pushState();
+  bool ok = m_taggedFile->deleteFrame(tagNr, frame);
+  pullState();
+  return ok;
+}
+
+/**
+ * Get a list of frame IDs which can be added.
+ * @param tagNr tag number
+ * @return list with frame IDs.
+ */
+QStringList CachedTaggedFile::getFrameIds(Frame::TagNumber tagNr) const
+{
+  parseFile();
+  return m_taggedFile->getFrameIds(tagNr);
+}
+
+/**
+ * Get all frames in tag.
+ *
+ * @param tagNr tag number
+ * @param frames frame collection to set.
+ */
+void CachedTaggedFile::getAllFrames(Frame::TagNumber tagNr,
+                                    FrameCollection& frames)
+{
+  if (m_cached && !areCachedFramesComplete(tagNr)) {
+    parseFile();
+  }
+  if (m_cached) {
+    if (tagNr < Frame::Tag_NumValues) {
+      frames = m_entry.tags[tagNr].frames;
+      updateMarkedState(tagNr, frames);
+    } else {
+      frames.clear();
+    }
+    return;
+  }
+  pushState();
+  m_taggedFile->getAllFrames(tagNr, frames);
+  pullState();
+}
+
+/**
+ * Close any file handles which are held open by the tagged file object.
+ */
+void CachedTaggedFile::closeFileHandle()
+{
+  if (!m_cached) {
+    m_taggedFile->closeFileHandle();
+  }
+}
+
+/**
+ * Add a suitable field list for the frame if missing.
+ * @param tagNr tag number
+ * @param frame frame where field list is added
+ */
+void CachedTaggedFile::addFieldList(Frame::TagNumber tagNr, Frame& frame) const
+{
+  parseFile();
+  m_taggedFile->addFieldList(tagNr, frame);
+}
+
+/**
+ * Parse the file with the tagged file of the metadata plugin if the
+ * information is still served from the cache.
+ */
+void CachedTaggedFile::parseFile() const
+{
+  if (m_cached) {
+    m_cached = false;
+    m_entry = TagCache::Entry();
+    pushState();
+    m_taggedFile->readTags(false);
+  }
+}
+
+/**
+ * Check if all frames of a tag can be served from the cache.
+ * @param tagNr tag number
+ * @return true if the frames have been read and contain all data.
+ */
+bool CachedTaggedFile::areCachedFramesComplete(Frame::TagNumber tagNr) const
+{
+  if (tagNr >= Frame::Tag_NumValues)
+    return true;
+
+  const TagCache::Entry::Tag& tag = m_entry.tags[tagNr];
+  return !tag.isSupported || (tag.framesRead && !tag.binaryOmitted);
+}
+
+/**
+ * Copy path and modification state to the tagged file of the plugin.
+ */
+void CachedTaggedFile::pushState() const
+{
+  m_taggedFile->setDetachedFilePath(
+        QDir(getDirname()).filePath(currentFilename()));
+  m_taggedFile->copyChangeState(*this);
+}
+
+/**
+ * Copy path and modification state from the tagged file of the plugin.
+ */
+void CachedTaggedFile::pullState()
+{
+  copyChangeState(*m_taggedFile);
+}
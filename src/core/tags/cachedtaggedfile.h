@@ -0,0 +1,295 @@
+/**
+ * \file cachedtaggedfile.h
+ * Tagged file with tags from the tag cache.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CACHEDTAGGEDFILE_H
+#define CACHEDTAGGEDFILE_H
+
+#include "taggedfile.h"
+#include "tagcache.h"
+
+/**
+ * Tagged file with tags from the tag cache.
+ *
+ * The information returned by an unchanged file is served from a
+ * TagCache::Entry. The tagged file of the metadata plugin is only parsed
+ * when its tags are modified or information is needed which is not cached.
+ * From then on, all calls are delegated to the plugin's tagged file, which
+ * is detached from the model and kept in sync with this tagged file.
+ */
+class KID3_CORE_EXPORT CachedTaggedFile : public TaggedFile {
+public:
+  /**
+   * Constructor.
+   *
+   * @param idx index in file proxy model
+   * @param taggedFile detached tagged file with unread tags, ownership is
+   * taken
+   * @param entry cached information about the file
+   */
+  CachedTaggedFile(const QPersistentModelIndex& idx, TaggedFile* taggedFile,
+                   const TagCache::Entry& entry);
+
+  /**
+   * Destructor.
+   */
+  virtual ~CachedTaggedFile();
+
+  /**
+   * Check if the information is still served from the cache.
+   * @return true if the file has not been parsed.
+   */
+  bool isCached() const { return m_cached; }
+
+  /**
+   * Get key of tagged file format.
+   * @return key.
+   */
+  virtual QString taggedFileKey() const;
+
+  /**
+   * Get features supported.
+   * @return bit mask with Feature flags set.
+   */
+  virtual int taggedFileFeatures() const;
+
+  /**
+   * Get currently active tagged file features.
+   * @return active tagged file features.
+   */
+  virtual int activeTaggedFileFeatures() const;
+
+  /**
+   * Activate some features provided by the tagged file.
+   * @param features bit mask with some of the Feature flags
+   */
+  virtual void setActiveTaggedFileFeatures(int features);
+
+  /**
+   * Read tags from file.
+   * Cached tags are only replaced if @a force is true.
+   *
+   * @param force true to force reading even if tags were already read.
+   */
+  virtual void readTags(bool force);
+
+  /**
+   * Write tags to file and rename it if necessary.
+   *
+   * @param force   true to force writing even if file was not changed.
+   * @param renamed will be set to true if the file was renamed,
+   *                i.e. the file name is no longer valid, else *renamed
+   *                is left unchanged
+   * @param preserve true to preserve file time stamps
+   *
+   * @return true if ok, false if the file could not be written or renamed.
+   */
+  virtual bool writeTags(bool force, bool* renamed, bool preserve);
+
+  /**
+   * Free resources allocated when calling readTags().
+   *
+   * @param force true to force clearing even if the tags are modified
+   */
+  virtual void clearTags(bool force);
+
+  /**
+   * Remove frames.
+   *
+   * @param tagNr tag number
+   * @param flt filter specifying which frames to remove
+   */
+  virtual void deleteFrames(Frame::TagNumber tagNr, const FrameFilter& flt);
+
+  /**
+   * Check if file has a tag.
+   *
+   * @param tagNr tag number
+   * @return true if a tag is available.
+   */
+  virtual bool hasTag(Frame::TagNumber tagNr) const;
+
+  /**
+   * Check if tags are supported by the format of this file.
+   *
+   * @param tagNr tag number
+   * @return true if tags are supported.
+   */
+  virtual bool isTagSupported(Frame::TagNumber tagNr) const;
+
+  /**
+   * Check if tag information has already been read.
+   *
+   * @return true if information is available.
+   */
+  virtual bool isTagInformationRead() const;
+
+  /**
+   * Get technical detail information.
+   *
+   * @param info the detail information is returned here
+   */
+  virtual void getDetailInfo(DetailInfo& info) const;
+
+  /**
+   * Get duration of file.
+   *
+   * @return duration in seconds,
+   *         0 if unknown.
+   */
+  virtual unsigned getDuration() const;
+
+  /**
+   * Check if technical detail information is available without reading
+   * more of the file.
+   *
+   * @return true if detail information has been read.
+   */
+  virtual bool isDetailInfoRead() const;
+
+  /**
+   * Check if the pictures are available without reading more of the file.
+   *
+   * @return false if the cached frames do not contain the binary data.
+   */
+  virtual bool arePicturesRead() const;
+
+  /**
+   * Get file extension including the dot.
+   *
+   * @return file extension, e.g. ".mp3".
+   */
+  virtual QString getFileExtension() const;
+
+  /**
+   * Get the format of tag.
+   *
+   * @param tagNr tag number
+   * @return string describing format of tag.
+   */
+  virtual QString getTagFormat(Frame::TagNumber tagNr) const;
+
+  /**
+   * Get a specific frame from the tags.
+   *
+   * @param tagNr tag number
+   * @param type  frame type
+   * @param frame the frame is returned here
+   *
+   * @return true if ok.
+   */
+  virtual bool getFrame(Frame::TagNumber tagNr, Frame::Type type,
+                        Frame& frame) const;
+
+  /**
+   * Set a frame in the tags.
+   *
+   * @param tagNr tag number
+   * @param frame frame to set.
+   *
+   * @return true if ok.
+   */
+  virtual bool setFrame(Frame::TagNumber tagNr, const Frame& frame);
+
+  /**
+   * Add a frame in the tags.
+   *
+   * @param tagNr tag number
+   * @param frame frame to add, a field list may be added by this method
+   *
+   * @return true if ok.
+   */
+  virtual bool addFrame(Frame::TagNumber tagNr, Frame& frame);
+
+  /**
+   * Delete a frame from the tags.
+   *
+   * @param tagNr tag number
+   * @param frame frame to delete
+   *
+   * @return true if ok.
+   */
+  virtual bool deleteFrame(Frame::TagNumber tagNr, const Frame& frame);
+
+  /**
+   * Get a list of frame IDs which can be added.
+   * @param tagNr tag number
+   * @return list with frame IDs.
+   */
+  virtual QStringList getFrameIds(Frame::TagNumber tagNr) const;
+
+  /**
+   * Get all frames in tag.
+   *
+   * @param tagNr tag number
+   * @param frames frame collection to set.
+   */
+  virtual void getAllFrames(Frame::TagNumber tagNr, FrameCollection& frames);
+
+  /**
+   * Close any file handles which are held open by the tagged file object.
+   */
+  virtual void closeFileHandle();
+
+  /**
+   * Add a suitable field list for the frame if missing.
+   * @param tagNr tag number
+   * @param frame frame where field list is added
+   */
+  virtual void addFieldList(Frame::TagNumber tagNr, Frame& frame) const;
+
+private:
+  CachedTaggedFile(const CachedTaggedFile&);
+  CachedTaggedFile& operator=(const CachedTaggedFile&);
+
+  /**
+   * Parse the file with the tagged file of the metadata plugin if the
+   * information is still served from the cache.
+   */
+  void parseFile() const;
+
+  /**
+   * Check if all frames of a tag can be served from the cache.
+   * @param tagNr tag number
+   * @return true if the frames have been read and contain all data.
+   */
+  bool areCachedFramesComplete(Frame::TagNumber tagNr) const;
+
+  /**
+   * Copy path and modification state to the tagged file of the plugin.
+   */
+  void pushState() const;
+
+  /**
+   * Copy path and modification state from the tagged file of the plugin.
+   */
+  void pullState();
+
+  TaggedFile* m_taggedFile;
+  mutable TagCache::Entry m_entry;
+  mutable bool m_cached;
+};
+
+#endif // CACHEDTAGGEDFILE_H
@@ -27,6 +27,13 @@
 #include "formatreplacer.h"
 #include <QUrl>
 
+namespace {
+
+/** Number of characters reserved for the replacement of a format code. */
+const int ReservedCodeLength = 16;
+
+}
+
 /**
  * Constructor.
  *
@@ -82,87 +89,210 @@ void FormatReplacer::replaceEscapedChars()
  *              ('/', '\\', ':') in tags,
  *              FSF_SupportHtmlEscape to support modifier h
  *              (with code c "%hc") to replace HTML metacharacters
- *              ('<', '>', '&', '"', ''', non-ascii) in tags.
+ *              ('<', '>', '&', '"', ''', non-ascii) in tags,
+ *              FSF_SupportTagNumber to support a tag number before
+ *              the modifiers and the code ("%1c", "%2hc"), which is
+ *              passed to getTagReplacement().
  */
 void FormatReplacer::replacePercentCodes(unsigned flags)
 {
-  if (!m_str.isEmpty()) {
-    for (int pos = 0; pos < static_cast<int>(m_str.length());) {
-      pos = m_str.indexOf(QLatin1Char('%'), pos);
-      if (pos == -1) break;
+  if (!m_str.isEmpty() && m_str.indexOf(QLatin1Char('%')) != -1) {
+    m_str = format(Template(m_str, flags));
+  }
+}
 
-      int codePos = pos + 1;
-      int codeLen = 0;
-      QString prefix, postfix;
-      bool urlEncode = false;
-      bool htmlEscape = false;
-      QString repl;
-      if ((flags & FSF_SupportUrlEncode) && m_str[codePos] == QLatin1Char('u')) {
-        ++codePos;
-        urlEncode = true;
-      }
-      if ((flags & FSF_SupportHtmlEscape) && m_str[codePos] == QLatin1Char('h')) {
-        ++codePos;
-        htmlEscape = true;
-      }
-      if (m_str[codePos] == QLatin1Char('{')) {
-        int closingBracePos = m_str.indexOf(QLatin1Char('}'), codePos + 1);
-        if (closingBracePos > codePos + 1) {
-          QString longCode =
-            m_str.mid(codePos + 1, closingBracePos - codePos - 1).toLower();
-          if (longCode.startsWith(QLatin1Char('"'))) {
-            int prefixEnd = longCode.indexOf(QLatin1Char('"'), 1);
-            if (prefixEnd != -1 && prefixEnd < longCode.length() - 2) {
-              prefix = longCode.mid(1, prefixEnd - 1);
-              longCode.remove(0, prefixEnd + 1);
-            }
-          }
-          if (longCode.endsWith(QLatin1Char('"'))) {
-            int postfixStart = longCode.lastIndexOf(QLatin1Char('"'), -2);
-            if (postfixStart != -1 && postfixStart > 1) {
-              postfix = longCode.mid(postfixStart + 1, longCode.length() - postfixStart - 2);
-              longCode.truncate(postfixStart);
-            }
-          }
-          repl = getReplacement(longCode);
-          codeLen = closingBracePos - pos + 1;
-        }
-      } else {
-        repl = getReplacement(QString(m_str[codePos]));
-        codeLen = codePos - pos + 1;
+/**
+ * Format a compiled template.
+ * The result is the same as when the string of the template is set with
+ * setString() and replacePercentCodes() is called with the flags of
+ * the template, but the format string is not parsed again and the
+ * result is built in a single pass.
+ *
+ * @param tmpl compiled format string
+ *
+ * @return string with format codes replaced.
+ */
+QString FormatReplacer::format(const Template& tmpl) const
+{
+  QString result;
+  if (tmpl.m_parts.isEmpty())
+    return result;
+
+  result.reserve(tmpl.m_str.length() + tmpl.m_numCodes * ReservedCodeLength);
+  int idx = 0;
+  while (idx != -1) {
+    const Template::Part& part = tmpl.m_parts.at(idx);
+    if (part.literal) {
+      result.append(tmpl.m_str.midRef(part.pos, part.len));
+      idx = part.next;
+      continue;
+    }
+
+    QString repl = part.tagNumber != 0
+        ? getTagReplacement(part.tagNumber, part.code)
+        : getReplacement(part.code);
+    if (repl.isNull() && part.fallback != -1) {
+      // Keep the '%' of a single character code which is not found.
+      idx = part.fallback;
+      continue;
+    }
+    if (tmpl.m_flags & FSF_ReplaceSeparators) {
+      repl.replace(QLatin1Char('/'), QLatin1Char('-'));
+      repl.replace(QLatin1Char('\\'), QLatin1Char('-'));
+      repl.replace(QLatin1Char(':'), QLatin1Char('-'));
+    }
+    if (part.urlEncode) {
+      repl = QString::fromLatin1(QUrl::toPercentEncoding(repl));
+    }
+    if (part.htmlEscape) {
+      repl = escapeHtml(repl);
+    }
+    if (!repl.isEmpty()) {
+      result += part.prefix;
+      result += repl;
+      result += part.postfix;
+    }
+    idx = part.next;
+  }
+  return result;
+}
+
+/**
+ * Replace a format code preceded by a tag number ("%1c", "%2{chars}"),
+ * only used with FSF_SupportTagNumber.
+ * This default implementation ignores the tag number.
+ *
+ * @param tagNumber tag number 1 or 2
+ * @param code format code
+ *
+ * @return replacement string,
+ *         QString::null if code not found.
+ */
+QString FormatReplacer::getTagReplacement(int, const QString& code) const
+{
+  return getReplacement(code);
+}
+
+/**
+ * Constructor.
+ *
+ * @param str   string with format codes
+ * @param flags flags as used with replacePercentCodes()
+ */
+FormatReplacer::Template::Template(const QString& str, unsigned flags)
+  : m_str(str), m_flags(flags), m_numCodes(0)
+{
+  QVector<int> parsed(2 * m_str.length(), -1);
+  partIndex(0, false, parsed);
+  // Parts are appended while parsing, so they are accessed by index.
+  for (int i = 0; i < m_parts.size(); ++i) {
+    Part part = m_parts.at(i);
+    int end = parsePart(part);
+    part.next = partIndex(end, false, parsed);
+    if (!part.literal) {
+      ++m_numCodes;
+      // Only codes with a single character and without modifiers are kept
+      // if they are not found.
+      if (end - part.pos <= (part.tagNumber != 0 ? 3 : 2)) {
+        part.fallback = partIndex(part.pos, true, parsed);
       }
+    }
+    m_parts[i] = part;
+  }
+}
 
-      if (codeLen > 0) {
-        if (flags & FSF_ReplaceSeparators) {
-          repl.replace(QLatin1Char('/'), QLatin1Char('-'));
-          repl.replace(QLatin1Char('\\'), QLatin1Char('-'));
-          repl.replace(QLatin1Char(':'), QLatin1Char('-'));
-        }
-        if (urlEncode) {
-          repl = QString::fromLatin1(QUrl::toPercentEncoding(repl));
-        }
-        if (htmlEscape) {
-          repl = escapeHtml(repl);
-        }
-        if (!repl.isEmpty()) {
-          if (!prefix.isEmpty()) {
-            repl = prefix + repl;
-          }
-          if (!postfix.isEmpty()) {
-            repl += postfix;
+/**
+ * Get index of part starting at a position, add it if not yet existing.
+ *
+ * @param pos position in format string
+ * @param literal true to get literal text also if a code starts at pos
+ * @param parsed indexes of already added parts, two per position
+ *
+ * @return index of part in m_parts, -1 at end of string.
+ */
+int FormatReplacer::Template::partIndex(int pos, bool literal,
+                                        QVector<int>& parsed)
+{
+  if (pos >= m_str.length())
+    return -1;
+
+  int& idx = parsed[2 * pos + (literal ? 1 : 0)];
+  if (idx == -1) {
+    idx = m_parts.size();
+    m_parts.append(Part(pos, literal));
+  }
+  return idx;
+}
+
+/**
+ * Parse literal text or a format code.
+ * @param part part with position and literal flag set
+ * @return position after part.
+ */
+int FormatReplacer::Template::parsePart(Part& part) const
+{
+  const int len = m_str.length();
+  const int pos = part.pos;
+  if (!part.literal && m_str.at(pos) == QLatin1Char('%')) {
+    // A missing code character at the end of the string is handled as a
+    // null character, as replacePercentCodes() has always done.
+    int codePos = pos + 1;
+    if ((m_flags & FSF_SupportTagNumber) && codePos < len &&
+        (m_str.at(codePos) == QLatin1Char('1') ||
+         m_str.at(codePos) == QLatin1Char('2'))) {
+      part.tagNumber = m_str.at(codePos).unicode() - '0';
+      ++codePos;
+    }
+    if ((m_flags & FSF_SupportUrlEncode) && codePos < len &&
+        m_str.at(codePos) == QLatin1Char('u')) {
+      ++codePos;
+      part.urlEncode = true;
+    }
+    if ((m_flags & FSF_SupportHtmlEscape) && codePos < len &&
+        m_str.at(codePos) == QLatin1Char('h')) {
+      ++codePos;
+      part.htmlEscape = true;
+    }
+    if (codePos < len && m_str.at(codePos) == QLatin1Char('{')) {
+      int closingBracePos = m_str.indexOf(QLatin1Char('}'), codePos + 1);
+      if (closingBracePos > codePos + 1) {
+        QString longCode =
+          m_str.mid(codePos + 1, closingBracePos - codePos - 1).toLower();
+        if (longCode.startsWith(QLatin1Char('"'))) {
+          int prefixEnd = longCode.indexOf(QLatin1Char('"'), 1);
+          if (prefixEnd != -1 && prefixEnd < longCode.length() - 2) {
+            part.prefix = longCode.mid(1, prefixEnd - 1);
+            longCode.remove(0, prefixEnd + 1);
           }
         }
-        if (!repl.isNull() || codeLen > 2) {
-          m_str.replace(pos, codeLen, repl);
-          pos += repl.length();
-        } else {
-          ++pos;
+        if (longCode.endsWith(QLatin1Char('"'))) {
+          int postfixStart = longCode.lastIndexOf(QLatin1Char('"'), -2);
+          if (postfixStart != -1 && postfixStart > 1) {
+            part.postfix = longCode.mid(postfixStart + 1,
+                                        longCode.length() - postfixStart - 2);
+            longCode.truncate(postfixStart);
+          }
         }
-      } else {
-        ++pos;
+        part.code = longCode;
+        return closingBracePos + 1;
       }
+      // Without a closing brace, the '%' is literal text.
+      part.urlEncode = part.htmlEscape = false;
+      part.tagNumber = 0;
+    } else {
+      part.code = QString(codePos < len ? m_str.at(codePos) : QChar());
+      return codePos + 1;
     }
   }
+
+  part.literal = true;
+  int end = m_str.indexOf(QLatin1Char('%'),
+                          m_str.at(pos) == QLatin1Char('%') ? pos + 1 : pos);
+  if (end == -1) {
+    end = len;
+  }
+  part.len = end - pos;
+  return end;
 }
 
 /**
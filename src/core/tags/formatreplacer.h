@@ -28,6 +28,7 @@
 #define FORMATREPLACER_H
 
 #include <QString>
+#include <QVector>
 #include "kid3api.h"
 
 /**
@@ -39,7 +40,88 @@ public:
   enum FormatStringFlags {
     FSF_SupportUrlEncode  = (1 << 0),
     FSF_ReplaceSeparators = (1 << 1),
-    FSF_SupportHtmlEscape = (1 << 2)
+    FSF_SupportHtmlEscape = (1 << 2),
+    FSF_SupportTagNumber  = (1 << 3)
+  };
+
+  /**
+   * Format string compiled into literal text and format codes.
+   * The format codes with their modifiers, prefixes and postfixes are
+   * parsed once, a template can then be used with format() to format
+   * the data of many files.
+   */
+  class KID3_CORE_EXPORT Template {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param str   string with format codes
+     * @param flags flags as used with replacePercentCodes()
+     */
+    explicit Template(const QString& str = QString(), unsigned flags = 0);
+
+    /**
+     * Get string with format codes.
+     * @return format string.
+     */
+    QString getString() const { return m_str; }
+
+    /**
+     * Get flags.
+     * @return flags used to compile the template.
+     */
+    unsigned getFlags() const { return m_flags; }
+
+  private:
+    friend class FormatReplacer;
+
+    /**
+     * Literal text or format code.
+     * If a single character code is not found, the '%' is kept and the
+     * parts starting with the code character are used, like it is done
+     * by replacePercentCodes().
+     */
+    struct Part {
+      /** Constructor. */
+      Part(int p = 0, bool l = false)
+        : pos(p), len(0), next(-1), fallback(-1), tagNumber(0), literal(l),
+          urlEncode(false), htmlEscape(false) {}
+
+      int pos;         /**< position of part in format string */
+      int len;         /**< length of literal text */
+      int next;        /**< index of next part, -1 at end */
+      int fallback;    /**< index of part used if code is not found, or -1 */
+      int tagNumber;   /**< tag number 1 or 2 before code, 0 if none */
+      bool literal;    /**< true if part is literal text */
+      bool urlEncode;  /**< true if replacement is URL encoded */
+      bool htmlEscape; /**< true if replacement is HTML escaped */
+      QString code;    /**< format code */
+      QString prefix;  /**< prefix added to non-empty replacement */
+      QString postfix; /**< postfix added to non-empty replacement */
+    };
+
+    /**
+     * Get index of part starting at a position, add it if not yet existing.
+     *
+     * @param pos position in format string
+     * @param literal true to get literal text also if a code starts at pos
+     * @param parsed indexes of already added parts, two per position
+     *
+     * @return index of part in m_parts, -1 at end of string.
+     */
+    int partIndex(int pos, bool literal, QVector<int>& parsed);
+
+    /**
+     * Parse literal text or a format code.
+     * @param part part with position and literal flag set
+     * @return position after part.
+     */
+    int parsePart(Part& part) const;
+
+    QString m_str;
+    unsigned m_flags;
+    int m_numCodes;
+    QVector<Part> m_parts;
   };
 
   /**
@@ -84,10 +166,26 @@ public:
    *              ('/', '\\', ':') in tags,
    *              FSF_SupportHtmlEscape to support modifier h
    *              (with code c "%hc") to replace HTML metacharacters
-   *              ('<', '>', '&', '"', ''', non-ascii) in tags.
+   *              ('<', '>', '&', '"', ''', non-ascii) in tags,
+   *              FSF_SupportTagNumber to support a tag number before
+   *              the modifiers and the code ("%1c", "%2hc"), which is
+   *              passed to getTagReplacement().
    */
   void replacePercentCodes(unsigned flags = 0);
 
+  /**
+   * Format a compiled template.
+   * The result is the same as when the string of the template is set with
+   * setString() and replacePercentCodes() is called with the flags of
+   * the template, but the format string is not parsed again and the
+   * result is built in a single pass.
+   *
+   * @param tmpl compiled format string
+   *
+   * @return string with format codes replaced.
+   */
+  QString format(const Template& tmpl) const;
+
   /**
    * Converts the plain text string @a plain to a HTML string with
    * HTML metacharacters replaced by HTML entities.
@@ -107,6 +205,19 @@ protected:
    */
   virtual QString getReplacement(const QString& code) const = 0;
 
+  /**
+   * Replace a format code preceded by a tag number ("%1c", "%2{chars}"),
+   * only used with FSF_SupportTagNumber.
+   * This default implementation ignores the tag number.
+   *
+   * @param tagNumber tag number 1 or 2
+   * @param code format code
+   *
+   * @return replacement string,
+   *         QString::null if code not found.
+   */
+  virtual QString getTagReplacement(int tagNumber, const QString& code) const;
+
 private:
   QString m_str;
 };
@@ -30,6 +30,8 @@
 #include <QRegExp>
 #include <QCoreApplication>
 #include "pictureframe.h"
+#include "framenameregistry.h"
+#include <algorithm>
 
 namespace {
 
@@ -91,253 +93,46 @@ static const char* const contentTypeNames[] = {
   0
 };
 
+}
 
 /**
- * Get name of frame from type.
- *
+ * Constructor.
  * @param type type
- *
- * @return name.
+ * @param name internal name
  */
-const char* getNameFromType(Frame::Type type)
-{
-  static const char* const names[] = {
-    QT_TRANSLATE_NOOP("@default", "Title"),           // FT_Title,
-    QT_TRANSLATE_NOOP("@default", "Artist"),          // FT_Artist,
-    QT_TRANSLATE_NOOP("@default", "Album"),           // FT_Album,
-    QT_TRANSLATE_NOOP("@default", "Comment"),         // FT_Comment,
-    QT_TRANSLATE_NOOP("@default", "Date"),            // FT_Date,
-    QT_TRANSLATE_NOOP("@default", "Track Number"),    // FT_Track,
-    QT_TRANSLATE_NOOP("@default", "Genre"),           // FT_Genre,
-                                  // FT_LastV1Frame = FT_Track,
-    QT_TRANSLATE_NOOP("@default", "Album Artist"),    // FT_AlbumArtist
-    QT_TRANSLATE_NOOP("@default", "Arranger"),        // FT_Arranger,
-    QT_TRANSLATE_NOOP("@default", "Author"),          // FT_Author,
-    QT_TRANSLATE_NOOP("@default", "BPM"),             // FT_Bpm,
-    QT_TRANSLATE_NOOP("@default", "Catalog Number"),  // FT_CatalogNumber,
-    QT_TRANSLATE_NOOP("@default", "Compilation"),     // FT_Compilation,
-    QT_TRANSLATE_NOOP("@default", "Composer"),        // FT_Composer,
-    QT_TRANSLATE_NOOP("@default", "Conductor"),       // FT_Conductor,
-    QT_TRANSLATE_NOOP("@default", "Copyright"),       // FT_Copyright,
-    QT_TRANSLATE_NOOP("@default", "Disc Number"),     // FT_Disc,
-    QT_TRANSLATE_NOOP("@default", "Encoded-by"),      // FT_EncodedBy,
-    QT_TRANSLATE_NOOP("@default", "Encoder Settings"), // FT_EncoderSettings,
-    QT_TRANSLATE_NOOP("@default", "Encoding Time"),   // FT_EncodingTime,
-    QT_TRANSLATE_NOOP("@default", "Grouping"),        // FT_Grouping,
-    QT_TRANSLATE_NOOP("@default", "Initial Key"),     // FT_InitialKey,
-    QT_TRANSLATE_NOOP("@default", "ISRC"),            // FT_Isrc,
-    QT_TRANSLATE_NOOP("@default", "Language"),        // FT_Language,
-    QT_TRANSLATE_NOOP("@default", "Lyricist"),        // FT_Lyricist,
-    QT_TRANSLATE_NOOP("@default", "Lyrics"),          // FT_Lyrics,
-    QT_TRANSLATE_NOOP("@default", "Media"),           // FT_Media,
-    QT_TRANSLATE_NOOP("@default", "Mood"),            // FT_Mood,
-    QT_TRANSLATE_NOOP("@default", "Original Album"),  // FT_OriginalAlbum,
-    QT_TRANSLATE_NOOP("@default", "Original Artist"), // FT_OriginalArtist,
-    QT_TRANSLATE_NOOP("@default", "Original Date"),   // FT_OriginalDate,
-    QT_TRANSLATE_NOOP("@default", "Disc Subtitle"),   // FT_Part,
-    QT_TRANSLATE_NOOP("@default", "Performer"),       // FT_Performer,
-    QT_TRANSLATE_NOOP("@default", "Picture"),         // FT_Picture,
-    QT_TRANSLATE_NOOP("@default", "Publisher"),       // FT_Publisher,
-    QT_TRANSLATE_NOOP("@default", "Release Country"), // FT_ReleaseCountry,
-    QT_TRANSLATE_NOOP("@default", "Remixer"),         // FT_Remixer,
-    QT_TRANSLATE_NOOP("@default", "Sort Album"),      // FT_SortAlbum,
-    QT_TRANSLATE_NOOP("@default", "Sort Album Artist"), // FT_SortAlbumArtist,
-    QT_TRANSLATE_NOOP("@default", "Sort Artist"),     // FT_SortArtist,
-    QT_TRANSLATE_NOOP("@default", "Sort Composer"),   // FT_SortComposer,
-    QT_TRANSLATE_NOOP("@default", "Sort Name"),       // FT_SortName,
-    QT_TRANSLATE_NOOP("@default", "Subtitle"),        // FT_Subtitle,
-    QT_TRANSLATE_NOOP("@default", "Website"),         // FT_Website,
-    QT_TRANSLATE_NOOP("@default", "WWW Audio File"),  // FT_WWWAudioFile,
-    QT_TRANSLATE_NOOP("@default", "WWW Audio Source"), // FT_WWWAudioSource,
-    QT_TRANSLATE_NOOP("@default", "Release Date"),    // FT_ReleaseDate,
-    QT_TRANSLATE_NOOP("@default", "Rating")           // FT_Rating,
-                                  // FT_LastFrame = FT_Rating
-  };
-  struct not_used { int array_size_check[
-      sizeof(names) / sizeof(names[0]) == Frame::FT_LastFrame + 1
-      ? 1 : -1 ]; };
-  return type <= Frame::FT_LastFrame ? names[type] : "Unknown";
-}
-
-/**
- * Get map of non unified frame names to display names.
- * @return mapping of frame names to display names.
- */
-QMap<QByteArray, QByteArray> getDisplayNamesOfIds()
-{
-  static const struct StrOfId {
-    const char* id;
-    const char* str;
-  } strOfId[] = {
-    { "AENC", QT_TRANSLATE_NOOP("@default", "Audio Encryption") },
-    { "ASPI", QT_TRANSLATE_NOOP("@default", "Audio Seek Point") },
-    { "CHAP", QT_TRANSLATE_NOOP("@default", "Chapter") },
-    { "COMR", QT_TRANSLATE_NOOP("@default", "Commercial") },
-    { "CTOC", QT_TRANSLATE_NOOP("@default", "Table of Contents") },
-    { "ENCR", QT_TRANSLATE_NOOP("@default", "Encryption Method") },
-    { "EQU2", QT_TRANSLATE_NOOP("@default", "Equalization") },
-    { "EQUA", QT_TRANSLATE_NOOP("@default", "Equalization") },
-    { "ETCO", QT_TRANSLATE_NOOP("@default", "Event Timing Codes") },
-    { "GEOB", QT_TRANSLATE_NOOP("@default", "General Object") },
-    { "GRID", QT_TRANSLATE_NOOP("@default", "Group Identification") },
-    { "LINK", QT_TRANSLATE_NOOP("@default", "Linked Information") },
-    { "MCDI", QT_TRANSLATE_NOOP("@default", "Music CD Identifier") },
-    { "MLLT", QT_TRANSLATE_NOOP("@default", "MPEG Lookup Table") },
-    { "MVIN", QT_TRANSLATE_NOOP("@default", "Movement Number") },
-    { "MVNM", QT_TRANSLATE_NOOP("@default", "Movement Name") },
-    { "OWNE", QT_TRANSLATE_NOOP("@default", "Ownership") },
-    { "PCNT", QT_TRANSLATE_NOOP("@default", "Play Counter") },
-    { "PCST", QT_TRANSLATE_NOOP("@default", "Podcast") },
-    { "POPM", QT_TRANSLATE_NOOP("@default", "Popularimeter") },
-    { "POSS", QT_TRANSLATE_NOOP("@default", "Position Synchronisation") },
-    { "PRIV", QT_TRANSLATE_NOOP("@default", "Private") },
-    { "RBUF", QT_TRANSLATE_NOOP("@default", "Recommended Buffer Size") },
-    { "RVA2", QT_TRANSLATE_NOOP("@default", "Volume Adjustment") },
-    { "RVAD", QT_TRANSLATE_NOOP("@default", "Volume Adjustment") },
-    { "RVRB", QT_TRANSLATE_NOOP("@default", "Reverb") },
-    { "SEEK", QT_TRANSLATE_NOOP("@default", "Seek") },
-    { "SIGN", QT_TRANSLATE_NOOP("@default", "Signature") },
-    { "SYLT", QT_TRANSLATE_NOOP("@default", "Synchronized Lyrics") },
-    { "SYTC", QT_TRANSLATE_NOOP("@default", "Synchronized Tempo Codes") },
-    { "TDAT", QT_TRANSLATE_NOOP("@default", "Date") },
-    { "TDEN", QT_TRANSLATE_NOOP("@default", "Encoding Time") },
-    { "TDES", QT_TRANSLATE_NOOP("@default", "Podcast Description") },
-    { "TDLY", QT_TRANSLATE_NOOP("@default", "Playlist Delay") },
-    { "TDOR", QT_TRANSLATE_NOOP("@default", "Original Release Time") },
-    { "TDRC", QT_TRANSLATE_NOOP("@default", "Recording Time") },
-    { "TDRL", QT_TRANSLATE_NOOP("@default", "Release Time") },
-    { "TDTG", QT_TRANSLATE_NOOP("@default", "Tagging Time") },
-    { "TFLT", QT_TRANSLATE_NOOP("@default", "File Type") },
-    { "TGID", QT_TRANSLATE_NOOP("@default", "Podcast Identifier") },
-    { "TIME", QT_TRANSLATE_NOOP("@default", "Time") },
-    { "TLEN", QT_TRANSLATE_NOOP("@default", "Length") },
-    { "TOFN", QT_TRANSLATE_NOOP("@default", "Original Filename") },
-    { "TOWN", QT_TRANSLATE_NOOP("@default", "File Owner") },
-    { "TPRO", QT_TRANSLATE_NOOP("@default", "Produced Notice") },
-    { "TRDA", QT_TRANSLATE_NOOP("@default", "Recording Date") },
-    { "TRSN", QT_TRANSLATE_NOOP("@default", "Radio Station Name") },
-    { "TRSO", QT_TRANSLATE_NOOP("@default", "Radio Station Owner") },
-    { "TSIZ", QT_TRANSLATE_NOOP("@default", "Size") },
-    { "TXXX", QT_TRANSLATE_NOOP("@default", "User-defined Text") },
-    { "UFID", QT_TRANSLATE_NOOP("@default", "Unique File Identifier") },
-    { "USER", QT_TRANSLATE_NOOP("@default", "Terms of Use") },
-    { "WCOM", QT_TRANSLATE_NOOP("@default", "Commercial URL") },
-    { "WCOP", QT_TRANSLATE_NOOP("@default", "Copyright URL") },
-    { "WFED", QT_TRANSLATE_NOOP("@default", "Podcast Feed") },
-    { "WORS", QT_TRANSLATE_NOOP("@default", "Official Radio Station") },
-    { "WPAY", QT_TRANSLATE_NOOP("@default", "Payment") },
-    { "WPUB", QT_TRANSLATE_NOOP("@default", "Official Publisher") },
-    { "WXXX", QT_TRANSLATE_NOOP("@default", "User-defined URL") },
-    { "BAND", QT_TRANSLATE_NOOP("@default", "Album Artist") },
-    { "CONTACT", QT_TRANSLATE_NOOP("@default", "Contact") },
-    { "CONTENTGROUP", QT_TRANSLATE_NOOP("@default", "Grouping") },
-    { "DESCRIPTION", QT_TRANSLATE_NOOP("@default", "Description") },
-    { "DISCTOTAL", QT_TRANSLATE_NOOP("@default", "Total Discs") },
-    { "ENCODER", QT_TRANSLATE_NOOP("@default", "Encoder") },
-    { "ENCODER_OPTIONS", QT_TRANSLATE_NOOP("@default", "Encoder Settings") },
-    { "ENCODEDBY", QT_TRANSLATE_NOOP("@default", "Encoded-by") },
-    { "ENCODING", QT_TRANSLATE_NOOP("@default", "Encoding") },
-    { "ENGINEER", QT_TRANSLATE_NOOP("@default", "Engineer") },
-    { "ENSEMBLE", QT_TRANSLATE_NOOP("@default", "Ensemble") },
-    { "GUESTARTIST", QT_TRANSLATE_NOOP("@default", "Guest Artist") },
-    { "IsVBR", QT_TRANSLATE_NOOP("@default", "VBR") },
-    { "iTunPGAP", QT_TRANSLATE_NOOP("@default", "Gapless Playback") },
-    { "LABEL", QT_TRANSLATE_NOOP("@default", "Label") },
-    { "LABELNO", QT_TRANSLATE_NOOP("@default", "Label Number") },
-    { "LICENSE", QT_TRANSLATE_NOOP("@default", "License") },
-    { "LOCATION", QT_TRANSLATE_NOOP("@default", "Location") },
-    { "OPUS", QT_TRANSLATE_NOOP("@default", "Opus") },
-    { "ORIGARTIST", QT_TRANSLATE_NOOP("@default", "Original Artist") },
-    { "ORGANIZATION", QT_TRANSLATE_NOOP("@default", "Organization") },
-    { "PARTNUMBER", QT_TRANSLATE_NOOP("@default", "Part Number") },
-    { "PRODUCER", QT_TRANSLATE_NOOP("@default", "Producer") },
-    { "PRODUCTNUMBER", QT_TRANSLATE_NOOP("@default", "Product Number") },
-    { "RECORDINGDATE", QT_TRANSLATE_NOOP("@default", "Recording Date") },
-    { "REMIXEDBY", QT_TRANSLATE_NOOP("@default", "Remixer") },
-    { "TOTALDISCS", QT_TRANSLATE_NOOP("@default", "Total Discs") },
-    { "TOTALTRACKS", QT_TRANSLATE_NOOP("@default", "Total Tracks") },
-    { "TRACKTOTAL", QT_TRANSLATE_NOOP("@default", "Total Tracks") },
-    { "UNKNOWN", QT_TRANSLATE_NOOP("@default", "Unknown") },
-    { "Unknown", QT_TRANSLATE_NOOP("@default", "Unknown") },
-    { "VERSION", QT_TRANSLATE_NOOP("@default", "Version") },
-    { "VOLUME", QT_TRANSLATE_NOOP("@default", "Volume") },
-    { "WWW", QT_TRANSLATE_NOOP("@default", "User-defined URL") },
-    { "WM/AlbumArtistSortOrder", QT_TRANSLATE_NOOP("@default", "Sort Album Artist") },
-    { "WM/Comments", QT_TRANSLATE_NOOP("@default", "Comment") },
-    { "WM/MCDI", QT_TRANSLATE_NOOP("@default", "MCDI") },
-    { "WM/Mood", QT_TRANSLATE_NOOP("@default", "Mood") },
-    { "WM/OriginalFilename", QT_TRANSLATE_NOOP("@default", "Original Filename") },
-    { "WM/OriginalLyricist", QT_TRANSLATE_NOOP("@default", "Original Lyricist") },
-    { "WM/PromotionURL", QT_TRANSLATE_NOOP("@default", "Commercial URL") },
-    { "WM/SharedUserRating", QT_TRANSLATE_NOOP("@default", "User Rating") },
-    { "WM/UserWebURL", QT_TRANSLATE_NOOP("@default", "User-defined URL") },
-    { "akID", QT_TRANSLATE_NOOP("@default", "Account Type") },
-    { "apID", QT_TRANSLATE_NOOP("@default", "Purchase Account") },
-    { "atID", QT_TRANSLATE_NOOP("@default", "Artist ID") },
-    { "catg", QT_TRANSLATE_NOOP("@default", "Category") },
-    { "cnID", QT_TRANSLATE_NOOP("@default", "Catalog ID") },
-    { "cond", QT_TRANSLATE_NOOP("@default", "Conductor") },
-    { "desc", QT_TRANSLATE_NOOP("@default", "Description") },
-    { "geID", QT_TRANSLATE_NOOP("@default", "Genre ID") },
-    { "hdvd", QT_TRANSLATE_NOOP("@default", "HD Video") },
-    { "keyw", QT_TRANSLATE_NOOP("@default", "Keyword") },
-    { "ldes", QT_TRANSLATE_NOOP("@default", "Long Description") },
-    { "pcst", QT_TRANSLATE_NOOP("@default", "Podcast") },
-    { "pgap", QT_TRANSLATE_NOOP("@default", "Gapless Playback") },
-    { "plID", QT_TRANSLATE_NOOP("@default", "Album ID") },
-    { "purd", QT_TRANSLATE_NOOP("@default", "Purchase Date") },
-    { "rtng", QT_TRANSLATE_NOOP("@default", "Rating/Advisory") },
-    { "sfID", QT_TRANSLATE_NOOP("@default", "Country Code") },
-    { "sosn", QT_TRANSLATE_NOOP("@default", "Sort Show") },
-    { "stik", QT_TRANSLATE_NOOP("@default", "Media Type") },
-    { "tven", QT_TRANSLATE_NOOP("@default", "TV Episode") },
-    { "tves", QT_TRANSLATE_NOOP("@default", "TV Episode Number") },
-    { "tvnn", QT_TRANSLATE_NOOP("@default", "TV Network Name") },
-    { "tvsh", QT_TRANSLATE_NOOP("@default", "TV Show Name") },
-    { "tvsn", QT_TRANSLATE_NOOP("@default", "TV Season") },
-    { "year", QT_TRANSLATE_NOOP("@default", "Year") },
-    { "\251wrk", QT_TRANSLATE_NOOP("@default", "Work") },
-    { "\251mvn", QT_TRANSLATE_NOOP("@default", "Movement Name") },
-    { "\251mvi", QT_TRANSLATE_NOOP("@default", "Movement Number") },
-    { "\251mvc", QT_TRANSLATE_NOOP("@default", "Movement Count") },
-    { "shwm", QT_TRANSLATE_NOOP("@default", "Show Work & Movement") },
-    { "ownr", QT_TRANSLATE_NOOP("@default", "Owner") },
-    { "purl", QT_TRANSLATE_NOOP("@default", "Podcast URL") },
-    { "egid", QT_TRANSLATE_NOOP("@default", "Podcast GUID") },
-    { "cmID", QT_TRANSLATE_NOOP("@default", "Composer ID") },
-    { "xid ", QT_TRANSLATE_NOOP("@default", "XID") },
-    { "IARL", QT_TRANSLATE_NOOP("@default", "Archival Location") },
-    { "ICMS", QT_TRANSLATE_NOOP("@default", "Commissioned") },
-    { "ICRP", QT_TRANSLATE_NOOP("@default", "Cropped") },
-    { "IDIM", QT_TRANSLATE_NOOP("@default", "Dimensions") },
-    { "IDPI", QT_TRANSLATE_NOOP("@default", "Dots Per Inch") },
-    { "IKEY", QT_TRANSLATE_NOOP("@default", "Keywords") },
-    { "ILGT", QT_TRANSLATE_NOOP("@default", "Lightness") },
-    { "IPLT", QT_TRANSLATE_NOOP("@default", "Number of Colors") },
-    { "ISBJ", QT_TRANSLATE_NOOP("@default", "Subject") },
-    { "ISHP", QT_TRANSLATE_NOOP("@default", "Sharpness") },
-    { "ISRF", QT_TRANSLATE_NOOP("@default", "Source Form") }
-  };
-  static QMap<QByteArray, QByteArray> idStrMap;
-  if (idStrMap.isEmpty()) {
-    // first time initialization
-    for (unsigned int i = 0; i < sizeof(strOfId) / sizeof(strOfId[0]); ++i) {
-      idStrMap.insert(strOfId[i].id, strOfId[i].str);
-    }
+Frame::ExtendedType::ExtendedType(Type type, const QString& name) :
+  m_type(type), m_atom(FrameNameRegistry::instance().intern(name))
+{
+  if (m_atom < 0) {
+    m_name = name;
   }
-  return idStrMap;
-}
-
 }
 
+/**
+ * Constructor.
+ * @param name internal name
+ */
 Frame::ExtendedType::ExtendedType(const QString& name) :
-  m_type(getTypeFromName(name)), m_name(name)
+  m_type(FT_UnknownFrame), m_atom(FrameNameRegistry::instance().intern(name))
 {
+  if (m_atom >= 0) {
+    m_type = FrameNameRegistry::instance().type(m_atom);
+  } else {
+    m_type = FrameNameRegistry::typeOfName(name);
+    m_name = name;
+  }
 }
 
+/**
+ * Constructor.
+ * @param type type
+ */
 Frame::ExtendedType::ExtendedType(Type type) :
-  m_type(type), m_name(QString::fromLatin1(getNameFromType(type)))
+  m_type(type), m_atom(FrameNameRegistry::instance().atomOfType(type))
 {
+  if (m_atom < 0) {
+    m_name = QString::fromLatin1(FrameNameRegistry::nameOfType(type));
+  }
 }
 
 /**
@@ -346,7 +141,14 @@ Frame::ExtendedType::ExtendedType(Type type) :
  */
 QString Frame::ExtendedType::getName() const
 {
-  return m_type != FT_Other ? QString::fromLatin1(getNameFromType(m_type)) : m_name;
+  if (m_type != FT_Other) {
+    FrameNameRegistry& registry = FrameNameRegistry::instance();
+    const int atom = registry.atomOfType(m_type);
+    return atom >= 0
+        ? registry.name(atom)
+        : QString::fromLatin1(FrameNameRegistry::nameOfType(m_type));
+  }
+  return getInternalName();
 }
 
 /**
@@ -355,7 +157,29 @@ QString Frame::ExtendedType::getName() const
  */
 QString Frame::ExtendedType::getTranslatedName() const
 {
-  return m_type != FT_Other ? QCoreApplication::translate("@default", getNameFromType(m_type)) : m_name;
+  return m_type != FT_Other
+      ? QCoreApplication::translate("@default",
+                                    FrameNameRegistry::nameOfType(m_type))
+      : getInternalName();
+}
+
+/**
+ * Get internal name of type.
+ * @return name.
+ */
+QString Frame::ExtendedType::getInternalName() const
+{
+  return m_atom >= 0 ? FrameNameRegistry::instance().name(m_atom) : m_name;
+}
+
+/**
+ * Compare the internal names of two types with different atoms.
+ * @param rhs right hand side to compare
+ * @return true if name of this < name of rhs.
+ */
+bool Frame::ExtendedType::isNameLessThan(const ExtendedType& rhs) const
+{
+  return getInternalName() < rhs.getInternalName();
 }
 
 
@@ -649,22 +473,7 @@ QVariant Frame::getField(const Frame& frame, const QString& fieldName)
  */
 Frame::Type Frame::getTypeFromName(const QString& name)
 {
-  static QMap<QString, int> strNumMap;
-  if (strNumMap.empty()) {
-    // first time initialization
-    for (int i = 0; i <= Frame::FT_LastFrame; ++i) {
-      Frame::Type type = static_cast<Frame::Type>(i);
-      strNumMap.insert(QString::fromLatin1(getNameFromType(type)).
-                       remove(QLatin1Char(' ')).toUpper(), type);
-    }
-  }
-  QString ucName(name.toUpper());
-  ucName.remove(QLatin1Char(' '));
-  QMap<QString, int>::const_iterator it = strNumMap.find(ucName);
-  if (it != strNumMap.end()) {
-    return static_cast<Frame::Type>(*it);
-  }
-  return Frame::FT_Other;
+  return FrameNameRegistry::typeOfName(name);
 }
 
 /**
@@ -676,7 +485,8 @@ Frame::Type Frame::getTypeFromName(const QString& name)
  */
 QString Frame::getFrameTypeName(Type type)
 {
-  return QCoreApplication::translate("@default", getNameFromType(type));
+  return QCoreApplication::translate("@default",
+                                     FrameNameRegistry::nameOfType(type));
 }
 
 /**
@@ -686,34 +496,12 @@ QString Frame::getFrameTypeName(Type type)
  */
 QString Frame::getDisplayName(const QString& name)
 {
-  QMap<QByteArray, QByteArray> idStrMap = getDisplayNamesOfIds();
   if (name.isEmpty())
     return name;
 
-  Type type = getTypeFromName(name);
-  if (type != FT_Other)
-    return QCoreApplication::translate("@default",
-                                       name.toLatin1().constData());
-
-  QString nameStr(name);
-  int nlPos = nameStr.indexOf(QLatin1Char('\n'));
-  if (nlPos > 0)
-    // probably "TXXX - User defined text information\nDescription" or
-    // "WXXX - User defined URL link\nDescription"
-    nameStr = nameStr.mid(nlPos + 1);
-
-  QByteArray id;
-  if (nameStr.mid(4, 3) == QLatin1String(" - ")) {
-    id = nameStr.left(4).toLatin1();
-  } else {
-    id = nameStr.toLatin1();
-  }
-
-  QMap<QByteArray, QByteArray>::const_iterator it = idStrMap.constFind(id);
-  if (it != idStrMap.constEnd()) {
-    return QCoreApplication::translate("@default", it->constData());
-  }
-  return nameStr;
+  // Display names are only looked up, names which are only displayed are
+  // not registered.
+  return FrameNameRegistry::instance().displayNameOfName(name);
 }
 
 /**
@@ -746,8 +534,7 @@ QString Frame::getNameForTranslatedFrameName(const QString& name)
       nameMap.insert(QCoreApplication::translate("@default",
                          name.toLatin1().constData()), name);
     }
-    QMap<QByteArray, QByteArray> idStrMap = getDisplayNamesOfIds();
-    foreach (const QByteArray& name, idStrMap.values()) {
+    foreach (const QByteArray& name, FrameNameRegistry::displayNamesOfIds()) {
       nameMap.insert(QCoreApplication::translate("@default", name),
                      QString::fromLatin1(name));
     }
@@ -959,7 +746,7 @@ void Frame::dump() const
 {
   qDebug("Frame: name=%s, value=%s, type=%s, index=%d, valueChanged=%u, marked=%s",
          getInternalName().toLatin1().data(), m_value.toLatin1().data(),
-         getNameFromType(getType()), m_index,
+         FrameNameRegistry::nameOfType(getType()), m_index,
          m_valueChanged, qPrintable(m_marked.getDescription()));
   qDebug("  fields=");
   for (FieldList::const_iterator it = m_fieldList.begin();
@@ -982,6 +769,125 @@ void Frame::dump() const
 quint64 FrameCollection::s_quickAccessFrames =
     FrameCollection::DEFAULT_QUICK_ACCESS_FRAMES;
 
+/**
+ * Constructor.
+ */
+FrameCollection::FrameCollection()
+{
+  std::fill(m_typeBegin, m_typeBegin + NumTypeSlots, 0);
+}
+
+/**
+ * Remove all frames.
+ */
+void FrameCollection::clear()
+{
+  m_frames.clear();
+  std::fill(m_typeBegin, m_typeBegin + NumTypeSlots, 0);
+}
+
+/**
+ * Insert a frame after all frames which are equal to it.
+ * @param frame frame to insert
+ * @return iterator to inserted frame.
+ */
+FrameCollection::iterator FrameCollection::insert(const Frame& frame)
+{
+  return insert(upper_bound(frame), frame);
+}
+
+/**
+ * Insert a frame.
+ * @param hint position where frame shall be inserted, it is only used
+ *             if the order of the frames is kept
+ * @param frame frame to insert
+ * @return iterator to inserted frame.
+ */
+FrameCollection::iterator FrameCollection::insert(const_iterator hint,
+                                                  const Frame& frame)
+{
+  if (!((hint == begin() || !(frame < *(hint - 1))) &&
+        (hint == end() || !(*hint < frame)))) {
+    hint = upper_bound(frame);
+  }
+  const int pos = hint - begin();
+  m_frames.insert(m_frames.begin() + pos, frame);
+  for (int t = frame.getType() + 1; t < NumTypeSlots; ++t) {
+    ++m_typeBegin[t];
+  }
+  return begin() + pos;
+}
+
+/**
+ * Remove a frame.
+ * @param pos position of frame
+ * @return iterator to the frame after the removed frame.
+ */
+FrameCollection::iterator FrameCollection::erase(const_iterator pos)
+{
+  const int idx = pos - begin();
+  const int type = pos->getType();
+  m_frames.erase(m_frames.begin() + idx);
+  for (int t = type + 1; t < NumTypeSlots; ++t) {
+    --m_typeBegin[t];
+  }
+  return begin() + idx;
+}
+
+/**
+ * Find first frame which is not less than a frame.
+ * @param frame frame with type and name to find
+ * @return iterator.
+ */
+FrameCollection::const_iterator FrameCollection::lower_bound(
+    const Frame& frame) const
+{
+  const int type = frame.getType();
+  const_iterator first = begin() + m_typeBegin[type];
+  if (type != Frame::FT_Other)
+    return first;
+
+  return std::lower_bound(first, begin() + m_typeBegin[type + 1], frame);
+}
+
+/**
+ * Find first frame which is greater than a frame.
+ * @param frame frame with type and name to find
+ * @return iterator.
+ */
+FrameCollection::const_iterator FrameCollection::upper_bound(
+    const Frame& frame) const
+{
+  const int type = frame.getType();
+  const_iterator last = begin() + m_typeBegin[type + 1];
+  if (type != Frame::FT_Other)
+    return last;
+
+  return std::upper_bound(begin() + m_typeBegin[type], last, frame);
+}
+
+/**
+ * Find first frame which is equal to a frame.
+ * @param frame frame with type and name to find
+ * @return iterator or end() if not found.
+ */
+FrameCollection::const_iterator FrameCollection::find(const Frame& frame) const
+{
+  const_iterator it = lower_bound(frame);
+  return it != end() && !(frame < *it) ? it : end();
+}
+
+/**
+ * Exchange the frames with another collection.
+ * @param other other frame collection
+ */
+void FrameCollection::swap(FrameCollection& other)
+{
+  m_frames.swap(other.m_frames);
+  std::swap_ranges(m_typeBegin, m_typeBegin + NumTypeSlots,
+                   other.m_typeBegin);
+}
+
 /**
  * Set values which are different inactive.
  *
@@ -1044,10 +950,9 @@ void FrameCollection::addMissingStandardFrames()
        i <= Frame::FT_LastFrame;
        ++i, mask <<= 1) {
     if (s_quickAccessFrames & mask) {
-      Frame frame(static_cast<Frame::Type>(i), QString(), QString(), -1);
-      FrameCollection::const_iterator it = find(frame);
-      if (it == end()) {
-        insert(frame);
+      Frame::Type type = static_cast<Frame::Type>(i);
+      if (findByType(type) == end()) {
+        insert(Frame(type, QString(), QString(), -1));
       }
     }
   }
@@ -1085,7 +990,7 @@ void FrameCollection::removeDisabledFrames(const FrameFilter& flt)
   for (iterator it = begin();
        it != end();) {
     if (!flt.isEnabled(it->getType(), it->getName())) {
-      erase(it++);
+      it = erase(it);
     } else {
       ++it;
     }
@@ -1200,7 +1105,7 @@ FrameCollection::const_iterator FrameCollection::findByName(
     it = searchByName(name);
     if (it == end()) {
       foreach (const QByteArray& id,
-               getDisplayNamesOfIds().keys(name.toLatin1())) {
+               FrameNameRegistry::idsWithDisplayName(name.toLatin1())) {
         if (!id.isEmpty()) {
           it = searchByName(QString::fromLatin1(id));
           if (it != end()) {
@@ -1267,8 +1172,7 @@ FrameCollection::const_iterator FrameCollection::findByIndex(int index) const
  */
 QString FrameCollection::getValue(Frame::Type type) const
 {
-  Frame frame(type, QLatin1String(""), QLatin1String(""), -1);
-  const_iterator it = find(frame);
+  const_iterator it = findByType(type);
   return it != end() ? it->getValue() : QString();
 }
 
@@ -1296,12 +1200,12 @@ QString FrameCollection::getValue(const Frame::ExtendedType& type) const
 void FrameCollection::setValue(Frame::Type type, const QString& value)
 {
   if (!value.isNull()) {
-    Frame frame(type, QLatin1String(""), QLatin1String(""), -1);
-    iterator it = find(frame);
+    iterator it = findByType(type);
     if (it != end()) {
       Frame& frameFound = const_cast<Frame&>(*it);
       frameFound.setValueIfChanged(value);
     } else {
+      Frame frame(type, QLatin1String(""), QLatin1String(""), -1);
       frame.setValueIfChanged(value);
       insert(frame);
     }
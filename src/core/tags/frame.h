@@ -32,6 +32,7 @@
 #include <QVariant>
 #include <QList>
 #include <set>
+#include <vector>
 #include "framenotice.h"
 #include "kid3api.h"
 
@@ -378,20 +379,23 @@ public:
 
   /**
    * Type and name of frame.
+   * The internal name is stored as an atom of the FrameNameRegistry, so
+   * that types can be copied and compared without string operations. Only
+   * if the registry is full, the name is stored as a string.
    */
   class KID3_CORE_EXPORT ExtendedType {
   public:
     /**
      * Constructor.
      */
-    ExtendedType() : m_type(FT_UnknownFrame) {}
+    ExtendedType() : m_type(FT_UnknownFrame), m_atom(0) {}
 
     /**
      * Constructor.
      * @param type type
      * @param name internal name
      */
-    ExtendedType(Type type, const QString& name) : m_type(type), m_name(name) {}
+    ExtendedType(Type type, const QString& name);
 
     /**
      * Constructor.
@@ -421,7 +425,7 @@ public:
      * Get internal name of type.
      * @return name.
      */
-    QString getInternalName() const { return m_name; }
+    QString getInternalName() const;
 
     /**
      * Less than operator.
@@ -430,7 +434,8 @@ public:
      */
     bool operator<(const ExtendedType& rhs) const {
       return m_type < rhs.m_type ||
-             (m_type == FT_Other && m_type == rhs.m_type && m_name < rhs.m_name);
+             (m_type == FT_Other && m_type == rhs.m_type &&
+              (m_atom != rhs.m_atom || m_atom < 0) && isNameLessThan(rhs));
     }
 
     /**
@@ -440,7 +445,8 @@ public:
      */
     bool operator==(const ExtendedType& rhs) const {
       return m_type == rhs.m_type &&
-             (m_type != FT_Other || m_name == rhs.m_name);
+             (m_type != FT_Other ||
+              (m_atom == rhs.m_atom && (m_atom >= 0 || m_name == rhs.m_name)));
     }
 
     /**
@@ -451,7 +457,18 @@ public:
 
   private:
     friend class Frame;
+
+    /**
+     * Compare the internal names of two types with different atoms.
+     * @param rhs right hand side to compare
+     * @return true if name of this < name of rhs.
+     */
+    bool isNameLessThan(const ExtendedType& rhs) const;
+
     Type m_type;
+    /** Atom of internal name, -1 if it is stored in m_name */
+    int m_atom;
+    /** Internal name if the frame name registry is full */
     QString m_name;
   };
 
@@ -485,7 +502,7 @@ public:
 
   /**
    * Less than operator.
-   * Needed for sorting in multiset.
+   * Needed for sorting in FrameCollection.
    * @param rhs right hand side to compare
    * @return true if this < rhs.
    */
@@ -864,9 +881,32 @@ private:
   std::set<QString> m_disabledOtherFrames;
 };
 
-/** Collection of frames. */
-class KID3_CORE_EXPORT FrameCollection : public std::multiset<Frame> {
+/**
+ * Collection of frames.
+ *
+ * The frames are stored sorted in a contiguous vector, frames which are
+ * equal are kept in the order of their insertion, like in a std::multiset.
+ * The position of the first frame of every type is stored in a table
+ * indexed by Frame::Type, so that standard frames are found in constant
+ * time. Frames of type FT_Other follow the standard frames sorted by name
+ * and are found by binary search.
+ *
+ * Like in a std::multiset, iterator and const_iterator are the same type
+ * and the frames are modified using const_cast. Other than for a
+ * std::multiset, iterators are invalidated when a frame is inserted or
+ * erased.
+ */
+class KID3_CORE_EXPORT FrameCollection {
 public:
+  /** Type of frames. */
+  typedef Frame value_type;
+  /** Iterator, frames are modified using const_cast. */
+  typedef std::vector<Frame>::const_iterator const_iterator;
+  /** Same as const_iterator. */
+  typedef const_iterator iterator;
+  /** Type for number of frames. */
+  typedef std::vector<Frame>::size_type size_type;
+
   /**
    * Default value for quick access frames.
    */
@@ -882,13 +922,102 @@ public:
   /**
    * Constructor.
    */
-  FrameCollection() {}
+  FrameCollection();
 
   /**
    * Destructor.
    */
   ~FrameCollection() {}
 
+  /**
+   * Get iterator to first frame.
+   * @return iterator.
+   */
+  const_iterator begin() const { return m_frames.begin(); }
+
+  /**
+   * Get iterator after last frame.
+   * @return iterator.
+   */
+  const_iterator end() const { return m_frames.end(); }
+
+  /**
+   * Get number of frames.
+   * @return number of frames.
+   */
+  size_type size() const { return m_frames.size(); }
+
+  /**
+   * Check if collection is empty.
+   * @return true if no frames.
+   */
+  bool empty() const { return m_frames.empty(); }
+
+  /**
+   * Remove all frames.
+   */
+  void clear();
+
+  /**
+   * Insert a frame after all frames which are equal to it.
+   * @param frame frame to insert
+   * @return iterator to inserted frame.
+   */
+  iterator insert(const Frame& frame);
+
+  /**
+   * Insert a frame.
+   * @param hint position where frame shall be inserted, it is only used
+   *             if the order of the frames is kept
+   * @param frame frame to insert
+   * @return iterator to inserted frame.
+   */
+  iterator insert(const_iterator hint, const Frame& frame);
+
+  /**
+   * Remove a frame.
+   * @param pos position of frame
+   * @return iterator to the frame after the removed frame.
+   */
+  iterator erase(const_iterator pos);
+
+  /**
+   * Find first frame which is equal to a frame.
+   * @param frame frame with type and name to find
+   * @return iterator or end() if not found.
+   */
+  const_iterator find(const Frame& frame) const;
+
+  /**
+   * Find first frame which is not less than a frame.
+   * @param frame frame with type and name to find
+   * @return iterator.
+   */
+  const_iterator lower_bound(const Frame& frame) const;
+
+  /**
+   * Find first frame which is greater than a frame.
+   * @param frame frame with type and name to find
+   * @return iterator.
+   */
+  const_iterator upper_bound(const Frame& frame) const;
+
+  /**
+   * Find first frame of a type.
+   * @param type frame type
+   * @return iterator or end() if not found.
+   */
+  const_iterator findByType(Frame::Type type) const {
+    return m_typeBegin[type] != m_typeBegin[type + 1]
+        ? m_frames.begin() + m_typeBegin[type] : m_frames.end();
+  }
+
+  /**
+   * Exchange the frames with another collection.
+   * @param other other frame collection
+   */
+  void swap(FrameCollection& other);
+
   /**
    * Set values which are different inactive.
    *
@@ -1182,6 +1311,16 @@ private:
    */
   const_iterator searchByName(const QString& name) const;
 
+  /** Number of entries in m_typeBegin. */
+  enum { NumTypeSlots = Frame::FT_UnknownFrame + 2 };
+
+  std::vector<Frame> m_frames;
+  /**
+   * Index of first frame of every type, the last entry is the number of
+   * frames. The frames of type t are in [m_typeBegin[t], m_typeBegin[t + 1]).
+   */
+  int m_typeBegin[NumTypeSlots];
+
   /**
    * Bit mask containing the bits of all frame types which shall be used as
    * quick access frames.
@@ -0,0 +1,778 @@
+/**
+ * \file framenameregistry.cpp
+ * Registry of interned frame names.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "framenameregistry.h"
+#include <QCoreApplication>
+#include <QVector>
+#include <QPair>
+#include <QSet>
+#include <QtAlgorithms>
+
+namespace {
+
+/** English names of frame types, indexed by Frame::Type. */
+const char* const typeNames[] = {
+  QT_TRANSLATE_NOOP("@default", "Title"),           // FT_Title,
+  QT_TRANSLATE_NOOP("@default", "Artist"),          // FT_Artist,
+  QT_TRANSLATE_NOOP("@default", "Album"),           // FT_Album,
+  QT_TRANSLATE_NOOP("@default", "Comment"),         // FT_Comment,
+  QT_TRANSLATE_NOOP("@default", "Date"),            // FT_Date,
+  QT_TRANSLATE_NOOP("@default", "Track Number"),    // FT_Track,
+  QT_TRANSLATE_NOOP("@default", "Genre"),           // FT_Genre,
+                                // FT_LastV1Frame = FT_Track,
+  QT_TRANSLATE_NOOP("@default", "Album Artist"),    // FT_AlbumArtist
+  QT_TRANSLATE_NOOP("@default", "Arranger"),        // FT_Arranger,
+  QT_TRANSLATE_NOOP("@default", "Author"),          // FT_Author,
+  QT_TRANSLATE_NOOP("@default", "BPM"),             // FT_Bpm,
+  QT_TRANSLATE_NOOP("@default", "Catalog Number"),  // FT_CatalogNumber,
+  QT_TRANSLATE_NOOP("@default", "Compilation"),     // FT_Compilation,
+  QT_TRANSLATE_NOOP("@default", "Composer"),        // FT_Composer,
+  QT_TRANSLATE_NOOP("@default", "Conductor"),       // FT_Conductor,
+  QT_TRANSLATE_NOOP("@default", "Copyright"),       // FT_Copyright,
+  QT_TRANSLATE_NOOP("@default", "Disc Number"),     // FT_Disc,
+  QT_TRANSLATE_NOOP("@default", "Encoded-by"),      // FT_EncodedBy,
+  QT_TRANSLATE_NOOP("@default", "Encoder Settings"), // FT_EncoderSettings,
+  QT_TRANSLATE_NOOP("@default", "Encoding Time"),   // FT_EncodingTime,
+  QT_TRANSLATE_NOOP("@default", "Grouping"),        // FT_Grouping,
+  QT_TRANSLATE_NOOP("@default", "Initial Key"),     // FT_InitialKey,
+  QT_TRANSLATE_NOOP("@default", "ISRC"),            // FT_Isrc,
+  QT_TRANSLATE_NOOP("@default", "Language"),        // FT_Language,
+  QT_TRANSLATE_NOOP("@default", "Lyricist"),        // FT_Lyricist,
+  QT_TRANSLATE_NOOP("@default", "Lyrics"),          // FT_Lyrics,
+  QT_TRANSLATE_NOOP("@default", "Media"),           // FT_Media,
+  QT_TRANSLATE_NOOP("@default", "Mood"),            // FT_Mood,
+  QT_TRANSLATE_NOOP("@default", "Original Album"),  // FT_OriginalAlbum,
+  QT_TRANSLATE_NOOP("@default", "Original Artist"), // FT_OriginalArtist,
+  QT_TRANSLATE_NOOP("@default", "Original Date"),   // FT_OriginalDate,
+  QT_TRANSLATE_NOOP("@default", "Disc Subtitle"),   // FT_Part,
+  QT_TRANSLATE_NOOP("@default", "Performer"),       // FT_Performer,
+  QT_TRANSLATE_NOOP("@default", "Picture"),         // FT_Picture,
+  QT_TRANSLATE_NOOP("@default", "Publisher"),       // FT_Publisher,
+  QT_TRANSLATE_NOOP("@default", "Release Country"), // FT_ReleaseCountry,
+  QT_TRANSLATE_NOOP("@default", "Remixer"),         // FT_Remixer,
+  QT_TRANSLATE_NOOP("@default", "Sort Album"),      // FT_SortAlbum,
+  QT_TRANSLATE_NOOP("@default", "Sort Album Artist"), // FT_SortAlbumArtist,
+  QT_TRANSLATE_NOOP("@default", "Sort Artist"),     // FT_SortArtist,
+  QT_TRANSLATE_NOOP("@default", "Sort Composer"),   // FT_SortComposer,
+  QT_TRANSLATE_NOOP("@default", "Sort Name"),       // FT_SortName,
+  QT_TRANSLATE_NOOP("@default", "Subtitle"),        // FT_Subtitle,
+  QT_TRANSLATE_NOOP("@default", "Website"),         // FT_Website,
+  QT_TRANSLATE_NOOP("@default", "WWW Audio File"),  // FT_WWWAudioFile,
+  QT_TRANSLATE_NOOP("@default", "WWW Audio Source"), // FT_WWWAudioSource,
+  QT_TRANSLATE_NOOP("@default", "Release Date"),    // FT_ReleaseDate,
+  QT_TRANSLATE_NOOP("@default", "Rating")           // FT_Rating,
+                                // FT_LastFrame = FT_Rating
+};
+
+struct not_used { int array_size_check[
+    sizeof(typeNames) / sizeof(typeNames[0]) == Frame::FT_LastFrame + 1
+    ? 1 : -1 ]; };
+
+/** Display names of non unified frame names. */
+const struct StrOfId {
+  const char* id;
+  const char* str;
+} strOfId[] = {
+  { "AENC", QT_TRANSLATE_NOOP("@default", "Audio Encryption") },
+  { "ASPI", QT_TRANSLATE_NOOP("@default", "Audio Seek Point") },
+  { "CHAP", QT_TRANSLATE_NOOP("@default", "Chapter") },
+  { "COMR", QT_TRANSLATE_NOOP("@default", "Commercial") },
+  { "CTOC", QT_TRANSLATE_NOOP("@default", "Table of Contents") },
+  { "ENCR", QT_TRANSLATE_NOOP("@default", "Encryption Method") },
+  { "EQU2", QT_TRANSLATE_NOOP("@default", "Equalization") },
+  { "EQUA", QT_TRANSLATE_NOOP("@default", "Equalization") },
+  { "ETCO", QT_TRANSLATE_NOOP("@default", "Event Timing Codes") },
+  { "GEOB", QT_TRANSLATE_NOOP("@default", "General Object") },
+  { "GRID", QT_TRANSLATE_NOOP("@default", "Group Identification") },
+  { "LINK", QT_TRANSLATE_NOOP("@default", "Linked Information") },
+  { "MCDI", QT_TRANSLATE_NOOP("@default", "Music CD Identifier") },
+  { "MLLT", QT_TRANSLATE_NOOP("@default", "MPEG Lookup Table") },
+  { "MVIN", QT_TRANSLATE_NOOP("@default", "Movement Number") },
+  { "MVNM", QT_TRANSLATE_NOOP("@default", "Movement Name") },
+  { "OWNE", QT_TRANSLATE_NOOP("@default", "Ownership") },
+  { "PCNT", QT_TRANSLATE_NOOP("@default", "Play Counter") },
+  { "PCST", QT_TRANSLATE_NOOP("@default", "Podcast") },
+  { "POPM", QT_TRANSLATE_NOOP("@default", "Popularimeter") },
+  { "POSS", QT_TRANSLATE_NOOP("@default", "Position Synchronisation") },
+  { "PRIV", QT_TRANSLATE_NOOP("@default", "Private") },
+  { "RBUF", QT_TRANSLATE_NOOP("@default", "Recommended Buffer Size") },
+  { "RVA2", QT_TRANSLATE_NOOP("@default", "Volume Adjustment") },
+  { "RVAD", QT_TRANSLATE_NOOP("@default", "Volume Adjustment") },
+  { "RVRB", QT_TRANSLATE_NOOP("@default", "Reverb") },
+  { "SEEK", QT_TRANSLATE_NOOP("@default", "Seek") },
+  { "SIGN", QT_TRANSLATE_NOOP("@default", "Signature") },
+  { "SYLT", QT_TRANSLATE_NOOP("@default", "Synchronized Lyrics") },
+  { "SYTC", QT_TRANSLATE_NOOP("@default", "Synchronized Tempo Codes") },
+  { "TDAT", QT_TRANSLATE_NOOP("@default", "Date") },
+  { "TDEN", QT_TRANSLATE_NOOP("@default", "Encoding Time") },
+  { "TDES", QT_TRANSLATE_NOOP("@default", "Podcast Description") },
+  { "TDLY", QT_TRANSLATE_NOOP("@default", "Playlist Delay") },
+  { "TDOR", QT_TRANSLATE_NOOP("@default", "Original Release Time") },
+  { "TDRC", QT_TRANSLATE_NOOP("@default", "Recording Time") },
+  { "TDRL", QT_TRANSLATE_NOOP("@default", "Release Time") },
+  { "TDTG", QT_TRANSLATE_NOOP("@default", "Tagging Time") },
+  { "TFLT", QT_TRANSLATE_NOOP("@default", "File Type") },
+  { "TGID", QT_TRANSLATE_NOOP("@default", "Podcast Identifier") },
+  { "TIME", QT_TRANSLATE_NOOP("@default", "Time") },
+  { "TLEN", QT_TRANSLATE_NOOP("@default", "Length") },
+  { "TOFN", QT_TRANSLATE_NOOP("@default", "Original Filename") },
+  { "TOWN", QT_TRANSLATE_NOOP("@default", "File Owner") },
+  { "TPRO", QT_TRANSLATE_NOOP("@default", "Produced Notice") },
+  { "TRDA", QT_TRANSLATE_NOOP("@default", "Recording Date") },
+  { "TRSN", QT_TRANSLATE_NOOP("@default", "Radio Station Name") },
+  { "TRSO", QT_TRANSLATE_NOOP("@default", "Radio Station Owner") },
+  { "TSIZ", QT_TRANSLATE_NOOP("@default", "Size") },
+  { "TXXX", QT_TRANSLATE_NOOP("@default", "User-defined Text") },
+  { "UFID", QT_TRANSLATE_NOOP("@default", "Unique File Identifier") },
+  { "USER", QT_TRANSLATE_NOOP("@default", "Terms of Use") },
+  { "WCOM", QT_TRANSLATE_NOOP("@default", "Commercial URL") },
+  { "WCOP", QT_TRANSLATE_NOOP("@default", "Copyright URL") },
+  { "WFED", QT_TRANSLATE_NOOP("@default", "Podcast Feed") },
+  { "WORS", QT_TRANSLATE_NOOP("@default", "Official Radio Station") },
+  { "WPAY", QT_TRANSLATE_NOOP("@default", "Payment") },
+  { "WPUB", QT_TRANSLATE_NOOP("@default", "Official Publisher") },
+  { "WXXX", QT_TRANSLATE_NOOP("@default", "User-defined URL") },
+  { "BAND", QT_TRANSLATE_NOOP("@default", "Album Artist") },
+  { "CONTACT", QT_TRANSLATE_NOOP("@default", "Contact") },
+  { "CONTENTGROUP", QT_TRANSLATE_NOOP("@default", "Grouping") },
+  { "DESCRIPTION", QT_TRANSLATE_NOOP("@default", "Description") },
+  { "DISCTOTAL", QT_TRANSLATE_NOOP("@default", "Total Discs") },
+  { "ENCODER", QT_TRANSLATE_NOOP("@default", "Encoder") },
+  { "ENCODER_OPTIONS", QT_TRANSLATE_NOOP("@default", "Encoder Settings") },
+  { "ENCODEDBY", QT_TRANSLATE_NOOP("@default", "Encoded-by") },
+  { "ENCODING", QT_TRANSLATE_NOOP("@default", "Encoding") },
+  { "ENGINEER", QT_TRANSLATE_NOOP("@default", "Engineer") },
+  { "ENSEMBLE", QT_TRANSLATE_NOOP("@default", "Ensemble") },
+  { "GUESTARTIST", QT_TRANSLATE_NOOP("@default", "Guest Artist") },
+  { "IsVBR", QT_TRANSLATE_NOOP("@default", "VBR") },
+  { "iTunPGAP", QT_TRANSLATE_NOOP("@default", "Gapless Playback") },
+  { "LABEL", QT_TRANSLATE_NOOP("@default", "Label") },
+  { "LABELNO", QT_TRANSLATE_NOOP("@default", "Label Number") },
+  { "LICENSE", QT_TRANSLATE_NOOP("@default", "License") },
+  { "LOCATION", QT_TRANSLATE_NOOP("@default", "Location") },
+  { "OPUS", QT_TRANSLATE_NOOP("@default", "Opus") },
+  { "ORIGARTIST", QT_TRANSLATE_NOOP("@default", "Original Artist") },
+  { "ORGANIZATION", QT_TRANSLATE_NOOP("@default", "Organization") },
+  { "PARTNUMBER", QT_TRANSLATE_NOOP("@default", "Part Number") },
+  { "PRODUCER", QT_TRANSLATE_NOOP("@default", "Producer") },
+  { "PRODUCTNUMBER", QT_TRANSLATE_NOOP("@default", "Product Number") },
+  { "RECORDINGDATE", QT_TRANSLATE_NOOP("@default", "Recording Date") },
+  { "REMIXEDBY", QT_TRANSLATE_NOOP("@default", "Remixer") },
+  { "TOTALDISCS", QT_TRANSLATE_NOOP("@default", "Total Discs") },
+  { "TOTALTRACKS", QT_TRANSLATE_NOOP("@default", "Total Tracks") },
+  { "TRACKTOTAL", QT_TRANSLATE_NOOP("@default", "Total Tracks") },
+  { "UNKNOWN", QT_TRANSLATE_NOOP("@default", "Unknown") },
+  { "Unknown", QT_TRANSLATE_NOOP("@default", "Unknown") },
+  { "VERSION", QT_TRANSLATE_NOOP("@default", "Version") },
+  { "VOLUME", QT_TRANSLATE_NOOP("@default", "Volume") },
+  { "WWW", QT_TRANSLATE_NOOP("@default", "User-defined URL") },
+  { "WM/AlbumArtistSortOrder", QT_TRANSLATE_NOOP("@default", "Sort Album Artist") },
+  { "WM/Comments", QT_TRANSLATE_NOOP("@default", "Comment") },
+  { "WM/MCDI", QT_TRANSLATE_NOOP("@default", "MCDI") },
+  { "WM/Mood", QT_TRANSLATE_NOOP("@default", "Mood") },
+  { "WM/OriginalFilename", QT_TRANSLATE_NOOP("@default", "Original Filename") },
+  { "WM/OriginalLyricist", QT_TRANSLATE_NOOP("@default", "Original Lyricist") },
+  { "WM/PromotionURL", QT_TRANSLATE_NOOP("@default", "Commercial URL") },
+  { "WM/SharedUserRating", QT_TRANSLATE_NOOP("@default", "User Rating") },
+  { "WM/UserWebURL", QT_TRANSLATE_NOOP("@default", "User-defined URL") },
+  { "akID", QT_TRANSLATE_NOOP("@default", "Account Type") },
+  { "apID", QT_TRANSLATE_NOOP("@default", "Purchase Account") },
+  { "atID", QT_TRANSLATE_NOOP("@default", "Artist ID") },
+  { "catg", QT_TRANSLATE_NOOP("@default", "Category") },
+  { "cnID", QT_TRANSLATE_NOOP("@default", "Catalog ID") },
+  { "cond", QT_TRANSLATE_NOOP("@default", "Conductor") },
+  { "desc", QT_TRANSLATE_NOOP("@default", "Description") },
+  { "geID", QT_TRANSLATE_NOOP("@default", "Genre ID") },
+  { "hdvd", QT_TRANSLATE_NOOP("@default", "HD Video") },
+  { "keyw", QT_TRANSLATE_NOOP("@default", "Keyword") },
+  { "ldes", QT_TRANSLATE_NOOP("@default", "Long Description") },
+  { "pcst", QT_TRANSLATE_NOOP("@default", "Podcast") },
+  { "pgap", QT_TRANSLATE_NOOP("@default", "Gapless Playback") },
+  { "plID", QT_TRANSLATE_NOOP("@default", "Album ID") },
+  { "purd", QT_TRANSLATE_NOOP("@default", "Purchase Date") },
+  { "rtng", QT_TRANSLATE_NOOP("@default", "Rating/Advisory") },
+  { "sfID", QT_TRANSLATE_NOOP("@default", "Country Code") },
+  { "sosn", QT_TRANSLATE_NOOP("@default", "Sort Show") },
+  { "stik", QT_TRANSLATE_NOOP("@default", "Media Type") },
+  { "tven", QT_TRANSLATE_NOOP("@default", "TV Episode") },
+  { "tves", QT_TRANSLATE_NOOP("@default", "TV Episode Number") },
+  { "tvnn", QT_TRANSLATE_NOOP("@default", "TV Network Name") },
+  { "tvsh", QT_TRANSLATE_NOOP("@default", "TV Show Name") },
+  { "tvsn", QT_TRANSLATE_NOOP("@default", "TV Season") },
+  { "year", QT_TRANSLATE_NOOP("@default", "Year") },
+  { "\251wrk", QT_TRANSLATE_NOOP("@default", "Work") },
+  { "\251mvn", QT_TRANSLATE_NOOP("@default", "Movement Name") },
+  { "\251mvi", QT_TRANSLATE_NOOP("@default", "Movement Number") },
+  { "\251mvc", QT_TRANSLATE_NOOP("@default", "Movement Count") },
+  { "shwm", QT_TRANSLATE_NOOP("@default", "Show Work & Movement") },
+  { "ownr", QT_TRANSLATE_NOOP("@default", "Owner") },
+  { "purl", QT_TRANSLATE_NOOP("@default", "Podcast URL") },
+  { "egid", QT_TRANSLATE_NOOP("@default", "Podcast GUID") },
+  { "cmID", QT_TRANSLATE_NOOP("@default", "Composer ID") },
+  { "xid ", QT_TRANSLATE_NOOP("@default", "XID") },
+  { "IARL", QT_TRANSLATE_NOOP("@default", "Archival Location") },
+  { "ICMS", QT_TRANSLATE_NOOP("@default", "Commissioned") },
+  { "ICRP", QT_TRANSLATE_NOOP("@default", "Cropped") },
+  { "IDIM", QT_TRANSLATE_NOOP("@default", "Dimensions") },
+  { "IDPI", QT_TRANSLATE_NOOP("@default", "Dots Per Inch") },
+  { "IKEY", QT_TRANSLATE_NOOP("@default", "Keywords") },
+  { "ILGT", QT_TRANSLATE_NOOP("@default", "Lightness") },
+  { "IPLT", QT_TRANSLATE_NOOP("@default", "Number of Colors") },
+  { "ISBJ", QT_TRANSLATE_NOOP("@default", "Subject") },
+  { "ISHP", QT_TRANSLATE_NOOP("@default", "Sharpness") },
+  { "ISRF", QT_TRANSLATE_NOOP("@default", "Source Form") }
+};
+
+/**
+ * Get code of a character.
+ * @param ch character
+ * @return Unicode code point.
+ */
+inline uint charCode(QChar ch)
+{
+  return ch.unicode();
+}
+
+/**
+ * Get code of a Latin-1 character.
+ * @param ch character
+ * @return Unicode code point.
+ */
+inline uint charCode(char ch)
+{
+  return static_cast<uchar>(ch);
+}
+
+/**
+ * Convert a character code to upper case.
+ * @param code Unicode code point
+ * @return upper case code point.
+ */
+inline uint upperCharCode(uint code)
+{
+  if (code >= 'a' && code <= 'z') {
+    return code - ('a' - 'A');
+  }
+  if (code < 0x80) {
+    return code;
+  }
+  return QChar(static_cast<ushort>(code)).toUpper().unicode();
+}
+
+/**
+ * Hash table for a fixed set of keys without collisions.
+ *
+ * The keys are distributed to buckets by a first hash, for every bucket
+ * a seed for a second hash is searched which maps all its keys to free
+ * slots (hash and displace). A lookup needs two hash computations and a
+ * single key comparison. Keys can be normalized while hashing, so that no
+ * temporary string is needed to ignore spaces and case.
+ */
+class PerfectHashTable {
+public:
+  /**
+   * Constructor.
+   * @param normalize true to ignore spaces and case
+   */
+  explicit PerfectHashTable(bool normalize) : m_normalize(normalize) {}
+
+  /**
+   * Build the table.
+   * @param keys keys, the index of a key is returned by indexOf()
+   */
+  void build(const QList<QByteArray>& keys);
+
+  /**
+   * Get index of a key.
+   * @param str key
+   * @return index of key in list passed to build(), -1 if not found.
+   */
+  int indexOf(const QString& str) const {
+    return lookup(str.constData(), str.length());
+  }
+
+  /**
+   * Get index of a key.
+   * @param str Latin-1 key
+   * @return index of key in list passed to build(), -1 if not found.
+   */
+  int indexOf(const QByteArray& str) const {
+    return lookup(str.constData(), str.length());
+  }
+
+private:
+  template <typename Char>
+  uint hash(uint seed, const Char* str, int len) const;
+
+  template <typename Char>
+  bool equals(const QByteArray& key, const Char* str, int len) const;
+
+  template <typename Char>
+  int lookup(const Char* str, int len) const;
+
+  bool m_normalize;
+  QList<QByteArray> m_keys;
+  QVector<uint> m_seeds;
+  QVector<int> m_slots;
+};
+
+/**
+ * Calculate hash of a key.
+ * @param seed seed
+ * @param str characters of key
+ * @param len number of characters
+ * @return hash value.
+ */
+template <typename Char>
+uint PerfectHashTable::hash(uint seed, const Char* str, int len) const
+{
+  // FNV-1a followed by the finalizer of MurmurHash3, so that all bits of
+  // the characters affect the bits used for the slot.
+  uint h = 2166136261U ^ seed;
+  for (int i = 0; i < len; ++i) {
+    uint code = charCode(str[i]);
+    if (m_normalize) {
+      if (code == ' ')
+        continue;
+      code = upperCharCode(code);
+    }
+    h = (h ^ code) * 16777619U;
+  }
+  h ^= h >> 16;
+  h *= 0x85ebca6bU;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35U;
+  h ^= h >> 16;
+  return h;
+}
+
+/**
+ * Compare a key with a string.
+ * @param key normalized key
+ * @param str characters of string
+ * @param len number of characters
+ * @return true if equal.
+ */
+template <typename Char>
+bool PerfectHashTable::equals(const QByteArray& key, const Char* str,
+                              int len) const
+{
+  const int keyLen = key.length();
+  int keyPos = 0;
+  for (int i = 0; i < len; ++i) {
+    uint code = charCode(str[i]);
+    if (m_normalize) {
+      if (code == ' ')
+        continue;
+      code = upperCharCode(code);
+    }
+    if (keyPos >= keyLen ||
+        code != static_cast<uchar>(key.at(keyPos++)))
+      return false;
+  }
+  return keyPos == keyLen;
+}
+
+/**
+ * Get index of a key.
+ * @param str characters of key
+ * @param len number of characters
+ * @return index of key in list passed to build(), -1 if not found.
+ */
+template <typename Char>
+int PerfectHashTable::lookup(const Char* str, int len) const
+{
+  if (m_slots.isEmpty())
+    return -1;
+
+  uint seed = m_seeds.at(hash(0, str, len) % m_seeds.size());
+  int index = m_slots.at(hash(seed, str, len) % m_slots.size());
+  return index >= 0 && equals(m_keys.at(index), str, len) ? index : -1;
+}
+
+/**
+ * Build the table.
+ * @param keys keys, the index of a key is returned by indexOf()
+ */
+void PerfectHashTable::build(const QList<QByteArray>& keys)
+{
+  m_keys.clear();
+  foreach (const QByteArray& key, keys) {
+    QByteArray normalizedKey;
+    if (m_normalize) {
+      for (int i = 0; i < key.length(); ++i) {
+        uint code = charCode(key.at(i));
+        if (code != ' ') {
+          normalizedKey.append(static_cast<char>(upperCharCode(code)));
+        }
+      }
+    } else {
+      normalizedKey = key;
+    }
+    m_keys.append(normalizedKey);
+  }
+
+  const int numKeys = m_keys.size();
+  const int numBuckets = qMax(numKeys / 2, 1);
+  m_seeds.fill(0, numBuckets);
+  m_slots.fill(-1, qMax(numKeys * 2, 1));
+  QVector<QList<int> > buckets(numBuckets);
+  QSet<QByteArray> distinctKeys;
+  for (int i = 0; i < numKeys; ++i) {
+    const QByteArray& key = m_keys.at(i);
+    if (!distinctKeys.contains(key)) {
+      distinctKeys.insert(key);
+      buckets[hash(0, key.constData(), key.length()) % numBuckets].append(i);
+    }
+  }
+
+  // Place the largest buckets first, they are the hardest to place.
+  QList<QPair<int, int> > bucketOrder;
+  for (int b = 0; b < numBuckets; ++b) {
+    if (!buckets.at(b).isEmpty()) {
+      bucketOrder.append(qMakePair(-buckets.at(b).size(), b));
+    }
+  }
+  qSort(bucketOrder);
+
+  typedef QPair<int, int> SizeBucketPair;
+  foreach (const SizeBucketPair& sizeBucket, bucketOrder) {
+    const QList<int>& bucket = buckets.at(sizeBucket.second);
+    QList<int> slots;
+    for (uint seed = 1; ; ++seed) {
+      slots.clear();
+      foreach (int keyIndex, bucket) {
+        const QByteArray& key = m_keys.at(keyIndex);
+        int slot = hash(seed, key.constData(), key.length()) % m_slots.size();
+        if (m_slots.at(slot) != -1 || slots.contains(slot))
+          break;
+        slots.append(slot);
+      }
+      if (slots.size() == bucket.size()) {
+        m_seeds[sizeBucket.second] = seed;
+        for (int i = 0; i < slots.size(); ++i) {
+          m_slots[slots.at(i)] = bucket.at(i);
+        }
+        break;
+      }
+    }
+  }
+}
+
+/**
+ * Perfect hash tables for the fixed frame names.
+ */
+class StaticTables {
+public:
+  /**
+   * Constructor.
+   */
+  StaticTables() : typeNameTable(true), idTable(false) {
+    QList<QByteArray> keys;
+    for (int i = 0; i <= Frame::FT_LastFrame; ++i) {
+      keys.append(typeNames[i]);
+    }
+    typeNameTable.build(keys);
+    keys.clear();
+    for (unsigned int i = 0; i < sizeof(strOfId) / sizeof(strOfId[0]); ++i) {
+      keys.append(strOfId[i].id);
+    }
+    idTable.build(keys);
+  }
+
+  PerfectHashTable typeNameTable; /**< type names, index is Frame::Type */
+  PerfectHashTable idTable;       /**< frame IDs, index into strOfId */
+};
+
+/**
+ * Get the static tables.
+ * They are built on first use, the initialization of the function local
+ * static object is thread safe.
+ * @return static tables.
+ */
+const StaticTables& staticTables()
+{
+  static const StaticTables tables;
+  return tables;
+}
+
+}
+
+/**
+ * Constructor.
+ */
+FrameNameRegistry::FrameNameRegistry() : m_count(0), m_full(false)
+{
+  for (int i = 0; i < MaxChunks; ++i) {
+    m_chunks[i] = 0;
+  }
+  // Atom 0 is the empty name, followed by the names of the frame types.
+  add(QLatin1String(""));
+  for (int i = 0; i <= Frame::FT_LastFrame; ++i) {
+    add(QString::fromLatin1(typeNames[i]));
+  }
+}
+
+/**
+ * Destructor.
+ */
+FrameNameRegistry::~FrameNameRegistry()
+{
+  for (int i = 0; i < MaxChunks; ++i) {
+    delete [] m_chunks[i];
+  }
+}
+
+/**
+ * Get the registry.
+ * @return frame name registry of the application.
+ */
+FrameNameRegistry& FrameNameRegistry::instance()
+{
+  static FrameNameRegistry registry;
+  return registry;
+}
+
+/**
+ * Get the atom of a name, the name is registered if it is not yet known.
+ * @param name frame name
+ * @return atom of @a name.
+ */
+int FrameNameRegistry::intern(const QString& name)
+{
+  // The empty name is registered as atom 0 by the constructor, it is
+  // returned without locking because default constructed types use it.
+  if (name.isEmpty())
+    return 0;
+
+  {
+    QReadLocker locker(&m_lock);
+    QHash<QString, int>::const_iterator it = m_atomOfName.constFind(name);
+    if (it != m_atomOfName.constEnd()) {
+      return *it;
+    }
+  }
+  QWriteLocker locker(&m_lock);
+  QHash<QString, int>::const_iterator it = m_atomOfName.constFind(name);
+  if (it != m_atomOfName.constEnd()) {
+    return *it;
+  }
+  return add(name);
+}
+
+/**
+ * Get the atom of a registered name.
+ * @param name frame name
+ * @return atom of @a name, -1 if not registered.
+ */
+int FrameNameRegistry::find(const QString& name) const
+{
+  QReadLocker locker(&m_lock);
+  return m_atomOfName.value(name, -1);
+}
+
+/**
+ * Get the atom of the name of a frame type.
+ * @param type frame type
+ * @return atom of English name of @a type, -1 if the registry is full.
+ */
+int FrameNameRegistry::atomOfType(Frame::Type type)
+{
+  return type >= Frame::FT_FirstFrame && type <= Frame::FT_LastFrame
+      ? type + 1 : intern(QString::fromLatin1(nameOfType(type)));
+}
+
+/**
+ * Get display name of an atom.
+ * @param atom atom returned by intern()
+ * @return display name, transformed if necessary and translated.
+ */
+QString FrameNameRegistry::displayName(int atom) const
+{
+  return displayNameOfEntry(entry(atom));
+}
+
+/**
+ * Get display name of a name without registering it.
+ * @param name frame name
+ * @return display name, transformed if necessary and translated.
+ */
+QString FrameNameRegistry::displayNameOfName(const QString& name) const
+{
+  const int atom = find(name);
+  if (atom >= 0)
+    return displayName(atom);
+
+  Entry e;
+  initEntry(e, name);
+  return displayNameOfEntry(e);
+}
+
+/**
+ * Get display name of an entry.
+ * @param e entry
+ * @return display name, translated if possible.
+ */
+QString FrameNameRegistry::displayNameOfEntry(const Entry& e)
+{
+  return e.translatableDisplayName
+      ? QCoreApplication::translate("@default", e.translatableDisplayName)
+      : e.displayName;
+}
+
+/**
+ * Get number of registered names.
+ * @return number of atoms.
+ */
+int FrameNameRegistry::count() const
+{
+  QReadLocker locker(&m_lock);
+  return m_count;
+}
+
+/**
+ * Set the type and display name of an entry.
+ * @param e entry
+ * @param name frame name
+ */
+void FrameNameRegistry::initEntry(Entry& e, const QString& name)
+{
+  e.name = name;
+  e.type = typeOfName(name);
+  if (e.type != Frame::FT_Other) {
+    e.latin1Name = name.toLatin1();
+    e.translatableDisplayName = e.latin1Name.constData();
+  } else {
+    QString nameStr(name);
+    int nlPos = nameStr.indexOf(QLatin1Char('\n'));
+    if (nlPos > 0)
+      // probably "TXXX - User defined text information\nDescription" or
+      // "WXXX - User defined URL link\nDescription"
+      nameStr = nameStr.mid(nlPos + 1);
+
+    QByteArray id;
+    if (nameStr.mid(4, 3) == QLatin1String(" - ")) {
+      id = nameStr.left(4).toLatin1();
+    } else {
+      id = nameStr.toLatin1();
+    }
+    e.translatableDisplayName = displayNameOfId(id);
+    e.displayName = nameStr;
+  }
+}
+
+/**
+ * Add a name which is not yet registered.
+ * Must be called with the write lock held.
+ * @param name frame name
+ * @return atom of @a name, -1 if the registry is full.
+ */
+int FrameNameRegistry::add(const QString& name)
+{
+  const int atom = m_count;
+  const int chunk = atom >> ChunkBits;
+  if (chunk >= MaxChunks) {
+    // Returning an existing atom would silently merge different names.
+    if (!m_full) {
+      qWarning("Frame name registry is full, %s and further names are "
+               "not interned", qPrintable(name));
+      m_full = true;
+    }
+    return -1;
+  }
+  if (!m_chunks[chunk]) {
+    m_chunks[chunk] = new Entry[ChunkSize];
+  }
+  initEntry(m_chunks[chunk][atom & (ChunkSize - 1)], name);
+  m_atomOfName.insert(name, atom);
+  ++m_count;
+  return atom;
+}
+
+/**
+ * Get English name of a frame type.
+ * @param type frame type
+ * @return name, "Unknown" if @a type has no name.
+ */
+const char* FrameNameRegistry::nameOfType(Frame::Type type)
+{
+  return type >= Frame::FT_FirstFrame && type <= Frame::FT_LastFrame
+      ? typeNames[type] : "Unknown";
+}
+
+/**
+ * Get type of frame from English name.
+ * The name is not registered.
+ * @param name name, spaces and case are ignored
+ * @return type, FT_Other if not found.
+ */
+Frame::Type FrameNameRegistry::typeOfName(const QString& name)
+{
+  int index = staticTables().typeNameTable.indexOf(name);
+  return index >= 0 ? static_cast<Frame::Type>(index) : Frame::FT_Other;
+}
+
+/**
+ * Get untranslated display name of a frame ID or key which is not unified
+ * by a frame type.
+ * @param id frame ID, e.g. "TDRC", "LABEL", "tvsh"
+ * @return display name, 0 if unknown.
+ */
+const char* FrameNameRegistry::displayNameOfId(const QByteArray& id)
+{
+  int index = staticTables().idTable.indexOf(id);
+  return index >= 0 ? strOfId[index].str : 0;
+}
+
+/**
+ * Get frame IDs having a display name.
+ * @param displayName untranslated display name
+ * @return frame IDs with @a displayName.
+ */
+QList<QByteArray> FrameNameRegistry::idsWithDisplayName(
+    const QByteArray& displayName)
+{
+  QList<QByteArray> ids;
+  for (unsigned int i = 0; i < sizeof(strOfId) / sizeof(strOfId[0]); ++i) {
+    if (displayName == strOfId[i].str) {
+      ids.append(strOfId[i].id);
+    }
+  }
+  return ids;
+}
+
+/**
+ * Get untranslated display names of all frame IDs.
+ * @return display names, can contain duplicates.
+ */
+QList<QByteArray> FrameNameRegistry::displayNamesOfIds()
+{
+  QList<QByteArray> names;
+  for (unsigned int i = 0; i < sizeof(strOfId) / sizeof(strOfId[0]); ++i) {
+    names.append(strOfId[i].str);
+  }
+  return names;
+}
@@ -0,0 +1,223 @@
+/**
+ * \file framenameregistry.h
+ * Registry of interned frame names.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMENAMEREGISTRY_H
+#define FRAMENAMEREGISTRY_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+#include "frame.h"
+#include "kid3api.h"
+
+/**
+ * Registry of frame names.
+ *
+ * Frame names (ID3v2 frame IDs, Vorbis, APE and MP4 keys, unified frame
+ * names) are interned as atoms, small integers which are unique for every
+ * name. The frame type and the display name of a name are determined once
+ * when it is registered, so that they can be looked up in constant time.
+ * The fixed tables of type names and frame IDs are looked up using perfect
+ * hashing without allocating temporary strings.
+ *
+ * Names are never removed, an atom stays valid for the lifetime of the
+ * application. If the registry is full, intern() returns -1 and the name
+ * has to be kept as a string by the caller. Names which are only displayed
+ * are not registered. The registry can be used from multiple threads.
+ */
+class KID3_CORE_EXPORT FrameNameRegistry {
+public:
+  /**
+   * Get the registry.
+   * @return frame name registry of the application.
+   */
+  static FrameNameRegistry& instance();
+
+  /**
+   * Get the atom of a name, the name is registered if it is not yet known.
+   * @param name frame name
+   * @return atom of @a name, 0 for an empty name, -1 if the registry is
+   *         full.
+   */
+  int intern(const QString& name);
+
+  /**
+   * Get the atom of a registered name.
+   * @param name frame name
+   * @return atom of @a name, -1 if not registered.
+   */
+  int find(const QString& name) const;
+
+  /**
+   * Get the atom of the name of a frame type.
+   * @param type frame type
+   * @return atom of English name of @a type, -1 if the registry is full.
+   */
+  int atomOfType(Frame::Type type);
+
+  /**
+   * Get name of an atom.
+   * @param atom atom returned by intern()
+   * @return frame name.
+   */
+  QString name(int atom) const { return entry(atom).name; }
+
+  /**
+   * Get frame type of an atom.
+   * @param atom atom returned by intern()
+   * @return type of name, spaces and case are ignored, FT_Other if the
+   *         name is not the name of a type.
+   */
+  Frame::Type type(int atom) const { return entry(atom).type; }
+
+  /**
+   * Get display name of an atom.
+   * @param atom atom returned by intern()
+   * @return display name, transformed if necessary and translated.
+   */
+  QString displayName(int atom) const;
+
+  /**
+   * Get display name of a name without registering it.
+   * @param name frame name
+   * @return display name, transformed if necessary and translated.
+   */
+  QString displayNameOfName(const QString& name) const;
+
+  /**
+   * Get number of registered names.
+   * @return number of atoms.
+   */
+  int count() const;
+
+  /**
+   * Get English name of a frame type.
+   * @param type frame type
+   * @return name, "Unknown" if @a type has no name.
+   */
+  static const char* nameOfType(Frame::Type type);
+
+  /**
+   * Get type of frame from English name.
+   * The name is not registered.
+   * @param name name, spaces and case are ignored
+   * @return type, FT_Other if not found.
+   */
+  static Frame::Type typeOfName(const QString& name);
+
+  /**
+   * Get untranslated display name of a frame ID or key which is not unified
+   * by a frame type.
+   * @param id frame ID, e.g. "TDRC", "LABEL", "tvsh"
+   * @return display name, 0 if unknown.
+   */
+  static const char* displayNameOfId(const QByteArray& id);
+
+  /**
+   * Get frame IDs having a display name.
+   * @param displayName untranslated display name
+   * @return frame IDs with @a displayName.
+   */
+  static QList<QByteArray> idsWithDisplayName(const QByteArray& displayName);
+
+  /**
+   * Get untranslated display names of all frame IDs.
+   * @return display names, can contain duplicates.
+   */
+  static QList<QByteArray> displayNamesOfIds();
+
+private:
+  /** Data determined when a name is registered. */
+  struct Entry {
+    Entry() : translatableDisplayName(0), type(Frame::FT_UnknownFrame) {}
+    QString name;
+    QByteArray latin1Name;
+    QString displayName;
+    const char* translatableDisplayName;
+    Frame::Type type;
+  };
+
+  /** Parameters of the entry storage. */
+  enum {
+    ChunkBits = 8,                /**< log2 of entries per chunk */
+    ChunkSize = 1 << ChunkBits,   /**< number of entries per chunk */
+    MaxChunks = 4096              /**< maximum number of chunks */
+  };
+
+  /**
+   * Constructor.
+   */
+  FrameNameRegistry();
+
+  /**
+   * Destructor.
+   */
+  ~FrameNameRegistry();
+
+  /**
+   * Get entry of an atom.
+   * Entries are never moved, so they can be read without locking.
+   * @param atom atom returned by intern()
+   * @return entry.
+   */
+  const Entry& entry(int atom) const {
+    return m_chunks[atom >> ChunkBits][atom & (ChunkSize - 1)];
+  }
+
+  /**
+   * Set the type and display name of an entry.
+   * @param e entry
+   * @param name frame name
+   */
+  static void initEntry(Entry& e, const QString& name);
+
+  /**
+   * Get display name of an entry.
+   * @param e entry
+   * @return display name, translated if possible.
+   */
+  static QString displayNameOfEntry(const Entry& e);
+
+  /**
+   * Add a name which is not yet registered.
+   * Must be called with the write lock held.
+   * @param name frame name
+   * @return atom of @a name, -1 if the registry is full.
+   */
+  int add(const QString& name);
+
+  mutable QReadWriteLock m_lock;
+  QHash<QString, int> m_atomOfName;
+  Entry* m_chunks[MaxChunks];
+  int m_count;
+  bool m_full;
+
+  Q_DISABLE_COPY(FrameNameRegistry)
+};
+
+#endif // FRAMENAMEREGISTRY_H
@@ -25,6 +25,7 @@
  */
 
 #include "pictureframe.h"
+#include "picturestore.h"
 #include <QFile>
 #include <QImage>
 #include <QBuffer>
@@ -209,7 +210,7 @@ void PictureFrame::setFields(Frame& frame,
   fields.push_back(field);
 
   field.m_id = ID_Data;
-  field.m_value = data;
+  field.m_value = PictureStore::instance().intern(data);
   fields.push_back(field);
 
   if (imgProps && !imgProps->isNull()) {
@@ -500,7 +501,7 @@ bool PictureFrame::getDescription(const Frame& frame, QString& description)
  */
 bool PictureFrame::setData(Frame& frame, const QByteArray& data)
 {
-  return setField(frame, ID_Data, data);
+  return setField(frame, ID_Data, PictureStore::instance().intern(data));
 }
 
 /**
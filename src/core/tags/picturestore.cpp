@@ -0,0 +1,156 @@
+/**
+ * \file picturestore.cpp
+ * Shared storage for picture data.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "picturestore.h"
+#include <QMutexLocker>
+
+namespace {
+
+/** Minimum size of data to be shared. */
+const int MinSharedSize = 4096;
+/** Minimum number of pictures before unused pictures are purged. */
+const int MinPurgeThreshold = 64;
+/** Minimum number of bytes of pictures before unused pictures are purged. */
+const qint64 MinPurgeSize = 16 * 1024 * 1024;
+
+}
+
+/**
+ * Constructor.
+ */
+PictureStore::PictureStore()
+  : m_totalSize(0), m_purgeSize(MinPurgeSize),
+    m_purgeThreshold(MinPurgeThreshold), m_sharedCount(0)
+{
+}
+
+/**
+ * Get the store.
+ * @return picture store of the application.
+ */
+PictureStore& PictureStore::instance()
+{
+  static PictureStore store;
+  return store;
+}
+
+/**
+ * Get shared data with the same content.
+ * Data smaller than a few kilobytes is returned unchanged, sharing it
+ * would not save memory.
+ *
+ * @param data picture data
+ *
+ * @return data with the same content as @a data, sharing its bytes with
+ * other frames having the same picture.
+ */
+QByteArray PictureStore::intern(const QByteArray& data)
+{
+  if (data.size() < MinSharedSize)
+    return data;
+
+  const uint key = qHash(data);
+  QMutexLocker locker(&m_mutex);
+  for (QMultiHash<uint, QByteArray>::const_iterator it =
+       m_pictures.constFind(key);
+       it != m_pictures.constEnd() && it.key() == key;
+       ++it) {
+    const QByteArray& stored = it.value();
+    if (stored.constData() == data.constData() || stored == data) {
+      ++m_sharedCount;
+      return stored;
+    }
+  }
+
+  m_pictures.insert(key, data);
+  m_totalSize += data.size();
+  // Bounding the store by both count and size keeps the memory held by
+  // unused pictures below that of the pictures in use, even for large
+  // pictures.
+  if (m_pictures.size() > m_purgeThreshold || m_totalSize > m_purgeSize) {
+    purgeUnlocked();
+    m_purgeThreshold = qMax(MinPurgeThreshold, 2 * m_pictures.size());
+    m_purgeSize = qMax(MinPurgeSize, 2 * m_totalSize);
+  }
+  return data;
+}
+
+/**
+ * Remove data which is only referenced by the store.
+ */
+void PictureStore::purge()
+{
+  QMutexLocker locker(&m_mutex);
+  purgeUnlocked();
+}
+
+/**
+ * Remove data which is only referenced by the store.
+ * The mutex must be locked.
+ */
+void PictureStore::purgeUnlocked()
+{
+  QMultiHash<uint, QByteArray>::iterator it = m_pictures.begin();
+  while (it != m_pictures.end()) {
+    // Data which is not shared is no longer used by any frame.
+    if (it.value().isDetached()) {
+      m_totalSize -= it.value().size();
+      it = m_pictures.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+/**
+ * Get number of stored pictures.
+ * @return number of pictures.
+ */
+int PictureStore::count() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_pictures.size();
+}
+
+/**
+ * Get number of bytes of stored pictures.
+ * @return size of all pictures.
+ */
+qint64 PictureStore::totalSize() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_totalSize;
+}
+
+/**
+ * Get number of pictures which were found in the store when interned.
+ * @return number of pictures which did not need additional memory.
+ */
+quint64 PictureStore::sharedCount() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_sharedCount;
+}
@@ -0,0 +1,116 @@
+/**
+ * \file picturestore.h
+ * Shared storage for picture data.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PICTURESTORE_H
+#define PICTURESTORE_H
+
+#include <QByteArray>
+#include <QMultiHash>
+#include <QMutex>
+#include "kid3api.h"
+
+/**
+ * Content addressed storage for the binary data of pictures.
+ *
+ * Embedded pictures are often identical for all files of an album. When
+ * picture data is interned, the store returns an implicitly shared copy of
+ * previously stored data with the same content, so that the bytes of a cover
+ * are only held once in memory, no matter how many frames refer to it.
+ * Data which is no longer referenced by any frame is removed by purge(),
+ * which is called automatically when the number or the total size of the
+ * stored pictures has doubled since the last purge.
+ *
+ * The store is thread safe, so tags can be read in worker threads.
+ */
+class KID3_CORE_EXPORT PictureStore {
+public:
+  /**
+   * Get the store.
+   * @return picture store of the application.
+   */
+  static PictureStore& instance();
+
+  /**
+   * Get shared data with the same content.
+   * Data smaller than a few kilobytes is returned unchanged, sharing it
+   * would not save memory.
+   *
+   * @param data picture data
+   *
+   * @return data with the same content as @a data, sharing its bytes with
+   * other frames having the same picture.
+   */
+  QByteArray intern(const QByteArray& data);
+
+  /**
+   * Remove data which is only referenced by the store.
+   */
+  void purge();
+
+  /**
+   * Get number of stored pictures.
+   * @return number of pictures.
+   */
+  int count() const;
+
+  /**
+   * Get number of bytes of stored pictures.
+   * @return size of all pictures.
+   */
+  qint64 totalSize() const;
+
+  /**
+   * Get number of pictures which were found in the store when interned.
+   * @return number of pictures which did not need additional memory.
+   */
+  quint64 sharedCount() const;
+
+private:
+  /**
+   * Constructor.
+   */
+  PictureStore();
+
+  /**
+   * Remove data which is only referenced by the store.
+   * The mutex must be locked.
+   */
+  void purgeUnlocked();
+
+  mutable QMutex m_mutex;
+  /** Pictures indexed by hash of content */
+  QMultiHash<uint, QByteArray> m_pictures;
+  qint64 m_totalSize;
+  /** Total size above which unused pictures are purged */
+  qint64 m_purgeSize;
+  /** Number of pictures above which unused pictures are purged */
+  int m_purgeThreshold;
+  quint64 m_sharedCount;
+
+  Q_DISABLE_COPY(PictureStore)
+};
+
+#endif // PICTURESTORE_H
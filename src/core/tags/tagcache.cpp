@@ -0,0 +1,681 @@
+/**
+ * \file tagcache.cpp
+ * Persistent cache with the tags of files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tagcache.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QBuffer>
+#include <QVector>
+#include <QPair>
+#include <algorithm>
+
+namespace {
+
+/** Magic number at start of cache file, "K3TC". */
+const quint32 CACHE_MAGIC = 0x4b335443;
+/** Version of cache file format. */
+const quint32 CACHE_VERSION = 4;
+/** Default maximum number of entries. */
+const int DEFAULT_MAX_ENTRIES = 50000;
+/** Default maximum size of entries in bytes. */
+const qint64 DEFAULT_MAX_BYTES = 32 * 1024 * 1024;
+
+/**
+ * Write a frame to a data stream.
+ * @param ds data stream
+ * @param frame frame
+ */
+void writeFrame(QDataStream& ds, const Frame& frame)
+{
+  const Frame::FieldList& fields = frame.getFieldList();
+  ds << static_cast<qint32>(frame.getType()) << frame.getInternalName()
+     << static_cast<qint32>(frame.getIndex()) << frame.getValue()
+     << static_cast<qint32>(fields.size());
+  for (Frame::FieldList::const_iterator it = fields.constBegin();
+       it != fields.constEnd();
+       ++it) {
+    ds << static_cast<qint32>(it->m_id) << it->m_value;
+  }
+}
+
+/**
+ * Read a frame from a data stream.
+ * @param ds data stream
+ * @return frame.
+ */
+Frame readFrame(QDataStream& ds)
+{
+  qint32 type, index, numFields;
+  QString name, value;
+  ds >> type >> name >> index >> value >> numFields;
+  Frame frame(static_cast<Frame::Type>(type), value, name, index);
+  Frame::FieldList& fields = frame.fieldList();
+  for (qint32 i = 0; i < numFields && ds.status() == QDataStream::Ok; ++i) {
+    qint32 id;
+    Frame::Field field;
+    ds >> id >> field.m_value;
+    field.m_id = id;
+    fields.append(field);
+  }
+  return frame;
+}
+
+/**
+ * Write frames to a data stream.
+ * @param ds data stream
+ * @param frames frames
+ */
+void writeFrames(QDataStream& ds, const FrameCollection& frames)
+{
+  ds << static_cast<qint32>(frames.size());
+  for (FrameCollection::const_iterator it = frames.begin();
+       it != frames.end();
+       ++it) {
+    writeFrame(ds, *it);
+  }
+}
+
+/**
+ * Read frames from a data stream.
+ * @param ds data stream
+ * @param frames the frames are returned here
+ */
+void readFrames(QDataStream& ds, FrameCollection& frames)
+{
+  qint32 numFrames;
+  ds >> numFrames;
+  for (qint32 i = 0; i < numFrames && ds.status() == QDataStream::Ok; ++i) {
+    frames.insert(readFrame(ds));
+  }
+}
+
+}
+
+
+/**
+ * Constructor.
+ */
+TagCache::Entry::Entry() : taggedFileFeatures(0), duration(0),
+  detailInfoRead(false)
+{
+}
+
+/**
+ * Destructor.
+ */
+TagCache::Entry::~Entry()
+{
+}
+
+
+/**
+ * Constructor.
+ */
+TagCache::TagCache() : m_numBytes(0), m_useCounter(0),
+  m_maxEntries(DEFAULT_MAX_ENTRIES), m_maxBytes(DEFAULT_MAX_BYTES),
+  m_loaded(false), m_dirty(false), m_pruned(false)
+{
+}
+
+/**
+ * Destructor, saves modified cache.
+ */
+TagCache::~TagCache()
+{
+  save();
+}
+
+/**
+ * Set path of cache file.
+ * Entries of a previously used cache file are saved and discarded.
+ * @param path path to cache file, empty to disable cache
+ */
+void TagCache::setFilePath(const QString& path)
+{
+  if (path == m_filePath)
+    return;
+
+  save();
+  m_entries.clear();
+  m_numBytes = 0;
+  m_loaded = false;
+  m_dirty = false;
+  m_filePath = path;
+}
+
+/**
+ * Set fingerprint of the settings which affect the tags read from files.
+ * Entries stored with a different fingerprint are discarded.
+ * @param fingerprint settings fingerprint
+ */
+void TagCache::setSettingsFingerprint(const QByteArray& fingerprint)
+{
+  if (fingerprint == m_fingerprint)
+    return;
+
+  m_fingerprint = fingerprint;
+  if (m_loaded) {
+    // The tags of the loaded entries were read with the old settings.
+    clear();
+  }
+}
+
+/**
+ * Set limits of the cache size.
+ * Least recently used entries are evicted if a limit is exceeded.
+ * @param maxEntries maximum number of entries
+ * @param maxBytes maximum size of entries in bytes
+ */
+void TagCache::setLimits(int maxEntries, qint64 maxBytes)
+{
+  m_maxEntries = maxEntries;
+  m_maxBytes = maxBytes;
+  if (m_loaded) {
+    evict();
+  }
+}
+
+/**
+ * Get number of entries.
+ * @return number of entries, including outdated entries.
+ */
+int TagCache::size()
+{
+  load();
+  return m_entries.size();
+}
+
+/**
+ * Get size of entries.
+ * @return size of entries in the cache file in bytes.
+ */
+qint64 TagCache::sizeInBytes()
+{
+  load();
+  return m_numBytes;
+}
+
+/**
+ * Check if there is a valid entry for a file.
+ * @param filePath absolute path to file
+ * @return true if an entry exists and the file has not been changed.
+ */
+bool TagCache::contains(const QString& filePath)
+{
+  return findStoredEntry(filePath) != 0;
+}
+
+/**
+ * Get cached information about a file.
+ * @param filePath absolute path to file
+ * @param entry the cached information is returned here
+ * @return true if an entry exists and the file has not been changed.
+ */
+bool TagCache::find(const QString& filePath, Entry& entry)
+{
+  const StoredEntry* storedEntry = findStoredEntry(filePath);
+  if (!storedEntry)
+    return false;
+
+  entry = storedEntry->entry;
+  return true;
+}
+
+/**
+ * Store the information of a tagged file in the cache.
+ * @param filePath absolute path to file
+ * @param taggedFile tagged file with read and unchanged tags
+ */
+void TagCache::insert(const QString& filePath, TaggedFile* taggedFile)
+{
+  if (!isEnabled())
+    return;
+
+  load();
+  StoredEntry storedEntry;
+  if (!getFileProperties(filePath, storedEntry.size, storedEntry.modified,
+                         storedEntry.changed))
+    return;
+
+  Entry& entry = storedEntry.entry;
+  entry.taggedFileKey = taggedFile->taggedFileKey();
+  entry.taggedFileFeatures = taggedFile->activeTaggedFileFeatures();
+  // Do not force reading audio properties which have not been requested.
+  entry.detailInfoRead = taggedFile->isDetailInfoRead();
+  if (entry.detailInfoRead) {
+    taggedFile->getDetailInfo(entry.detailInfo);
+    entry.duration = taggedFile->getDuration();
+  }
+  entry.fileExtension = taggedFile->getFileExtension();
+  FOR_ALL_TAGS(tagNr) {
+    Entry::Tag& tag = entry.tags[tagNr];
+    tag.isSupported = taggedFile->isTagSupported(tagNr);
+    if (!tag.isSupported)
+      continue;
+
+    tag.hasTag = taggedFile->hasTag(tagNr);
+    tag.format = taggedFile->getTagFormat(tagNr);
+    Frame frame;
+    for (int i = Frame::FT_FirstFrame; i <= Frame::FT_LastV1Frame; ++i) {
+      if (taggedFile->getFrame(tagNr, static_cast<Frame::Type>(i), frame)) {
+        tag.standardFrames.insert(frame);
+      }
+    }
+    // Getting all frames would convert pictures which have not been
+    // requested, the file is parsed if the frames are needed.
+    if (!taggedFile->arePicturesRead())
+      continue;
+
+    taggedFile->getAllFrames(tagNr, tag.frames);
+    tag.framesRead = true;
+    for (FrameCollection::iterator it = tag.frames.begin();
+         it != tag.frames.end();
+         ++it) {
+      Frame::FieldList& fields = const_cast<Frame&>(*it).fieldList();
+      for (Frame::FieldList::iterator fit = fields.begin();
+           fit != fields.end();
+           ++fit) {
+        if (fit->m_value.type() == QVariant::ByteArray) {
+          fit->m_value = QByteArray();
+          tag.binaryOmitted = true;
+        }
+      }
+    }
+  }
+  QBuffer buffer;
+  buffer.open(QIODevice::WriteOnly);
+  QDataStream ds(&buffer);
+  ds.setVersion(QDataStream::Qt_4_7);
+  writeEntry(ds, filePath, storedEntry);
+  storedEntry.bytes = buffer.size();
+  addEntry(filePath, storedEntry);
+  m_dirty = true;
+  evict();
+}
+
+/**
+ * Remove the entry of a file.
+ * @param filePath absolute path to file
+ */
+void TagCache::remove(const QString& filePath)
+{
+  if (!isEnabled())
+    return;
+
+  load();
+  QHash<QString, StoredEntry>::iterator it = m_entries.find(filePath);
+  if (it != m_entries.end()) {
+    eraseEntry(it);
+    m_dirty = true;
+  }
+}
+
+/**
+ * Remove all entries.
+ */
+void TagCache::clear()
+{
+  m_entries.clear();
+  m_numBytes = 0;
+  m_loaded = true;
+  m_dirty = true;
+}
+
+/**
+ * Write cache file if entries were modified.
+ * @return true if ok.
+ */
+bool TagCache::save()
+{
+  if (!m_dirty || !isEnabled())
+    return true;
+
+  if (!m_pruned) {
+    m_pruned = true;
+    prune();
+  }
+
+  QDir().mkpath(QFileInfo(m_filePath).absolutePath());
+  QString tmpPath = m_filePath + QLatin1String(".tmp");
+  QFile tmpFile(tmpPath);
+  if (!tmpFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+
+  // The entries are written from the least to the most recently used,
+  // so that the order of use is restored when loading.
+  QVector<QPair<quint64, QString> > useOrder;
+  useOrder.reserve(m_entries.size());
+  for (QHash<QString, StoredEntry>::const_iterator it = m_entries.constBegin();
+       it != m_entries.constEnd();
+       ++it) {
+    useOrder.append(qMakePair(it->lastUse, it.key()));
+  }
+  std::sort(useOrder.begin(), useOrder.end());
+
+  // The entries are stored with a hash, so that a corrupt cache file is
+  // detected before its entries are used.
+  QByteArray entries;
+  QDataStream es(&entries, QIODevice::WriteOnly);
+  es.setVersion(QDataStream::Qt_4_7);
+  es << static_cast<qint32>(useOrder.size());
+  for (QVector<QPair<quint64, QString> >::const_iterator it =
+         useOrder.constBegin();
+       it != useOrder.constEnd();
+       ++it) {
+    writeEntry(es, it->second, m_entries.value(it->second));
+  }
+
+  QDataStream ds(&tmpFile);
+  ds.setVersion(QDataStream::Qt_4_7);
+  ds << CACHE_MAGIC << CACHE_VERSION << m_fingerprint
+     << QCryptographicHash::hash(entries, QCryptographicHash::Md5)
+     << entries;
+  bool ok = es.status() == QDataStream::Ok &&
+      ds.status() == QDataStream::Ok && tmpFile.error() == QFile::NoError;
+  tmpFile.close();
+  if (!ok) {
+    QFile::remove(tmpPath);
+    return false;
+  }
+
+  QFile::remove(m_filePath);
+  if (!QFile::rename(tmpPath, m_filePath))
+    return false;
+
+  m_dirty = false;
+  return true;
+}
+
+/**
+ * Load cache file if not already done.
+ */
+void TagCache::load()
+{
+  if (m_loaded)
+    return;
+
+  m_loaded = true;
+  m_pruned = false;
+  if (!isEnabled())
+    return;
+
+  QFile file(m_filePath);
+  if (!file.open(QIODevice::ReadOnly))
+    return;
+
+  QDataStream ds(&file);
+  ds.setVersion(QDataStream::Qt_4_7);
+  quint32 magic, version;
+  ds >> magic >> version;
+  if (ds.status() != QDataStream::Ok ||
+      magic != CACHE_MAGIC || version != CACHE_VERSION)
+    return;
+
+  QByteArray fingerprint;
+  ds >> fingerprint;
+  if (ds.status() != QDataStream::Ok || fingerprint != m_fingerprint) {
+    // Stored with other settings, it will be replaced on the next save.
+    return;
+  }
+
+  QByteArray hash, entries;
+  ds >> hash >> entries;
+  if (ds.status() != QDataStream::Ok ||
+      hash != QCryptographicHash::hash(entries, QCryptographicHash::Md5)) {
+    // Corrupt cache file, it will be replaced on the next save.
+    return;
+  }
+  file.close();
+
+  QBuffer buffer(&entries);
+  buffer.open(QIODevice::ReadOnly);
+  QDataStream es(&buffer);
+  es.setVersion(QDataStream::Qt_4_7);
+  qint32 numEntries;
+  es >> numEntries;
+  for (qint32 i = 0; i < numEntries && es.status() == QDataStream::Ok; ++i) {
+    QString filePath;
+    StoredEntry storedEntry;
+    qint64 pos = buffer.pos();
+    readEntry(es, filePath, storedEntry);
+    storedEntry.bytes = buffer.pos() - pos;
+    if (es.status() == QDataStream::Ok) {
+      addEntry(filePath, storedEntry);
+    }
+  }
+  if (es.status() != QDataStream::Ok) {
+    // Corrupt cache file, it will be replaced on the next save.
+    m_entries.clear();
+    m_numBytes = 0;
+    return;
+  }
+  // The limits may have been lowered since the cache was written.
+  evict();
+}
+
+/**
+ * Write an entry to a data stream.
+ * @param ds data stream
+ * @param filePath absolute path to file
+ * @param storedEntry entry
+ */
+void TagCache::writeEntry(QDataStream& ds, const QString& filePath,
+                          const StoredEntry& storedEntry)
+{
+  const Entry& entry = storedEntry.entry;
+  const TaggedFile::DetailInfo& info = entry.detailInfo;
+  ds << filePath << storedEntry.size << storedEntry.modified
+     << storedEntry.changed << entry.taggedFileKey
+     << static_cast<qint32>(entry.taggedFileFeatures)
+     << info.format << static_cast<qint32>(info.channelMode)
+     << static_cast<quint32>(info.channels)
+     << static_cast<quint32>(info.sampleRate)
+     << static_cast<quint32>(info.bitrate)
+     << static_cast<quint32>(info.duration) << info.valid << info.vbr
+     << static_cast<quint32>(entry.duration) << entry.detailInfoRead
+     << entry.fileExtension;
+  FOR_ALL_TAGS(tagNr) {
+    const Entry::Tag& tag = entry.tags[tagNr];
+    ds << tag.format << tag.hasTag << tag.isSupported << tag.framesRead
+       << tag.binaryOmitted;
+    writeFrames(ds, tag.frames);
+    writeFrames(ds, tag.standardFrames);
+  }
+}
+
+/**
+ * Read an entry from a data stream.
+ * @param ds data stream
+ * @param filePath the absolute path to the file is returned here
+ * @param storedEntry the entry is returned here
+ */
+void TagCache::readEntry(QDataStream& ds, QString& filePath,
+                         StoredEntry& storedEntry)
+{
+  Entry& entry = storedEntry.entry;
+  TaggedFile::DetailInfo& info = entry.detailInfo;
+  qint32 features, channelMode;
+  quint32 channels, sampleRate, bitrate, infoDuration, duration;
+  ds >> filePath >> storedEntry.size >> storedEntry.modified
+     >> storedEntry.changed >> entry.taggedFileKey >> features
+     >> info.format >> channelMode >> channels >> sampleRate >> bitrate
+     >> infoDuration >> info.valid >> info.vbr
+     >> duration >> entry.detailInfoRead >> entry.fileExtension;
+  entry.taggedFileFeatures = features;
+  info.channelMode =
+      static_cast<TaggedFile::DetailInfo::ChannelMode>(channelMode);
+  info.channels = channels;
+  info.sampleRate = sampleRate;
+  info.bitrate = bitrate;
+  info.duration = infoDuration;
+  entry.duration = duration;
+  FOR_ALL_TAGS(tagNr) {
+    Entry::Tag& tag = entry.tags[tagNr];
+    ds >> tag.format >> tag.hasTag >> tag.isSupported >> tag.framesRead
+       >> tag.binaryOmitted;
+    readFrames(ds, tag.frames);
+    readFrames(ds, tag.standardFrames);
+  }
+}
+
+/**
+ * Get file properties used to check if a cache entry is valid.
+ * @param filePath absolute path to file
+ * @param size the file size is returned here
+ * @param modified the modification time is returned here
+ * @param changed the status change time is returned here
+ * @return true if file exists.
+ */
+bool TagCache::getFileProperties(const QString& filePath, qint64& size,
+                                 qint64& modified, qint64& changed)
+{
+  QFileInfo fileInfo(filePath);
+  if (!fileInfo.exists())
+    return false;
+
+  size = fileInfo.size();
+  modified = fileInfo.lastModified().toMSecsSinceEpoch();
+  // The status change time also changes when the modification time is
+  // restored after writing with "Preserve file timestamp".
+#if QT_VERSION >= 0x050a00
+  changed = fileInfo.metadataChangeTime().toMSecsSinceEpoch();
+#else
+  changed = fileInfo.created().toMSecsSinceEpoch();
+#endif
+  return true;
+}
+
+/**
+ * Find valid entry for file.
+ * @param filePath absolute path to file
+ * @return entry, 0 if not found or outdated.
+ */
+const TagCache::StoredEntry* TagCache::findStoredEntry(const QString& filePath)
+{
+  if (!isEnabled())
+    return 0;
+
+  load();
+  QHash<QString, StoredEntry>::iterator it = m_entries.find(filePath);
+  if (it == m_entries.end())
+    return 0;
+
+  qint64 size, modified, changed;
+  if (!getFileProperties(filePath, size, modified, changed) ||
+      size != it->size || modified != it->modified || changed != it->changed) {
+    // The file has been deleted or modified, the entry cannot be used
+    // anymore.
+    eraseEntry(it);
+    m_dirty = true;
+    return 0;
+  }
+
+  // The order of use is only saved with other modifications, using
+  // entries does not require writing the cache file.
+  it->lastUse = ++m_useCounter;
+  return &it.value();
+}
+
+/**
+ * Add an entry, replacing an existing entry for the same file.
+ * @param filePath absolute path to file
+ * @param storedEntry entry with bytes set
+ */
+void TagCache::addEntry(const QString& filePath,
+                        const StoredEntry& storedEntry)
+{
+  QHash<QString, StoredEntry>::iterator it = m_entries.find(filePath);
+  if (it != m_entries.end()) {
+    m_numBytes -= it->bytes;
+    *it = storedEntry;
+  } else {
+    it = m_entries.insert(filePath, storedEntry);
+  }
+  it->lastUse = ++m_useCounter;
+  m_numBytes += storedEntry.bytes;
+}
+
+/**
+ * Remove an entry.
+ * @param it iterator to entry
+ * @return iterator to next entry.
+ */
+QHash<QString, TagCache::StoredEntry>::iterator TagCache::eraseEntry(
+    QHash<QString, StoredEntry>::iterator it)
+{
+  m_numBytes -= it->bytes;
+  return m_entries.erase(it);
+}
+
+/**
+ * Evict least recently used entries if a limit is exceeded.
+ */
+void TagCache::evict()
+{
+  if (m_entries.size() <= m_maxEntries && m_numBytes <= m_maxBytes)
+    return;
+
+  // Evict down to three quarters of the limits, so that sorting the
+  // entries is not needed for every inserted entry.
+  const int numEntries = m_maxEntries * 3 / 4;
+  const qint64 numBytes = m_maxBytes * 3 / 4;
+  QVector<QPair<quint64, QString> > useOrder;
+  useOrder.reserve(m_entries.size());
+  for (QHash<QString, StoredEntry>::const_iterator it = m_entries.constBegin();
+       it != m_entries.constEnd();
+       ++it) {
+    useOrder.append(qMakePair(it->lastUse, it.key()));
+  }
+  std::sort(useOrder.begin(), useOrder.end());
+  for (QVector<QPair<quint64, QString> >::const_iterator it =
+         useOrder.constBegin();
+       it != useOrder.constEnd() &&
+       (m_entries.size() > numEntries || m_numBytes > numBytes);
+       ++it) {
+    eraseEntry(m_entries.find(it->second));
+  }
+  m_dirty = true;
+}
+
+/**
+ * Remove the entries of files which no longer exist.
+ */
+void TagCache::prune()
+{
+  QHash<QString, StoredEntry>::iterator it = m_entries.begin();
+  while (it != m_entries.end()) {
+    if (!QFileInfo(it.key()).exists()) {
+      it = eraseEntry(it);
+      m_dirty = true;
+    } else {
+      ++it;
+    }
+  }
+}
@@ -0,0 +1,294 @@
+/**
+ * \file tagcache.h
+ * Persistent cache with the tags of files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAGCACHE_H
+#define TAGCACHE_H
+
+#include <QString>
+#include <QHash>
+#include "frame.h"
+#include "taggedfile.h"
+#include "kid3api.h"
+
+class QDataStream;
+
+/**
+ * Persistent cache with the tags of files.
+ *
+ * For each file, the frames, tag formats and detail information are stored
+ * together with the size, modification time and status change time of the
+ * file. An entry is only returned if these file properties are unchanged.
+ * The cache is stored in a single file, which is loaded on first use and
+ * written by save(). Entries are only valid for the settings fingerprint
+ * with which they were stored, see setSettingsFingerprint().
+ *
+ * Only information which has already been read is stored, storing an
+ * entry does not read audio properties or pictures which were not
+ * requested. Binary field data such as pictures is not stored, the fields
+ * are kept as empty placeholders and the file has to be parsed when the
+ * frames with the data are requested.
+ *
+ * The number of entries and their size are limited, the least recently
+ * used entries are evicted when a limit is exceeded. Entries of files
+ * which no longer exist or have been modified are removed when they are
+ * looked up, the entries of all files are checked once when the loaded
+ * cache is saved for the first time.
+ */
+class KID3_CORE_EXPORT TagCache {
+public:
+  /** Cached information about a file. */
+  struct KID3_CORE_EXPORT Entry {
+    /** Constructor. */
+    Entry();
+    /** Destructor. */
+    ~Entry();
+
+    /** Cached information about a tag. */
+    struct Tag {
+      /** Constructor. */
+      Tag() : hasTag(false), isSupported(false), framesRead(false),
+        binaryOmitted(false) {}
+
+      QString format;                 /**< tag format */
+      FrameCollection frames;         /**< frames from getAllFrames() */
+      FrameCollection standardFrames; /**< frames from getFrame() */
+      bool hasTag;                    /**< true if tag exists */
+      bool isSupported;               /**< true if tag is supported */
+      bool framesRead;    /**< true if frames is set, false if pictures
+                               were not yet read */
+      bool binaryOmitted; /**< true if binary data in frames is replaced
+                               by empty placeholders */
+    };
+
+    QString taggedFileKey;           /**< key of tagged file implementation */
+    int taggedFileFeatures;          /**< active tagged file features */
+    TaggedFile::DetailInfo detailInfo; /**< detail information */
+    unsigned duration;               /**< duration in seconds */
+    bool detailInfoRead;             /**< true if detail information is set */
+    QString fileExtension;           /**< file extension */
+    Tag tags[Frame::Tag_NumValues];  /**< information about tags */
+  };
+
+  /**
+   * Constructor.
+   */
+  TagCache();
+
+  /**
+   * Destructor, saves modified cache.
+   */
+  ~TagCache();
+
+  /**
+   * Set path of cache file.
+   * Entries of a previously used cache file are saved and discarded.
+   * @param path path to cache file, empty to disable cache
+   */
+  void setFilePath(const QString& path);
+
+  /**
+   * Get path of cache file.
+   * @return path to cache file.
+   */
+  QString getFilePath() const { return m_filePath; }
+
+  /**
+   * Set fingerprint of the settings which affect the tags read from files.
+   * Entries stored with a different fingerprint are discarded.
+   * @param fingerprint settings fingerprint
+   */
+  void setSettingsFingerprint(const QByteArray& fingerprint);
+
+  /**
+   * Get fingerprint of the settings which affect the tags read from files.
+   * @return settings fingerprint.
+   */
+  QByteArray getSettingsFingerprint() const { return m_fingerprint; }
+
+  /**
+   * Set limits of the cache size.
+   * Least recently used entries are evicted if a limit is exceeded.
+   * @param maxEntries maximum number of entries
+   * @param maxBytes maximum size of entries in bytes
+   */
+  void setLimits(int maxEntries, qint64 maxBytes);
+
+  /**
+   * Get number of entries.
+   * @return number of entries, including outdated entries.
+   */
+  int size();
+
+  /**
+   * Get size of entries.
+   * @return size of entries in the cache file in bytes.
+   */
+  qint64 sizeInBytes();
+
+  /**
+   * Check if the cache has been modified since it was saved.
+   * @return true if save() would write the cache file.
+   */
+  bool isModified() const { return m_dirty; }
+
+  /**
+   * Check if cache is enabled.
+   * @return true if a cache file is set.
+   */
+  bool isEnabled() const { return !m_filePath.isEmpty(); }
+
+  /**
+   * Check if there is a valid entry for a file.
+   * @param filePath absolute path to file
+   * @return true if an entry exists and the file has not been changed.
+   */
+  bool contains(const QString& filePath);
+
+  /**
+   * Get cached information about a file.
+   * @param filePath absolute path to file
+   * @param entry the cached information is returned here
+   * @return true if an entry exists and the file has not been changed.
+   */
+  bool find(const QString& filePath, Entry& entry);
+
+  /**
+   * Store the information of a tagged file in the cache.
+   * @param filePath absolute path to file
+   * @param taggedFile tagged file with read and unchanged tags
+   */
+  void insert(const QString& filePath, TaggedFile* taggedFile);
+
+  /**
+   * Remove the entry of a file.
+   * @param filePath absolute path to file
+   */
+  void remove(const QString& filePath);
+
+  /**
+   * Remove all entries.
+   */
+  void clear();
+
+  /**
+   * Write cache file if entries were modified.
+   * @return true if ok.
+   */
+  bool save();
+
+private:
+  TagCache(const TagCache&);
+  TagCache& operator=(const TagCache&);
+
+  /** Entry with file properties. */
+  struct StoredEntry {
+    Entry entry;              /**< cached information, without binary data */
+    qint64 size;              /**< file size */
+    qint64 modified;          /**< modification time in ms */
+    qint64 changed;           /**< status change time in ms */
+    qint64 bytes;             /**< size in cache file */
+    quint64 lastUse;          /**< use counter when last used */
+  };
+
+  /**
+   * Load cache file if not already done.
+   */
+  void load();
+
+  /**
+   * Write an entry to a data stream.
+   * @param ds data stream
+   * @param filePath absolute path to file
+   * @param storedEntry entry
+   */
+  static void writeEntry(QDataStream& ds, const QString& filePath,
+                         const StoredEntry& storedEntry);
+
+  /**
+   * Read an entry from a data stream.
+   * @param ds data stream
+   * @param filePath the absolute path to the file is returned here
+   * @param storedEntry the entry is returned here
+   */
+  static void readEntry(QDataStream& ds, QString& filePath,
+                        StoredEntry& storedEntry);
+
+  /**
+   * Get file properties used to check if a cache entry is valid.
+   * @param filePath absolute path to file
+   * @param size the file size is returned here
+   * @param modified the modification time is returned here
+   * @param changed the status change time is returned here
+   * @return true if file exists.
+   */
+  static bool getFileProperties(const QString& filePath, qint64& size,
+                                qint64& modified, qint64& changed);
+
+  /**
+   * Find valid entry for file.
+   * @param filePath absolute path to file
+   * @return entry, 0 if not found or outdated.
+   */
+  const StoredEntry* findStoredEntry(const QString& filePath);
+
+  /**
+   * Add an entry, replacing an existing entry for the same file.
+   * @param filePath absolute path to file
+   * @param storedEntry entry with bytes set
+   */
+  void addEntry(const QString& filePath, const StoredEntry& storedEntry);
+
+  /**
+   * Remove an entry.
+   * @param it iterator to entry
+   * @return iterator to next entry.
+   */
+  QHash<QString, StoredEntry>::iterator eraseEntry(
+      QHash<QString, StoredEntry>::iterator it);
+
+  /**
+   * Evict least recently used entries if a limit is exceeded.
+   */
+  void evict();
+
+  /**
+   * Remove the entries of files which no longer exist.
+   */
+  void prune();
+
+  QString m_filePath;
+  QByteArray m_fingerprint;
+  QHash<QString, StoredEntry> m_entries;
+  qint64 m_numBytes;
+  quint64 m_useCounter;
+  int m_maxEntries;
+  qint64 m_maxBytes;
+  bool m_loaded;
+  bool m_dirty;
+  bool m_pruned;
+};
+
+#endif // TAGCACHE_H
@@ -26,6 +26,7 @@
 
 #include "taggedfile.h"
 #include <QDir>
+#include <QFileInfo>
 #include <QString>
 #if QT_VERSION >= 0x050100
 #include <QRegularExpression>
@@ -51,13 +52,15 @@
  * @param idx index in file proxy model
  */
 TaggedFile::TaggedFile(const QPersistentModelIndex& idx) :
-  m_index(idx), m_truncation(0), m_modified(false), m_marked(false)
+  m_index(idx), m_truncation(0), m_modified(false), m_marked(false),
+  m_fileRewritten(false)
 {
   FOR_ALL_TAGS(tagNr) {
     m_changedFrames[tagNr] = 0;
     m_changed[tagNr] = false;
   }
-  Q_ASSERT(m_index.model()->metaObject() == &FileProxyModel::staticMetaObject);
+  Q_ASSERT(!m_index.model() ||
+           m_index.model()->metaObject() == &FileProxyModel::staticMetaObject);
   if (const FileProxyModel* model = getFileProxyModel()) {
     m_newFilename = model->fileName(m_index);
     m_filename = m_newFilename;
@@ -91,7 +94,93 @@ QString TaggedFile::getDirname() const
   if (const FileProxyModel* model = getFileProxyModel()) {
     return model->filePath(m_index.parent());
   }
-  return QString();
+  return m_detachedDirname;
+}
+
+/**
+ * Set the path of a tagged file which is not associated with a model index.
+ * Such a detached tagged file is created with an invalid model index, it
+ * does not notify the model about changes and can therefore be read in a
+ * worker thread. It can be associated with the model later using
+ * attachToIndex().
+ *
+ * @param path absolute path to file
+ */
+void TaggedFile::setDetachedFilePath(const QString& path)
+{
+  QFileInfo fileInfo(path);
+  m_detachedDirname = fileInfo.absolutePath();
+  m_filename = fileInfo.fileName();
+  m_newFilename = m_filename;
+  m_revertedFilename.clear();
+}
+
+/**
+ * Associate a detached tagged file with a model index.
+ * This method must be called in the thread of the model before the tagged
+ * file is stored in the model.
+ *
+ * @param idx index in file proxy model
+ * @see setDetachedFilePath()
+ */
+void TaggedFile::attachToIndex(const QPersistentModelIndex& idx)
+{
+  Q_ASSERT(idx.model()->metaObject() == &FileProxyModel::staticMetaObject);
+  m_index = idx;
+  m_detachedDirname.clear();
+  if (const FileProxyModel* model = getFileProxyModel()) {
+    if (m_modified) {
+      const_cast<FileProxyModel*>(model)->notifyModificationChanged(
+            m_index, m_modified);
+    }
+    const_cast<FileProxyModel*>(model)->notifyModelDataChanged(m_index);
+  }
+}
+
+/**
+ * Temporarily dissociate a tagged file from its model index.
+ * The model is notified as if the file were unmodified, afterwards the
+ * tagged file does not access the model and can be written in a worker
+ * thread. attachToIndex() must be called with the returned index to
+ * store it in the model again.
+ *
+ * @return index in file proxy model.
+ */
+QPersistentModelIndex TaggedFile::detachFromIndex()
+{
+  QPersistentModelIndex idx = m_index;
+  if (const FileProxyModel* model = getFileProxyModel()) {
+    m_detachedDirname = getDirname();
+    if (m_modified) {
+      const_cast<FileProxyModel*>(model)->notifyModificationChanged(
+            m_index, false);
+    }
+    m_index = QPersistentModelIndex();
+  }
+  return idx;
+}
+
+/**
+ * Copy the file name and modification state from another tagged file.
+ * This is used to keep a tagged file which delegates to another tagged
+ * file in sync with it.
+ *
+ * @param source tagged file to copy state from
+ */
+void TaggedFile::copyChangeState(const TaggedFile& source)
+{
+  bool priorTruncation = m_truncation != 0;
+  m_filename = source.m_filename;
+  m_newFilename = source.m_newFilename;
+  m_revertedFilename = source.m_revertedFilename;
+  FOR_ALL_TAGS(tagNr) {
+    m_changedFrames[tagNr] = source.m_changedFrames[tagNr];
+    m_changed[tagNr] = source.m_changed[tagNr];
+  }
+  m_truncation = source.m_truncation;
+  m_marked = source.m_marked;
+  updateModifiedState();
+  notifyTruncationChanged(priorTruncation);
 }
 
 /**
@@ -115,6 +204,9 @@ QString TaggedFile::currentFilePath() const
   if (const FileProxyModel* model = getFileProxyModel()) {
     return model->filePath(m_index);
   }
+  if (!m_detachedDirname.isEmpty()) {
+    return QDir(m_detachedDirname).filePath(m_filename);
+  }
   return QString();
 }
 
@@ -935,12 +1027,42 @@ void TaggedFile::updateMarkedState(Frame::TagNumber tagNr,
   }
 }
 
+/**
+ * Check if technical detail information is available without reading
+ * more of the file.
+ * Implementations which read the audio properties only when
+ * getDetailInfo() or getDuration() is called return false until then.
+ * The default implementation returns true.
+ *
+ * @return true if detail information has been read.
+ */
+bool TaggedFile::isDetailInfoRead() const
+{
+  return true;
+}
+
+/**
+ * Check if the pictures are available without reading more of the file.
+ * Implementations which convert pictures to frames only when they are
+ * accessed return false until then, getAllFrames() would read them.
+ * The default implementation returns true.
+ *
+ * @return true if pictures have been read.
+ */
+bool TaggedFile::arePicturesRead() const
+{
+  return true;
+}
+
 /**
  * Close any file handles which are held open by the tagged file object.
  * The default implementation does nothing. If a concrete subclass holds
  * any file handles open, it has to close them in this method. This method
  * can be used before operations which require that a file is not open,
  * e.g. file renaming on Windows.
+ * Subclasses which keep file handles open between operations should
+ * register them with the FileHandlePool, which limits the number of open
+ * files by closing the least recently used ones.
  */
 void TaggedFile::closeFileHandle()
 {
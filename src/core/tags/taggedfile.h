@@ -111,6 +111,47 @@ public:
    */
   QString getDirname() const;
 
+  /**
+   * Set the path of a tagged file which is not associated with a model index.
+   * Such a detached tagged file is created with an invalid model index, it
+   * does not notify the model about changes and can therefore be read in a
+   * worker thread. It can be associated with the model later using
+   * attachToIndex().
+   *
+   * @param path absolute path to file
+   */
+  void setDetachedFilePath(const QString& path);
+
+  /**
+   * Associate a detached tagged file with a model index.
+   * This method must be called in the thread of the model before the tagged
+   * file is stored in the model.
+   *
+   * @param idx index in file proxy model
+   * @see setDetachedFilePath()
+   */
+  void attachToIndex(const QPersistentModelIndex& idx);
+
+  /**
+   * Temporarily dissociate a tagged file from its model index.
+   * The model is notified as if the file were unmodified, afterwards the
+   * tagged file does not access the model and can be written in a worker
+   * thread. attachToIndex() must be called with the returned index to
+   * store it in the model again.
+   *
+   * @return index in file proxy model.
+   */
+  QPersistentModelIndex detachFromIndex();
+
+  /**
+   * Copy the file name and modification state from another tagged file.
+   * This is used to keep a tagged file which delegates to another tagged
+   * file in sync with it.
+   *
+   * @param source tagged file to copy state from
+   */
+  void copyChangeState(const TaggedFile& source);
+
   /**
    * Get key of tagged file format.
    * @return key.
@@ -219,6 +260,27 @@ public:
    */
   virtual unsigned getDuration() const = 0;
 
+  /**
+   * Check if technical detail information is available without reading
+   * more of the file.
+   * Implementations which read the audio properties only when
+   * getDetailInfo() or getDuration() is called return false until then.
+   * The default implementation returns true.
+   *
+   * @return true if detail information has been read.
+   */
+  virtual bool isDetailInfoRead() const;
+
+  /**
+   * Check if the pictures are available without reading more of the file.
+   * Implementations which convert pictures to frames only when they are
+   * accessed return false until then, getAllFrames() would read them.
+   * The default implementation returns true.
+   *
+   * @return true if pictures have been read.
+   */
+  virtual bool arePicturesRead() const;
+
   /**
    * Get file extension including the dot.
    *
@@ -298,6 +360,9 @@ public:
    * any file handles open, it has to close them in this method. This method
    * can be used before operations which require that a file is not open,
    * e.g. file renaming on Windows.
+   * Subclasses which keep file handles open between operations should
+   * register them with the FileHandlePool, which limits the number of open
+   * files by closing the least recently used ones.
    */
   virtual void closeFileHandle();
 
@@ -355,6 +420,14 @@ public:
    */
   bool isFilenameChanged() const { return m_newFilename != m_filename; }
 
+  /**
+   * Check if the last writeTags() had to rewrite the whole file because
+   * the tags did not fit into the space reserved for them.
+   *
+   * @return true if file was rewritten.
+   */
+  bool isFileRewritten() const { return m_fileRewritten; }
+
   /**
    * Get absolute filename.
    *
@@ -555,6 +628,12 @@ protected:
    */
   void markFilenameUnchanged();
 
+  /**
+   * Set if the whole file was rewritten by writeTags().
+   * @param rewritten true if file was rewritten, false when writing starts
+   */
+  void setFileRewritten(bool rewritten) { m_fileRewritten = rewritten; }
+
   /**
    * Revert modification of filename.
    */
@@ -645,6 +724,8 @@ private:
   QString m_newFilename;
   /** File name reverted because file was not writable */
   QString m_revertedFilename;
+  /** Directory path if the tagged file is not associated with a model */
+  QString m_detachedDirname;
   /** changed tag frame types */
   quint64 m_changedFrames[Frame::Tag_NumValues];
   /** Truncation flags. */
@@ -655,6 +736,8 @@ private:
   bool m_modified;
   /** true if tagged file is marked */
   bool m_marked;
+  /** true if the whole file was rewritten by writeTags() */
+  bool m_fileRewritten;
 };
 
 #endif // TAGGEDFILE_H
@@ -102,8 +102,6 @@ QString TrackDataFormatReplacer::getReplacement(const QString& code) const
     }
 
     if (!name.isNull()) {
-      TaggedFile::DetailInfo info;
-      m_trackData.getDetailInfo(info);
       if (name == QLatin1String("file")) {
         QString filename(m_trackData.getAbsFilename());
         int sepPos = filename.lastIndexOf(QLatin1Char('/'));
@@ -134,32 +132,43 @@ QString TrackDataFormatReplacer::getReplacement(const QString& code) const
         if (tagNr < Frame::Tag_NumValues) {
           result = m_trackData.getTagFormat(tagNr);
         }
-      } else if (name == QLatin1String("bitrate")) {
-        result.setNum(info.bitrate);
-      } else if (name == QLatin1String("vbr")) {
-        result = info.vbr ? QLatin1String("VBR") : QLatin1String("");
-      } else if (name == QLatin1String("samplerate")) {
-        result.setNum(info.sampleRate);
-      } else if (name == QLatin1String("mode")) {
-        switch (info.channelMode) {
-          case TaggedFile::DetailInfo::CM_Stereo:
-            result = QLatin1String("Stereo");
-            break;
-          case TaggedFile::DetailInfo::CM_JointStereo:
-            result = QLatin1String("Joint Stereo");
-            break;
-          case TaggedFile::DetailInfo::CM_None:
-          default:
-            result = QLatin1String("");
-        }
-      } else if (name == QLatin1String("channels")) {
-        result.setNum(info.channels);
-      } else if (name == QLatin1String("codec")) {
-        result = info.format;
       } else if (name == QLatin1String("marked")) {
         TaggedFile* taggedFile = m_trackData.getTaggedFile();
         result = taggedFile && taggedFile->isMarked()
             ? QLatin1String("1") : QLatin1String("");
+      } else if (name == QLatin1String("bitrate") ||
+                 name == QLatin1String("vbr") ||
+                 name == QLatin1String("samplerate") ||
+                 name == QLatin1String("mode") ||
+                 name == QLatin1String("channels") ||
+                 name == QLatin1String("codec")) {
+        // Only get detail information when needed, the tagged file may have
+        // to read the audio properties from the file.
+        TaggedFile::DetailInfo info;
+        m_trackData.getDetailInfo(info);
+        if (name == QLatin1String("bitrate")) {
+          result.setNum(info.bitrate);
+        } else if (name == QLatin1String("vbr")) {
+          result = info.vbr ? QLatin1String("VBR") : QLatin1String("");
+        } else if (name == QLatin1String("samplerate")) {
+          result.setNum(info.sampleRate);
+        } else if (name == QLatin1String("mode")) {
+          switch (info.channelMode) {
+            case TaggedFile::DetailInfo::CM_Stereo:
+              result = QLatin1String("Stereo");
+              break;
+            case TaggedFile::DetailInfo::CM_JointStereo:
+              result = QLatin1String("Joint Stereo");
+              break;
+            case TaggedFile::DetailInfo::CM_None:
+            default:
+              result = QLatin1String("");
+          }
+        } else if (name == QLatin1String("channels")) {
+          result.setNum(info.channels);
+        } else if (name == QLatin1String("codec")) {
+          result = info.format;
+        }
       }
     }
   }
@@ -370,10 +379,37 @@ void TrackData::getDetailInfo(TaggedFile::DetailInfo& info) const
  */
 QString TrackData::formatString(const QString& format) const
 {
-  TrackDataFormatReplacer fmt(*this, format);
+  return formatString(compileFormat(format));
+}
+
+/**
+ * Format a string from track data using a compiled format.
+ *
+ * @param tmpl format compiled with compileFormat()
+ *
+ * @return formatted string.
+ */
+QString TrackData::formatString(const FormatReplacer::Template& tmpl) const
+{
+  return TrackDataFormatReplacer(*this).format(tmpl);
+}
+
+/**
+ * Compile a format for formatString().
+ * The escaped characters are replaced and the format codes are parsed,
+ * so that the format can be used for many tracks.
+ *
+ * @param format format specification
+ *
+ * @return compiled format.
+ */
+FormatReplacer::Template TrackData::compileFormat(const QString& format)
+{
+  TrackData noTrackData;
+  TrackDataFormatReplacer fmt(noTrackData, format);
   fmt.replaceEscapedChars();
-  fmt.replacePercentCodes(FormatReplacer::FSF_SupportHtmlEscape);
-  return fmt.getString();
+  return FormatReplacer::Template(fmt.getString(),
+                                  FormatReplacer::FSF_SupportHtmlEscape);
 }
 
 /**
@@ -386,21 +422,52 @@ QString TrackData::formatString(const QString& format) const
  * @return format string with format codes replaced by tags.
  */
 QString TrackData::formatFilenameFromTags(QString str, bool isDirname) const
+{
+  return formatFilenameFromTags(compileFilenameFormat(str, isDirname),
+                                isDirname);
+}
+
+/**
+ * Create filename from tags according to a compiled format.
+ *
+ * @param tmpl      format compiled with compileFilenameFormat()
+ * @param isDirname true to generate a directory name, must be the same
+ *                  as used with compileFilenameFormat()
+ *
+ * @return format string with format codes replaced by tags.
+ */
+QString TrackData::formatFilenameFromTags(const FormatReplacer::Template& tmpl,
+                                          bool isDirname) const
+{
+  QString str = TrackDataFormatReplacer(*this).format(tmpl);
+  if (!isDirname) {
+    // add extension, it does not contain format codes
+    str += getFileExtension(true);
+  }
+  return str;
+}
+
+/**
+ * Compile a format for formatFilenameFromTags().
+ *
+ * @param str       format string containing codes supported by
+ *                  TrackDataFormatReplacer::getReplacement()
+ * @param isDirname true to generate a directory name
+ *
+ * @return compiled format.
+ */
+FormatReplacer::Template TrackData::compileFilenameFormat(QString str,
+                                                          bool isDirname)
 {
   if (!isDirname) {
-    // first remove directory part from str
+    // remove directory part from str
     const int sepPos = str.lastIndexOf(QLatin1Char('/'));
     if (sepPos >= 0) {
       str.remove(0, sepPos + 1);
     }
-    // add extension to str
-    str += getFileExtension(true);
   }
-
-  TrackDataFormatReplacer fmt(*this, str);
-  fmt.replacePercentCodes(isDirname ?
-                          FormatReplacer::FSF_ReplaceSeparators : 0);
-  return fmt.getString();
+  return FormatReplacer::Template(
+        str, isDirname ? FormatReplacer::FSF_ReplaceSeparators : 0);
 }
 
 /**
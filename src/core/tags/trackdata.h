@@ -119,6 +119,26 @@ public:
    */
   QString formatString(const QString& format) const;
 
+  /**
+   * Format a string from track data using a compiled format.
+   *
+   * @param tmpl format compiled with compileFormat()
+   *
+   * @return formatted string.
+   */
+  QString formatString(const FormatReplacer::Template& tmpl) const;
+
+  /**
+   * Compile a format for formatString().
+   * The escaped characters are replaced and the format codes are parsed,
+   * so that the format can be used for many tracks.
+   *
+   * @param format format specification
+   *
+   * @return compiled format.
+   */
+  static FormatReplacer::Template compileFormat(const QString& format);
+
   /**
    * Create filename from tags according to format string.
    *
@@ -130,6 +150,30 @@ public:
    */
   QString formatFilenameFromTags(QString str, bool isDirname = false) const;
 
+  /**
+   * Create filename from tags according to a compiled format.
+   *
+   * @param tmpl      format compiled with compileFilenameFormat()
+   * @param isDirname true to generate a directory name, must be the same
+   *                  as used with compileFilenameFormat()
+   *
+   * @return format string with format codes replaced by tags.
+   */
+  QString formatFilenameFromTags(const FormatReplacer::Template& tmpl,
+                                 bool isDirname = false) const;
+
+  /**
+   * Compile a format for formatFilenameFromTags().
+   *
+   * @param str       format string containing codes supported by
+   *                  TrackDataFormatReplacer::getReplacement()
+   * @param isDirname true to generate a directory name
+   *
+   * @return compiled format.
+   */
+  static FormatReplacer::Template compileFilenameFormat(QString str,
+                                                        bool isDirname = false);
+
   /**
    * Get frames.
    * @return frames.
@@ -1,6 +1,11 @@
 set(utils_SRCS
   utils/debugutils.cpp
   utils/saferename.cpp
+  utils/filerewriter.cpp
+  utils/filehandlepool.cpp
+  utils/operationprofiler.cpp
+  utils/directoryscanner.cpp
+  utils/directorywatcher.cpp
   utils/loadtranslation.cpp
   utils/icoreplatformtools.cpp
   utils/coreplatformtools.cpp
@@ -8,4 +13,6 @@ set(utils_SRCS
 
 set(utils_MOC_HDRS
   utils/debugutils.h
+  utils/directoryscanner.h
+  utils/directorywatcher.h
 )
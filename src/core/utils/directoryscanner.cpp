@@ -0,0 +1,470 @@
+/**
+ * \file directoryscanner.cpp
+ * Recursive parallel directory scanner.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "directoryscanner.h"
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QRegExp>
+#include <QStack>
+#include <QMutexLocker>
+#ifdef Q_OS_UNIX
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/**
+ * Create regular expressions for wildcard folder patterns.
+ * A separate list is needed for each thread because QRegExp keeps its
+ * match state.
+ * @param patterns wildcard patterns
+ * @return regular expressions.
+ */
+QList<QRegExp> createFolderRegExps(const QStringList& patterns)
+{
+  QList<QRegExp> regExps;
+  foreach (const QString& pattern, patterns) {
+    regExps.append(QRegExp(pattern, Qt::CaseInsensitive, QRegExp::Wildcard));
+  }
+  return regExps;
+}
+
+/**
+ * Check if a path matches any of the regular expressions.
+ * @param regExps regular expressions
+ * @param path directory path
+ * @return true if a regular expression matches exactly.
+ */
+bool matchesAny(QList<QRegExp>& regExps, const QString& path)
+{
+  for (QList<QRegExp>::iterator it = regExps.begin();
+       it != regExps.end();
+       ++it) {
+    if (it->exactMatch(path)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Join a directory path and a file name.
+ * @param dirPath directory path
+ * @param name file name
+ * @return path of entry.
+ */
+QString joinPath(const QString& dirPath, const QString& name)
+{
+  return dirPath.endsWith(QLatin1Char('/'))
+      ? dirPath + name : dirPath + QLatin1Char('/') + name;
+}
+
+}
+
+/**
+ * Task reading a directory in a worker thread.
+ */
+class DirectoryScanner::ScanTask : public QRunnable {
+public:
+  /**
+   * Constructor.
+   * @param scanner directory scanner
+   * @param dirPath path of directory
+   * @param generation generation of scan
+   */
+  ScanTask(DirectoryScanner* scanner, const QString& dirPath, int generation)
+    : m_scanner(scanner), m_dirPath(dirPath), m_generation(generation) {}
+
+  /**
+   * Read directory.
+   */
+  virtual void run() { m_scanner->scanDirectory(m_dirPath, m_generation); }
+
+private:
+  DirectoryScanner* m_scanner;
+  QString m_dirPath;
+  int m_generation;
+};
+
+
+/**
+ * Constructor.
+ * @param parent parent object
+ */
+DirectoryScanner::DirectoryScanner(QObject* parent) : QObject(parent),
+  m_threadPool(new QThreadPool(this)), m_numPending(0), m_generation(0),
+  m_numDirectories(0), m_aborted(false), m_showHidden(false),
+  m_running(false)
+{
+  setObjectName(QLatin1String("DirectoryScanner"));
+  // Reading directories mostly waits for the file system, so more threads
+  // than cores are useful, especially on network file systems.
+  m_threadPool->setMaxThreadCount(qBound(2, 2 * QThread::idealThreadCount(),
+                                         16));
+}
+
+/**
+ * Destructor.
+ */
+DirectoryScanner::~DirectoryScanner()
+{
+  abort();
+  m_threadPool->waitForDone();
+}
+
+/**
+ * Set filters for folders.
+ * Subdirectories which do not match the exclude filters are listed,
+ * they are entered if they also match the include filters.
+ *
+ * @param includeFolders wildcard patterns of folders to include,
+ * all folders are included if empty
+ * @param excludeFolders wildcard patterns of folders to exclude
+ */
+void DirectoryScanner::setFolderFilters(const QStringList& includeFolders,
+                                        const QStringList& excludeFolders)
+{
+  m_includeFolders.clear();
+  foreach (QString filter, includeFolders) {
+    filter.replace(QLatin1Char('\\'), QLatin1Char('/'));
+    m_includeFolders.append(filter);
+  }
+  m_excludeFolders.clear();
+  foreach (QString filter, excludeFolders) {
+    filter.replace(QLatin1Char('\\'), QLatin1Char('/'));
+    m_excludeFolders.append(filter);
+  }
+}
+
+/**
+ * Set maximum number of worker threads.
+ * @param maxThreadCount number of threads
+ */
+void DirectoryScanner::setMaxThreadCount(int maxThreadCount)
+{
+  m_threadPool->setMaxThreadCount(maxThreadCount);
+}
+
+/**
+ * Start scanning directories in the background.
+ * A scan which is still running is aborted. finished() is emitted when
+ * all directories have been read.
+ *
+ * @param rootPaths paths of directories to scan, a path of a file is
+ * only listed itself
+ */
+void DirectoryScanner::start(const QStringList& rootPaths)
+{
+  if (m_running) {
+    abort();
+    m_threadPool->waitForDone();
+  }
+  ++m_generation;
+  m_rootPaths = rootPaths;
+  m_paths.clear();
+  m_children.clear();
+  m_visited.clear();
+  m_numDirectories = 0;
+  m_numPending = 0;
+  m_aborted = false;
+  m_running = true;
+  foreach (const QString& rootPath, m_rootPaths) {
+    if (QFileInfo(rootPath).isDir()) {
+      enqueue(rootPath, m_generation);
+    }
+  }
+  if (m_numPending == 0) {
+    // Nothing to read, finish asynchronously like a scan.
+    QMetaObject::invokeMethod(this, "onTasksDone", Qt::QueuedConnection,
+                              Q_ARG(int, m_generation));
+  }
+}
+
+/**
+ * Wait until the current scan has finished.
+ * The results are available when this method returns, finished() is
+ * not emitted for the scan.
+ */
+void DirectoryScanner::waitForFinished()
+{
+  if (m_running) {
+    m_threadPool->waitForDone();
+    assemblePaths();
+    m_running = false;
+  }
+}
+
+/**
+ * Scan directories synchronously.
+ * @param rootPaths paths of directories to scan
+ * @return paths of root directories and their entries.
+ */
+QStringList DirectoryScanner::scan(const QStringList& rootPaths)
+{
+  start(rootPaths);
+  waitForFinished();
+  return m_paths;
+}
+
+/**
+ * Abort the current scan.
+ * finished() is still emitted, without results.
+ */
+void DirectoryScanner::abort()
+{
+  QMutexLocker locker(&m_mutex);
+  m_aborted = true;
+}
+
+/**
+ * Enqueue a task for a directory.
+ * @param dirPath path of directory
+ * @param generation generation of scan
+ */
+void DirectoryScanner::enqueue(const QString& dirPath, int generation)
+{
+  {
+    QMutexLocker locker(&m_mutex);
+    ++m_numPending;
+  }
+  m_threadPool->start(new ScanTask(this, dirPath, generation));
+}
+
+/**
+ * Mark a task as done.
+ * @param generation generation of scan
+ */
+void DirectoryScanner::taskDone(int generation)
+{
+  bool allDone;
+  {
+    QMutexLocker locker(&m_mutex);
+    allDone = --m_numPending == 0;
+  }
+  if (allDone) {
+    QMetaObject::invokeMethod(this, "onTasksDone", Qt::QueuedConnection,
+                              Q_ARG(int, generation));
+  }
+}
+
+/**
+ * Called in the thread of the scanner when all tasks are done.
+ * @param generation generation of scan
+ */
+void DirectoryScanner::onTasksDone(int generation)
+{
+  if (generation != m_generation || !m_running)
+    return;
+
+  m_threadPool->waitForDone();
+  assemblePaths();
+  m_running = false;
+  emit finished();
+}
+
+/**
+ * Read a directory and enqueue tasks for its subdirectories.
+ * Called in a worker thread.
+ *
+ * @param dirPath path of directory
+ * @param generation generation of scan
+ */
+void DirectoryScanner::scanDirectory(const QString& dirPath, int generation)
+{
+  bool aborted;
+  {
+    QMutexLocker locker(&m_mutex);
+    aborted = m_aborted;
+  }
+  QList<Entry> entries;
+  QPair<quint64, quint64> id(0, 0);
+  if (!aborted && readDirectory(dirPath, entries, &id)) {
+    QList<QRegExp> includeRegExps = createFolderRegExps(m_includeFolders);
+    QList<QRegExp> excludeRegExps = createFolderRegExps(m_excludeFolders);
+    QStringList names;
+    QStringList subdirPaths;
+    foreach (const Entry& entry, entries) {
+      if (entry.isDir) {
+        const QString path = joinPath(dirPath, entry.name);
+        if (matchesAny(excludeRegExps, path))
+          continue;
+        if (includeRegExps.isEmpty() || matchesAny(includeRegExps, path)) {
+          subdirPaths.append(path);
+        }
+      } else if (!m_extensions.isEmpty()) {
+        bool matches = false;
+        for (QStringList::const_iterator it = m_extensions.constBegin();
+             it != m_extensions.constEnd();
+             ++it) {
+          if (entry.name.endsWith(*it, Qt::CaseInsensitive)) {
+            matches = true;
+            break;
+          }
+        }
+        if (!matches)
+          continue;
+      }
+      names.append(entry.name);
+    }
+    // Sorted like the nodes in FileProxyModelIterator.
+    names.sort();
+    QStringList childPaths;
+    childPaths.reserve(names.size());
+    foreach (const QString& name, names) {
+      childPaths.append(joinPath(dirPath, name));
+    }
+
+    bool visited = false;
+    {
+      QMutexLocker locker(&m_mutex);
+      if (id.first != 0 || id.second != 0) {
+        visited = m_visited.contains(id);
+        m_visited.insert(id);
+      }
+      if (!visited) {
+        m_children.insert(dirPath, childPaths);
+        ++m_numDirectories;
+      }
+    }
+    if (!visited) {
+      foreach (const QString& subdirPath, subdirPaths) {
+        enqueue(subdirPath, generation);
+      }
+    }
+  }
+  taskDone(generation);
+}
+
+/**
+ * Read the entries of a directory.
+ * @param dirPath path of directory
+ * @param entries the entries are appended here
+ * @param id if not 0, the device and inode numbers are returned here
+ * @return true if directory could be read.
+ */
+bool DirectoryScanner::readDirectory(const QString& dirPath,
+                                     QList<Entry>& entries,
+                                     QPair<quint64, quint64>* id) const
+{
+#ifdef Q_OS_UNIX
+  int fd = ::open(QFile::encodeName(dirPath).constData(),
+                  O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (id && ::fstat(fd, &st) == 0) {
+    id->first = st.st_dev;
+    id->second = st.st_ino;
+  }
+  DIR* dir = ::fdopendir(fd);
+  if (!dir) {
+    ::close(fd);
+    return false;
+  }
+  while (struct dirent* de = ::readdir(dir)) {
+    const char* name = de->d_name;
+    if (name[0] == '.' &&
+        (!m_showHidden || name[1] == '\0' ||
+         (name[1] == '.' && name[2] == '\0')))
+      continue;
+
+    bool isDir = false, isFile = false;
+#ifdef DT_UNKNOWN
+    if (de->d_type == DT_DIR) {
+      isDir = true;
+    } else if (de->d_type == DT_REG) {
+      isFile = true;
+    } else if (de->d_type == DT_LNK || de->d_type == DT_UNKNOWN)
+#endif
+    {
+      // Only symbolic links and file systems without type information
+      // need a stat() call, the link target decides about the type.
+      if (::fstatat(fd, name, &st, 0) == 0) {
+        isDir = S_ISDIR(st.st_mode);
+        isFile = S_ISREG(st.st_mode);
+      }
+    }
+    // Broken links and special files are not listed by the file system
+    // model either.
+    if (isDir || isFile) {
+      entries.append(Entry(QFile::decodeName(name), isDir));
+    }
+  }
+  ::closedir(dir);
+  return true;
+#else
+  Q_UNUSED(id)
+  QDir dir(dirPath);
+  if (!dir.exists())
+    return false;
+
+  QDir::Filters filters = QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot;
+  if (m_showHidden) {
+    filters |= QDir::Hidden;
+  }
+  foreach (const QFileInfo& fi, dir.entryInfoList(filters)) {
+    entries.append(Entry(fi.fileName(), fi.isDir()));
+  }
+  return true;
+#endif
+}
+
+/**
+ * Build the result list from the scanned directories.
+ */
+void DirectoryScanner::assemblePaths()
+{
+  m_paths.clear();
+  if (!m_aborted) {
+    QStack<QString> stack;
+    foreach (const QString& rootPath, m_rootPaths) {
+      stack.push(rootPath);
+      while (!stack.isEmpty()) {
+        QString path = stack.pop();
+        QHash<QString, QStringList>::const_iterator it =
+            m_children.constFind(path);
+        m_paths.append(path);
+        if (it != m_children.constEnd()) {
+          const QStringList& childPaths = *it;
+          for (int i = childPaths.size() - 1; i >= 0; --i) {
+            stack.push(childPaths.at(i));
+          }
+        }
+      }
+    }
+  }
+  m_children.clear();
+  m_visited.clear();
+}
@@ -0,0 +1,236 @@
+/**
+ * \file directoryscanner.h
+ * Recursive parallel directory scanner.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIRECTORYSCANNER_H
+#define DIRECTORYSCANNER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+#include <QMutex>
+#include "kid3api.h"
+
+class QThreadPool;
+
+/**
+ * Recursive directory scanner which does not depend on a file system model.
+ *
+ * The directories are read in parallel by the tasks of a thread pool, one
+ * task per directory. On Unix, the entries are enumerated with readdir()
+ * and their type is taken from the directory entry, so that no stat()
+ * is needed for most entries. The name and folder filters are applied
+ * during the walk, excluded directories are not entered.
+ *
+ * When all directories are read, the paths are available in the same
+ * order as FileProxyModelIterator would deliver them: depth first, each
+ * directory followed by its entries sorted by name.
+ */
+class KID3_CORE_EXPORT DirectoryScanner : public QObject {
+  Q_OBJECT
+public:
+  /**
+   * Constructor.
+   * @param parent parent object
+   */
+  explicit DirectoryScanner(QObject* parent = 0);
+
+  /**
+   * Destructor.
+   */
+  virtual ~DirectoryScanner();
+
+  /**
+   * Set extensions of files to list.
+   * @param extensions lower case extensions including the dot,
+   * e.g. ".mp3", all files are listed if empty
+   */
+  void setExtensions(const QStringList& extensions) {
+    m_extensions = extensions;
+  }
+
+  /**
+   * Set filters for folders.
+   * Subdirectories which do not match the exclude filters are listed,
+   * they are entered if they also match the include filters.
+   *
+   * @param includeFolders wildcard patterns of folders to include,
+   * all folders are included if empty
+   * @param excludeFolders wildcard patterns of folders to exclude
+   */
+  void setFolderFilters(const QStringList& includeFolders,
+                        const QStringList& excludeFolders);
+
+  /**
+   * Set if hidden files and directories are listed.
+   * @param showHidden true to list entries starting with a dot
+   */
+  void setShowHiddenFiles(bool showHidden) { m_showHidden = showHidden; }
+
+  /**
+   * Set maximum number of worker threads.
+   * @param maxThreadCount number of threads
+   */
+  void setMaxThreadCount(int maxThreadCount);
+
+  /**
+   * Start scanning directories in the background.
+   * A scan which is still running is aborted. finished() is emitted when
+   * all directories have been read.
+   *
+   * @param rootPaths paths of directories to scan, a path of a file is
+   * only listed itself
+   */
+  void start(const QStringList& rootPaths);
+
+  /**
+   * Wait until the current scan has finished.
+   * The results are available when this method returns, finished() is
+   * not emitted for the scan.
+   */
+  void waitForFinished();
+
+  /**
+   * Scan directories synchronously.
+   * @param rootPaths paths of directories to scan
+   * @return paths of root directories and their entries.
+   */
+  QStringList scan(const QStringList& rootPaths);
+
+  /**
+   * Abort the current scan.
+   * finished() is still emitted, without results.
+   */
+  void abort();
+
+  /**
+   * Check if a scan is running.
+   * @return true if directories are still read.
+   */
+  bool isRunning() const { return m_running; }
+
+  /**
+   * Get result of scan.
+   * @return paths of root directories and their entries, empty if aborted.
+   */
+  QStringList paths() const { return m_paths; }
+
+  /**
+   * Get number of directories read by the last scan.
+   * @return number of directories.
+   */
+  int numberOfDirectories() const { return m_numDirectories; }
+
+signals:
+  /**
+   * Emitted when a scan started with start() has finished.
+   */
+  void finished();
+
+private slots:
+  /**
+   * Called in the thread of the scanner when all tasks are done.
+   * @param generation generation of scan
+   */
+  void onTasksDone(int generation);
+
+private:
+  class ScanTask;
+  friend class ScanTask;
+
+  /** Entry in a directory. */
+  struct Entry {
+    /**
+     * Constructor.
+     * @param n name
+     * @param d true if entry is a directory
+     */
+    Entry(const QString& n = QString(), bool d = false) : name(n), isDir(d) {}
+    QString name; /**< file name */
+    bool isDir;   /**< true if directory */
+  };
+
+  /**
+   * Read a directory and enqueue tasks for its subdirectories.
+   * Called in a worker thread.
+   *
+   * @param dirPath path of directory
+   * @param generation generation of scan
+   */
+  void scanDirectory(const QString& dirPath, int generation);
+
+  /**
+   * Read the entries of a directory.
+   * @param dirPath path of directory
+   * @param entries the entries are appended here
+   * @param id if not 0, the device and inode numbers are returned here
+   * @return true if directory could be read.
+   */
+  bool readDirectory(const QString& dirPath, QList<Entry>& entries,
+                     QPair<quint64, quint64>* id) const;
+
+  /**
+   * Enqueue a task for a directory.
+   * @param dirPath path of directory
+   * @param generation generation of scan
+   */
+  void enqueue(const QString& dirPath, int generation);
+
+  /**
+   * Mark a task as done.
+   * @param generation generation of scan
+   */
+  void taskDone(int generation);
+
+  /**
+   * Build the result list from the scanned directories.
+   */
+  void assemblePaths();
+
+  QThreadPool* m_threadPool;
+  QStringList m_extensions;
+  QStringList m_includeFolders;
+  QStringList m_excludeFolders;
+  QStringList m_rootPaths;
+  QStringList m_paths;
+  /** Guards the members written by the tasks. */
+  QMutex m_mutex;
+  /** Sorted paths of entries for each directory read */
+  QHash<QString, QStringList> m_children;
+  /** Device and inode numbers of directories read, to avoid loops */
+  QSet<QPair<quint64, quint64> > m_visited;
+  int m_numPending;
+  int m_generation;
+  int m_numDirectories;
+  bool m_aborted;
+  bool m_showHidden;
+  bool m_running;
+
+  Q_DISABLE_COPY(DirectoryScanner)
+};
+
+#endif // DIRECTORYSCANNER_H
@@ -0,0 +1,340 @@
+/**
+ * \file directorywatcher.cpp
+ * Watcher for changes of the files in directories.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "directorywatcher.h"
+#include <QTimer>
+#include <QFile>
+#include <QVarLengthArray>
+#ifdef Q_OS_LINUX
+#include <QSocketNotifier>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <errno.h>
+#else
+#include <QFileSystemWatcher>
+#endif
+
+namespace {
+
+/** Default time without changes after which changes are reported. */
+const int DefaultCoalescingInterval = 300;
+/** Default time after which changes are reported during a storm. */
+const int DefaultMaximumDelay = 2000;
+
+#ifdef Q_OS_LINUX
+/** Events watched for each directory. */
+const quint32 WatchMask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+    IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+    IN_ONLYDIR;
+#endif
+
+}
+
+/**
+ * Constructor.
+ * @param parent parent object
+ */
+DirectoryWatcher::DirectoryWatcher(QObject* parent) : QObject(parent),
+#ifdef Q_OS_LINUX
+  m_inotifyFd(-1), m_notifier(0),
+#else
+  m_watcher(0),
+#endif
+  m_timer(new QTimer(this)), m_maximumDelay(DefaultMaximumDelay),
+  m_limitReached(false)
+{
+  setObjectName(QLatin1String("DirectoryWatcher"));
+  m_timer->setSingleShot(true);
+  m_timer->setInterval(DefaultCoalescingInterval);
+  connect(m_timer, SIGNAL(timeout()), this, SLOT(emitChanges()));
+}
+
+/**
+ * Destructor.
+ */
+DirectoryWatcher::~DirectoryWatcher()
+{
+#ifdef Q_OS_LINUX
+  if (m_inotifyFd >= 0) {
+    ::close(m_inotifyFd);
+  }
+#endif
+}
+
+/**
+ * Start watching a directory.
+ * Subdirectories are not watched, they have to be added separately.
+ *
+ * @param dirPath path of directory
+ * @return true if the directory is watched.
+ */
+bool DirectoryWatcher::addDirectory(const QString& dirPath)
+{
+  if (contains(dirPath))
+    return true;
+  if (m_limitReached || dirPath.isEmpty())
+    return false;
+
+#ifdef Q_OS_LINUX
+  if (m_inotifyFd < 0) {
+    m_inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0) {
+      qWarning("inotify_init1 failed, changes are not watched");
+      m_limitReached = true;
+      return false;
+    }
+    m_notifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read,
+                                     this);
+    connect(m_notifier, SIGNAL(activated(int)), this, SLOT(readEvents()));
+  }
+  int wd = ::inotify_add_watch(m_inotifyFd,
+                               QFile::encodeName(dirPath).constData(),
+                               WatchMask);
+  if (wd < 0) {
+    if (errno == ENOSPC) {
+      // Do not try again for every directory, the other directories are
+      // still refreshed when they are opened again.
+      qWarning("Limit of inotify watches reached, see "
+               "/proc/sys/fs/inotify/max_user_watches");
+      m_limitReached = true;
+    }
+    return false;
+  }
+  // Another path to the same directory gets the same watch descriptor.
+  QString oldPath = m_pathOfWatch.value(wd);
+  if (!oldPath.isNull()) {
+    m_watchOfPath.remove(oldPath);
+  }
+  m_pathOfWatch.insert(wd, dirPath);
+  m_watchOfPath.insert(dirPath, wd);
+  return true;
+#else
+  if (!m_watcher) {
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, SIGNAL(directoryChanged(QString)),
+            this, SLOT(onDirectoryChanged(QString)));
+  }
+  m_watcher->addPath(dirPath);
+  return contains(dirPath);
+#endif
+}
+
+/**
+ * Stop watching a directory.
+ * @param dirPath path of directory
+ */
+void DirectoryWatcher::removeDirectory(const QString& dirPath)
+{
+#ifdef Q_OS_LINUX
+  QHash<QString, int>::iterator it = m_watchOfPath.find(dirPath);
+  if (it != m_watchOfPath.end()) {
+    ::inotify_rm_watch(m_inotifyFd, *it);
+    m_pathOfWatch.remove(*it);
+    m_watchOfPath.erase(it);
+  }
+#else
+  if (m_watcher) {
+    m_watcher->removePath(dirPath);
+  }
+#endif
+}
+
+/**
+ * Check if a directory is watched.
+ * @param dirPath path of directory
+ * @return true if watched.
+ */
+bool DirectoryWatcher::contains(const QString& dirPath) const
+{
+#ifdef Q_OS_LINUX
+  return m_watchOfPath.contains(dirPath);
+#else
+  return m_watcher && m_watcher->directories().contains(dirPath);
+#endif
+}
+
+/**
+ * Get number of watched directories.
+ * @return number of directories.
+ */
+int DirectoryWatcher::count() const
+{
+#ifdef Q_OS_LINUX
+  return m_watchOfPath.size();
+#else
+  return m_watcher ? m_watcher->directories().size() : 0;
+#endif
+}
+
+/**
+ * Stop watching all directories and discard pending changes.
+ */
+void DirectoryWatcher::clear()
+{
+#ifdef Q_OS_LINUX
+  // Closing the descriptor removes all watches at once.
+  delete m_notifier;
+  m_notifier = 0;
+  if (m_inotifyFd >= 0) {
+    ::close(m_inotifyFd);
+    m_inotifyFd = -1;
+  }
+  m_pathOfWatch.clear();
+  m_watchOfPath.clear();
+#else
+  delete m_watcher;
+  m_watcher = 0;
+#endif
+  m_timer->stop();
+  m_changedFiles.clear();
+  m_changedDirs.clear();
+  m_limitReached = false;
+}
+
+/**
+ * Set time without changes after which changes are reported.
+ * @param msec time in milliseconds
+ */
+void DirectoryWatcher::setCoalescingInterval(int msec)
+{
+  m_timer->setInterval(msec);
+}
+
+/**
+ * Get time without changes after which changes are reported.
+ * @return time in milliseconds.
+ */
+int DirectoryWatcher::coalescingInterval() const
+{
+  return m_timer->interval();
+}
+
+/**
+ * Read available events from the inotify descriptor.
+ */
+void DirectoryWatcher::readEvents()
+{
+#ifdef Q_OS_LINUX
+  int available = 0;
+  if (::ioctl(m_inotifyFd, FIONREAD, &available) != 0 || available <= 0) {
+    available = 4096;
+  }
+  QVarLengthArray<char, 4096> buf(available);
+  ssize_t len = ::read(m_inotifyFd, buf.data(), available);
+  if (len <= 0)
+    return;
+
+  const char* ptr = buf.constData();
+  const char* end = ptr + len;
+  while (ptr + static_cast<int>(sizeof(inotify_event)) <= end) {
+    const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+    ptr += sizeof(inotify_event) + event->len;
+    if (event->mask & IN_Q_OVERFLOW) {
+      // Events were lost, everything may have changed.
+      foreach (const QString& dirPath, m_watchOfPath.keys()) {
+        m_changedDirs.insert(dirPath);
+      }
+      continue;
+    }
+    QString dirPath = m_pathOfWatch.value(event->wd);
+    if (dirPath.isNull())
+      continue;
+
+    if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+      // The entry of the directory is reported by its parent directory.
+      if (event->mask & IN_MOVE_SELF) {
+        // The path is no longer valid, IN_IGNORED will follow.
+        ::inotify_rm_watch(m_inotifyFd, event->wd);
+      } else if (event->mask & IN_IGNORED) {
+        m_pathOfWatch.remove(event->wd);
+        m_watchOfPath.remove(dirPath);
+      }
+      continue;
+    }
+    if (event->len > 0) {
+      QString name = QFile::decodeName(event->name);
+      m_changedFiles.insert(dirPath.endsWith(QLatin1Char('/'))
+                            ? dirPath + name
+                            : dirPath + QLatin1Char('/') + name);
+    }
+  }
+  scheduleChanges();
+#endif
+}
+
+/**
+ * Called when a directory watched by QFileSystemWatcher has changed.
+ * @param dirPath path of directory
+ */
+void DirectoryWatcher::onDirectoryChanged(const QString& dirPath)
+{
+  m_changedDirs.insert(dirPath);
+  scheduleChanges();
+}
+
+/**
+ * Schedule emission of the changes.
+ */
+void DirectoryWatcher::scheduleChanges()
+{
+  if (m_changedFiles.isEmpty() && m_changedDirs.isEmpty())
+    return;
+
+  if (!m_timer->isActive()) {
+    m_pendingSince.start();
+    m_timer->start();
+  } else if (m_pendingSince.elapsed() < m_maximumDelay) {
+    // Restart to wait until the storm is over.
+    m_timer->start();
+  }
+}
+
+/**
+ * Emit the coalesced changes.
+ */
+void DirectoryWatcher::emitChanges()
+{
+  QStringList dirPaths = m_changedDirs.toList();
+  QStringList paths;
+  foreach (const QString& path, m_changedFiles) {
+    // Entries are already covered by a changed directory.
+    int slashPos = path.lastIndexOf(QLatin1Char('/'));
+    if (!m_changedDirs.contains(path.left(slashPos > 0 ? slashPos : 1))) {
+      paths.append(path);
+    }
+  }
+  m_changedFiles.clear();
+  m_changedDirs.clear();
+  if (!dirPaths.isEmpty()) {
+    dirPaths.sort();
+    emit directoriesChanged(dirPaths);
+  }
+  if (!paths.isEmpty()) {
+    paths.sort();
+    emit filesChanged(paths);
+  }
+}
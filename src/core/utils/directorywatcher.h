@@ -0,0 +1,182 @@
+/**
+ * \file directorywatcher.h
+ * Watcher for changes of the files in directories.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIRECTORYWATCHER_H
+#define DIRECTORYWATCHER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
+#include "kid3api.h"
+
+class QTimer;
+class QSocketNotifier;
+class QFileSystemWatcher;
+
+/**
+ * Watcher for changes of the files in directories.
+ *
+ * On Linux, inotify is used with a single watch per directory, which
+ * reports the names of created, written, moved and deleted files. Other
+ * platforms use QFileSystemWatcher, which only reports that something in a
+ * directory has changed.
+ *
+ * Changes are coalesced: they are reported when no further change has
+ * happened for coalescingInterval() milliseconds, but at least every
+ * maximumDelay() milliseconds, so that the storm of events caused by a
+ * tool processing many files results in few notifications.
+ */
+class KID3_CORE_EXPORT DirectoryWatcher : public QObject {
+  Q_OBJECT
+public:
+  /**
+   * Constructor.
+   * @param parent parent object
+   */
+  explicit DirectoryWatcher(QObject* parent = 0);
+
+  /**
+   * Destructor.
+   */
+  virtual ~DirectoryWatcher();
+
+  /**
+   * Start watching a directory.
+   * Subdirectories are not watched, they have to be added separately.
+   *
+   * @param dirPath path of directory
+   * @return true if the directory is watched.
+   */
+  bool addDirectory(const QString& dirPath);
+
+  /**
+   * Stop watching a directory.
+   * @param dirPath path of directory
+   */
+  void removeDirectory(const QString& dirPath);
+
+  /**
+   * Check if a directory is watched.
+   * @param dirPath path of directory
+   * @return true if watched.
+   */
+  bool contains(const QString& dirPath) const;
+
+  /**
+   * Get number of watched directories.
+   * @return number of directories.
+   */
+  int count() const;
+
+  /**
+   * Stop watching all directories and discard pending changes.
+   */
+  void clear();
+
+  /**
+   * Set time without changes after which changes are reported.
+   * @param msec time in milliseconds
+   */
+  void setCoalescingInterval(int msec);
+
+  /**
+   * Get time without changes after which changes are reported.
+   * @return time in milliseconds.
+   */
+  int coalescingInterval() const;
+
+  /**
+   * Set time after which changes are reported during continuous changes.
+   * @param msec time in milliseconds
+   */
+  void setMaximumDelay(int msec) { m_maximumDelay = msec; }
+
+  /**
+   * Get time after which changes are reported during continuous changes.
+   * @return time in milliseconds.
+   */
+  int maximumDelay() const { return m_maximumDelay; }
+
+signals:
+  /**
+   * Emitted when files or subdirectories in watched directories have been
+   * created, written, moved or deleted.
+   * @param paths paths of changed entries, sorted
+   */
+  void filesChanged(const QStringList& paths);
+
+  /**
+   * Emitted when the contents of directories have changed, but the
+   * changed entries are not known. This happens when the kernel event
+   * queue overflows and on platforms without inotify.
+   * @param dirPaths paths of changed directories, sorted
+   */
+  void directoriesChanged(const QStringList& dirPaths);
+
+private slots:
+  /**
+   * Read available events from the inotify descriptor.
+   */
+  void readEvents();
+
+  /**
+   * Called when a directory watched by QFileSystemWatcher has changed.
+   * @param dirPath path of directory
+   */
+  void onDirectoryChanged(const QString& dirPath);
+
+  /**
+   * Emit the coalesced changes.
+   */
+  void emitChanges();
+
+private:
+  /**
+   * Schedule emission of the changes.
+   */
+  void scheduleChanges();
+
+#ifdef Q_OS_LINUX
+  int m_inotifyFd;
+  QSocketNotifier* m_notifier;
+  QHash<int, QString> m_pathOfWatch;
+  QHash<QString, int> m_watchOfPath;
+#else
+  QFileSystemWatcher* m_watcher;
+#endif
+  QTimer* m_timer;
+  QElapsedTimer m_pendingSince;
+  QSet<QString> m_changedFiles;
+  QSet<QString> m_changedDirs;
+  int m_maximumDelay;
+  bool m_limitReached;
+
+  Q_DISABLE_COPY(DirectoryWatcher)
+};
+
+#endif // DIRECTORYWATCHER_H
@@ -0,0 +1,231 @@
+/**
+ * \file filehandlepool.cpp
+ * Limits the number of file handles held open by tagged files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "filehandlepool.h"
+#include <QCoreApplication>
+#include <QThread>
+#include "operationprofiler.h"
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+/** Lower bound for the number of open file handles. */
+const int MinCapacity = 16;
+/** Upper bound for the number of open file handles. */
+const int MaxCapacity = 1024;
+/** Capacity used if the file descriptor limit is unknown. */
+const int FallbackCapacity = 64;
+
+/**
+ * Check if the calling thread is the main application thread.
+ * @return true if in application thread.
+ */
+bool isInApplicationThread()
+{
+  QCoreApplication* app = QCoreApplication::instance();
+  return !app || QThread::currentThread() == app->thread();
+}
+
+}
+
+/**
+ * Destructor, removes the client from the pool.
+ */
+FileHandlePool::Client::~Client()
+{
+  if (m_registered) {
+    // Clients are only registered by touch() in the application thread,
+    // unlinking them in another thread would corrupt the list.
+    Q_ASSERT(isInApplicationThread());
+    if (isInApplicationThread()) {
+      FileHandlePool::instance().unlink(this);
+    }
+  }
+}
+
+/**
+ * Constructor.
+ */
+FileHandlePool::FileHandlePool()
+  : m_head(0), m_tail(0), m_size(0), m_capacity(defaultCapacity()),
+    m_hits(0), m_misses(0), m_evictions(0)
+{
+}
+
+/**
+ * Get the pool.
+ * @return file handle pool of the application.
+ */
+FileHandlePool& FileHandlePool::instance()
+{
+  static FileHandlePool pool;
+  return pool;
+}
+
+/**
+ * Get number of file handles which are kept open if not configured.
+ * The number is derived from the maximum number of file descriptors
+ * (RLIMIT_NOFILE) available for the process.
+ * @return default capacity.
+ */
+int FileHandlePool::defaultCapacity()
+{
+#ifdef Q_OS_UNIX
+  struct rlimit rl;
+  if (::getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+    if (rl.rlim_cur == RLIM_INFINITY) {
+      return MaxCapacity;
+    }
+    // Leave three quarters of the descriptors for the application, e.g.
+    // sockets, pipes of external processes and directory scans.
+    return qBound(MinCapacity, static_cast<int>(rl.rlim_cur / 4),
+                  MaxCapacity);
+  }
+#endif
+  return FallbackCapacity;
+}
+
+/**
+ * Set maximum number of open file handles.
+ * @param capacity maximum number of handles, 0 for defaultCapacity()
+ */
+void FileHandlePool::setCapacity(int capacity)
+{
+  m_capacity = capacity > 0 ? capacity : defaultCapacity();
+  if (isInApplicationThread()) {
+    evict();
+  }
+}
+
+/**
+ * Mark the file handle of a client as used.
+ * If the client is not yet registered, it is added as the most recently
+ * used client and counted as a miss, least recently used clients are
+ * evicted if the capacity is exceeded. Otherwise it is moved to the front
+ * and counted as a hit.
+ *
+ * @param client client which has opened or used its file handle
+ */
+void FileHandlePool::touch(Client* client)
+{
+  if (!isInApplicationThread())
+    return;
+
+  if (client->m_registered) {
+    ++m_hits;
+    if (client != m_head) {
+      unlink(client);
+      link(client);
+    }
+  } else {
+    ++m_misses;
+    OperationProfiler::count(OperationProfiler::FileHandleOpens);
+    link(client);
+    evict();
+  }
+}
+
+/**
+ * Remove a client whose file handle has been closed.
+ * @param client client which is no longer open
+ */
+void FileHandlePool::remove(Client* client)
+{
+  if (!isInApplicationThread() || !client->m_registered)
+    return;
+
+  unlink(client);
+}
+
+/**
+ * Reset hit, miss and eviction counters.
+ */
+void FileHandlePool::resetCounters()
+{
+  m_hits = m_misses = m_evictions = 0;
+}
+
+/**
+ * Insert a client at the front of the list.
+ * @param client client which is not in the list
+ */
+void FileHandlePool::link(Client* client)
+{
+  client->m_prev = 0;
+  client->m_next = m_head;
+  if (m_head) {
+    m_head->m_prev = client;
+  } else {
+    m_tail = client;
+  }
+  m_head = client;
+  client->m_registered = true;
+  ++m_size;
+}
+
+/**
+ * Remove a client from the list.
+ * @param client client which is in the list
+ */
+void FileHandlePool::unlink(Client* client)
+{
+  if (client->m_prev) {
+    client->m_prev->m_next = client->m_next;
+  } else {
+    m_head = client->m_next;
+  }
+  if (client->m_next) {
+    client->m_next->m_prev = client->m_prev;
+  } else {
+    m_tail = client->m_prev;
+  }
+  client->m_prev = client->m_next = 0;
+  client->m_registered = false;
+  --m_size;
+}
+
+/**
+ * Evict least recently used clients until the capacity is not exceeded.
+ */
+void FileHandlePool::evict()
+{
+  // Clients which cannot be closed are moved to the front, so each
+  // client is asked at most once. The most recently used client is kept.
+  int attempts = m_size - 1;
+  while (m_size > m_capacity && attempts-- > 0) {
+    Client* client = m_tail;
+    // Unlink before releasing, the client will call remove() when its
+    // handle is closed.
+    unlink(client);
+    if (client->releaseFileHandle()) {
+      ++m_evictions;
+    } else {
+      link(client);
+    }
+  }
+}
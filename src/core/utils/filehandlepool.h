@@ -0,0 +1,191 @@
+/**
+ * \file filehandlepool.h
+ * Limits the number of file handles held open by tagged files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILEHANDLEPOOL_H
+#define FILEHANDLEPOOL_H
+
+#include <QtGlobal>
+#include "kid3api.h"
+
+/**
+ * Least recently used cache of open file handles.
+ *
+ * Tagged files which keep their file open between operations register
+ * themselves as a Client when they use their file handle. If more than
+ * capacity() clients are registered, the least recently used clients are
+ * asked to close their file handles, they will be opened again when needed.
+ * The clients are kept in an intrusive doubly linked list, so that using,
+ * evicting and removing a client are all constant time operations.
+ *
+ * The pool is only maintained in the application thread, calls from other
+ * threads are ignored. Files used in worker threads have to close their
+ * handles themselves.
+ */
+class KID3_CORE_EXPORT FileHandlePool {
+public:
+  /**
+   * Object holding a file handle managed by the pool.
+   */
+  class KID3_CORE_EXPORT Client {
+  public:
+    /**
+     * Constructor.
+     */
+    Client() : m_prev(0), m_next(0), m_registered(false) {}
+
+    /**
+     * Destructor, removes the client from the pool.
+     * A registered client must be deleted in the application thread.
+     */
+    virtual ~Client();
+
+  protected:
+    /**
+     * Close the file handle because the pool is full.
+     * The handle has to be opened again when it is used the next time.
+     *
+     * @return true if the handle was closed, false if it cannot be closed
+     *         at the moment.
+     */
+    virtual bool releaseFileHandle() = 0;
+
+  private:
+    friend class FileHandlePool;
+
+    Client* m_prev;
+    Client* m_next;
+    bool m_registered;
+
+    Q_DISABLE_COPY(Client)
+  };
+
+  /**
+   * Get the pool.
+   * @return file handle pool of the application.
+   */
+  static FileHandlePool& instance();
+
+  /**
+   * Get number of file handles which are kept open if not configured.
+   * The number is derived from the maximum number of file descriptors
+   * (RLIMIT_NOFILE) available for the process.
+   * @return default capacity.
+   */
+  static int defaultCapacity();
+
+  /**
+   * Set maximum number of open file handles.
+   * @param capacity maximum number of handles, 0 for defaultCapacity()
+   */
+  void setCapacity(int capacity);
+
+  /**
+   * Get maximum number of open file handles.
+   * @return capacity.
+   */
+  int capacity() const { return m_capacity; }
+
+  /**
+   * Get number of registered clients.
+   * @return number of open file handles.
+   */
+  int size() const { return m_size; }
+
+  /**
+   * Mark the file handle of a client as used.
+   * If the client is not yet registered, it is added as the most recently
+   * used client and counted as a miss, least recently used clients are
+   * evicted if the capacity is exceeded. Otherwise it is moved to the front
+   * and counted as a hit.
+   *
+   * @param client client which has opened or used its file handle
+   */
+  void touch(Client* client);
+
+  /**
+   * Remove a client whose file handle has been closed.
+   * @param client client which is no longer open
+   */
+  void remove(Client* client);
+
+  /**
+   * Get number of uses of already open file handles.
+   * @return number of hits.
+   */
+  quint64 hitCount() const { return m_hits; }
+
+  /**
+   * Get number of file handles which had to be opened.
+   * @return number of misses.
+   */
+  quint64 missCount() const { return m_misses; }
+
+  /**
+   * Get number of file handles closed because the pool was full.
+   * @return number of evictions.
+   */
+  quint64 evictionCount() const { return m_evictions; }
+
+  /**
+   * Reset hit, miss and eviction counters.
+   */
+  void resetCounters();
+
+private:
+  /**
+   * Constructor.
+   */
+  FileHandlePool();
+
+  /**
+   * Insert a client at the front of the list.
+   * @param client client which is not in the list
+   */
+  void link(Client* client);
+
+  /**
+   * Remove a client from the list.
+   * @param client client which is in the list
+   */
+  void unlink(Client* client);
+
+  /**
+   * Evict least recently used clients until the capacity is not exceeded.
+   */
+  void evict();
+
+  Client* m_head; /**< most recently used client */
+  Client* m_tail; /**< least recently used client */
+  int m_size;
+  int m_capacity;
+  quint64 m_hits;
+  quint64 m_misses;
+  quint64 m_evictions;
+
+  Q_DISABLE_COPY(FileHandlePool)
+};
+
+#endif // FILEHANDLEPOOL_H
@@ -0,0 +1,130 @@
+/**
+ * \file filerewriter.cpp
+ * Write a changed copy of a file and replace the original with it.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "filerewriter.h"
+
+namespace {
+
+/** Size of buffer used to copy regions of the original file. */
+const int CopyBufferSize = 1024 * 1024;
+
+}
+
+/**
+ * Constructor.
+ * @param filePath path of file to rewrite
+ */
+FileRewriter::FileRewriter(const QString& filePath)
+  : m_original(filePath), m_temp(filePath + QLatin1String("_KID3")),
+    m_tempCreated(false), m_ok(false)
+{
+}
+
+/**
+ * Destructor.
+ * The temporary file is removed if commit() has not succeeded, unless
+ * the original file has already been removed.
+ */
+FileRewriter::~FileRewriter()
+{
+  m_temp.close();
+  // If the original file has been removed but could not be replaced, its
+  // data is only left in the temporary file.
+  if (m_tempCreated && !m_ok && m_original.exists()) {
+    m_temp.remove();
+  }
+}
+
+/**
+ * Open the original file and create the temporary file.
+ * @return true if ok.
+ */
+bool FileRewriter::open()
+{
+  m_ok = false;
+  if (!m_original.open(QIODevice::ReadOnly))
+    return false;
+
+  m_tempCreated = m_temp.open(QIODevice::WriteOnly | QIODevice::Truncate);
+  return m_tempCreated;
+}
+
+/**
+ * Append data to the copy.
+ * @param data data to write
+ * @return true if ok.
+ */
+bool FileRewriter::write(const QByteArray& data)
+{
+  return m_temp.write(data) == data.size();
+}
+
+/**
+ * Append a region of the original file to the copy.
+ * @param start start position in original file
+ * @param end end position in original file
+ * @return true if ok.
+ */
+bool FileRewriter::copy(qint64 start, qint64 end)
+{
+  if (start > end || end > m_original.size() || !m_original.seek(start))
+    return false;
+
+  qint64 pos = start;
+  while (pos < end) {
+    const QByteArray buf =
+        m_original.read(qMin<qint64>(CopyBufferSize, end - pos));
+    if (buf.isEmpty() || !write(buf))
+      return false;
+    pos += buf.size();
+  }
+  return true;
+}
+
+/**
+ * Replace the original file by the copy.
+ * The permissions of the original file are kept.
+ * @return true if ok, false if the original file has not been replaced.
+ */
+bool FileRewriter::commit()
+{
+  if (!m_temp.isOpen() || !m_temp.flush())
+    return false;
+
+  m_temp.close();
+  if (m_temp.error() != QFile::NoError)
+    return false;
+
+  const QFile::Permissions permissions = m_original.permissions();
+  m_original.close();
+  m_temp.setPermissions(permissions);
+  // QFile::rename() does not overwrite existing files.
+  if (!m_original.remove())
+    return false;
+
+  m_ok = m_temp.rename(m_original.fileName());
+  return m_ok;
+}
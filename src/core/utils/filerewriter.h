@@ -0,0 +1,107 @@
+/**
+ * \file filerewriter.h
+ * Write a changed copy of a file and replace the original with it.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILEREWRITER_H
+#define FILEREWRITER_H
+
+#include <QFile>
+#include <QString>
+#include "kid3api.h"
+
+/**
+ * Writes a changed copy of a file and replaces the original file with it.
+ *
+ * The copy is composed of new data and regions of the original file. It is
+ * written to a temporary file in the same directory, which only replaces
+ * the original file when all data has been written. So if a tag grows and
+ * the audio data has to be moved, an I/O error leaves the original file
+ * intact instead of a partially moved file.
+ *
+ * @code
+ * FileRewriter rewriter(path);
+ * bool ok = rewriter.open() && rewriter.write(newTag) &&
+ *     rewriter.copy(oldTagSize, fileSize) && rewriter.commit();
+ * @endcode
+ */
+class KID3_CORE_EXPORT FileRewriter {
+public:
+  /**
+   * Constructor.
+   * @param filePath path of file to rewrite
+   */
+  explicit FileRewriter(const QString& filePath);
+
+  /**
+   * Destructor.
+   * The temporary file is removed if commit() has not succeeded, unless
+   * the original file has already been removed.
+   */
+  ~FileRewriter();
+
+  /**
+   * Open the original file and create the temporary file.
+   * @return true if ok.
+   */
+  bool open();
+
+  /**
+   * Append data to the copy.
+   * @param data data to write
+   * @return true if ok.
+   */
+  bool write(const QByteArray& data);
+
+  /**
+   * Append a region of the original file to the copy.
+   * @param start start position in original file
+   * @param end end position in original file
+   * @return true if ok.
+   */
+  bool copy(qint64 start, qint64 end);
+
+  /**
+   * Replace the original file by the copy.
+   * The permissions of the original file are kept.
+   * @return true if ok, false if the original file has not been replaced.
+   */
+  bool commit();
+
+  /**
+   * Get path of temporary file.
+   * @return path in the directory of the original file.
+   */
+  QString tempFilePath() const { return m_temp.fileName(); }
+
+private:
+  Q_DISABLE_COPY(FileRewriter)
+
+  QFile m_original;
+  QFile m_temp;
+  bool m_tempCreated;
+  bool m_ok;
+};
+
+#endif // FILEREWRITER_H
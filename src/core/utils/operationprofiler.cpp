@@ -0,0 +1,458 @@
+/**
+ * \file operationprofiler.cpp
+ * Profiler for durations of operations and counters.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "operationprofiler.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QStringList>
+#include <QThread>
+
+namespace {
+
+/**
+ * Maximum number of recorded trace events, later events are only
+ * added to the histograms.
+ */
+const int MaxEvents = 1000000;
+
+/**
+ * Quote a string for JSON output.
+ * @param str string
+ * @return quoted and escaped string.
+ */
+QString jsonString(const QString& str)
+{
+  QString result(QLatin1Char('"'));
+  foreach (QChar ch, str) {
+    if (ch == QLatin1Char('"') || ch == QLatin1Char('\\')) {
+      result += QLatin1Char('\\');
+      result += ch;
+    } else if (ch.unicode() < 0x20) {
+      result += QString(QLatin1String("\\u%1"))
+          .arg(ch.unicode(), 4, 16, QLatin1Char('0'));
+    } else {
+      result += ch;
+    }
+  }
+  result += QLatin1Char('"');
+  return result;
+}
+
+/**
+ * Format a duration in milliseconds.
+ * @param nsecs duration in nanoseconds
+ * @return milliseconds with three decimals.
+ */
+QString msString(qint64 nsecs)
+{
+  return QString::number(nsecs / 1e6, 'f', 3);
+}
+
+/**
+ * Format a time in microseconds as used in Chrome traces.
+ * @param nsecs time in nanoseconds
+ * @return microseconds with three decimals.
+ */
+QString usString(qint64 nsecs)
+{
+  return QString::number(nsecs / 1e3, 'f', 3);
+}
+
+}
+
+QAtomicInt OperationProfiler::s_enabled(0);
+
+/**
+ * Constructor.
+ */
+OperationProfiler::Histogram::Histogram()
+  : count(0), total(0), minimum(0), maximum(0)
+{
+  for (int i = 0; i < NumBuckets; ++i) {
+    buckets[i] = 0;
+  }
+}
+
+/**
+ * Add a duration.
+ * @param nsecs duration in nanoseconds
+ */
+void OperationProfiler::Histogram::add(qint64 nsecs)
+{
+  if (count == 0 || nsecs < minimum) {
+    minimum = nsecs;
+  }
+  if (nsecs > maximum) {
+    maximum = nsecs;
+  }
+  ++count;
+  total += nsecs;
+  int bucket = 0;
+  for (qint64 usecs = nsecs / 1000; usecs > 0 && bucket < NumBuckets - 1;
+       usecs >>= 1) {
+    ++bucket;
+  }
+  ++buckets[bucket];
+}
+
+/**
+ * Estimate a percentile from the buckets.
+ * @param percent percentage, e.g. 50 for the median
+ * @return upper bound of the bucket containing the percentile in
+ *         nanoseconds, at most the maximum.
+ */
+qint64 OperationProfiler::Histogram::percentile(int percent) const
+{
+  const qint64 rank = (count * percent + 99) / 100;
+  qint64 cumulated = 0;
+  for (int i = 0; i < NumBuckets; ++i) {
+    cumulated += buckets[i];
+    if (cumulated >= rank && cumulated > 0) {
+      return qMin(Q_INT64_C(1000) << i, maximum);
+    }
+  }
+  return maximum;
+}
+
+/**
+ * Constructor.
+ */
+OperationProfiler::OperationProfiler() : m_droppedEvents(0)
+{
+  for (int i = 0; i < NumCounters; ++i) {
+    m_counters[i] = 0;
+  }
+}
+
+/**
+ * Get the profiler.
+ * @return profiler of the application.
+ */
+OperationProfiler& OperationProfiler::instance()
+{
+  static OperationProfiler profiler;
+  return profiler;
+}
+
+/**
+ * Get name of counter.
+ * @param counter counter
+ * @return name, e.g. "filesRead".
+ */
+const char* OperationProfiler::counterName(Counter counter)
+{
+  static const char* const names[] = {
+    "filesRead",
+    "filesWritten",
+    "fileBytesRead",
+    "fileBytesWritten",
+    "fileHandleOpens",
+    "httpRequests",
+    "httpBytesReceived",
+    "fileRewrites"
+  };
+  Q_ASSERT(sizeof(names) / sizeof(names[0]) == NumCounters);
+  return counter >= 0 && counter < NumCounters ? names[counter] : "";
+}
+
+/**
+ * Enable or disable profiler.
+ * The collected data is kept when disabled.
+ * @param enable true to enable
+ */
+void OperationProfiler::setEnabled(bool enable)
+{
+  QMutexLocker locker(&m_mutex);
+  if (enable && !m_clock.isValid()) {
+    m_clock.start();
+  }
+  s_enabled.fetchAndStoreRelease(enable ? 1 : 0);
+}
+
+/**
+ * Get time since profiler was started.
+ * @return time in nanoseconds.
+ */
+qint64 OperationProfiler::timestamp() const
+{
+  return m_clock.isValid() ? m_clock.nsecsElapsed() : 0;
+}
+
+/**
+ * Add duration of an operation.
+ * @param operation name of operation, must be a string literal
+ * @param category category, e.g. metadata plugin or host
+ * @param startTime start of operation from timestamp()
+ */
+void OperationProfiler::addDuration(const char* operation,
+                                    const QString& category,
+                                    qint64 startTime)
+{
+  const qint64 duration = qMax(timestamp() - startTime, Q_INT64_C(0));
+  const Qt::HANDLE threadId = QThread::currentThreadId();
+  QMutexLocker locker(&m_mutex);
+  m_histograms[qMakePair(QByteArray(operation), category)].add(duration);
+  if (m_events.size() < MaxEvents) {
+    QHash<Qt::HANDLE, int>::const_iterator it = m_threadNrs.constFind(threadId);
+    if (it == m_threadNrs.constEnd()) {
+      it = m_threadNrs.insert(threadId, m_threadNrs.size() + 1);
+    }
+    TraceEvent event;
+    event.operation = operation;
+    event.category = category;
+    event.startTime = startTime;
+    event.duration = duration;
+    event.threadNr = *it;
+    m_events.append(event);
+  } else {
+    ++m_droppedEvents;
+  }
+}
+
+/**
+ * Increment a counter.
+ * @param counter counter
+ * @param value value to add
+ */
+void OperationProfiler::addCount(Counter counter, qint64 value)
+{
+  QMutexLocker locker(&m_mutex);
+  m_counters[counter] += value;
+}
+
+/**
+ * Start measuring an asynchronous operation.
+ * @param operation name of operation, must be a string literal
+ */
+void OperationProfiler::beginOperation(const char* operation)
+{
+  const qint64 startTime = timestamp();
+  QMutexLocker locker(&m_mutex);
+  m_startTimes.insert(QByteArray(operation), startTime);
+}
+
+/**
+ * Finish measuring an asynchronous operation.
+ * Nothing is measured if the operation was not started.
+ * @param operation name of operation
+ */
+void OperationProfiler::endOperation(const char* operation)
+{
+  qint64 startTime;
+  {
+    QMutexLocker locker(&m_mutex);
+    QHash<QByteArray, qint64>::iterator it =
+        m_startTimes.find(QByteArray(operation));
+    if (it == m_startTimes.end())
+      return;
+
+    startTime = *it;
+    m_startTimes.erase(it);
+  }
+  addDuration(operation, QString(), startTime);
+}
+
+/**
+ * Get value of counter.
+ * @param counter counter
+ * @return counter value.
+ */
+qint64 OperationProfiler::counterValue(Counter counter) const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_counters[counter];
+}
+
+/**
+ * Clear all counters, histograms and events.
+ */
+void OperationProfiler::reset()
+{
+  QMutexLocker locker(&m_mutex);
+  for (int i = 0; i < NumCounters; ++i) {
+    m_counters[i] = 0;
+  }
+  m_histograms.clear();
+  m_startTimes.clear();
+  m_events.clear();
+  m_threadNrs.clear();
+  m_droppedEvents = 0;
+  if (m_clock.isValid()) {
+    m_clock.restart();
+  }
+}
+
+/**
+ * Get a report with counters and statistics of the operations.
+ * @return text with a line per counter and operation.
+ */
+QString OperationProfiler::toText() const
+{
+  QMutexLocker locker(&m_mutex);
+  QStringList lines;
+  for (int i = 0; i < NumCounters; ++i) {
+    lines.append(QString(QLatin1String("%1 %2"))
+                 .arg(QLatin1String(counterName(static_cast<Counter>(i))),
+                      -18)
+                 .arg(m_counters[i]));
+  }
+  if (!m_histograms.isEmpty()) {
+    const QLatin1String lineFmt("%1 %2 %3 %4 %5 %6 %7 %8 %9");
+    lines.append(QString(lineFmt)
+                 .arg(QLatin1String("Operation"), -22)
+                 .arg(QLatin1String("Category"), -16)
+                 .arg(QLatin1String("Count"), 7)
+                 .arg(QLatin1String("Total ms"), 11)
+                 .arg(QLatin1String("Mean ms"), 10)
+                 .arg(QLatin1String("Min ms"), 10)
+                 .arg(QLatin1String("Max ms"), 10)
+                 .arg(QLatin1String("P50 ms"), 10)
+                 .arg(QLatin1String("P95 ms"), 10));
+    for (QMap<HistogramKey, Histogram>::const_iterator it =
+           m_histograms.constBegin();
+         it != m_histograms.constEnd();
+         ++it) {
+      const Histogram& hist = it.value();
+      lines.append(QString(lineFmt)
+                   .arg(QString::fromLatin1(it.key().first), -22)
+                   .arg(it.key().second, -16)
+                   .arg(hist.count, 7)
+                   .arg(msString(hist.total), 11)
+                   .arg(msString(hist.total / hist.count), 10)
+                   .arg(msString(hist.minimum), 10)
+                   .arg(msString(hist.maximum), 10)
+                   .arg(msString(hist.percentile(50)), 10)
+                   .arg(msString(hist.percentile(95)), 10));
+    }
+  }
+  return lines.join(QLatin1String("\n"));
+}
+
+/**
+ * Get counters and statistics of the operations.
+ * @return map with "enabled", "counters" and "operations", the
+ *         operations are a list of maps with "operation", "category",
+ *         "count", "totalMs", "meanMs", "minMs", "maxMs", "p50Ms",
+ *         "p95Ms" and "histogram".
+ */
+QVariantMap OperationProfiler::toVariantMap() const
+{
+  QMutexLocker locker(&m_mutex);
+  QVariantMap counters;
+  for (int i = 0; i < NumCounters; ++i) {
+    counters.insert(QLatin1String(counterName(static_cast<Counter>(i))),
+                    m_counters[i]);
+  }
+  QVariantList operations;
+  for (QMap<HistogramKey, Histogram>::const_iterator it =
+         m_histograms.constBegin();
+       it != m_histograms.constEnd();
+       ++it) {
+    const Histogram& hist = it.value();
+    QVariantList buckets;
+    for (int i = 0; i < NumBuckets; ++i) {
+      buckets.append(hist.buckets[i]);
+    }
+    QVariantMap operation;
+    operation.insert(QLatin1String("operation"),
+                     QString::fromLatin1(it.key().first));
+    operation.insert(QLatin1String("category"), it.key().second);
+    operation.insert(QLatin1String("count"), hist.count);
+    operation.insert(QLatin1String("totalMs"), hist.total / 1e6);
+    operation.insert(QLatin1String("meanMs"), hist.total / 1e6 / hist.count);
+    operation.insert(QLatin1String("minMs"), hist.minimum / 1e6);
+    operation.insert(QLatin1String("maxMs"), hist.maximum / 1e6);
+    operation.insert(QLatin1String("p50Ms"), hist.percentile(50) / 1e6);
+    operation.insert(QLatin1String("p95Ms"), hist.percentile(95) / 1e6);
+    operation.insert(QLatin1String("histogram"), buckets);
+    operations.append(operation);
+  }
+  QVariantMap map;
+  map.insert(QLatin1String("enabled"), isEnabled());
+  map.insert(QLatin1String("counters"), counters);
+  map.insert(QLatin1String("operations"), operations);
+  return map;
+}
+
+/**
+ * Write recorded events in Chrome trace event format.
+ * @param path path to JSON file
+ * @return true if ok.
+ */
+bool OperationProfiler::writeChromeTrace(const QString& path) const
+{
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+
+  QMutexLocker locker(&m_mutex);
+  const QString pid = QString::number(QCoreApplication::applicationPid());
+  QString str(QLatin1String("{\"traceEvents\":[\n"));
+  qint64 endTime = 0;
+  foreach (const TraceEvent& event, m_events) {
+    str += QLatin1String("{\"name\":");
+    str += jsonString(QString::fromLatin1(event.operation));
+    str += QLatin1String(",\"cat\":");
+    str += jsonString(event.category.isEmpty()
+                      ? QString(QLatin1String("kid3")) : event.category);
+    str += QLatin1String(",\"ph\":\"X\",\"ts\":");
+    str += usString(event.startTime);
+    str += QLatin1String(",\"dur\":");
+    str += usString(event.duration);
+    str += QLatin1String(",\"pid\":");
+    str += pid;
+    str += QLatin1String(",\"tid\":");
+    str += QString::number(event.threadNr);
+    str += QLatin1String("},\n");
+    endTime = qMax(endTime, event.startTime + event.duration);
+    if (str.size() > 65536) {
+      file.write(str.toUtf8());
+      str.clear();
+    }
+  }
+  // The counters are added as a single counter event at the end.
+  str += QLatin1String("{\"name\":\"counters\",\"ph\":\"C\",\"ts\":");
+  str += usString(endTime);
+  str += QLatin1String(",\"pid\":");
+  str += pid;
+  str += QLatin1String(",\"tid\":0,\"args\":{");
+  for (int i = 0; i < NumCounters; ++i) {
+    if (i > 0) {
+      str += QLatin1Char(',');
+    }
+    str += QLatin1Char('"');
+    str += QLatin1String(counterName(static_cast<Counter>(i)));
+    str += QLatin1String("\":");
+    str += QString::number(m_counters[i]);
+  }
+  str += QLatin1String("}}\n],\"displayTimeUnit\":\"ms\",\"otherData\":{");
+  str += QLatin1String("\"droppedEvents\":");
+  str += QString::number(m_droppedEvents);
+  str += QLatin1String("}}\n");
+  bool ok = file.write(str.toUtf8()) != -1;
+  file.close();
+  return ok && file.error() == QFile::NoError;
+}
@@ -0,0 +1,287 @@
+/**
+ * \file operationprofiler.h
+ * Profiler for durations of operations and counters.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPERATIONPROFILER_H
+#define OPERATIONPROFILER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVariantMap>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include "kid3api.h"
+
+/**
+ * Profiler for durations of operations and counters.
+ *
+ * Durations are collected in histograms per operation and category, e.g.
+ * "readTags" with the key of the metadata plugin. Every measurement is
+ * also recorded as an event, so that a trace can be written in the Chrome
+ * trace event format, which can be viewed in chrome://tracing or Perfetto.
+ *
+ * The profiler is disabled by default. When disabled, the static methods
+ * only check a flag, so that instrumented code is not slowed down.
+ * Measurements can be added from any thread.
+ */
+class KID3_CORE_EXPORT OperationProfiler {
+public:
+  /** Counters. */
+  enum Counter {
+    FilesRead,         /**< files whose tags were read */
+    FilesWritten,      /**< files whose tags were written */
+    FileBytesRead,     /**< size of files whose tags were read */
+    FileBytesWritten,  /**< size of files whose tags were written */
+    FileHandleOpens,   /**< file handles opened by tagged files */
+    HttpRequests,      /**< HTTP requests sent to servers */
+    HttpBytesReceived, /**< bytes received in HTTP responses */
+    FileRewrites,      /**< files completely rewritten to store tags */
+    NumCounters        /**< number of counters */
+  };
+
+  /**
+   * Scoped timer, measures the time until it is destroyed.
+   *
+   * @code
+   * OperationProfiler::Scope scope("saveDirectory");
+   * @endcode
+   */
+  class Scope {
+  public:
+    /**
+     * Constructor, starts measurement if profiler is enabled.
+     * @param operation name of operation, must be a string literal
+     */
+    explicit Scope(const char* operation) : m_operation(0), m_startTime(0) {
+      if (isEnabled()) {
+        m_operation = operation;
+        m_startTime = instance().timestamp();
+      }
+    }
+
+    /**
+     * Destructor, adds the duration to the profiler.
+     */
+    ~Scope() {
+      if (m_operation) {
+        instance().addDuration(m_operation, m_category, m_startTime);
+      }
+    }
+
+    /**
+     * Check if the scope is measured.
+     * Can be used to avoid calculating a category which is not used.
+     * @return true if profiler was enabled when scope was created.
+     */
+    bool isActive() const { return m_operation != 0; }
+
+    /**
+     * Set category, e.g. key of metadata plugin.
+     * @param category category
+     */
+    void setCategory(const QString& category) { m_category = category; }
+
+  private:
+    Q_DISABLE_COPY(Scope)
+
+    const char* m_operation;
+    QString m_category;
+    qint64 m_startTime;
+  };
+
+  /**
+   * Get the profiler.
+   * @return profiler of the application.
+   */
+  static OperationProfiler& instance();
+
+  /**
+   * Check if profiler is enabled.
+   * Can be called from any thread, the flag is set with release semantics
+   * in setEnabled().
+   * @return true if enabled.
+   */
+  static bool isEnabled() {
+#if QT_VERSION >= 0x050000
+    return s_enabled.loadAcquire() != 0;
+#else
+    return s_enabled.fetchAndAddAcquire(0) != 0;
+#endif
+  }
+
+  /**
+   * Increment a counter if the profiler is enabled.
+   * @param counter counter
+   * @param value value to add
+   */
+  static void count(Counter counter, qint64 value = 1) {
+    if (isEnabled()) {
+      instance().addCount(counter, value);
+    }
+  }
+
+  /**
+   * Start measuring an asynchronous operation if the profiler is enabled.
+   * @param operation name of operation, must be a string literal
+   * @see end()
+   */
+  static void begin(const char* operation) {
+    if (isEnabled()) {
+      instance().beginOperation(operation);
+    }
+  }
+
+  /**
+   * Finish measuring an asynchronous operation started with begin().
+   * @param operation name of operation
+   */
+  static void end(const char* operation) {
+    if (isEnabled()) {
+      instance().endOperation(operation);
+    }
+  }
+
+  /**
+   * Get name of counter.
+   * @param counter counter
+   * @return name, e.g. "filesRead".
+   */
+  static const char* counterName(Counter counter);
+
+  /**
+   * Enable or disable profiler.
+   * The collected data is kept when disabled.
+   * @param enable true to enable
+   */
+  void setEnabled(bool enable);
+
+  /**
+   * Get time since profiler was started.
+   * @return time in nanoseconds.
+   */
+  qint64 timestamp() const;
+
+  /**
+   * Add duration of an operation.
+   * @param operation name of operation, must be a string literal
+   * @param category category, e.g. metadata plugin or host
+   * @param startTime start of operation from timestamp()
+   */
+  void addDuration(const char* operation, const QString& category,
+                   qint64 startTime);
+
+  /**
+   * Get value of counter.
+   * @param counter counter
+   * @return counter value.
+   */
+  qint64 counterValue(Counter counter) const;
+
+  /**
+   * Clear all counters, histograms and events.
+   */
+  void reset();
+
+  /**
+   * Get a report with counters and statistics of the operations.
+   * @return text with a line per counter and operation.
+   */
+  QString toText() const;
+
+  /**
+   * Get counters and statistics of the operations.
+   * @return map with "enabled", "counters" and "operations", the
+   *         operations are a list of maps with "operation", "category",
+   *         "count", "totalMs", "meanMs", "minMs", "maxMs", "p50Ms",
+   *         "p95Ms" and "histogram".
+   */
+  QVariantMap toVariantMap() const;
+
+  /**
+   * Write recorded events in Chrome trace event format.
+   * @param path path to JSON file
+   * @return true if ok.
+   */
+  bool writeChromeTrace(const QString& path) const;
+
+private:
+  /**
+   * Number of histogram buckets, bucket 0 counts durations below 1 us,
+   * bucket i durations from 2^(i-1) us to below 2^i us.
+   */
+  static const int NumBuckets = 25;
+
+  /** Statistics of an operation. */
+  struct Histogram {
+    Histogram();
+    void add(qint64 nsecs);
+    qint64 percentile(int percent) const;
+
+    qint64 count;
+    qint64 total;
+    qint64 minimum;
+    qint64 maximum;
+    qint64 buckets[NumBuckets];
+  };
+
+  /** Recorded measurement. */
+  struct TraceEvent {
+    const char* operation;
+    QString category;
+    qint64 startTime;
+    qint64 duration;
+    int threadNr;
+  };
+
+  /** Operation name and category. */
+  typedef QPair<QByteArray, QString> HistogramKey;
+
+  OperationProfiler();
+
+  void addCount(Counter counter, qint64 value);
+  void beginOperation(const char* operation);
+  void endOperation(const char* operation);
+
+  /** Not 0 if enabled, read without locking m_mutex */
+  static QAtomicInt s_enabled;
+
+  mutable QMutex m_mutex;
+  QElapsedTimer m_clock;
+  qint64 m_counters[NumCounters];
+  QMap<HistogramKey, Histogram> m_histograms;
+  QHash<QByteArray, qint64> m_startTimes;
+  QVector<TraceEvent> m_events;
+  QHash<Qt::HANDLE, int> m_threadNrs;
+  int m_droppedEvents;
+
+  Q_DISABLE_COPY(OperationProfiler)
+};
+
+#endif // OPERATIONPROFILER_H
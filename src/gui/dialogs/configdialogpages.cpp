@@ -128,7 +128,8 @@ ConfigDialogPages::ConfigDialogPages(IPlatformTools* platformTools,
                                      QObject* parent) : QObject(parent),
   m_platformTools(platformTools),
   m_loadLastOpenedFileCheckBox(0), m_preserveTimeCheckBox(0),
-  m_markChangesCheckBox(0), m_coverFileNameLineEdit(0),
+  m_markChangesCheckBox(0), m_tagPaddingSizeSpinBox(0),
+  m_growTagPaddingOnceCheckBox(0), m_coverFileNameLineEdit(0),
   m_nameFilterComboBox(0), m_includeFoldersLineEdit(0),
   m_excludeFoldersLineEdit(0), m_showHiddenFilesCheckBox(0),
   m_fileTextEncodingComboBox(0),
@@ -355,6 +356,12 @@ QWidget* ConfigDialogPages::createFilesPage()
   QGroupBox* saveGroupBox = new QGroupBox(tr("Save"), filesPage);
   m_preserveTimeCheckBox = new QCheckBox(tr("&Preserve file timestamp"), saveGroupBox);
   m_markChangesCheckBox = new QCheckBox(tr("&Mark changes"), saveGroupBox);
+  m_tagPaddingSizeSpinBox = new QSpinBox(saveGroupBox);
+  m_tagPaddingSizeSpinBox->setRange(0, 1048576);
+  m_tagPaddingSizeSpinBox->setSingleStep(1024);
+  m_tagPaddingSizeSpinBox->setSpecialValueText(tr("Default"));
+  m_growTagPaddingOnceCheckBox =
+      new QCheckBox(tr("&Grow padding when tag is moved"), saveGroupBox);
   m_coverFileNameLineEdit = new QLineEdit(saveGroupBox);
   m_fileTextEncodingComboBox = new QComboBox(saveGroupBox);
   m_fileTextEncodingComboBox->addItems(FileConfig::getTextCodecNames());
@@ -364,6 +371,8 @@ QWidget* ConfigDialogPages::createFilesPage()
   formLayout->setFieldGrowthPolicy(QFormLayout::AllNonFixedFieldsGrow);
   formLayout->addRow(m_preserveTimeCheckBox);
   formLayout->addRow(m_markChangesCheckBox);
+  formLayout->addRow(tr("Tag pa&dding (bytes):"), m_tagPaddingSizeSpinBox);
+  formLayout->addRow(m_growTagPaddingOnceCheckBox);
   formLayout->addRow(tr("F&ilename for cover:"), m_coverFileNameLineEdit);
   formLayout->addRow(tr("Text &encoding (Export, Playlist):"),
                      m_fileTextEncodingComboBox);
@@ -588,6 +597,8 @@ void ConfigDialogPages::setConfigs(
   m_loadLastOpenedFileCheckBox->setChecked(fileCfg.loadLastOpenedFile());
   m_preserveTimeCheckBox->setChecked(fileCfg.preserveTime());
   m_markChangesCheckBox->setChecked(fileCfg.markChanges());
+  m_tagPaddingSizeSpinBox->setValue(tagCfg.tagPaddingSize());
+  m_growTagPaddingOnceCheckBox->setChecked(tagCfg.growTagPaddingOnce());
   m_coverFileNameLineEdit->setText(fileCfg.defaultCoverFileName());
   m_nameFilterComboBox->setCurrentIndex(
         m_nameFilterComboBox->findData(fileCfg.nameFilter()));
@@ -722,6 +733,8 @@ void ConfigDialogPages::getConfig() const
   fileCfg.setLoadLastOpenedFile(m_loadLastOpenedFileCheckBox->isChecked());
   fileCfg.setPreserveTime(m_preserveTimeCheckBox->isChecked());
   fileCfg.setMarkChanges(m_markChangesCheckBox->isChecked());
+  tagCfg.setTagPaddingSize(m_tagPaddingSizeSpinBox->value());
+  tagCfg.setGrowTagPaddingOnce(m_growTagPaddingOnceCheckBox->isChecked());
   fileCfg.setDefaultCoverFileName(m_coverFileNameLineEdit->text());
 #if QT_VERSION >= 0x050200
   fileCfg.setNameFilter(m_nameFilterComboBox->currentData().toString());
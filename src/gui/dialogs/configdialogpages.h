@@ -133,6 +133,10 @@ private:
   QCheckBox* m_preserveTimeCheckBox;
   /** Mark changes checkbox */
   QCheckBox* m_markChangesCheckBox;
+  /** Tag padding spinbox */
+  QSpinBox* m_tagPaddingSizeSpinBox;
+  /** Grow tag padding once checkbox */
+  QCheckBox* m_growTagPaddingOnceCheckBox;
   /** Filename for cover lineedit */
   QLineEdit* m_coverFileNameLineEdit;
   /** File list name filter combo box */
@@ -362,6 +362,11 @@ void BaseMainWindowImpl::saveDirectory(bool updateGui)
   if (updateGui) {
     QApplication::restoreOverrideCursor();
     updateGuiControls();
+    if (int numRewritten = m_app->numberOfRewrittenFiles()) {
+      // Rewriting large files is slow, point to the padding setting.
+      slotStatusMsg(tr("%1 file(s) rewritten because the tags did not fit "
+                       "into the padding").arg(numRewritten));
+    }
   }
 }
 
@@ -908,8 +913,12 @@ void BaseMainWindowImpl::filterProgress(int type, const QString& fileName,
     stopProgressMonitoring();
     break;
   default:
-    checkProgressMonitoring(0, 0, QString::number(passed) +
-                            QLatin1Char('/') + QString::number(total));
+    // Files are filtered faster than the progress can be displayed, so
+    // only every 64th file is reported.
+    if ((total & 63) == 0) {
+      checkProgressMonitoring(0, 0, QString::number(passed) +
+                              QLatin1Char('/') + QString::number(total));
+    }
   }
 }
 
@@ -1353,6 +1362,7 @@ void BaseMainWindowImpl::expandFileList()
   startProgressMonitoring(tr("Expand All"),
                           &BaseMainWindowImpl::terminateExpandFileList,
                           !expandOnlySubtree);
+  m_app->getFileProxyModelIterator()->setPrefetchTags(false);
   m_app->getFileProxyModelIterator()->start(expandOnlySubtree
         ? m_form->getFileList()->currentIndex()
         : m_form->getFileList()->rootIndex());
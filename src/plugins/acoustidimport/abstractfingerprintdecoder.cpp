@@ -47,17 +47,19 @@ AbstractFingerprintDecoder::~AbstractFingerprintDecoder()
  */
 void AbstractFingerprintDecoder::start(const QString&)
 {
-  m_stopped = false;
+  m_stopped.fetchAndStoreOrdered(0);
 }
 
 /**
  * Stop decoder.
  * Can be used to stop the decoder when an error is found after
- * getting bufferReady() data.
+ * getting bufferReady() data. The implementation of this base class
+ * only sets a flag, which is checked by synchronous decoders, it can
+ * therefore be called from another thread while start() is running.
  */
 void AbstractFingerprintDecoder::stop()
 {
-  m_stopped = true;
+  m_stopped.fetchAndStoreOrdered(1);
 }
 
 /**
@@ -66,5 +68,16 @@ void AbstractFingerprintDecoder::stop()
  */
 bool AbstractFingerprintDecoder::isStopped() const
 {
-  return m_stopped;
+  return m_stopped.fetchAndAddOrdered(0) != 0;
+}
+
+/**
+ * Check if start() blocks until the whole file is decoded.
+ * Such decoders are run in worker threads to decode multiple files
+ * concurrently.
+ * @return true if decoding is synchronous, default is false.
+ */
+bool AbstractFingerprintDecoder::isSynchronous() const
+{
+  return false;
 }
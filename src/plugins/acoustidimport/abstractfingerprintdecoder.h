@@ -28,6 +28,7 @@
 #define ABSTRACTFINGERPRINTDECODER_H
 
 #include <QObject>
+#include <QAtomicInt>
 
 /**
  * Abstract base class for Chromaprint fingerprint decoder.
@@ -55,7 +56,9 @@ public:
   /**
    * Stop decoder.
    * Can be used to stop the decoder when an error is found after
-   * getting bufferReady() data.
+   * getting bufferReady() data. The implementation of this base class
+   * only sets a flag, which is checked by synchronous decoders, it can
+   * therefore be called from another thread while start() is running.
    */
   virtual void stop();
 
@@ -65,6 +68,14 @@ public:
    */
   virtual bool isStopped() const;
 
+  /**
+   * Check if start() blocks until the whole file is decoded.
+   * Such decoders are run in worker threads to decode multiple files
+   * concurrently.
+   * @return true if decoding is synchronous, default is false.
+   */
+  virtual bool isSynchronous() const;
+
   /**
    * Create concrete fingerprint decoder.
    * @param parent parent object
@@ -101,7 +112,7 @@ signals:
   void finished(int duration);
 
 private:
-  bool m_stopped;
+  mutable QAtomicInt m_stopped;
 };
 
 #endif // ABSTRACTFINGERPRINTDECODER_H
@@ -62,6 +62,8 @@ int av_audio_convert(AVAudioConvert *ctx,
 #endif
 }
 #include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
 #include "fingerprintcalculator.h"
 
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(52, 94, 1)
@@ -80,6 +82,13 @@ namespace {
 
 const int BUFFER_SIZE = MAX_AUDIO_FRAME_SIZE * 2;
 
+/**
+ * Mutex to serialize opening and closing of codecs, which is not thread
+ * safe in older libavcodec versions. Decoding itself can run concurrently
+ * in multiple threads.
+ */
+QMutex codecMutex;
+
 /*
  * The following classes are used to benefit from the C++
  * "Resource Acquisition Is Initialization" (RAII) idiom when dealing with
@@ -123,8 +132,10 @@ public:
 #else
       ::av_frame_free(&m_frame);
 #endif
-    if (m_opened)
+    if (m_opened) {
+      QMutexLocker locker(&codecMutex);
       ::avcodec_close(m_ptr);
+    }
 #if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(57, 33, 100)
     if (m_ptr)
       ::avcodec_free_context(&m_ptr);
@@ -134,6 +145,7 @@ public:
   bool open() {
     m_opened = false;
     if (m_ptr && m_impl) {
+      QMutexLocker locker(&codecMutex);
       m_opened =
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(53, 5, 0)
         ::avcodec_open(m_ptr, m_impl) >= 0
@@ -624,6 +636,15 @@ void FFmpegFingerprintDecoder::start(const QString& filePath)
   emit finished(duration);
 }
 
+/**
+ * Check if start() blocks until the whole file is decoded.
+ * @return true.
+ */
+bool FFmpegFingerprintDecoder::isSynchronous() const
+{
+  return true;
+}
+
 
 /**
  * Create concrete fingerprint decoder.
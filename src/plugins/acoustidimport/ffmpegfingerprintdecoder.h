@@ -51,6 +51,12 @@ public:
    */
   virtual void start(const QString& filePath);
 
+  /**
+   * Check if start() blocks until the whole file is decoded.
+   * @return true.
+   */
+  virtual bool isSynchronous() const;
+
 private:
   qint16* m_buffer1;
   qint16* m_buffer2;
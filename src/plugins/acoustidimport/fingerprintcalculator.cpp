@@ -26,15 +26,28 @@
 
 #define __STDC_CONSTANT_MACROS
 #include "fingerprintcalculator.h"
+#include <QMutex>
+#include <QMutexLocker>
 #include "config.h"
 #include "abstractfingerprintdecoder.h"
 
+namespace {
+
+/**
+ * Mutex to serialize creation and destruction of Chromaprint contexts.
+ * Chromaprint may use FFTW, whose planner is not thread safe.
+ */
+QMutex chromaprintMutex;
+
+}
+
 /**
  * Constructor.
  */
 FingerprintCalculator::FingerprintCalculator(QObject* parent) : QObject(parent),
   m_chromaprintCtx(0),
-  m_decoder(AbstractFingerprintDecoder::createFingerprintDecoder(this))
+  m_decoder(AbstractFingerprintDecoder::createFingerprintDecoder(this)),
+  m_token(0), m_finished(false)
 {
   connect(m_decoder, SIGNAL(started(int,int)),
           this, SLOT(startChromaprint(int,int)));
@@ -52,6 +65,7 @@ FingerprintCalculator::FingerprintCalculator(QObject* parent) : QObject(parent),
 FingerprintCalculator::~FingerprintCalculator()
 {
   if (m_chromaprintCtx) {
+    QMutexLocker locker(&chromaprintMutex);
     ::chromaprint_free(m_chromaprintCtx);
   }
 }
@@ -61,22 +75,39 @@ FingerprintCalculator::~FingerprintCalculator()
  * When the calculation is finished, finished() is emitted.
  *
  * @param fileName path to audio file
+ * @param token token passed with finished() to identify the calculation
  */
-void FingerprintCalculator::start(const QString& fileName) {
+void FingerprintCalculator::start(const QString& fileName, int token) {
   if (!m_chromaprintCtx) {
     // Lazy initialization to save resources if not used
+    QMutexLocker locker(&chromaprintMutex);
     m_chromaprintCtx = ::chromaprint_new(CHROMAPRINT_ALGORITHM_DEFAULT);
   }
+  m_token = token;
+  m_finished = false;
   m_decoder->start(fileName);
 }
 
 /**
  * Stop decoder.
+ * If the decoder is synchronous, this method can be called from another
+ * thread to stop a running start().
  */
 void FingerprintCalculator::stop() {
   m_decoder->stop();
 }
 
+/**
+ * Check if start() blocks until the fingerprint is calculated.
+ * Such calculators can be moved to a worker thread to calculate
+ * multiple fingerprints concurrently.
+ * @return true if the decoder is synchronous.
+ */
+bool FingerprintCalculator::isSynchronous() const
+{
+  return m_decoder->isSynchronous();
+}
+
 /**
  * Called when decoding starts.
  * @param sampleRate sample rate of the audio stream (in Hz)
@@ -97,7 +128,10 @@ void FingerprintCalculator::feedChromaprint(QByteArray data)
                           reinterpret_cast<qint16*>(data.data()),
                           data.size() / 2)) {
     m_decoder->stop();
-    emit finished(QString(), 0, FingerprintCalculationFailed);
+    if (!m_finished) {
+      m_finished = true;
+      emit finished(QString(), 0, FingerprintCalculationFailed, m_token);
+    }
   }
 }
 
@@ -107,7 +141,12 @@ void FingerprintCalculator::feedChromaprint(QByteArray data)
  */
 void FingerprintCalculator::receiveError(int err)
 {
-  emit finished(QString(), 0, err);
+  // Only report the first result, a stopped decoder reports an error
+  // after a failure has already been reported.
+  if (!m_finished) {
+    m_finished = true;
+    emit finished(QString(), 0, err, m_token);
+  }
 }
 
 /**
@@ -126,5 +165,8 @@ void FingerprintCalculator::finishChromaprint(int duration)
   } else {
     err = FingerprintCalculationFailed;
   }
-  emit finished(fingerprint, duration, err);
+  if (!m_finished) {
+    m_finished = true;
+    emit finished(fingerprint, duration, err, m_token);
+  }
 }
@@ -66,14 +66,25 @@ public:
    * When the calculation is finished, finished() is emitted.
    *
    * @param fileName path to audio file
+   * @param token token passed with finished() to identify the calculation
    */
-  void start(const QString& fileName);
+  Q_INVOKABLE void start(const QString& fileName, int token = 0);
 
   /**
    * Stop decoder.
+   * If the decoder is synchronous, this method can be called from another
+   * thread to stop a running start().
    */
   void stop();
 
+  /**
+   * Check if start() blocks until the fingerprint is calculated.
+   * Such calculators can be moved to a worker thread to calculate
+   * multiple fingerprints concurrently.
+   * @return true if the decoder is synchronous.
+   */
+  bool isSynchronous() const;
+
 signals:
   /**
    * Emitted when the fingerprint calculation is finished.
@@ -81,8 +92,10 @@ signals:
    * @param fingerprint Chromaprint fingerprint
    * @param duration duration in seconds
    * @param error error code, enum FingerprintCalculator::Error
+   * @param token token passed to start()
    */
-  void finished(const QString& fingerprint, int duration, int error);
+  void finished(const QString& fingerprint, int duration, int error,
+                int token);
 
 private slots:
   /**
@@ -113,6 +126,8 @@ private slots:
 private:
   ChromaprintContext* m_chromaprintCtx;
   AbstractFingerprintDecoder* m_decoder;
+  int m_token;
+  bool m_finished;
 };
 
 #endif // FINGERPRINTCALCULATOR_H
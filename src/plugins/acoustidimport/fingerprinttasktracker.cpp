@@ -0,0 +1,129 @@
+/**
+ * \file fingerprinttasktracker.cpp
+ * Assignment of tracks to fingerprint calculators.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fingerprinttasktracker.h"
+
+/**
+ * Constructor.
+ * @param numCalculators number of calculators
+ */
+FingerprintTaskTracker::FingerprintTaskTracker(int numCalculators) :
+  m_tasks(numCalculators), m_lastToken(0)
+{
+}
+
+/**
+ * Set the number of calculators.
+ * All calculators are idle afterwards.
+ * @param numCalculators number of calculators
+ */
+void FingerprintTaskTracker::resize(int numCalculators)
+{
+  m_tasks.resize(numCalculators);
+  stopAll();
+}
+
+/**
+ * Get an idle calculator.
+ * @return number of first idle calculator, -1 if all are busy.
+ */
+int FingerprintTaskTracker::idleCalculator() const
+{
+  for (int i = 0; i < m_tasks.size(); ++i) {
+    if (m_tasks.at(i).trackIndex < 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Assign a track to a calculator.
+ * @param calculatorNr number of calculator
+ * @param trackIndex index of track
+ * @return token to be passed with the result of the calculation.
+ */
+int FingerprintTaskTracker::assign(int calculatorNr, int trackIndex)
+{
+  // Zero is never used as a token, so that a default constructed task
+  // does not accept a result.
+  if (++m_lastToken <= 0) {
+    m_lastToken = 1;
+  }
+  Task& task = m_tasks[calculatorNr];
+  task.trackIndex = trackIndex;
+  task.token = m_lastToken;
+  return m_lastToken;
+}
+
+/**
+ * Get track assigned to a calculator.
+ * @param calculatorNr number of calculator
+ * @return index of track, -1 if the calculator is idle.
+ */
+int FingerprintTaskTracker::trackIndex(int calculatorNr) const
+{
+  return calculatorNr >= 0 && calculatorNr < m_tasks.size()
+      ? m_tasks.at(calculatorNr).trackIndex : -1;
+}
+
+/**
+ * Finish the calculation of a calculator.
+ * The calculator becomes idle if @a token belongs to its current
+ * assignment, else the result is stale and the state is not changed.
+ * @param calculatorNr number of calculator
+ * @param token token returned by assign() when the calculation was started
+ * @return index of track, -1 if the result is stale.
+ */
+int FingerprintTaskTracker::finish(int calculatorNr, int token)
+{
+  if (calculatorNr < 0 || calculatorNr >= m_tasks.size())
+    return -1;
+
+  Task& task = m_tasks[calculatorNr];
+  if (task.trackIndex < 0 || task.token != token)
+    return -1;
+
+  int index = task.trackIndex;
+  task.trackIndex = -1;
+  task.token = 0;
+  return index;
+}
+
+/**
+ * Make all calculators idle.
+ * Results of calculations which are still running are ignored by
+ * finish().
+ */
+void FingerprintTaskTracker::stopAll()
+{
+  for (QVector<Task>::iterator it = m_tasks.begin();
+       it != m_tasks.end();
+       ++it) {
+    it->trackIndex = -1;
+    it->token = 0;
+  }
+}
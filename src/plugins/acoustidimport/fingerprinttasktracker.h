@@ -0,0 +1,113 @@
+/**
+ * \file fingerprinttasktracker.h
+ * Assignment of tracks to fingerprint calculators.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FINGERPRINTTASKTRACKER_H
+#define FINGERPRINTTASKTRACKER_H
+
+#include <QVector>
+
+/**
+ * Assignment of tracks to fingerprint calculators.
+ *
+ * Each calculation started on a calculator gets a new token, which is
+ * passed with the result of the calculation. A result is only accepted if
+ * its token is the one of the current assignment of the calculator, so that
+ * a result which arrives after the calculations have been stopped, e.g.
+ * from a calculator running in a worker thread, is not attributed to the
+ * track for which the calculator is used next.
+ */
+class FingerprintTaskTracker {
+public:
+  /**
+   * Constructor.
+   * @param numCalculators number of calculators
+   */
+  explicit FingerprintTaskTracker(int numCalculators = 0);
+
+  /**
+   * Set the number of calculators.
+   * All calculators are idle afterwards.
+   * @param numCalculators number of calculators
+   */
+  void resize(int numCalculators);
+
+  /**
+   * Get the number of calculators.
+   * @return number of calculators.
+   */
+  int size() const { return m_tasks.size(); }
+
+  /**
+   * Get an idle calculator.
+   * @return number of first idle calculator, -1 if all are busy.
+   */
+  int idleCalculator() const;
+
+  /**
+   * Assign a track to a calculator.
+   * @param calculatorNr number of calculator
+   * @param trackIndex index of track
+   * @return token to be passed with the result of the calculation.
+   */
+  int assign(int calculatorNr, int trackIndex);
+
+  /**
+   * Get track assigned to a calculator.
+   * @param calculatorNr number of calculator
+   * @return index of track, -1 if the calculator is idle.
+   */
+  int trackIndex(int calculatorNr) const;
+
+  /**
+   * Finish the calculation of a calculator.
+   * The calculator becomes idle if @a token belongs to its current
+   * assignment, else the result is stale and the state is not changed.
+   * @param calculatorNr number of calculator
+   * @param token token returned by assign() when the calculation was started
+   * @return index of track, -1 if the result is stale.
+   */
+  int finish(int calculatorNr, int token);
+
+  /**
+   * Make all calculators idle.
+   * Results of calculations which are still running are ignored by
+   * finish().
+   */
+  void stopAll();
+
+private:
+  /** Assignment of a calculator. */
+  struct Task {
+    Task() : trackIndex(-1), token(0) {}
+    int trackIndex;
+    int token;
+  };
+
+  QVector<Task> m_tasks;
+  int m_lastToken;
+};
+
+#endif // FINGERPRINTTASKTRACKER_H
@@ -27,47 +27,89 @@
 #include "musicbrainzclient.h"
 #include <QByteArray>
 #include <QDomDocument>
+#include <QThread>
+#include <QUrl>
+#include <QVariant>
 #include "httpclient.h"
+#include "jsonparser.h"
 #include "trackdatamodel.h"
 #include "fingerprintcalculator.h"
 
 namespace {
 
+/** Maximum number of fingerprints looked up in a single request. */
+const int MaxFingerprintsPerLookup = 10;
+
+/**
+ * Get MusicBrainz IDs of the recordings from acoustid.org results.
+ * @param results results for a fingerprint, best match first
+ * @return list of MusicBrainz IDs of the best match having recordings
+ */
+QStringList parseRecordingIds(const QVariantList& results)
+{
+  QStringList ids;
+  foreach (const QVariant& result, results) {
+    const QVariantList recordings =
+        result.toMap().value(QLatin1String("recordings")).toList();
+    if (!recordings.isEmpty()) {
+      foreach (const QVariant& recording, recordings) {
+        QString id = recording.toMap().value(QLatin1String("id")).toString();
+        if (!id.isEmpty()) {
+          ids.append(id);
+        }
+      }
+      break;
+    }
+  }
+  return ids;
+}
+
 /**
  * Parse response from acoustid.org.
  * @param bytes response in JSON format
- * @return list of MusicBrainz IDs
+ * @return lists of MusicBrainz IDs indexed by the index of the fingerprint
+ *         in the request.
  */
-QStringList parseAcoustidIds(const QByteArray& bytes)
+QMap<int, QStringList> parseAcoustidIds(const QByteArray& bytes)
 {
   /*
    * The response from acoustid.org is in JSON format and looks like this:
    * {
    *   "status": "ok",
-   *   "results": [{
-   *     "recordings": [{"id": "14fef9a4-9b50-4e9f-9e22-490fd86d1861"}],
-   *     "score": 0.938621, "id": "29bf7ce3-0182-40da-b840-5420203369c4"
+   *   "fingerprints": [{
+   *     "index": "0",
+   *     "results": [{
+   *       "recordings": [{"id": "14fef9a4-9b50-4e9f-9e22-490fd86d1861"}],
+   *       "score": 0.938621, "id": "29bf7ce3-0182-40da-b840-5420203369c4"
+   *     }]
    *   }]
    * }
+   * For a request with a single fingerprint, "results" is directly
+   * contained in the top level object.
    */
-  QStringList ids;
-  if (bytes.indexOf("\"status\": \"ok\"") >= 0) {
-    int startPos = bytes.indexOf("\"recordings\": [");
-    if (startPos >= 0) {
-      startPos += 15;
-      int endPos = bytes.indexOf(']', startPos);
-      if (endPos > startPos) {
-        QRegExp idRe(QLatin1String("\"id\":\\s*\"([^\"]+)\""));
-        QString recordings(QString::fromLatin1(bytes.mid(startPos, endPos - startPos)));
-        int pos = 0;
-        while ((pos = idRe.indexIn(recordings, pos)) != -1) {
-          ids.append(idRe.cap(1));
-          pos += idRe.matchedLength();
-        }
+  QMap<int, QStringList> idsOfIndex;
+  const QVariantMap response =
+      JsonParser::deserialize(QString::fromUtf8(bytes)).toMap();
+  if (response.value(QLatin1String("status")).toString() !=
+      QLatin1String("ok")) {
+    return idsOfIndex;
+  }
+  if (response.contains(QLatin1String("fingerprints"))) {
+    foreach (const QVariant& var,
+             response.value(QLatin1String("fingerprints")).toList()) {
+      const QVariantMap fingerprint = var.toMap();
+      bool ok;
+      int index = fingerprint.value(QLatin1String("index")).toInt(&ok);
+      if (ok) {
+        idsOfIndex.insert(index, parseRecordingIds(
+                            fingerprint.value(QLatin1String("results")).toList()));
       }
     }
+  } else {
+    idsOfIndex.insert(0, parseRecordingIds(
+                        response.value(QLatin1String("results")).toList()));
   }
-  return ids;
+  return idsOfIndex;
 }
 
 /**
@@ -179,14 +221,14 @@ void parseMusicBrainzMetadata(const QByteArray& bytes,
 MusicBrainzClient::MusicBrainzClient(QNetworkAccessManager* netMgr,
                                      TrackDataModel *trackDataModel) :
   ServerTrackImporter(netMgr, trackDataModel),
-  m_fingerprintCalculator(new FingerprintCalculator(this)),
-  m_state(Idle), m_currentIndex(-1)
+  m_acoustIdClient(new HttpClient(netMgr)),
+  m_nextFingerprintIndex(0), m_metadataIndex(-1)
 {
   m_headers["User-Agent"] = "curl/7.52.1";
   connect(httpClient(), SIGNAL(bytesReceived(QByteArray)),
           this, SLOT(receiveBytes(QByteArray)));
-  connect(m_fingerprintCalculator, SIGNAL(finished(QString,int,int)),
-          this, SLOT(receiveFingerprint(QString,int,int)));
+  connect(m_acoustIdClient, SIGNAL(bytesReceived(QByteArray)),
+          this, SLOT(receiveIds(QByteArray)));
 }
 
 /**
@@ -194,6 +236,15 @@ MusicBrainzClient::MusicBrainzClient(QNetworkAccessManager* netMgr,
  */
 MusicBrainzClient::~MusicBrainzClient()
 {
+  foreach (FingerprintCalculator* calculator, m_calculators) {
+    calculator->stop();
+  }
+  foreach (QThread* thread, m_threads) {
+    thread->quit();
+    thread->wait();
+  }
+  qDeleteAll(m_calculators);
+  delete m_acoustIdClient;
 }
 
 /**
@@ -226,75 +277,82 @@ ServerImporterConfig* MusicBrainzClient::config() const {
 }
 
 /**
- * Verify if m_currentIndex is in range of m_idsOfTrack.
- * @return true if index OK, false if index was invalid and state is reset.
+ * Create the fingerprint calculators if not already existing.
+ * Calculators with a synchronous decoder are moved to worker threads.
  */
-bool MusicBrainzClient::verifyIdIndex()
+void MusicBrainzClient::createCalculators()
 {
-  if (m_currentIndex < 0 || m_currentIndex >= m_idsOfTrack.size()) {
-    qWarning("Invalid index %d for IDs (size %d)",
-             m_currentIndex, m_idsOfTrack.size());
-    stop();
-    return false;
-  }
-  return true;
-}
+  if (!m_calculators.isEmpty())
+    return;
 
-/**
- * Verify if m_currentIndex is in range of m_filenameOfTrack.
- * @return true if index OK, false if index was invalid and state is reset.
- */
-bool MusicBrainzClient::verifyTrackIndex()
-{
-  if (m_currentIndex < 0 || m_currentIndex >= m_filenameOfTrack.size()) {
-    qWarning("Invalid index %d for track (size %d)",
-             m_currentIndex, m_filenameOfTrack.size());
-    stop();
-    return false;
+  const int numCalculators = qMax(QThread::idealThreadCount(), 1);
+  for (int i = 0; i < numCalculators; ++i) {
+    FingerprintCalculator* calculator = new FingerprintCalculator;
+    if (calculator->isSynchronous()) {
+      QThread* thread = new QThread(this);
+      calculator->moveToThread(thread);
+      thread->start();
+      m_threads.append(thread);
+    }
+    connect(calculator, SIGNAL(finished(QString,int,int,int)),
+            this, SLOT(receiveFingerprint(QString,int,int,int)));
+    m_calculators.append(calculator);
   }
-  return true;
+  m_tasks.resize(m_calculators.size());
 }
 
 /**
- * Reset the state to Idle and no track.
+ * Reset the client state.
  */
 void MusicBrainzClient::stop()
 {
-  m_fingerprintCalculator->stop();
-  m_currentIndex = -1;
-  m_state = Idle;
+  // Calculators in worker threads have synchronous decoders, which can be
+  // stopped from this thread. Their results are still delivered, but their
+  // tokens are no longer valid, so they are not attributed to the tracks
+  // assigned to the calculators afterwards. Restarting such a calculator
+  // is queued after its current calculation.
+  for (int i = 0; i < m_calculators.size(); ++i) {
+    if (m_tasks.trackIndex(i) >= 0) {
+      m_calculators.at(i)->stop();
+    }
+  }
+  m_tasks.stopAll();
+  m_nextFingerprintIndex = m_filenameOfTrack.size();
+  m_pendingFingerprints.clear();
+  m_metadataQueue.clear();
+  m_currentTrackData.clear();
+  // Aborted requests are reported synchronously and ignored because
+  // no track is waiting for them.
+  if (!m_lookupIndexes.isEmpty()) {
+    m_lookupIndexes.clear();
+    m_acoustIdClient->abort();
+  }
+  if (m_metadataIndex >= 0) {
+    m_metadataIndex = -1;
+    httpClient()->abort();
+  }
 }
 
 /**
- * Receive response from web service.
- * @param bytes bytes received
+ * Start fingerprint calculations for the next tracks on all idle
+ * calculators.
  */
-void MusicBrainzClient::receiveBytes(const QByteArray& bytes)
+void MusicBrainzClient::startFingerprintCalculations()
 {
-  switch (m_state) {
-  case GettingIds:
-    if (!verifyIdIndex())
-      return;
-    m_idsOfTrack[m_currentIndex] = parseAcoustidIds(bytes);
-    if (m_idsOfTrack.at(m_currentIndex).isEmpty()) {
-      emit statusChanged(m_currentIndex, tr("Unrecognized"));
-    }
-    m_state = GettingMetadata;
-    processNextStep();
-    break;
-  case GettingMetadata:
-    parseMusicBrainzMetadata(bytes, m_currentTrackData);
-    if (!verifyIdIndex())
-      return;
-    if (m_idsOfTrack.at(m_currentIndex).isEmpty()) {
-      emit statusChanged(m_currentIndex, m_currentTrackData.size() == 1
-                         ? tr("Recognized") : tr("User Selection"));
-      emit resultsReceived(m_currentIndex, m_currentTrackData);
+  int calculatorNr;
+  while (m_nextFingerprintIndex < m_filenameOfTrack.size() &&
+         (calculatorNr = m_tasks.idleCalculator()) >= 0) {
+    int index = m_nextFingerprintIndex++;
+    int token = m_tasks.assign(calculatorNr, index);
+    emit statusChanged(index, tr("Fingerprint"));
+    FingerprintCalculator* calculator = m_calculators.at(calculatorNr);
+    if (calculator->thread() != thread()) {
+      QMetaObject::invokeMethod(calculator, "start", Qt::QueuedConnection,
+                                Q_ARG(QString, m_filenameOfTrack.at(index)),
+                                Q_ARG(int, token));
+    } else {
+      calculator->start(m_filenameOfTrack.at(index), token);
     }
-    processNextStep();
-    break;
-  default:
-    ;
   }
 }
 
@@ -304,78 +362,136 @@ void MusicBrainzClient::receiveBytes(const QByteArray& bytes)
  * @param fingerprint Chromaprint fingerprint
  * @param duration duration in seconds
  * @param error error code
+ * @param token token of calculation, results of stopped calculations
+ * are ignored
  */
 void MusicBrainzClient::receiveFingerprint(const QString& fingerprint,
-                                           int duration, int error)
+                                           int duration, int error,
+                                           int token)
 {
-  if (error == FingerprintCalculator::Ok) {
-    m_state = GettingIds;
-    emit statusChanged(m_currentIndex, tr("ID Lookup"));
-    QString path(QLatin1String("/v2/lookup?client=LxDbFAXo&meta=recordingids&duration=") +
-                 QString::number(duration) +
-                 QLatin1String("&fingerprint=") + fingerprint);
-    httpClient()->sendRequest(QLatin1String("api.acoustid.org"), path,
-                              QLatin1String("https"));
-  } else {
-    emit statusChanged(m_currentIndex, tr("Error"));
-    if (m_state != Idle) {
-      processNextTrack();
+  int index = m_tasks.finish(m_calculators.indexOf(
+        qobject_cast<FingerprintCalculator*>(sender())), token);
+  if (index < 0)
+    return;
+
+  if (index < m_filenameOfTrack.size()) {
+    if (error == FingerprintCalculator::Ok) {
+      emit statusChanged(index, tr("ID Lookup"));
+      Fingerprint fp;
+      fp.index = index;
+      fp.duration = duration;
+      fp.fingerprint = fingerprint;
+      m_pendingFingerprints.append(fp);
+    } else {
+      emit statusChanged(index, tr("Error"));
     }
   }
+  startFingerprintCalculations();
+  sendIdLookup();
 }
 
 /**
- * Process next step in importing from fingerprints.
+ * Look up the pending fingerprints at acoustid.org if no lookup is
+ * in progress.
+ * Fingerprints calculated while a lookup is in progress are collected
+ * and sent together in the next request.
  */
-void MusicBrainzClient::processNextStep()
+void MusicBrainzClient::sendIdLookup()
 {
-  switch (m_state) {
-  case Idle:
-    break;
-  case CalculatingFingerprint:
-  {
-    if (!verifyTrackIndex())
-      return;
-    emit statusChanged(m_currentIndex, tr("Fingerprint"));
-    m_fingerprintCalculator->start(m_filenameOfTrack.at(m_currentIndex));
-    break;
+  if (!m_lookupIndexes.isEmpty() || m_pendingFingerprints.isEmpty())
+    return;
+
+  QByteArray data("client=LxDbFAXo&meta=recordingids&format=json");
+  for (int i = 0;
+       i < MaxFingerprintsPerLookup && !m_pendingFingerprints.isEmpty();
+       ++i) {
+    Fingerprint fp = m_pendingFingerprints.takeFirst();
+    QByteArray nr(QByteArray::number(i));
+    data += "&duration." + nr + '=' + QByteArray::number(fp.duration);
+    data += "&fingerprint." + nr + '=' + fp.fingerprint.toLatin1();
+    m_lookupIndexes.append(fp.index);
   }
-  case GettingMetadata:
-  {
-    if (!verifyIdIndex())
-      return;
-    QStringList& ids = m_idsOfTrack[m_currentIndex];
-    if (!ids.isEmpty()) {
-      emit statusChanged(m_currentIndex, tr("Metadata Lookup"));
-      QString path(QLatin1String("/ws/2/recording/") + ids.takeFirst() +
-                   QLatin1String("?inc=artists+releases+media"));
-      httpClient()->sendRequest(QLatin1String("musicbrainz.org"), path,
-                                QLatin1String("https"), m_headers);
+  m_acoustIdClient->sendPostRequest(
+        QUrl(QLatin1String("https://api.acoustid.org/v2/lookup")), data);
+}
+
+/**
+ * Receive response from acoustid.org.
+ * @param bytes bytes received
+ */
+void MusicBrainzClient::receiveIds(const QByteArray& bytes)
+{
+  if (m_lookupIndexes.isEmpty())
+    return;
+
+  const QList<int> indexes = m_lookupIndexes;
+  m_lookupIndexes.clear();
+  const QMap<int, QStringList> idsOfIndex = parseAcoustidIds(bytes);
+  for (int i = 0; i < indexes.size(); ++i) {
+    int index = indexes.at(i);
+    if (index < 0 || index >= m_idsOfTrack.size())
+      continue;
+
+    m_idsOfTrack[index] = idsOfIndex.value(i);
+    if (m_idsOfTrack.at(index).isEmpty()) {
+      emit statusChanged(index, tr("Unrecognized"));
     } else {
-      processNextTrack();
+      m_metadataQueue.append(index);
     }
-    break;
-  }
-  case GettingIds:
-    qWarning("processNextStep() called in state GettingIds");
-    stop();
   }
+  processNextMetadataLookup();
+  sendIdLookup();
 }
 
 /**
- * Process next track.
- * If all tracks have been processed, the state is reset to Idle.
+ * Start metadata lookup for the next track in the queue if no lookup is
+ * in progress.
  */
-void MusicBrainzClient::processNextTrack()
+void MusicBrainzClient::processNextMetadataLookup()
 {
-  if (m_currentIndex < m_filenameOfTrack.size() - 1) {
-    ++m_currentIndex;
-    m_state = CalculatingFingerprint;
-  } else {
-    stop();
-  }
+  if (m_metadataIndex >= 0 || m_metadataQueue.isEmpty())
+    return;
+
+  m_metadataIndex = m_metadataQueue.takeFirst();
   m_currentTrackData.clear();
-  processNextStep();
+  emit statusChanged(m_metadataIndex, tr("Metadata Lookup"));
+  sendMetadataLookup();
+}
+
+/**
+ * Request the metadata of the next recording of the current track from
+ * MusicBrainz.
+ */
+void MusicBrainzClient::sendMetadataLookup()
+{
+  QString path(QLatin1String("/ws/2/recording/") +
+               m_idsOfTrack[m_metadataIndex].takeFirst() +
+               QLatin1String("?inc=artists+releases+media"));
+  httpClient()->sendRequest(QLatin1String("musicbrainz.org"), path,
+                            QLatin1String("https"), m_headers);
+}
+
+/**
+ * Receive response from web service.
+ * @param bytes bytes received
+ */
+void MusicBrainzClient::receiveBytes(const QByteArray& bytes)
+{
+  if (m_metadataIndex < 0 || m_metadataIndex >= m_idsOfTrack.size())
+    return;
+
+  parseMusicBrainzMetadata(bytes, m_currentTrackData);
+  if (!m_idsOfTrack.at(m_metadataIndex).isEmpty()) {
+    sendMetadataLookup();
+    return;
+  }
+
+  int index = m_metadataIndex;
+  m_metadataIndex = -1;
+  emit statusChanged(index, m_currentTrackData.size() == 1
+                     ? tr("Recognized") : tr("User Selection"));
+  emit resultsReceived(index, m_currentTrackData);
+  processNextMetadataLookup();
 }
 
 /**
@@ -405,5 +521,7 @@ void MusicBrainzClient::start()
     }
   }
   stop();
-  processNextTrack();
+  createCalculators();
+  m_nextFingerprintIndex = 0;
+  startFingerprintCalculations();
 }
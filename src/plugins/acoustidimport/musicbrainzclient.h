@@ -28,14 +28,24 @@
 #define MUSICBRAINZCLIENT_H
 
 #include <QObject>
+#include <QList>
 #include "servertrackimporter.h"
 #include "trackdata.h"
+#include "fingerprinttasktracker.h"
 
 class QByteArray;
+class QThread;
+class HttpClient;
 class FingerprintCalculator;
 
 /**
  * MusicBrainz client.
+ *
+ * Fingerprints of multiple tracks are calculated concurrently, one
+ * calculator per processor core. Calculators with a synchronous decoder
+ * run in their own worker thread. The fingerprints are looked up in batches
+ * at acoustid.org, the metadata of the recordings is then fetched from
+ * MusicBrainz one track after the other.
  */
 class MusicBrainzClient : public ServerTrackImporter
 {
@@ -107,26 +117,36 @@ signals:
 private slots:
   void receiveBytes(const QByteArray& bytes);
 
-  void receiveFingerprint(const QString& fingerprint, int duration, int error);
+  void receiveIds(const QByteArray& bytes);
+
+  void receiveFingerprint(const QString& fingerprint, int duration, int error,
+                          int token);
 
 private:
-  enum State {
-    Idle,
-    CalculatingFingerprint,
-    GettingIds,
-    GettingMetadata
+  /** Calculated fingerprint waiting for lookup at acoustid.org. */
+  struct Fingerprint {
+    int index;
+    int duration;
+    QString fingerprint;
   };
 
-  bool verifyIdIndex();
-  bool verifyTrackIndex();
-  void processNextStep();
-  void processNextTrack();
+  void createCalculators();
+  void startFingerprintCalculations();
+  void sendIdLookup();
+  void sendMetadataLookup();
+  void processNextMetadataLookup();
 
-  FingerprintCalculator* m_fingerprintCalculator;
-  State m_state;
+  QList<FingerprintCalculator*> m_calculators;
+  QList<QThread*> m_threads;
+  FingerprintTaskTracker m_tasks;
+  HttpClient* m_acoustIdClient;
   QVector<QString> m_filenameOfTrack;
   QVector<QStringList> m_idsOfTrack;
-  int m_currentIndex;
+  int m_nextFingerprintIndex;
+  QList<Fingerprint> m_pendingFingerprints;
+  QList<int> m_lookupIndexes;
+  QList<int> m_metadataQueue;
+  int m_metadataIndex;
   ImportTrackDataVector m_currentTrackData;
   QMap<QByteArray, QByteArray> m_headers;
 };
@@ -0,0 +1,201 @@
+/**
+ * \file id3libio.cpp
+ * Reader and writer for id3lib using Qt I/O.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "id3libio.h"
+#include <QFile>
+#include <cstring>
+
+namespace {
+
+/** Size of blocks read from the file. */
+const ID3_Reader::pos_type BlockSize = 16384;
+
+}
+
+/**
+ * Constructor.
+ * @param file file opened for reading
+ */
+Id3libFileReader::Id3libFileReader(QFile& file)
+  : m_file(file), m_size(static_cast<pos_type>(file.size())), m_pos(0)
+{
+}
+
+/**
+ * Destructor.
+ */
+Id3libFileReader::~Id3libFileReader()
+{
+}
+
+/**
+ * Close the reader, the file is not closed.
+ */
+void Id3libFileReader::close()
+{
+  m_blocks.clear();
+}
+
+/**
+ * Get end position.
+ * @return size of file.
+ */
+ID3_Reader::pos_type Id3libFileReader::getEnd()
+{
+  return m_size;
+}
+
+/**
+ * Get current position.
+ * @return current position.
+ */
+ID3_Reader::pos_type Id3libFileReader::getCur()
+{
+  return m_pos;
+}
+
+/**
+ * Set current position.
+ * @param pos new position
+ * @return new position.
+ */
+ID3_Reader::pos_type Id3libFileReader::setCur(pos_type pos)
+{
+  m_pos = qMin(pos, m_size);
+  return m_pos;
+}
+
+/**
+ * Get next character without advancing the position.
+ * @return character, END_OF_READER at the end.
+ */
+ID3_Reader::int_type Id3libFileReader::peekChar()
+{
+  if (m_pos >= m_size)
+    return END_OF_READER;
+
+  const QByteArray& data = block(m_pos / BlockSize);
+  const int offset = m_pos % BlockSize;
+  return offset < data.size()
+      ? static_cast<int_type>(static_cast<uchar>(data.at(offset)))
+      : END_OF_READER;
+}
+
+/**
+ * Read characters.
+ * @param buf buffer to read into
+ * @param len number of characters to read
+ * @return number of characters read.
+ */
+ID3_Reader::size_type Id3libFileReader::readChars(char_type buf[],
+                                                  size_type len)
+{
+  size_type numRead = 0;
+  while (numRead < len && m_pos < m_size) {
+    const QByteArray& data = block(m_pos / BlockSize);
+    const int offset = m_pos % BlockSize;
+    if (offset >= data.size())
+      break;
+
+    const size_type n = qMin<size_type>(len - numRead, data.size() - offset);
+    if (buf) {
+      std::memcpy(buf + numRead, data.constData() + offset, n);
+    }
+    numRead += n;
+    m_pos += n;
+  }
+  return numRead;
+}
+
+/**
+ * Get a block of the file.
+ * @param index index of block
+ * @return data of block, shorter than the block size at the end of the
+ *         file.
+ */
+const QByteArray& Id3libFileReader::block(pos_type index)
+{
+  QHash<pos_type, QByteArray>::iterator it = m_blocks.find(index);
+  if (it == m_blocks.end()) {
+    QByteArray data;
+    if (m_file.seek(static_cast<qint64>(index) * BlockSize)) {
+      data = m_file.read(BlockSize);
+    }
+    it = m_blocks.insert(index, data);
+  }
+  return *it;
+}
+
+
+/**
+ * Constructor.
+ */
+Id3libBufferWriter::Id3libBufferWriter()
+{
+}
+
+/**
+ * Destructor.
+ */
+Id3libBufferWriter::~Id3libBufferWriter()
+{
+}
+
+/**
+ * Close the writer.
+ */
+void Id3libBufferWriter::close()
+{
+}
+
+/**
+ * Flush the writer.
+ */
+void Id3libBufferWriter::flush()
+{
+}
+
+/**
+ * Get current position.
+ * @return number of characters written.
+ */
+ID3_Writer::pos_type Id3libBufferWriter::getCur()
+{
+  return static_cast<pos_type>(m_data.size());
+}
+
+/**
+ * Write characters.
+ * @param buf characters to write
+ * @param len number of characters
+ * @return number of characters written.
+ */
+ID3_Writer::size_type Id3libBufferWriter::writeChars(const char_type buf[],
+                                                     size_type len)
+{
+  m_data.append(reinterpret_cast<const char*>(buf), static_cast<int>(len));
+  return len;
+}
@@ -0,0 +1,163 @@
+/**
+ * \file id3libio.h
+ * Reader and writer for id3lib using Qt I/O.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ID3LIBIO_H
+#define ID3LIBIO_H
+
+#include <QHash>
+#include <QByteArray>
+#include <id3/reader.h>
+#include <id3/writer.h>
+
+class QFile;
+
+/**
+ * id3lib reader for a file which reads each block of the file at most
+ * once.
+ * The ID3v1 and ID3v2 tags are parsed into separate ID3_Tag objects, with
+ * a shared reader, the file is only opened once and the blocks at the
+ * start and the end of the file are only read once for both tags.
+ */
+class Id3libFileReader : public ID3_Reader {
+public:
+  /**
+   * Constructor.
+   * @param file file opened for reading
+   */
+  explicit Id3libFileReader(QFile& file);
+
+  /**
+   * Destructor.
+   */
+  virtual ~Id3libFileReader();
+
+  /**
+   * Close the reader, the file is not closed.
+   */
+  virtual void close();
+
+  /**
+   * Get end position.
+   * @return size of file.
+   */
+  virtual pos_type getEnd();
+
+  /**
+   * Get current position.
+   * @return current position.
+   */
+  virtual pos_type getCur();
+
+  /**
+   * Set current position.
+   * @param pos new position
+   * @return new position.
+   */
+  virtual pos_type setCur(pos_type pos);
+
+  /**
+   * Get next character without advancing the position.
+   * @return character, END_OF_READER at the end.
+   */
+  virtual int_type peekChar();
+
+  using ID3_Reader::readChars;
+
+  /**
+   * Read characters.
+   * @param buf buffer to read into
+   * @param len number of characters to read
+   * @return number of characters read.
+   */
+  virtual size_type readChars(char_type buf[], size_type len);
+
+private:
+  /**
+   * Get a block of the file.
+   * @param index index of block
+   * @return data of block, shorter than the block size at the end of the
+   *         file.
+   */
+  const QByteArray& block(pos_type index);
+
+  QFile& m_file;
+  pos_type m_size;
+  pos_type m_pos;
+  QHash<pos_type, QByteArray> m_blocks;
+};
+
+/**
+ * id3lib writer rendering into a byte array.
+ */
+class Id3libBufferWriter : public ID3_Writer {
+public:
+  /**
+   * Constructor.
+   */
+  Id3libBufferWriter();
+
+  /**
+   * Destructor.
+   */
+  virtual ~Id3libBufferWriter();
+
+  /**
+   * Close the writer.
+   */
+  virtual void close();
+
+  /**
+   * Flush the writer.
+   */
+  virtual void flush();
+
+  /**
+   * Get current position.
+   * @return number of characters written.
+   */
+  virtual pos_type getCur();
+
+  using ID3_Writer::writeChars;
+
+  /**
+   * Write characters.
+   * @param buf characters to write
+   * @param len number of characters
+   * @return number of characters written.
+   */
+  virtual size_type writeChars(const char_type buf[], size_type len);
+
+  /**
+   * Get the data written.
+   * @return data.
+   */
+  const QByteArray& data() const { return m_data; }
+
+private:
+  QByteArray m_data;
+};
+
+#endif // ID3LIBIO_H
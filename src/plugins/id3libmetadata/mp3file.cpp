@@ -27,6 +27,7 @@
 #include "mp3file.h"
 
 #include <QDir>
+#include <QFile>
 #include <QString>
 #include <QTextCodec>
 #include <QByteArray>
@@ -41,6 +42,11 @@
 #include "id3libconfig.h"
 #include "genres.h"
 #include "attributedata.h"
+#include "picturestore.h"
+#include "tagconfig.h"
+#include "operationprofiler.h"
+#include "id3libio.h"
+#include "mp3tagwriter.h"
 
 #ifdef Q_OS_WIN32
 /**
@@ -72,6 +78,21 @@ ID3_TextEnc s_defaultTextEncoding = ID3TE_ISO8859_1;
  */
 ID3_TextEnc getDefaultTextEncoding() { return s_defaultTextEncoding; }
 
+/**
+ * Render a tag without padding.
+ * @param tag tag
+ * @param type ID3TT_ID3V1 or ID3TT_ID3V2
+ * @return rendered tag.
+ */
+QByteArray renderTag(ID3_Tag* tag, ID3_TagType type)
+{
+  Id3libBufferWriter writer;
+  tag->SetPadding(false);
+  tag->Render(writer, type);
+  tag->SetPadding(true);
+  return writer.data();
+}
+
 }
 
 /**
@@ -123,27 +144,33 @@ int Mp3File::taggedFileFeatures() const
 void Mp3File::readTags(bool force)
 {
   bool priorIsTagInformationRead = isTagInformationRead();
-  QByteArray fn = QFile::encodeName(currentFilePath());
+  bool linkV1 = false, linkV2 = false;
 
   if (force && m_tagV1) {
     m_tagV1->Clear();
-    m_tagV1->Link(fn, ID3TT_ID3V1);
-    markTagUnchanged(Frame::Tag_1);
+    linkV1 = true;
   }
   if (!m_tagV1) {
     m_tagV1 = new ID3_Tag;
-    m_tagV1->Link(fn, ID3TT_ID3V1);
-    markTagUnchanged(Frame::Tag_1);
+    linkV1 = true;
   }
 
   if (force && m_tagV2) {
     m_tagV2->Clear();
-    m_tagV2->Link(fn, ID3TT_ID3V2);
-    markTagUnchanged(Frame::Tag_2);
+    linkV2 = true;
   }
   if (!m_tagV2) {
     m_tagV2 = new ID3_Tag;
-    m_tagV2->Link(fn, ID3TT_ID3V2);
+    linkV2 = true;
+  }
+
+  if (linkV1 || linkV2) {
+    linkTags(linkV1, linkV2);
+  }
+  if (linkV1) {
+    markTagUnchanged(Frame::Tag_1);
+  }
+  if (linkV2) {
     markTagUnchanged(Frame::Tag_2);
   }
 
@@ -168,6 +195,7 @@ void Mp3File::readTags(bool force)
 bool Mp3File::writeTags(bool force, bool* renamed, bool preserve)
 {
   QString fnStr(currentFilePath());
+  setFileRewritten(false);
   if (isChanged() && !QFileInfo(fnStr).isWritable()) {
     revertChangedFilename();
     return false;
@@ -179,29 +207,33 @@ bool Mp3File::writeTags(bool force, bool* renamed, bool preserve)
     getFileTimeStamps(fnStr, actime, modtime);
   }
 
-  // There seems to be a bug in id3lib: The V1 genre is not
-  // removed. So we check here and strip the whole header
-  // if there are no frames.
-  if (m_tagV1 && (force || isTagChanged(Frame::Tag_1)) && (m_tagV1->NumFrames() == 0)) {
-    m_tagV1->Strip(ID3TT_ID3V1);
-    markTagUnchanged(Frame::Tag_1);
-  }
-  // Even after removing all frames, HasV2Tag() still returns true,
-  // so we strip the whole header.
-  if (m_tagV2 && (force || isTagChanged(Frame::Tag_2)) && (m_tagV2->NumFrames() == 0)) {
-    m_tagV2->Strip(ID3TT_ID3V2);
-    markTagUnchanged(Frame::Tag_2);
-  }
-  // There seems to be a bug in id3lib: If I update an ID3v1 and then
-  // strip the ID3v2 the ID3v1 is removed too and vice versa, so I
-  // first make any stripping and then the updating.
-  if (m_tagV1 && (force || isTagChanged(Frame::Tag_1)) && (m_tagV1->NumFrames() > 0)) {
-    m_tagV1->Update(ID3TT_ID3V1);
-    markTagUnchanged(Frame::Tag_1);
-  }
-  if (m_tagV2 && (force || isTagChanged(Frame::Tag_2)) && (m_tagV2->NumFrames() > 0)) {
-    m_tagV2->Update(ID3TT_ID3V2);
-    markTagUnchanged(Frame::Tag_2);
+  bool updateV1 = m_tagV1 && (force || isTagChanged(Frame::Tag_1));
+  bool updateV2 = m_tagV2 && (force || isTagChanged(Frame::Tag_2));
+  if (updateV1 || updateV2) {
+    // The presence of the tags in the file is only known to id3lib after
+    // parsing, so tags which were added or removed are parsed again.
+    bool relinkV1 = updateV1 &&
+        m_tagV1->HasV1Tag() != (m_tagV1->NumFrames() > 0);
+    bool relinkV2 = updateV2 &&
+        m_tagV2->HasV2Tag() != (m_tagV2->NumFrames() > 0);
+    if (!updateTags(updateV1, updateV2)) {
+      return false;
+    }
+    if (updateV1) {
+      markTagUnchanged(Frame::Tag_1);
+    }
+    if (updateV2) {
+      markTagUnchanged(Frame::Tag_2);
+    }
+    if ((relinkV1 || relinkV2) && !isFilenameChanged()) {
+      if (relinkV1) {
+        m_tagV1->Clear();
+      }
+      if (relinkV2) {
+        m_tagV2->Clear();
+      }
+      linkTags(relinkV1, relinkV2);
+    }
   }
 
   // restore time stamp
@@ -221,6 +253,58 @@ bool Mp3File::writeTags(bool force, bool* renamed, bool preserve)
   return true;
 }
 
+/**
+ * Parse tags from the file.
+ * The file is opened once and its blocks are read once for both tags.
+ *
+ * @param linkV1 true to parse the ID3v1 tag into m_tagV1
+ * @param linkV2 true to parse the ID3v2 tag into m_tagV2
+ */
+void Mp3File::linkTags(bool linkV1, bool linkV2)
+{
+  QFile file(currentFilePath());
+  if (!file.open(QIODevice::ReadOnly))
+    return;
+
+  Id3libFileReader reader(file);
+  if (linkV1) {
+    m_tagV1->Link(reader, ID3TT_ID3V1);
+  }
+  if (linkV2) {
+    reader.setCur(reader.getBeg());
+    m_tagV2->Link(reader, ID3TT_ID3V2);
+  }
+}
+
+/**
+ * Write tags to the file.
+ * Both tags are written while the file is opened once, tags without
+ * frames are removed. The ID3v2 tag is written in place if it fits into
+ * the space of the existing tag, else the file is rewritten once.
+ *
+ * @param updateV1 true to write m_tagV1
+ * @param updateV2 true to write m_tagV2
+ *
+ * @return true if ok.
+ */
+bool Mp3File::updateTags(bool updateV1, bool updateV2)
+{
+  const TagConfig& tagCfg = TagConfig::instance();
+  Mp3TagWriter writer(currentFilePath(), tagCfg.tagPaddingSize(),
+                      tagCfg.growTagPaddingOnce());
+  if (updateV1) {
+    writer.setTagV1(m_tagV1->NumFrames() > 0
+                    ? renderTag(m_tagV1, ID3TT_ID3V1) : QByteArray());
+  }
+  if (updateV2) {
+    writer.setTagV2(m_tagV2->NumFrames() > 0
+                    ? renderTag(m_tagV2, ID3TT_ID3V2) : QByteArray());
+  }
+  const Mp3TagWriter::Result result = writer.write();
+  setFileRewritten(result == Mp3TagWriter::Rewritten);
+  return result != Mp3TagWriter::Failed;
+}
+
 /**
  * Free resources allocated when calling readTags().
  *
@@ -1233,6 +1317,8 @@ static QString getFieldsFromId3Frame(ID3_Frame* id3Frame,
         field.m_value = syltBytesToList(ba, enc);
       } else if (id3Id == ID3FID_EVENTTIMING) {
         field.m_value = etcoBytesToList(ba);
+      } else if (id3Id == ID3FID_PICTURE) {
+        field.m_value = PictureStore::instance().intern(ba);
       } else {
         field.m_value = ba;
       }
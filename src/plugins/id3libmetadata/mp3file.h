@@ -241,6 +241,28 @@ private:
    */
   bool setTrackNum(ID3_Tag* tag, int num, int numTracks = 0) const;
 
+  /**
+   * Parse tags from the file.
+   * The file is opened once and its blocks are read once for both tags.
+   *
+   * @param linkV1 true to parse the ID3v1 tag into m_tagV1
+   * @param linkV2 true to parse the ID3v2 tag into m_tagV2
+   */
+  void linkTags(bool linkV1, bool linkV2);
+
+  /**
+   * Write tags to the file.
+   * Both tags are written while the file is opened once, tags without
+   * frames are removed. The ID3v2 tag is written in place if it fits into
+   * the space of the existing tag, else the file is rewritten once.
+   *
+   * @param updateV1 true to write m_tagV1
+   * @param updateV2 true to write m_tagV2
+   *
+   * @return true if ok.
+   */
+  bool updateTags(bool updateV1, bool updateV2);
+
   /**
    * Set the fields in an id3lib frame from the field in the frame.
    *
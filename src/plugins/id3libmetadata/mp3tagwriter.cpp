@@ -0,0 +1,180 @@
+/**
+ * \file mp3tagwriter.cpp
+ * Write ID3v1 and ID3v2 tags into an MP3 file.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mp3tagwriter.h"
+#include <QFile>
+#include "operationprofiler.h"
+#include "filerewriter.h"
+
+namespace {
+
+/** Size of an ID3v1 tag. */
+const int TagV1Size = 128;
+/** Size of the ID3v2 header and footer. */
+const int TagV2HeaderSize = 10;
+/** id3lib rounds the file size up to a multiple of this size. */
+const int Id3libPadMultiple = 2048;
+/** Maximum padding reserved by the grow once policy. */
+const int MaxGrownPadding = 1024 * 1024;
+
+}
+
+/**
+ * Constructor.
+ * @param filePath path to MP3 file
+ * @param paddingSize padding in bytes reserved when the ID3v2 tag grows,
+ *                    0 to pad like id3lib, which rounds the size of the
+ *                    file up to a multiple of 2 KiB
+ * @param growPadding true to reserve padding as large as the tag
+ */
+Mp3TagWriter::Mp3TagWriter(const QString& filePath, int paddingSize,
+                           bool growPadding)
+  : m_filePath(filePath), m_paddingSize(qMax(paddingSize, 0)),
+    m_growPadding(growPadding), m_updateV1(false), m_updateV2(false)
+{
+}
+
+/**
+ * Set the ID3v1 tag to write.
+ * @param tag rendered tag of 128 bytes, empty to remove the tag
+ */
+void Mp3TagWriter::setTagV1(const QByteArray& tag)
+{
+  m_tagV1 = tag;
+  m_updateV1 = true;
+}
+
+/**
+ * Set the ID3v2 tag to write.
+ * @param tag rendered tag without padding, empty to remove the tag
+ */
+void Mp3TagWriter::setTagV2(const QByteArray& tag)
+{
+  m_tagV2 = tag;
+  m_updateV2 = true;
+}
+
+/**
+ * Get the size of the ID3v2 tag written to the file.
+ * @param oldV2Size size of existing ID3v2 tag including its padding
+ * @param dataSize size of the file without ID3v2 tag
+ * @return size of new tag including padding, 0 if it is removed.
+ */
+qint64 Mp3TagWriter::paddedTagV2Size(qint64 oldV2Size, qint64 dataSize) const
+{
+  const qint64 size = m_tagV2.size();
+  if (size == 0 || size <= oldV2Size)
+    return size == 0 ? 0 : oldV2Size;
+
+  qint64 padding = m_paddingSize;
+  if (padding == 0) {
+    padding = Id3libPadMultiple - (size + dataSize) % Id3libPadMultiple;
+  }
+  if (m_growPadding) {
+    padding = qMax<qint64>(padding, qMin<qint64>(size, MaxGrownPadding));
+  }
+  return size + padding;
+}
+
+/**
+ * Write the tags set with setTagV1() and setTagV2(), the other tag is
+ * kept.
+ * @return result of operation.
+ */
+Mp3TagWriter::Result Mp3TagWriter::write()
+{
+  // ReadWrite would create a missing file.
+  QFile file(m_filePath);
+  if (!file.exists() || !file.open(QIODevice::ReadWrite))
+    return Failed;
+
+  // Find the existing tags, ID3v2 at the start, ID3v1 at the end.
+  const qint64 fileSize = file.size();
+  qint64 oldV2Size = 0;
+  const QByteArray header = file.read(TagV2HeaderSize);
+  if (header.size() == TagV2HeaderSize && header.startsWith("ID3")) {
+    oldV2Size = TagV2HeaderSize + (((header.at(6) & 0x7f) << 21) |
+                                   ((header.at(7) & 0x7f) << 14) |
+                                   ((header.at(8) & 0x7f) << 7) |
+                                   (header.at(9) & 0x7f));
+    if (header.at(5) & 0x10) {
+      oldV2Size += TagV2HeaderSize;
+    }
+    if (oldV2Size > fileSize)
+      return Failed;
+  }
+  bool hasV1 = false;
+  if (fileSize - oldV2Size >= TagV1Size &&
+      file.seek(fileSize - TagV1Size)) {
+    hasV1 = file.read(3) == "TAG";
+  }
+  const qint64 audioEnd = hasV1 ? fileSize - TagV1Size : fileSize;
+  const qint64 newV1Size = m_updateV1 ? m_tagV1.size() : fileSize - audioEnd;
+
+  QByteArray v2;
+  qint64 newV2Size = oldV2Size;
+  if (m_updateV2) {
+    newV2Size = paddedTagV2Size(oldV2Size,
+                                audioEnd - oldV2Size + newV1Size);
+    if (newV2Size > 0) {
+      v2 = m_tagV2;
+      v2.append(QByteArray(newV2Size - v2.size(), '\0'));
+      const qint64 size = newV2Size - TagV2HeaderSize;
+      for (int i = 0; i < 4; ++i) {
+        v2[6 + i] = static_cast<char>((size >> (7 * (3 - i))) & 0x7f);
+      }
+    }
+  }
+
+  if (newV2Size == oldV2Size) {
+    // The tags are written in place, the ID3v1 tag is appended or
+    // truncated.
+    if (m_updateV1) {
+      if (!m_tagV1.isEmpty()) {
+        if (!file.seek(audioEnd) || file.write(m_tagV1) != m_tagV1.size())
+          return Failed;
+      } else if (hasV1 && !file.resize(audioEnd)) {
+        return Failed;
+      }
+    }
+    if (!v2.isEmpty() && (!file.seek(0) || file.write(v2) != v2.size()))
+      return Failed;
+    return WrittenInPlace;
+  }
+
+  // The audio data is moved by writing a new file, the original file is
+  // kept if this fails.
+  file.close();
+  FileRewriter rewriter(m_filePath);
+  if (!rewriter.open() || !rewriter.write(v2) ||
+      !rewriter.copy(oldV2Size, audioEnd) ||
+      !(m_updateV1 ? rewriter.write(m_tagV1)
+                   : rewriter.copy(audioEnd, fileSize)) ||
+      !rewriter.commit())
+    return Failed;
+  OperationProfiler::count(OperationProfiler::FileRewrites);
+  return Rewritten;
+}
@@ -0,0 +1,100 @@
+/**
+ * \file mp3tagwriter.h
+ * Write ID3v1 and ID3v2 tags into an MP3 file.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MP3TAGWRITER_H
+#define MP3TAGWRITER_H
+
+#include <QString>
+#include <QByteArray>
+
+/**
+ * Writes rendered ID3v1 and ID3v2 tags into an MP3 file.
+ *
+ * Both tags are written while the file is opened once. The ID3v2 tag is
+ * written in place if it fits into the space of the existing tag, the rest
+ * of the space is kept as padding. Else the file is written as a new file
+ * with the audio data after the new tag and padding, which replaces the
+ * original file only if it is complete, so that an I/O error does not
+ * leave a partially moved file. The ID3v1 tag at the end of the file is
+ * always written in place unless the file is rewritten anyway.
+ */
+class Mp3TagWriter {
+public:
+  /** Result of write(). */
+  enum Result {
+    WrittenInPlace, /**< tags written without moving the audio data */
+    Rewritten,      /**< file rewritten with moved audio data */
+    Failed          /**< file could not be written */
+  };
+
+  /**
+   * Constructor.
+   * @param filePath path to MP3 file
+   * @param paddingSize padding in bytes reserved when the ID3v2 tag grows,
+   *                    0 to pad like id3lib, which rounds the size of the
+   *                    file up to a multiple of 2 KiB
+   * @param growPadding true to reserve padding as large as the tag
+   */
+  Mp3TagWriter(const QString& filePath, int paddingSize, bool growPadding);
+
+  /**
+   * Set the ID3v1 tag to write.
+   * @param tag rendered tag of 128 bytes, empty to remove the tag
+   */
+  void setTagV1(const QByteArray& tag);
+
+  /**
+   * Set the ID3v2 tag to write.
+   * @param tag rendered tag without padding, empty to remove the tag
+   */
+  void setTagV2(const QByteArray& tag);
+
+  /**
+   * Write the tags set with setTagV1() and setTagV2(), the other tag is
+   * kept.
+   * @return result of operation.
+   */
+  Result write();
+
+private:
+  /**
+   * Get the size of the ID3v2 tag written to the file.
+   * @param oldV2Size size of existing ID3v2 tag including its padding
+   * @param dataSize size of the file without ID3v2 tag
+   * @return size of new tag including padding, 0 if it is removed.
+   */
+  qint64 paddedTagV2Size(qint64 oldV2Size, qint64 dataSize) const;
+
+  QString m_filePath;
+  QByteArray m_tagV1;
+  QByteArray m_tagV2;
+  int m_paddingSize;
+  bool m_growPadding;
+  bool m_updateV1;
+  bool m_updateV2;
+};
+
+#endif // MP3TAGWRITER_H
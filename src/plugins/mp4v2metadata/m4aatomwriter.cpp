@@ -0,0 +1,487 @@
+/**
+ * \file m4aatomwriter.cpp
+ * Restore the atom layout of MP4 files after changing metadata.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "m4aatomwriter.h"
+#include <QFile>
+#include <string.h>
+#include "operationprofiler.h"
+#include "filerewriter.h"
+
+namespace {
+
+/** Maximum padding reserved by the grow once policy. */
+const int MaxGrownPadding = 1024 * 1024;
+/** Maximum size of a moov atom which is read into memory. */
+const qint64 MaxMoovSize = 256 * 1024 * 1024;
+/** Size of an atom header with 32 bit size. */
+const int AtomHeaderSize = 8;
+
+/**
+ * Get a big endian 32 bit integer.
+ * @param data bytes
+ * @return integer value.
+ */
+quint32 getBe32(const char* data)
+{
+  const uchar* bytes = reinterpret_cast<const uchar*>(data);
+  return (static_cast<quint32>(bytes[0]) << 24) | (bytes[1] << 16) |
+      (bytes[2] << 8) | bytes[3];
+}
+
+/**
+ * Get a big endian 64 bit integer.
+ * @param data bytes
+ * @return integer value.
+ */
+quint64 getBe64(const char* data)
+{
+  return (static_cast<quint64>(getBe32(data)) << 32) | getBe32(data + 4);
+}
+
+/**
+ * Set a big endian 32 bit integer.
+ * @param data bytes
+ * @param value integer value
+ */
+void setBe32(char* data, quint32 value)
+{
+  for (int i = 3; i >= 0; --i) {
+    data[i] = static_cast<char>(value & 0xff);
+    value >>= 8;
+  }
+}
+
+/**
+ * Set a big endian 64 bit integer.
+ * @param data bytes
+ * @param value integer value
+ */
+void setBe64(char* data, quint64 value)
+{
+  setBe32(data, static_cast<quint32>(value >> 32));
+  setBe32(data + 4, static_cast<quint32>(value & 0xffffffffU));
+}
+
+/**
+ * Check if an atom type is free space.
+ * @param type atom type
+ * @return true for free and skip atoms.
+ */
+bool isFreeType(const QByteArray& type)
+{
+  return type == "free" || type == "skip";
+}
+
+/**
+ * Create a free atom.
+ * @param size size of atom including header, at least 8
+ * @return free atom.
+ */
+QByteArray freeAtom(int size)
+{
+  QByteArray atom(size, '\0');
+  setBe32(atom.data(), size);
+  ::memcpy(atom.data() + 4, "free", 4);
+  return atom;
+}
+
+/**
+ * Get the header of an atom in memory.
+ * @param data atom data
+ * @param pos position of atom
+ * @param end end of enclosing atom
+ * @param headerSize the size of the header is returned here
+ * @return size of atom, -1 if invalid.
+ */
+qint64 atomSizeAt(const char* data, qint64 pos, qint64 end, int& headerSize)
+{
+  if (pos + AtomHeaderSize > end)
+    return -1;
+  qint64 size = getBe32(data + pos);
+  headerSize = AtomHeaderSize;
+  if (size == 1) {
+    if (pos + 16 > end)
+      return -1;
+    size = static_cast<qint64>(getBe64(data + pos + 8));
+    headerSize = 16;
+  } else if (size == 0) {
+    size = end - pos;
+  }
+  if (size < headerSize || size > end - pos)
+    return -1;
+  return size;
+}
+
+/**
+ * Find a child atom in memory.
+ * @param data atom data
+ * @param start start of children
+ * @param end end of children
+ * @param type type of child
+ * @param childStart start of child contents is returned here
+ * @param childEnd end of child is returned here
+ * @return true if found.
+ */
+bool findChild(const char* data, qint64 start, qint64 end, const char* type,
+               qint64& childStart, qint64& childEnd)
+{
+  qint64 pos = start;
+  int headerSize;
+  qint64 size;
+  while ((size = atomSizeAt(data, pos, end, headerSize)) > 0) {
+    if (::memcmp(data + pos + 4, type, 4) == 0) {
+      childStart = pos + headerSize;
+      childEnd = pos + size;
+      return true;
+    }
+    pos += size;
+  }
+  return false;
+}
+
+/**
+ * Add a value to the chunk offsets in container atoms.
+ * @param data atom data
+ * @param start start of children
+ * @param end end of children
+ * @param minOffset only offsets greater or equal are changed
+ * @param delta value to add
+ * @return true if ok, false if an atom is invalid or an offset is out of
+ *         range.
+ */
+bool adjustChunkOffsetsIn(char* data, qint64 start, qint64 end,
+                          qint64 minOffset, qint64 delta)
+{
+  qint64 pos = start;
+  while (pos < end) {
+    int headerSize;
+    const qint64 size = atomSizeAt(data, pos, end, headerSize);
+    if (size < 0)
+      return false;
+
+    const char* type = data + pos + 4;
+    const qint64 contentStart = pos + headerSize;
+    if (::memcmp(type, "moov", 4) == 0 || ::memcmp(type, "trak", 4) == 0 ||
+        ::memcmp(type, "mdia", 4) == 0 || ::memcmp(type, "minf", 4) == 0 ||
+        ::memcmp(type, "stbl", 4) == 0) {
+      if (!adjustChunkOffsetsIn(data, contentStart, pos + size,
+                                minOffset, delta))
+        return false;
+    } else if (::memcmp(type, "stco", 4) == 0 ||
+               ::memcmp(type, "co64", 4) == 0) {
+      const bool is64Bit = type[0] == 'c';
+      const int entrySize = is64Bit ? 8 : 4;
+      // version, flags and number of entries
+      if (contentStart + 8 > pos + size)
+        return false;
+      const qint64 numEntries = getBe32(data + contentStart + 4);
+      char* entry = data + contentStart + 8;
+      if (contentStart + 8 + numEntries * entrySize > pos + size)
+        return false;
+      for (qint64 i = 0; i < numEntries; ++i, entry += entrySize) {
+        if (is64Bit) {
+          const quint64 offset = getBe64(entry);
+          if (static_cast<qint64>(offset) >= minOffset) {
+            setBe64(entry, offset + delta);
+          }
+        } else {
+          const qint64 offset = getBe32(entry);
+          if (offset >= minOffset) {
+            if (offset + delta > 0xffffffffLL)
+              return false;
+            setBe32(entry, static_cast<quint32>(offset + delta));
+          }
+        }
+      }
+    }
+    pos += size;
+  }
+  return true;
+}
+
+}
+
+/**
+ * Constructor.
+ * @param filePath path to MP4 file
+ * @param paddingSize padding in bytes reserved when the media data has to
+ *                    be moved
+ * @param growPadding true to reserve padding as large as the metadata
+ */
+M4aAtomWriter::M4aAtomWriter(const QString& filePath, int paddingSize,
+                             bool growPadding)
+  : m_filePath(filePath), m_paddingSize(qMax(paddingSize, 0)),
+    m_growPadding(growPadding), m_regionStart(0), m_regionEnd(0),
+    m_moovBeforeMdat(false)
+{
+}
+
+/**
+ * Read the top level atoms of the file.
+ * @param file opened file
+ * @param atoms the atoms are returned here
+ * @return true if ok.
+ */
+bool M4aAtomWriter::readAtoms(QFile& file, QList<Atom>& atoms)
+{
+  const qint64 fileSize = file.size();
+  qint64 pos = 0;
+  while (pos < fileSize) {
+    if (!file.seek(pos))
+      return false;
+    const QByteArray header = file.read(16);
+    if (header.size() < AtomHeaderSize)
+      return false;
+
+    quint64 size = getBe32(header.constData());
+    int headerSize = AtomHeaderSize;
+    if (size == 1) {
+      if (header.size() < 16)
+        return false;
+      size = getBe64(header.constData() + 8);
+      headerSize = 16;
+    } else if (size == 0) {
+      size = fileSize - pos;
+    }
+    if (size < static_cast<quint64>(headerSize) ||
+        size > static_cast<quint64>(fileSize - pos))
+      return false;
+
+    Atom atom;
+    atom.type = header.mid(4, 4);
+    atom.offset = pos;
+    atom.size = size;
+    atoms.append(atom);
+    pos += atom.size;
+  }
+  return true;
+}
+
+/**
+ * Add a value to the chunk offsets in a moov atom.
+ * @param moov data of moov atom
+ * @param minOffset only offsets greater or equal are changed
+ * @param delta value to add
+ * @return true if ok, false if an offset is out of range.
+ */
+bool M4aAtomWriter::adjustChunkOffsets(QByteArray& moov, qint64 minOffset,
+                                       qint64 delta)
+{
+  return adjustChunkOffsetsIn(moov.data(), 0, moov.size(), minOffset, delta);
+}
+
+/**
+ * Get size of the item list atom in a moov atom.
+ * @param moov data of moov atom
+ * @return size of moov.udta.meta.ilst, 0 if not found.
+ */
+int M4aAtomWriter::itemListSize(const QByteArray& moov)
+{
+  const char* data = moov.constData();
+  qint64 start, end;
+  if (findChild(data, 0, moov.size(), "moov", start, end) &&
+      findChild(data, start, end, "udta", start, end) &&
+      findChild(data, start, end, "meta", start, end) &&
+      // skip version and flags of meta atom
+      findChild(data, start + 4, end, "ilst", start, end)) {
+    return static_cast<int>(end - start) + AtomHeaderSize;
+  }
+  return 0;
+}
+
+/**
+ * Write the moov atom into the region of the old moov atom.
+ * The region is first turned into a single free atom, the header of the
+ * moov atom is written last, so that the file stays valid if writing fails.
+ * @param file opened file
+ * @param moov data of moov atom, must fit into the region
+ * @param tailStart start of the free and moov atoms appended by mp4v2,
+ *                  which are truncated
+ * @return MovedInPlace or Failed.
+ */
+M4aAtomWriter::Result M4aAtomWriter::writeMoovInPlace(
+    QFile& file, const QByteArray& moov, qint64 tailStart)
+{
+  const int moovSize = moov.size();
+  const qint64 regionSize = m_regionEnd - m_regionStart;
+  QByteArray regionHeader = freeAtom(AtomHeaderSize);
+  setBe32(regionHeader.data(), static_cast<quint32>(regionSize));
+  if (!file.seek(m_regionStart) ||
+      file.write(regionHeader) != AtomHeaderSize ||
+      file.write(moov.constData() + AtomHeaderSize,
+                 moovSize - AtomHeaderSize) != moovSize - AtomHeaderSize ||
+      (moovSize < regionSize &&
+       file.write(freeAtom(regionSize - moovSize)) !=
+       regionSize - moovSize) ||
+      !file.flush() ||
+      !file.seek(m_regionStart) ||
+      file.write(moov.constData(), AtomHeaderSize) != AtomHeaderSize ||
+      !file.flush())
+    return Failed;
+
+  if (!file.resize(tailStart)) {
+    // Keep only one moov atom by marking the appended one as free.
+    const qint64 appendedMoovOffset = file.size() - moovSize;
+    if (!file.seek(appendedMoovOffset + 4) || file.write("free", 4) != 4)
+      return Failed;
+  }
+  return MovedInPlace;
+}
+
+/**
+ * Read the layout of the file before it is modified.
+ * @return true if the file has a supported layout.
+ */
+bool M4aAtomWriter::readLayout()
+{
+  QFile file(m_filePath);
+  QList<Atom> atoms;
+  if (!file.open(QIODevice::ReadOnly) || !readAtoms(file, atoms))
+    return false;
+
+  int moovIdx = -1, mdatIdx = -1;
+  for (int i = 0; i < atoms.size(); ++i) {
+    const QByteArray& type = atoms.at(i).type;
+    if (type == "moof") {
+      // Fragmented files have offsets outside of the moov atom.
+      return false;
+    } else if (type == "moov") {
+      if (moovIdx != -1)
+        return false;
+      moovIdx = i;
+    } else if (type == "mdat" && mdatIdx == -1) {
+      mdatIdx = i;
+    }
+  }
+  if (moovIdx == -1 || mdatIdx == -1)
+    return false;
+
+  m_moovBeforeMdat = moovIdx < mdatIdx;
+  if (m_moovBeforeMdat) {
+    int first = moovIdx, last = moovIdx;
+    while (first > 0 && isFreeType(atoms.at(first - 1).type)) {
+      --first;
+    }
+    while (last + 1 < atoms.size() && isFreeType(atoms.at(last + 1).type)) {
+      ++last;
+    }
+    m_regionStart = atoms.at(first).offset;
+    m_regionEnd = atoms.at(last).offset + atoms.at(last).size;
+  }
+  return true;
+}
+
+/**
+ * Restore the layout read with readLayout() after the file was modified.
+ * @return result of operation.
+ */
+M4aAtomWriter::Result M4aAtomWriter::restoreLayout()
+{
+  if (!m_moovBeforeMdat) {
+    // The moov atom has to be moved in front of the media data, which
+    // rewrites the whole file anyway, so this is left to optimizing.
+    return NotHandled;
+  }
+
+  QFile file(m_filePath);
+  if (!file.open(QIODevice::ReadWrite))
+    return Failed;
+  QList<Atom> atoms;
+  if (!readAtoms(file, atoms))
+    return NotHandled;
+
+  int moovIdx = -1;
+  for (int i = 0; i < atoms.size(); ++i) {
+    const Atom& atom = atoms.at(i);
+    if (atom.type == "moov") {
+      if (moovIdx != -1)
+        return NotHandled;
+      moovIdx = i;
+    } else if (atom.offset >= m_regionStart && atom.offset < m_regionEnd &&
+               (!isFreeType(atom.type) ||
+                atom.offset + atom.size > m_regionEnd)) {
+      return NotHandled;
+    }
+  }
+  if (moovIdx == -1)
+    return NotHandled;
+
+  const Atom& moovAtom = atoms.at(moovIdx);
+  if (moovAtom.offset >= m_regionStart && moovAtom.offset < m_regionEnd) {
+    // Written in place by mp4v2.
+    return Unchanged;
+  }
+  if (moovAtom.offset < m_regionEnd || moovIdx != atoms.size() - 1 ||
+      moovAtom.size > MaxMoovSize ||
+      m_regionEnd - m_regionStart > 0xffffffffLL)
+    return NotHandled;
+
+  // Free atoms directly before the appended moov atom are removed.
+  int tailIdx = moovIdx;
+  while (tailIdx > 0 && isFreeType(atoms.at(tailIdx - 1).type) &&
+         atoms.at(tailIdx - 1).offset >= m_regionEnd) {
+    --tailIdx;
+  }
+  const qint64 tailEnd = atoms.at(tailIdx).offset;
+
+  if (!file.seek(moovAtom.offset))
+    return Failed;
+  QByteArray moov = file.read(moovAtom.size);
+  if (moov.size() != moovAtom.size)
+    return Failed;
+
+  const int moovSize = moov.size();
+  const qint64 regionSize = m_regionEnd - m_regionStart;
+  if (moovSize == regionSize || moovSize + AtomHeaderSize <= regionSize) {
+    // Move the moov atom back, the rest of the space stays free.
+    return writeMoovInPlace(file, moov, tailEnd);
+  }
+
+  int padding = m_paddingSize;
+  if (m_growPadding) {
+    padding = qMax(padding, qMin(itemListSize(moov), MaxGrownPadding));
+  }
+  // A free atom needs at least its header, the media data must not be moved
+  // towards the start.
+  if (padding < AtomHeaderSize && (padding > 0 || moovSize < regionSize)) {
+    padding = AtomHeaderSize;
+  }
+  const qint64 delta = moovSize + padding - regionSize;
+  if (!adjustChunkOffsets(moov, m_regionEnd, delta))
+    return NotHandled;
+
+  // The media data is moved by writing a new file, the file modified by
+  // mp4v2 is kept if this fails.
+  file.close();
+  FileRewriter rewriter(m_filePath);
+  if (!rewriter.open() || !rewriter.copy(0, m_regionStart) ||
+      !rewriter.write(moov) ||
+      (padding > 0 && !rewriter.write(freeAtom(padding))) ||
+      !rewriter.copy(m_regionEnd, tailEnd) || !rewriter.commit())
+    return Failed;
+  OperationProfiler::count(OperationProfiler::FileRewrites);
+  return Rewritten;
+}
@@ -0,0 +1,145 @@
+/**
+ * \file m4aatomwriter.h
+ * Restore the atom layout of MP4 files after changing metadata.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef M4AATOMWRITER_H
+#define M4AATOMWRITER_H
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+
+class QFile;
+
+/**
+ * Restores the atom layout of an MP4 file after its metadata was changed.
+ *
+ * When mp4v2 modifies a file whose moov atom is not the last atom, the old
+ * moov atom is converted into a free atom and the new one is appended to
+ * the end of the file. Instead of optimizing the whole file, the new moov
+ * atom is moved back into the space of the old moov atom and adjacent free
+ * atoms, the rest is kept as a free atom for later changes. Only if it does
+ * not fit, the media data is moved once to make room for the moov atom
+ * followed by padding, and the chunk offsets in the stco and co64 atoms
+ * are adjusted. The moved file is written as a new file which replaces the
+ * original file only if it is complete.
+ *
+ * Files with the moov atom after the media data are not handled, they have
+ * to be optimized to get the moov atom to the front of the file as before.
+ * This is only used by the mp4v2 plugin, TagLib updates the moov atom in
+ * place and adjusts the chunk offsets itself.
+ */
+class M4aAtomWriter {
+public:
+  /** Result of restoreLayout(). */
+  enum Result {
+    NotHandled,   /**< layout not supported or moov atom not in front of
+                       media data, file has to be optimized */
+    Unchanged,    /**< layout needs no change */
+    MovedInPlace, /**< moov atom moved into free space before media data */
+    Rewritten,    /**< media data moved to make room for moov atom */
+    Failed        /**< file could not be written */
+  };
+
+  /**
+   * Constructor.
+   * @param filePath path to MP4 file
+   * @param paddingSize padding in bytes reserved when the media data has to
+   *                    be moved
+   * @param growPadding true to reserve padding as large as the metadata
+   */
+  M4aAtomWriter(const QString& filePath, int paddingSize, bool growPadding);
+
+  /**
+   * Read the layout of the file before it is modified.
+   * @return true if the file has a supported layout.
+   */
+  bool readLayout();
+
+  /**
+   * Restore the layout read with readLayout() after the file was modified.
+   * @return result of operation.
+   */
+  Result restoreLayout();
+
+private:
+  /** Top level atom. */
+  struct Atom {
+    QByteArray type; /**< atom type */
+    qint64 offset;   /**< offset in file */
+    qint64 size;     /**< size including header */
+  };
+
+  /**
+   * Read the top level atoms of the file.
+   * @param file opened file
+   * @param atoms the atoms are returned here
+   * @return true if ok.
+   */
+  static bool readAtoms(QFile& file, QList<Atom>& atoms);
+
+  /**
+   * Add a value to the chunk offsets in a moov atom.
+   * @param moov data of moov atom
+   * @param minOffset only offsets greater or equal are changed
+   * @param delta value to add
+   * @return true if ok, false if an offset is out of range.
+   */
+  static bool adjustChunkOffsets(QByteArray& moov, qint64 minOffset,
+                                 qint64 delta);
+
+  /**
+   * Get size of the item list atom in a moov atom.
+   * @param moov data of moov atom
+   * @return size of moov.udta.meta.ilst, 0 if not found.
+   */
+  static int itemListSize(const QByteArray& moov);
+
+  /**
+   * Write the moov atom into the region of the old moov atom.
+   * The region is first turned into a single free atom, the header of the
+   * moov atom is written last, so that the file stays valid if writing
+   * fails.
+   * @param file opened file
+   * @param moov data of moov atom, must fit into the region
+   * @param tailStart start of the free and moov atoms appended by mp4v2,
+   *                  which are truncated
+   * @return MovedInPlace or Failed.
+   */
+  Result writeMoovInPlace(QFile& file, const QByteArray& moov,
+                          qint64 tailStart);
+
+  QString m_filePath;
+  int m_paddingSize;
+  bool m_growPadding;
+  /** Start of moov atom and adjacent free atoms before media data */
+  qint64 m_regionStart;
+  /** End of moov atom and adjacent free atoms before media data */
+  qint64 m_regionEnd;
+  /** true if moov atom is before media data */
+  bool m_moovBeforeMdat;
+};
+
+#endif // M4AATOMWRITER_H
@@ -40,6 +40,9 @@
 #include <cstring>
 #include "genres.h"
 #include "pictureframe.h"
+#include "tagconfig.h"
+#include "operationprofiler.h"
+#include "m4aatomwriter.h"
 
 /** MPEG4IP version as 16-bit hex number with major and minor version. */
 #if defined MP4V2_PROJECT_version_major && defined MP4V2_PROJECT_version_minor
@@ -545,6 +548,7 @@ bool M4aFile::writeTags(bool force, bool* renamed, bool preserve)
 {
   bool ok = true;
   QString fnStr(currentFilePath());
+  setFileRewritten(false);
   if (isChanged() && !QFileInfo(fnStr).isWritable()) {
     revertChangedFilename();
     return false;
@@ -559,6 +563,11 @@ bool M4aFile::writeTags(bool force, bool* renamed, bool preserve)
       getFileTimeStamps(fnStr, actime, modtime);
     }
 
+    const TagConfig& tagCfg = TagConfig::instance();
+    M4aAtomWriter atomWriter(fnStr, tagCfg.tagPaddingSize(),
+                             tagCfg.growTagPaddingOnce());
+    const bool layoutRead = atomWriter.readLayout();
+
     MP4FileHandle handle = MP4Modify(fn);
     if (handle != MP4_INVALID_FILE_HANDLE) {
 #if MPEG4IP_MAJOR_MINOR_VERSION >= 0x0109
@@ -843,9 +852,25 @@ bool M4aFile::writeTags(bool force, bool* renamed, bool preserve)
 #endif
                );
       if (ok) {
-        // without this, old tags stay in the file marked as free
-        MP4Optimize(fn);
-        markTagUnchanged(Frame::Tag_2);
+        // Move the moov atom back in front of the media data, reusing the
+        // free space left by the old moov atom. Only if this is not
+        // possible, the whole file is optimized.
+        M4aAtomWriter::Result result = layoutRead
+            ? atomWriter.restoreLayout() : M4aAtomWriter::NotHandled;
+        if (result == M4aAtomWriter::NotHandled) {
+          // without this, old tags stay in the file marked as free
+          MP4Optimize(fn);
+          OperationProfiler::count(OperationProfiler::FileRewrites);
+          setFileRewritten(true);
+        } else if (result == M4aAtomWriter::Failed) {
+          qDebug("Restoring MP4 layout failed");
+          ok = false;
+        } else if (result == M4aAtomWriter::Rewritten) {
+          setFileRewritten(true);
+        }
+        if (ok) {
+          markTagUnchanged(Frame::Tag_2);
+        }
       }
 
       // restore time stamp
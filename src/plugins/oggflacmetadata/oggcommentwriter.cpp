@@ -0,0 +1,552 @@
+/**
+ * \file oggcommentwriter.cpp
+ * Write Vorbis comments into the header pages of Ogg files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "oggcommentwriter.h"
+#include <QFile>
+#include <string.h>
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/sendfile.h>
+#endif
+#include "operationprofiler.h"
+
+namespace {
+
+/** Size of Ogg page header without lacing values. */
+const int PageHeaderSize = 27;
+/** Maximum number of lacing values in a page. */
+const int MaxLacingValues = 255;
+/** Page is continuation of a packet. */
+const int ContinuedFlag = 0x01;
+/** Page is beginning of stream. */
+const int BeginOfStreamFlag = 0x02;
+/** Page is end of stream. */
+const int EndOfStreamFlag = 0x04;
+/** Maximum padding reserved by the grow once policy. */
+const int MaxGrownPadding = 1024 * 1024;
+/** Size of buffer used to copy pages. */
+const int CopyBufferSize = 1024 * 1024;
+
+/** Table for Ogg CRC (polynomial 0x04c11db7, not reflected). */
+class OggCrcTable {
+public:
+  /** Constructor. */
+  OggCrcTable() {
+    for (quint32 i = 0; i < 256; ++i) {
+      quint32 r = i << 24;
+      for (int j = 0; j < 8; ++j) {
+        r = (r & 0x80000000U) ? (r << 1) ^ 0x04c11db7U : r << 1;
+      }
+      m_table[i] = r;
+    }
+  }
+
+  /**
+   * Calculate checksum of a page.
+   * @param data page data with the checksum field set to zero
+   * @param len length of page
+   * @return checksum.
+   */
+  quint32 checksum(const char* data, int len) const {
+    quint32 crc = 0;
+    for (int i = 0; i < len; ++i) {
+      crc = (crc << 8) ^
+          m_table[((crc >> 24) & 0xff) ^ static_cast<uchar>(data[i])];
+    }
+    return crc;
+  }
+
+private:
+  quint32 m_table[256];
+};
+
+/**
+ * Get the CRC table.
+ * @return table, initialized on first use.
+ */
+const OggCrcTable& crcTable()
+{
+  static const OggCrcTable table;
+  return table;
+}
+
+/**
+ * Get a little endian 32 bit integer.
+ * @param data bytes
+ * @return integer value.
+ */
+quint32 getLe32(const char* data)
+{
+  const uchar* bytes = reinterpret_cast<const uchar*>(data);
+  return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) |
+      (static_cast<quint32>(bytes[3]) << 24);
+}
+
+/**
+ * Set a little endian 32 bit integer.
+ * @param data bytes
+ * @param value integer value
+ */
+void setLe32(char* data, quint32 value)
+{
+  for (int i = 0; i < 4; ++i) {
+    data[i] = static_cast<char>(value & 0xff);
+    value >>= 8;
+  }
+}
+
+/**
+ * Append a little endian 32 bit integer.
+ * @param data bytes
+ * @param value integer value
+ */
+void appendLe32(QByteArray& data, quint32 value)
+{
+  char bytes[4];
+  setLe32(bytes, value);
+  data.append(bytes, 4);
+}
+
+/**
+ * Append the lacing values for a packet.
+ * @param laces lacing values
+ * @param size size of packet
+ */
+void appendLacingValues(QByteArray& laces, int size)
+{
+  for (; size >= 255; size -= 255) {
+    laces.append(static_cast<char>(255));
+  }
+  laces.append(static_cast<char>(size));
+}
+
+/**
+ * Get the size of a packet including its lacing values.
+ * @param size size of packet
+ * @return number of bytes occupied in the pages.
+ */
+qint64 lacedSize(qint64 size)
+{
+  return size + size / 255 + 1;
+}
+
+/**
+ * Set the checksum of a page.
+ * @param page page data
+ * @param len length of page
+ */
+void setChecksum(char* page, int len)
+{
+  setLe32(page + 22, 0);
+  setLe32(page + 22, crcTable().checksum(page, len));
+}
+
+/** Ogg page read from a file. */
+struct OggPage {
+  int flags;                     /**< header type flags */
+  quint32 serialNumber;          /**< stream serial number */
+  quint32 sequenceNumber;        /**< page sequence number */
+  QByteArray laces;              /**< lacing values */
+  QByteArray data;               /**< page data */
+};
+
+/**
+ * Read an Ogg page.
+ * @param file file positioned at the start of a page
+ * @param page the page is returned here
+ * @return true if a complete page was read.
+ */
+bool readPage(QFile& file, OggPage& page)
+{
+  QByteArray header = file.read(PageHeaderSize);
+  if (header.size() != PageHeaderSize || !header.startsWith("OggS") ||
+      header.at(4) != 0)
+    return false;
+
+  page.flags = static_cast<uchar>(header.at(5));
+  page.serialNumber = getLe32(header.constData() + 14);
+  page.sequenceNumber = getLe32(header.constData() + 18);
+  int numLaces = static_cast<uchar>(header.at(26));
+  page.laces = file.read(numLaces);
+  if (page.laces.size() != numLaces)
+    return false;
+
+  int dataSize = 0;
+  for (int i = 0; i < numLaces; ++i) {
+    dataSize += static_cast<uchar>(page.laces.at(i));
+  }
+  page.data = file.read(dataSize);
+  return page.data.size() == dataSize;
+}
+
+}
+
+/**
+ * Constructor.
+ * @param comments comment fields in the form "NAME=value", UTF-8 encoded
+ * @param paddingSize padding in bytes reserved when the file is copied
+ * @param growPadding true to reserve padding as large as the comments
+ */
+OggCommentWriter::OggCommentWriter(const QList<QByteArray>& comments,
+                                   int paddingSize, bool growPadding)
+  : m_comments(comments), m_paddingSize(qMax(paddingSize, 0)),
+    m_growPadding(growPadding), m_headerStart(0), m_headerEnd(0),
+    m_numHeaderPages(0), m_serialNumber(0), m_firstSequenceNumber(0)
+{
+}
+
+/**
+ * Read the header pages of the first logical stream.
+ * @param file file to read
+ * @return true if the stream starts with Vorbis headers which are not
+ *         interleaved with other streams.
+ */
+bool OggCommentWriter::readHeaders(QFile& file)
+{
+  OggPage page;
+  if (!file.seek(0) || !readPage(file, page) ||
+      !(page.flags & BeginOfStreamFlag) ||
+      !page.data.startsWith("\x01vorbis"))
+    return false;
+
+  m_serialNumber = page.serialNumber;
+  m_headerStart = file.pos();
+  m_numHeaderPages = 0;
+
+  // The comment and setup packets, the first audio packet has to start on
+  // a new page.
+  QList<QByteArray> packets;
+  QByteArray packet;
+  while (packets.size() < 2) {
+    if (!readPage(file, page) || page.serialNumber != m_serialNumber ||
+        (page.flags & (BeginOfStreamFlag | EndOfStreamFlag)))
+      return false;
+
+    if (m_numHeaderPages == 0) {
+      if (page.flags & ContinuedFlag)
+        return false;
+      m_firstSequenceNumber = page.sequenceNumber;
+    }
+    ++m_numHeaderPages;
+    int dataPos = 0;
+    for (int i = 0; i < page.laces.size(); ++i) {
+      if (packets.size() == 2)
+        return false;
+      int lace = static_cast<uchar>(page.laces.at(i));
+      packet.append(page.data.constData() + dataPos, lace);
+      dataPos += lace;
+      if (lace < 255) {
+        packets.append(packet);
+        packet.clear();
+      }
+    }
+  }
+  m_headerEnd = file.pos();
+
+  const QByteArray& comment = packets.at(0);
+  if (!comment.startsWith("\x03vorbis") ||
+      !packets.at(1).startsWith("\x05vorbis") || comment.size() < 11)
+    return false;
+
+  quint32 vendorLength = getLe32(comment.constData() + 7);
+  if (vendorLength > static_cast<quint32>(comment.size() - 11))
+    return false;
+
+  m_vendor = comment.mid(11, vendorLength);
+  m_setupPacket = packets.at(1);
+  return true;
+}
+
+/**
+ * Create a comment header packet.
+ * @param size size of packet, if larger than needed, zeros are appended
+ * @return comment packet.
+ */
+QByteArray OggCommentWriter::commentPacket(int size) const
+{
+  QByteArray packet("\x03vorbis", 7);
+  appendLe32(packet, m_vendor.size());
+  packet.append(m_vendor);
+  appendLe32(packet, m_comments.size());
+  foreach (const QByteArray& comment, m_comments) {
+    appendLe32(packet, comment.size());
+    packet.append(comment);
+  }
+  // framing bit
+  packet.append('\x01');
+  if (packet.size() < size) {
+    packet.append(QByteArray(size - packet.size(), '\0'));
+  }
+  return packet;
+}
+
+/**
+ * Create the pages for the comment and setup header packets.
+ * @param comment comment header packet
+ * @param numPages number of pages, each page must get at least one and
+ *                 at most 255 lacing values
+ * @return pages.
+ */
+QByteArray OggCommentWriter::paginate(const QByteArray& comment,
+                                      int numPages) const
+{
+  QByteArray laces;
+  appendLacingValues(laces, comment.size());
+  appendLacingValues(laces, m_setupPacket.size());
+  const QByteArray data = comment + m_setupPacket;
+
+  QByteArray pages;
+  int lacePos = 0;
+  int dataPos = 0;
+  bool continued = false;
+  for (int pageNr = 0; pageNr < numPages; ++pageNr) {
+    int numLaces = qMin(MaxLacingValues,
+                        laces.size() - lacePos - (numPages - pageNr - 1));
+    int dataSize = 0;
+    bool packetEnds = false;
+    for (int i = lacePos; i < lacePos + numLaces; ++i) {
+      int lace = static_cast<uchar>(laces.at(i));
+      dataSize += lace;
+      if (lace < 255) {
+        packetEnds = true;
+      }
+    }
+
+    QByteArray page("OggS", 4);
+    page.append('\0');
+    page.append(static_cast<char>(continued ? ContinuedFlag : 0));
+    // The granule position of header pages is 0, -1 if no packet ends.
+    page.append(QByteArray(8, packetEnds ? '\0' : '\xff'));
+    appendLe32(page, m_serialNumber);
+    appendLe32(page, m_firstSequenceNumber + pageNr);
+    appendLe32(page, 0);
+    page.append(static_cast<char>(numLaces));
+    page.append(laces.constData() + lacePos, numLaces);
+    page.append(data.constData() + dataPos, dataSize);
+    setChecksum(page.data(), page.size());
+    pages.append(page);
+
+    lacePos += numLaces;
+    dataPos += dataSize;
+    continued = static_cast<uchar>(laces.at(lacePos - 1)) == 255;
+  }
+  return pages;
+}
+
+/**
+ * Overwrite the header pages of a file if the comments fit.
+ * @param file file opened for reading and writing
+ * @return WrittenInPlace, NotHandled if the comments do not fit or the
+ *         stream is not supported, Failed if writing failed.
+ */
+OggCommentWriter::Result OggCommentWriter::writeInPlace(QFile& file)
+{
+  if (!readHeaders(file))
+    return NotHandled;
+
+  // Bytes available for the comment packet and its lacing values.
+  const qint64 available = m_headerEnd - m_headerStart -
+      PageHeaderSize * m_numHeaderPages - lacedSize(m_setupPacket.size());
+  if (available <= 0)
+    return NotHandled;
+
+  // Find the packet size which exactly fills the available space, this is
+  // not possible if the lacing values grow by two bytes.
+  qint64 size = available - available / 256;
+  while (size > 0 && lacedSize(size) > available) {
+    --size;
+  }
+  while (lacedSize(size) < available) {
+    ++size;
+  }
+  const int numLaces = size / 255 + 1 + m_setupPacket.size() / 255 + 1;
+  if (lacedSize(size) != available ||
+      size < commentPacket(0).size() ||
+      numLaces < m_numHeaderPages ||
+      numLaces > MaxLacingValues * m_numHeaderPages)
+    return NotHandled;
+
+  const QByteArray pages = paginate(commentPacket(size), m_numHeaderPages);
+  if (!file.seek(m_headerStart) || file.write(pages) != pages.size())
+    return Failed;
+  return WrittenInPlace;
+}
+
+/**
+ * Copy a file with new header pages.
+ * @param in file opened for reading
+ * @param out empty file opened for writing
+ * @return Rewritten, NotHandled if the stream is not supported, Failed
+ *         if copying failed.
+ */
+OggCommentWriter::Result OggCommentWriter::copy(QFile& in, QFile& out)
+{
+  if (!readHeaders(in))
+    return NotHandled;
+
+  int size = commentPacket(0).size();
+  int padding = m_paddingSize;
+  if (m_growPadding) {
+    padding = qMax(padding, qMin(size, MaxGrownPadding));
+  }
+  size += padding;
+
+  // Keep the number of header pages if possible, so that the audio pages
+  // can be copied without modification.
+  const int numLaces = size / 255 + 1 + m_setupPacket.size() / 255 + 1;
+  int numPages = (numLaces + MaxLacingValues - 1) / MaxLacingValues;
+  if (numPages < m_numHeaderPages && numLaces >= m_numHeaderPages) {
+    numPages = m_numHeaderPages;
+  }
+
+  const QByteArray pages = paginate(commentPacket(size), numPages);
+  if (!in.seek(0))
+    return Failed;
+  const QByteArray firstPage = in.read(m_headerStart);
+  if (firstPage.size() != m_headerStart ||
+      out.write(firstPage) != firstPage.size() ||
+      out.write(pages) != pages.size())
+    return Failed;
+
+  const bool ok = numPages == m_numHeaderPages
+      ? copyTail(in, out, m_headerEnd)
+      : copyPages(in, out, numPages - m_numHeaderPages);
+  if (!ok)
+    return Failed;
+  OperationProfiler::count(OperationProfiler::FileRewrites);
+  return Rewritten;
+}
+
+/**
+ * Copy the pages after the headers and renumber the pages of the stream.
+ * @param in input file
+ * @param out output file
+ * @param sequenceNumberDelta difference added to the page sequence
+ *                            numbers
+ * @return true if ok.
+ */
+bool OggCommentWriter::copyPages(QFile& in, QFile& out,
+                                 int sequenceNumberDelta) const
+{
+  if (!in.seek(m_headerEnd))
+    return false;
+
+  QByteArray buf;
+  forever {
+    const QByteArray chunk = in.read(CopyBufferSize);
+    buf.append(chunk);
+    char* data = buf.data();
+    int pos = 0;
+    while (buf.size() - pos >= PageHeaderSize) {
+      char* page = data + pos;
+      if (::memcmp(page, "OggS", 4) != 0)
+        return false;
+
+      const int numLaces = static_cast<uchar>(page[26]);
+      if (buf.size() - pos < PageHeaderSize + numLaces)
+        break;
+
+      int pageSize = PageHeaderSize + numLaces;
+      for (int i = 0; i < numLaces; ++i) {
+        pageSize += static_cast<uchar>(page[PageHeaderSize + i]);
+      }
+      if (buf.size() - pos < pageSize)
+        break;
+
+      if (getLe32(page + 14) == m_serialNumber) {
+        setLe32(page + 18, getLe32(page + 18) + sequenceNumberDelta);
+        setChecksum(page, pageSize);
+      }
+      pos += pageSize;
+    }
+    if (out.write(data, pos) != pos)
+      return false;
+
+    buf.remove(0, pos);
+    if (chunk.isEmpty()) {
+      // Copy incomplete trailing data as it is.
+      return out.write(buf) == buf.size();
+    }
+  }
+}
+
+/**
+ * Copy the rest of a file unchanged.
+ * @param in input file
+ * @param out output file
+ * @param pos position in input file
+ * @return true if ok.
+ */
+bool OggCommentWriter::copyTail(QFile& in, QFile& out, qint64 pos)
+{
+  if (!out.flush())
+    return false;
+
+  qint64 outPos = out.pos();
+  qint64 remaining = in.size() - pos;
+#ifdef Q_OS_LINUX
+  // Let the kernel copy the data without transferring it to user space.
+  const int inFd = in.handle();
+  const int outFd = out.handle();
+#ifdef SYS_copy_file_range
+  loff_t inOffset = pos;
+  while (remaining > 0) {
+    ssize_t len = ::syscall(SYS_copy_file_range, inFd, &inOffset, outFd,
+                            static_cast<loff_t*>(0),
+                            static_cast<size_t>(remaining), 0U);
+    if (len <= 0)
+      break;
+    remaining -= len;
+    pos += len;
+    outPos += len;
+  }
+#endif
+  off_t offset = pos;
+  while (remaining > 0) {
+    ssize_t len = ::sendfile(outFd, inFd, &offset,
+                             static_cast<size_t>(remaining));
+    if (len <= 0)
+      break;
+    remaining -= len;
+    pos += len;
+    outPos += len;
+  }
+  if (remaining == 0)
+    return true;
+#endif
+
+  // The file position of out has been changed outside QFile.
+  if (!in.seek(pos) || !out.seek(outPos))
+    return false;
+  while (remaining > 0) {
+    const QByteArray buf = in.read(qMin<qint64>(remaining, CopyBufferSize));
+    if (buf.isEmpty() || out.write(buf) != buf.size())
+      return false;
+    remaining -= buf.size();
+  }
+  return true;
+}
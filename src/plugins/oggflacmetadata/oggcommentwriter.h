@@ -0,0 +1,139 @@
+/**
+ * \file oggcommentwriter.h
+ * Write Vorbis comments into the header pages of Ogg files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OGGCOMMENTWRITER_H
+#define OGGCOMMENTWRITER_H
+
+#include <QList>
+#include <QByteArray>
+
+class QFile;
+
+/**
+ * Writes the Vorbis comment header of an Ogg/Vorbis file.
+ *
+ * Only the pages containing the comment and setup headers are touched.
+ * If the new comment header fits into these pages, they are overwritten
+ * in place, the remaining space is used as padding after the framing bit
+ * of the comment packet, which is ignored by decoders. Otherwise the file
+ * is copied with new header pages, the audio pages are copied unchanged
+ * using zero-copy I/O if the number of header pages does not change, else
+ * they are renumbered.
+ */
+class OggCommentWriter {
+public:
+  /** Result of a write operation. */
+  enum Result {
+    NotHandled,     /**< stream not supported, has to be written by vcedit */
+    WrittenInPlace, /**< header pages overwritten */
+    Rewritten,      /**< file copied with new header pages */
+    Failed          /**< file could not be written */
+  };
+
+  /**
+   * Constructor.
+   * @param comments comment fields in the form "NAME=value", UTF-8 encoded
+   * @param paddingSize padding in bytes reserved when the file is copied
+   * @param growPadding true to reserve padding as large as the comments
+   */
+  OggCommentWriter(const QList<QByteArray>& comments, int paddingSize,
+                   bool growPadding);
+
+  /**
+   * Overwrite the header pages of a file if the comments fit.
+   * @param file file opened for reading and writing
+   * @return WrittenInPlace, NotHandled if the comments do not fit or the
+   *         stream is not supported, Failed if writing failed.
+   */
+  Result writeInPlace(QFile& file);
+
+  /**
+   * Copy a file with new header pages.
+   * @param in file opened for reading
+   * @param out empty file opened for writing
+   * @return Rewritten, NotHandled if the stream is not supported, Failed
+   *         if copying failed.
+   */
+  Result copy(QFile& in, QFile& out);
+
+private:
+  /**
+   * Read the header pages of the first logical stream.
+   * @param file file to read
+   * @return true if the stream starts with Vorbis headers which are not
+   *         interleaved with other streams.
+   */
+  bool readHeaders(QFile& file);
+
+  /**
+   * Create a comment header packet.
+   * @param size size of packet, if larger than needed, zeros are appended
+   * @return comment packet.
+   */
+  QByteArray commentPacket(int size) const;
+
+  /**
+   * Create the pages for the comment and setup header packets.
+   * @param comment comment header packet
+   * @param numPages number of pages, each page must get at least one and
+   *                 at most 255 lacing values
+   * @return pages.
+   */
+  QByteArray paginate(const QByteArray& comment, int numPages) const;
+
+  /**
+   * Copy the pages after the headers and renumber the pages of the stream.
+   * @param in input file
+   * @param out output file
+   * @param sequenceNumberDelta difference added to the page sequence
+   *                            numbers
+   * @return true if ok.
+   */
+  bool copyPages(QFile& in, QFile& out, int sequenceNumberDelta) const;
+
+  /**
+   * Copy the rest of a file unchanged.
+   * @param in input file
+   * @param out output file
+   * @param pos position in input file
+   * @return true if ok.
+   */
+  static bool copyTail(QFile& in, QFile& out, qint64 pos);
+
+  QList<QByteArray> m_comments;
+  int m_paddingSize;
+  bool m_growPadding;
+
+  QByteArray m_vendor;
+  QByteArray m_setupPacket;
+  qint64 m_headerStart;
+  qint64 m_headerEnd;
+  int m_numHeaderPages;
+  quint32 m_serialNumber;
+  quint32 m_firstSequenceNumber;
+};
+
+#endif // OGGCOMMENTWRITER_H
@@ -34,9 +34,11 @@
 #ifdef HAVE_VORBIS
 #include <vorbis/vorbisfile.h>
 #include "vcedit.h"
+#include "oggcommentwriter.h"
 #endif
 #include "pictureframe.h"
 #include "tagconfig.h"
+#include "operationprofiler.h"
 
 namespace {
 
@@ -239,6 +241,7 @@ void OggFile::readTags(bool force)
 bool OggFile::writeTags(bool force, bool* renamed, bool preserve)
 {
   QString dirname = getDirname();
+  setFileRewritten(false);
   if (isChanged() &&
     !QFileInfo(currentFilePath()).isWritable()) {
     revertChangedFilename();
@@ -246,6 +249,52 @@ bool OggFile::writeTags(bool force, bool* renamed, bool preserve)
   }
 
   if (m_fileRead && (force || isTagChanged(Frame::Tag_2))) {
+    QList<QByteArray> fields;
+    CommentList::iterator it = m_comments.begin();
+    while (it != m_comments.end()) {
+      QString name((*it).getName());
+      QString value((*it).getValue());
+      if (!value.isEmpty()) {
+        fields.append(name.toLatin1() + '=' + value.toUtf8());
+        ++it;
+      } else {
+        it = m_comments.erase(it);
+      }
+    }
+    const TagConfig& tagCfg = TagConfig::instance();
+    OggCommentWriter commentWriter(fields, tagCfg.tagPaddingSize(),
+                                   tagCfg.growTagPaddingOnce());
+
+    // First try to overwrite only the header pages.
+    QString fnStr(currentFilePath());
+    quint64 actime = 0, modtime = 0;
+    if (preserve) {
+      getFileTimeStamps(fnStr, actime, modtime);
+    }
+    OggCommentWriter::Result result = OggCommentWriter::NotHandled;
+    QFile file(fnStr);
+    if (file.open(QIODevice::ReadWrite)) {
+      result = commentWriter.writeInPlace(file);
+      file.close();
+    }
+    if (result == OggCommentWriter::Failed) {
+      return false;
+    }
+    if (result == OggCommentWriter::WrittenInPlace) {
+      if (actime || modtime) {
+        setFileTimeStamps(fnStr, actime, modtime);
+      }
+      markTagUnchanged(Frame::Tag_2);
+      if (isFilenameChanged()) {
+        if (!renameFile(currentFilename(), getFilename())) {
+          return false;
+        }
+        markFilenameUnchanged();
+        *renamed = true;
+      }
+      return true;
+    }
+
     bool writeOk = false;
     // we have to rename the original file and delete it afterwards
     QString filename = currentFilename();
@@ -257,42 +306,37 @@ bool OggFile::writeTags(bool force, bool* renamed, bool preserve)
     QString fnOut = dirname + QDir::separator() + getFilename();
     QFile fpIn(fnIn);
     if (fpIn.open(QIODevice::ReadOnly)) {
-
-      // store time stamp if it has to be preserved
-      quint64 actime = 0, modtime = 0;
-      if (preserve) {
-        getFileTimeStamps(fnIn, actime, modtime);
-      }
-
       QFile fpOut(fnOut);
       if (fpOut.open(QIODevice::WriteOnly)) {
-        vcedit_state* state = ::vcedit_new_state();
-        if (state) {
-          if (::vcedit_open_callbacks(state, &fpIn, oggread, oggwrite) >= 0) {
-            vorbis_comment* vc = ::vcedit_comments(state);
-            if (vc) {
-              ::vorbis_comment_clear(vc);
-              ::vorbis_comment_init(vc);
-              CommentList::iterator it = m_comments.begin();
-              while (it != m_comments.end()) {
-                QString name((*it).getName());
-                QString value((*it).getValue());
-                if (!value.isEmpty()) {
+        if (commentWriter.copy(fpIn, fpOut) == OggCommentWriter::Rewritten) {
+          writeOk = true;
+          setFileRewritten(true);
+        } else if (fpIn.seek(0) && fpOut.resize(0) && fpOut.seek(0)) {
+          // Stream not supported by the comment writer, use vcedit.
+          vcedit_state* state = ::vcedit_new_state();
+          if (state) {
+            if (::vcedit_open_callbacks(state, &fpIn,
+                                        oggread, oggwrite) >= 0) {
+              vorbis_comment* vc = ::vcedit_comments(state);
+              if (vc) {
+                ::vorbis_comment_clear(vc);
+                ::vorbis_comment_init(vc);
+                foreach (const CommentField& field, m_comments) {
                   ::vorbis_comment_add_tag(
                     vc,
-                    const_cast<char*>(name.toLatin1().data()),
-                    const_cast<char*>((const char*)value.toUtf8().data()));
-                  ++it;
-                } else {
-                  it = m_comments.erase(it);
+                    const_cast<char*>(field.getName().toLatin1().data()),
+                    const_cast<char*>(
+                      (const char*)field.getValue().toUtf8().data()));
+                }
+                if (::vcedit_write(state, &fpOut) >= 0) {
+                  writeOk = true;
+                  setFileRewritten(true);
+                  OperationProfiler::count(OperationProfiler::FileRewrites);
                 }
-              }
-              if (::vcedit_write(state, &fpOut) >= 0) {
-                writeOk = true;
               }
             }
+            ::vcedit_clear(state);
           }
-          ::vcedit_clear(state);
         }
         fpOut.close();
       }
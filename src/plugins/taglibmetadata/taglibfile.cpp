@@ -31,9 +31,13 @@
 #include <QByteArray>
 #include <QImage>
 #include <QVarLengthArray>
+#include <QScopedPointer>
 #include "genres.h"
 #include "attributedata.h"
 #include "pictureframe.h"
+#include "picturestore.h"
+#include "filehandlepool.h"
+#include "taglibpaddingwriter.h"
 
 // Just using include <oggfile.h>, include <flacfile.h> as recommended in the
 // TagLib documentation does not work, as there are files with these names
@@ -199,7 +203,7 @@ void frameToFlacPicture(const Frame& frame, TagLib::FLAC::Picture* pic)
   pic->setType(static_cast<TagLib::FLAC::Picture::Type>(pictureType));
   pic->setMimeType(toTString(mimeType));
   pic->setDescription(toTString(description));
-  pic->setData(TagLib::ByteVector(data.data(), data.size()));
+  pic->setData(TagLib::ByteVector(data.constData(), data.size()));
   if (!imgProps.isValidForImage(data)) {
     imgProps = PictureFrame::ImageProperties(data);
   }
@@ -222,8 +226,9 @@ public:
   /**
    * Constructor.
    * @param stream stream to open
+   * @param readProperties true to read audio properties
    */
-  explicit WavFile(TagLib::IOStream *stream);
+  explicit WavFile(TagLib::IOStream *stream, bool readProperties = true);
 
   /**
    * Destructor.
@@ -238,7 +243,8 @@ public:
   void changeToLowercaseId3Chunk();
 };
 
-WavFile::WavFile(TagLib::IOStream *stream) : TagLib::RIFF::WAV::File(stream)
+WavFile::WavFile(TagLib::IOStream *stream, bool readProperties) :
+  TagLib::RIFF::WAV::File(stream, readProperties)
 {
 }
 
@@ -273,9 +279,10 @@ void WavFile::changeToLowercaseId3Chunk()
  *
  * Using streams, closing the file descriptor is also possible for modified
  * files because the TagLib file does not have to be deleted just to close the
- * file descriptor.
+ * file descriptor. The open file descriptors are limited by the
+ * FileHandlePool.
  */
-class FileIOStream : public TagLib::IOStream {
+class FileIOStream : public TagLib::IOStream, public FileHandlePool::Client {
 public:
   /**
    * Constructor.
@@ -314,9 +321,20 @@ public:
    * TagLib::FileRef::create() adapted for IOStream.
    * @param stream stream with name() of which the extension is used to decduce
    * the file type
+   * @param readProperties true to read audio properties, false to defer
+   * them for formats where TagLibFile::makeAudioPropertiesRead() can build
+   * them from the open file (MPEG, Vorbis, Speex, Opus), the properties of
+   * all other formats are always read
    * @return file, 0 if not supported.
    */
-  static TagLib::File* create(IOStream* stream);
+  static TagLib::File* create(IOStream* stream, bool readProperties = true);
+
+protected:
+  /**
+   * Close the file handle because the file handle pool is full.
+   * @return true.
+   */
+  virtual bool releaseFileHandle();
 
 private:
   /**
@@ -326,21 +344,6 @@ private:
    */
   bool openFileHandle() const;
 
-  /**
-   * Register open files, so that the number of open files can be limited.
-   * If the number of open files exceeds a limit, files are closed.
-   *
-   * @param stream new open file to be registered
-   */
-  static void registerOpenFile(FileIOStream* stream);
-
-  /**
-   * Deregister open file.
-   *
-   * @param stream file which is no longer open
-   */
-  static void deregisterOpenFile(FileIOStream* stream);
-
 #ifdef Q_OS_WIN32
   wchar_t* m_fileName;
 #else
@@ -348,13 +351,8 @@ private:
 #endif
   TagLib::FileStream* m_fileStream;
   long m_offset;
-
-  /** list of file streams with open file descriptor */
-  static QList<FileIOStream*> s_openFiles;
 };
 
-QList<FileIOStream*> FileIOStream::s_openFiles;
-
 FileIOStream::FileIOStream(const QString& fileName) :
   m_fileStream(0), m_offset(0)
 {
@@ -372,7 +370,7 @@ FileIOStream::FileIOStream(const QString& fileName) :
 
 FileIOStream::~FileIOStream()
 {
-  deregisterOpenFile(this);
+  FileHandlePool::instance().remove(this);
   delete m_fileStream;
   delete [] m_fileName;
 }
@@ -391,8 +389,8 @@ bool FileIOStream::openFileHandle() const
     if (m_offset > 0) {
       m_fileStream->seek(m_offset);
     }
-    registerOpenFile(self);
   }
+  FileHandlePool::instance().touch(const_cast<FileIOStream*>(this));
   return true;
 }
 
@@ -402,10 +400,16 @@ void FileIOStream::closeFileHandle()
     m_offset = m_fileStream->tell();
     delete m_fileStream;
     m_fileStream = 0;
-    deregisterOpenFile(this);
+    FileHandlePool::instance().remove(this);
   }
 }
 
+bool FileIOStream::releaseFileHandle()
+{
+  closeFileHandle();
+  return true;
+}
+
 TagLib::FileName FileIOStream::name() const
 {
   if (m_fileStream) {
@@ -497,7 +501,8 @@ void FileIOStream::truncate(long length)
   }
 }
 
-TagLib::File* FileIOStream::create(TagLib::IOStream* stream)
+TagLib::File* FileIOStream::create(TagLib::IOStream* stream,
+                                   bool readProperties)
 {
 #ifdef Q_OS_WIN32
   TagLib::String fn = stream->name().toString();
@@ -509,99 +514,73 @@ TagLib::File* FileIOStream::create(TagLib::IOStream* stream)
     TagLib::String ext = fn.substr(extPos + 1).upper();
     if (ext == "MP3" || ext == "MP2" || ext == "AAC")
       return new TagLib::MPEG::File(stream,
-                                    TagLib::ID3v2::FrameFactory::instance());
+                                    TagLib::ID3v2::FrameFactory::instance(),
+                                    readProperties);
     if (ext == "OGG") {
-      TagLib::File* file = new TagLib::Vorbis::File(stream);
+      TagLib::File* file = new TagLib::Vorbis::File(stream, readProperties);
       if (!file->isValid()) {
         delete file;
-        file = new TagLib::Ogg::FLAC::File(stream);
+        file = new TagLib::Ogg::FLAC::File(stream, true);
       }
       return file;
     }
     if (ext == "OGA") {
-      TagLib::File* file = new TagLib::Ogg::FLAC::File(stream);
+      TagLib::File* file = new TagLib::Ogg::FLAC::File(stream, true);
       if (!file->isValid()) {
         delete file;
-        file = new TagLib::Vorbis::File(stream);
+        file = new TagLib::Vorbis::File(stream, readProperties);
       }
       return file;
     }
     if (ext == "FLAC")
       return new TagLib::FLAC::File(stream,
-                                    TagLib::ID3v2::FrameFactory::instance());
+                                    TagLib::ID3v2::FrameFactory::instance(),
+                                    true);
     if (ext == "MPC")
-      return new TagLib::MPC::File(stream);
+      return new TagLib::MPC::File(stream, true);
     if (ext == "WV")
-      return new TagLib::WavPack::File(stream);
+      return new TagLib::WavPack::File(stream, true);
     if (ext == "SPX")
-      return new TagLib::Ogg::Speex::File(stream);
+      return new TagLib::Ogg::Speex::File(stream, readProperties);
 #if TAGLIB_VERSION >= 0x010900
     if (ext == "OPUS")
-      return new TagLib::Ogg::Opus::File(stream);
+      return new TagLib::Ogg::Opus::File(stream, readProperties);
 #endif
     if (ext == "TTA")
-      return new TagLib::TrueAudio::File(stream);
+      return new TagLib::TrueAudio::File(stream, true);
     if (ext == "M4A" || ext == "M4R" || ext == "M4B" || ext == "M4P" ||
         ext == "MP4" || ext == "3G2" || ext == "M4V" || ext == "MP4V")
-      return new TagLib::MP4::File(stream);
+      return new TagLib::MP4::File(stream, true);
     if (ext == "WMA" || ext == "ASF")
-      return new TagLib::ASF::File(stream);
+      return new TagLib::ASF::File(stream, true);
     if (ext == "AIF" || ext == "AIFF")
-      return new TagLib::RIFF::AIFF::File(stream);
+      return new TagLib::RIFF::AIFF::File(stream, true);
     if (ext == "WAV")
 #if TAGLIB_VERSION >= 0x010900
-      return new WavFile(stream);
+      return new WavFile(stream, true);
 #else
-      return new TagLib::RIFF::WAV::File(stream);
+      return new TagLib::RIFF::WAV::File(stream, true);
 #endif
     if (ext == "APE")
-      return new TagLib::APE::File(stream);
+      return new TagLib::APE::File(stream, true);
     if (ext == "MOD" || ext == "MODULE" || ext == "NST" || ext == "WOW")
-      return new TagLib::Mod::File(stream);
+      return new TagLib::Mod::File(stream, true);
     if (ext == "S3M")
-      return new TagLib::S3M::File(stream);
+      return new TagLib::S3M::File(stream, true);
     if (ext == "IT")
-      return new TagLib::IT::File(stream);
+      return new TagLib::IT::File(stream, true);
 #ifdef HAVE_TAGLIB_XM_SUPPORT
     if (ext == "XM")
-      return new TagLib::XM::File(stream);
+      return new TagLib::XM::File(stream, true);
 #endif
 #if TAGLIB_VERSION >= 0x010901
     if (ext == "DSF")
-      return new DSFFile(stream, TagLib::ID3v2::FrameFactory::instance());
+      return new DSFFile(stream, TagLib::ID3v2::FrameFactory::instance(),
+                         true);
 #endif
   }
   return 0;
 }
-
-void FileIOStream::registerOpenFile(FileIOStream* stream)
-{
-  if (s_openFiles.contains(stream))
-    return;
-
-  int numberOfFilesToClose = s_openFiles.size() - 15;
-  if (numberOfFilesToClose > 5) {
-    for (QList<FileIOStream*>::iterator it = s_openFiles.begin();
-         it != s_openFiles.end();
-         ++it) {
-      (*it)->closeFileHandle();
-      if (--numberOfFilesToClose <= 0) {
-        break;
-      }
-    }
-  }
-  s_openFiles.append(stream);
-}
-
-/**
- * Deregister open file.
- *
- * @param stream file which is no longer open
- */
-void FileIOStream::deregisterOpenFile(FileIOStream* stream)
-{
-  s_openFiles.removeAll(stream);
-}
 #endif
 
 /**
@@ -677,8 +656,31 @@ TagLib::ByteVector TextCodecStringHandler::render(const TagLib::String& s) const
 TagLib::String::Type TagLibFile::s_defaultTextEncoding = TagLib::String::Latin1;
 
 #if TAGLIB_VERSION < 0x010800
-/** List of TagLib files with open file descriptor */
-QList<TagLibFile*> TagLibFile::s_openFiles;
+/**
+ * Registration of a TagLib file with an open file descriptor in the
+ * FileHandlePool.
+ */
+class TagLibFile::OpenFileHandle : public FileHandlePool::Client {
+public:
+  /**
+   * Constructor.
+   * @param tagLibFile TagLib file holding the file descriptor
+   */
+  explicit OpenFileHandle(TagLibFile* tagLibFile) : m_tagLibFile(tagLibFile) {}
+
+protected:
+  /**
+   * Close the TagLib file because the file handle pool is full.
+   * @return true if closed, false if the file has changed tags.
+   */
+  virtual bool releaseFileHandle() {
+    m_tagLibFile->closeFile(false);
+    return m_tagLibFile->m_fileRef.isNull();
+  }
+
+private:
+  TagLibFile* m_tagLibFile;
+};
 #endif
 
 
@@ -690,9 +692,12 @@ QList<TagLibFile*> TagLibFile::s_openFiles;
 TagLibFile::TagLibFile(const QPersistentModelIndex& idx) :
   TaggedFile(idx),
   m_tagInformationRead(false), m_fileRead(false),
+  m_audioPropertiesRead(false),
 #if TAGLIB_VERSION >= 0x010800
   m_stream(0),
   m_id3v2Version(0),
+#else
+  m_openFileHandle(new OpenFileHandle(this)),
 #endif
   m_activatedFeatures(0), m_duration(0)
 {
@@ -710,6 +715,9 @@ TagLibFile::TagLibFile(const QPersistentModelIndex& idx) :
 TagLibFile::~TagLibFile()
 {
   closeFile(true);
+#if TAGLIB_VERSION < 0x010800
+  delete m_openFileHandle;
+#endif
 }
 
 /**
@@ -805,7 +813,16 @@ void TagLibFile::readTags(bool force)
 #if TAGLIB_VERSION >= 0x010800
     delete m_stream;
     m_stream = new FileIOStream(fileName);
-    m_fileRef = TagLib::FileRef(FileIOStream::create(m_stream));
+    // Audio properties which can be built from the open file are read on
+    // demand by makeAudioPropertiesRead(), the others are read now.
+    m_fileRef = TagLib::FileRef(FileIOStream::create(m_stream, false));
+    if (TagLib::AudioProperties* audioProperties =
+        m_fileRef.isNull() ? 0 : m_fileRef.audioProperties()) {
+      readAudioProperties(audioProperties);
+      m_audioPropertiesRead = true;
+    } else {
+      m_audioPropertiesRead = false;
+    }
 #else
 #if TAGLIB_VERSION > 0x010400 && defined Q_OS_WIN32
     int fnLen = fileName.length();
@@ -889,16 +906,7 @@ void TagLibFile::readTags(bool force)
       }
 #if TAGLIB_VERSION >= 0x010700
       if (!m_pictures.isRead()) {
-        TagLib::List<TagLib::FLAC::Picture*> pics(flacFile->pictureList());
-        int i = 0;
-        for (TagLib::List<TagLib::FLAC::Picture*>::ConstIterator it =
-             pics.begin(); it != pics.end(); ++it) {
-          PictureFrame frame;
-          flacPictureToFrame(*it, frame);
-          frame.setIndex(i++);
-          m_pictures.append(frame);
-        }
-        m_pictures.setRead(true);
+        m_pictures.setPending(true);
       }
 #endif
 #if TAGLIB_VERSION >= 0x010b00
@@ -1026,20 +1034,9 @@ void TagLibFile::readTags(bool force)
         markTagUnchanged(Frame::Tag_2);
       }
 #if TAGLIB_VERSION >= 0x010b00
-      if (!m_pictures.isRead()) {
-        if (TagLib::Ogg::XiphComment* xiphComment =
-            dynamic_cast<TagLib::Ogg::XiphComment*>(m_tag[Frame::Tag_2])) {
-          TagLib::List<TagLib::FLAC::Picture*> pics(xiphComment->pictureList());
-          int i = 0;
-          for (TagLib::List<TagLib::FLAC::Picture*>::ConstIterator it =
-               pics.begin(); it != pics.end(); ++it) {
-            PictureFrame frame;
-            flacPictureToFrame(*it, frame);
-            frame.setIndex(i++);
-            m_pictures.append(frame);
-          }
-          m_pictures.setRead(true);
-        }
+      if (!m_pictures.isRead() &&
+          dynamic_cast<TagLib::Ogg::XiphComment*>(m_tag[Frame::Tag_2])) {
+        m_pictures.setPending(true);
       }
 #endif
     }
@@ -1051,7 +1048,10 @@ void TagLibFile::readTags(bool force)
     m_hasTag[tagNr] = m_tag[tagNr] && !m_tag[tagNr]->isEmpty();
     m_tagFormat[tagNr] = getTagFormat(m_tag[tagNr], m_tagType[tagNr]);
   }
-  readAudioProperties();
+#if TAGLIB_VERSION < 0x010800
+  readAudioProperties(m_fileRef.isNull() ? 0 : m_fileRef.audioProperties());
+  m_audioPropertiesRead = true;
+#endif
 
   if (force) {
     setFilename(currentFilename());
@@ -1158,6 +1158,7 @@ bool TagLibFile::writeTags(bool force, bool* renamed, bool preserve,
                            int id3v2Version)
 {
   QString fnStr(currentFilePath());
+  setFileRewritten(false);
   if (isChanged() && !QFileInfo(fnStr).isWritable()) {
 #if TAGLIB_VERSION >= 0x010800
     closeFile(false);
@@ -1200,14 +1201,46 @@ bool TagLibFile::writeTags(bool force, bool* renamed, bool preserve,
 #else
         Q_UNUSED(id3v2Version);
 #endif
-        if (mpegFile->save(saveMask, false
+        // The ID3v2 tag is written after the other tags using the reserved
+        // padding, moving the audio data would invalidate the positions of
+        // the tags at the end of the file known by TagLib.
+        int taglibSaveMask = saveMask;
+        TagLib::ID3v2::Tag* id3v2Tag = mpegFile->ID3v2Tag();
+#if TAGLIB_VERSION >= 0x010800
+        if ((saveMask & TagLib::MPEG::File::ID3v2) && id3v2Tag) {
+          taglibSaveMask &= ~TagLib::MPEG::File::ID3v2;
+        }
+#endif
+        bool saved = taglibSaveMask == 0 ||
+            mpegFile->save(taglibSaveMask, false
 #if TAGLIB_VERSION >= 0x010800
                            , m_id3v2Version
 #endif
 #if TAGLIB_VERSION >= 0x010900
                            , false
 #endif
-                           )) {
+                           );
+        if (saved && taglibSaveMask != saveMask) {
+          const TagConfig& tagCfg = TagConfig::instance();
+          TagLibPaddingWriter::Result result =
+              TagLibPaddingWriter(mpegFile, tagCfg.tagPaddingSize(),
+                                  tagCfg.growTagPaddingOnce())
+              .writeId3v2Tag(id3v2Tag, m_id3v2Version);
+          if (result == TagLibPaddingWriter::NotHandled) {
+            saved = mpegFile->save(TagLib::MPEG::File::ID3v2, false
+#if TAGLIB_VERSION >= 0x010800
+                                   , m_id3v2Version
+#endif
+#if TAGLIB_VERSION >= 0x010900
+                                   , false
+#endif
+                                   );
+          } else {
+            saved = result != TagLibPaddingWriter::Failed;
+            setFileRewritten(result == TagLibPaddingWriter::Rewritten);
+          }
+        }
+        if (saved) {
           fileChanged = true;
           FOR_TAGLIB_TAGS(tagNr) {
             if (saveMask & tagTypes[tagNr]) {
@@ -1316,11 +1349,37 @@ bool TagLibFile::writeTags(bool force, bool* renamed, bool preserve,
             }
           }
 #endif
-          flacFile->removePictures();
-          foreach (const Frame& frame, m_pictures) {
-            TagLib::FLAC::Picture* pic = new TagLib::FLAC::Picture;
-            frameToFlacPicture(frame, pic);
-            flacFile->addPicture(pic);
+          // Pictures which have not been read have not been changed.
+          if (m_pictures.isRead()) {
+            flacFile->removePictures();
+            foreach (const Frame& frame, m_pictures) {
+              TagLib::FLAC::Picture* pic = new TagLib::FLAC::Picture;
+              frameToFlacPicture(frame, pic);
+              flacFile->addPicture(pic);
+            }
+          }
+          // The metadata blocks are written using the reserved padding if
+          // no ID3 tags have to be written.
+          if (!(m_tag[Frame::Tag_1] &&
+                (force || isTagChanged(Frame::Tag_1))) &&
+              !(m_tag[Frame::Tag_3] &&
+                (force || isTagChanged(Frame::Tag_3))) &&
+              !fileChanged) {
+            const TagConfig& tagCfg = TagConfig::instance();
+            TagLibPaddingWriter::Result result =
+                TagLibPaddingWriter(flacFile, tagCfg.tagPaddingSize(),
+                                    tagCfg.growTagPaddingOnce())
+                .writeFlacMetadata(flacFile);
+            if (result != TagLibPaddingWriter::NotHandled) {
+              if (result != TagLibPaddingWriter::Failed) {
+                fileChanged = true;
+                setFileRewritten(result == TagLibPaddingWriter::Rewritten);
+                FOR_TAGLIB_TAGS(tagNr) {
+                  markTagUnchanged(tagNr);
+                }
+              }
+              needsSave = false;
+            }
           }
         }
 #endif
@@ -1360,11 +1419,13 @@ bool TagLibFile::writeTags(bool force, bool* renamed, bool preserve,
 #if TAGLIB_VERSION >= 0x010b00
         else if (TagLib::Ogg::XiphComment* xiphComment =
                  dynamic_cast<TagLib::Ogg::XiphComment*>(m_tag[Frame::Tag_2])) {
-          xiphComment->removeAllPictures();
-          foreach (const Frame& frame, m_pictures) {
-            TagLib::FLAC::Picture* pic = new TagLib::FLAC::Picture;
-            frameToFlacPicture(frame, pic);
-            xiphComment->addPicture(pic);
+          if (m_pictures.isRead()) {
+            xiphComment->removeAllPictures();
+            foreach (const Frame& frame, m_pictures) {
+              TagLib::FLAC::Picture* pic = new TagLib::FLAC::Picture;
+              frameToFlacPicture(frame, pic);
+              xiphComment->addPicture(pic);
+            }
           }
         }
 #endif
@@ -1671,17 +1732,121 @@ bool TagLibFile::hasTag(Frame::TagNumber tagNr) const
  */
 void TagLibFile::getDetailInfo(DetailInfo& info) const
 {
+  makeAudioPropertiesRead();
   info = m_detailInfo;
 }
 
+/**
+ * Check if technical detail information is available without reading
+ * more of the file.
+ *
+ * @return true if the audio properties have been read.
+ */
+bool TagLibFile::isDetailInfoRead() const
+{
+  return m_audioPropertiesRead;
+}
+
+/**
+ * Check if the pictures are available without reading more of the file.
+ *
+ * @return false if pictures of FLAC files or Xiph comments have not yet
+ * been converted to frames.
+ */
+bool TagLibFile::arePicturesRead() const
+{
+#if TAGLIB_VERSION >= 0x010700
+  return !m_pictures.isPending();
+#else
+  return true;
+#endif
+}
+
+/**
+ * Make sure that the audio properties are read.
+ * MPEG, Vorbis, Speex and Opus files are read without audio properties
+ * because determining them can require scanning the whole file. They are
+ * built from the already open file when the detail information is requested
+ * for the first time. This only uses the original stream headers (first
+ * MPEG frame, identification packet), so modified tags do not matter.
+ */
+void TagLibFile::makeAudioPropertiesRead() const
+{
+  if (m_audioPropertiesRead || !m_tagInformationRead)
+    return;
+
+  TagLibFile* self = const_cast<TagLibFile*>(this);
+#if TAGLIB_VERSION >= 0x010800
+  makeFileOpen();
+  if (m_audioPropertiesRead)
+    return;
+
+  QScopedPointer<TagLib::AudioProperties> audioProperties;
+  TagLib::File* file = m_fileRef.isNull() ? 0 : m_fileRef.file();
+  if (TagLib::MPEG::File* mpegFile = dynamic_cast<TagLib::MPEG::File*>(file)) {
+    audioProperties.reset(new TagLib::MPEG::Properties(mpegFile));
+  } else if (TagLib::Vorbis::File* oggFile =
+             dynamic_cast<TagLib::Vorbis::File*>(file)) {
+    audioProperties.reset(new TagLib::Vorbis::Properties(oggFile));
+  } else if (TagLib::Ogg::Speex::File* speexFile =
+             dynamic_cast<TagLib::Ogg::Speex::File*>(file)) {
+    audioProperties.reset(new TagLib::Ogg::Speex::Properties(speexFile));
+#if TAGLIB_VERSION >= 0x010900
+  } else if (TagLib::Ogg::Opus::File* opusFile =
+             dynamic_cast<TagLib::Ogg::Opus::File*>(file)) {
+    audioProperties.reset(new TagLib::Ogg::Opus::Properties(opusFile));
+#endif
+  }
+  self->readAudioProperties(audioProperties.data());
+#endif
+  self->m_audioPropertiesRead = true;
+}
+
+#if TAGLIB_VERSION >= 0x010700
+/**
+ * Make sure that the pictures of a picture list are read.
+ * Pictures of FLAC files and Xiph comments are only converted to frames
+ * when they are accessed for the first time.
+ *
+ * @return true if the file has a picture list, i.e. m_pictures is used.
+ */
+bool TagLibFile::readPictures()
+{
+  if (m_pictures.isPending()) {
+    makeFileOpen();
+    TagLib::List<TagLib::FLAC::Picture*> pics;
+    if (TagLib::FLAC::File* flacFile =
+        dynamic_cast<TagLib::FLAC::File*>(m_fileRef.file())) {
+      pics = flacFile->pictureList();
+    }
+#if TAGLIB_VERSION >= 0x010b00
+    else if (TagLib::Ogg::XiphComment* xiphComment =
+             dynamic_cast<TagLib::Ogg::XiphComment*>(m_tag[Frame::Tag_2])) {
+      pics = xiphComment->pictureList();
+    }
+#endif
+    int i = 0;
+    for (TagLib::List<TagLib::FLAC::Picture*>::ConstIterator it =
+         pics.begin(); it != pics.end(); ++it) {
+      PictureFrame frame;
+      flacPictureToFrame(*it, frame);
+      frame.setIndex(i++);
+      m_pictures.append(frame);
+    }
+    m_pictures.setRead(true);
+  }
+  return m_pictures.isRead();
+}
+#endif
+
 /**
  * Cache technical detail information.
+ *
+ * @param audioProperties audio properties of TagLib file, 0 if not available
  */
-void TagLibFile::readAudioProperties()
+void TagLibFile::readAudioProperties(TagLib::AudioProperties* audioProperties)
 {
-  TagLib::AudioProperties* audioProperties;
-  if (!m_fileRef.isNull() &&
-      (audioProperties = m_fileRef.audioProperties()) != 0) {
+  if (audioProperties) {
     TagLib::MPEG::Properties* mpegProperties;
     TagLib::Ogg::Speex::Properties* speexProperties;
     TagLib::TrueAudio::Properties* ttaProperties;
@@ -1903,6 +2068,7 @@ void TagLibFile::setId3v2VersionOrDefault(int id3v2Version)
  */
 unsigned TagLibFile::getDuration() const
 {
+  makeAudioPropertiesRead();
   return m_detailInfo.valid ? m_detailInfo.duration : 0;
 }
 
@@ -2170,17 +2336,26 @@ static void getTypeStringForFrameId(TagLib::ByteVector id, Frame::Type& type,
  */
 static const char* getStringForType(Frame::Type type)
 {
-  if (type != Frame::FT_Other) {
-    for (unsigned i = 0;
-         i < sizeof(typeStrOfId) / sizeof(typeStrOfId[0]);
-         ++i) {
-      const TypeStrOfId& ts = typeStrOfId[i];
-      if (ts.type == type) {
-        return ts.str;
+  /** Descriptions indexed by frame type, built on first use. */
+  static const struct StrOfType {
+    StrOfType() {
+      for (int i = 0; i <= Frame::FT_LastFrame; ++i) {
+        str[i] = "????";
+      }
+      // Iterate backwards, so that the first entry of a type is used.
+      for (int i = sizeof(typeStrOfId) / sizeof(typeStrOfId[0]) - 1;
+           i >= 0;
+           --i) {
+        const TypeStrOfId& ts = typeStrOfId[i];
+        if (ts.type <= Frame::FT_LastFrame) {
+          str[ts.type] = ts.str;
+        }
       }
     }
-  }
-  return "????";
+    const char* str[Frame::FT_LastFrame + 1];
+  } strOfType;
+  return type >= Frame::FT_FirstFrame && type <= Frame::FT_LastFrame
+      ? strOfType.str[type] : "????";
 }
 
 /**
@@ -2267,7 +2442,7 @@ static QString getFieldsFromApicFrame(
   TagLib::ByteVector pic = apicFrame->picture();
   QByteArray ba;
   ba = QByteArray(pic.data(), pic.size());
-  field.m_value = ba;
+  field.m_value = PictureStore::instance().intern(ba);
   fields.push_back(field);
 
   return text;
@@ -3177,7 +3352,7 @@ template <>
 void setData(TagLib::ID3v2::AttachedPictureFrame* f, const Frame::Field& fld)
 {
   QByteArray ba(fld.m_value.toByteArray());
-  f->setPicture(TagLib::ByteVector(ba.data(), ba.size()));
+  f->setPicture(TagLib::ByteVector(ba.constData(), ba.size()));
 }
 
 template <>
@@ -4423,8 +4598,8 @@ static TagLib::MP4::Item getMp4ItemForFrame(const Frame& frame, TagLib::String&
           format = TagLib::MP4::CoverArt::PNG;
         }
       }
-      TagLib::MP4::CoverArt coverArt(format,
-                                     TagLib::ByteVector(ba.data(), ba.size()));
+      TagLib::MP4::CoverArt coverArt(
+            format, TagLib::ByteVector(ba.constData(), ba.size()));
       TagLib::MP4::CoverArtList coverArtList;
       coverArtList.append(coverArt);
       return TagLib::MP4::Item(coverArtList);
@@ -4677,7 +4852,7 @@ static void renderAsfPicture(const Frame& frame, TagLib::ASF::Picture& picture)
   picture.setMimeType(toTString(mimeType));
   picture.setType(static_cast<TagLib::ASF::Picture::Type>(pictureType));
   picture.setDescription(toTString(description));
-  picture.setPicture(TagLib::ByteVector(data.data(), data.size()));
+  picture.setPicture(TagLib::ByteVector(data.constData(), data.size()));
 }
 #elif TAGLIB_VERSION >= 0x010602
 /**
@@ -4759,7 +4934,7 @@ static void renderAsfPicture(const Frame& frame, TagLib::ByteVector& data)
   data.append(TagLib::ByteVector(2, 0));
   data.append(toTString(description).data(TagLib::String::UTF16LE));
   data.append(TagLib::ByteVector(2, 0));
-  data.append(TagLib::ByteVector(picture.data(), picture.size()));
+  data.append(TagLib::ByteVector(picture.constData(), picture.size()));
 }
 #endif
 
@@ -5118,7 +5293,7 @@ bool TagLibFile::setFrame(Frame::TagNumber tagNr, const Frame& frame)
         QString frameValue(frame.getValue());
         if (frame.getType() == Frame::FT_Picture) {
 #if TAGLIB_VERSION >= 0x010700
-          if (m_pictures.isRead()) {
+          if (readPictures()) {
             int idx = frame.getIndex();
             if (idx >= 0 && idx < m_pictures.size()) {
               Frame newFrame(frame);
@@ -5742,7 +5917,7 @@ bool TagLibFile::addFrame(Frame::TagNumber tagNr, Frame& frame)
               frame, Frame::TE_ISO8859_1, QLatin1String("JPG"), QLatin1String("image/jpeg"),
               PictureFrame::PT_CoverFront, QLatin1String(""), QByteArray());
           }
-          if (m_pictures.isRead()) {
+          if (readPictures()) {
             PictureFrame::setDescription(frame, value);
             frame.setIndex(m_pictures.size());
             m_pictures.append(frame);
@@ -5997,7 +6172,7 @@ bool TagLibFile::deleteFrame(Frame::TagNumber tagNr, const Frame& frame)
         QString frameValue(frame.getValue());
 #if TAGLIB_VERSION >= 0x010700
         if (frame.getType() == Frame::FT_Picture) {
-          if (m_pictures.isRead()) {
+          if (readPictures()) {
             int idx = frame.getIndex();
             if (idx >= 0 && idx < m_pictures.size()) {
               m_pictures.removeAt(idx);
@@ -6200,6 +6375,10 @@ void TagLibFile::deleteFrames(Frame::TagNumber tagNr, const FrameFilter& flt)
             oggTag->removeField((*it++).first);
           }
 #if TAGLIB_VERSION >= 0x010700
+          if (m_pictures.isPending()) {
+            // Pictures which are deleted do not have to be converted.
+            m_pictures.setRead(true);
+          }
           m_pictures.clear();
 #endif
           markTagChanged(tagNr, Frame::FT_UnknownFrame);
@@ -6268,6 +6447,10 @@ void TagLibFile::deleteFrames(Frame::TagNumber tagNr, const FrameFilter& flt)
           }
 #if TAGLIB_VERSION >= 0x010700
           if (flt.isEnabled(Frame::FT_Picture)) {
+            if (m_pictures.isPending()) {
+              // Pictures which are deleted do not have to be converted.
+              m_pictures.setRead(true);
+            }
             m_pictures.clear();
           }
 #endif
@@ -6428,7 +6611,7 @@ void TagLibFile::getAllFrames(Frame::TagNumber tagNr, FrameCollection& frames)
           }
         }
 #if TAGLIB_VERSION >= 0x010700
-        if (m_pictures.isRead()) {
+        if (readPictures()) {
           for (Pictures::iterator it = m_pictures.begin();
                it != m_pictures.end();
                ++it) {
@@ -6811,10 +6994,10 @@ QStringList TagLibFile::getFrameIds(Frame::TagNumber tagNr) const
       "VOLUME"
     };
 #if TAGLIB_VERSION >= 0x010800
-    const bool picturesSupported = m_pictures.isRead() ||
+    const bool picturesSupported = m_pictures.isRead() || m_pictures.isPending() ||
         m_tagType[tagNr] == TT_Vorbis || m_tagType[tagNr] == TT_Ape;
 #elif TAGLIB_VERSION >= 0x010700
-    const bool picturesSupported = m_pictures.isRead() ||
+    const bool picturesSupported = m_pictures.isRead() || m_pictures.isPending() ||
         m_tagType[tagNr] == TT_Vorbis;
 #else
     const bool picturesSupported = false;
@@ -6882,43 +7065,14 @@ void TagLibFile::notifyConfigurationChange()
 #if TAGLIB_VERSION < 0x010800
 /**
  * Register open TagLib file, so that the number of open files can be limited.
- * If the number of open files exceeds a limit, files are closed.
+ * If the number of open files exceeds the capacity of the FileHandlePool,
+ * the least recently used files are closed.
  *
  * @param tagLibFile new open file to be registered
  */
 void TagLibFile::registerOpenFile(TagLibFile* tagLibFile)
 {
-  if (s_openFiles.contains(tagLibFile))
-    return;
-
-  int numberOfFilesToClose = s_openFiles.size() - 15;
-  if (numberOfFilesToClose > 5) {
-    QList<TagLibFile*> filesToClose;
-    for (QList<TagLibFile*>::iterator it = s_openFiles.begin();
-         it != s_openFiles.end();
-         ++it) {
-      TagLibFile* tlf = *it;
-      bool tagChanged = false;
-      FOR_TAGLIB_TAGS(tagNr) {
-        if (tlf->isTagChanged(tagNr)) {
-          tagChanged = true;
-          break;
-        }
-      }
-      if (!tagChanged) {
-        filesToClose.append(tlf);
-        if (--numberOfFilesToClose <= 0) {
-          break;
-        }
-      }
-    }
-    for (QList<TagLibFile*>::iterator it = filesToClose.begin();
-         it != filesToClose.end();
-         ++it) {
-      (*it)->closeFile(false);
-    }
-  }
-  s_openFiles.append(tagLibFile);
+  FileHandlePool::instance().touch(tagLibFile->m_openFileHandle);
 }
 
 /**
@@ -6928,7 +7082,7 @@ void TagLibFile::registerOpenFile(TagLibFile* tagLibFile)
  */
 void TagLibFile::deregisterOpenFile(TagLibFile* tagLibFile)
 {
-  s_openFiles.removeAll(tagLibFile);
+  FileHandlePool::instance().remove(tagLibFile->m_openFileHandle);
 }
 #endif
 
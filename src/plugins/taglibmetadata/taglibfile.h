@@ -196,6 +196,22 @@ public:
    */
   virtual unsigned getDuration() const;
 
+  /**
+   * Check if technical detail information is available without reading
+   * more of the file.
+   *
+   * @return true if the audio properties have been read.
+   */
+  virtual bool isDetailInfoRead() const;
+
+  /**
+   * Check if the pictures are available without reading more of the file.
+   *
+   * @return false if pictures of FLAC files or Xiph comments have not yet
+   * been converted to frames.
+   */
+  virtual bool arePicturesRead() const;
+
   /**
    * Get file extension including the dot.
    *
@@ -349,8 +365,29 @@ private:
 
   /**
    * Cache technical detail information.
+   *
+   * @param audioProperties audio properties of TagLib file, 0 if not available
    */
-  void readAudioProperties();
+  void readAudioProperties(TagLib::AudioProperties* audioProperties);
+
+  /**
+   * Make sure that the audio properties are read.
+   * The tags are read without audio properties because determining them
+   * can require scanning the whole file. They are read when the detail
+   * information is requested for the first time.
+   */
+  void makeAudioPropertiesRead() const;
+
+#if TAGLIB_VERSION >= 0x010700
+  /**
+   * Make sure that the pictures of a picture list are read.
+   * Pictures of FLAC files and Xiph comments are only converted to frames
+   * when they are accessed for the first time.
+   *
+   * @return true if the file has a picture list, i.e. m_pictures is used.
+   */
+  bool readPictures();
+#endif
 
 #if TAGLIB_VERSION >= 0x010800
   /**
@@ -408,7 +445,8 @@ private:
 #if TAGLIB_VERSION < 0x010800
   /**
    * Register open TagLib file, so that the number of open files can be limited.
-   * If the number of open files exceeds a limit, files are closed.
+   * If the number of open files exceeds the capacity of the FileHandlePool,
+   * the least recently used files are closed.
    *
    * @param tagLibFile new open file to be registered
    */
@@ -443,12 +481,17 @@ private:
   bool m_isTagSupported[NUM_TAGS];
 
   bool m_fileRead;           /**< true if file has been read */
+  bool m_audioPropertiesRead; /**< true if m_detailInfo is set */
 
   TagLib::FileRef m_fileRef; /**< file reference */
   TagLib::Tag* m_tag[NUM_TAGS];
 #if TAGLIB_VERSION >= 0x010800
   FileIOStream* m_stream;
   int m_id3v2Version;        /**< 3 for ID3v2.3, 4 for ID3v2.4, 0 if none */
+#else
+  class OpenFileHandle;
+  /** registration of open file descriptor in FileHandlePool */
+  OpenFileHandle* m_openFileHandle;
 #endif
   int m_activatedFeatures;   /**< TF_ID3v23, TF_ID3v24, or 0 */
 
@@ -462,12 +505,16 @@ private:
 #if TAGLIB_VERSION >= 0x010700
   class Pictures : public QList<Frame> {
   public:
-    Pictures() : m_read(false) {}
+    Pictures() : m_read(false), m_pending(false) {}
     bool isRead() const { return m_read; }
-    void setRead(bool read) { m_read = read; }
+    void setRead(bool read) { m_read = read; m_pending = false; }
+    /** true if the file has pictures which are not yet converted to frames */
+    bool isPending() const { return m_pending; }
+    void setPending(bool pending) { m_pending = pending; }
 
   private:
     bool m_read;
+    bool m_pending;
   };
 
   Pictures m_pictures;
@@ -475,11 +522,6 @@ private:
 
   /** default text encoding */
   static TagLib::String::Type s_defaultTextEncoding;
-
-#if TAGLIB_VERSION < 0x010800
-  /** list of TagLib files with open file descriptor */
-  static QList<TagLibFile*> s_openFiles;
-#endif
 };
 
 #endif // TAGLIBFILE_H
@@ -0,0 +1,355 @@
+/**
+ * \file taglibpaddingwriter.cpp
+ * Write tags using padding reserved in the file.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "taglibpaddingwriter.h"
+#include "taglibfile.h"
+#include <tfile.h>
+#include <tbytevector.h>
+#include <id3v2tag.h>
+#include <id3v2header.h>
+#if TAGLIB_VERSION >= 0x010700
+#include <flacfile.h>
+#include <flacpicture.h>
+#include <xiphcomment.h>
+#endif
+#include "operationprofiler.h"
+
+namespace {
+
+/** Padding used by TagLib for ID3v2 tags. */
+const uint DefaultId3v2Padding = 1024;
+/** Padding used by TagLib for FLAC metadata. */
+const uint DefaultFlacPadding = 4096;
+/** Maximum padding reserved by the grow once policy. */
+const uint MaxGrownPadding = 1024 * 1024;
+/** Maximum size of an ID3v2 tag (28 bit synchsafe integer). */
+const uint MaxId3v2Size = 0x0fffffff;
+/** Maximum length of a FLAC metadata block (24 bit integer). */
+const uint MaxFlacBlockLength = 0x00ffffff;
+
+/** FLAC metadata block types. */
+enum FlacBlockType {
+  FlacPadding = 1,
+  FlacVorbisComment = 4,
+  FlacPicture = 6,
+  FlacInvalid = 127
+};
+
+/**
+ * Get a big endian integer from bytes.
+ * @param data bytes
+ * @param offset index of first byte
+ * @param numBytes number of bytes
+ * @param synchsafe true if only the 7 lower bits of each byte are used
+ * @return integer value.
+ */
+uint bigEndianUInt(const TagLib::ByteVector& data, uint offset, uint numBytes,
+                   bool synchsafe = false)
+{
+  uint value = 0;
+  for (uint i = offset; i < offset + numBytes && i < data.size(); ++i) {
+    uchar byte = static_cast<uchar>(data[i]);
+    value = synchsafe ? (value << 7) | (byte & 0x7f) : (value << 8) | byte;
+  }
+  return value;
+}
+
+/**
+ * Get synchsafe bytes for a 28 bit integer.
+ * @param value integer value
+ * @return four bytes.
+ */
+TagLib::ByteVector synchsafeBytes(uint value)
+{
+  TagLib::ByteVector bytes(4, 0);
+  for (int i = 3; i >= 0; --i) {
+    bytes[i] = static_cast<char>(value & 0x7f);
+    value >>= 7;
+  }
+  return bytes;
+}
+
+/**
+ * Get the header of a FLAC metadata block.
+ * @param type block type
+ * @param length length of block data
+ * @param isLast true if this is the last metadata block
+ * @return four header bytes.
+ */
+TagLib::ByteVector flacBlockHeader(uint type, uint length, bool isLast)
+{
+  TagLib::ByteVector header(4, 0);
+  header[0] = static_cast<char>((isLast ? 0x80 : 0) | (type & 0x7f));
+  header[1] = static_cast<char>((length >> 16) & 0xff);
+  header[2] = static_cast<char>((length >> 8) & 0xff);
+  header[3] = static_cast<char>(length & 0xff);
+  return header;
+}
+
+/**
+ * Append a FLAC metadata block which is not the last block.
+ * @param data metadata to append to
+ * @param type block type
+ * @param block block data
+ * @return position of the block header in @a data.
+ */
+uint appendFlacBlock(TagLib::ByteVector& data, uint type,
+                     const TagLib::ByteVector& block)
+{
+  uint headerPos = data.size();
+  data.append(flacBlockHeader(type, block.size(), false));
+  data.append(block);
+  return headerPos;
+}
+
+}
+
+/**
+ * Constructor.
+ * @param file file to write
+ * @param paddingSize padding in bytes reserved when a tag is moved,
+ *                    0 to use the padding size of TagLib
+ * @param growPadding true to reserve padding as large as the tag
+ */
+TagLibPaddingWriter::TagLibPaddingWriter(TagLib::File* file, int paddingSize,
+                                         bool growPadding)
+  : m_file(file),
+    m_paddingSize(paddingSize > 0 ? static_cast<uint>(paddingSize) : 0),
+    m_growPadding(growPadding)
+{
+}
+
+/**
+ * Get padding reserved when a tag has to be moved.
+ * @param tagSize size of tag without padding
+ * @param defaultPadding padding used by TagLib
+ * @return padding size in bytes.
+ */
+uint TagLibPaddingWriter::paddingForRewrite(uint tagSize,
+                                            uint defaultPadding) const
+{
+  uint padding = m_paddingSize > 0 ? m_paddingSize : defaultPadding;
+  if (m_growPadding) {
+    // Reserve as much space as the tag occupies, so that it can double its
+    // size before the file has to be rewritten again.
+    padding = qMax(padding, qMin(tagSize, MaxGrownPadding));
+  }
+  return padding;
+}
+
+/**
+ * Replace a region of the file.
+ * @param data data to write
+ * @param start start position of region
+ * @param oldLength length of region, if it is the size of @a data,
+ *                  the data is written in place
+ * @return WrittenInPlace or Rewritten.
+ */
+TagLibPaddingWriter::Result TagLibPaddingWriter::replace(
+    const TagLib::ByteVector& data, ulong start, ulong oldLength)
+{
+  if (data.size() == oldLength) {
+    m_file->seek(start);
+    m_file->writeBlock(data);
+    return WrittenInPlace;
+  }
+  m_file->insert(data, start, oldLength);
+  OperationProfiler::count(OperationProfiler::FileRewrites);
+  return Rewritten;
+}
+
+/**
+ * Write an ID3v2 tag located at the start of the file.
+ * Tags at the end of the file have to be written before, because their
+ * positions known by TagLib are invalid if the rest of the file is moved.
+ *
+ * @param tag ID3v2 tag of file
+ * @param version ID3v2 version, 3 or 4
+ * @return result of operation.
+ */
+TagLibPaddingWriter::Result TagLibPaddingWriter::writeId3v2Tag(
+    TagLib::ID3v2::Tag* tag, int version)
+{
+#if TAGLIB_VERSION >= 0x010800
+  if (!tag || !m_file->isOpen() || tag->header()->footerPresent())
+    return NotHandled;
+  if (m_file->readOnly())
+    return Failed;
+
+  // Size of the existing tag including header and padding.
+  uint oldSize = 0;
+  m_file->seek(0);
+  TagLib::ByteVector oldHeader = m_file->readBlock(10);
+  if (oldHeader.size() == 10 && oldHeader.startsWith("ID3")) {
+    if (static_cast<uchar>(oldHeader[5]) & 0x10)
+      return NotHandled;
+    oldSize = 10 + bigEndianUInt(oldHeader, 6, 4, true);
+  } else if (tag->header()->tagSize() != 0) {
+    // The existing tag is not at the start of the file.
+    return NotHandled;
+  }
+
+  TagLib::ByteVector data = tag->render(version);
+  if (data.size() < 10 || !data.startsWith("ID3") ||
+      (static_cast<uchar>(data[5]) & 0x10))
+    return NotHandled;
+
+  // Find the end of the frames, the rest of the rendered tag is the padding
+  // calculated by TagLib.
+  const bool synchsafeFrameSizes = static_cast<uchar>(data[3]) >= 4;
+  const uint renderedSize = 10 + bigEndianUInt(data, 6, 4, true);
+  if (renderedSize > data.size())
+    return NotHandled;
+  uint framesEnd = 10;
+  while (framesEnd + 10 <= renderedSize && data[framesEnd] != 0) {
+    framesEnd += 10 + bigEndianUInt(data, framesEnd + 4, 4,
+                                    synchsafeFrameSizes);
+  }
+  if (framesEnd > renderedSize)
+    return NotHandled;
+
+  const uint newSize = framesEnd <= oldSize
+      ? oldSize
+      : framesEnd + paddingForRewrite(framesEnd, DefaultId3v2Padding);
+  if (newSize - 10 > MaxId3v2Size)
+    return NotHandled;
+  data.resize(framesEnd);
+  data.resize(newSize, 0);
+  TagLib::ByteVector size = synchsafeBytes(newSize - 10);
+  for (int i = 0; i < 4; ++i) {
+    data[6 + i] = size[i];
+  }
+  return replace(data, 0, oldSize);
+#else
+  Q_UNUSED(tag);
+  Q_UNUSED(version);
+  return NotHandled;
+#endif
+}
+
+/**
+ * Write the Vorbis comment and the pictures of a FLAC file.
+ * All other metadata blocks are kept unchanged, existing padding blocks
+ * are merged into a single padding block at the end of the metadata.
+ *
+ * @param flacFile FLAC file
+ * @return result of operation.
+ */
+TagLibPaddingWriter::Result TagLibPaddingWriter::writeFlacMetadata(
+    TagLib::FLAC::File* flacFile)
+{
+#if TAGLIB_VERSION >= 0x010700
+  TagLib::Ogg::XiphComment* xiphComment = flacFile->xiphComment();
+  if (!xiphComment || !m_file->isOpen())
+    return NotHandled;
+  if (m_file->readOnly())
+    return Failed;
+
+  // Skip an ID3v2 tag before the FLAC stream.
+  ulong streamStart = 0;
+  m_file->seek(0);
+  TagLib::ByteVector id3Header = m_file->readBlock(10);
+  if (id3Header.size() == 10 && id3Header.startsWith("ID3")) {
+    streamStart = 10 + bigEndianUInt(id3Header, 6, 4, true);
+    if (static_cast<uchar>(id3Header[5]) & 0x10) {
+      streamStart += 10;
+    }
+    m_file->seek(streamStart);
+  } else {
+    m_file->seek(0);
+  }
+  if (m_file->readBlock(4) != TagLib::ByteVector("fLaC", 4))
+    return NotHandled;
+
+  // Keep all blocks except comments, pictures and padding.
+  const ulong metadataStart = streamStart + 4;
+  ulong pos = metadataStart;
+  TagLib::ByteVector data;
+  uint lastHeaderPos = 0;
+  bool isLast = false;
+  while (!isLast) {
+    m_file->seek(pos);
+    TagLib::ByteVector header = m_file->readBlock(4);
+    if (header.size() != 4)
+      return NotHandled;
+    const uint type = static_cast<uchar>(header[0]) & 0x7f;
+    isLast = (static_cast<uchar>(header[0]) & 0x80) != 0;
+    const uint length = bigEndianUInt(header, 1, 3);
+    if (type == FlacInvalid || (pos == metadataStart && type != 0))
+      return NotHandled;
+    if (type != FlacPadding && type != FlacVorbisComment &&
+        type != FlacPicture) {
+      TagLib::ByteVector block = m_file->readBlock(length);
+      if (block.size() != length)
+        return NotHandled;
+      lastHeaderPos = appendFlacBlock(data, type, block);
+    }
+    pos += 4 + length;
+  }
+  const ulong oldLength = pos - metadataStart;
+
+  TagLib::ByteVector comment = xiphComment->render(false);
+  if (comment.size() > MaxFlacBlockLength)
+    return NotHandled;
+  lastHeaderPos = appendFlacBlock(data, FlacVorbisComment, comment);
+  TagLib::List<TagLib::FLAC::Picture*> pictures = flacFile->pictureList();
+  for (TagLib::List<TagLib::FLAC::Picture*>::ConstIterator it =
+         pictures.begin();
+       it != pictures.end();
+       ++it) {
+    TagLib::ByteVector picture = (*it)->render();
+    if (picture.size() > MaxFlacBlockLength)
+      return NotHandled;
+    lastHeaderPos = appendFlacBlock(data, FlacPicture, picture);
+  }
+
+  // A padding block needs at least its header, if the remaining space is
+  // too small, the file has to be rewritten.
+  const ulong contentLength = data.size();
+  uint padding = 0;
+  bool hasPadding = true;
+  if (contentLength == oldLength) {
+    hasPadding = false;
+  } else if (contentLength + 4 <= oldLength) {
+    if (oldLength - contentLength - 4 > MaxFlacBlockLength)
+      return NotHandled;
+    padding = oldLength - contentLength - 4;
+  } else {
+    padding = qMin(paddingForRewrite(contentLength, DefaultFlacPadding),
+                   MaxFlacBlockLength);
+  }
+  if (hasPadding) {
+    lastHeaderPos = appendFlacBlock(data, FlacPadding,
+                                    TagLib::ByteVector(padding, 0));
+  }
+  data[lastHeaderPos] = static_cast<char>(
+        static_cast<uchar>(data[lastHeaderPos]) | 0x80);
+  return replace(data, metadataStart, oldLength);
+#else
+  Q_UNUSED(flacFile);
+  return NotHandled;
+#endif
+}
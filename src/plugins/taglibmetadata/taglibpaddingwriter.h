@@ -0,0 +1,118 @@
+/**
+ * \file taglibpaddingwriter.h
+ * Write tags using padding reserved in the file.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAGLIBPADDINGWRITER_H
+#define TAGLIBPADDINGWRITER_H
+
+#include <QtGlobal>
+
+namespace TagLib {
+  class File;
+  class ByteVector;
+  namespace ID3v2 {
+    class Tag;
+  }
+  namespace FLAC {
+    class File;
+  }
+}
+
+/**
+ * Writes tags at the start of files using the padding reserved in the file.
+ *
+ * If the new tag fits into the space of the old tag including its padding,
+ * the tag is overwritten in place. Otherwise the rest of the file has to be
+ * moved, in this case padding of a configurable size is reserved so that
+ * later changes can be written in place. The result tells the caller if the
+ * file was rewritten, TagLibFile reports it with
+ * TaggedFile::isFileRewritten().
+ */
+class TagLibPaddingWriter {
+public:
+  /** Result of a write operation. */
+  enum Result {
+    NotHandled,     /**< tag not supported, has to be written by TagLib */
+    WrittenInPlace, /**< tag written into existing space */
+    Rewritten,      /**< tag written, rest of file moved */
+    Failed          /**< file could not be written */
+  };
+
+  /**
+   * Constructor.
+   * @param file file to write
+   * @param paddingSize padding in bytes reserved when a tag is moved,
+   *                    0 to use the padding size of TagLib
+   * @param growPadding true to reserve padding as large as the tag
+   */
+  TagLibPaddingWriter(TagLib::File* file, int paddingSize, bool growPadding);
+
+  /**
+   * Write an ID3v2 tag located at the start of the file.
+   * Tags at the end of the file have to be written before, because their
+   * positions known by TagLib are invalid if the rest of the file is moved.
+   *
+   * @param tag ID3v2 tag of file
+   * @param version ID3v2 version, 3 or 4
+   * @return result of operation.
+   */
+  Result writeId3v2Tag(TagLib::ID3v2::Tag* tag, int version);
+
+  /**
+   * Write the Vorbis comment and the pictures of a FLAC file.
+   * All other metadata blocks are kept unchanged, existing padding blocks
+   * are merged into a single padding block at the end of the metadata.
+   *
+   * @param flacFile FLAC file
+   * @return result of operation.
+   */
+  Result writeFlacMetadata(TagLib::FLAC::File* flacFile);
+
+private:
+  /**
+   * Get padding reserved when a tag has to be moved.
+   * @param tagSize size of tag without padding
+   * @param defaultPadding padding used by TagLib
+   * @return padding size in bytes.
+   */
+  uint paddingForRewrite(uint tagSize, uint defaultPadding) const;
+
+  /**
+   * Replace a region of the file.
+   * @param data data to write
+   * @param start start position of region
+   * @param oldLength length of region, if it is the size of @a data,
+   *                  the data is written in place
+   * @return WrittenInPlace or Rewritten.
+   */
+  Result replace(const TagLib::ByteVector& data, ulong start,
+                 ulong oldLength);
+
+  TagLib::File* m_file;
+  uint m_paddingSize;
+  bool m_growPadding;
+};
+
+#endif // TAGLIBPADDINGWRITER_H
@@ -0,0 +1,406 @@
+/**
+ * \file kid3benchmark.cpp
+ * Benchmark of tag operations on synthetic libraries.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "kid3benchmark.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QTimer>
+#include "kid3application.h"
+#include "fileproxymodel.h"
+#include "modeliterator.h"
+#include "itaggedfilefactory.h"
+#include "taggedfile.h"
+#include "tagsearcher.h"
+#include "filefilter.h"
+
+namespace {
+
+/** Maximum time in milliseconds to wait for an asynchronous operation. */
+const int OperationTimeout = 10 * 60 * 1000;
+
+/**
+ * Quote a string for JSON output.
+ * @param str string
+ * @return quoted and escaped string.
+ */
+QString jsonString(const QString& str)
+{
+  QString result(QLatin1Char('"'));
+  foreach (QChar ch, str) {
+    if (ch == QLatin1Char('"') || ch == QLatin1Char('\\')) {
+      result += QLatin1Char('\\');
+      result += ch;
+    } else if (ch.unicode() < 0x20) {
+      result += QString(QLatin1String("\\u%1"))
+          .arg(ch.unicode(), 4, 16, QLatin1Char('0'));
+    } else {
+      result += ch;
+    }
+  }
+  result += QLatin1Char('"');
+  return result;
+}
+
+/**
+ * Remove a directory with all its contents.
+ * @param path path of directory
+ * @return true if ok.
+ */
+bool removeDirectory(const QString& path)
+{
+  QDir dir(path);
+  foreach (const QFileInfo& fi, dir.entryInfoList(
+             QDir::AllEntries | QDir::NoDotAndDotDot |
+             QDir::Hidden | QDir::System)) {
+    if (fi.isDir() && !fi.isSymLink()) {
+      if (!removeDirectory(fi.filePath()))
+        return false;
+    } else if (!QFile::remove(fi.filePath())) {
+      return false;
+    }
+  }
+  return QDir().rmdir(path);
+}
+
+}
+
+/**
+ * Constructor.
+ * @param app application context
+ * @param out stream for results
+ * @param parent parent object
+ */
+Kid3Benchmark::Kid3Benchmark(Kid3Application* app, QTextStream& out,
+                             QObject* parent) : QObject(parent),
+  m_app(app), m_out(out),
+  m_workDir(QDir::temp().filePath(QLatin1String("kid3-bench"))),
+  m_filterExpression(QLatin1String("%{artist} contains \"Artist\"")),
+  m_searchText(QLatin1String("Title 1")),
+  m_eventLoop(0), m_numRuns(1), m_numMatches(0), m_returnCode(0),
+  m_done(true), m_keepFiles(false)
+{
+  connect(m_app, SIGNAL(directoryOpened()), this, SLOT(finishWait()));
+  connect(m_app, SIGNAL(renameActionsScheduled()), this, SLOT(finishWait()));
+  connect(m_app, SIGNAL(fileFiltered(int,QString,int,int)),
+          this, SLOT(onFileFiltered(int)));
+  connect(m_app->getTagSearcher(), SIGNAL(textFound()),
+          this, SLOT(onTextFound()));
+}
+
+/**
+ * Destructor.
+ */
+Kid3Benchmark::~Kid3Benchmark()
+{
+}
+
+/**
+ * Run the benchmark.
+ * finished() is emitted when done.
+ */
+void Kid3Benchmark::run()
+{
+  m_returnCode = 0;
+  QList<ITaggedFileFactory*>& factories =
+      FileProxyModel::taggedFileFactories();
+  const QList<ITaggedFileFactory*> allFactories = factories;
+  foreach (ITaggedFileFactory* factory, allFactories) {
+    const QString pluginName = factory->name();
+    if (!m_plugins.isEmpty()) {
+      bool selected = false;
+      foreach (const QString& plugin, m_plugins) {
+        if (pluginName.startsWith(plugin, Qt::CaseInsensitive)) {
+          selected = true;
+          break;
+        }
+      }
+      if (!selected)
+        continue;
+    }
+
+    // Only the plugin under test may create the tagged files, otherwise
+    // the first plugin supporting a format would always be used.
+    factories.clear();
+    factories.append(factory);
+    for (int runNr = 1; runNr <= m_numRuns; ++runNr) {
+      const QString libraryPath = QDir(m_workDir).filePath(
+            QString(QLatin1String("%1-%2")).arg(pluginName).arg(runNr));
+      for (int i = 0; i < SynthLibraryGenerator::NumFormats; ++i) {
+        SynthLibraryGenerator::Format format =
+            static_cast<SynthLibraryGenerator::Format>(i);
+        const QString formatName = SynthLibraryGenerator::formatName(format);
+        if (!m_formats.isEmpty() &&
+            !m_formats.contains(formatName, Qt::CaseInsensitive))
+          continue;
+
+        const QString dirPath = QDir(libraryPath).filePath(formatName);
+        if (m_generator.generate(dirPath, format).isEmpty()) {
+          qWarning("Could not generate files in %s", qPrintable(dirPath));
+          m_returnCode = 1;
+          continue;
+        }
+        if (!runOperations(pluginName, formatName, dirPath, runNr)) {
+          m_returnCode = 1;
+        }
+      }
+      if (!m_keepFiles) {
+        // Leave the library before it is deleted.
+        startWait();
+        if (m_app->openDirectory(QStringList() << m_workDir)) {
+          waitForCompletion();
+        }
+        removeDirectory(libraryPath);
+      }
+    }
+  }
+  factories = allFactories;
+  emit finished();
+}
+
+/**
+ * Run the operations on a directory.
+ * @param pluginName name of metadata plugin
+ * @param formatName name of file format
+ * @param dirPath path of directory
+ * @param runNr number of run
+ * @return false if an operation failed.
+ */
+bool Kid3Benchmark::runOperations(const QString& pluginName,
+                                  const QString& formatName,
+                                  const QString& dirPath, int runNr)
+{
+  QElapsedTimer timer;
+
+  startWait();
+  timer.start();
+  if (!m_app->openDirectory(QStringList() << dirPath) ||
+      !waitForCompletion()) {
+    qWarning("Could not open %s", qPrintable(dirPath));
+    return false;
+  }
+  const qint64 openNsecs = timer.nsecsElapsed();
+
+  int numFiles = 0;
+  timer.start();
+  TaggedFileIterator readIt(m_app->getRootIndex());
+  while (readIt.hasNext()) {
+    TaggedFile* taggedFile =
+        FileProxyModel::readTagsFromTaggedFile(readIt.next());
+    FOR_ALL_TAGS(tagNr) {
+      FrameCollection frames;
+      taggedFile->getAllFrames(tagNr, frames);
+    }
+    ++numFiles;
+  }
+  const qint64 readNsecs = timer.nsecsElapsed();
+  if (numFiles == 0) {
+    // The format is not supported by this plugin.
+    return true;
+  }
+  report(pluginName, formatName, "open", runNr, numFiles, openNsecs);
+  report(pluginName, formatName, "read", runNr, numFiles, readNsecs);
+
+  bool ok = true;
+  startWait();
+  timer.start();
+  m_app->applyFilter(m_filterExpression);
+  if (waitForCompletion()) {
+    report(pluginName, formatName, "filter", runNr, numFiles,
+           timer.nsecsElapsed());
+  } else {
+    qWarning("Filter timed out in %s", qPrintable(dirPath));
+    ok = false;
+  }
+
+  m_numMatches = 0;
+  startWait();
+  timer.start();
+  findNextText();
+  if (waitForCompletion()) {
+    report(pluginName, formatName, "search", runNr, numFiles,
+           timer.nsecsElapsed());
+  } else {
+    qWarning("Search timed out in %s", qPrintable(dirPath));
+    ok = false;
+  }
+
+  // The rename actions are only scheduled, the directory is not renamed.
+  startWait();
+  timer.start();
+  if (m_app->renameDirectory(Frame::TagV2V1,
+                             QLatin1String("%{artist} - %{album}"), false) &&
+      waitForCompletion()) {
+    report(pluginName, formatName, "rename", runNr, numFiles,
+           timer.nsecsElapsed());
+  } else {
+    qWarning("Rename failed in %s", qPrintable(dirPath));
+    ok = false;
+  }
+
+  const QString exportPath = QDir(m_workDir).filePath(
+        QString(QLatin1String("export-%1-%2.txt"))
+        .arg(pluginName).arg(formatName));
+  timer.start();
+  if (m_app->exportTags(Frame::TagV2V1, exportPath, 0)) {
+    report(pluginName, formatName, "export", runNr, numFiles,
+           timer.nsecsElapsed());
+  } else {
+    qWarning("Could not export to %s", qPrintable(exportPath));
+    ok = false;
+  }
+  if (!m_keepFiles) {
+    QFile::remove(exportPath);
+  }
+
+  TaggedFileIterator modifyIt(m_app->getRootIndex());
+  while (modifyIt.hasNext()) {
+    TaggedFile* taggedFile = modifyIt.next();
+    FrameCollection frames;
+    taggedFile->getAllFrames(Frame::Tag_2, frames);
+    frames.setComment(QString(QLatin1String("Run %1")).arg(runNr));
+    taggedFile->setFrames(Frame::Tag_2, frames, false);
+  }
+  timer.start();
+  const QStringList errorFiles = m_app->saveDirectory();
+  const qint64 saveNsecs = timer.nsecsElapsed();
+  if (errorFiles.isEmpty()) {
+    report(pluginName, formatName, "save", runNr, numFiles, saveNsecs);
+  } else {
+    qWarning("Could not save %s", qPrintable(errorFiles.join(
+                                                QLatin1String(", "))));
+    ok = false;
+  }
+  return ok;
+}
+
+/**
+ * Called when a file has been filtered.
+ * @param type filter event type, see FileFilter::FilterEventType
+ */
+void Kid3Benchmark::onFileFiltered(int type)
+{
+  if (type == FileFilter::Finished || type == FileFilter::Aborted) {
+    finishWait();
+  }
+}
+
+/**
+ * Called when the tag searcher has finished a search step.
+ */
+void Kid3Benchmark::onTextFound()
+{
+  if (m_done)
+    return;
+
+  if (m_app->getTagSearcher()->getPosition().isValid()) {
+    ++m_numMatches;
+    // Continue asynchronously like a user repeatedly pressing "Find".
+    QTimer::singleShot(0, this, SLOT(findNextText()));
+  } else {
+    finishWait();
+  }
+}
+
+/**
+ * Search the next occurrence of the search text.
+ */
+void Kid3Benchmark::findNextText()
+{
+  TagSearcher::Parameters params;
+  params.setSearchText(m_searchText);
+  params.setFlags(TagSearcher::AllFrames);
+  m_app->findText(params);
+}
+
+/**
+ * Prepare waiting for an asynchronous operation.
+ * Has to be called before the operation is started.
+ */
+void Kid3Benchmark::startWait()
+{
+  m_done = false;
+}
+
+/**
+ * Wait until finishWait() is called or the timeout expires.
+ * @return false on timeout.
+ */
+bool Kid3Benchmark::waitForCompletion()
+{
+  if (!m_done) {
+    QEventLoop eventLoop;
+    QTimer timer;
+    timer.setSingleShot(true);
+    connect(&timer, SIGNAL(timeout()), &eventLoop, SLOT(quit()));
+    timer.start(OperationTimeout);
+    m_eventLoop = &eventLoop;
+    eventLoop.exec();
+    m_eventLoop = 0;
+  }
+  return m_done;
+}
+
+/**
+ * Mark the asynchronous operation as finished.
+ */
+void Kid3Benchmark::finishWait()
+{
+  m_done = true;
+  if (m_eventLoop) {
+    m_eventLoop->quit();
+  }
+}
+
+/**
+ * Write the result of an operation.
+ * @param pluginName name of metadata plugin
+ * @param formatName name of file format
+ * @param operation name of operation
+ * @param runNr number of run
+ * @param numFiles number of files
+ * @param nsecs elapsed time in nanoseconds
+ */
+void Kid3Benchmark::report(const QString& pluginName,
+                           const QString& formatName,
+                           const char* operation, int runNr, int numFiles,
+                           qint64 nsecs)
+{
+  m_out << "{\"label\":" << jsonString(m_label)
+        << ",\"plugin\":" << jsonString(pluginName)
+        << ",\"format\":" << jsonString(formatName)
+        << ",\"operation\":\"" << operation << '"'
+        << ",\"run\":" << runNr
+        << ",\"files\":" << numFiles
+        << ",\"frames\":" << m_generator.numberOfFrames()
+        << ",\"pictureSize\":" << m_generator.pictureSize()
+        << ",\"ms\":" << QString::number(nsecs / 1e6, 'f', 3)
+        << "}\n";
+  m_out.flush();
+}
@@ -0,0 +1,216 @@
+/**
+ * \file kid3benchmark.h
+ * Benchmark of tag operations on synthetic libraries.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KID3BENCHMARK_H
+#define KID3BENCHMARK_H
+
+#include <QObject>
+#include <QStringList>
+#include "synthlibrarygenerator.h"
+
+class QEventLoop;
+class QTextStream;
+class Kid3Application;
+
+/**
+ * Benchmark of tag operations on synthetic libraries.
+ *
+ * For each metadata plugin and run, a library is generated with
+ * SynthLibraryGenerator and the operations "open", "read", "filter",
+ * "search", "rename", "export" and "save" are timed on the directory
+ * of each format using the same code paths as the applications. Every
+ * measurement is written as a line with a JSON object, so that results
+ * of different commits can be compared with standard tools.
+ */
+class Kid3Benchmark : public QObject {
+  Q_OBJECT
+public:
+  /**
+   * Constructor.
+   * @param app application context
+   * @param out stream for results
+   * @param parent parent object
+   */
+  Kid3Benchmark(Kid3Application* app, QTextStream& out, QObject* parent = 0);
+
+  /**
+   * Destructor.
+   */
+  virtual ~Kid3Benchmark();
+
+  /**
+   * Access generator for synthetic libraries.
+   * @return generator.
+   */
+  SynthLibraryGenerator& generator() { return m_generator; }
+
+  /**
+   * Set directory in which the libraries are generated.
+   * @param path directory path
+   */
+  void setWorkDirectory(const QString& path) { m_workDir = path; }
+
+  /**
+   * Set number of runs for each plugin.
+   * @param numRuns number of runs
+   */
+  void setNumberOfRuns(int numRuns) { m_numRuns = numRuns; }
+
+  /**
+   * Set plugins to benchmark.
+   * @param plugins case insensitive prefixes of plugin names, e.g.
+   *        "taglib", empty for all plugins
+   */
+  void setPlugins(const QStringList& plugins) { m_plugins = plugins; }
+
+  /**
+   * Set formats to benchmark.
+   * @param formats format names, e.g. "mp3", empty for all formats
+   */
+  void setFormats(const QStringList& formats) { m_formats = formats; }
+
+  /**
+   * Set label written with every result, e.g. a commit ID.
+   * @param label label
+   */
+  void setLabel(const QString& label) { m_label = label; }
+
+  /**
+   * Set filter expression used for the "filter" operation.
+   * @param expression filter expression
+   */
+  void setFilterExpression(const QString& expression) {
+    m_filterExpression = expression;
+  }
+
+  /**
+   * Set text searched in the "search" operation.
+   * @param text search text
+   */
+  void setSearchText(const QString& text) { m_searchText = text; }
+
+  /**
+   * Keep generated libraries after the benchmark.
+   * @param keep true to keep files
+   */
+  void setKeepFiles(bool keep) { m_keepFiles = keep; }
+
+  /**
+   * Get result of last run().
+   * @return 0 if ok, 1 if an operation failed.
+   */
+  int returnCode() const { return m_returnCode; }
+
+public slots:
+  /**
+   * Run the benchmark.
+   * finished() is emitted when done.
+   */
+  void run();
+
+signals:
+  /**
+   * Emitted when the benchmark is finished.
+   * The result is available with returnCode().
+   */
+  void finished();
+
+private slots:
+  /**
+   * Called when a file has been filtered.
+   * @param type filter event type, see FileFilter::FilterEventType
+   */
+  void onFileFiltered(int type);
+
+  /**
+   * Called when the tag searcher has finished a search step.
+   */
+  void onTextFound();
+
+  /**
+   * Search the next occurrence of the search text.
+   */
+  void findNextText();
+
+  /**
+   * Mark the asynchronous operation as finished.
+   */
+  void finishWait();
+
+private:
+  /**
+   * Run the operations on a directory.
+   * @param pluginName name of metadata plugin
+   * @param formatName name of file format
+   * @param dirPath path of directory
+   * @param runNr number of run
+   * @return false if an operation failed.
+   */
+  bool runOperations(const QString& pluginName, const QString& formatName,
+                     const QString& dirPath, int runNr);
+
+  /**
+   * Prepare waiting for an asynchronous operation.
+   * Has to be called before the operation is started.
+   */
+  void startWait();
+
+  /**
+   * Wait until finishWait() is called or the timeout expires.
+   * @return false on timeout.
+   */
+  bool waitForCompletion();
+
+  /**
+   * Write the result of an operation.
+   * @param pluginName name of metadata plugin
+   * @param formatName name of file format
+   * @param operation name of operation
+   * @param runNr number of run
+   * @param numFiles number of files
+   * @param nsecs elapsed time in nanoseconds
+   */
+  void report(const QString& pluginName, const QString& formatName,
+              const char* operation, int runNr, int numFiles, qint64 nsecs);
+
+  Kid3Application* m_app;
+  QTextStream& m_out;
+  SynthLibraryGenerator m_generator;
+  QString m_workDir;
+  QStringList m_plugins;
+  QStringList m_formats;
+  QString m_label;
+  QString m_filterExpression;
+  QString m_searchText;
+  QEventLoop* m_eventLoop;
+  int m_numRuns;
+  int m_numMatches;
+  int m_returnCode;
+  bool m_done;
+  bool m_keepFiles;
+};
+
+#endif // KID3BENCHMARK_H
@@ -0,0 +1,204 @@
+/**
+ * \file mainbench.cpp
+ * Main program for benchmark of tag operations.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QTimer>
+#include <cstdio>
+#include "coreplatformtools.h"
+#include "kid3application.h"
+#include "kid3benchmark.h"
+
+namespace {
+
+/**
+ * Print usage to standard error.
+ */
+void printUsage()
+{
+  std::fputs(
+    "Usage: kid3-bench [OPTION]...\n"
+    "Generate synthetic libraries and time tag operations.\n\n"
+    "  --dir DIR           work directory, default $TMPDIR/kid3-bench\n"
+    "  --output FILE       write results to FILE instead of stdout\n"
+    "  --files N           number of files per format, default 100\n"
+    "  --frames N          number of frames per tag, default 10\n"
+    "  --picture-size N    size of cover art in bytes, 0 for none\n"
+    "  --runs N            number of runs per plugin, default 1\n"
+    "  --plugins A,B       plugins to benchmark, e.g. taglib,id3lib\n"
+    "  --formats A,B       formats, mp3,flac,ogg,m4a,wav,dsf\n"
+    "  --label LABEL       label written with each result\n"
+    "  --filter EXPR       expression for filter operation\n"
+    "  --search TEXT       text for search operation\n"
+    "  --keep              do not delete generated files\n"
+    "  --generate-only     only generate the libraries in DIR\n"
+    "Each result is written as a line with a JSON object.\n",
+    stderr);
+}
+
+}
+
+/**
+ * Main program for benchmark.
+ *
+ * @param argc number of arguments including command name
+ * @param argv arguments, argv[0] is command name
+ *
+ * @return 0 if OK, 1 if an operation failed, 2 for invalid arguments.
+ */
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  app.setApplicationName(QLatin1String("Kid3"));
+
+  QString workDir = QDir::temp().filePath(QLatin1String("kid3-bench"));
+  QString outputPath, label, filterExpression, searchText;
+  QStringList plugins, formats;
+  int numFiles = -1, numFrames = -1, pictureSize = -1, numRuns = 1;
+  bool keepFiles = false, generateOnly = false;
+  QStringList args = QCoreApplication::arguments();
+  for (int i = 1; i < args.size(); ++i) {
+    const QString& arg = args.at(i);
+    if (arg == QLatin1String("--keep")) {
+      keepFiles = true;
+      continue;
+    } else if (arg == QLatin1String("--generate-only")) {
+      generateOnly = true;
+      continue;
+    } else if (arg == QLatin1String("-h") || arg == QLatin1String("--help")) {
+      printUsage();
+      return 0;
+    }
+    if (i + 1 >= args.size()) {
+      printUsage();
+      return 2;
+    }
+    const QString value = args.at(++i);
+    bool ok = true;
+    if (arg == QLatin1String("--dir")) {
+      workDir = value;
+    } else if (arg == QLatin1String("--output")) {
+      outputPath = value;
+    } else if (arg == QLatin1String("--files")) {
+      numFiles = value.toInt(&ok);
+    } else if (arg == QLatin1String("--frames")) {
+      numFrames = value.toInt(&ok);
+    } else if (arg == QLatin1String("--picture-size")) {
+      pictureSize = value.toInt(&ok);
+    } else if (arg == QLatin1String("--runs")) {
+      numRuns = value.toInt(&ok);
+    } else if (arg == QLatin1String("--plugins")) {
+      plugins = value.split(QLatin1Char(','), QString::SkipEmptyParts);
+    } else if (arg == QLatin1String("--formats")) {
+      formats = value.split(QLatin1Char(','), QString::SkipEmptyParts);
+    } else if (arg == QLatin1String("--label")) {
+      label = value;
+    } else if (arg == QLatin1String("--filter")) {
+      filterExpression = value;
+    } else if (arg == QLatin1String("--search")) {
+      searchText = value;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      printUsage();
+      return 2;
+    }
+  }
+
+  workDir = QDir(workDir).absolutePath();
+  if (!QDir().mkpath(workDir)) {
+    qWarning("Could not create %s", qPrintable(workDir));
+    return 1;
+  }
+  // Use a separate configuration, the settings of the user must neither
+  // influence the results nor be changed by the benchmark.
+  qputenv("KID3_CONFIG_FILE", QFile::encodeName(
+            QDir(workDir).filePath(QLatin1String("kid3-bench.ini"))));
+
+  QFile outputFile;
+  if (outputPath.isEmpty()) {
+    outputFile.open(stdout, QIODevice::WriteOnly);
+  } else {
+    outputFile.setFileName(outputPath);
+    if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+      qWarning("Could not open %s", qPrintable(outputPath));
+      return 1;
+    }
+  }
+  QTextStream out(&outputFile);
+
+  ICorePlatformTools* platformTools = new CorePlatformTools;
+  Kid3Application* kid3App = new Kid3Application(platformTools);
+  int rc;
+  {
+    Kid3Benchmark benchmark(kid3App, out);
+    SynthLibraryGenerator& generator = benchmark.generator();
+    if (numFiles >= 0)
+      generator.setNumberOfFiles(numFiles);
+    if (numFrames >= 0)
+      generator.setNumberOfFrames(numFrames);
+    if (pictureSize >= 0)
+      generator.setPictureSize(pictureSize);
+
+    if (generateOnly) {
+      rc = 0;
+      for (int i = 0; i < SynthLibraryGenerator::NumFormats; ++i) {
+        SynthLibraryGenerator::Format format =
+            static_cast<SynthLibraryGenerator::Format>(i);
+        const QString formatName = SynthLibraryGenerator::formatName(format);
+        if (!formats.isEmpty() &&
+            !formats.contains(formatName, Qt::CaseInsensitive))
+          continue;
+        if (generator.generate(QDir(workDir).filePath(formatName),
+                               format).isEmpty()) {
+          rc = 1;
+        }
+      }
+    } else {
+      benchmark.setWorkDirectory(workDir);
+      benchmark.setNumberOfRuns(numRuns);
+      benchmark.setPlugins(plugins);
+      benchmark.setFormats(formats);
+      benchmark.setLabel(label);
+      benchmark.setKeepFiles(keepFiles);
+      if (!filterExpression.isEmpty())
+        benchmark.setFilterExpression(filterExpression);
+      if (!searchText.isEmpty())
+        benchmark.setSearchText(searchText);
+      QObject::connect(&benchmark, SIGNAL(finished()), &app, SLOT(quit()));
+      QTimer::singleShot(0, &benchmark, SLOT(run()));
+      app.exec();
+      rc = benchmark.returnCode();
+    }
+  }
+  delete kid3App;
+  delete platformTools;
+  return rc;
+}
@@ -33,6 +33,32 @@
 #include "testmusicbrainzreleaseimportparser.h"
 #include "testmusicbrainzreleaseimporter.h"
 #include "testdiscogsimporter.h"
+#include "testhttpclient.h"
+#include "testhttpresponsecache.h"
+#include "testframenameregistry.h"
+#include "testframecollection.h"
+#include "testtagsearchindex.h"
+#include "testtagcache.h"
+#include "testtagreaderpool.h"
+#include "testtrackdatamatcher.h"
+#include "testoperationprofiler.h"
+#include "testdirectoryscanner.h"
+#include "testdirectorywatcher.h"
+#include "testformatreplacer.h"
+#include "testtextexporter.h"
+#include "testfileproxymodel.h"
+#include "testfilefilter.h"
+#include "testpicturestore.h"
+#include "testfilehandlepool.h"
+#include "testfilerewriter.h"
+#include "testm4aatomwriter.h"
+#include "testoggcommentwriter.h"
+#include "testmp3tagwriter.h"
+#include "testfingerprinttasktracker.h"
+#ifdef HAVE_TAGLIB
+#include "testtaglibpaddingwriter.h"
+#include "testtaglibfile.h"
+#endif
 
 /**
  * Main routine for test runner.
@@ -52,6 +78,32 @@ int main(int argc, char *argv[])
     new TestMusicBrainzReleaseImportParser,
     new TestMusicBrainzReleaseImporter,
     new TestDiscogsImporter,
+    new TestHttpClient,
+    new TestHttpResponseCache,
+    new TestFrameNameRegistry,
+    new TestFrameCollection,
+    new TestTagSearchIndex,
+    new TestTagCache,
+    new TestTagReaderPool,
+    new TestTrackDataMatcher,
+    new TestOperationProfiler,
+    new TestDirectoryScanner,
+    new TestDirectoryWatcher,
+    new TestFormatReplacer,
+    new TestTextExporter,
+    new TestFileProxyModel,
+    new TestFileFilter,
+    new TestPictureStore,
+    new TestFileHandlePool,
+    new TestFileRewriter,
+    new TestM4aAtomWriter,
+    new TestOggCommentWriter,
+    new TestMp3TagWriter,
+    new TestFingerprintTaskTracker,
+#ifdef HAVE_TAGLIB
+    new TestTagLibPaddingWriter,
+    new TestTagLibFile,
+#endif
     0
   };
 
@@ -0,0 +1,1037 @@
+/**
+ * \file synthlibrarygenerator.cpp
+ * Generator for synthetic libraries of tagged audio files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synthlibrarygenerator.h"
+#include <QDir>
+#include <QFile>
+#include <QList>
+#include <QPair>
+
+namespace {
+
+/** Number of tracks on an album, tracks of an album share the picture. */
+const int TracksPerAlbum = 12;
+/** Number of different artists. */
+const int NumArtists = 10;
+/** Sample rate of the audio. */
+const int SampleRate = 44100;
+/** Duration of the audio in seconds. */
+const int AudioSeconds = 1;
+/** Size of padding in ID3v2 tags and MP4 metadata. */
+const int TagPadding = 1024;
+/** Size of an MPEG 1 layer III frame with 128 kbit/s and 44.1 kHz. */
+const int MpegFrameSize = 417;
+/** Number of samples in an MPEG 1 layer III frame. */
+const int MpegFrameSamples = 1152;
+/** Number of samples in an AAC frame. */
+const int AacFrameSamples = 1024;
+/** Size of the empty AAC frames. */
+const int AacFrameSize = 16;
+/** Block size per channel of DSF audio. */
+const int DsfBlockSize = 4096;
+/** Number of DSF blocks per channel. */
+const int DsfBlocks = 4;
+/** Number of empty Vorbis audio packets. */
+const int VorbisAudioPackets = 100;
+
+/** Genre names with their ID3v1 genre numbers. */
+const struct {
+  const char* name;
+  int id3v1Genre;
+} genres[] = {
+  { "Rock", 17 }, { "Pop", 13 }, { "Jazz", 8 }, { "Classical", 32 },
+  { "Electronic", 52 }, { "Hip-Hop", 7 }, { "Blues", 0 }, { "Country", 2 }
+};
+const int numGenres = sizeof(genres) / sizeof(genres[0]);
+
+/**
+ * Tag values of a generated track.
+ */
+struct TrackInfo {
+  QString title;
+  QString artist;
+  QString album;
+  QString genre;
+  QString comment;
+  int genreId3v1;
+  int track;
+  int totalTracks;
+  int year;
+  QList<QPair<QString, QString> > userFrames;
+  QByteArray picture;
+};
+
+/**
+ * Get next pseudo random number of a linear congruential generator.
+ * @param seed state of generator, updated
+ * @return random number in the range 0..32767.
+ */
+inline quint32 nextRandom(quint32& seed)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) & 0x7fff;
+}
+
+void appendBe16(QByteArray& ba, quint32 value)
+{
+  ba += static_cast<char>((value >> 8) & 0xff);
+  ba += static_cast<char>(value & 0xff);
+}
+
+void appendBe24(QByteArray& ba, quint32 value)
+{
+  ba += static_cast<char>((value >> 16) & 0xff);
+  appendBe16(ba, value);
+}
+
+void appendBe32(QByteArray& ba, quint32 value)
+{
+  appendBe16(ba, value >> 16);
+  appendBe16(ba, value);
+}
+
+void appendBe64(QByteArray& ba, quint64 value)
+{
+  appendBe32(ba, static_cast<quint32>(value >> 32));
+  appendBe32(ba, static_cast<quint32>(value));
+}
+
+void appendLe16(QByteArray& ba, quint32 value)
+{
+  ba += static_cast<char>(value & 0xff);
+  ba += static_cast<char>((value >> 8) & 0xff);
+}
+
+void appendLe32(QByteArray& ba, quint32 value)
+{
+  appendLe16(ba, value);
+  appendLe16(ba, value >> 16);
+}
+
+void appendLe64(QByteArray& ba, quint64 value)
+{
+  appendLe32(ba, static_cast<quint32>(value));
+  appendLe32(ba, static_cast<quint32>(value >> 32));
+}
+
+/**
+ * Create picture data which starts like a JPEG file.
+ * @param albumIndex index of album, used as seed for the data
+ * @param size size of data
+ * @return picture data, empty if @a size is 0.
+ */
+QByteArray createPicture(int albumIndex, int size)
+{
+  if (size <= 0) {
+    return QByteArray();
+  }
+  QByteArray data("\xff\xd8\xff\xe0\x00\x10JFIF\x00\x01\x01\x00\x00\x01"
+                  "\x00\x01\x00\x00", 20);
+  data.reserve(size);
+  quint32 seed = albumIndex + 1;
+  while (data.size() < size - 2) {
+    data += static_cast<char>(nextRandom(seed) & 0xff);
+  }
+  data += "\xff\xd9";
+  return data;
+}
+
+/**
+ * Create tag values of a track.
+ * @param trackIndex index of track
+ * @param numFrames number of user defined frames
+ * @param pictureSize size of picture data
+ * @return tag values.
+ */
+TrackInfo createTrackInfo(int trackIndex, int numFrames, int pictureSize)
+{
+  const int albumIndex = trackIndex / TracksPerAlbum;
+  TrackInfo info;
+  info.title = QString(QLatin1String("Title %1")).arg(trackIndex + 1);
+  info.artist = QString(QLatin1String("Artist %1"))
+      .arg(albumIndex % NumArtists + 1);
+  info.album = QString(QLatin1String("Album %1")).arg(albumIndex + 1);
+  info.genre = QLatin1String(genres[albumIndex % numGenres].name);
+  info.genreId3v1 = genres[albumIndex % numGenres].id3v1Genre;
+  info.comment = QString(QLatin1String("Comment for track %1"))
+      .arg(trackIndex + 1);
+  info.track = trackIndex % TracksPerAlbum + 1;
+  info.totalTracks = TracksPerAlbum;
+  info.year = 1970 + albumIndex % 50;
+  for (int i = 0; i < numFrames; ++i) {
+    info.userFrames.append(
+          qMakePair(QString(QLatin1String("BENCH_FIELD_%1")).arg(i + 1),
+                    QString(QLatin1String("Value %1 of track %2"))
+                    .arg(i + 1).arg(trackIndex + 1)));
+  }
+  info.picture = createPicture(albumIndex, pictureSize);
+  return info;
+}
+
+/**
+ * Get Latin-1 string padded with zeros to a fixed length.
+ * @param str string
+ * @param len length
+ * @return fixed length string.
+ */
+QByteArray fixedLatin1(const QString& str, int len)
+{
+  QByteArray ba = str.toLatin1().left(len);
+  return ba + QByteArray(len - ba.size(), '\0');
+}
+
+QByteArray id3v1Tag(const TrackInfo& info)
+{
+  QByteArray tag("TAG");
+  tag += fixedLatin1(info.title, 30);
+  tag += fixedLatin1(info.artist, 30);
+  tag += fixedLatin1(info.album, 30);
+  tag += fixedLatin1(QString::number(info.year), 4);
+  tag += fixedLatin1(info.comment, 28);
+  tag += '\0';
+  tag += static_cast<char>(info.track);
+  tag += static_cast<char>(info.genreId3v1);
+  return tag;
+}
+
+QByteArray id3v2Frame(const char* id, const QByteArray& data)
+{
+  QByteArray frame(id, 4);
+  appendBe32(frame, data.size());
+  frame += QByteArray(2, '\0');
+  frame += data;
+  return frame;
+}
+
+QByteArray id3v2TextFrame(const char* id, const QString& text)
+{
+  return id3v2Frame(id, QByteArray(1, '\0') + text.toLatin1());
+}
+
+/**
+ * Create an ID3v2.3 tag with padding.
+ * @param info tag values
+ * @return tag.
+ */
+QByteArray id3v2Tag(const TrackInfo& info)
+{
+  QByteArray frames;
+  frames += id3v2TextFrame("TIT2", info.title);
+  frames += id3v2TextFrame("TPE1", info.artist);
+  frames += id3v2TextFrame("TALB", info.album);
+  frames += id3v2TextFrame("TRCK", QString(QLatin1String("%1/%2"))
+                           .arg(info.track).arg(info.totalTracks));
+  frames += id3v2TextFrame("TYER", QString::number(info.year));
+  frames += id3v2TextFrame("TCON", info.genre);
+  frames += id3v2Frame("COMM", QByteArray("\0eng\0", 5) +
+                       info.comment.toLatin1());
+  for (QList<QPair<QString, QString> >::const_iterator it =
+         info.userFrames.constBegin();
+       it != info.userFrames.constEnd();
+       ++it) {
+    frames += id3v2Frame("TXXX", QByteArray(1, '\0') + it->first.toLatin1() +
+                         '\0' + it->second.toLatin1());
+  }
+  if (!info.picture.isEmpty()) {
+    frames += id3v2Frame("APIC", QByteArray("\0image/jpeg\0\x03\0", 14) +
+                         info.picture);
+  }
+
+  const quint32 size = frames.size() + TagPadding;
+  QByteArray tag("ID3\x03\x00\x00", 6);
+  tag += static_cast<char>((size >> 21) & 0x7f);
+  tag += static_cast<char>((size >> 14) & 0x7f);
+  tag += static_cast<char>((size >> 7) & 0x7f);
+  tag += static_cast<char>(size & 0x7f);
+  tag += frames;
+  tag += QByteArray(TagPadding, '\0');
+  return tag;
+}
+
+QByteArray apeItem(const QString& key, const QByteArray& value,
+                   bool binary = false)
+{
+  QByteArray item;
+  appendLe32(item, value.size());
+  appendLe32(item, binary ? 2 : 0);
+  item += key.toLatin1();
+  item += '\0';
+  item += value;
+  return item;
+}
+
+QByteArray apeHeader(quint32 tagSize, quint32 itemCount, bool isHeader)
+{
+  QByteArray header("APETAGEX");
+  appendLe32(header, 2000);
+  appendLe32(header, tagSize);
+  appendLe32(header, itemCount);
+  appendLe32(header, 0x80000000U | (isHeader ? 0x20000000U : 0));
+  header += QByteArray(8, '\0');
+  return header;
+}
+
+/**
+ * Create an APEv2 tag with header and footer.
+ * @param info tag values
+ * @return tag.
+ */
+QByteArray apeTag(const TrackInfo& info)
+{
+  QByteArray items;
+  items += apeItem(QLatin1String("Title"), info.title.toUtf8());
+  items += apeItem(QLatin1String("Artist"), info.artist.toUtf8());
+  items += apeItem(QLatin1String("Album"), info.album.toUtf8());
+  items += apeItem(QLatin1String("Track"), QString(QLatin1String("%1/%2"))
+                   .arg(info.track).arg(info.totalTracks).toLatin1());
+  items += apeItem(QLatin1String("Year"), QByteArray::number(info.year));
+  items += apeItem(QLatin1String("Genre"), info.genre.toUtf8());
+  items += apeItem(QLatin1String("Comment"), info.comment.toUtf8());
+  int itemCount = 7;
+  for (QList<QPair<QString, QString> >::const_iterator it =
+         info.userFrames.constBegin();
+       it != info.userFrames.constEnd();
+       ++it) {
+    items += apeItem(it->first, it->second.toUtf8());
+    ++itemCount;
+  }
+  if (!info.picture.isEmpty()) {
+    items += apeItem(QLatin1String("Cover Art (Front)"),
+                     QByteArray("cover.jpg\0", 10) + info.picture, true);
+    ++itemCount;
+  }
+  const quint32 tagSize = items.size() + 32;
+  return apeHeader(tagSize, itemCount, true) + items +
+      apeHeader(tagSize, itemCount, false);
+}
+
+/**
+ * Create a FLAC picture block without block header.
+ * @param info tag values
+ * @return picture block data.
+ */
+QByteArray flacPicture(const TrackInfo& info)
+{
+  const QByteArray mimeType("image/jpeg");
+  QByteArray data;
+  appendBe32(data, 3);
+  appendBe32(data, mimeType.size());
+  data += mimeType;
+  appendBe32(data, 0);
+  appendBe32(data, 500);
+  appendBe32(data, 500);
+  appendBe32(data, 24);
+  appendBe32(data, 0);
+  appendBe32(data, info.picture.size());
+  data += info.picture;
+  return data;
+}
+
+/**
+ * Create Vorbis comments.
+ * @param info tag values
+ * @param framingBit true to append the framing bit used in Ogg Vorbis
+ * @param withPicture true to add the picture as a base64 encoded comment
+ * @return Vorbis comment data.
+ */
+QByteArray vorbisComment(const TrackInfo& info, bool framingBit,
+                         bool withPicture)
+{
+  QList<QByteArray> comments;
+  comments.append("TITLE=" + info.title.toUtf8());
+  comments.append("ARTIST=" + info.artist.toUtf8());
+  comments.append("ALBUM=" + info.album.toUtf8());
+  comments.append("TRACKNUMBER=" + QByteArray::number(info.track));
+  comments.append("TRACKTOTAL=" + QByteArray::number(info.totalTracks));
+  comments.append("DATE=" + QByteArray::number(info.year));
+  comments.append("GENRE=" + info.genre.toUtf8());
+  comments.append("COMMENT=" + info.comment.toUtf8());
+  for (QList<QPair<QString, QString> >::const_iterator it =
+         info.userFrames.constBegin();
+       it != info.userFrames.constEnd();
+       ++it) {
+    comments.append(it->first.toUtf8() + '=' + it->second.toUtf8());
+  }
+  if (withPicture && !info.picture.isEmpty()) {
+    comments.append("METADATA_BLOCK_PICTURE=" +
+                    flacPicture(info).toBase64());
+  }
+
+  const QByteArray vendor("kid3-bench");
+  QByteArray data;
+  appendLe32(data, vendor.size());
+  data += vendor;
+  appendLe32(data, comments.size());
+  foreach (const QByteArray& comment, comments) {
+    appendLe32(data, comment.size());
+    data += comment;
+  }
+  if (framingBit) {
+    data += '\x01';
+  }
+  return data;
+}
+
+QByteArray mp3File(const TrackInfo& info)
+{
+  QByteArray frame(MpegFrameSize, '\0');
+  frame[0] = static_cast<char>(0xff);
+  frame[1] = static_cast<char>(0xfb);
+  frame[2] = static_cast<char>(0x90);
+  const int numFrames = AudioSeconds * SampleRate / MpegFrameSamples;
+  QByteArray data = id3v2Tag(info);
+  for (int i = 0; i < numFrames; ++i) {
+    data += frame;
+  }
+  data += apeTag(info);
+  data += id3v1Tag(info);
+  return data;
+}
+
+QByteArray flacBlock(int type, const QByteArray& data, bool last = false)
+{
+  QByteArray block;
+  block += static_cast<char>((last ? 0x80 : 0) | type);
+  appendBe24(block, data.size());
+  block += data;
+  return block;
+}
+
+QByteArray flacFile(const TrackInfo& info)
+{
+  QByteArray streamInfo;
+  appendBe16(streamInfo, 4096);
+  appendBe16(streamInfo, 4096);
+  appendBe24(streamInfo, 0);
+  appendBe24(streamInfo, 0);
+  // Sample rate (20 bits), channels - 1 (3 bits), bits per sample - 1
+  // (5 bits) and total number of samples (36 bits).
+  appendBe64(streamInfo, (static_cast<quint64>(SampleRate) << 44) |
+             (Q_UINT64_C(1) << 41) | (Q_UINT64_C(15) << 36) |
+             static_cast<quint64>(SampleRate * AudioSeconds));
+  streamInfo += QByteArray(16, '\0');
+
+  QByteArray data("fLaC");
+  data += flacBlock(0, streamInfo);
+  data += flacBlock(4, vorbisComment(info, false, false));
+  if (!info.picture.isEmpty()) {
+    data += flacBlock(6, flacPicture(info));
+  }
+  data += flacBlock(1, QByteArray(TagPadding, '\0'), true);
+  return data;
+}
+
+/**
+ * Writer for bit packed data as used in Vorbis headers, the bits are
+ * filled starting with the least significant bit of each byte.
+ */
+class BitWriter {
+public:
+  BitWriter() : m_bitPos(0) {}
+
+  void write(quint32 value, int bits) {
+    for (int i = 0; i < bits; ++i) {
+      if (m_bitPos == 0) {
+        m_data += '\0';
+      }
+      if ((value >> i) & 1) {
+        char& byte = m_data[m_data.size() - 1];
+        byte = static_cast<char>(static_cast<uchar>(byte) | (1 << m_bitPos));
+      }
+      m_bitPos = (m_bitPos + 1) & 7;
+    }
+  }
+
+  void writeBytes(const char* str, int len) {
+    for (int i = 0; i < len; ++i) {
+      write(static_cast<uchar>(str[i]), 8);
+    }
+  }
+
+  QByteArray data() const { return m_data; }
+
+private:
+  QByteArray m_data;
+  int m_bitPos;
+};
+
+/**
+ * Create the smallest valid Vorbis setup header.
+ * It has a single codebook with two entries, one floor of type 1 without
+ * partitions, one residue of type 0, one mapping and one mode.
+ * @return setup header packet.
+ */
+QByteArray vorbisSetupHeader()
+{
+  BitWriter w;
+  w.writeBytes("\x05vorbis", 7);
+  w.write(0, 8);          // codebook count - 1
+  w.write(0x564342, 24);  // codebook sync pattern
+  w.write(1, 16);         // dimensions
+  w.write(2, 24);         // entries
+  w.write(0, 1);          // not ordered
+  w.write(0, 1);          // not sparse
+  w.write(0, 5);          // codeword length - 1 of entry 0
+  w.write(0, 5);          // codeword length - 1 of entry 1
+  w.write(0, 4);          // no lookup table
+  w.write(0, 6);          // time domain transform count - 1
+  w.write(0, 16);         // time domain transform type
+  w.write(0, 6);          // floor count - 1
+  w.write(1, 16);         // floor type 1
+  w.write(0, 5);          // floor partitions
+  w.write(0, 2);          // floor multiplier - 1
+  w.write(8, 4);          // floor range bits
+  w.write(0, 6);          // residue count - 1
+  w.write(0, 16);         // residue type 0
+  w.write(0, 24);         // residue begin
+  w.write(0, 24);         // residue end
+  w.write(0, 24);         // residue partition size - 1
+  w.write(0, 6);          // residue classifications - 1
+  w.write(0, 8);          // residue classbook
+  w.write(0, 3);          // residue cascade low bits
+  w.write(0, 1);          // no residue cascade high bits
+  w.write(0, 6);          // mapping count - 1
+  w.write(0, 16);         // mapping type 0
+  w.write(0, 1);          // single submap
+  w.write(0, 1);          // no coupling
+  w.write(0, 2);          // reserved
+  w.write(0, 8);          // submap time configuration
+  w.write(0, 8);          // submap floor
+  w.write(0, 8);          // submap residue
+  w.write(0, 6);          // mode count - 1
+  w.write(0, 1);          // block flag
+  w.write(0, 16);         // window type
+  w.write(0, 16);         // transform type
+  w.write(0, 8);          // mapping
+  w.write(1, 1);          // framing bit
+  return w.data();
+}
+
+/**
+ * Calculate the CRC of an Ogg page.
+ * @param data page with zero checksum field
+ * @return checksum.
+ */
+quint32 oggCrc(const QByteArray& data)
+{
+  static quint32 table[256];
+  static bool tableInitialized = false;
+  if (!tableInitialized) {
+    for (quint32 i = 0; i < 256; ++i) {
+      quint32 r = i << 24;
+      for (int j = 0; j < 8; ++j) {
+        r = (r & 0x80000000U) ? (r << 1) ^ 0x04c11db7U : r << 1;
+      }
+      table[i] = r;
+    }
+    tableInitialized = true;
+  }
+  quint32 crc = 0;
+  for (int i = 0; i < data.size(); ++i) {
+    crc = (crc << 8) ^
+        table[((crc >> 24) & 0xff) ^ static_cast<uchar>(data.at(i))];
+  }
+  return crc;
+}
+
+/**
+ * Writer for packets of a logical Ogg bitstream.
+ */
+class OggWriter {
+public:
+  OggWriter()
+    : m_sequenceNumber(0), m_beginOfStream(true), m_continued(false),
+      m_packetEnded(false) {}
+
+  /**
+   * Add a packet to the current page, full pages are flushed with
+   * granule position 0 as used for header packets.
+   * @param packet packet data
+   */
+  void addPacket(const QByteArray& packet) {
+    int pos = 0;
+    for (;;) {
+      if (m_lacing.size() == 255) {
+        flush(0);
+        m_continued = pos > 0;
+      }
+      const int len = qMin(packet.size() - pos, 255);
+      m_lacing += static_cast<char>(len);
+      m_body += packet.mid(pos, len);
+      pos += len;
+      if (len < 255) {
+        m_packetEnded = true;
+        break;
+      }
+    }
+  }
+
+  /**
+   * Write the current page.
+   * @param granulePosition granule position of last packet ending on page
+   * @param endOfStream true if this is the last page
+   */
+  void flush(qint64 granulePosition, bool endOfStream = false) {
+    if (m_lacing.isEmpty())
+      return;
+
+    QByteArray page("OggS\0", 5);
+    page += static_cast<char>((m_continued ? 1 : 0) |
+                              (m_beginOfStream ? 2 : 0) |
+                              (endOfStream ? 4 : 0));
+    appendLe64(page, m_packetEnded ? granulePosition : -1);
+    appendLe32(page, 0x6b696433);
+    appendLe32(page, m_sequenceNumber++);
+    appendLe32(page, 0);
+    page += static_cast<char>(m_lacing.size());
+    page += m_lacing;
+    page += m_body;
+    const quint32 crc = oggCrc(page);
+    for (int i = 0; i < 4; ++i) {
+      page[22 + i] = static_cast<char>((crc >> (8 * i)) & 0xff);
+    }
+    m_data += page;
+    m_lacing.clear();
+    m_body.clear();
+    m_beginOfStream = false;
+    m_continued = false;
+    m_packetEnded = false;
+  }
+
+  QByteArray data() const { return m_data; }
+
+private:
+  QByteArray m_data;
+  QByteArray m_lacing;
+  QByteArray m_body;
+  quint32 m_sequenceNumber;
+  bool m_beginOfStream;
+  bool m_continued;
+  bool m_packetEnded;
+};
+
+QByteArray oggFile(const TrackInfo& info)
+{
+  QByteArray identification("\x01vorbis");
+  appendLe32(identification, 0);
+  identification += '\x02';
+  appendLe32(identification, SampleRate);
+  appendLe32(identification, 0);
+  appendLe32(identification, 128000);
+  appendLe32(identification, 0);
+  identification += '\xb8';  // block sizes 256 and 2048
+  identification += '\x01';
+
+  OggWriter writer;
+  writer.addPacket(identification);
+  writer.flush(0);
+  writer.addPacket("\x03vorbis" + vorbisComment(info, true, true));
+  writer.addPacket(vorbisSetupHeader());
+  writer.flush(0);
+  // Audio packets with unused floors decode to silence of the short block
+  // size, every packet except the first one contributes 128 samples.
+  for (int i = 0; i < VorbisAudioPackets; ++i) {
+    writer.addPacket(QByteArray(1, '\0'));
+  }
+  writer.flush((VorbisAudioPackets - 1) * 128, true);
+  return writer.data();
+}
+
+QByteArray mp4Box(const char* type, const QByteArray& payload)
+{
+  QByteArray box;
+  appendBe32(box, 8 + payload.size());
+  box.append(type, 4);
+  box += payload;
+  return box;
+}
+
+QByteArray mp4FullBox(const char* type, int flags, const QByteArray& payload)
+{
+  QByteArray data;
+  appendBe32(data, flags & 0xffffff);
+  data += payload;
+  return mp4Box(type, data);
+}
+
+QByteArray mp4DataBox(int dataType, const QByteArray& value)
+{
+  QByteArray data;
+  appendBe32(data, dataType);
+  appendBe32(data, 0);
+  data += value;
+  return mp4Box("data", data);
+}
+
+QByteArray mp4TextItem(const char* type, const QString& text)
+{
+  return mp4Box(type, mp4DataBox(1, text.toUtf8()));
+}
+
+QByteArray mp4Descriptor(int tag, const QByteArray& payload)
+{
+  QByteArray descriptor;
+  descriptor += static_cast<char>(tag);
+  descriptor += static_cast<char>(payload.size());
+  descriptor += payload;
+  return descriptor;
+}
+
+void appendMatrix(QByteArray& ba)
+{
+  static const quint32 matrix[9] = {
+    0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000
+  };
+  for (int i = 0; i < 9; ++i) {
+    appendBe32(ba, matrix[i]);
+  }
+}
+
+/**
+ * Create MP4 movie box.
+ * @param info tag values
+ * @param numSamples number of audio samples
+ * @param mdatOffset file offset of audio data
+ * @return moov box.
+ */
+QByteArray mp4MovieBox(const TrackInfo& info, int numSamples,
+                       quint32 mdatOffset)
+{
+  const quint32 durationMs = AudioSeconds * 1000;
+
+  QByteArray mvhd;
+  appendBe32(mvhd, 0);
+  appendBe32(mvhd, 0);
+  appendBe32(mvhd, 1000);
+  appendBe32(mvhd, durationMs);
+  appendBe32(mvhd, 0x00010000);
+  appendBe16(mvhd, 0x0100);
+  mvhd += QByteArray(10, '\0');
+  appendMatrix(mvhd);
+  mvhd += QByteArray(24, '\0');
+  appendBe32(mvhd, 2);
+
+  QByteArray tkhd;
+  appendBe32(tkhd, 0);
+  appendBe32(tkhd, 0);
+  appendBe32(tkhd, 1);
+  appendBe32(tkhd, 0);
+  appendBe32(tkhd, durationMs);
+  tkhd += QByteArray(8, '\0');
+  appendBe16(tkhd, 0);
+  appendBe16(tkhd, 0);
+  appendBe16(tkhd, 0x0100);
+  appendBe16(tkhd, 0);
+  appendMatrix(tkhd);
+  appendBe32(tkhd, 0);
+  appendBe32(tkhd, 0);
+
+  QByteArray mdhd;
+  appendBe32(mdhd, 0);
+  appendBe32(mdhd, 0);
+  appendBe32(mdhd, SampleRate);
+  appendBe32(mdhd, numSamples * AacFrameSamples);
+  appendBe16(mdhd, 0x55c4);  // "und"
+  appendBe16(mdhd, 0);
+
+  QByteArray hdlr;
+  appendBe32(hdlr, 0);
+  hdlr += "soun";
+  hdlr += QByteArray(12, '\0');
+  hdlr += QByteArray("SoundHandler\0", 13);
+
+  QByteArray esds;
+  QByteArray decoderConfig;
+  decoderConfig += '\x40';  // MPEG-4 audio
+  decoderConfig += '\x15';  // audio stream
+  appendBe24(decoderConfig, 0);
+  appendBe32(decoderConfig, 128000);
+  appendBe32(decoderConfig, 128000);
+  decoderConfig += mp4Descriptor(5, QByteArray("\x12\x10", 2));  // AAC LC
+  QByteArray esDescriptor;
+  appendBe16(esDescriptor, 0);
+  esDescriptor += '\0';
+  esDescriptor += mp4Descriptor(4, decoderConfig);
+  esDescriptor += mp4Descriptor(6, QByteArray("\x02", 1));
+  esds += mp4Descriptor(3, esDescriptor);
+
+  QByteArray mp4a;
+  mp4a += QByteArray(6, '\0');
+  appendBe16(mp4a, 1);
+  mp4a += QByteArray(8, '\0');
+  appendBe16(mp4a, 2);
+  appendBe16(mp4a, 16);
+  appendBe16(mp4a, 0);
+  appendBe16(mp4a, 0);
+  appendBe32(mp4a, static_cast<quint32>(SampleRate) << 16);
+  mp4a += mp4FullBox("esds", 0, esds);
+
+  QByteArray stsd;
+  appendBe32(stsd, 1);
+  stsd += mp4Box("mp4a", mp4a);
+
+  QByteArray stts;
+  appendBe32(stts, 1);
+  appendBe32(stts, numSamples);
+  appendBe32(stts, AacFrameSamples);
+
+  QByteArray stsc;
+  appendBe32(stsc, 1);
+  appendBe32(stsc, 1);
+  appendBe32(stsc, numSamples);
+  appendBe32(stsc, 1);
+
+  QByteArray stsz;
+  appendBe32(stsz, 0);
+  appendBe32(stsz, numSamples);
+  for (int i = 0; i < numSamples; ++i) {
+    appendBe32(stsz, AacFrameSize);
+  }
+
+  QByteArray stco;
+  appendBe32(stco, 1);
+  appendBe32(stco, mdatOffset);
+
+  QByteArray dref;
+  appendBe32(dref, 1);
+  dref += mp4FullBox("url ", 1, QByteArray());
+
+  QByteArray trak =
+      mp4FullBox("tkhd", 7, tkhd) +
+      mp4Box("mdia",
+             mp4FullBox("mdhd", 0, mdhd) +
+             mp4FullBox("hdlr", 0, hdlr) +
+             mp4Box("minf",
+                    mp4FullBox("smhd", 0, QByteArray(4, '\0')) +
+                    mp4Box("dinf", mp4FullBox("dref", 0, dref)) +
+                    mp4Box("stbl",
+                           mp4FullBox("stsd", 0, stsd) +
+                           mp4FullBox("stts", 0, stts) +
+                           mp4FullBox("stsc", 0, stsc) +
+                           mp4FullBox("stsz", 0, stsz) +
+                           mp4FullBox("stco", 0, stco))));
+
+  QByteArray ilst;
+  ilst += mp4TextItem("\xa9" "nam", info.title);
+  ilst += mp4TextItem("\xa9" "ART", info.artist);
+  ilst += mp4TextItem("\xa9" "alb", info.album);
+  ilst += mp4TextItem("\xa9" "day", QString::number(info.year));
+  ilst += mp4TextItem("\xa9" "gen", info.genre);
+  ilst += mp4TextItem("\xa9" "cmt", info.comment);
+  QByteArray trkn(2, '\0');
+  appendBe16(trkn, info.track);
+  appendBe16(trkn, info.totalTracks);
+  trkn += QByteArray(2, '\0');
+  ilst += mp4Box("trkn", mp4DataBox(0, trkn));
+  for (QList<QPair<QString, QString> >::const_iterator it =
+         info.userFrames.constBegin();
+       it != info.userFrames.constEnd();
+       ++it) {
+    ilst += mp4Box("----",
+                   mp4FullBox("mean", 0, "com.apple.iTunes") +
+                   mp4FullBox("name", 0, it->first.toUtf8()) +
+                   mp4DataBox(1, it->second.toUtf8()));
+  }
+  if (!info.picture.isEmpty()) {
+    ilst += mp4Box("covr", mp4DataBox(13, info.picture));
+  }
+
+  QByteArray metaHdlr;
+  appendBe32(metaHdlr, 0);
+  metaHdlr += "mdirappl";
+  metaHdlr += QByteArray(9, '\0');
+  QByteArray meta = mp4FullBox("meta", 0,
+                               mp4FullBox("hdlr", 0, metaHdlr) +
+                               mp4Box("ilst", ilst) +
+                               mp4Box("free", QByteArray(TagPadding, '\0')));
+
+  return mp4Box("moov",
+                mp4FullBox("mvhd", 0, mvhd) +
+                mp4Box("trak", trak) +
+                mp4Box("udta", meta));
+}
+
+QByteArray m4aFile(const TrackInfo& info)
+{
+  QByteArray ftyp("M4A ");
+  appendBe32(ftyp, 0);
+  ftyp += "M4A mp42isom";
+  ftyp = mp4Box("ftyp", ftyp);
+
+  const int numSamples = AudioSeconds * SampleRate / AacFrameSamples;
+  // The size of the movie box does not depend on the offset of the audio.
+  const quint32 mdatOffset =
+      ftyp.size() + mp4MovieBox(info, numSamples, 0).size() + 8;
+  return ftyp + mp4MovieBox(info, numSamples, mdatOffset) +
+      mp4Box("mdat", QByteArray(numSamples * AacFrameSize, '\0'));
+}
+
+QByteArray riffChunk(const char* id, const QByteArray& data)
+{
+  QByteArray chunk(id, 4);
+  appendLe32(chunk, data.size());
+  chunk += data;
+  if (data.size() & 1) {
+    chunk += '\0';
+  }
+  return chunk;
+}
+
+QByteArray wavFile(const TrackInfo& info)
+{
+  const int channels = 2;
+  const int bytesPerSample = 2;
+  QByteArray fmt;
+  appendLe16(fmt, 1);
+  appendLe16(fmt, channels);
+  appendLe32(fmt, SampleRate);
+  appendLe32(fmt, SampleRate * channels * bytesPerSample);
+  appendLe16(fmt, channels * bytesPerSample);
+  appendLe16(fmt, 8 * bytesPerSample);
+
+  QByteArray chunks("WAVE");
+  chunks += riffChunk("fmt ", fmt);
+  chunks += riffChunk("data", QByteArray(
+                        SampleRate * channels * bytesPerSample * AudioSeconds,
+                        '\0'));
+  chunks += riffChunk("id3 ", id3v2Tag(info));
+  return riffChunk("RIFF", chunks);
+}
+
+QByteArray dsfFile(const TrackInfo& info)
+{
+  const int channels = 2;
+  const quint64 dataSize = DsfBlockSize * channels * DsfBlocks;
+  const QByteArray tag = id3v2Tag(info);
+  const quint64 metadataOffset = 28 + 52 + 12 + dataSize;
+
+  QByteArray data("DSD ");
+  appendLe64(data, 28);
+  appendLe64(data, metadataOffset + tag.size());
+  appendLe64(data, metadataOffset);
+  data += "fmt ";
+  appendLe64(data, 52);
+  appendLe32(data, 1);
+  appendLe32(data, 0);
+  appendLe32(data, 2);
+  appendLe32(data, channels);
+  appendLe32(data, 2822400);
+  appendLe32(data, 1);
+  appendLe64(data, static_cast<quint64>(DsfBlockSize) * 8 * DsfBlocks);
+  appendLe32(data, DsfBlockSize);
+  appendLe32(data, 0);
+  data += "data";
+  appendLe64(data, 12 + dataSize);
+  data += QByteArray(static_cast<int>(dataSize), '\x69');  // DSD silence
+  data += tag;
+  return data;
+}
+
+}
+
+/**
+ * Constructor.
+ */
+SynthLibraryGenerator::SynthLibraryGenerator()
+  : m_numFiles(100), m_numFrames(10), m_pictureSize(50000)
+{
+}
+
+/**
+ * Get name of a format, which is also used as the directory name.
+ * @param format file format
+ * @return format name, e.g. "mp3".
+ */
+QString SynthLibraryGenerator::formatName(Format format)
+{
+  static const char* const names[] = {
+    "mp3", "flac", "ogg", "m4a", "wav", "dsf"
+  };
+  return format >= 0 && format < NumFormats
+      ? QLatin1String(names[format]) : QString();
+}
+
+/**
+ * Generate the files of a format.
+ * @param dirPath path of directory, it is created if it does not exist
+ * @param format file format
+ * @return paths of generated files, empty if writing failed.
+ */
+QStringList SynthLibraryGenerator::generate(const QString& dirPath,
+                                            Format format) const
+{
+  QStringList filePaths;
+  QDir dir(dirPath);
+  if (!dir.mkpath(QLatin1String("."))) {
+    return filePaths;
+  }
+  for (int i = 0; i < m_numFiles; ++i) {
+    const int albumIndex = i / TracksPerAlbum;
+    QString fileName = QString(QLatin1String("%1 Artist %2 - Title %3.%4"))
+        .arg(i + 1, 4, 10, QLatin1Char('0'))
+        .arg(albumIndex % NumArtists + 1)
+        .arg(i + 1)
+        .arg(formatName(format));
+    QString filePath = dir.filePath(fileName);
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(generateFile(format, i)) == -1) {
+      return QStringList();
+    }
+    filePaths.append(filePath);
+  }
+  return filePaths;
+}
+
+/**
+ * Generate the data of a file.
+ * @param format file format
+ * @param trackIndex index of track, determines the tag values
+ * @return file contents.
+ */
+QByteArray SynthLibraryGenerator::generateFile(Format format,
+                                               int trackIndex) const
+{
+  const TrackInfo info = createTrackInfo(trackIndex, m_numFrames,
+                                         m_pictureSize);
+  switch (format) {
+  case Mp3:
+    return mp3File(info);
+  case Flac:
+    return flacFile(info);
+  case Ogg:
+    return oggFile(info);
+  case M4a:
+    return m4aFile(info);
+  case Wav:
+    return wavFile(info);
+  case Dsf:
+    return dsfFile(info);
+  case NumFormats:
+    break;
+  }
+  return QByteArray();
+}
@@ -0,0 +1,125 @@
+/**
+ * \file synthlibrarygenerator.h
+ * Generator for synthetic libraries of tagged audio files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYNTHLIBRARYGENERATOR_H
+#define SYNTHLIBRARYGENERATOR_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+/**
+ * Generator for deterministic libraries of small audio files with tags.
+ *
+ * The files are written byte by byte without using any of the metadata
+ * plugins, so that the same library is generated for every commit and
+ * every plugin. The audio data consists of silent or empty frames which
+ * are just valid enough to be accepted by the metadata libraries.
+ */
+class SynthLibraryGenerator {
+public:
+  /** Generated file formats. */
+  enum Format {
+    Mp3,  /**< MPEG audio with ID3v1, ID3v2.3 and APE tags */
+    Flac, /**< FLAC with Vorbis comments and picture block */
+    Ogg,  /**< Ogg Vorbis with Vorbis comments */
+    M4a,  /**< MP4 audio with iTunes metadata */
+    Wav,  /**< WAV with ID3v2.3 chunk */
+    Dsf,  /**< DSF with ID3v2.3 tag */
+    NumFormats
+  };
+
+  /**
+   * Constructor.
+   */
+  SynthLibraryGenerator();
+
+  /**
+   * Set number of files generated for each format.
+   * @param numFiles number of files
+   */
+  void setNumberOfFiles(int numFiles) { m_numFiles = numFiles; }
+
+  /**
+   * Get number of files generated for each format.
+   * @return number of files.
+   */
+  int numberOfFiles() const { return m_numFiles; }
+
+  /**
+   * Set number of additional user defined frames in each tag.
+   * @param numFrames number of frames in addition to the standard frames
+   */
+  void setNumberOfFrames(int numFrames) { m_numFrames = numFrames; }
+
+  /**
+   * Get number of additional user defined frames in each tag.
+   * @return number of frames.
+   */
+  int numberOfFrames() const { return m_numFrames; }
+
+  /**
+   * Set size of embedded pictures.
+   * @param size size of picture data in bytes, 0 to embed no picture
+   */
+  void setPictureSize(int size) { m_pictureSize = size; }
+
+  /**
+   * Get size of embedded pictures.
+   * @return size in bytes.
+   */
+  int pictureSize() const { return m_pictureSize; }
+
+  /**
+   * Get name of a format, which is also used as the directory name.
+   * @param format file format
+   * @return format name, e.g. "mp3".
+   */
+  static QString formatName(Format format);
+
+  /**
+   * Generate the files of a format.
+   * @param dirPath path of directory, it is created if it does not exist
+   * @param format file format
+   * @return paths of generated files, empty if writing failed.
+   */
+  QStringList generate(const QString& dirPath, Format format) const;
+
+  /**
+   * Generate the data of a file.
+   * @param format file format
+   * @param trackIndex index of track, determines the tag values
+   * @return file contents.
+   */
+  QByteArray generateFile(Format format, int trackIndex) const;
+
+private:
+  int m_numFiles;
+  int m_numFrames;
+  int m_pictureSize;
+};
+
+#endif // SYNTHLIBRARYGENERATOR_H
@@ -616,6 +616,8 @@ class CliFunctionsTestCase(unittest.TestCase):
                 self.assertEqual(export_csv, import_csv)
             os.remove(importpath)
             os.remove(exportpath)
+            self.assertEqual(call_kid3_cli(
+                ['-c', 'export - "CSV unquoted"', tmpdir]), import_csv)
             expected = (
                 'File: MP4 9 kbps 44100 Hz 2 Channels \n'
                 '  Name: track00.m4a\n'
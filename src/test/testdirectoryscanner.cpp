@@ -0,0 +1,199 @@
+/**
+ * \file testdirectoryscanner.cpp
+ * Test directory scanner.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testdirectoryscanner.h"
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include "directoryscanner.h"
+
+namespace {
+
+/**
+ * Remove a directory with all its contents.
+ * @param path path of directory
+ * @return true if ok.
+ */
+bool removeDirectory(const QString& path)
+{
+  QDir dir(path);
+  foreach (const QFileInfo& fi, dir.entryInfoList(
+             QDir::AllEntries | QDir::NoDotAndDotDot |
+             QDir::Hidden | QDir::System)) {
+    if (fi.isDir() && !fi.isSymLink()) {
+      if (!removeDirectory(fi.filePath()))
+        return false;
+    } else if (!QFile::remove(fi.filePath())) {
+      return false;
+    }
+  }
+  return QDir().rmdir(path);
+}
+
+/**
+ * Get the extensions used for the tests.
+ * @return extensions.
+ */
+QStringList audioExtensions()
+{
+  return QStringList() << QLatin1String(".mp3") << QLatin1String(".flac");
+}
+
+}
+
+void TestDirectoryScanner::initTestCase()
+{
+  m_rootPath = QDir::temp().filePath(
+        QLatin1String("kid3_testdirectoryscanner"));
+  removeDirectory(m_rootPath);
+  static const char* const dirs[] = {
+    "a/sub", "skip", ".hidden", 0
+  };
+  static const char* const files[] = {
+    "b.mp3", "c.MP3", ".x.mp3", "a/2.mp3", "a/1.flac", "a/cover.jpg",
+    "a/sub/3.mp3", "skip/4.mp3", ".hidden/5.mp3", 0
+  };
+  QDir root(QDir::tempPath());
+  for (const char* const* dir = dirs; *dir; ++dir) {
+    QVERIFY(root.mkpath(m_rootPath + QLatin1Char('/') +
+                        QLatin1String(*dir)));
+  }
+  for (const char* const* file = files; *file; ++file) {
+    QFile f(m_rootPath + QLatin1Char('/') + QLatin1String(*file));
+    QVERIFY(f.open(QIODevice::WriteOnly));
+  }
+}
+
+void TestDirectoryScanner::cleanupTestCase()
+{
+  removeDirectory(m_rootPath);
+}
+
+QStringList TestDirectoryScanner::paths(const char* const* relPaths) const
+{
+  QStringList result;
+  result.append(m_rootPath);
+  for (const char* const* relPath = relPaths; *relPath; ++relPath) {
+    result.append(m_rootPath + QLatin1Char('/') + QLatin1String(*relPath));
+  }
+  return result;
+}
+
+void TestDirectoryScanner::testOrder()
+{
+  static const char* const expected[] = {
+    "a", "a/1.flac", "a/2.mp3", "a/sub", "a/sub/3.mp3",
+    "b.mp3", "c.MP3", "skip", "skip/4.mp3", 0
+  };
+  DirectoryScanner scanner;
+  scanner.setExtensions(audioExtensions());
+  QCOMPARE(scanner.scan(QStringList() << m_rootPath), paths(expected));
+  QCOMPARE(scanner.numberOfDirectories(), 4);
+
+  // A file as root is only listed itself.
+  const QString filePath = m_rootPath + QLatin1String("/b.mp3");
+  QCOMPARE(scanner.scan(QStringList() << filePath),
+           QStringList() << filePath);
+
+  // Without extensions, all files are listed.
+  scanner.setExtensions(QStringList());
+  QVERIFY(scanner.scan(QStringList() << m_rootPath).contains(
+            m_rootPath + QLatin1String("/a/cover.jpg")));
+}
+
+void TestDirectoryScanner::testFolderFilters()
+{
+  DirectoryScanner scanner;
+  scanner.setExtensions(audioExtensions());
+  scanner.setFolderFilters(QStringList(),
+                           QStringList() << QLatin1String("*/skip"));
+  static const char* const excluded[] = {
+    "a", "a/1.flac", "a/2.mp3", "a/sub", "a/sub/3.mp3", "b.mp3", "c.MP3", 0
+  };
+  QCOMPARE(scanner.scan(QStringList() << m_rootPath), paths(excluded));
+
+  // Folders which are not included are listed but not entered.
+  scanner.setFolderFilters(QStringList() << QLatin1String("*/a"),
+                           QStringList());
+  static const char* const included[] = {
+    "a", "a/1.flac", "a/2.mp3", "a/sub", "b.mp3", "c.MP3", "skip", 0
+  };
+  QCOMPARE(scanner.scan(QStringList() << m_rootPath), paths(included));
+}
+
+void TestDirectoryScanner::testHiddenFiles()
+{
+  DirectoryScanner scanner;
+  scanner.setExtensions(audioExtensions());
+  scanner.setShowHiddenFiles(true);
+  QStringList result = scanner.scan(QStringList() << m_rootPath);
+  QCOMPARE(result.size(), 13);
+  QCOMPARE(result.at(1), m_rootPath + QLatin1String("/.hidden"));
+  QCOMPARE(result.at(2), m_rootPath + QLatin1String("/.hidden/5.mp3"));
+  QCOMPARE(result.at(3), m_rootPath + QLatin1String("/.x.mp3"));
+}
+
+void TestDirectoryScanner::testAsynchronous()
+{
+  DirectoryScanner scanner;
+  scanner.setExtensions(audioExtensions());
+  QSignalSpy spy(&scanner, SIGNAL(finished()));
+  scanner.start(QStringList() << m_rootPath);
+  QVERIFY(scanner.isRunning());
+  for (int i = 0; i < 100 && spy.isEmpty(); ++i) {
+    QTest::qWait(50);
+  }
+  QCOMPARE(spy.count(), 1);
+  QVERIFY(!scanner.isRunning());
+  QCOMPARE(scanner.paths().size(), 10);
+
+  // An aborted scan finishes without results.
+  scanner.start(QStringList() << m_rootPath);
+  scanner.abort();
+  for (int i = 0; i < 100 && spy.count() < 2; ++i) {
+    QTest::qWait(50);
+  }
+  QCOMPARE(spy.count(), 2);
+  QVERIFY(scanner.paths().isEmpty());
+}
+
+void TestDirectoryScanner::testSymbolicLinkLoop()
+{
+#ifdef Q_OS_UNIX
+  const QString linkPath = m_rootPath + QLatin1String("/a/sub/loop");
+  QVERIFY(QFile::link(m_rootPath + QLatin1String("/a"), linkPath));
+  DirectoryScanner scanner;
+  scanner.setExtensions(audioExtensions());
+  QStringList result = scanner.scan(QStringList() << m_rootPath);
+  QFile::remove(linkPath);
+  // The link is listed, but the directory is not entered again.
+  int idx = result.indexOf(linkPath);
+  QVERIFY(idx > 0 && idx + 1 < result.size());
+  QCOMPARE(result.at(idx - 1), m_rootPath + QLatin1String("/a/sub/3.mp3"));
+  QCOMPARE(result.at(idx + 1), m_rootPath + QLatin1String("/b.mp3"));
+  QCOMPARE(result.size(), 11);
+#endif
+}
@@ -0,0 +1,142 @@
+/**
+ * \file testdirectorywatcher.cpp
+ * Test directory watcher.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testdirectorywatcher.h"
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include "directorywatcher.h"
+
+namespace {
+
+/**
+ * Write a file.
+ * @param path path of file
+ * @return true if ok.
+ */
+bool writeFile(const QString& path)
+{
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+  file.write("data");
+  file.close();
+  return true;
+}
+
+/**
+ * Wait until a signal spy has recorded signals.
+ * @param spy signal spy
+ * @param count number of expected signals
+ */
+void waitForSignals(const QSignalSpy& spy, int count)
+{
+  for (int i = 0; i < 100 && spy.count() < count; ++i) {
+    QTest::qWait(50);
+  }
+}
+
+}
+
+void TestDirectoryWatcher::init()
+{
+  m_dirPath = QDir::temp().filePath(
+        QLatin1String("kid3_testdirectorywatcher"));
+  QDir().mkpath(m_dirPath);
+}
+
+void TestDirectoryWatcher::cleanup()
+{
+  QDir dir(m_dirPath);
+  foreach (const QString& fileName, dir.entryList(QDir::Files)) {
+    dir.remove(fileName);
+  }
+  QDir().rmdir(m_dirPath);
+}
+
+void TestDirectoryWatcher::testChangedFiles()
+{
+  DirectoryWatcher watcher;
+  watcher.setCoalescingInterval(50);
+  QSignalSpy filesSpy(&watcher, SIGNAL(filesChanged(QStringList)));
+  QSignalSpy dirsSpy(&watcher, SIGNAL(directoriesChanged(QStringList)));
+  QVERIFY(watcher.addDirectory(m_dirPath));
+  QVERIFY(watcher.contains(m_dirPath));
+  QCOMPARE(watcher.count(), 1);
+
+  const QString path = m_dirPath + QLatin1String("/a.mp3");
+  QVERIFY(writeFile(path));
+  waitForSignals(filesSpy, 1);
+#ifdef Q_OS_LINUX
+  QCOMPARE(filesSpy.count(), 1);
+  QCOMPARE(filesSpy.first().first().toStringList(), QStringList() << path);
+  QCOMPARE(dirsSpy.count(), 0);
+#else
+  waitForSignals(dirsSpy, 1);
+  QCOMPARE(dirsSpy.count(), 1);
+  QCOMPARE(dirsSpy.first().first().toStringList(),
+           QStringList() << m_dirPath);
+#endif
+}
+
+void TestDirectoryWatcher::testCoalescing()
+{
+#ifdef Q_OS_LINUX
+  DirectoryWatcher watcher;
+  watcher.setCoalescingInterval(200);
+  QSignalSpy filesSpy(&watcher, SIGNAL(filesChanged(QStringList)));
+  QVERIFY(watcher.addDirectory(m_dirPath));
+
+  QStringList paths;
+  for (int i = 0; i < 50; ++i) {
+    paths.append(m_dirPath + QString(QLatin1String("/%1.mp3"))
+                 .arg(i, 2, 10, QLatin1Char('0')));
+    QVERIFY(writeFile(paths.last()));
+    // Overwrite to cause more events for the same file.
+    QVERIFY(writeFile(paths.last()));
+  }
+  waitForSignals(filesSpy, 1);
+  QCOMPARE(filesSpy.count(), 1);
+  QCOMPARE(filesSpy.first().first().toStringList(), paths);
+#endif
+}
+
+void TestDirectoryWatcher::testRemoveDirectory()
+{
+  DirectoryWatcher watcher;
+  watcher.setCoalescingInterval(50);
+  QSignalSpy filesSpy(&watcher, SIGNAL(filesChanged(QStringList)));
+  QSignalSpy dirsSpy(&watcher, SIGNAL(directoriesChanged(QStringList)));
+  QVERIFY(watcher.addDirectory(m_dirPath));
+  watcher.removeDirectory(m_dirPath);
+  QVERIFY(!watcher.contains(m_dirPath));
+  QCOMPARE(watcher.count(), 0);
+
+  QVERIFY(writeFile(m_dirPath + QLatin1String("/b.mp3")));
+  QTest::qWait(300);
+  QCOMPARE(filesSpy.count(), 0);
+  QCOMPARE(dirsSpy.count(), 0);
+}
@@ -0,0 +1,283 @@
+/**
+ * \file testfilefilter.cpp
+ * Test filtering files with expressions.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testfilefilter.h"
+#include <QMap>
+#if QT_VERSION >= 0x050100
+#include <QRegularExpression>
+#else
+#include <QRegExp>
+#endif
+#include "filefilter.h"
+#include "expressionparser.h"
+#include "taggedfile.h"
+
+namespace {
+
+/**
+ * Tagged file with fixed frames in tag 1 and tag 2.
+ */
+class FilterTaggedFile : public TaggedFile {
+public:
+  FilterTaggedFile() : TaggedFile(QPersistentModelIndex()) {
+    m_frames[Frame::Tag_1][Frame::FT_Title] = QLatin1String("Title One");
+    m_frames[Frame::Tag_1][Frame::FT_Artist] = QLatin1String("Artist");
+    m_frames[Frame::Tag_2][Frame::FT_Title] = QLatin1String("Second Title");
+    m_frames[Frame::Tag_2][Frame::FT_Artist] = QLatin1String("Artist");
+    m_frames[Frame::Tag_2][Frame::FT_Album] = QLatin1String("Album");
+  }
+
+  virtual QString taggedFileKey() const {
+    return QLatin1String("FilterMetadata");
+  }
+
+  virtual void readTags(bool) {}
+
+  virtual bool writeTags(bool, bool* renamed, bool) {
+    *renamed = false;
+    return true;
+  }
+
+  virtual void clearTags(bool) {}
+
+  virtual bool isTagInformationRead() const { return true; }
+
+  virtual void getDetailInfo(DetailInfo&) const {}
+
+  virtual unsigned getDuration() const { return 0; }
+
+  virtual QString getFileExtension() const {
+    return QLatin1String(".flt");
+  }
+
+  virtual bool getFrame(Frame::TagNumber tagNr, Frame::Type type,
+                        Frame& frame) const {
+    if (tagNr > Frame::Tag_2 || !m_frames[tagNr].contains(type))
+      return false;
+
+    frame.setType(type);
+    frame.setValue(m_frames[tagNr].value(type));
+    return true;
+  }
+
+  virtual bool setFrame(Frame::TagNumber, const Frame&) { return false; }
+
+  virtual QStringList getFrameIds(Frame::TagNumber) const {
+    return QStringList();
+  }
+
+private:
+  QMap<Frame::Type, QString> m_frames[Frame::Tag_2 + 1];
+};
+
+/**
+ * Filter evaluated with ExpressionParser for every file, as it was done
+ * before filter expressions were compiled.
+ */
+class ReferenceFilter {
+public:
+  /**
+   * Constructor.
+   * @param taggedFile file to check
+   */
+  explicit ReferenceFilter(TaggedFile& taggedFile)
+    : m_trackData1(taggedFile, Frame::TagV1),
+      m_trackData2(taggedFile, Frame::TagV2),
+      m_trackData12(taggedFile, Frame::TagV2V1) {}
+
+  /**
+   * Check if the file passes through the filter.
+   * @param expression filter expression
+   * @param ok false is returned here when parsing fails
+   * @return true if file passes through filter.
+   */
+  bool filter(const QString& expression, bool& ok) const {
+    ExpressionParser parser(QStringList() << QLatin1String("equals")
+                                          << QLatin1String("contains")
+                                          << QLatin1String("matches"));
+    parser.tokenizeRpn(expression);
+    QString op, var1, var2;
+    bool result = false;
+    parser.clearEvaluation();
+    while (parser.evaluate(op, var1, var2)) {
+      var1 = formatString(var1);
+      var2 = formatString(var2);
+      if (op == QLatin1String("equals")) {
+        parser.pushBool(var1 == var2);
+      } else if (op == QLatin1String("contains")) {
+        parser.pushBool(var2.indexOf(var1) >= 0);
+      } else if (op == QLatin1String("matches")) {
+        parser.pushBool(
+#if QT_VERSION >= 0x050100
+              QRegularExpression(var1).match(var2).hasMatch()
+#else
+              QRegExp(var1).indexIn(var2) != -1
+#endif
+              );
+      }
+    }
+    ok = !parser.hasError();
+    if (ok) {
+      parser.popBool(result);
+    }
+    return ok && result;
+  }
+
+private:
+  QString formatString(const QString& format) const {
+    if (format.indexOf(QLatin1Char('%')) == -1) {
+      return format;
+    }
+    QString str(format);
+    str.replace(QLatin1String("%1"), QLatin1String("\v1"));
+    str.replace(QLatin1String("%2"), QLatin1String("\v2"));
+    str = m_trackData12.formatString(str);
+    if (str.indexOf(QLatin1Char('\v')) != -1) {
+      str.replace(QLatin1String("\v2"), QLatin1String("%"));
+      str = m_trackData2.formatString(str);
+      if (str.indexOf(QLatin1Char('\v')) != -1) {
+        str.replace(QLatin1String("\v1"), QLatin1String("%"));
+        str = m_trackData1.formatString(str);
+      }
+    }
+    return str;
+  }
+
+  ImportTrackData m_trackData1;
+  ImportTrackData m_trackData2;
+  ImportTrackData m_trackData12;
+};
+
+}
+
+void TestFileFilter::testFilter_data()
+{
+  QTest::addColumn<QString>("expression");
+  QTest::addColumn<bool>("result");
+  QTest::addColumn<bool>("ok");
+
+  QTest::newRow("equals")
+      << QString(QLatin1String("%{artist} equals Artist")) << true << true;
+  QTest::newRow("equals tag 2 before tag 1")
+      << QString(QLatin1String("%{title} equals \"Title One\""))
+      << false << true;
+  QTest::newRow("tag 1")
+      << QString(QLatin1String("%1{title} equals \"Title One\""))
+      << true << true;
+  QTest::newRow("tag 2")
+      << QString(QLatin1String("%2{title} equals \"Second Title\""))
+      << true << true;
+  QTest::newRow("contains")
+      << QString(QLatin1String("%{album} contains lbu")) << true << true;
+  QTest::newRow("does not contain")
+      << QString(QLatin1String("%{album} contains Title")) << false << true;
+  QTest::newRow("matches")
+      << QString(QLatin1String("%{title} matches \"^Sec.*e$\""))
+      << true << true;
+  QTest::newRow("matches formatted pattern")
+      << QString(QLatin1String("\"Second Title\" matches %2{title}"))
+      << true << true;
+  QTest::newRow("does not match")
+      << QString(QLatin1String("%{title} matches ^Title")) << false << true;
+  QTest::newRow("not")
+      << QString(QLatin1String("not %{artist} equals Artist"))
+      << false << true;
+  QTest::newRow("and")
+      << QString(QLatin1String(
+                   "%{artist} equals Artist and %{album} equals Album"))
+      << true << true;
+  QTest::newRow("and before or")
+      << QString(QLatin1String(
+                   "%{album} equals Album or %{artist} equals X and "
+                   "%{title} equals X"))
+      << true << true;
+  QTest::newRow("not before and")
+      << QString(QLatin1String(
+                   "not %{artist} equals Artist and %{album} equals X"))
+      << false << true;
+  QTest::newRow("parentheses")
+      << QString(QLatin1String(
+                   "(%{album} equals Album or %{artist} equals X) and "
+                   "%{title} equals X"))
+      << false << true;
+  QTest::newRow("nested parentheses")
+      << QString(QLatin1String(
+                   "not (%{artist} equals X or (%{album} contains lb and "
+                   "%{title} contains Title))"))
+      << false << true;
+  QTest::newRow("boolean constant")
+      << QString(QLatin1String("true and %{artist} equals Artist"))
+      << true << true;
+  QTest::newRow("string result")
+      << QString(QLatin1String("%{artist}")) << false << true;
+  QTest::newRow("unbalanced parenthesis")
+      << QString(QLatin1String("(%{artist} equals Artist"))
+      << false << true;
+  QTest::newRow("missing operand")
+      << QString(QLatin1String("%{artist} equals")) << false << false;
+  QTest::newRow("missing operand of and")
+      << QString(QLatin1String("%{artist} equals Artist and"))
+      << false << false;
+  QTest::newRow("string operand of and")
+      << QString(QLatin1String("%{artist} and true")) << false << false;
+  QTest::newRow("not without operand")
+      << QString(QLatin1String("not")) << false << false;
+}
+
+void TestFileFilter::testFilter()
+{
+  QFETCH(QString, expression);
+  QFETCH(bool, result);
+  QFETCH(bool, ok);
+
+  FilterTaggedFile taggedFile;
+  bool referenceOk;
+  const bool referenceResult =
+      ReferenceFilter(taggedFile).filter(expression, referenceOk);
+  QCOMPARE(referenceResult, result);
+  QCOMPARE(referenceOk, ok);
+
+  FileFilter fileFilter;
+  fileFilter.setFilterExpression(expression);
+  fileFilter.initParser();
+  bool filterOk = !ok;
+  QCOMPARE(fileFilter.filter(taggedFile, &filterOk), referenceResult);
+  QCOMPARE(filterOk, referenceOk);
+  // The compiled expression can be evaluated repeatedly.
+  QCOMPARE(fileFilter.filter(taggedFile, &filterOk), referenceResult);
+  QCOMPARE(filterOk, referenceOk);
+}
+
+void TestFileFilter::testEmptyExpression()
+{
+  FilterTaggedFile taggedFile;
+  FileFilter fileFilter;
+  fileFilter.initParser();
+  QVERIFY(fileFilter.isEmptyFilterExpression());
+  bool ok = false;
+  QVERIFY(fileFilter.filter(taggedFile, &ok));
+  QVERIFY(ok);
+}
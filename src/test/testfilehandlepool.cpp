@@ -0,0 +1,229 @@
+/**
+ * \file testfilehandlepool.cpp
+ * Test cache of open file handles.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testfilehandlepool.h"
+#include "filehandlepool.h"
+
+namespace {
+
+/**
+ * Client simulating an open file handle.
+ */
+class HandleClient : public FileHandlePool::Client {
+public:
+  /**
+   * Constructor.
+   * @param refuseRelease true if the handle cannot be released
+   */
+  explicit HandleClient(bool refuseRelease = false)
+    : m_open(false), m_refuseRelease(refuseRelease), m_releaseRequests(0) {}
+
+  /**
+   * Open the handle or use the open handle.
+   */
+  void use() {
+    m_open = true;
+    FileHandlePool::instance().touch(this);
+  }
+
+  /**
+   * Close the handle.
+   */
+  void close() {
+    m_open = false;
+    FileHandlePool::instance().remove(this);
+  }
+
+  /**
+   * Check if the handle is open.
+   * @return true if open.
+   */
+  bool isOpen() const { return m_open; }
+
+  /**
+   * Get number of times the pool asked to release the handle.
+   * @return number of requests.
+   */
+  int releaseRequests() const { return m_releaseRequests; }
+
+protected:
+  virtual bool releaseFileHandle() {
+    ++m_releaseRequests;
+    if (m_refuseRelease)
+      return false;
+
+    close();
+    return true;
+  }
+
+private:
+  bool m_open;
+  bool m_refuseRelease;
+  int m_releaseRequests;
+};
+
+}
+
+void TestFileHandlePool::init()
+{
+  FileHandlePool::instance().resetCounters();
+}
+
+void TestFileHandlePool::cleanup()
+{
+  FileHandlePool::instance().setCapacity(0);
+  QCOMPARE(FileHandlePool::instance().size(), 0);
+}
+
+void TestFileHandlePool::testLeastRecentlyUsedOrder()
+{
+  FileHandlePool& pool = FileHandlePool::instance();
+  pool.setCapacity(3);
+  HandleClient a, b, c, d, e;
+  a.use();
+  b.use();
+  c.use();
+  QCOMPARE(pool.size(), 3);
+  QCOMPARE(pool.missCount(), Q_UINT64_C(3));
+  QCOMPARE(pool.hitCount(), Q_UINT64_C(0));
+
+  // Using a makes b the least recently used client.
+  a.use();
+  QCOMPARE(pool.hitCount(), Q_UINT64_C(1));
+  d.use();
+  QVERIFY(a.isOpen());
+  QVERIFY(!b.isOpen());
+  QVERIFY(c.isOpen());
+  QVERIFY(d.isOpen());
+
+  // Using the most recently used client again does not change the order.
+  d.use();
+  e.use();
+  QVERIFY(a.isOpen());
+  QVERIFY(!c.isOpen());
+  QVERIFY(d.isOpen());
+  QVERIFY(e.isOpen());
+  QCOMPARE(pool.size(), 3);
+  QCOMPARE(pool.hitCount(), Q_UINT64_C(2));
+  QCOMPARE(pool.missCount(), Q_UINT64_C(5));
+  QCOMPARE(pool.evictionCount(), Q_UINT64_C(2));
+
+  // A closed client is removed and counted as a miss when used again.
+  a.close();
+  QCOMPARE(pool.size(), 2);
+  b.use();
+  QCOMPARE(pool.size(), 3);
+  QCOMPARE(pool.missCount(), Q_UINT64_C(6));
+  QCOMPARE(pool.evictionCount(), Q_UINT64_C(2));
+}
+
+void TestFileHandlePool::testEviction()
+{
+  FileHandlePool& pool = FileHandlePool::instance();
+  pool.setCapacity(4);
+  HandleClient clients[6];
+  for (int i = 0; i < 6; ++i) {
+    clients[i].use();
+  }
+  QCOMPARE(pool.size(), 4);
+  QCOMPARE(pool.evictionCount(), Q_UINT64_C(2));
+  for (int i = 0; i < 6; ++i) {
+    QCOMPARE(clients[i].isOpen(), i >= 2);
+  }
+
+  // Reducing the capacity evicts the least recently used clients.
+  pool.setCapacity(1);
+  QCOMPARE(pool.size(), 1);
+  QCOMPARE(pool.evictionCount(), Q_UINT64_C(5));
+  for (int i = 0; i < 6; ++i) {
+    QCOMPARE(clients[i].isOpen(), i == 5);
+  }
+}
+
+void TestFileHandlePool::testRefusingClients()
+{
+  FileHandlePool& pool = FileHandlePool::instance();
+  pool.setCapacity(2);
+  HandleClient refusing(true), b, c;
+  refusing.use();
+  b.use();
+  c.use();
+
+  // The refusing client is skipped and the next one evicted instead.
+  QCOMPARE(pool.size(), 2);
+  QCOMPARE(pool.evictionCount(), Q_UINT64_C(1));
+  QCOMPARE(refusing.releaseRequests(), 1);
+  QVERIFY(refusing.isOpen());
+  QVERIFY(!b.isOpen());
+  QVERIFY(c.isOpen());
+
+  // c is now the least recently used client.
+  HandleClient d;
+  d.use();
+  QCOMPARE(pool.size(), 2);
+  QCOMPARE(refusing.releaseRequests(), 1);
+  QVERIFY(!c.isOpen());
+  QVERIFY(d.isOpen());
+
+  // If no client can be released, the capacity is exceeded, but each
+  // eviction asks a client only once and the most recently used one not
+  // at all.
+  pool.setCapacity(1);
+  QCOMPARE(pool.size(), 2);
+  QCOMPARE(refusing.releaseRequests(), 2);
+  QVERIFY(d.isOpen());
+  HandleClient refusing2(true), refusing3(true);
+  refusing2.use();
+  refusing3.use();
+  QCOMPARE(pool.size(), 3);
+  QVERIFY(!d.isOpen());
+  QCOMPARE(refusing.releaseRequests(), 4);
+  QCOMPARE(refusing2.releaseRequests(), 1);
+  QCOMPARE(refusing3.releaseRequests(), 0);
+  QVERIFY(refusing.isOpen());
+  QVERIFY(refusing2.isOpen());
+  QVERIFY(refusing3.isOpen());
+}
+
+void TestFileHandlePool::testDestroyClient()
+{
+  FileHandlePool& pool = FileHandlePool::instance();
+  pool.setCapacity(2);
+  HandleClient a, c;
+  a.use();
+  HandleClient* b = new HandleClient;
+  b->use();
+  QCOMPARE(pool.size(), 2);
+
+  // A deleted client is unlinked and not asked to release its handle.
+  delete b;
+  QCOMPARE(pool.size(), 1);
+  c.use();
+  QCOMPARE(pool.size(), 2);
+  QVERIFY(a.isOpen());
+  QVERIFY(c.isOpen());
+  QCOMPARE(pool.evictionCount(), Q_UINT64_C(0));
+}
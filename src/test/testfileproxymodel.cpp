@@ -0,0 +1,524 @@
+/**
+ * \file testfileproxymodel.cpp
+ * Test file proxy model with tagged files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testfileproxymodel.h"
+#include <QDir>
+#include <QFile>
+#include <QFileSystemModel>
+#include <QSemaphore>
+#include <QSignalSpy>
+#include "fileproxymodel.h"
+#include "taggedfile.h"
+#include "itaggedfilefactory.h"
+#include "tagwriterpool.h"
+#include "directorywatcher.h"
+#include "configstore.h"
+#include "dummysettings.h"
+
+namespace {
+
+/** Semaphore acquired by writeTags() while writes are blocked. */
+QSemaphore writeGate;
+
+/** Not 0 while writes are blocked. */
+QAtomicInt writesBlocked;
+
+/** Number of existing TextTaggedFile instances. */
+QAtomicInt numTextTaggedFiles;
+
+/**
+ * Tagged file with the contents of the file as its title.
+ */
+class TextTaggedFile : public TaggedFile {
+public:
+  explicit TextTaggedFile(const QPersistentModelIndex& idx)
+    : TaggedFile(idx), m_fileRead(false) {
+    numTextTaggedFiles.ref();
+  }
+
+  virtual ~TextTaggedFile() {
+    numTextTaggedFiles.deref();
+  }
+
+  virtual QString taggedFileKey() const {
+    return QLatin1String("TextMetadata");
+  }
+
+  virtual void readTags(bool force) {
+    bool priorIsTagInformationRead = isTagInformationRead();
+    if (force || !m_fileRead) {
+      QFile file(currentFilePath());
+      m_title = file.open(QIODevice::ReadOnly)
+          ? QString::fromUtf8(file.readAll()) : QString();
+      m_fileRead = true;
+      markTagUnchanged(Frame::Tag_2);
+    }
+    notifyModelDataChanged(priorIsTagInformationRead);
+  }
+
+  virtual bool writeTags(bool force, bool* renamed, bool) {
+    *renamed = false;
+    if (writesBlocked.fetchAndAddOrdered(0)) {
+      writeGate.acquire();
+    }
+    if (force || isTagChanged(Frame::Tag_2)) {
+      // Do not create files which have been deleted in the meantime.
+      QFile file(currentFilePath());
+      if (!file.exists() || !file.open(QIODevice::WriteOnly))
+        return false;
+      file.write(m_title.toUtf8());
+      markTagUnchanged(Frame::Tag_2);
+    }
+    return true;
+  }
+
+  virtual void clearTags(bool force) {
+    if (!m_fileRead || (isChanged() && !force))
+      return;
+
+    bool priorIsTagInformationRead = isTagInformationRead();
+    m_title.clear();
+    markTagUnchanged(Frame::Tag_2);
+    m_fileRead = false;
+    notifyModelDataChanged(priorIsTagInformationRead);
+  }
+
+  virtual bool isTagInformationRead() const { return m_fileRead; }
+
+  virtual void getDetailInfo(DetailInfo&) const {}
+
+  virtual unsigned getDuration() const { return 0; }
+
+  virtual QString getFileExtension() const {
+    return QLatin1String(".tst");
+  }
+
+  virtual bool getFrame(Frame::TagNumber tagNr, Frame::Type type,
+                        Frame& frame) const {
+    if (tagNr != Frame::Tag_2 || type != Frame::FT_Title)
+      return false;
+
+    frame.setType(type);
+    frame.setValue(m_title);
+    return true;
+  }
+
+  virtual bool setFrame(Frame::TagNumber tagNr, const Frame& frame) {
+    if (tagNr != Frame::Tag_2 || frame.getType() != Frame::FT_Title)
+      return false;
+
+    if (frame.getValue() != m_title) {
+      m_title = frame.getValue();
+      markTagChanged(Frame::Tag_2, Frame::FT_Title);
+    }
+    return true;
+  }
+
+  virtual QStringList getFrameIds(Frame::TagNumber) const {
+    return QStringList();
+  }
+
+private:
+  QString m_title;
+  bool m_fileRead;
+};
+
+/**
+ * Factory for TextTaggedFile.
+ */
+class TextTaggedFileFactory : public ITaggedFileFactory {
+public:
+  virtual QString name() const { return QLatin1String("TextMetadata"); }
+
+  virtual QStringList taggedFileKeys() const {
+    return QStringList() << QLatin1String("TextMetadata");
+  }
+
+  virtual int taggedFileFeatures(const QString&) const { return 0; }
+
+  virtual void initialize(const QString&) {}
+
+  virtual TaggedFile* createTaggedFile(
+      const QString&, const QString& fileName,
+      const QPersistentModelIndex& idx, int) {
+    return fileName.endsWith(QLatin1String(".tst"))
+        ? new TextTaggedFile(idx) : 0;
+  }
+
+  virtual QStringList supportedFileExtensions(const QString&) const {
+    return QStringList() << QLatin1String(".tst");
+  }
+
+  virtual void notifyConfigurationChange(const QString&) {}
+};
+
+/**
+ * Blocks TextTaggedFile::writeTags() while it exists or until open() is
+ * called.
+ * Must be constructed after the TagWriterPool, so that it is destructed
+ * before the pool waits for its workers.
+ */
+class WriteBlocker {
+public:
+  WriteBlocker() : m_open(false) {
+    writeGate.tryAcquire(writeGate.available());
+    writesBlocked.fetchAndStoreOrdered(1);
+  }
+
+  ~WriteBlocker() {
+    writesBlocked.fetchAndStoreOrdered(0);
+    open();
+  }
+
+  /** Let a blocked write continue. */
+  void open() {
+    if (!m_open) {
+      m_open = true;
+      writeGate.release();
+    }
+  }
+
+private:
+  bool m_open;
+};
+
+/**
+ * Write a file.
+ * @param path path of file
+ * @param data contents of file
+ * @return true if ok.
+ */
+bool writeFile(const QString& path, const QByteArray& data)
+{
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+  file.write(data);
+  file.close();
+  return true;
+}
+
+/**
+ * Read a file.
+ * @param path path of file
+ * @return contents of file.
+ */
+QByteArray readFile(const QString& path)
+{
+  QFile file(path);
+  return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+/**
+ * Set the title of a tagged file.
+ * @param taggedFile tagged file
+ * @param title title
+ */
+void setTitle(TaggedFile* taggedFile, const QString& title)
+{
+  Frame frame(Frame::FT_Title, title, QString(), -1);
+  taggedFile->setFrame(Frame::Tag_2, frame);
+}
+
+/**
+ * Wait until a condition is fulfilled.
+ * @param cond condition to check
+ * @return true if the condition is fulfilled.
+ */
+template <class Condition>
+bool waitFor(Condition cond)
+{
+  for (int i = 0; i < 100 && !cond(); ++i) {
+    QTest::qWait(50);
+  }
+  return cond();
+}
+
+/**
+ * Condition checking if a path is no longer in a model.
+ */
+class PathRemoved {
+public:
+  PathRemoved(const FileProxyModel* model, const QString& path)
+    : m_model(model), m_path(path) {}
+  bool operator()() const { return !m_model->index(m_path).isValid(); }
+private:
+  const FileProxyModel* m_model;
+  QString m_path;
+};
+
+/**
+ * Condition checking if the tags of a tagged file have been cleared.
+ */
+class TagsCleared {
+public:
+  explicit TagsCleared(const TaggedFile* taggedFile)
+    : m_taggedFile(taggedFile) {}
+  bool operator()() const { return !m_taggedFile->isTagInformationRead(); }
+private:
+  const TaggedFile* m_taggedFile;
+};
+
+/**
+ * Condition checking if a signal spy has recorded signals.
+ */
+class SignalReceived {
+public:
+  explicit SignalReceived(const QSignalSpy& spy) : m_spy(spy) {}
+  bool operator()() const { return !m_spy.isEmpty(); }
+private:
+  const QSignalSpy& m_spy;
+};
+
+}
+
+
+TestFileProxyModel::TestFileProxyModel(QObject* parent) : QObject(parent),
+  m_fsModel(0), m_model(0), m_factory(new TextTaggedFileFactory),
+  m_settings(0), m_configStore(0)
+{
+  if (!ConfigStore::instance()) {
+    m_settings = new DummySettings;
+    m_configStore = new ConfigStore(m_settings);
+  }
+}
+
+TestFileProxyModel::~TestFileProxyModel()
+{
+  delete m_factory;
+  delete m_configStore;
+  delete m_settings;
+}
+
+void TestFileProxyModel::initTestCase()
+{
+  qRegisterMetaType<QModelIndex>("QModelIndex");
+  FileProxyModel::taggedFileFactories().append(m_factory);
+}
+
+void TestFileProxyModel::cleanupTestCase()
+{
+  FileProxyModel::taggedFileFactories().removeAll(m_factory);
+}
+
+void TestFileProxyModel::init()
+{
+  m_dirPath = QDir::temp().filePath(QLatin1String("kid3_testfileproxymodel"));
+  QDir().mkpath(m_dirPath);
+  QVERIFY(writeFile(filePath(QLatin1String("a.tst")), "Title A"));
+  QVERIFY(writeFile(filePath(QLatin1String("b.tst")), "Title B"));
+
+  m_fsModel = new QFileSystemModel;
+  m_model = new FileProxyModel;
+  m_model->setSourceModel(m_fsModel);
+  m_model->setNameFilters(QStringList() << QLatin1String("*.tst"));
+  m_model->getDirectoryWatcher()->setCoalescingInterval(50);
+  QSignalSpy loadedSpy(m_model, SIGNAL(sortingFinished()));
+  m_fsModel->setRootPath(m_dirPath);
+  QVERIFY(waitFor(SignalReceived(loadedSpy)));
+  QModelIndex rootIndex = m_model->index(m_dirPath);
+  QVERIFY(rootIndex.isValid());
+  QCOMPARE(m_model->rowCount(rootIndex), 2);
+}
+
+void TestFileProxyModel::cleanup()
+{
+  delete m_model;
+  m_model = 0;
+  delete m_fsModel;
+  m_fsModel = 0;
+  QDir dir(m_dirPath);
+  foreach (const QString& fileName, dir.entryList(QDir::Files)) {
+    dir.remove(fileName);
+  }
+  QDir().rmdir(m_dirPath);
+}
+
+QString TestFileProxyModel::filePath(const QString& fileName) const
+{
+  return m_dirPath + QLatin1Char('/') + fileName;
+}
+
+TaggedFile* TestFileProxyModel::taggedFileOfPath(const QString& path) const
+{
+  return FileProxyModel::getTaggedFileOfIndex(m_model->index(path));
+}
+
+/**
+ * Wait until the directory watcher of the model reports changes.
+ * @return true if changes have been reported.
+ */
+bool TestFileProxyModel::waitForWatcher()
+{
+  DirectoryWatcher* watcher = m_model->getDirectoryWatcher();
+  // Connected after the model, so the model has processed the changes
+  // when the spies have recorded them.
+  QSignalSpy filesSpy(watcher, SIGNAL(filesChanged(QStringList)));
+  QSignalSpy dirsSpy(watcher, SIGNAL(directoriesChanged(QStringList)));
+  for (int i = 0; i < 100 && filesSpy.isEmpty() && dirsSpy.isEmpty(); ++i) {
+    QTest::qWait(50);
+  }
+  return !filesSpy.isEmpty() || !dirsSpy.isEmpty();
+}
+
+void TestFileProxyModel::testHideFilesBeingWritten()
+{
+  const QString path = filePath(QLatin1String("a.tst"));
+  QModelIndex index = m_model->index(path);
+  TaggedFile* taggedFile = taggedFileOfPath(path);
+  QVERIFY(taggedFile);
+  taggedFile->readTags(false);
+  setTitle(taggedFile, QLatin1String("New Title"));
+  QVERIFY(taggedFile->isChanged());
+  QVERIFY(m_model->isModified());
+
+  TagWriterPool pool;
+  WriteBlocker blocker;
+  pool.enqueue(taggedFile, 1, false);
+  // The model does not give access to the file while it is written.
+  QVERIFY(!m_model->data(index, FileProxyModel::TaggedFileRole).isValid());
+  QVERIFY(!taggedFileOfPath(path));
+  QVERIFY(!m_model->isModified());
+  QTest::qWait(50);
+  QVERIFY(!taggedFileOfPath(path));
+  QCOMPARE(numTextTaggedFiles.fetchAndAddOrdered(0), 2);
+
+  blocker.open();
+  int id;
+  TagWriterPool::WriteResult result;
+  QCOMPARE(pool.takeResult(true, &id, &result), taggedFile);
+  QCOMPARE(id, 1);
+  QCOMPARE(result, TagWriterPool::Written);
+  QCOMPARE(taggedFileOfPath(path), taggedFile);
+  QVERIFY(taggedFile->getIndex() == index);
+  QVERIFY(!taggedFile->isChanged());
+  QVERIFY(!m_model->isModified());
+  QCOMPARE(readFile(path), QByteArray("New Title"));
+}
+
+void TestFileProxyModel::testRemoveRowOfFileBeingWritten()
+{
+  const QString path = filePath(QLatin1String("a.tst"));
+  TaggedFile* taggedFile = taggedFileOfPath(path);
+  QVERIFY(taggedFile);
+  taggedFile->readTags(false);
+  setTitle(taggedFile, QLatin1String("New Title"));
+
+  TagWriterPool pool;
+  WriteBlocker blocker;
+  pool.enqueue(taggedFile, 1, false);
+  QVERIFY(QFile::remove(path));
+  bool removed = waitFor(PathRemoved(m_model, path));
+  // The tagged file is still owned by the worker.
+  QCOMPARE(numTextTaggedFiles.fetchAndAddOrdered(0), 2);
+
+  blocker.open();
+  int id;
+  TagWriterPool::WriteResult result;
+  QCOMPARE(pool.takeResult(true, &id, &result), taggedFile);
+  QCOMPARE(result, TagWriterPool::WriteFailed);
+  QVERIFY(removed);
+  QVERIFY(!taggedFileOfPath(path));
+  // Deleted when control returns to the event loop.
+  QTest::qWait(50);
+  QCOMPARE(numTextTaggedFiles.fetchAndAddOrdered(0), 1);
+}
+
+void TestFileProxyModel::testRefreshChangedFiles()
+{
+  const QString path = filePath(QLatin1String("a.tst"));
+  QModelIndex index = m_model->index(path);
+  TaggedFile* taggedFile = taggedFileOfPath(path);
+  QVERIFY(taggedFile);
+  taggedFile->readTags(false);
+  TaggedFile* unreadFile = taggedFileOfPath(filePath(QLatin1String("b.tst")));
+  QVERIFY(unreadFile);
+  QVERIFY(!unreadFile->isTagInformationRead());
+
+  QSignalSpy dataSpy(m_model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+  QVERIFY(writeFile(path, "Changed Title"));
+  QVERIFY(waitFor(TagsCleared(taggedFile)));
+  QCOMPARE(taggedFileOfPath(path), taggedFile);
+  bool dataChanged = false;
+  foreach (const QList<QVariant>& args, dataSpy) {
+    if (args.first().value<QModelIndex>() == index) {
+      dataChanged = true;
+      break;
+    }
+  }
+  QVERIFY(dataChanged);
+
+  Frame frame;
+  taggedFile->readTags(false);
+  QVERIFY(taggedFile->getFrame(Frame::Tag_2, Frame::FT_Title, frame));
+  QCOMPARE(frame.getValue(), QString(QLatin1String("Changed Title")));
+}
+
+void TestFileProxyModel::testIgnoreOwnWrites()
+{
+  const QString path = filePath(QLatin1String("a.tst"));
+  TaggedFile* taggedFile = taggedFileOfPath(path);
+  QVERIFY(taggedFile);
+  taggedFile->readTags(false);
+  setTitle(taggedFile, QLatin1String("New Title"));
+
+  TagWriterPool pool;
+  pool.enqueue(taggedFile, 1, false);
+  int id;
+  TagWriterPool::WriteResult result;
+  QCOMPARE(pool.takeResult(true, &id, &result), taggedFile);
+  QCOMPARE(result, TagWriterPool::Written);
+  QVERIFY(waitForWatcher());
+  QVERIFY(taggedFile->isTagInformationRead());
+}
+
+void TestFileProxyModel::testIgnoreChangesOfFilesBeingWritten()
+{
+  const QString path = filePath(QLatin1String("a.tst"));
+  TaggedFile* taggedFile = taggedFileOfPath(path);
+  QVERIFY(taggedFile);
+  taggedFile->readTags(false);
+  setTitle(taggedFile, QLatin1String("New Title"));
+
+  TagWriterPool pool;
+  WriteBlocker blocker;
+  pool.enqueue(taggedFile, 1, false);
+  // A change reported while a worker owns the tagged file must not clear
+  // its tags.
+  QVERIFY(writeFile(path, "Other Title"));
+  QVERIFY(waitForWatcher());
+  QVERIFY(taggedFile->isTagInformationRead());
+
+  blocker.open();
+  int id;
+  TagWriterPool::WriteResult result;
+  QCOMPARE(pool.takeResult(true, &id, &result), taggedFile);
+  QCOMPARE(result, TagWriterPool::Written);
+  QCOMPARE(readFile(path), QByteArray("New Title"));
+  QVERIFY(waitForWatcher());
+  QVERIFY(taggedFile->isTagInformationRead());
+  QVERIFY(!taggedFile->isChanged());
+}
@@ -0,0 +1,72 @@
+/**
+ * \file testfileproxymodel.h
+ * Test file proxy model with tagged files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTFILEPROXYMODEL_H
+#define TESTFILEPROXYMODEL_H
+
+#include <QTest>
+
+class QFileSystemModel;
+class FileProxyModel;
+class ITaggedFileFactory;
+class TaggedFile;
+class ISettings;
+class ConfigStore;
+
+/**
+ * Test file proxy model with tagged files which are written concurrently.
+ */
+class TestFileProxyModel : public QObject {
+  Q_OBJECT
+public:
+  explicit TestFileProxyModel(QObject* parent = 0);
+  virtual ~TestFileProxyModel();
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void init();
+  void cleanup();
+  void testHideFilesBeingWritten();
+  void testRemoveRowOfFileBeingWritten();
+  void testRefreshChangedFiles();
+  void testIgnoreOwnWrites();
+  void testIgnoreChangesOfFilesBeingWritten();
+
+private:
+  QString filePath(const QString& fileName) const;
+  TaggedFile* taggedFileOfPath(const QString& path) const;
+  bool waitForWatcher();
+
+  QString m_dirPath;
+  QFileSystemModel* m_fsModel;
+  FileProxyModel* m_model;
+  ITaggedFileFactory* m_factory;
+  ISettings* m_settings;
+  ConfigStore* m_configStore;
+};
+
+#endif
@@ -0,0 +1,108 @@
+/**
+ * \file testfilerewriter.cpp
+ * Test writing a changed copy of a file.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testfilerewriter.h"
+#include <QDir>
+#include <QFile>
+#include "filerewriter.h"
+
+namespace {
+
+/**
+ * Read a file.
+ * @param path path of file
+ * @return contents of file.
+ */
+QByteArray readFile(const QString& path)
+{
+  QFile file(path);
+  return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+/**
+ * Write a file.
+ * @param path path of file
+ * @param data contents of file
+ * @return true if ok.
+ */
+bool writeFile(const QString& path, const QByteArray& data)
+{
+  QFile file(path);
+  return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+}
+
+void TestFileRewriter::init()
+{
+  m_filePath = QDir::temp().filePath(QLatin1String("kid3_testrewrite.mp3"));
+  QVERIFY(writeFile(m_filePath, "0123456789"));
+}
+
+void TestFileRewriter::cleanup()
+{
+  QFile::remove(m_filePath);
+  QFile::remove(m_filePath + QLatin1String("_KID3"));
+}
+
+void TestFileRewriter::testRewrite()
+{
+  QFile::setPermissions(m_filePath, QFile::ReadOwner | QFile::WriteOwner);
+  {
+    FileRewriter rewriter(m_filePath);
+    QVERIFY(rewriter.open());
+    QVERIFY(rewriter.write("TAG"));
+    QVERIFY(rewriter.copy(2, 8));
+    QVERIFY(rewriter.copy(0, 0));
+    QVERIFY(rewriter.write("END"));
+    QVERIFY(QFile::exists(rewriter.tempFilePath()));
+    QVERIFY(rewriter.commit());
+  }
+  QCOMPARE(readFile(m_filePath), QByteArray("TAG234567END"));
+  QVERIFY(!QFile::exists(m_filePath + QLatin1String("_KID3")));
+  QCOMPARE(QFile::permissions(m_filePath) &
+           (QFile::ReadOwner | QFile::WriteOwner | QFile::ReadOther),
+           QFile::ReadOwner | QFile::WriteOwner);
+}
+
+void TestFileRewriter::testFailedRewrite()
+{
+  {
+    FileRewriter rewriter(m_filePath);
+    QVERIFY(rewriter.open());
+    QVERIFY(rewriter.write("TAG"));
+    // Region beyond the end of the file
+    QVERIFY(!rewriter.copy(5, 20));
+    QVERIFY(!rewriter.copy(6, 4));
+  }
+  // Without commit, the original file is kept.
+  QCOMPARE(readFile(m_filePath), QByteArray("0123456789"));
+  QVERIFY(!QFile::exists(m_filePath + QLatin1String("_KID3")));
+
+  FileRewriter missing(m_filePath + QLatin1String(".missing"));
+  QVERIFY(!missing.open());
+  QVERIFY(!missing.commit());
+}
@@ -0,0 +1,47 @@
+/**
+ * \file testfilerewriter.h
+ * Test writing a changed copy of a file.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTFILEREWRITER_H
+#define TESTFILEREWRITER_H
+
+#include <QTest>
+
+/**
+ * Test writing a changed copy of a file.
+ */
+class TestFileRewriter : public QObject {
+  Q_OBJECT
+private slots:
+  void init();
+  void cleanup();
+  void testRewrite();
+  void testFailedRewrite();
+
+private:
+  QString m_filePath;
+};
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ * \file testfingerprinttasktracker.cpp
+ * Test assignment of tracks to fingerprint calculators.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testfingerprinttasktracker.h"
+#include "fingerprinttasktracker.h"
+
+void TestFingerprintTaskTracker::testAssign()
+{
+  FingerprintTaskTracker tracker(2);
+  QCOMPARE(tracker.size(), 2);
+  QCOMPARE(tracker.idleCalculator(), 0);
+  int token0 = tracker.assign(0, 5);
+  QCOMPARE(tracker.trackIndex(0), 5);
+  QCOMPARE(tracker.idleCalculator(), 1);
+  int token1 = tracker.assign(1, 6);
+  QVERIFY(token0 != token1);
+  QCOMPARE(tracker.idleCalculator(), -1);
+
+  // A token of another calculator is not accepted.
+  QCOMPARE(tracker.finish(0, token1), -1);
+  QCOMPARE(tracker.trackIndex(0), 5);
+  QCOMPARE(tracker.finish(1, token1), 6);
+  QCOMPARE(tracker.trackIndex(1), -1);
+  QCOMPARE(tracker.idleCalculator(), 1);
+  // A result is only accepted once.
+  QCOMPARE(tracker.finish(1, token1), -1);
+  QCOMPARE(tracker.finish(0, token0), 5);
+  QCOMPARE(tracker.idleCalculator(), 0);
+}
+
+void TestFingerprintTaskTracker::testStaleResult()
+{
+  FingerprintTaskTracker tracker(1);
+  int staleToken = tracker.assign(0, 3);
+  tracker.stopAll();
+  QCOMPARE(tracker.trackIndex(0), -1);
+  QCOMPARE(tracker.idleCalculator(), 0);
+  // The result of the stopped calculation arrives after the calculator has
+  // been assigned to the first track of a new import.
+  int token = tracker.assign(0, 0);
+  QVERIFY(token != staleToken);
+  QCOMPARE(tracker.finish(0, staleToken), -1);
+  QCOMPARE(tracker.trackIndex(0), 0);
+  QCOMPARE(tracker.finish(0, token), 0);
+
+  // A stale result arriving while the calculator is idle is ignored, too.
+  staleToken = tracker.assign(0, 1);
+  tracker.stopAll();
+  QCOMPARE(tracker.finish(0, staleToken), -1);
+  QCOMPARE(tracker.idleCalculator(), 0);
+
+  // Resizing stops all calculations.
+  staleToken = tracker.assign(0, 2);
+  tracker.resize(2);
+  QCOMPARE(tracker.finish(0, staleToken), -1);
+  QCOMPARE(tracker.idleCalculator(), 0);
+}
+
+void TestFingerprintTaskTracker::testInvalidCalculator()
+{
+  FingerprintTaskTracker tracker;
+  QCOMPARE(tracker.size(), 0);
+  QCOMPARE(tracker.idleCalculator(), -1);
+  QCOMPARE(tracker.trackIndex(0), -1);
+  // The result of an unknown sender is ignored.
+  QCOMPARE(tracker.finish(-1, 1), -1);
+  QCOMPARE(tracker.finish(0, 0), -1);
+}
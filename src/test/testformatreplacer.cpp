@@ -0,0 +1,222 @@
+/**
+ * \file testformatreplacer.cpp
+ * Test format replacer and compiled format templates.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testformatreplacer.h"
+#include <QMap>
+#include "formatreplacer.h"
+
+namespace {
+
+/** Number of files used for the benchmarks. */
+const int NumFiles = 10000;
+
+/** Format used for the benchmarks, like a typical export format. */
+const char* const BenchmarkFormat =
+    "%{track}. %{artist} - %{\"[\"album\"] \"}%{title} (%{year}) %z%%";
+
+/**
+ * Format replacer with codes from a map.
+ */
+class MapFormatReplacer : public FormatReplacer {
+public:
+  /**
+   * Constructor.
+   * @param codes map with replacements for codes
+   * @param str string with format codes
+   */
+  explicit MapFormatReplacer(const QMap<QString, QString>& codes,
+                             const QString& str = QString())
+    : FormatReplacer(str), m_codes(codes) {}
+
+protected:
+  /**
+   * Replace a format code.
+   * @param code format code
+   * @return replacement string, null if code not found.
+   */
+  virtual QString getReplacement(const QString& code) const {
+    return m_codes.value(code);
+  }
+
+  /**
+   * Replace a format code preceded by a tag number.
+   * @param tagNumber tag number 1 or 2
+   * @param code format code
+   * @return replacement string, null if code not found.
+   */
+  virtual QString getTagReplacement(int tagNumber, const QString& code) const {
+    return m_codes.value(QString::number(tagNumber) + code);
+  }
+
+private:
+  const QMap<QString, QString>& m_codes;
+};
+
+/**
+ * Get replacements used for the tests.
+ * @param nr number used to create different values
+ * @return map with codes and replacements.
+ */
+QMap<QString, QString> createCodes(int nr = 0)
+{
+  QMap<QString, QString> codes;
+  codes.insert(QLatin1String("a"), QLatin1String("A/B"));
+  codes.insert(QLatin1String("x"), QLatin1String("X"));
+  codes.insert(QLatin1String("t"), QLatin1String(""));
+  codes.insert(QLatin1String("empty"), QLatin1String(""));
+  codes.insert(QLatin1String("title"), QString(QLatin1String("T<%1>")).arg(nr));
+  codes.insert(QLatin1String("artist"), QLatin1String("Artist"));
+  codes.insert(QLatin1String("album"), QLatin1String("Album"));
+  codes.insert(QLatin1String("track"), QString::number(nr % 20 + 1));
+  codes.insert(QLatin1String("year"), QLatin1String("2026"));
+  codes.insert(QLatin1String("1a"), QLatin1String("A1"));
+  codes.insert(QLatin1String("2a"), QLatin1String("A2"));
+  codes.insert(QLatin1String("2title"), QLatin1String("T2<>"));
+  return codes;
+}
+
+}
+
+void TestFormatReplacer::testReplacePercentCodes_data()
+{
+  QTest::addColumn<QString>("str");
+  QTest::addColumn<unsigned>("flags");
+  QTest::addColumn<QString>("result");
+
+  QTest::newRow("plain") << QString(QLatin1String("No codes")) << 0U
+                         << QString(QLatin1String("No codes"));
+  QTest::newRow("short") << QString(QLatin1String("%a - %x")) << 0U
+                         << QString(QLatin1String("A/B - X"));
+  QTest::newRow("unknown") << QString(QLatin1String("%z%x")) << 0U
+                           << QString(QLatin1String("%zX"));
+  QTest::newRow("percent") << QString(QLatin1String("100%%x")) << 0U
+                           << QString(QLatin1String("100%X"));
+  QTest::newRow("trailing") << QString(QLatin1String("end%")) << 0U
+                            << QString(QLatin1String("end%"));
+  QTest::newRow("empty") << QString(QLatin1String("[%t]")) << 0U
+                         << QString(QLatin1String("[]"));
+  QTest::newRow("long") << QString(QLatin1String("%{TITLE}")) << 0U
+                        << QString(QLatin1String("T<0>"));
+  QTest::newRow("affixes") << QString(QLatin1String("%{\"[\"title\"]\"}"))
+                           << 0U << QString(QLatin1String("[T<0>]"));
+  QTest::newRow("emptyaffixes")
+      << QString(QLatin1String("%{\"[\"empty\"]\"}")) << 0U << QString();
+  QTest::newRow("unknownlong") << QString(QLatin1String("a%{nothing}b"))
+                               << 0U << QString(QLatin1String("ab"));
+  QTest::newRow("unclosed") << QString(QLatin1String("%{title")) << 0U
+                            << QString(QLatin1String("%{title"));
+  QTest::newRow("separators") << QString(QLatin1String("%a"))
+      << unsigned(FormatReplacer::FSF_ReplaceSeparators)
+      << QString(QLatin1String("A-B"));
+  QTest::newRow("html") << QString(QLatin1String("%h{title}"))
+      << unsigned(FormatReplacer::FSF_SupportHtmlEscape)
+      << QString(QLatin1String("T&lt;0&gt;"));
+  QTest::newRow("url") << QString(QLatin1String("%ua"))
+      << unsigned(FormatReplacer::FSF_SupportUrlEncode)
+      << QString(QLatin1String("A%2FB"));
+  QTest::newRow("nomodifier") << QString(QLatin1String("%hx")) << 0U
+                              << QString(QLatin1String("%hx"));
+  QTest::newRow("tagnumber") << QString(QLatin1String("%1a %2a %a"))
+      << unsigned(FormatReplacer::FSF_SupportTagNumber)
+      << QString(QLatin1String("A1 A2 A/B"));
+  QTest::newRow("tagnumberlong")
+      << QString(QLatin1String("%2h{\"[\"title\"]\"}"))
+      << unsigned(FormatReplacer::FSF_SupportTagNumber |
+                  FormatReplacer::FSF_SupportHtmlEscape)
+      << QString(QLatin1String("[T2&lt;&gt;]"));
+  QTest::newRow("tagnumberunknown") << QString(QLatin1String("%1x%2"))
+      << unsigned(FormatReplacer::FSF_SupportTagNumber)
+      << QString(QLatin1String("%1x%2"));
+  QTest::newRow("notagnumber") << QString(QLatin1String("%1a")) << 0U
+                               << QString(QLatin1String("%1a"));
+}
+
+void TestFormatReplacer::testReplacePercentCodes()
+{
+  QFETCH(QString, str);
+  QFETCH(unsigned, flags);
+  QFETCH(QString, result);
+
+  const QMap<QString, QString> codes = createCodes();
+  MapFormatReplacer fmt(codes, str);
+  fmt.replacePercentCodes(flags);
+  QCOMPARE(fmt.getString(), result);
+  const FormatReplacer::Template tmpl(str, flags);
+  QCOMPARE(MapFormatReplacer(codes).format(tmpl), result);
+}
+
+void TestFormatReplacer::testTemplateReuse()
+{
+  const FormatReplacer::Template tmpl(
+        QLatin1String("%{track}: %{title}%%a"));
+  const QMap<QString, QString> codes1 = createCodes(1);
+  const QMap<QString, QString> codes2 = createCodes(2);
+  QCOMPARE(MapFormatReplacer(codes1).format(tmpl),
+           QString(QLatin1String("2: T<1>%A/B")));
+  QCOMPARE(MapFormatReplacer(codes2).format(tmpl),
+           QString(QLatin1String("3: T<2>%A/B")));
+  QCOMPARE(tmpl.getString(), QString(QLatin1String("%{track}: %{title}%%a")));
+  QVERIFY(MapFormatReplacer(codes1).format(FormatReplacer::Template())
+          .isEmpty());
+}
+
+void TestFormatReplacer::benchmarkReplacePercentCodes()
+{
+  QVector<QMap<QString, QString> > fileCodes;
+  fileCodes.reserve(NumFiles);
+  for (int i = 0; i < NumFiles; ++i) {
+    fileCodes.append(createCodes(i));
+  }
+  const QString format = QString::fromLatin1(BenchmarkFormat);
+  int length = 0;
+  QBENCHMARK {
+    length = 0;
+    for (int i = 0; i < NumFiles; ++i) {
+      MapFormatReplacer fmt(fileCodes.at(i), format);
+      fmt.replacePercentCodes();
+      length += fmt.getString().length();
+    }
+  }
+  QVERIFY(length > 0);
+}
+
+void TestFormatReplacer::benchmarkFormatTemplate()
+{
+  QVector<QMap<QString, QString> > fileCodes;
+  fileCodes.reserve(NumFiles);
+  for (int i = 0; i < NumFiles; ++i) {
+    fileCodes.append(createCodes(i));
+  }
+  int length = 0;
+  QBENCHMARK {
+    length = 0;
+    const FormatReplacer::Template tmpl(QString::fromLatin1(BenchmarkFormat));
+    for (int i = 0; i < NumFiles; ++i) {
+      length += MapFormatReplacer(fileCodes.at(i)).format(tmpl).length();
+    }
+  }
+  QVERIFY(length > 0);
+}
@@ -0,0 +1,446 @@
+/**
+ * \file testframecollection.cpp
+ * Test frame collection and benchmark operations on frames.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testframecollection.h"
+#include <QStringList>
+#include <set>
+#include "frame.h"
+#include "trackdata.h"
+
+namespace {
+
+/** Number of files used for the benchmarks. */
+const int NumFiles = 5000;
+
+/** Frame container used by FrameCollection before it became a vector. */
+typedef std::multiset<Frame> FrameMultiset;
+
+/** Frame containers compared by the benchmarks. */
+enum Container {
+  MultisetContainer,
+  FlatContainer
+};
+
+/**
+ * Get the frames of a file like they are returned by getAllFrames().
+ * @param fileNr number of file, used to create different values
+ * @return frames with standard and other frames.
+ */
+FrameCollection createFileFrames(int fileNr)
+{
+  static const char* const otherNames[] = {
+    "TXXX - User defined text information\nCATALOG",
+    "TLEN - Length", "PRIV - Private frame", "TSSE - Software/Hardware"
+  };
+  FrameCollection frames;
+  int index = 0;
+  frames.insert(Frame(Frame::FT_Title,
+                      QString(QLatin1String("Title %1")).arg(fileNr),
+                      QString(), index++));
+  frames.insert(Frame(Frame::FT_Artist, QLatin1String("Artist"),
+                      QString(), index++));
+  frames.insert(Frame(Frame::FT_Album,
+                      QString(QLatin1String("Album %1")).arg(fileNr / 10),
+                      QString(), index++));
+  frames.insert(Frame(Frame::FT_Track, QString::number(fileNr % 10 + 1),
+                      QString(), index++));
+  frames.insert(Frame(Frame::FT_Date, QLatin1String("2026"),
+                      QString(), index++));
+  frames.insert(Frame(Frame::FT_Genre, QLatin1String("Rock"),
+                      QString(), index++));
+  for (unsigned int i = 0; i < sizeof(otherNames) / sizeof(otherNames[0]);
+       ++i) {
+    frames.insert(Frame(Frame::ExtendedType(
+                          Frame::FT_Other, QString::fromLatin1(otherNames[i])),
+                        QString::number(fileNr), index++));
+  }
+  return frames;
+}
+
+/**
+ * Mark the frames which are different in two containers, like
+ * FrameCollection::filterDifferent() does.
+ * @param frames frames to mark, missing frames from @a others are added
+ * @param others other frames, modified to mark the handled frames
+ */
+template <class C>
+void filterDifferentIn(C& frames, C& others)
+{
+  typename C::iterator it = frames.begin();
+  while (it != frames.end()) {
+    Frame& frame = const_cast<Frame&>(*it);
+    frame.setIndex(-1);
+    typename C::iterator othersIt = others.find(frame);
+    if (othersIt == others.end()) {
+      frame.setDifferent();
+      ++it;
+    } else {
+      while (it != frames.end() && othersIt != others.end() &&
+             !(frame < *it) && !(frame < *othersIt)) {
+        if (it->getValue() != othersIt->getValue()) {
+          const_cast<Frame&>(*it).setDifferent();
+        }
+        const_cast<Frame&>(*othersIt).setIndex(-2);
+        ++it;
+        ++othersIt;
+      }
+    }
+  }
+  for (typename C::iterator othersIt = others.begin();
+       othersIt != others.end();
+       ++othersIt) {
+    if (othersIt->getIndex() != -2) {
+      Frame& frame = const_cast<Frame&>(*othersIt);
+      frame.setIndex(-1);
+      frame.setDifferent();
+      frames.insert(frame);
+    }
+  }
+}
+
+/**
+ * Set the value of a standard frame in a container, like
+ * FrameCollection::setValue() does.
+ * @param frames frame container
+ * @param type type of frame
+ * @param value value
+ */
+template <class C>
+void setValueIn(C& frames, Frame::Type type, const QString& value)
+{
+  Frame frame(type, value, QString(), -1);
+  typename C::iterator it = frames.find(frame);
+  if (it != frames.end()) {
+    const_cast<Frame&>(*it).setValue(value);
+  } else {
+    frames.insert(frame);
+  }
+}
+
+/**
+ * Simulate a selection of many files, like
+ * TaggedFileSelection::addTaggedFile().
+ * @param fileFrames frames of the files
+ * @return number of frames of the selection.
+ */
+template <class C>
+int selectFiles(const QVector<C>& fileFrames)
+{
+  C frames(fileFrames.first());
+  for (int i = 1; i < fileFrames.size(); ++i) {
+    C others(fileFrames.at(i));
+    filterDifferentIn(frames, others);
+  }
+  return static_cast<int>(frames.size());
+}
+
+/**
+ * Simulate an importer creating the frames of many tracks.
+ * @param framesHdr frames common to all tracks
+ * @return number of tracks.
+ */
+template <class C>
+int importFrames(const C& framesHdr)
+{
+  QVector<C> tracks;
+  C frames(framesHdr);
+  for (int i = 0; i < NumFiles; ++i) {
+    setValueIn(frames, Frame::FT_Track, QString::number(i + 1));
+    setValueIn(frames, Frame::FT_Title,
+               QString(QLatin1String("Title %1")).arg(i));
+    tracks.append(frames);
+  }
+  for (typename QVector<C>::iterator it = tracks.begin();
+       it != tracks.end();
+       ++it) {
+    setValueIn(*it, Frame::FT_Comment,
+               it->find(Frame(Frame::FT_Title, QString(), QString(), -1))
+               ->getValue());
+  }
+  return tracks.size();
+}
+
+/**
+ * Get the types of the frames in a collection.
+ * @param frames frame collection
+ * @return list with types in the order of the collection.
+ */
+QList<int> typesOf(const FrameCollection& frames)
+{
+  QList<int> types;
+  for (FrameCollection::const_iterator it = frames.begin();
+       it != frames.end();
+       ++it) {
+    types.append(it->getType());
+  }
+  return types;
+}
+
+/**
+ * Get the values of the frames in a collection.
+ * @param frames frame collection
+ * @return list with values in the order of the collection.
+ */
+QStringList valuesOf(const FrameCollection& frames)
+{
+  QStringList values;
+  for (FrameCollection::const_iterator it = frames.begin();
+       it != frames.end();
+       ++it) {
+    values.append(it->getValue());
+  }
+  return values;
+}
+
+}
+
+void TestFrameCollection::testOrder()
+{
+  FrameCollection frames;
+  frames.insert(Frame(Frame::ExtendedType(Frame::FT_Other,
+                                          QLatin1String("ZZZ")),
+                      QLatin1String("z"), -1));
+  frames.insert(Frame(Frame::FT_Genre, QLatin1String("g1"), QString(), -1));
+  frames.insert(Frame(Frame::ExtendedType(Frame::FT_Other,
+                                          QLatin1String("AAA")),
+                      QLatin1String("a"), -1));
+  frames.insert(Frame(Frame::FT_Title, QLatin1String("t"), QString(), -1));
+  frames.insert(Frame(Frame::FT_Genre, QLatin1String("g2"), QString(), -1));
+  frames.insert(Frame(Frame::ExtendedType(Frame::FT_Other,
+                                          QLatin1String("AAA")),
+                      QLatin1String("a2"), -1));
+  QCOMPARE(static_cast<int>(frames.size()), 6);
+  QCOMPARE(valuesOf(frames), QStringList()
+           << QLatin1String("t") << QLatin1String("g1") << QLatin1String("g2")
+           << QLatin1String("a") << QLatin1String("a2") << QLatin1String("z"));
+  FrameCollection::const_iterator prev = frames.begin();
+  for (FrameCollection::const_iterator it = prev + 1;
+       it != frames.end();
+       prev = it++) {
+    QVERIFY(!(*it < *prev));
+  }
+}
+
+void TestFrameCollection::testFind()
+{
+  FrameCollection frames = createFileFrames(42);
+  QCOMPARE(frames.getValue(Frame::FT_Title), QString(QLatin1String("Title 42")));
+  QCOMPARE(frames.getTrack(), 3);
+  QVERIFY(frames.getValue(Frame::FT_Composer).isNull());
+  QVERIFY(frames.findByType(Frame::FT_Composer) == frames.end());
+  QCOMPARE(frames.findByType(Frame::FT_Genre)->getValue(),
+           QString(QLatin1String("Rock")));
+
+  FrameCollection::const_iterator it = frames.find(
+        Frame(Frame::ExtendedType(Frame::FT_Other,
+                                  QLatin1String("TLEN - Length")),
+              QString(), -1));
+  QVERIFY(it != frames.end());
+  QCOMPARE(it->getName(), QString(QLatin1String("TLEN - Length")));
+  QVERIFY(frames.find(Frame(Frame::ExtendedType(Frame::FT_Other,
+                                                QLatin1String("XXXX")),
+                            QString(), -1)) == frames.end());
+  it = frames.findByName(QLatin1String("TSSE"));
+  QVERIFY(it != frames.end());
+  QCOMPARE(it->getName(), QString(QLatin1String("TSSE - Software/Hardware")));
+  QCOMPARE(frames.findByIndex(3)->getType(), Frame::FT_Track);
+
+  frames.setValue(Frame::FT_Composer, QLatin1String("Composer"));
+  frames.setValue(Frame::FT_Title, QLatin1String("New Title"));
+  QCOMPARE(frames.getValue(Frame::FT_Composer),
+           QString(QLatin1String("Composer")));
+  QCOMPARE(frames.getValue(Frame::FT_Title),
+           QString(QLatin1String("New Title")));
+  QCOMPARE(static_cast<int>(frames.size()), 11);
+}
+
+void TestFrameCollection::testInsertErase()
+{
+  FrameCollection frames = createFileFrames(1);
+  Frame album(Frame::FT_Album, QLatin1String("Album 2"), QString(), -1);
+  FrameCollection::iterator it = frames.upper_bound(album);
+  it = frames.insert(it, album);
+  QCOMPARE(it->getValue(), QString(QLatin1String("Album 2")));
+  QCOMPARE((it - 1)->getValue(), QString(QLatin1String("Album 0")));
+  // A hint which would break the order is not used.
+  it = frames.insert(frames.begin(), Frame(Frame::FT_Genre,
+                                           QLatin1String("Pop"), QString(),
+                                           -1));
+  QCOMPARE((it - 1)->getValue(), QString(QLatin1String("Rock")));
+  QCOMPARE(static_cast<int>(frames.size()), 12);
+
+  it = frames.erase(frames.findByType(Frame::FT_Artist));
+  QCOMPARE(it->getType(), Frame::FT_Album);
+  QVERIFY(frames.findByType(Frame::FT_Artist) == frames.end());
+  QCOMPARE(frames.getValue(Frame::FT_Genre), QString(QLatin1String("Rock")));
+  QCOMPARE(frames.getValue(Frame::FT_Date), QString(QLatin1String("2026")));
+
+  while (frames.findByType(Frame::FT_Album) != frames.end()) {
+    frames.erase(frames.findByType(Frame::FT_Album));
+  }
+  QCOMPARE(typesOf(frames), QList<int>()
+           << Frame::FT_Title << Frame::FT_Date << Frame::FT_Track
+           << Frame::FT_Genre << Frame::FT_Genre
+           << Frame::FT_Other << Frame::FT_Other << Frame::FT_Other
+           << Frame::FT_Other);
+  QCOMPARE(frames.findByName(QLatin1String("TLEN"))->getValue(),
+           QString(QLatin1String("1")));
+
+  frames.clear();
+  QVERIFY(frames.empty());
+  QVERIFY(frames.findByType(Frame::FT_Title) == frames.end());
+  frames.setValue(Frame::FT_Title, QLatin1String("Title"));
+  QCOMPARE(frames.getValue(Frame::FT_Title), QString(QLatin1String("Title")));
+}
+
+void TestFrameCollection::testCopyAndSwap()
+{
+  FrameCollection frames = createFileFrames(1);
+  FrameCollection copy(frames);
+  frames.setValue(Frame::FT_Title, QLatin1String("Changed"));
+  QCOMPARE(copy.getValue(Frame::FT_Title), QString(QLatin1String("Title 1")));
+
+  FrameCollection other;
+  other.setValue(Frame::FT_Comment, QLatin1String("Comment"));
+  other.swap(copy);
+  QCOMPARE(copy.getValue(Frame::FT_Comment),
+           QString(QLatin1String("Comment")));
+  QVERIFY(copy.getValue(Frame::FT_Title).isNull());
+  QCOMPARE(other.getValue(Frame::FT_Title), QString(QLatin1String("Title 1")));
+  QVERIFY(other.getValue(Frame::FT_Comment).isNull());
+}
+
+void TestFrameCollection::testFilterDifferent()
+{
+  FrameCollection frames = createFileFrames(1);
+  FrameCollection others = createFileFrames(2);
+  others.setValue(Frame::FT_Composer, QLatin1String("Composer"));
+  frames.filterDifferent(others);
+  QCOMPARE(static_cast<int>(frames.size()), 11);
+  QCOMPARE(frames.getValue(Frame::FT_Artist), QString(QLatin1String("Artist")));
+  QCOMPARE(frames.getValue(Frame::FT_Album), QString(QLatin1String("Album 0")));
+  QVERIFY(!frames.findByType(Frame::FT_Artist)->isDifferent());
+  QVERIFY(frames.findByType(Frame::FT_Title)->isDifferent());
+  QVERIFY(frames.findByType(Frame::FT_Composer)->isDifferent());
+  QVERIFY(frames.findByName(QLatin1String("TLEN"))->isDifferent());
+}
+
+void TestFrameCollection::benchmarkSelection_data()
+{
+  QTest::addColumn<int>("container");
+
+  QTest::newRow("multiset") << static_cast<int>(MultisetContainer);
+  QTest::newRow("flat") << static_cast<int>(FlatContainer);
+}
+
+void TestFrameCollection::benchmarkSelection()
+{
+  // Like TaggedFileSelection::addTaggedFile() for a selection of NumFiles.
+  QFETCH(int, container);
+  QVector<FrameCollection> fileFrames;
+  QVector<FrameMultiset> fileFrameSets;
+  fileFrames.reserve(NumFiles);
+  for (int i = 0; i < NumFiles; ++i) {
+    FrameCollection frames = createFileFrames(i);
+    if (container == MultisetContainer) {
+      fileFrameSets.append(FrameMultiset(frames.begin(), frames.end()));
+    } else {
+      fileFrames.append(frames);
+    }
+  }
+  int numFrames = 0;
+  if (container == MultisetContainer) {
+    QBENCHMARK {
+      numFrames = selectFiles(fileFrameSets);
+    }
+  } else {
+    QBENCHMARK {
+      numFrames = selectFiles(fileFrames);
+    }
+  }
+  QCOMPARE(numFrames, 10);
+}
+
+void TestFrameCollection::benchmarkImportFrames_data()
+{
+  QTest::addColumn<int>("container");
+
+  QTest::newRow("multiset") << static_cast<int>(MultisetContainer);
+  QTest::newRow("flat") << static_cast<int>(FlatContainer);
+}
+
+void TestFrameCollection::benchmarkImportFrames()
+{
+  // Like the importers, copy the header frames and add track frames.
+  QFETCH(int, container);
+  FrameCollection framesHdr;
+  framesHdr.setArtist(QLatin1String("Artist"));
+  framesHdr.setAlbum(QLatin1String("Album"));
+  framesHdr.setYear(2026);
+  framesHdr.setGenre(QLatin1String("Rock"));
+  const FrameMultiset frameSetHdr(framesHdr.begin(), framesHdr.end());
+  int size = 0;
+  if (container == MultisetContainer) {
+    QBENCHMARK {
+      size = importFrames(frameSetHdr);
+    }
+  } else {
+    QBENCHMARK {
+      size = importFrames(framesHdr);
+    }
+  }
+  QCOMPARE(size, NumFiles);
+}
+
+void TestFrameCollection::benchmarkImportTrackDataVector()
+{
+  FrameCollection framesHdr;
+  framesHdr.setArtist(QLatin1String("Artist"));
+  framesHdr.setAlbum(QLatin1String("Album"));
+  framesHdr.setYear(2026);
+  framesHdr.setGenre(QLatin1String("Rock"));
+  int size = 0;
+  QBENCHMARK {
+    // Like the importers, copy the header frames and add track frames.
+    ImportTrackDataVector trackDataVector;
+    FrameCollection frames(framesHdr);
+    for (int i = 0; i < NumFiles; ++i) {
+      frames.setTrack(i + 1);
+      frames.setTitle(QString(QLatin1String("Title %1")).arg(i));
+      ImportTrackData trackData;
+      trackData.setFrameCollection(frames);
+      trackData.setImportDuration(180 + i % 60);
+      trackDataVector.append(trackData);
+    }
+    for (ImportTrackDataVector::iterator it = trackDataVector.begin();
+         it != trackDataVector.end();
+         ++it) {
+      it->setValue(Frame::FT_Comment, it->getTitle());
+    }
+    size = trackDataVector.size();
+  }
+  QCOMPARE(size, NumFiles);
+}
@@ -0,0 +1,53 @@
+/**
+ * \file testframecollection.h
+ * Test frame collection and benchmark operations on frames.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTFRAMECOLLECTION_H
+#define TESTFRAMECOLLECTION_H
+
+#include <QTest>
+
+/**
+ * Test frame collection and benchmark operations used when many files are
+ * selected or imported, run with "-functions" to list them. The "multiset"
+ * rows use the std::multiset<Frame> which was used before FrameCollection
+ * stored its frames in a sorted vector, so that both can be compared.
+ */
+class TestFrameCollection : public QObject {
+  Q_OBJECT
+private slots:
+  void testOrder();
+  void testFind();
+  void testInsertErase();
+  void testCopyAndSwap();
+  void testFilterDifferent();
+  void benchmarkSelection_data();
+  void benchmarkSelection();
+  void benchmarkImportFrames_data();
+  void benchmarkImportFrames();
+  void benchmarkImportTrackDataVector();
+};
+
+#endif
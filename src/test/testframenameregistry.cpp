@@ -0,0 +1,355 @@
+/**
+ * \file testframenameregistry.cpp
+ * Test frame name registry and benchmark frame name lookups.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testframenameregistry.h"
+#include <QThread>
+#include <QStringList>
+#include <QMap>
+#include <QCoreApplication>
+#include "framenameregistry.h"
+
+namespace {
+
+/** Frame names as found in the frame tables of different tag formats. */
+const char* const sampleNames[] = {
+  "Title", "Artist", "Album", "Track Number", "Date", "Genre",
+  "Album Artist", "Disc Number", "Encoded-by", "Picture", "Rating",
+  "TDRC - Recording time", "TXXX - User defined text information\nCATALOG",
+  "TLEN - Length", "PRIV - Private frame", "LABEL", "ORGANIZATION",
+  "REPLAYGAIN_TRACK_GAIN", "tvsh", "iTunPGAP", "WM/Mood", "MY CUSTOM KEY"
+};
+
+/**
+ * Get the sample names.
+ * @return frame names.
+ */
+QStringList getSampleNames()
+{
+  QStringList names;
+  for (unsigned int i = 0; i < sizeof(sampleNames) / sizeof(sampleNames[0]);
+       ++i) {
+    names.append(QString::fromLatin1(sampleNames[i]));
+  }
+  return names;
+}
+
+/**
+ * Get type from name like it was done before the registry existed.
+ * @param name frame name
+ * @return frame type.
+ */
+Frame::Type getTypeFromNameWithMap(const QString& name)
+{
+  static QMap<QString, int> strNumMap;
+  if (strNumMap.empty()) {
+    for (int i = 0; i <= Frame::FT_LastFrame; ++i) {
+      Frame::Type type = static_cast<Frame::Type>(i);
+      strNumMap.insert(
+            QString::fromLatin1(FrameNameRegistry::nameOfType(type)).
+            remove(QLatin1Char(' ')).toUpper(), type);
+    }
+  }
+  QString ucName(name.toUpper());
+  ucName.remove(QLatin1Char(' '));
+  QMap<QString, int>::const_iterator it = strNumMap.find(ucName);
+  if (it != strNumMap.end()) {
+    return static_cast<Frame::Type>(*it);
+  }
+  return Frame::FT_Other;
+}
+
+/**
+ * Get display name like it was done before the registry existed.
+ * @param name frame name
+ * @return display name.
+ */
+QString getDisplayNameWithMap(const QString& name)
+{
+  static QMap<QByteArray, QByteArray> idStrMap;
+  if (idStrMap.isEmpty()) {
+    foreach (const QByteArray& str, FrameNameRegistry::displayNamesOfIds()) {
+      foreach (const QByteArray& id,
+               FrameNameRegistry::idsWithDisplayName(str)) {
+        idStrMap.insert(id, str);
+      }
+    }
+  }
+  QMap<QByteArray, QByteArray> map = idStrMap;
+  if (name.isEmpty())
+    return name;
+
+  if (getTypeFromNameWithMap(name) != Frame::FT_Other)
+    return QCoreApplication::translate("@default",
+                                       name.toLatin1().constData());
+
+  QString nameStr(name);
+  int nlPos = nameStr.indexOf(QLatin1Char('\n'));
+  if (nlPos > 0)
+    nameStr = nameStr.mid(nlPos + 1);
+
+  QByteArray id;
+  if (nameStr.mid(4, 3) == QLatin1String(" - ")) {
+    id = nameStr.left(4).toLatin1();
+  } else {
+    id = nameStr.toLatin1();
+  }
+
+  QMap<QByteArray, QByteArray>::const_iterator it = map.constFind(id);
+  if (it != map.constEnd()) {
+    return QCoreApplication::translate("@default", it->constData());
+  }
+  return nameStr;
+}
+
+/**
+ * Thread registering names.
+ */
+class InternThread : public QThread {
+public:
+  /**
+   * Constructor.
+   * @param names names to register
+   */
+  explicit InternThread(const QStringList& names) : m_names(names) {}
+
+  /**
+   * Get atoms of registered names.
+   * @return atoms in the order of the names.
+   */
+  QList<int> atoms() const { return m_atoms; }
+
+protected:
+  /**
+   * Register the names.
+   */
+  virtual void run() {
+    FrameNameRegistry& registry = FrameNameRegistry::instance();
+    foreach (const QString& name, m_names) {
+      m_atoms.append(registry.intern(name));
+    }
+  }
+
+private:
+  QStringList m_names;
+  QList<int> m_atoms;
+};
+
+}
+
+void TestFrameNameRegistry::testIntern()
+{
+  FrameNameRegistry& registry = FrameNameRegistry::instance();
+  const QString name(QLatin1String("TestIntern Name"));
+  QCOMPARE(registry.find(name), -1);
+  int count = registry.count();
+  int atom = registry.intern(name);
+  QCOMPARE(registry.count(), count + 1);
+  QCOMPARE(registry.intern(name), atom);
+  QCOMPARE(registry.find(name), atom);
+  QCOMPARE(registry.count(), count + 1);
+  QCOMPARE(registry.name(atom), name);
+  QVERIFY(registry.intern(QLatin1String("TestIntern name")) != atom);
+  QCOMPARE(registry.intern(QLatin1String("")), 0);
+  QCOMPARE(registry.name(registry.atomOfType(Frame::FT_Album)),
+           QString(QLatin1String("Album")));
+  QCOMPARE(registry.atomOfType(Frame::FT_Album),
+           registry.intern(QLatin1String("Album")));
+}
+
+void TestFrameNameRegistry::testTypeOfName()
+{
+  for (int i = Frame::FT_FirstFrame; i <= Frame::FT_LastFrame; ++i) {
+    Frame::Type type = static_cast<Frame::Type>(i);
+    QString name = QString::fromLatin1(FrameNameRegistry::nameOfType(type));
+    QCOMPARE(FrameNameRegistry::typeOfName(name), type);
+    QCOMPARE(FrameNameRegistry::typeOfName(name.toLower()), type);
+    QCOMPARE(FrameNameRegistry::typeOfName(name.toUpper().remove(QLatin1Char(' '))),
+             type);
+  }
+  QCOMPARE(FrameNameRegistry::typeOfName(QLatin1String("track number")),
+           Frame::FT_Track);
+  QCOMPARE(FrameNameRegistry::typeOfName(QLatin1String(" Track  Number ")),
+           Frame::FT_Track);
+  QCOMPARE(FrameNameRegistry::typeOfName(QLatin1String("Track Numbers")),
+           Frame::FT_Other);
+  QCOMPARE(FrameNameRegistry::typeOfName(QLatin1String("TIT2")),
+           Frame::FT_Other);
+  QCOMPARE(FrameNameRegistry::typeOfName(QLatin1String("")),
+           Frame::FT_Other);
+  foreach (const QString& name, getSampleNames()) {
+    QCOMPARE(Frame::getTypeFromName(name), getTypeFromNameWithMap(name));
+  }
+}
+
+void TestFrameNameRegistry::testDisplayName()
+{
+  QCOMPARE(Frame::getDisplayName(QLatin1String("Album Artist")),
+           QString(QLatin1String("Album Artist")));
+  QCOMPARE(Frame::getDisplayName(QLatin1String("TDRC - Recording time")),
+           QString(QLatin1String("Recording Time")));
+  QCOMPARE(Frame::getDisplayName(
+             QLatin1String("TXXX - User defined text information\nCATALOG")),
+           QString(QLatin1String("CATALOG")));
+  QCOMPARE(Frame::getDisplayName(QLatin1String("LABEL")),
+           QString(QLatin1String("Label")));
+  QCOMPARE(Frame::getDisplayName(QLatin1String("XYZW")),
+           QString(QLatin1String("XYZW")));
+  QCOMPARE(Frame::getDisplayName(QString()), QString());
+  // Names which are only displayed are not registered.
+  FrameNameRegistry& registry = FrameNameRegistry::instance();
+  const int count = registry.count();
+  QCOMPARE(Frame::getDisplayName(
+             QLatin1String("TXXX - User defined text information\nDISPLAYED")),
+           QString(QLatin1String("DISPLAYED")));
+  QCOMPARE(Frame::getDisplayName(QLatin1String("TestDisplayName tvsh")),
+           QString(QLatin1String("TestDisplayName tvsh")));
+  QCOMPARE(registry.count(), count);
+  QCOMPARE(QByteArray(FrameNameRegistry::displayNameOfId("tvsh")),
+           QByteArray("TV Show Name"));
+  QVERIFY(!FrameNameRegistry::displayNameOfId("TVSH"));
+  QVERIFY(FrameNameRegistry::idsWithDisplayName("Total Tracks").contains(
+            "TRACKTOTAL"));
+  foreach (const QString& name, getSampleNames()) {
+    QCOMPARE(Frame::getDisplayName(name), getDisplayNameWithMap(name));
+  }
+}
+
+void TestFrameNameRegistry::testExtendedType()
+{
+  Frame::ExtendedType a(Frame::FT_Other, QLatin1String("ALPHA"));
+  Frame::ExtendedType b(Frame::FT_Other, QLatin1String("BETA"));
+  Frame::ExtendedType b2(QLatin1String("BETA"));
+  QCOMPARE(b2.getType(), Frame::FT_Other);
+  QVERIFY(b == b2);
+  QVERIFY(!(a == b));
+  // Names registered later must still be ordered by name.
+  QVERIFY(!(b < Frame::ExtendedType(Frame::FT_Other, QLatin1String("AAA"))));
+  QVERIFY(Frame::ExtendedType(Frame::FT_Other, QLatin1String("AAA")) < a);
+  QVERIFY(a < b);
+  QVERIFY(!(b < a));
+  QVERIFY(!(b < b2));
+
+  Frame::ExtendedType title(QLatin1String("title"));
+  QCOMPARE(title.getType(), Frame::FT_Title);
+  QCOMPARE(title.getName(), QString(QLatin1String("Title")));
+  QCOMPARE(title.getInternalName(), QString(QLatin1String("title")));
+  QVERIFY(title == Frame::ExtendedType(Frame::FT_Title, QLatin1String("TIT2")));
+  QVERIFY(title < a);
+
+  Frame::ExtendedType other(Frame::FT_Other, QLatin1String("TXXX - Note"));
+  QCOMPARE(other.getName(), QString(QLatin1String("TXXX - Note")));
+  QCOMPARE(Frame::ExtendedType(Frame::FT_Track).getName(),
+           QString(QLatin1String("Track Number")));
+  QCOMPARE(Frame::ExtendedType().getInternalName(), QString());
+}
+
+void TestFrameNameRegistry::testConcurrentIntern()
+{
+  QStringList names;
+  for (int i = 0; i < 1000; ++i) {
+    names.append(QString(QLatin1String("ConcurrentName%1")).arg(i));
+  }
+  QList<InternThread*> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.append(new InternThread(names));
+  }
+  foreach (InternThread* thread, threads) {
+    thread->start();
+  }
+  foreach (InternThread* thread, threads) {
+    thread->wait();
+  }
+  FrameNameRegistry& registry = FrameNameRegistry::instance();
+  for (int i = 0; i < names.size(); ++i) {
+    int atom = registry.find(names.at(i));
+    QVERIFY(atom > 0);
+    QCOMPARE(registry.name(atom), names.at(i));
+    foreach (InternThread* thread, threads) {
+      QCOMPARE(thread->atoms().at(i), atom);
+    }
+  }
+  qDeleteAll(threads);
+}
+
+void TestFrameNameRegistry::benchmarkTypeFromName_data()
+{
+  QTest::addColumn<bool>("useRegistry");
+  QTest::newRow("map") << false;
+  QTest::newRow("registry") << true;
+}
+
+void TestFrameNameRegistry::benchmarkTypeFromName()
+{
+  QFETCH(bool, useRegistry);
+  const QStringList names = getSampleNames();
+  int numOther = 0;
+  if (useRegistry) {
+    QBENCHMARK {
+      foreach (const QString& name, names) {
+        if (Frame::getTypeFromName(name) == Frame::FT_Other) {
+          ++numOther;
+        }
+      }
+    }
+  } else {
+    QBENCHMARK {
+      foreach (const QString& name, names) {
+        if (getTypeFromNameWithMap(name) == Frame::FT_Other) {
+          ++numOther;
+        }
+      }
+    }
+  }
+  QVERIFY(numOther > 0);
+}
+
+void TestFrameNameRegistry::benchmarkDisplayName_data()
+{
+  QTest::addColumn<bool>("useRegistry");
+  QTest::newRow("map") << false;
+  QTest::newRow("registry") << true;
+}
+
+void TestFrameNameRegistry::benchmarkDisplayName()
+{
+  QFETCH(bool, useRegistry);
+  const QStringList names = getSampleNames();
+  int length = 0;
+  if (useRegistry) {
+    QBENCHMARK {
+      foreach (const QString& name, names) {
+        length += Frame::getDisplayName(name).length();
+      }
+    }
+  } else {
+    QBENCHMARK {
+      foreach (const QString& name, names) {
+        length += getDisplayNameWithMap(name).length();
+      }
+    }
+  }
+  QVERIFY(length > 0);
+}
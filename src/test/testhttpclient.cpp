@@ -0,0 +1,316 @@
+/**
+ * \file testhttpclient.cpp
+ * Test HTTP client and request scheduler with a local mock server.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "testhttpclient.h"
+#include <QTest>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QNetworkAccessManager>
+#include "dummysettings.h"
+#include "configstore.h"
+#include "httpclient.h"
+#include "httprequestscheduler.h"
+
+MockHttpServer::MockHttpServer(QObject* parent) : QTcpServer(parent),
+  m_responseDelay(0), m_holdResponses(false)
+{
+  connect(this, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+}
+
+void MockHttpServer::onNewConnection()
+{
+  while (QTcpSocket* socket = nextPendingConnection()) {
+    connect(socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+    connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+  }
+}
+
+void MockHttpServer::onReadyRead()
+{
+  QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+  if (!socket)
+    return;
+
+  QByteArray request = socket->property("request").toByteArray();
+  request += socket->readAll();
+  socket->setProperty("request", request);
+  if (!request.contains("\r\n\r\n"))
+    return;
+
+  // Request line: GET /path HTTP/1.1
+  QList<QByteArray> requestLine = request.left(request.indexOf('\r')).split(' ');
+  QString path = requestLine.size() > 1
+      ? QString::fromLatin1(requestLine.at(1)) : QString();
+  m_requestedPaths.append(path);
+  socket->setProperty("request", QByteArray());
+  socket->setProperty("path", path);
+
+  QTimer* timer = new QTimer(socket);
+  timer->setSingleShot(true);
+  connect(timer, SIGNAL(timeout()), this, SLOT(sendResponse()));
+  if (m_holdResponses) {
+    m_heldResponses.append(timer);
+  } else {
+    timer->start(m_responseDelay);
+  }
+}
+
+void MockHttpServer::releaseResponses()
+{
+  m_holdResponses = false;
+  foreach (const QPointer<QTimer>& timer, m_heldResponses) {
+    if (timer) {
+      timer->start(m_responseDelay);
+    }
+  }
+  m_heldResponses.clear();
+}
+
+void MockHttpServer::sendResponse()
+{
+  QTimer* timer = qobject_cast<QTimer*>(sender());
+  QTcpSocket* socket = timer ? qobject_cast<QTcpSocket*>(timer->parent()) : 0;
+  if (!socket)
+    return;
+
+  QByteArray body = socket->property("path").toString().toLatin1();
+  QByteArray response("HTTP/1.1 200 OK\r\n"
+                      "Content-Type: text/plain\r\n"
+                      "Connection: close\r\n"
+                      "Content-Length: ");
+  response += QByteArray::number(body.size());
+  response += "\r\n\r\n";
+  response += body;
+  socket->write(response);
+  socket->disconnectFromHost();
+  timer->deleteLater();
+}
+
+
+TestHttpClient::TestHttpClient(QObject* parent) : QObject(parent),
+  m_netMgr(new QNetworkAccessManager(this)),
+  m_server(new MockHttpServer(this)),
+  m_settings(0), m_configStore(0)
+{
+  if (!ConfigStore::instance()) {
+    m_settings = new DummySettings;
+    m_configStore = new ConfigStore(m_settings);
+  }
+}
+
+TestHttpClient::~TestHttpClient()
+{
+  delete m_configStore;
+  delete m_settings;
+}
+
+void TestHttpClient::initTestCase()
+{
+  QVERIFY(m_server->listen(QHostAddress::LocalHost));
+}
+
+void TestHttpClient::cleanup()
+{
+  HttpRequestScheduler::instance()->setMinimumRequestInterval(
+        QLatin1String("127.0.0.1"), 0);
+  m_server->setResponseDelay(0);
+  m_server->releaseResponses();
+  m_server->clearRequests();
+}
+
+QUrl TestHttpClient::serverUrl(const QString& path) const
+{
+  return QUrl(QString(QLatin1String("http://127.0.0.1:%1%2"))
+              .arg(m_server->serverPort()).arg(path));
+}
+
+bool TestHttpClient::waitForRequests(int count)
+{
+  QElapsedTimer timer;
+  timer.start();
+  while (m_server->requestCount() < count && timer.elapsed() < 5000) {
+    QTest::qWait(5);
+  }
+  return m_server->requestCount() == count;
+}
+
+bool TestHttpClient::waitForResponses(const QList<HttpClient*>& clients,
+                                      QList<QByteArray>* responses)
+{
+  QList<QSignalSpy*> spies;
+  foreach (HttpClient* client, clients) {
+    spies.append(new QSignalSpy(client, SIGNAL(bytesReceived(QByteArray))));
+  }
+  QElapsedTimer timer;
+  timer.start();
+  bool allReceived = false;
+  while (!allReceived && timer.elapsed() < 5000) {
+    QTest::qWait(5);
+    allReceived = true;
+    foreach (QSignalSpy* spy, spies) {
+      if (spy->isEmpty()) {
+        allReceived = false;
+        break;
+      }
+    }
+  }
+  if (responses) {
+    foreach (QSignalSpy* spy, spies) {
+      responses->append(spy->isEmpty()
+                        ? QByteArray() : spy->first().first().toByteArray());
+    }
+  }
+  qDeleteAll(spies);
+  return allReceived;
+}
+
+void TestHttpClient::testConcurrentRequests()
+{
+  const int numRequests = 4;
+  m_server->setHoldResponses(true);
+
+  QList<HttpClient*> clients;
+  for (int i = 0; i < numRequests; ++i) {
+    clients.append(new HttpClient(m_netMgr));
+  }
+  for (int i = 0; i < numRequests; ++i) {
+    clients.at(i)->sendRequest(serverUrl(QString(QLatin1String("/album%1"))
+                                         .arg(i)));
+  }
+  // Sent one after the other, only the first request would arrive before
+  // its response is released.
+  QVERIFY(waitForRequests(numRequests));
+  m_server->releaseResponses();
+  QList<QByteArray> responses;
+  QVERIFY(waitForResponses(clients, &responses));
+  qDeleteAll(clients);
+
+  QCOMPARE(m_server->requestCount(), numRequests);
+  for (int i = 0; i < numRequests; ++i) {
+    QCOMPARE(responses.at(i), QByteArray("/album") + QByteArray::number(i));
+  }
+}
+
+void TestHttpClient::testRateLimit()
+{
+  const int numRequests = 3;
+  // The interval is long enough that no token is added during the test.
+  HttpRequestScheduler* scheduler = HttpRequestScheduler::instance();
+  scheduler->setMinimumRequestInterval(QLatin1String("127.0.0.1"), 600000);
+
+  QList<HttpClient*> clients;
+  QList<QSignalSpy*> startSpies;
+  for (int i = 0; i < numRequests; ++i) {
+    HttpClient* client = new HttpClient(m_netMgr);
+    clients.append(client);
+    startSpies.append(new QSignalSpy(client,
+                                     SIGNAL(progress(QString,int,int))));
+  }
+  for (int i = 0; i < numRequests; ++i) {
+    clients.at(i)->sendRequest(serverUrl(QString(QLatin1String("/track%1"))
+                                         .arg(i)));
+  }
+  // Only the first request gets a token.
+  QVERIFY(waitForResponses(QList<HttpClient*>() << clients.first()));
+  QCOMPARE(m_server->requestedPaths(),
+           QStringList() << QLatin1String("/track0"));
+  for (int i = 1; i < numRequests; ++i) {
+    QVERIFY(startSpies.at(i)->isEmpty());
+  }
+
+  // Lifting the rate limit sends the waiting requests.
+  scheduler->setMinimumRequestInterval(QLatin1String("127.0.0.1"), 0);
+  QVERIFY(waitForResponses(clients));
+  qDeleteAll(startSpies);
+  qDeleteAll(clients);
+
+  QCOMPARE(m_server->requestCount(), numRequests);
+  QCOMPARE(m_server->requestedPaths().first(),
+           QString(QLatin1String("/track0")));
+}
+
+void TestHttpClient::testPriorities()
+{
+  HttpRequestScheduler::instance()->setMinimumRequestInterval(
+        QLatin1String("127.0.0.1"), 50);
+
+  HttpClient first(m_netMgr);
+  HttpClient low(m_netMgr);
+  HttpClient high(m_netMgr);
+  low.setPriority(HttpClient::LowPriority);
+  high.setPriority(HttpClient::HighPriority);
+  // The first request takes the token, the others have to wait.
+  first.sendRequest(serverUrl(QLatin1String("/first")));
+  low.sendRequest(serverUrl(QLatin1String("/low")));
+  high.sendRequest(serverUrl(QLatin1String("/high")));
+  QVERIFY(waitForResponses(QList<HttpClient*>() << &first << &low << &high));
+
+  QCOMPARE(m_server->requestedPaths(), QStringList()
+           << QLatin1String("/first") << QLatin1String("/high")
+           << QLatin1String("/low"));
+}
+
+void TestHttpClient::testCoalescedRequests()
+{
+  m_server->setResponseDelay(100);
+  HttpRequestScheduler* scheduler = HttpRequestScheduler::instance();
+  quint64 coalescedCount = scheduler->coalescedCount();
+
+  HttpClient client1(m_netMgr);
+  HttpClient client2(m_netMgr);
+  client1.sendRequest(serverUrl(QLatin1String("/cover")));
+  client2.sendRequest(serverUrl(QLatin1String("/cover")));
+  QList<QByteArray> responses;
+  QVERIFY(waitForResponses(QList<HttpClient*>() << &client1 << &client2,
+                           &responses));
+
+  QCOMPARE(m_server->requestCount(), 1);
+  QCOMPARE(scheduler->coalescedCount(), coalescedCount + 1);
+  QCOMPARE(responses.at(0), QByteArray("/cover"));
+  QCOMPARE(responses.at(1), QByteArray("/cover"));
+  QCOMPARE(client2.getContentType(), QString(QLatin1String("text/plain")));
+}
+
+void TestHttpClient::testStaleResponse()
+{
+  m_server->setHoldResponses(true);
+
+  // The first request of the leader is still in flight when it sends
+  // another request, which is coalesced with the request of the follower.
+  HttpClient leader(m_netMgr);
+  HttpClient follower(m_netMgr);
+  leader.sendRequest(serverUrl(QLatin1String("/old")));
+  leader.sendRequest(serverUrl(QLatin1String("/new")));
+  follower.sendRequest(serverUrl(QLatin1String("/new")));
+  QVERIFY(waitForRequests(2));
+  m_server->releaseResponses();
+  QList<QByteArray> responses;
+  QVERIFY(waitForResponses(QList<HttpClient*>() << &follower, &responses));
+
+  // The response to the old request must not be delivered to the follower.
+  QCOMPARE(responses.at(0), QByteArray("/new"));
+}
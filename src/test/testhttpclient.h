@@ -0,0 +1,99 @@
+/**
+ * \file testhttpclient.h
+ * Test HTTP client and request scheduler with a local mock server.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef TESTHTTPCLIENT_H
+#define TESTHTTPCLIENT_H
+
+#include <QTcpServer>
+#include <QStringList>
+#include <QUrl>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+
+class QNetworkAccessManager;
+class HttpClient;
+class ISettings;
+class ConfigStore;
+
+/**
+ * HTTP server answering every request after a delay with its path.
+ * Responses can be held back until releaseResponses() is called.
+ */
+class MockHttpServer : public QTcpServer {
+  Q_OBJECT
+public:
+  explicit MockHttpServer(QObject* parent = 0);
+
+  void setResponseDelay(int msec) { m_responseDelay = msec; }
+  void setHoldResponses(bool hold) { m_holdResponses = hold; }
+  void releaseResponses();
+  int requestCount() const { return m_requestedPaths.size(); }
+  QStringList requestedPaths() const { return m_requestedPaths; }
+  void clearRequests() { m_requestedPaths.clear(); }
+
+private slots:
+  void onNewConnection();
+  void onReadyRead();
+  void sendResponse();
+
+private:
+  int m_responseDelay;
+  bool m_holdResponses;
+  QStringList m_requestedPaths;
+  QList<QPointer<QTimer> > m_heldResponses;
+};
+
+/**
+ * Test HTTP client and request scheduler.
+ */
+class TestHttpClient : public QObject {
+  Q_OBJECT
+public:
+  explicit TestHttpClient(QObject* parent = 0);
+  virtual ~TestHttpClient();
+
+private slots:
+  void initTestCase();
+  void cleanup();
+  void testConcurrentRequests();
+  void testRateLimit();
+  void testPriorities();
+  void testCoalescedRequests();
+  void testStaleResponse();
+
+private:
+  QUrl serverUrl(const QString& path) const;
+  bool waitForRequests(int count);
+  bool waitForResponses(const QList<HttpClient*>& clients,
+                        QList<QByteArray>* responses = 0);
+
+  QNetworkAccessManager* m_netMgr;
+  MockHttpServer* m_server;
+  ISettings* m_settings;
+  ConfigStore* m_configStore;
+};
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ * \file testhttpresponsecache.cpp
+ * Test disk cache for HTTP responses.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testhttpresponsecache.h"
+#include <QDir>
+#include <QFile>
+#include <QDateTime>
+#include <QNetworkCacheMetaData>
+#include "httpresponsecache.h"
+
+namespace {
+
+/** Time to live of cache used for the tests. */
+const int TimeToLive = 24 * 60 * 60;
+
+/**
+ * Remove a directory with all its contents.
+ * @param path path of directory
+ * @return true if ok.
+ */
+bool removeDirectory(const QString& path)
+{
+  QDir dir(path);
+  foreach (const QFileInfo& fi, dir.entryInfoList(
+             QDir::AllEntries | QDir::NoDotAndDotDot |
+             QDir::Hidden | QDir::System)) {
+    if (fi.isDir() && !fi.isSymLink()) {
+      if (!removeDirectory(fi.filePath()))
+        return false;
+    } else if (!QFile::remove(fi.filePath())) {
+      return false;
+    }
+  }
+  return QDir().rmdir(path);
+}
+
+/**
+ * Create meta data of a response.
+ * @param url URL of request
+ * @param cacheControl value of Cache-Control header, empty if not present
+ * @return meta data.
+ */
+QNetworkCacheMetaData responseMetaData(const QUrl& url,
+                                       const QByteArray& cacheControl)
+{
+  QNetworkCacheMetaData md;
+  md.setUrl(url);
+  md.setSaveToDisk(true);
+  QNetworkCacheMetaData::RawHeaderList headers;
+  headers.append(qMakePair(QByteArray("Content-Type"),
+                           QByteArray("application/json")));
+  if (!cacheControl.isEmpty()) {
+    headers.append(qMakePair(QByteArray("Cache-Control"), cacheControl));
+  }
+  md.setRawHeaders(headers);
+  return md;
+}
+
+}
+
+void TestHttpResponseCache::initTestCase()
+{
+  m_cachePath = QDir::tempPath() + QLatin1Char('/') +
+      QLatin1String("kid3_testhttpresponsecache");
+  removeDirectory(m_cachePath);
+  m_cache = new HttpResponseCache(this);
+  m_cache->setCacheDirectory(m_cachePath);
+  m_cache->setTimeToLive(TimeToLive);
+}
+
+void TestHttpResponseCache::cleanupTestCase()
+{
+  delete m_cache;
+  m_cache = 0;
+  removeDirectory(m_cachePath);
+}
+
+void TestHttpResponseCache::testCacheControl_data()
+{
+  QTest::addColumn<QByteArray>("cacheControl");
+  QTest::addColumn<bool>("stored");
+  QTest::addColumn<int>("lifetime");
+
+  QTest::newRow("none") << QByteArray() << true << TimeToLive;
+  QTest::newRow("public") << QByteArray("public") << true << TimeToLive;
+  QTest::newRow("maxage") << QByteArray("public, max-age=3600")
+                          << true << 3600;
+  QTest::newRow("maxagezero") << QByteArray("max-age=0") << true << 0;
+  QTest::newRow("nocache") << QByteArray("No-Cache") << true << 0;
+  QTest::newRow("nostore") << QByteArray("no-store") << false << 0;
+  QTest::newRow("nocachenostore") << QByteArray("no-cache, no-store")
+                                  << false << 0;
+  QTest::newRow("invalidmaxage") << QByteArray("max-age=soon")
+                                 << true << TimeToLive;
+}
+
+void TestHttpResponseCache::testCacheControl()
+{
+  QFETCH(QByteArray, cacheControl);
+  QFETCH(bool, stored);
+  QFETCH(int, lifetime);
+
+  QUrl url(QString(QLatin1String("http://example.com/")) +
+           QLatin1String(QTest::currentDataTag()));
+  QIODevice* device = m_cache->prepare(responseMetaData(url, cacheControl));
+  QCOMPARE(device != 0, stored);
+  if (!device)
+    return;
+
+  device->write("{}");
+  m_cache->insert(device);
+  QNetworkCacheMetaData md = m_cache->metaData(url);
+  QVERIFY(md.isValid());
+  QVERIFY(md.expirationDate().isValid());
+  int secs = QDateTime::currentDateTimeUtc().secsTo(md.expirationDate());
+  QVERIFY(qAbs(secs - lifetime) <= 5);
+  QCOMPARE(m_cache->isFresh(url), lifetime > 0);
+}
+
+void TestHttpResponseCache::testRevalidation()
+{
+  QUrl url(QLatin1String("http://example.com/revalidated"));
+  QIODevice* device = m_cache->prepare(responseMetaData(url, "max-age=0"));
+  QVERIFY(device);
+  device->write("{}");
+  m_cache->insert(device);
+  QVERIFY(!m_cache->isFresh(url));
+
+  // A revalidated response without directives gets the time to live.
+  m_cache->updateMetaData(responseMetaData(url, QByteArray()));
+  QVERIFY(m_cache->isFresh(url));
+
+  // A response which must no longer be stored is removed.
+  m_cache->updateMetaData(responseMetaData(url, "no-store"));
+  QVERIFY(!m_cache->metaData(url).isValid());
+}
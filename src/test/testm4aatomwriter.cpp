@@ -0,0 +1,345 @@
+/**
+ * \file testm4aatomwriter.cpp
+ * Test restoring the atom layout of MP4 files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testm4aatomwriter.h"
+#include <QDir>
+#include <QFile>
+#include "m4aatomwriter.h"
+
+namespace {
+
+/** Size of the media data in the test files. */
+const int MediaDataSize = 4096;
+
+/**
+ * Get a big endian 32 bit integer.
+ * @param value integer value
+ * @return 4 bytes.
+ */
+QByteArray be32(quint32 value)
+{
+  QByteArray bytes(4, '\0');
+  for (int i = 3; i >= 0; --i) {
+    bytes[i] = static_cast<char>(value & 0xff);
+    value >>= 8;
+  }
+  return bytes;
+}
+
+/**
+ * Get a big endian 64 bit integer.
+ * @param value integer value
+ * @return 8 bytes.
+ */
+QByteArray be64(quint64 value)
+{
+  return be32(static_cast<quint32>(value >> 32)) +
+      be32(static_cast<quint32>(value & 0xffffffffU));
+}
+
+/**
+ * Read a big endian integer.
+ * @param data bytes
+ * @param pos position of integer
+ * @param size number of bytes
+ * @return integer value.
+ */
+quint64 readBe(const QByteArray& data, int pos, int size)
+{
+  quint64 value = 0;
+  for (int i = 0; i < size; ++i) {
+    value = (value << 8) | static_cast<uchar>(data.at(pos + i));
+  }
+  return value;
+}
+
+/**
+ * Create an atom.
+ * @param type atom type
+ * @param content content of atom
+ * @return atom data.
+ */
+QByteArray atom(const char* type, const QByteArray& content = QByteArray())
+{
+  return be32(content.size() + 8) + QByteArray(type, 4) + content;
+}
+
+/**
+ * Create a moov atom with one track using stco and one using co64.
+ * @param offsets chunk offsets of both tracks
+ * @param ilstSize size of the item list contents
+ * @return moov atom.
+ */
+QByteArray moovAtom(const QList<quint64>& offsets, int ilstSize)
+{
+  QByteArray stco = be32(0) + be32(offsets.size());
+  QByteArray co64 = be32(0) + be32(offsets.size());
+  foreach (quint64 offset, offsets) {
+    stco += be32(static_cast<quint32>(offset));
+    co64 += be64(offset);
+  }
+  return atom("moov",
+              atom("trak", atom("mdia", atom("minf", atom("stbl",
+                   atom("stsd") + atom("stco", stco))))) +
+              atom("trak", atom("mdia", atom("minf", atom("stbl",
+                   atom("co64", co64))))) +
+              atom("udta", atom("meta", be32(0) +
+                   atom("ilst", QByteArray(ilstSize, 'i')))));
+}
+
+/**
+ * Create media data.
+ * @return mdat atom with MediaDataSize bytes of content.
+ */
+QByteArray mdatAtom()
+{
+  QByteArray data(MediaDataSize, '\0');
+  for (int i = 0; i < MediaDataSize; ++i) {
+    data[i] = static_cast<char>(i * 7);
+  }
+  return atom("mdat", data);
+}
+
+/**
+ * Get chunk offsets pointing into media data.
+ * @param mdatOffset offset of mdat atom
+ * @return chunk offsets.
+ */
+QList<quint64> chunkOffsets(qint64 mdatOffset)
+{
+  return QList<quint64>() << mdatOffset + 8 << mdatOffset + 1032
+                          << mdatOffset + 3000;
+}
+
+/**
+ * Read chunk offsets from the stco or co64 atom of a file.
+ * @param data file data
+ * @param type "stco" or "co64"
+ * @return chunk offsets.
+ */
+QList<quint64> readChunkOffsets(const QByteArray& data, const char* type)
+{
+  QList<quint64> offsets;
+  const int pos = data.indexOf(type);
+  if (pos < 0)
+    return offsets;
+  const int entrySize = type[0] == 'c' ? 8 : 4;
+  const int numEntries = static_cast<int>(readBe(data, pos + 8, 4));
+  for (int i = 0; i < numEntries; ++i) {
+    offsets.append(readBe(data, pos + 12 + i * entrySize, entrySize));
+  }
+  return offsets;
+}
+
+/**
+ * Get the top level atoms of a file.
+ * @param data file data
+ * @return "type:size" strings.
+ */
+QStringList topLevelAtoms(const QByteArray& data)
+{
+  QStringList atoms;
+  int pos = 0;
+  while (pos + 8 <= data.size()) {
+    const int size = static_cast<int>(readBe(data, pos, 4));
+    if (size < 8)
+      break;
+    atoms.append(QString::fromLatin1(data.mid(pos + 4, 4)) +
+                 QLatin1Char(':') + QString::number(size));
+    pos += size;
+  }
+  return atoms;
+}
+
+/**
+ * Modify a file like mp4v2 does when the metadata does not fit: the old
+ * moov atom becomes a free atom and the new moov atom is appended.
+ * @param data file data
+ * @param moovOffset offset of old moov atom
+ * @param newMoov new moov atom
+ */
+void modifyLikeMp4v2(QByteArray& data, int moovOffset,
+                     const QByteArray& newMoov)
+{
+  data.replace(moovOffset + 4, 4, "free");
+  data.append(newMoov);
+}
+
+/**
+ * Read a file.
+ * @param path path of file
+ * @return contents of file.
+ */
+QByteArray readFile(const QString& path)
+{
+  QFile file(path);
+  return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+/**
+ * Write a file.
+ * @param path path of file
+ * @param data contents of file
+ * @return true if ok.
+ */
+bool writeFile(const QString& path, const QByteArray& data)
+{
+  QFile file(path);
+  return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+}
+
+void TestM4aAtomWriter::init()
+{
+  m_filePath = QDir::temp().filePath(QLatin1String("kid3_testm4a.m4a"));
+}
+
+void TestM4aAtomWriter::cleanup()
+{
+  QFile::remove(m_filePath);
+  QFile::remove(m_filePath + QLatin1String("_KID3"));
+}
+
+void TestM4aAtomWriter::testMoveMoovIntoFreeSpace()
+{
+  const QByteArray ftyp = atom("ftyp", QByteArray("M4A \0\0\0\0", 8));
+  const QByteArray free = atom("free", QByteArray(400, '\0'));
+  const int moovOffset = ftyp.size();
+  // The size of the moov atom depends only on the number of offsets.
+  const qint64 mdatOffset =
+      moovOffset + moovAtom(chunkOffsets(0), 100).size() + free.size();
+  const QList<quint64> offsets = chunkOffsets(mdatOffset);
+  const QByteArray moov = moovAtom(offsets, 100);
+  const QByteArray mdat = mdatAtom();
+  QByteArray data = ftyp + moov + free + mdat;
+  QVERIFY(writeFile(m_filePath, data));
+
+  M4aAtomWriter writer(m_filePath, 1024, false);
+  QVERIFY(writer.readLayout());
+  const QByteArray newMoov = moovAtom(offsets, 300);
+  modifyLikeMp4v2(data, moovOffset, newMoov);
+  QVERIFY(writeFile(m_filePath, data));
+  QCOMPARE(writer.restoreLayout(), M4aAtomWriter::MovedInPlace);
+
+  // The free space is reused, the media data is not moved.
+  data = readFile(m_filePath);
+  const int regionSize = moov.size() + free.size();
+  QCOMPARE(topLevelAtoms(data), QStringList()
+           << QString(QLatin1String("ftyp:%1")).arg(ftyp.size())
+           << QString(QLatin1String("moov:%1")).arg(newMoov.size())
+           << QString(QLatin1String("free:%1")).arg(
+                regionSize - newMoov.size())
+           << QString(QLatin1String("mdat:%1")).arg(mdat.size()));
+  QCOMPARE(data.mid(moovOffset, newMoov.size()), newMoov);
+  QCOMPARE(data.mid(mdatOffset), mdat);
+  QCOMPARE(readChunkOffsets(data, "stco"), offsets);
+  QCOMPARE(readChunkOffsets(data, "co64"), offsets);
+}
+
+void TestM4aAtomWriter::testMoveMediaData_data()
+{
+  QTest::addColumn<int>("paddingSize");
+  QTest::addColumn<bool>("growPadding");
+  QTest::addColumn<int>("expectedPadding");
+
+  QTest::newRow("padding") << 512 << false << 512;
+  QTest::newRow("nopadding") << 0 << false << 0;
+  // The item list with 1000 bytes of content and its header
+  QTest::newRow("grow") << 16 << true << 1008;
+}
+
+void TestM4aAtomWriter::testMoveMediaData()
+{
+  QFETCH(int, paddingSize);
+  QFETCH(bool, growPadding);
+  QFETCH(int, expectedPadding);
+
+  const QByteArray ftyp = atom("ftyp", QByteArray("M4A \0\0\0\0", 8));
+  const int moovOffset = ftyp.size();
+  const qint64 mdatOffset =
+      moovOffset + moovAtom(chunkOffsets(0), 100).size();
+  const QList<quint64> offsets = chunkOffsets(mdatOffset);
+  const QByteArray moov = moovAtom(offsets, 100);
+  const QByteArray mdat = mdatAtom();
+  QByteArray data = ftyp + moov + mdat;
+  QVERIFY(writeFile(m_filePath, data));
+
+  M4aAtomWriter writer(m_filePath, paddingSize, growPadding);
+  QVERIFY(writer.readLayout());
+  const QByteArray newMoov = moovAtom(offsets, 1000);
+  modifyLikeMp4v2(data, moovOffset, newMoov);
+  QVERIFY(writeFile(m_filePath, data));
+  QCOMPARE(writer.restoreLayout(), M4aAtomWriter::Rewritten);
+  QVERIFY(!QFile::exists(m_filePath + QLatin1String("_KID3")));
+
+  // The media data is moved behind the new moov atom and the padding,
+  // the chunk offsets are adjusted.
+  data = readFile(m_filePath);
+  const qint64 delta = newMoov.size() + expectedPadding - moov.size();
+  QStringList expectedAtoms;
+  expectedAtoms << QString(QLatin1String("ftyp:%1")).arg(ftyp.size())
+                << QString(QLatin1String("moov:%1")).arg(newMoov.size());
+  if (expectedPadding > 0) {
+    expectedAtoms << QString(QLatin1String("free:%1")).arg(expectedPadding);
+  }
+  expectedAtoms << QString(QLatin1String("mdat:%1")).arg(mdat.size());
+  QCOMPARE(topLevelAtoms(data), expectedAtoms);
+  QCOMPARE(data.size(), ftyp.size() + newMoov.size() + expectedPadding +
+           mdat.size());
+  QCOMPARE(data.mid(mdatOffset + delta), mdat);
+  QList<quint64> movedOffsets;
+  foreach (quint64 offset, offsets) {
+    movedOffsets.append(offset + delta);
+  }
+  QCOMPARE(readChunkOffsets(data, "stco"), movedOffsets);
+  QCOMPARE(readChunkOffsets(data, "co64"), movedOffsets);
+}
+
+void TestM4aAtomWriter::testMoovAfterMediaData()
+{
+  const QByteArray ftyp = atom("ftyp", QByteArray("M4A \0\0\0\0", 8));
+  const QByteArray mdat = mdatAtom();
+  const QByteArray moov = moovAtom(chunkOffsets(ftyp.size()), 100);
+  QVERIFY(writeFile(m_filePath, ftyp + mdat + moov));
+
+  // The moov atom has to be moved to the front by optimizing the file.
+  M4aAtomWriter writer(m_filePath, 1024, false);
+  QVERIFY(writer.readLayout());
+  QCOMPARE(writer.restoreLayout(), M4aAtomWriter::NotHandled);
+  QCOMPARE(readFile(m_filePath), ftyp + mdat + moov);
+}
+
+void TestM4aAtomWriter::testFragmentedFile()
+{
+  const QByteArray ftyp = atom("ftyp", QByteArray("M4A \0\0\0\0", 8));
+  const QByteArray moov = moovAtom(QList<quint64>(), 100);
+  QVERIFY(writeFile(m_filePath, ftyp + moov + atom("moof", be32(0)) +
+                    mdatAtom()));
+
+  M4aAtomWriter writer(m_filePath, 1024, false);
+  QVERIFY(!writer.readLayout());
+}
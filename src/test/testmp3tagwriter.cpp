@@ -0,0 +1,218 @@
+/**
+ * \file testmp3tagwriter.cpp
+ * Test writing ID3 tags into MP3 files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testmp3tagwriter.h"
+#include <QDir>
+#include <QFile>
+#include "mp3tagwriter.h"
+
+Q_DECLARE_METATYPE(Mp3TagWriter::Result)
+
+namespace {
+
+/** Size of the audio data in the test files. */
+const int AudioSize = 5000;
+
+/**
+ * Create an ID3v2 tag.
+ * @param fill byte used for the frame data
+ * @param framesSize size of frame data
+ * @param size size of tag including header and padding
+ * @return tag.
+ */
+QByteArray tagV2(char fill, int framesSize, int size)
+{
+  QByteArray tag("ID3\x03\x00\x00", 6);
+  const int tagSize = size - 10;
+  for (int i = 3; i >= 0; --i) {
+    tag.append(static_cast<char>((tagSize >> (7 * i)) & 0x7f));
+  }
+  tag.append(QByteArray(framesSize, fill));
+  tag.append(QByteArray(size - tag.size(), '\0'));
+  return tag;
+}
+
+/**
+ * Create an ID3v1 tag.
+ * @param fill byte used for the fields
+ * @return tag.
+ */
+QByteArray tagV1(char fill)
+{
+  return "TAG" + QByteArray(125, fill);
+}
+
+/**
+ * Get audio data starting with an MPEG frame header.
+ * @return audio data.
+ */
+QByteArray audioData()
+{
+  QByteArray audio(AudioSize, '\0');
+  for (int i = 0; i < audio.size(); ++i) {
+    audio[i] = static_cast<char>(i * 7);
+  }
+  audio[0] = '\xff';
+  audio[1] = '\xfb';
+  return audio;
+}
+
+/**
+ * Read a file.
+ * @param path path of file
+ * @return contents of file.
+ */
+QByteArray readFile(const QString& path)
+{
+  QFile file(path);
+  return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+/**
+ * Write a file.
+ * @param path path of file
+ * @param data contents of file
+ * @return true if ok.
+ */
+bool writeFile(const QString& path, const QByteArray& data)
+{
+  QFile file(path);
+  return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+}
+
+void TestMp3TagWriter::init()
+{
+  m_filePath = QDir::temp().filePath(QLatin1String("kid3_testtags.mp3"));
+}
+
+void TestMp3TagWriter::cleanup()
+{
+  QFile::remove(m_filePath);
+}
+
+void TestMp3TagWriter::testWrite_data()
+{
+  // Sizes of frame data, -1 for no tag. A new tag of -1 is not written,
+  // 0 removes the tag.
+  QTest::addColumn<int>("oldV2");
+  QTest::addColumn<int>("oldV2Padding");
+  QTest::addColumn<bool>("oldV1");
+  QTest::addColumn<int>("newV2");
+  QTest::addColumn<int>("newV1");
+  QTest::addColumn<int>("paddingSize");
+  QTest::addColumn<bool>("growPadding");
+  QTest::addColumn<Mp3TagWriter::Result>("result");
+  QTest::addColumn<int>("v2Size");
+
+  QTest::newRow("unchanged")
+      << 100 << 50 << true << -1 << -1 << 1024 << false
+      << Mp3TagWriter::WrittenInPlace << 160;
+  QTest::newRow("add v1")
+      << -1 << 0 << false << -1 << 1 << 1024 << false
+      << Mp3TagWriter::WrittenInPlace << 0;
+  QTest::newRow("replace v1")
+      << 100 << 0 << true << -1 << 1 << 1024 << false
+      << Mp3TagWriter::WrittenInPlace << 110;
+  QTest::newRow("remove v1")
+      << 100 << 0 << true << -1 << 0 << 1024 << false
+      << Mp3TagWriter::WrittenInPlace << 110;
+  QTest::newRow("add v2")
+      << -1 << 0 << true << 300 << -1 << 1000 << false
+      << Mp3TagWriter::Rewritten << 1310;
+  QTest::newRow("remove v2")
+      << 300 << 0 << true << 0 << -1 << 1024 << false
+      << Mp3TagWriter::Rewritten << 0;
+  QTest::newRow("remove both")
+      << 300 << 100 << true << 0 << 0 << 1024 << false
+      << Mp3TagWriter::Rewritten << 0;
+  QTest::newRow("shrink v2")
+      << 500 << 0 << false << 200 << 1 << 1024 << false
+      << Mp3TagWriter::WrittenInPlace << 510;
+  QTest::newRow("grow v2 into padding")
+      << 200 << 500 << true << 600 << -1 << 1024 << false
+      << Mp3TagWriter::WrittenInPlace << 710;
+  QTest::newRow("grow v2")
+      << 200 << 0 << true << 600 << 1 << 1000 << false
+      << Mp3TagWriter::Rewritten << 1610;
+  QTest::newRow("grow v2 once")
+      << 200 << 0 << false << 600 << -1 << 100 << true
+      << Mp3TagWriter::Rewritten << 1220;
+  // Without configured padding, the file size (1016 + 5000 + 128) is
+  // rounded up to a multiple of 2048 like id3lib does.
+  QTest::newRow("id3lib padding")
+      << -1 << 0 << true << 600 << -1 << 0 << false
+      << Mp3TagWriter::Rewritten << 1016;
+}
+
+void TestMp3TagWriter::testWrite()
+{
+  QFETCH(int, oldV2);
+  QFETCH(int, oldV2Padding);
+  QFETCH(bool, oldV1);
+  QFETCH(int, newV2);
+  QFETCH(int, newV1);
+  QFETCH(int, paddingSize);
+  QFETCH(bool, growPadding);
+  QFETCH(Mp3TagWriter::Result, result);
+  QFETCH(int, v2Size);
+
+  const QByteArray audio = audioData();
+  const QByteArray oldTagV2 = oldV2 >= 0
+      ? tagV2('o', oldV2, 10 + oldV2 + oldV2Padding) : QByteArray();
+  const QByteArray oldTagV1 = oldV1 ? tagV1('o') : QByteArray();
+  QVERIFY(writeFile(m_filePath, oldTagV2 + audio + oldTagV1));
+
+  Mp3TagWriter writer(m_filePath, paddingSize, growPadding);
+  if (newV2 >= 0) {
+    writer.setTagV2(newV2 > 0 ? tagV2('n', newV2, 10 + newV2)
+                              : QByteArray());
+  }
+  if (newV1 >= 0) {
+    writer.setTagV1(newV1 > 0 ? tagV1('n') : QByteArray());
+  }
+  QCOMPARE(writer.write(), result);
+
+  QByteArray expected;
+  if (v2Size > 0) {
+    expected = newV2 > 0 ? tagV2('n', newV2, v2Size) : oldTagV2;
+  }
+  expected += audio;
+  expected += newV1 > 0 ? tagV1('n') : newV1 == 0 ? QByteArray() : oldTagV1;
+  const QByteArray data = readFile(m_filePath);
+  QCOMPARE(data.size(), expected.size());
+  QVERIFY(data == expected);
+  QVERIFY(!QFile::exists(m_filePath + QLatin1String("_KID3")));
+}
+
+void TestMp3TagWriter::testMissingFile()
+{
+  Mp3TagWriter writer(m_filePath, 0, false);
+  writer.setTagV2(tagV2('n', 100, 110));
+  QCOMPARE(writer.write(), Mp3TagWriter::Failed);
+  QVERIFY(!QFile::exists(m_filePath));
+}
@@ -0,0 +1,463 @@
+/**
+ * \file testoggcommentwriter.cpp
+ * Test writing Vorbis comments into Ogg pages.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testoggcommentwriter.h"
+#include <QDir>
+#include <QFile>
+#include "oggcommentwriter.h"
+
+namespace {
+
+/** Serial number of the Vorbis stream in the test files. */
+const quint32 VorbisSerial = 0x1234;
+/** Serial number of a second stream in multiplexed test files. */
+const quint32 OtherSerial = 0x5678;
+/** Number of audio pages in the test files. */
+const int NumAudioPages = 5;
+
+/** Ogg page parsed from test data. */
+struct Page {
+  int flags;
+  quint32 serialNumber;
+  quint32 sequenceNumber;
+  qint64 granulePosition;
+  QByteArray laces;
+  QByteArray data;
+  bool checksumValid;
+};
+
+/**
+ * Get a little endian integer.
+ * @param data bytes
+ * @param pos position of integer
+ * @param size number of bytes
+ * @return integer value.
+ */
+quint64 readLe(const QByteArray& data, int pos, int size)
+{
+  quint64 value = 0;
+  for (int i = size - 1; i >= 0; --i) {
+    value = (value << 8) | static_cast<uchar>(data.at(pos + i));
+  }
+  return value;
+}
+
+/**
+ * Get little endian bytes of an integer.
+ * @param value integer value
+ * @param size number of bytes
+ * @return bytes.
+ */
+QByteArray le(quint64 value, int size)
+{
+  QByteArray bytes;
+  for (int i = 0; i < size; ++i) {
+    bytes.append(static_cast<char>(value & 0xff));
+    value >>= 8;
+  }
+  return bytes;
+}
+
+/**
+ * Calculate the Ogg checksum bit by bit.
+ * @param page page with zero checksum field
+ * @return checksum.
+ */
+quint32 oggChecksum(const QByteArray& page)
+{
+  quint32 crc = 0;
+  for (int i = 0; i < page.size(); ++i) {
+    crc ^= static_cast<quint32>(static_cast<uchar>(page.at(i))) << 24;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x80000000U) ? (crc << 1) ^ 0x04c11db7U : crc << 1;
+    }
+  }
+  return crc;
+}
+
+/**
+ * Create an Ogg page.
+ * @param flags header type flags
+ * @param serialNumber stream serial number
+ * @param sequenceNumber page sequence number
+ * @param granulePosition granule position
+ * @param packets complete packets in the page
+ * @return page data.
+ */
+QByteArray oggPage(int flags, quint32 serialNumber, quint32 sequenceNumber,
+                   qint64 granulePosition, const QList<QByteArray>& packets)
+{
+  QByteArray laces, data;
+  foreach (const QByteArray& packet, packets) {
+    int size = packet.size();
+    for (; size >= 255; size -= 255) {
+      laces.append(static_cast<char>(255));
+    }
+    laces.append(static_cast<char>(size));
+    data.append(packet);
+  }
+  QByteArray page = QByteArray("OggS", 4) + '\0' +
+      static_cast<char>(flags) + le(granulePosition, 8) +
+      le(serialNumber, 4) + le(sequenceNumber, 4) + le(0, 4) +
+      static_cast<char>(laces.size()) + laces + data;
+  page.replace(22, 4, le(oggChecksum(page), 4));
+  return page;
+}
+
+/**
+ * Parse the pages of an Ogg file.
+ * @param data file data
+ * @return pages.
+ */
+QList<Page> oggPages(const QByteArray& data)
+{
+  QList<Page> pages;
+  int pos = 0;
+  while (pos + 27 <= data.size() && data.mid(pos, 4) == "OggS") {
+    Page page;
+    page.flags = static_cast<uchar>(data.at(pos + 5));
+    page.granulePosition = static_cast<qint64>(readLe(data, pos + 6, 8));
+    page.serialNumber = static_cast<quint32>(readLe(data, pos + 14, 4));
+    page.sequenceNumber = static_cast<quint32>(readLe(data, pos + 18, 4));
+    const int numLaces = static_cast<uchar>(data.at(pos + 26));
+    page.laces = data.mid(pos + 27, numLaces);
+    int dataSize = 0;
+    for (int i = 0; i < numLaces; ++i) {
+      dataSize += static_cast<uchar>(page.laces.at(i));
+    }
+    const int pageSize = 27 + numLaces + dataSize;
+    page.data = data.mid(pos + 27 + numLaces, dataSize);
+    QByteArray raw = data.mid(pos, pageSize);
+    const quint32 checksum = static_cast<quint32>(readLe(raw, 22, 4));
+    raw.replace(22, 4, le(0, 4));
+    page.checksumValid = raw.size() == pageSize &&
+        oggChecksum(raw) == checksum;
+    pages.append(page);
+    pos += pageSize;
+  }
+  return pages;
+}
+
+/**
+ * Get the packets of a logical stream.
+ * @param pages pages of file
+ * @param serialNumber serial number of stream
+ * @return complete packets.
+ */
+QList<QByteArray> oggPackets(const QList<Page>& pages, quint32 serialNumber)
+{
+  QList<QByteArray> packets;
+  QByteArray packet;
+  foreach (const Page& page, pages) {
+    if (page.serialNumber != serialNumber)
+      continue;
+    int dataPos = 0;
+    for (int i = 0; i < page.laces.size(); ++i) {
+      const int lace = static_cast<uchar>(page.laces.at(i));
+      packet.append(page.data.mid(dataPos, lace));
+      dataPos += lace;
+      if (lace < 255) {
+        packets.append(packet);
+        packet.clear();
+      }
+    }
+  }
+  return packets;
+}
+
+/**
+ * Create a Vorbis comment packet.
+ * @param comments comment fields
+ * @param padding number of zero bytes after the framing bit
+ * @return comment packet.
+ */
+QByteArray commentPacket(const QList<QByteArray>& comments, int padding = 0)
+{
+  const QByteArray vendor("Xiph.Org libVorbis I 20150105");
+  QByteArray packet = QByteArray("\x03vorbis", 7) + le(vendor.size(), 4) +
+      vendor + le(comments.size(), 4);
+  foreach (const QByteArray& comment, comments) {
+    packet += le(comment.size(), 4) + comment;
+  }
+  return packet + '\x01' + QByteArray(padding, '\0');
+}
+
+/**
+ * Create comment fields.
+ * @param count number of fields
+ * @param valueSize size of each value
+ * @return comment fields.
+ */
+QList<QByteArray> commentFields(int count, int valueSize)
+{
+  QList<QByteArray> comments;
+  for (int i = 0; i < count; ++i) {
+    comments.append("COMMENT" + QByteArray::number(i) + '=' +
+                    QByteArray(valueSize,
+                                          static_cast<char>('a' + i % 26)));
+  }
+  return comments;
+}
+
+/**
+ * Get the audio packets of the test files.
+ * @return audio packets.
+ */
+QList<QByteArray> audioPackets()
+{
+  QList<QByteArray> packets;
+  for (int i = 0; i < NumAudioPages * 2; ++i) {
+    QByteArray packet(100 + i * 37, '\0');
+    for (int j = 0; j < packet.size(); ++j) {
+      packet[j] = static_cast<char>(i + j * 3);
+    }
+    packets.append(packet);
+  }
+  return packets;
+}
+
+/**
+ * Create an Ogg/Vorbis file with all headers after the first in one page.
+ * @param comment comment packet
+ * @return file data.
+ */
+QByteArray oggVorbisFile(const QByteArray& comment)
+{
+  const QByteArray identification =
+      QByteArray("\x01vorbis", 7) + QByteArray(23, '\x02');
+  const QByteArray setup = QByteArray("\x05vorbis", 7) +
+      QByteArray(600, '\x05');
+  QByteArray data =
+      oggPage(0x02, VorbisSerial, 0, 0, QList<QByteArray>() << identification) +
+      oggPage(0, VorbisSerial, 1, 0, QList<QByteArray>() << comment << setup);
+  const QList<QByteArray> audio = audioPackets();
+  for (int i = 0; i < NumAudioPages; ++i) {
+    data += oggPage(i == NumAudioPages - 1 ? 0x04 : 0, VorbisSerial, 2 + i,
+                    (i + 1) * 1024,
+                    QList<QByteArray>() << audio.at(2 * i)
+                                        << audio.at(2 * i + 1));
+  }
+  return data;
+}
+
+/**
+ * Read a file.
+ * @param path path of file
+ * @return contents of file.
+ */
+QByteArray readFile(const QString& path)
+{
+  QFile file(path);
+  return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+/**
+ * Write a file.
+ * @param path path of file
+ * @param data contents of file
+ * @return true if ok.
+ */
+bool writeFile(const QString& path, const QByteArray& data)
+{
+  QFile file(path);
+  return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+/**
+ * Check that a comment packet contains the comments followed by padding.
+ * @param packet comment packet
+ * @param comments expected comment fields
+ * @return size of padding after the framing bit, -1 if the packet does not
+ *         match.
+ */
+int commentPadding(const QByteArray& packet,
+                   const QList<QByteArray>& comments)
+{
+  const QByteArray expected = commentPacket(comments);
+  if (!packet.startsWith(expected))
+    return -1;
+  const QByteArray padding = packet.mid(expected.size());
+  return padding.count('\0') == padding.size() ? padding.size() : -1;
+}
+
+}
+
+void TestOggCommentWriter::init()
+{
+  m_filePath = QDir::temp().filePath(QLatin1String("kid3_testogg.ogg"));
+  m_outPath = QDir::temp().filePath(QLatin1String("kid3_testogg_out.ogg"));
+}
+
+void TestOggCommentWriter::cleanup()
+{
+  QFile::remove(m_filePath);
+  QFile::remove(m_outPath);
+}
+
+void TestOggCommentWriter::testWriteInPlace_data()
+{
+  QTest::addColumn<int>("oldCount");
+  QTest::addColumn<int>("oldPadding");
+  QTest::addColumn<int>("newCount");
+  QTest::addColumn<bool>("inPlace");
+
+  QTest::newRow("shrink") << 10 << 0 << 2 << true;
+  QTest::newRow("grow") << 2 << 1000 << 10 << true;
+  QTest::newRow("unchanged") << 4 << 0 << 4 << true;
+  QTest::newRow("toolarge") << 2 << 10 << 10 << false;
+}
+
+void TestOggCommentWriter::testWriteInPlace()
+{
+  QFETCH(int, oldCount);
+  QFETCH(int, oldPadding);
+  QFETCH(int, newCount);
+  QFETCH(bool, inPlace);
+
+  const QByteArray oldData = oggVorbisFile(
+        commentPacket(commentFields(oldCount, 50), oldPadding));
+  QVERIFY(writeFile(m_filePath, oldData));
+  const QList<Page> oldPages = oggPages(oldData);
+
+  const QList<QByteArray> comments = commentFields(newCount, 50);
+  OggCommentWriter writer(comments, 0, false);
+  QFile file(m_filePath);
+  QVERIFY(file.open(QIODevice::ReadWrite));
+  QCOMPARE(writer.writeInPlace(file),
+           inPlace ? OggCommentWriter::WrittenInPlace
+                   : OggCommentWriter::NotHandled);
+  file.close();
+
+  const QByteArray data = readFile(m_filePath);
+  if (!inPlace) {
+    QCOMPARE(data, oldData);
+    return;
+  }
+  QCOMPARE(data.size(), oldData.size());
+  const QList<Page> pages = oggPages(data);
+  QCOMPARE(pages.size(), oldPages.size());
+  for (int i = 0; i < pages.size(); ++i) {
+    QVERIFY(pages.at(i).checksumValid);
+    QCOMPARE(pages.at(i).sequenceNumber, oldPages.at(i).sequenceNumber);
+    QCOMPARE(pages.at(i).granulePosition, oldPages.at(i).granulePosition);
+    QCOMPARE(pages.at(i).flags, oldPages.at(i).flags);
+  }
+  // The space not used by the comments is filled with zeros after the
+  // framing bit, the other packets are unchanged.
+  const QList<QByteArray> packets = oggPackets(pages, VorbisSerial);
+  const QList<QByteArray> oldPackets = oggPackets(oldPages, VorbisSerial);
+  QCOMPARE(packets.size(), oldPackets.size());
+  QCOMPARE(commentPadding(packets.at(1), comments),
+           oldPackets.at(1).size() - commentPacket(comments).size());
+  QCOMPARE(packets.mid(2), oldPackets.mid(2));
+  QCOMPARE(packets.at(0), oldPackets.at(0));
+}
+
+void TestOggCommentWriter::testCopy_data()
+{
+  QTest::addColumn<int>("newCount");
+  QTest::addColumn<int>("valueSize");
+  QTest::addColumn<int>("paddingSize");
+  QTest::addColumn<int>("numHeaderPages");
+
+  QTest::newRow("samepages") << 20 << 50 << 1024 << 1;
+  // More than 255 lacing values do not fit into one page.
+  QTest::newRow("renumbered") << 300 << 300 << 0 << 2;
+}
+
+void TestOggCommentWriter::testCopy()
+{
+  QFETCH(int, newCount);
+  QFETCH(int, valueSize);
+  QFETCH(int, paddingSize);
+  QFETCH(int, numHeaderPages);
+
+  const QByteArray oldData = oggVorbisFile(
+        commentPacket(commentFields(2, 50)));
+  QVERIFY(writeFile(m_filePath, oldData));
+  const QList<Page> oldPages = oggPages(oldData);
+
+  const QList<QByteArray> comments = commentFields(newCount, valueSize);
+  OggCommentWriter writer(comments, paddingSize, false);
+  QFile in(m_filePath);
+  QFile out(m_outPath);
+  QVERIFY(in.open(QIODevice::ReadOnly));
+  QVERIFY(out.open(QIODevice::WriteOnly));
+  QCOMPARE(writer.copy(in, out), OggCommentWriter::Rewritten);
+  in.close();
+  out.close();
+
+  const QList<Page> pages = oggPages(readFile(m_outPath));
+  const int pageDelta = numHeaderPages - 1;
+  QCOMPARE(pages.size(), oldPages.size() + pageDelta);
+  for (int i = 0; i < pages.size(); ++i) {
+    QVERIFY(pages.at(i).checksumValid);
+    QCOMPARE(pages.at(i).serialNumber, VorbisSerial);
+    QCOMPARE(pages.at(i).sequenceNumber, static_cast<quint32>(i));
+  }
+  for (int i = 2; i < oldPages.size(); ++i) {
+    QCOMPARE(pages.at(i + pageDelta).data, oldPages.at(i).data);
+    QCOMPARE(pages.at(i + pageDelta).granulePosition,
+             oldPages.at(i).granulePosition);
+  }
+  QVERIFY(pages.last().flags & 0x04);
+
+  const QList<QByteArray> packets = oggPackets(pages, VorbisSerial);
+  const QList<QByteArray> oldPackets = oggPackets(oldPages, VorbisSerial);
+  QCOMPARE(packets.size(), oldPackets.size());
+  QCOMPARE(commentPadding(packets.at(1), comments), paddingSize);
+  QCOMPARE(packets.at(0), oldPackets.at(0));
+  QCOMPARE(packets.mid(2), oldPackets.mid(2));
+}
+
+void TestOggCommentWriter::testMultiplexedStreams()
+{
+  // The beginning of stream pages of all streams come first, so the
+  // headers of the Vorbis stream are interleaved with another stream.
+  // Such files are left to vcedit.
+  const QByteArray identification =
+      QByteArray("\x01vorbis", 7) + QByteArray(23, '\x02');
+  const QByteArray oldData =
+      oggPage(0x02, VorbisSerial, 0, 0, QList<QByteArray>() << identification) +
+      oggPage(0x02, OtherSerial, 0, 0,
+              QList<QByteArray>() << QByteArray("\x80theora", 7)) +
+      oggPage(0, VorbisSerial, 1, 0,
+              QList<QByteArray>() << commentPacket(commentFields(2, 50))
+                                  << QByteArray("\x05vorbis", 7));
+  QVERIFY(writeFile(m_filePath, oldData));
+
+  OggCommentWriter writer(commentFields(1, 10), 0, false);
+  QFile file(m_filePath);
+  QVERIFY(file.open(QIODevice::ReadWrite));
+  QCOMPARE(writer.writeInPlace(file), OggCommentWriter::NotHandled);
+  QFile out(m_outPath);
+  QVERIFY(out.open(QIODevice::WriteOnly));
+  QCOMPARE(writer.copy(file, out), OggCommentWriter::NotHandled);
+  file.close();
+  out.close();
+  QCOMPARE(readFile(m_filePath), oldData);
+  QVERIFY(readFile(m_outPath).isEmpty());
+}
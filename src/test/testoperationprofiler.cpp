@@ -0,0 +1,196 @@
+/**
+ * \file testoperationprofiler.cpp
+ * Test operation profiler.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testoperationprofiler.h"
+#include <QDir>
+#include <QFile>
+#include <QThread>
+#include "operationprofiler.h"
+#include "jsonparser.h"
+
+namespace {
+
+/**
+ * Find the statistics of an operation.
+ * @param stats statistics from OperationProfiler::toVariantMap()
+ * @param operation name of operation
+ * @param category category
+ * @return map with statistics of operation, empty if not found.
+ */
+QVariantMap findOperation(const QVariantMap& stats, const QString& operation,
+                          const QString& category = QString())
+{
+  foreach (const QVariant& var,
+           stats.value(QLatin1String("operations")).toList()) {
+    QVariantMap map = var.toMap();
+    if (map.value(QLatin1String("operation")).toString() == operation &&
+        map.value(QLatin1String("category")).toString() == category) {
+      return map;
+    }
+  }
+  return QVariantMap();
+}
+
+}
+
+void TestOperationProfiler::init()
+{
+  OperationProfiler::instance().reset();
+}
+
+void TestOperationProfiler::cleanup()
+{
+  OperationProfiler::instance().setEnabled(false);
+  OperationProfiler::instance().reset();
+}
+
+void TestOperationProfiler::testDisabled()
+{
+  OperationProfiler& profiler = OperationProfiler::instance();
+  profiler.setEnabled(false);
+  QVERIFY(!OperationProfiler::isEnabled());
+  {
+    OperationProfiler::Scope scope("disabled");
+    QVERIFY(!scope.isActive());
+  }
+  OperationProfiler::count(OperationProfiler::FilesRead);
+  OperationProfiler::begin("disabledAsync");
+  OperationProfiler::end("disabledAsync");
+  QCOMPARE(profiler.counterValue(OperationProfiler::FilesRead), Q_INT64_C(0));
+  QVERIFY(profiler.toVariantMap().value(QLatin1String("operations"))
+          .toList().isEmpty());
+}
+
+void TestOperationProfiler::testCountersAndDurations()
+{
+  OperationProfiler& profiler = OperationProfiler::instance();
+  profiler.setEnabled(true);
+  OperationProfiler::count(OperationProfiler::FilesRead);
+  OperationProfiler::count(OperationProfiler::FileBytesRead, 1000);
+  OperationProfiler::count(OperationProfiler::FileBytesRead, 234);
+  for (int i = 0; i < 3; ++i) {
+    OperationProfiler::Scope scope("readTags");
+    QVERIFY(scope.isActive());
+    scope.setCategory(QLatin1String("TaglibMetadata"));
+    QTest::qSleep(2);
+  }
+  {
+    OperationProfiler::Scope scope("saveDirectory");
+  }
+  QCOMPARE(profiler.counterValue(OperationProfiler::FilesRead), Q_INT64_C(1));
+  QCOMPARE(profiler.counterValue(OperationProfiler::FileBytesRead),
+           Q_INT64_C(1234));
+
+  QVariantMap stats = profiler.toVariantMap();
+  QVERIFY(stats.value(QLatin1String("enabled")).toBool());
+  QCOMPARE(stats.value(QLatin1String("counters")).toMap()
+           .value(QLatin1String("fileBytesRead")).toLongLong(),
+           Q_INT64_C(1234));
+  QVariantMap readTags = findOperation(stats, QLatin1String("readTags"),
+                                       QLatin1String("TaglibMetadata"));
+  QCOMPARE(readTags.value(QLatin1String("count")).toInt(), 3);
+  const double minMs = readTags.value(QLatin1String("minMs")).toDouble();
+  const double maxMs = readTags.value(QLatin1String("maxMs")).toDouble();
+  const double p50Ms = readTags.value(QLatin1String("p50Ms")).toDouble();
+  QVERIFY(minMs >= 1.0);
+  QVERIFY(minMs <= maxMs);
+  QVERIFY(p50Ms >= minMs && p50Ms <= maxMs);
+  QVERIFY(readTags.value(QLatin1String("totalMs")).toDouble() >= 3 * minMs);
+  int histogramCount = 0;
+  foreach (const QVariant& bucket,
+           readTags.value(QLatin1String("histogram")).toList()) {
+    histogramCount += bucket.toInt();
+  }
+  QCOMPARE(histogramCount, 3);
+  QCOMPARE(findOperation(stats, QLatin1String("saveDirectory"))
+           .value(QLatin1String("count")).toInt(), 1);
+
+  const QString text = profiler.toText();
+  QVERIFY(text.contains(QLatin1String("fileBytesRead")));
+  QVERIFY(text.contains(QLatin1String("TaglibMetadata")));
+
+  // Data is kept when disabled and cleared by reset().
+  profiler.setEnabled(false);
+  QCOMPARE(profiler.counterValue(OperationProfiler::FilesRead), Q_INT64_C(1));
+  profiler.reset();
+  QCOMPARE(profiler.counterValue(OperationProfiler::FilesRead), Q_INT64_C(0));
+  QVERIFY(profiler.toVariantMap().value(QLatin1String("operations"))
+          .toList().isEmpty());
+}
+
+void TestOperationProfiler::testAsynchronousOperations()
+{
+  OperationProfiler& profiler = OperationProfiler::instance();
+  profiler.setEnabled(true);
+  OperationProfiler::end("notStarted");
+  OperationProfiler::begin("openDirectory");
+  OperationProfiler::begin("applyFilter");
+  OperationProfiler::end("openDirectory");
+  OperationProfiler::end("openDirectory");
+  QVariantMap stats = profiler.toVariantMap();
+  QCOMPARE(findOperation(stats, QLatin1String("openDirectory"))
+           .value(QLatin1String("count")).toInt(), 1);
+  QVERIFY(findOperation(stats, QLatin1String("applyFilter")).isEmpty());
+  QVERIFY(findOperation(stats, QLatin1String("notStarted")).isEmpty());
+}
+
+void TestOperationProfiler::testChromeTrace()
+{
+  OperationProfiler& profiler = OperationProfiler::instance();
+  profiler.setEnabled(true);
+  {
+    OperationProfiler::Scope scope("writeTags");
+    scope.setCategory(QLatin1String("Quoted \"plugin\""));
+  }
+  OperationProfiler::count(OperationProfiler::HttpRequests, 2);
+
+  const QString path = QDir::temp().filePath(
+        QLatin1String("kid3_testoperationprofiler.json"));
+  QVERIFY(profiler.writeChromeTrace(path));
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  const QString str = QString::fromUtf8(file.readAll());
+  file.close();
+  QFile::remove(path);
+
+  bool ok;
+  QVariantMap trace = JsonParser::deserialize(str, &ok).toMap();
+  QVERIFY(ok);
+  QVariantList events = trace.value(QLatin1String("traceEvents")).toList();
+  QCOMPARE(events.size(), 2);
+  QVariantMap event = events.at(0).toMap();
+  QCOMPARE(event.value(QLatin1String("name")).toString(),
+           QString(QLatin1String("writeTags")));
+  QCOMPARE(event.value(QLatin1String("cat")).toString(),
+           QString(QLatin1String("Quoted \"plugin\"")));
+  QCOMPARE(event.value(QLatin1String("ph")).toString(),
+           QString(QLatin1String("X")));
+  QVariantMap counters = events.at(1).toMap();
+  QCOMPARE(counters.value(QLatin1String("ph")).toString(),
+           QString(QLatin1String("C")));
+  QCOMPARE(counters.value(QLatin1String("args")).toMap()
+           .value(QLatin1String("httpRequests")).toInt(), 2);
+}
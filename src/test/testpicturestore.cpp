@@ -0,0 +1,159 @@
+/**
+ * \file testpicturestore.cpp
+ * Test shared storage for picture data.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testpicturestore.h"
+#include "picturestore.h"
+
+namespace {
+
+/** Size of pictures large enough to be shared. */
+const int PictureSize = 64 * 1024;
+
+/**
+ * Create picture data with a new buffer.
+ * @param fill byte used to fill the data
+ * @param size size of the data
+ * @return picture data.
+ */
+QByteArray createPicture(char fill, int size = PictureSize)
+{
+  return QByteArray(size, fill);
+}
+
+}
+
+void TestPictureStore::initTestCase()
+{
+  // Start without unused pictures from other tests.
+  PictureStore::instance().purge();
+}
+
+void TestPictureStore::testInternIdentical()
+{
+  PictureStore& store = PictureStore::instance();
+  const int count = store.count();
+  const qint64 totalSize = store.totalSize();
+  const quint64 sharedCount = store.sharedCount();
+
+  QByteArray first = createPicture('a');
+  QByteArray second = createPicture('a');
+  QVERIFY(first.constData() != second.constData());
+
+  QByteArray internedFirst = store.intern(first);
+  QByteArray internedSecond = store.intern(second);
+  QVERIFY(internedFirst.constData() == first.constData());
+  QVERIFY(internedSecond.constData() == first.constData());
+  QCOMPARE(internedSecond, second);
+  QCOMPARE(store.count(), count + 1);
+  QCOMPARE(store.totalSize(), totalSize + PictureSize);
+  QCOMPARE(store.sharedCount(), sharedCount + 1);
+
+  // Interning already shared data does not store it again.
+  QVERIFY(store.intern(internedSecond).constData() == first.constData());
+  QCOMPARE(store.count(), count + 1);
+  QCOMPARE(store.sharedCount(), sharedCount + 2);
+}
+
+void TestPictureStore::testInternDistinct()
+{
+  PictureStore& store = PictureStore::instance();
+  store.purge();
+  const int count = store.count();
+  const quint64 sharedCount = store.sharedCount();
+
+  QByteArray first = store.intern(createPicture('b'));
+  QByteArray second = store.intern(createPicture('c'));
+  QByteArray third = createPicture('b');
+  third[PictureSize - 1] = 'c';
+  third = store.intern(third);
+  QVERIFY(first.constData() != second.constData());
+  QVERIFY(first.constData() != third.constData());
+  QVERIFY(second.constData() != third.constData());
+  QCOMPARE(first, createPicture('b'));
+  QCOMPARE(second, createPicture('c'));
+  QCOMPARE(store.count(), count + 3);
+  QCOMPARE(store.sharedCount(), sharedCount);
+}
+
+void TestPictureStore::testInternSmall()
+{
+  PictureStore& store = PictureStore::instance();
+  const int count = store.count();
+
+  QByteArray first = createPicture('d', 16);
+  QByteArray second = createPicture('d', 16);
+  QVERIFY(store.intern(first).constData() == first.constData());
+  QVERIFY(store.intern(second).constData() == second.constData());
+  QCOMPARE(store.count(), count);
+}
+
+void TestPictureStore::testPurge()
+{
+  PictureStore& store = PictureStore::instance();
+  store.purge();
+  const int count = store.count();
+  const qint64 totalSize = store.totalSize();
+
+  QByteArray used = store.intern(createPicture('e'));
+  QByteArray unused = store.intern(createPicture('f'));
+  QByteArray copyOfUnused = unused;
+  QCOMPARE(store.count(), count + 2);
+
+  // Data still referenced outside the store is kept.
+  unused = QByteArray();
+  store.purge();
+  QCOMPARE(store.count(), count + 2);
+
+  // Only data referenced by the store alone is dropped.
+  copyOfUnused = QByteArray();
+  store.purge();
+  QCOMPARE(store.count(), count + 1);
+  QCOMPARE(store.totalSize(), totalSize + PictureSize);
+  QVERIFY(store.intern(createPicture('e')).constData() == used.constData());
+
+  used = QByteArray();
+  store.purge();
+  QCOMPARE(store.count(), count);
+  QCOMPARE(store.totalSize(), totalSize);
+}
+
+void TestPictureStore::testPurgeLargePictures()
+{
+  PictureStore& store = PictureStore::instance();
+  store.purge();
+  const qint64 totalSize = store.totalSize();
+
+  // Few large pictures, which are no longer used, must not accumulate
+  // until the number of pictures triggers a purge.
+  const int size = 1024 * 1024;
+  const int numPictures = 48;
+  for (int i = 0; i < numPictures; ++i) {
+    store.intern(createPicture(static_cast<char>('A' + i), size));
+  }
+  QVERIFY(store.totalSize() - totalSize < numPictures / 2 * size);
+  store.purge();
+  QCOMPARE(store.totalSize(), totalSize);
+}
@@ -0,0 +1,551 @@
+/**
+ * \file testtagcache.cpp
+ * Test persistent cache with the tags of files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testtagcache.h"
+#include <QDir>
+#include <QFile>
+#include "tagcache.h"
+#include "cachedtaggedfile.h"
+
+namespace {
+
+/**
+ * Remove a directory with all its contents.
+ * @param path path of directory
+ * @return true if ok.
+ */
+bool removeDirectory(const QString& path)
+{
+  QDir dir(path);
+  foreach (const QFileInfo& fi, dir.entryInfoList(
+             QDir::AllEntries | QDir::NoDotAndDotDot |
+             QDir::Hidden | QDir::System)) {
+    if (fi.isDir() && !fi.isSymLink()) {
+      if (!removeDirectory(fi.filePath()))
+        return false;
+    } else if (!QFile::remove(fi.filePath())) {
+      return false;
+    }
+  }
+  return QDir().rmdir(path);
+}
+
+/**
+ * Get picture data used for the tests.
+ * @return picture data.
+ */
+QByteArray pictureData()
+{
+  static const char data[] = "\x89PNG\r\n\x1a\n picture data";
+  return QByteArray(data, sizeof(data) - 1);
+}
+
+/**
+ * Detached tagged file with the contents of the file as its title and a
+ * picture, counting how often the file and its pictures are read.
+ */
+class PictureTaggedFile : public TaggedFile {
+public:
+  PictureTaggedFile(const QString& path, bool lazyPictures)
+    : TaggedFile(QPersistentModelIndex()),
+      numReads(0), numPictureReads(0),
+      m_lazyPictures(lazyPictures), m_tagsRead(false),
+      m_picturesRead(false) {
+    setDetachedFilePath(path);
+  }
+
+  virtual QString taggedFileKey() const {
+    return QLatin1String("PictureMetadata");
+  }
+
+  virtual void readTags(bool force) {
+    if (force || !m_tagsRead) {
+      ++numReads;
+      QFile file(currentFilePath());
+      m_title = file.open(QIODevice::ReadOnly)
+          ? QString::fromLatin1(file.readAll()) : QString();
+      m_tagsRead = true;
+      m_picturesRead = !m_lazyPictures;
+    }
+  }
+
+  virtual bool writeTags(bool, bool*, bool) { return false; }
+
+  virtual void clearTags(bool) { m_tagsRead = false; }
+
+  virtual bool isTagInformationRead() const { return m_tagsRead; }
+
+  virtual void getDetailInfo(DetailInfo& info) const {
+    info.valid = true;
+    info.format = QLatin1String("Picture Test");
+    info.duration = 42;
+  }
+
+  virtual unsigned getDuration() const { return 42; }
+
+  virtual QString getFileExtension() const {
+    return QLatin1String(".tst");
+  }
+
+  virtual bool hasTag(Frame::TagNumber tagNr) const {
+    return tagNr == Frame::Tag_2 && m_tagsRead;
+  }
+
+  virtual bool arePicturesRead() const { return m_picturesRead; }
+
+  virtual bool getFrame(Frame::TagNumber tagNr, Frame::Type type,
+                        Frame& frame) const {
+    if (tagNr != Frame::Tag_2 || type != Frame::FT_Title)
+      return false;
+
+    frame = Frame(type, m_title, QLatin1String("TITLE"), -1);
+    return true;
+  }
+
+  virtual bool setFrame(Frame::TagNumber, const Frame&) { return false; }
+
+  virtual QStringList getFrameIds(Frame::TagNumber) const {
+    return QStringList();
+  }
+
+  virtual void getAllFrames(Frame::TagNumber tagNr,
+                            FrameCollection& frames) {
+    TaggedFile::getAllFrames(tagNr, frames);
+    if (tagNr != Frame::Tag_2)
+      return;
+
+    if (!m_picturesRead) {
+      ++numPictureReads;
+      m_picturesRead = true;
+    }
+    Frame picture(Frame::FT_Picture, QLatin1String("Cover"),
+                  QLatin1String("PICTURE"), 0);
+    Frame::Field field;
+    field.m_id = Frame::ID_Description;
+    field.m_value = QLatin1String("Cover");
+    picture.fieldList().append(field);
+    field.m_id = Frame::ID_Data;
+    field.m_value = pictureData();
+    picture.fieldList().append(field);
+    frames.insert(picture);
+  }
+
+  int numReads;
+  int numPictureReads;
+
+private:
+  QString m_title;
+  bool m_lazyPictures;
+  bool m_tagsRead;
+  bool m_picturesRead;
+};
+
+/**
+ * Read a file and store it in a tag cache.
+ * @param cache tag cache
+ * @param path path to file
+ */
+void insertFile(TagCache& cache, const QString& path)
+{
+  PictureTaggedFile taggedFile(path, false);
+  taggedFile.readTags(false);
+  cache.insert(path, &taggedFile);
+}
+
+/**
+ * Get the title stored for a file.
+ * @param cache tag cache
+ * @param path path to file
+ * @return title, null if no valid entry exists.
+ */
+QString cachedTitle(TagCache& cache, const QString& path)
+{
+  TagCache::Entry entry;
+  if (!cache.find(path, entry))
+    return QString();
+
+  FrameCollection::const_iterator it =
+      entry.tags[Frame::Tag_2].standardFrames.findByType(Frame::FT_Title);
+  return it != entry.tags[Frame::Tag_2].standardFrames.end()
+      ? it->getValue() : QString(QLatin1String(""));
+}
+
+/**
+ * Get the data of the picture in a frame collection.
+ * @param frames frames
+ * @return picture data, null if no picture found.
+ */
+QByteArray pictureDataOf(const FrameCollection& frames)
+{
+  FrameCollection::const_iterator it = frames.findByType(Frame::FT_Picture);
+  if (it == frames.end())
+    return QByteArray();
+
+  foreach (const Frame::Field& field, it->getFieldList()) {
+    if (field.m_id == Frame::ID_Data) {
+      return field.m_value.toByteArray();
+    }
+  }
+  return QByteArray();
+}
+
+}
+
+void TestTagCache::init()
+{
+  m_dirPath = QDir::tempPath() + QLatin1String("/kid3_testtagcache");
+  removeDirectory(m_dirPath);
+  QVERIFY(QDir().mkpath(m_dirPath));
+  m_cachePath = filePath(QLatin1String("tagcache.bin"));
+}
+
+void TestTagCache::cleanup()
+{
+  removeDirectory(m_dirPath);
+}
+
+QString TestTagCache::filePath(const QString& fileName) const
+{
+  return m_dirPath + QLatin1Char('/') + fileName;
+}
+
+QString TestTagCache::createFile(const QString& fileName,
+                                 const QByteArray& contents)
+{
+  QString path = filePath(fileName);
+  QFile file(path);
+  if (file.open(QIODevice::WriteOnly)) {
+    file.write(contents);
+  }
+  return path;
+}
+
+void TestTagCache::testSaveAndLoad()
+{
+  const QString path1 = createFile(QLatin1String("1.tst"), "First");
+  const QString path2 = createFile(QLatin1String("2.tst"), "Second");
+  {
+    TagCache cache;
+    cache.setFilePath(m_cachePath);
+    cache.setSettingsFingerprint("settings");
+    QVERIFY(!cache.contains(path1));
+    insertFile(cache, path1);
+    insertFile(cache, path2);
+    QVERIFY(cache.isModified());
+    QVERIFY(cache.save());
+    QVERIFY(!cache.isModified());
+    QVERIFY(QFile::exists(m_cachePath));
+    QVERIFY(!QFile::exists(m_cachePath + QLatin1String(".tmp")));
+  }
+
+  TagCache cache;
+  cache.setFilePath(m_cachePath);
+  cache.setSettingsFingerprint("settings");
+  QCOMPARE(cache.size(), 2);
+  QVERIFY(cache.sizeInBytes() > 0);
+  QCOMPARE(cachedTitle(cache, path1), QString(QLatin1String("First")));
+  QCOMPARE(cachedTitle(cache, path2), QString(QLatin1String("Second")));
+
+  TagCache::Entry entry;
+  QVERIFY(cache.find(path1, entry));
+  QCOMPARE(entry.taggedFileKey, QString(QLatin1String("PictureMetadata")));
+  QCOMPARE(entry.fileExtension, QString(QLatin1String(".tst")));
+  QVERIFY(entry.detailInfoRead);
+  QCOMPARE(entry.duration, 42U);
+  QCOMPARE(entry.detailInfo.format, QString(QLatin1String("Picture Test")));
+  const TagCache::Entry::Tag& tag = entry.tags[Frame::Tag_2];
+  QVERIFY(tag.hasTag);
+  QVERIFY(tag.isSupported);
+  QVERIFY(tag.framesRead);
+  QVERIFY(!entry.tags[Frame::Tag_1].isSupported);
+
+  // Looking up entries does not require saving the cache.
+  QVERIFY(!cache.isModified());
+}
+
+void TestTagCache::testFileChanged()
+{
+  const QString path = createFile(QLatin1String("1.tst"), "Title");
+  TagCache cache;
+  cache.setFilePath(m_cachePath);
+  insertFile(cache, path);
+  QVERIFY(cache.contains(path));
+  QVERIFY(cache.save());
+
+  // Changed size
+  createFile(QLatin1String("1.tst"), "Longer title");
+  QVERIFY(!cache.contains(path));
+  // The outdated entry is removed.
+  QCOMPARE(cache.size(), 0);
+  QVERIFY(cache.isModified());
+
+  // Changed modification time, same size, the sleep is needed for file
+  // systems with a resolution of a second.
+  insertFile(cache, path);
+  QVERIFY(cache.contains(path));
+  QTest::qSleep(1100);
+  createFile(QLatin1String("1.tst"), "Longer TITLE");
+  QVERIFY(!cache.contains(path));
+
+  // Removed file
+  insertFile(cache, path);
+  QVERIFY(cache.contains(path));
+  QVERIFY(QFile::remove(path));
+  QVERIFY(!cache.contains(path));
+}
+
+void TestTagCache::testSettingsFingerprint()
+{
+  const QString path = createFile(QLatin1String("1.tst"), "Title");
+  {
+    TagCache cache;
+    cache.setFilePath(m_cachePath);
+    cache.setSettingsFingerprint("old settings");
+    insertFile(cache, path);
+    QVERIFY(cache.save());
+  }
+  {
+    // Entries of a file stored with other settings are not used.
+    TagCache cache;
+    cache.setFilePath(m_cachePath);
+    cache.setSettingsFingerprint("new settings");
+    QVERIFY(!cache.contains(path));
+  }
+
+  // Changing the settings discards the loaded entries.
+  TagCache cache;
+  cache.setFilePath(m_cachePath);
+  cache.setSettingsFingerprint("old settings");
+  QVERIFY(cache.contains(path));
+  cache.setSettingsFingerprint("new settings");
+  QVERIFY(!cache.contains(path));
+  QCOMPARE(cache.getSettingsFingerprint(), QByteArray("new settings"));
+}
+
+void TestTagCache::testCorruptFile_data()
+{
+  QTest::addColumn<int>("truncateTo");
+  QTest::addColumn<int>("garbageAt");
+
+  QTest::newRow("empty") << 0 << -1;
+  QTest::newRow("magic") << 6 << -1;
+  QTest::newRow("header") << 30 << -1;
+  QTest::newRow("entry") << 100 << -1;
+  QTest::newRow("lastbyte") << -2 << -1;
+  QTest::newRow("badmagic") << -1 << 0;
+  QTest::newRow("badentry") << -1 << 40;
+}
+
+void TestTagCache::testCorruptFile()
+{
+  QFETCH(int, truncateTo);
+  QFETCH(int, garbageAt);
+
+  const QString path1 = createFile(QLatin1String("1.tst"), "First");
+  const QString path2 = createFile(QLatin1String("2.tst"), "Second");
+  {
+    TagCache cache;
+    cache.setFilePath(m_cachePath);
+    insertFile(cache, path1);
+    insertFile(cache, path2);
+    QVERIFY(cache.save());
+  }
+
+  QFile file(m_cachePath);
+  QVERIFY(file.open(QIODevice::ReadWrite));
+  QByteArray data = file.readAll();
+  if (truncateTo == -2) {
+    truncateTo = data.size() - 1;
+  }
+  if (truncateTo >= 0) {
+    QVERIFY(truncateTo < data.size());
+    QVERIFY(file.resize(truncateTo));
+  }
+  if (garbageAt >= 0) {
+    QVERIFY(file.seek(garbageAt));
+    file.write(QByteArray(16, '\xff'));
+  }
+  file.close();
+
+  // A corrupt cache file is ignored and replaced.
+  TagCache cache;
+  cache.setFilePath(m_cachePath);
+  QVERIFY(!cache.contains(path1));
+  QVERIFY(!cache.contains(path2));
+  insertFile(cache, path1);
+  QVERIFY(cache.save());
+
+  TagCache reloaded;
+  reloaded.setFilePath(m_cachePath);
+  QCOMPARE(cachedTitle(reloaded, path1), QString(QLatin1String("First")));
+  QVERIFY(!reloaded.contains(path2));
+}
+
+void TestTagCache::testEviction()
+{
+  QStringList paths;
+  for (int i = 0; i < 5; ++i) {
+    paths.append(createFile(QString::number(i) + QLatin1String(".tst"),
+                            QByteArray::number(i)));
+  }
+  TagCache cache;
+  cache.setFilePath(m_cachePath);
+  cache.setLimits(4, 1024 * 1024);
+  for (int i = 0; i < 4; ++i) {
+    insertFile(cache, paths.at(i));
+  }
+  QCOMPARE(cache.size(), 4);
+  QVERIFY(cache.contains(paths.at(0)));
+
+  // Exceeding the limit evicts the least recently used entries down to
+  // three quarters of the limit.
+  insertFile(cache, paths.at(4));
+  QCOMPARE(cache.size(), 3);
+  QVERIFY(cache.contains(paths.at(0)));
+  QVERIFY(!cache.contains(paths.at(1)));
+  QVERIFY(!cache.contains(paths.at(2)));
+  QVERIFY(cache.contains(paths.at(3)));
+  QVERIFY(cache.contains(paths.at(4)));
+
+  // The order of use is restored when loading.
+  QVERIFY(cache.contains(paths.at(3)));
+  QVERIFY(cache.save());
+  {
+    TagCache reloaded;
+    reloaded.setFilePath(m_cachePath);
+    reloaded.setLimits(2, 1024 * 1024);
+    QCOMPARE(reloaded.size(), 1);
+    QVERIFY(reloaded.contains(paths.at(3)));
+  }
+
+  // Limit of bytes
+  const qint64 bytes = cache.sizeInBytes();
+  QVERIFY(bytes > 0);
+  cache.setLimits(100, bytes - 1);
+  QVERIFY(cache.sizeInBytes() <= (bytes - 1) * 3 / 4);
+  QVERIFY(cache.size() < 3);
+}
+
+void TestTagCache::testPrune()
+{
+  const QString path1 = createFile(QLatin1String("1.tst"), "First");
+  const QString path2 = createFile(QLatin1String("2.tst"), "Second");
+  {
+    TagCache cache;
+    cache.setFilePath(m_cachePath);
+    insertFile(cache, path1);
+    insertFile(cache, path2);
+    QVERIFY(cache.save());
+  }
+  QVERIFY(QFile::remove(path2));
+  const QString path3 = createFile(QLatin1String("3.tst"), "Third");
+  {
+    // Entries of removed files are pruned when the cache is saved.
+    TagCache cache;
+    cache.setFilePath(m_cachePath);
+    QCOMPARE(cache.size(), 2);
+    insertFile(cache, path3);
+    QVERIFY(cache.save());
+    QCOMPARE(cache.size(), 2);
+  }
+  TagCache cache;
+  cache.setFilePath(m_cachePath);
+  QCOMPARE(cache.size(), 2);
+  QVERIFY(cache.contains(path1));
+  QVERIFY(cache.contains(path3));
+}
+
+void TestTagCache::testLazyPictures()
+{
+  const QString path = createFile(QLatin1String("1.tst"), "Title");
+  TagCache cache;
+  cache.setFilePath(m_cachePath);
+  PictureTaggedFile* taggedFile = new PictureTaggedFile(path, true);
+  taggedFile->readTags(false);
+  cache.insert(path, taggedFile);
+  // Storing the entry does not read the pictures.
+  QCOMPARE(taggedFile->numPictureReads, 0);
+  delete taggedFile;
+
+  TagCache::Entry entry;
+  QVERIFY(cache.find(path, entry));
+  QVERIFY(!entry.tags[Frame::Tag_2].framesRead);
+
+  taggedFile = new PictureTaggedFile(path, true);
+  CachedTaggedFile cachedFile(QPersistentModelIndex(), taggedFile, entry);
+  cachedFile.setDetachedFilePath(path);
+  Frame frame;
+  QVERIFY(cachedFile.getFrame(Frame::Tag_2, Frame::FT_Title, frame));
+  QCOMPARE(frame.getValue(), QString(QLatin1String("Title")));
+  QVERIFY(!cachedFile.arePicturesRead());
+  QVERIFY(cachedFile.isCached());
+  QCOMPARE(taggedFile->numReads, 0);
+
+  // The file is only parsed when all frames are requested.
+  FrameCollection frames;
+  cachedFile.getAllFrames(Frame::Tag_2, frames);
+  QVERIFY(!cachedFile.isCached());
+  QCOMPARE(taggedFile->numReads, 1);
+  QCOMPARE(taggedFile->numPictureReads, 1);
+  QCOMPARE(pictureDataOf(frames), pictureData());
+  cachedFile.getAllFrames(Frame::Tag_2, frames);
+  QCOMPARE(taggedFile->numReads, 1);
+  QCOMPARE(taggedFile->numPictureReads, 1);
+}
+
+void TestTagCache::testOmittedPictureData()
+{
+  const QString path = createFile(QLatin1String("1.tst"), "Title");
+  {
+    TagCache cache;
+    cache.setFilePath(m_cachePath);
+    insertFile(cache, path);
+    QVERIFY(cache.save());
+  }
+
+  // The picture is stored as a placeholder without its data.
+  TagCache cache;
+  cache.setFilePath(m_cachePath);
+  TagCache::Entry entry;
+  QVERIFY(cache.find(path, entry));
+  const TagCache::Entry::Tag& tag = entry.tags[Frame::Tag_2];
+  QVERIFY(tag.framesRead);
+  QVERIFY(tag.binaryOmitted);
+  QVERIFY(tag.frames.findByType(Frame::FT_Picture) != tag.frames.end());
+  QVERIFY(pictureDataOf(tag.frames).isEmpty());
+  QVERIFY(cache.sizeInBytes() < 1024);
+
+  PictureTaggedFile* taggedFile = new PictureTaggedFile(path, false);
+  CachedTaggedFile cachedFile(QPersistentModelIndex(), taggedFile, entry);
+  cachedFile.setDetachedFilePath(path);
+  Frame frame;
+  QVERIFY(cachedFile.getFrame(Frame::Tag_2, Frame::FT_Title, frame));
+  QCOMPARE(taggedFile->numReads, 0);
+  FrameCollection frames;
+  cachedFile.getAllFrames(Frame::Tag_2, frames);
+  QCOMPARE(taggedFile->numReads, 1);
+  QCOMPARE(pictureDataOf(frames), pictureData());
+}
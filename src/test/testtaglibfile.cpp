@@ -0,0 +1,294 @@
+/**
+ * \file testtaglibfile.cpp
+ * Test reading tags, audio properties and pictures with TagLib.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testtaglibfile.h"
+#include <QDir>
+#include <QFile>
+#include <QPersistentModelIndex>
+#include "taglibfile.h"
+#include "configstore.h"
+#include "dummysettings.h"
+
+namespace {
+
+/** Number of MPEG frames in the MP3 test file. */
+const int NumMpegFrames = 20;
+
+/** Size of an MPEG 1 layer 3 frame with 128 kbps and 44100 Hz. */
+const int MpegFrameSize = 417;
+
+/**
+ * Get big endian bytes of an integer.
+ * @param value integer value
+ * @param size number of bytes
+ * @param synchsafe true to use only the 7 lower bits of each byte
+ * @return bytes.
+ */
+QByteArray be(quint64 value, int size, bool synchsafe = false)
+{
+  QByteArray bytes(size, '\0');
+  for (int i = size - 1; i >= 0; --i) {
+    bytes[i] = static_cast<char>(value & (synchsafe ? 0x7f : 0xff));
+    value >>= synchsafe ? 7 : 8;
+  }
+  return bytes;
+}
+
+/**
+ * Get little endian bytes of a 32 bit integer.
+ * @param value integer value
+ * @return bytes.
+ */
+QByteArray le32(quint32 value)
+{
+  QByteArray bytes;
+  for (int i = 0; i < 4; ++i) {
+    bytes.append(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+  return bytes;
+}
+
+/**
+ * Create an MP3 file with an ID3v2.4 tag containing a title followed by
+ * constant bitrate MPEG frames.
+ * @param title title
+ * @return file data.
+ */
+QByteArray mp3FileData(const QByteArray& title)
+{
+  const QByteArray frame = "TIT2" + be(title.size() + 1, 4, true) +
+      QByteArray(2, '\0') + '\x03' + title;
+  QByteArray data = QByteArray("ID3\x04\x00\x00", 6) +
+      be(frame.size(), 4, true) + frame;
+  // MPEG 1 layer 3, 128 kbps, 44100 Hz, stereo
+  QByteArray mpegFrame(MpegFrameSize, '\0');
+  mpegFrame[0] = '\xff';
+  mpegFrame[1] = '\xfb';
+  mpegFrame[2] = '\x90';
+  mpegFrame[3] = '\x04';
+  for (int i = 0; i < NumMpegFrames; ++i) {
+    data += mpegFrame;
+  }
+  return data;
+}
+
+/**
+ * Create a FLAC metadata block.
+ * @param type block type
+ * @param data block data
+ * @param isLast true if this is the last metadata block
+ * @return block.
+ */
+QByteArray flacBlock(int type, const QByteArray& data, bool isLast = false)
+{
+  return static_cast<char>((isLast ? 0x80 : 0) | type) +
+      be(data.size(), 3) + data;
+}
+
+/**
+ * Create a FLAC file with a title in the Vorbis comment and a picture.
+ * @param title title in Vorbis comment
+ * @param picture picture data
+ * @return file data.
+ */
+QByteArray flacFileData(const QByteArray& title, const QByteArray& picture)
+{
+  // 4096 samples per block, 44100 Hz, 2 channels, 16 bits
+  const QByteArray streamInfo = be(4096, 2) + be(4096, 2) +
+      QByteArray(6, '\0') +
+      be((Q_UINT64_C(44100) << 44) | (Q_UINT64_C(1) << 41) |
+         (Q_UINT64_C(15) << 36), 8) + QByteArray(16, '\0');
+  const QByteArray vendor("reference libFLAC 1.3.1 20141125");
+  const QByteArray field = "TITLE=" + title;
+  const QByteArray comment = le32(vendor.size()) + vendor + le32(1) +
+      le32(field.size()) + field;
+  const QByteArray mimeType("image/png");
+  const QByteArray description("Cover");
+  const QByteArray pictureBlock = be(3, 4) +
+      be(mimeType.size(), 4) + mimeType +
+      be(description.size(), 4) + description +
+      be(1, 4) + be(1, 4) + be(24, 4) + be(0, 4) +
+      be(picture.size(), 4) + picture;
+  return QByteArray("fLaC", 4) + flacBlock(0, streamInfo) +
+      flacBlock(4, comment) + flacBlock(6, pictureBlock, true) +
+      QByteArray(1000, '\0');
+}
+
+/**
+ * Write a file.
+ * @param path path of file
+ * @param data contents of file
+ * @return true if ok.
+ */
+bool writeFile(const QString& path, const QByteArray& data)
+{
+  QFile file(path);
+  return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+/**
+ * Get the title of a tag.
+ * @param taggedFile tagged file
+ * @param tagNr tag number
+ * @return title.
+ */
+QString title(const TaggedFile& taggedFile, Frame::TagNumber tagNr)
+{
+  Frame frame;
+  return taggedFile.getFrame(tagNr, Frame::FT_Title, frame)
+      ? frame.getValue() : QString();
+}
+
+/**
+ * Count the pictures in a tag.
+ * @param taggedFile tagged file
+ * @param tagNr tag number
+ * @return number of picture frames.
+ */
+int numPictures(TaggedFile& taggedFile, Frame::TagNumber tagNr)
+{
+  FrameCollection frames;
+  taggedFile.getAllFrames(tagNr, frames);
+  int count = 0;
+  for (FrameCollection::const_iterator it = frames.begin();
+       it != frames.end();
+       ++it) {
+    if (it->getType() == Frame::FT_Picture) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+}
+
+
+TestTagLibFile::TestTagLibFile(QObject* parent) : QObject(parent),
+  m_settings(0), m_configStore(0)
+{
+  if (!ConfigStore::instance()) {
+    m_settings = new DummySettings;
+    m_configStore = new ConfigStore(m_settings);
+  }
+}
+
+TestTagLibFile::~TestTagLibFile()
+{
+  delete m_configStore;
+  delete m_settings;
+}
+
+void TestTagLibFile::init()
+{
+  m_filePath = QDir::temp().filePath(QLatin1String("kid3_testtaglibfile"));
+}
+
+void TestTagLibFile::cleanup()
+{
+  QFile::remove(m_filePath + QLatin1String(".mp3"));
+  QFile::remove(m_filePath + QLatin1String(".flac"));
+}
+
+void TestTagLibFile::testMpegAudioProperties()
+{
+  const QString path = m_filePath + QLatin1String(".mp3");
+  QVERIFY(writeFile(path, mp3FileData("Title")));
+
+  TagLibFile taggedFile((QPersistentModelIndex()));
+  taggedFile.setDetachedFilePath(path);
+  QVERIFY(!taggedFile.isTagInformationRead());
+  taggedFile.readTags(false);
+  QVERIFY(taggedFile.isTagInformationRead());
+  QCOMPARE(title(taggedFile, Frame::Tag_2), QString(QLatin1String("Title")));
+#if TAGLIB_VERSION >= 0x010800
+  // The audio properties of MPEG files are only read on demand.
+  QVERIFY(!taggedFile.isDetailInfoRead());
+#endif
+
+  // Modify the tag in memory, reading the tags again and the audio
+  // properties must not parse the file again and lose the modification.
+  Frame frame;
+  QVERIFY(taggedFile.getFrame(Frame::Tag_2, Frame::FT_Title, frame));
+  frame.setValue(QLatin1String("Changed"));
+  frame.setValueChanged();
+  QVERIFY(taggedFile.setFrame(Frame::Tag_2, frame));
+  taggedFile.readTags(false);
+  QCOMPARE(title(taggedFile, Frame::Tag_2),
+           QString(QLatin1String("Changed")));
+
+  TaggedFile::DetailInfo info;
+  taggedFile.getDetailInfo(info);
+  QVERIFY(taggedFile.isDetailInfoRead());
+  QVERIFY(info.valid);
+  QCOMPARE(info.bitrate, 128U);
+  QCOMPARE(info.sampleRate, 44100U);
+  QCOMPARE(info.channels, 2U);
+  QCOMPARE(title(taggedFile, Frame::Tag_2),
+           QString(QLatin1String("Changed")));
+
+  // Change the bitrate of the first frame to 192 kbps on disk, the audio
+  // properties are not read again.
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::ReadWrite));
+  const qint64 headerPos = file.size() - NumMpegFrames * MpegFrameSize;
+  QVERIFY(file.seek(headerPos + 2));
+  QCOMPARE(file.write("\xb0", 1), Q_INT64_C(1));
+  file.close();
+  taggedFile.getDetailInfo(info);
+  QCOMPARE(info.bitrate, 128U);
+}
+
+void TestTagLibFile::testFlacPictures()
+{
+#if TAGLIB_VERSION >= 0x010700
+  const QString path = m_filePath + QLatin1String(".flac");
+  const QByteArray picture("\x89PNG\r\n\x1a\n picture data");
+  QVERIFY(writeFile(path, flacFileData("Title", picture)));
+
+  TagLibFile taggedFile((QPersistentModelIndex()));
+  taggedFile.setDetachedFilePath(path);
+  taggedFile.readTags(false);
+  QVERIFY(taggedFile.isTagInformationRead());
+  QCOMPARE(title(taggedFile, Frame::Tag_2), QString(QLatin1String("Title")));
+  // The audio properties of FLAC files are read together with the tags,
+  // the pictures only on demand.
+  QVERIFY(taggedFile.isDetailInfoRead());
+  QVERIFY(!taggedFile.arePicturesRead());
+
+  TaggedFile::DetailInfo info;
+  taggedFile.getDetailInfo(info);
+  QVERIFY(info.valid);
+  QCOMPARE(info.sampleRate, 44100U);
+  QVERIFY(!taggedFile.arePicturesRead());
+
+  // The pictures are converted to frames only once.
+  QCOMPARE(numPictures(taggedFile, Frame::Tag_2), 1);
+  QVERIFY(taggedFile.arePicturesRead());
+  QCOMPARE(numPictures(taggedFile, Frame::Tag_2), 1);
+  taggedFile.readTags(false);
+  QCOMPARE(numPictures(taggedFile, Frame::Tag_2), 1);
+#endif
+}
@@ -0,0 +1,339 @@
+/**
+ * \file testtaglibpaddingwriter.cpp
+ * Test writing tags into the padding with TagLib.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testtaglibpaddingwriter.h"
+#include <QDir>
+#include <QFile>
+#include "taglibfile.h"
+#include "taglibpaddingwriter.h"
+#include <mpegfile.h>
+#include <id3v2tag.h>
+#if TAGLIB_VERSION >= 0x010700
+#include <flacfile.h>
+#include <xiphcomment.h>
+#endif
+
+Q_DECLARE_METATYPE(TagLibPaddingWriter::Result)
+
+namespace {
+
+/** Size of the audio data in the test files. */
+const int AudioSize = 3000;
+
+/** FLAC metadata block of a test file. */
+struct FlacBlock {
+  int type;
+  bool isLast;
+  int length;
+};
+
+/**
+ * Get big endian bytes of an integer.
+ * @param value integer value
+ * @param size number of bytes
+ * @param synchsafe true to use only the 7 lower bits of each byte
+ * @return bytes.
+ */
+QByteArray be(quint64 value, int size, bool synchsafe = false)
+{
+  QByteArray bytes(size, '\0');
+  for (int i = size - 1; i >= 0; --i) {
+    bytes[i] = static_cast<char>(value & (synchsafe ? 0x7f : 0xff));
+    value >>= synchsafe ? 7 : 8;
+  }
+  return bytes;
+}
+
+/**
+ * Get little endian bytes of a 32 bit integer.
+ * @param value integer value
+ * @return bytes.
+ */
+QByteArray le32(quint32 value)
+{
+  QByteArray bytes;
+  for (int i = 0; i < 4; ++i) {
+    bytes.append(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+  return bytes;
+}
+
+/**
+ * Get audio data which does not contain MPEG frame syncs.
+ * @return audio data.
+ */
+QByteArray audioData()
+{
+  QByteArray audio(AudioSize, '\0');
+  for (int i = 0; i < audio.size(); ++i) {
+    audio[i] = static_cast<char>(i % 0xfe);
+  }
+  return audio;
+}
+
+/**
+ * Create an ID3v2.4 tag with a title.
+ * @param title title
+ * @param padding size of padding
+ * @return tag.
+ */
+QByteArray id3v2Tag(const QByteArray& title, int padding)
+{
+  const QByteArray frame = "TIT2" + be(title.size() + 1, 4, true) +
+      QByteArray(2, '\0') + '\x03' + title;
+  return QByteArray("ID3\x04\x00\x00", 6) +
+      be(frame.size() + padding, 4, true) + frame +
+      QByteArray(padding, '\0');
+}
+
+/**
+ * Create a FLAC metadata block.
+ * @param type block type
+ * @param data block data
+ * @param isLast true if this is the last metadata block
+ * @return block.
+ */
+QByteArray flacBlock(int type, const QByteArray& data, bool isLast = false)
+{
+  return static_cast<char>((isLast ? 0x80 : 0) | type) +
+      be(data.size(), 3) + data;
+}
+
+/**
+ * Create a FLAC file with padding split into two blocks.
+ * @param title title in Vorbis comment
+ * @return file data.
+ */
+QByteArray flacFileData(const QByteArray& title)
+{
+  // 4096 samples per block, 44100 Hz, 2 channels, 16 bits
+  const QByteArray streamInfo = be(4096, 2) + be(4096, 2) +
+      QByteArray(6, '\0') +
+      be((Q_UINT64_C(44100) << 44) | (Q_UINT64_C(1) << 41) |
+         (Q_UINT64_C(15) << 36), 8) + QByteArray(16, '\0');
+  const QByteArray vendor("reference libFLAC 1.3.1 20141125");
+  const QByteArray field = "TITLE=" + title;
+  const QByteArray comment = le32(vendor.size()) + vendor + le32(1) +
+      le32(field.size()) + field;
+  return QByteArray("fLaC", 4) + flacBlock(0, streamInfo) +
+      flacBlock(1, QByteArray(500, '\0')) +
+      flacBlock(4, comment) +
+      flacBlock(2, QByteArray("kid3") + QByteArray(20, 'a')) +
+      flacBlock(1, QByteArray(300, '\0'), true) + audioData();
+}
+
+/**
+ * Parse the metadata blocks of a FLAC file.
+ * @param data file data
+ * @param blocks the blocks are returned here
+ * @return position after the metadata, -1 if invalid.
+ */
+int flacBlocks(const QByteArray& data, QList<FlacBlock>& blocks)
+{
+  if (!data.startsWith("fLaC"))
+    return -1;
+  int pos = 4;
+  bool isLast = false;
+  while (!isLast && pos + 4 <= data.size()) {
+    FlacBlock block;
+    block.type = static_cast<uchar>(data.at(pos)) & 0x7f;
+    block.isLast = isLast = (static_cast<uchar>(data.at(pos)) & 0x80) != 0;
+    block.length = (static_cast<uchar>(data.at(pos + 1)) << 16) |
+        (static_cast<uchar>(data.at(pos + 2)) << 8) |
+        static_cast<uchar>(data.at(pos + 3));
+    blocks.append(block);
+    pos += 4 + block.length;
+  }
+  return isLast && pos <= data.size() ? pos : -1;
+}
+
+/**
+ * Read a file.
+ * @param path path of file
+ * @return contents of file.
+ */
+QByteArray readFile(const QString& path)
+{
+  QFile file(path);
+  return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+/**
+ * Write a file.
+ * @param path path of file
+ * @param data contents of file
+ * @return true if ok.
+ */
+bool writeFile(const QString& path, const QByteArray& data)
+{
+  QFile file(path);
+  return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+}
+
+void TestTagLibPaddingWriter::init()
+{
+  m_filePath = QDir::temp().filePath(QLatin1String("kid3_testpadding"));
+}
+
+void TestTagLibPaddingWriter::cleanup()
+{
+  QFile::remove(m_filePath);
+}
+
+void TestTagLibPaddingWriter::testWriteId3v2Tag_data()
+{
+  QTest::addColumn<int>("titleSize");
+  QTest::addColumn<int>("paddingSize");
+  QTest::addColumn<TagLibPaddingWriter::Result>("result");
+  QTest::addColumn<int>("tagSize");
+
+  // The old tag has 10 bytes header, 11 + 20 bytes TIT2 frame and 1000
+  // bytes padding.
+  QTest::newRow("shrink")
+      << 5 << 2048 << TagLibPaddingWriter::WrittenInPlace << 1041;
+  QTest::newRow("grow into padding")
+      << 900 << 2048 << TagLibPaddingWriter::WrittenInPlace << 1041;
+  QTest::newRow("grow")
+      << 2000 << 2048 << TagLibPaddingWriter::Rewritten << 4069;
+  QTest::newRow("taglib padding")
+      << 2000 << 0 << TagLibPaddingWriter::Rewritten << 3045;
+}
+
+void TestTagLibPaddingWriter::testWriteId3v2Tag()
+{
+  QFETCH(int, titleSize);
+  QFETCH(int, paddingSize);
+  QFETCH(TagLibPaddingWriter::Result, result);
+  QFETCH(int, tagSize);
+
+  const QByteArray audio = audioData();
+  QVERIFY(writeFile(m_filePath,
+                    id3v2Tag(QByteArray(20, 'o'), 1000) + audio));
+  const QByteArray fileName = QFile::encodeName(m_filePath);
+  const QByteArray title(titleSize, 'n');
+  {
+    TagLib::MPEG::File file(fileName.constData(), false);
+    TagLib::ID3v2::Tag* tag = file.ID3v2Tag();
+    QVERIFY(tag);
+    QCOMPARE(tag->title(), TagLib::String(QByteArray(20, 'o').constData()));
+    tag->setTitle(TagLib::String(title.constData()));
+#if TAGLIB_VERSION >= 0x010800
+    QCOMPARE(TagLibPaddingWriter(&file, paddingSize, false)
+             .writeId3v2Tag(tag, 4), result);
+#else
+    QCOMPARE(TagLibPaddingWriter(&file, paddingSize, false)
+             .writeId3v2Tag(tag, 4), TagLibPaddingWriter::NotHandled);
+    return;
+#endif
+  }
+
+  // The tag including its padding is followed by the unchanged audio data.
+  const QByteArray data = readFile(m_filePath);
+  QCOMPARE(data.size(), tagSize + AudioSize);
+  QVERIFY(data.startsWith(id3v2Tag(title, tagSize - 21 - titleSize)));
+  QVERIFY(data.mid(tagSize) == audio);
+
+  TagLib::MPEG::File file(fileName.constData(), false);
+  QVERIFY(file.ID3v2Tag());
+  QCOMPARE(file.ID3v2Tag()->title(), TagLib::String(title.constData()));
+}
+
+void TestTagLibPaddingWriter::testWriteFlacMetadata_data()
+{
+  QTest::addColumn<int>("titleSize");
+  QTest::addColumn<int>("paddingSize");
+  QTest::addColumn<TagLibPaddingWriter::Result>("result");
+  QTest::addColumn<int>("padding");
+
+  // The two padding blocks have 808 bytes including their headers.
+  QTest::newRow("shrink")
+      << 5 << 2048 << TagLibPaddingWriter::WrittenInPlace << 819;
+  QTest::newRow("grow into padding")
+      << 600 << 2048 << TagLibPaddingWriter::WrittenInPlace << 224;
+  QTest::newRow("fill padding")
+      << 828 << 2048 << TagLibPaddingWriter::WrittenInPlace << -1;
+  QTest::newRow("grow")
+      << 1000 << 2048 << TagLibPaddingWriter::Rewritten << 2048;
+  QTest::newRow("taglib padding")
+      << 1000 << 0 << TagLibPaddingWriter::Rewritten << 4096;
+}
+
+void TestTagLibPaddingWriter::testWriteFlacMetadata()
+{
+#if TAGLIB_VERSION >= 0x010700
+  QFETCH(int, titleSize);
+  QFETCH(int, paddingSize);
+  QFETCH(TagLibPaddingWriter::Result, result);
+  QFETCH(int, padding);
+
+  const QByteArray oldData = flacFileData(QByteArray(20, 'o'));
+  QList<FlacBlock> oldBlocks;
+  const int oldAudioStart = flacBlocks(oldData, oldBlocks);
+  QCOMPARE(oldAudioStart, oldData.size() - AudioSize);
+  QVERIFY(writeFile(m_filePath, oldData));
+  const QByteArray fileName = QFile::encodeName(m_filePath);
+  const QByteArray title(titleSize, 'n');
+  {
+    TagLib::FLAC::File file(fileName.constData(), false);
+    TagLib::Ogg::XiphComment* comment = file.xiphComment();
+    QVERIFY(comment);
+    QCOMPARE(comment->title(),
+             TagLib::String(QByteArray(20, 'o').constData()));
+    comment->setTitle(TagLib::String(title.constData()));
+    QCOMPARE(TagLibPaddingWriter(&file, paddingSize, false)
+             .writeFlacMetadata(&file), result);
+  }
+
+  // The other blocks are kept in front of the comment, the padding is
+  // merged into a single block at the end.
+  const QByteArray data = readFile(m_filePath);
+  QList<FlacBlock> blocks;
+  const int audioStart = flacBlocks(data, blocks);
+  QCOMPARE(audioStart, data.size() - AudioSize);
+  QVERIFY(data.mid(audioStart) == audioData());
+  QCOMPARE(blocks.size(), padding >= 0 ? 4 : 3);
+  QCOMPARE(blocks.at(0).type, 0);
+  QCOMPARE(blocks.at(1).type, 2);
+  QCOMPARE(blocks.at(2).type, 4);
+  QCOMPARE(blocks.at(2).length, oldBlocks.at(2).length + titleSize - 20);
+  if (padding >= 0) {
+    QCOMPARE(blocks.at(3).type, 1);
+    QCOMPARE(blocks.at(3).length, padding);
+  }
+  for (int i = 0; i < blocks.size(); ++i) {
+    QCOMPARE(blocks.at(i).isLast, i == blocks.size() - 1);
+  }
+  if (result == TagLibPaddingWriter::WrittenInPlace) {
+    QCOMPARE(data.size(), oldData.size());
+  }
+
+  TagLib::FLAC::File file(fileName.constData(), false);
+  QVERIFY(file.xiphComment());
+  QCOMPARE(file.xiphComment()->title(), TagLib::String(title.constData()));
+#endif
+}
@@ -0,0 +1,49 @@
+/**
+ * \file testtaglibpaddingwriter.h
+ * Test writing tags into the padding with TagLib.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTTAGLIBPADDINGWRITER_H
+#define TESTTAGLIBPADDINGWRITER_H
+
+#include <QTest>
+
+/**
+ * Test writing tags into the padding with TagLib.
+ */
+class TestTagLibPaddingWriter : public QObject {
+  Q_OBJECT
+private slots:
+  void init();
+  void cleanup();
+  void testWriteId3v2Tag_data();
+  void testWriteId3v2Tag();
+  void testWriteFlacMetadata_data();
+  void testWriteFlacMetadata();
+
+private:
+  QString m_filePath;
+};
+
+#endif
@@ -0,0 +1,228 @@
+/**
+ * \file testtagreaderpool.cpp
+ * Test reading tags in worker threads.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testtagreaderpool.h"
+#include <QDir>
+#include <QStringListModel>
+#include "tagreaderpool.h"
+#include "fileproxymodel.h"
+#include "taggedfile.h"
+#include "itaggedfilefactory.h"
+
+namespace {
+
+/** Number of existing FallbackTaggedFile instances. */
+QAtomicInt numFallbackFiles;
+
+/** Number of FallbackTaggedFile instances which read the last stage. */
+QAtomicInt numLastStageReads;
+
+/**
+ * Tagged file which requires both fallbacks of the tag reading.
+ * The file created first is an ID3v2.3 file with an ID3v2.2 tag, which is
+ * replaced by an ID3v2.4 file. This file has invalid Ogg detail
+ * information and is replaced by an Ogg FLAC file.
+ */
+class FallbackTaggedFile : public TaggedFile {
+public:
+  /** Stage of the tag reading at which the file is created. */
+  enum Stage { Id3v23, Id3v24, OggFlac };
+
+  FallbackTaggedFile(const QPersistentModelIndex& idx, Stage stage)
+    : TaggedFile(idx), m_stage(stage), m_fileRead(false) {
+    numFallbackFiles.ref();
+  }
+
+  virtual ~FallbackTaggedFile() {
+    numFallbackFiles.deref();
+  }
+
+  virtual QString taggedFileKey() const {
+    return QLatin1String("FallbackMetadata");
+  }
+
+  virtual int taggedFileFeatures() const {
+    return m_stage == Id3v23 ? TF_ID3v23 | TF_OggPictures
+         : m_stage == Id3v24 ? TF_ID3v24 | TF_OggPictures
+         : TF_OggFlac;
+  }
+
+  virtual void readTags(bool) {
+    m_fileRead = true;
+    if (m_stage == OggFlac) {
+      numLastStageReads.ref();
+    }
+  }
+
+  virtual bool writeTags(bool, bool* renamed, bool) {
+    *renamed = false;
+    return true;
+  }
+
+  virtual void clearTags(bool) { m_fileRead = false; }
+
+  virtual bool hasTag(Frame::TagNumber tagNr) const {
+    return m_fileRead && tagNr == Frame::Tag_Id3v2;
+  }
+
+  virtual bool isTagInformationRead() const { return m_fileRead; }
+
+  virtual QString getTagFormat(Frame::TagNumber tagNr) const {
+    return m_stage == Id3v23 && tagNr == Frame::Tag_Id3v2
+        ? QLatin1String("ID3v2.2.0") : QString();
+  }
+
+  virtual void getDetailInfo(DetailInfo& info) const {
+    info.valid = m_stage == OggFlac;
+  }
+
+  virtual unsigned getDuration() const { return 0; }
+
+  virtual QString getFileExtension() const {
+    return QLatin1String(".fbk");
+  }
+
+  virtual bool getFrame(Frame::TagNumber, Frame::Type, Frame&) const {
+    return false;
+  }
+
+  virtual bool setFrame(Frame::TagNumber, const Frame&) { return false; }
+
+  virtual QStringList getFrameIds(Frame::TagNumber) const {
+    return QStringList();
+  }
+
+  /**
+   * Get stage at which the file was created.
+   * @return stage.
+   */
+  Stage stage() const { return m_stage; }
+
+private:
+  Stage m_stage;
+  bool m_fileRead;
+};
+
+/**
+ * Factory for FallbackTaggedFile.
+ */
+class FallbackTaggedFileFactory : public ITaggedFileFactory {
+public:
+  virtual QString name() const { return QLatin1String("FallbackMetadata"); }
+
+  virtual QStringList taggedFileKeys() const {
+    return QStringList() << QLatin1String("FallbackMetadata");
+  }
+
+  virtual int taggedFileFeatures(const QString&) const {
+    return TaggedFile::TF_ID3v24 | TaggedFile::TF_OggFlac;
+  }
+
+  virtual void initialize(const QString&) {}
+
+  virtual TaggedFile* createTaggedFile(
+      const QString&, const QString& fileName,
+      const QPersistentModelIndex& idx, int features) {
+    if (!fileName.endsWith(QLatin1String(".fbk")))
+      return 0;
+
+    return new FallbackTaggedFile(idx,
+        (features & TaggedFile::TF_OggFlac) ? FallbackTaggedFile::OggFlac
+      : (features & TaggedFile::TF_ID3v24) ? FallbackTaggedFile::Id3v24
+      : FallbackTaggedFile::Id3v23);
+  }
+
+  virtual QStringList supportedFileExtensions(const QString&) const {
+    return QStringList() << QLatin1String(".fbk");
+  }
+
+  virtual void notifyConfigurationChange(const QString&) {}
+};
+
+}
+
+
+TestTagReaderPool::TestTagReaderPool(QObject* parent) : QObject(parent),
+  m_factory(new FallbackTaggedFileFactory)
+{
+}
+
+TestTagReaderPool::~TestTagReaderPool()
+{
+  delete m_factory;
+}
+
+void TestTagReaderPool::initTestCase()
+{
+  FileProxyModel::taggedFileFactories().append(m_factory);
+}
+
+void TestTagReaderPool::cleanupTestCase()
+{
+  FileProxyModel::taggedFileFactories().removeAll(m_factory);
+}
+
+void TestTagReaderPool::testFallbacks()
+{
+  const int numFiles = 20;
+  QStringList paths;
+  for (int i = 0; i < numFiles; ++i) {
+    paths.append(QDir::cleanPath(QDir::temp().filePath(
+        QString(QLatin1String("kid3_testpool%1.fbk")).arg(i))));
+  }
+  QStringListModel model(paths);
+  numFallbackFiles.fetchAndStoreOrdered(0);
+  numLastStageReads.fetchAndStoreOrdered(0);
+  {
+    TagReaderPool pool;
+    pool.setMaxThreadCount(4);
+    QVERIFY(pool.isEnabled());
+    for (int i = 0; i < numFiles; ++i) {
+      pool.enqueue(QPersistentModelIndex(model.index(i)), paths.at(i));
+    }
+    // Files which are not yet being read would be cancelled by take().
+    for (int i = 0; i < 100 &&
+         numLastStageReads.fetchAndAddOrdered(0) < numFiles; ++i) {
+      QTest::qWait(50);
+    }
+    QCOMPARE(numLastStageReads.fetchAndAddOrdered(0), numFiles);
+
+    // Every file is handed back for its own index, after going through both
+    // fallbacks, and only the files of the last stage are left.
+    for (int i = 0; i < numFiles; ++i) {
+      TaggedFile* taggedFile = pool.take(QPersistentModelIndex(model.index(i)));
+      QVERIFY(taggedFile);
+      QCOMPARE(taggedFile->getAbsFilename(), paths.at(i));
+      QVERIFY(taggedFile->isTagInformationRead());
+      QCOMPARE(static_cast<FallbackTaggedFile*>(taggedFile)->stage(),
+               FallbackTaggedFile::OggFlac);
+      QCOMPARE(numFallbackFiles.fetchAndAddOrdered(0), numFiles - i);
+      delete taggedFile;
+    }
+    QVERIFY(!pool.take(QPersistentModelIndex(model.index(0))));
+  }
+  QCOMPARE(numFallbackFiles.fetchAndAddOrdered(0), 0);
+}
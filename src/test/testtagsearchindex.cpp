@@ -0,0 +1,138 @@
+/**
+ * \file testtagsearchindex.cpp
+ * Test index used to search in tags.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testtagsearchindex.h"
+#include <QStringList>
+#include "tagsearchindex.h"
+
+void TestTagSearchIndex::testRequiredLiterals_data()
+{
+  QTest::addColumn<QString>("pattern");
+  QTest::addColumn<QStringList>("literals");
+
+  QTest::newRow("plain") << QString(QLatin1String("Beatles"))
+                         << (QStringList() << QLatin1String("Beatles"));
+  QTest::newRow("anchors") << QString(QLatin1String("^The .*Band$"))
+                           << (QStringList() << QLatin1String("The ")
+                                             << QLatin1String("Band"));
+  QTest::newRow("optional") << QString(QLatin1String("colou?r"))
+                            << (QStringList() << QLatin1String("colo"));
+  QTest::newRow("repeated") << QString(QLatin1String("aaab+cde"))
+                            << (QStringList() << QLatin1String("aaab")
+                                              << QLatin1String("cde"));
+  QTest::newRow("escaped") << QString(QLatin1String("\\(live\\)\\d+"))
+                           << (QStringList() << QLatin1String("(live)"));
+  QTest::newRow("class") << QString(QLatin1String("Track [0-9]+ of"))
+                         << (QStringList() << QLatin1String("Track ")
+                                           << QLatin1String(" of"));
+  QTest::newRow("group") << QString(QLatin1String("Mix(ed)? Tape"))
+                         << (QStringList() << QLatin1String("Mix")
+                                           << QLatin1String(" Tape"));
+  QTest::newRow("alternative") << QString(QLatin1String("Rock|Pop"))
+                               << QStringList();
+  QTest::newRow("options") << QString(QLatin1String("(?i)rock"))
+                           << QStringList();
+  QTest::newRow("short") << QString(QLatin1String("ab.cd"))
+                         << QStringList();
+  QTest::newRow("quantifier") << QString(QLatin1String("\\d{3}abc"))
+                              << (QStringList() << QLatin1String("abc"));
+  QTest::newRow("quantified") << QString(QLatin1String("abcd{2,3}efg"))
+                              << (QStringList() << QLatin1String("abc")
+                                                << QLatin1String("efg"));
+  QTest::newRow("hex") << QString(QLatin1String("\\x41ghij"))
+                       << (QStringList() << QLatin1String("ghij"));
+  QTest::newRow("hexbraces") << QString(QLatin1String("\\x{e9}tude"))
+                             << (QStringList() << QLatin1String("tude"));
+  QTest::newRow("unicode") << QString(QLatin1String("\\u00e9tude"))
+                           << (QStringList() << QLatin1String("tude"));
+  QTest::newRow("octal") << QString(QLatin1String("\\0123xyz"))
+                         << (QStringList() << QLatin1String("xyz"));
+  QTest::newRow("backreference")
+      << QString(QLatin1String("(la)\\1 land"))
+      << (QStringList() << QLatin1String(" land"));
+}
+
+void TestTagSearchIndex::testRequiredLiterals()
+{
+  QFETCH(QString, pattern);
+  QFETCH(QStringList, literals);
+  QCOMPARE(TagSearchIndex::requiredLiterals(pattern), literals);
+}
+
+void TestTagSearchIndex::testTextTrigrams()
+{
+  QVERIFY(TagSearchIndex::textTrigrams(QLatin1String("ab")).isEmpty());
+  QCOMPARE(TagSearchIndex::textTrigrams(QLatin1String("abc")).size(), 1);
+  QCOMPARE(TagSearchIndex::textTrigrams(QLatin1String("abcabc")).size(), 3);
+  QCOMPARE(TagSearchIndex::textTrigrams(QLatin1String("Hello")),
+           TagSearchIndex::textTrigrams(QLatin1String("hELLO")));
+  QVERIFY(TagSearchIndex::regExpTrigrams(QLatin1String("a|bcdef")).isEmpty());
+  QCOMPARE(TagSearchIndex::regExpTrigrams(QLatin1String("^hello.*")),
+           TagSearchIndex::textTrigrams(QLatin1String("HELLO")));
+}
+
+void TestTagSearchIndex::testMayContain()
+{
+  // Only the addresses are used as keys.
+  int files[3];
+  const TaggedFile* file1 = reinterpret_cast<const TaggedFile*>(&files[0]);
+  const TaggedFile* file2 = reinterpret_cast<const TaggedFile*>(&files[1]);
+  const TaggedFile* unindexed = reinterpret_cast<const TaggedFile*>(&files[2]);
+
+  TagSearchIndex index;
+  index.insert(file1, QStringList() << QLatin1String("01 Yesterday.mp3")
+               << QLatin1String("Yesterday") << QLatin1String("The Beatles"));
+  index.insert(file2, QStringList() << QLatin1String("02 Help.mp3")
+               << QLatin1String("Help!") << QLatin1String("The Beatles"));
+  QCOMPARE(index.size(), 2);
+  QVERIFY(index.contains(file1));
+  QVERIFY(!index.contains(unindexed));
+
+  QVector<quint32> beatles = TagSearchIndex::textTrigrams(
+        QLatin1String("beatles"));
+  QVERIFY(index.mayContain(file1, beatles));
+  QVERIFY(index.mayContain(file2, beatles));
+  QVector<quint32> yesterday = TagSearchIndex::textTrigrams(
+        QLatin1String("YESTERDAY"));
+  QVERIFY(index.mayContain(file1, yesterday));
+  QVERIFY(!index.mayContain(file2, yesterday));
+  QVERIFY(index.mayContain(unindexed, yesterday));
+  // Matches cannot span multiple values.
+  QVERIFY(!index.mayContain(file2, TagSearchIndex::textTrigrams(
+                              QLatin1String("Help!The"))));
+  QVector<quint32> regExp = TagSearchIndex::regExpTrigrams(
+        QLatin1String("^\\d+ Help\\.mp3$"));
+  QVERIFY(!regExp.isEmpty());
+  QVERIFY(!index.mayContain(file1, regExp));
+  QVERIFY(index.mayContain(file2, regExp));
+  QVERIFY(index.mayContain(file2, QVector<quint32>()));
+
+  index.removeFile(file2);
+  QVERIFY(index.mayContain(file2, yesterday));
+  index.clear();
+  QVERIFY(index.mayContain(file1, beatles));
+  QCOMPARE(index.size(), 0);
+}
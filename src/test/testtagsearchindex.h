@@ -0,0 +1,44 @@
+/**
+ * \file testtagsearchindex.h
+ * Test index used to search in tags.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTTAGSEARCHINDEX_H
+#define TESTTAGSEARCHINDEX_H
+
+#include <QTest>
+
+/**
+ * Test index used to search in tags.
+ */
+class TestTagSearchIndex : public QObject {
+  Q_OBJECT
+private slots:
+  void testRequiredLiterals_data();
+  void testRequiredLiterals();
+  void testTextTrigrams();
+  void testMayContain();
+};
+
+#endif
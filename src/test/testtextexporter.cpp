@@ -0,0 +1,364 @@
+/**
+ * \file testtextexporter.cpp
+ * Test exporting tags as text.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testtextexporter.h"
+#include <QDir>
+#include <QFile>
+#include <QBuffer>
+#include <QFileSystemModel>
+#include <QSignalSpy>
+#include "textexporter.h"
+#include "fileproxymodel.h"
+#include "modeliterator.h"
+#include "tagreaderpool.h"
+#include "taggedfile.h"
+#include "itaggedfilefactory.h"
+#include "exportconfig.h"
+#include "configstore.h"
+#include "dummysettings.h"
+
+namespace {
+
+/** Number of worker threads reading tags ahead. */
+const int NumReaderThreads = 2;
+
+/** Number of files read ahead with NumReaderThreads. */
+const int WindowSize = 4 * NumReaderThreads;
+
+/**
+ * Tagged file with the contents of the file as its title.
+ */
+class TitleTaggedFile : public TaggedFile {
+public:
+  explicit TitleTaggedFile(const QPersistentModelIndex& idx)
+    : TaggedFile(idx), m_fileRead(false) {}
+
+  virtual QString taggedFileKey() const {
+    return QLatin1String("TitleMetadata");
+  }
+
+  virtual void readTags(bool force) {
+    bool priorIsTagInformationRead = isTagInformationRead();
+    if (force || !m_fileRead) {
+      QFile file(currentFilePath());
+      m_title = file.open(QIODevice::ReadOnly)
+          ? QString::fromUtf8(file.readAll()) : QString();
+      m_fileRead = true;
+      markTagUnchanged(Frame::Tag_2);
+    }
+    notifyModelDataChanged(priorIsTagInformationRead);
+  }
+
+  virtual bool writeTags(bool, bool* renamed, bool) {
+    *renamed = false;
+    return true;
+  }
+
+  virtual void clearTags(bool force) {
+    if (!m_fileRead || (isChanged() && !force))
+      return;
+
+    bool priorIsTagInformationRead = isTagInformationRead();
+    m_title.clear();
+    m_fileRead = false;
+    notifyModelDataChanged(priorIsTagInformationRead);
+  }
+
+  virtual bool isTagInformationRead() const { return m_fileRead; }
+
+  virtual void getDetailInfo(DetailInfo&) const {}
+
+  virtual unsigned getDuration() const { return 0; }
+
+  virtual QString getFileExtension() const {
+    return QLatin1String(".ttl");
+  }
+
+  virtual bool getFrame(Frame::TagNumber tagNr, Frame::Type type,
+                        Frame& frame) const {
+    if (tagNr != Frame::Tag_2 || type != Frame::FT_Title)
+      return false;
+
+    frame.setType(type);
+    frame.setValue(m_title);
+    return true;
+  }
+
+  virtual bool setFrame(Frame::TagNumber, const Frame&) { return false; }
+
+  virtual QStringList getFrameIds(Frame::TagNumber) const {
+    return QStringList();
+  }
+
+private:
+  QString m_title;
+  bool m_fileRead;
+};
+
+/**
+ * Factory for TitleTaggedFile.
+ */
+class TitleTaggedFileFactory : public ITaggedFileFactory {
+public:
+  virtual QString name() const { return QLatin1String("TitleMetadata"); }
+
+  virtual QStringList taggedFileKeys() const {
+    return QStringList() << QLatin1String("TitleMetadata");
+  }
+
+  virtual int taggedFileFeatures(const QString&) const { return 0; }
+
+  virtual void initialize(const QString&) {}
+
+  virtual TaggedFile* createTaggedFile(
+      const QString&, const QString& fileName,
+      const QPersistentModelIndex& idx, int) {
+    return fileName.endsWith(QLatin1String(".ttl"))
+        ? new TitleTaggedFile(idx) : 0;
+  }
+
+  virtual QStringList supportedFileExtensions(const QString&) const {
+    return QStringList() << QLatin1String(".ttl");
+  }
+
+  virtual void notifyConfigurationChange(const QString&) {}
+};
+
+/**
+ * Read a file.
+ * @param path path of file
+ * @return contents of file.
+ */
+QByteArray readFile(const QString& path)
+{
+  QFile file(path);
+  return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+/**
+ * Write a file.
+ * @param path path of file
+ * @param data contents of file
+ * @return true if ok.
+ */
+bool writeFile(const QString& path, const QByteArray& data)
+{
+  QFile file(path);
+  return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+/**
+ * Set the export format with index 0 in the configuration.
+ * @param headerFormat header format
+ * @param trackFormat track format
+ * @param trailerFormat trailer format
+ */
+void setExportFormat(const QString& headerFormat, const QString& trackFormat,
+                     const QString& trailerFormat)
+{
+  ExportConfig& exportCfg = ExportConfig::instance();
+  exportCfg.setExportFormatNames(QStringList() << QLatin1String("Test"));
+  exportCfg.setExportFormatHeaders(QStringList() << headerFormat);
+  exportCfg.setExportFormatTracks(QStringList() << trackFormat);
+  exportCfg.setExportFormatTrailers(QStringList() << trailerFormat);
+}
+
+}
+
+
+TestTextExporter::TestTextExporter(QObject* parent) : QObject(parent),
+  m_fsModel(0), m_model(0), m_factory(new TitleTaggedFileFactory),
+  m_settings(0), m_configStore(0)
+{
+  if (!ConfigStore::instance()) {
+    m_settings = new DummySettings;
+    m_configStore = new ConfigStore(m_settings);
+  }
+}
+
+TestTextExporter::~TestTextExporter()
+{
+  delete m_factory;
+  delete m_configStore;
+  delete m_settings;
+}
+
+void TestTextExporter::initTestCase()
+{
+  FileProxyModel::taggedFileFactories().append(m_factory);
+  m_dirPath = QDir::temp().filePath(QLatin1String("kid3_testtextexporter"));
+}
+
+void TestTextExporter::cleanupTestCase()
+{
+  FileProxyModel::taggedFileFactories().removeAll(m_factory);
+}
+
+void TestTextExporter::cleanup()
+{
+  delete m_model;
+  m_model = 0;
+  delete m_fsModel;
+  m_fsModel = 0;
+  QDir dir(m_dirPath);
+  foreach (const QString& fileName, dir.entryList(QDir::Files)) {
+    dir.remove(fileName);
+  }
+  QDir().rmdir(m_dirPath);
+}
+
+/**
+ * Create files in the test directory and open it with background reading
+ * of tags.
+ * @param numFiles number of files to create
+ * @return true if ok.
+ */
+bool TestTextExporter::openDirectory(int numFiles)
+{
+  if (!QDir().mkpath(m_dirPath))
+    return false;
+  for (int i = 1; i <= numFiles; ++i) {
+    if (!writeFile(filePath(QString(QLatin1String("%1.ttl"))
+                            .arg(i, 2, 10, QLatin1Char('0'))),
+                   QString(QLatin1String("Title %1")).arg(i).toUtf8()))
+      return false;
+  }
+
+  m_fsModel = new QFileSystemModel;
+  m_model = new FileProxyModel;
+  m_model->setSourceModel(m_fsModel);
+  m_model->setNameFilters(QStringList() << QLatin1String("*.ttl"));
+  m_model->getTagReaderPool()->setMaxThreadCount(NumReaderThreads);
+  QSignalSpy loadedSpy(m_model, SIGNAL(sortingFinished()));
+  m_fsModel->setRootPath(m_dirPath);
+  for (int i = 0; i < 100 && loadedSpy.isEmpty(); ++i) {
+    QTest::qWait(50);
+  }
+  if (loadedSpy.isEmpty())
+    return false;
+  // The file system model may add the rows in several steps.
+  QModelIndex rootIndex = m_model->index(m_dirPath);
+  for (int i = 0; i < 100 && m_model->rowCount(rootIndex) < numFiles; ++i) {
+    QTest::qWait(50);
+  }
+  return rootIndex.isValid() && m_model->rowCount(rootIndex) == numFiles;
+}
+
+QString TestTextExporter::filePath(const QString& fileName) const
+{
+  return m_dirPath + QLatin1Char('/') + fileName;
+}
+
+void TestTextExporter::testStreamedExport_data()
+{
+  QTest::addColumn<QString>("headerFormat");
+  QTest::addColumn<QString>("trackFormat");
+  QTest::addColumn<QString>("trailerFormat");
+  QTest::addColumn<int>("numFiles");
+
+  const QString header(QLatin1String("Header %{title}"));
+  const QString track(QLatin1String("%{title}\t%{file}"));
+  const QString trailer(QLatin1String("Trailer %{title}"));
+  QTest::newRow("single file") << header << track << trailer << 1;
+  QTest::newRow("window - 1")
+      << header << track << trailer << WindowSize - 1;
+  QTest::newRow("window") << header << track << trailer << WindowSize;
+  QTest::newRow("window + 1")
+      << header << track << trailer << WindowSize + 1;
+  QTest::newRow("two windows + 1")
+      << header << track << trailer << 2 * WindowSize + 1;
+  QTest::newRow("header only")
+      << header << QString() << QString() << WindowSize + 1;
+  QTest::newRow("track only")
+      << QString() << track << QString() << WindowSize + 1;
+  QTest::newRow("trailer only")
+      << QString() << QString() << trailer << WindowSize + 1;
+  QTest::newRow("header and trailer")
+      << header << QString() << trailer << 3;
+}
+
+void TestTextExporter::testStreamedExport()
+{
+  QFETCH(QString, headerFormat);
+  QFETCH(QString, trackFormat);
+  QFETCH(QString, trailerFormat);
+  QFETCH(int, numFiles);
+
+  QVERIFY(openDirectory(numFiles));
+  QCOMPARE(m_model->tagPrefetchWindowSize(), WindowSize);
+  setExportFormat(headerFormat, trackFormat, trailerFormat);
+  const QPersistentModelIndex rootIndex(m_model->index(m_dirPath));
+
+  // Streamed export, the tags are read ahead in the background.
+  QBuffer streamed;
+  QVERIFY(streamed.open(QIODevice::WriteOnly));
+  TextExporter exporter;
+  QVERIFY(exporter.exportDirectory(rootIndex, Frame::TagVAll, &streamed, 0));
+  streamed.close();
+
+  // Tags which were only read for the export are freed again.
+  TaggedFileOfDirectoryIterator unreadIt(rootIndex);
+  while (unreadIt.hasNext()) {
+    QVERIFY(!unreadIt.next()->isTagInformationRead());
+  }
+
+  // Text built in memory from all tracks and written with exportToFile().
+  ImportTrackDataVector trackDataVector;
+  TaggedFileOfDirectoryIterator it(rootIndex);
+  while (it.hasNext()) {
+    TaggedFile* taggedFile = FileProxyModel::readTagsFromTaggedFile(it.next());
+    trackDataVector.push_back(ImportTrackData(*taggedFile, Frame::TagVAll));
+  }
+  QCOMPARE(static_cast<int>(trackDataVector.size()), numFiles);
+  exporter.setTrackData(trackDataVector);
+  exporter.updateText(headerFormat, trackFormat, trailerFormat);
+  const QString exportPath = QDir::temp().filePath(
+        QLatin1String("kid3_testtextexporter.txt"));
+  QVERIFY(exporter.exportToFile(exportPath));
+  const QByteArray inMemory = readFile(exportPath);
+  QFile::remove(exportPath);
+
+  QCOMPARE(streamed.data(), inMemory);
+  if (numFiles > 0 && !headerFormat.isEmpty()) {
+    QVERIFY(streamed.data().startsWith("Header Title 01\n"));
+  }
+}
+
+void TestTextExporter::testInvalidFormatIndex()
+{
+  setExportFormat(QLatin1String("Header"), QLatin1String("%{title}"),
+                  QLatin1String("Trailer"));
+  TextExporter exporter;
+  QBuffer buffer;
+  QVERIFY(buffer.open(QIODevice::WriteOnly));
+  QVERIFY(!exporter.beginExport(0, 0));
+  QVERIFY(exporter.beginExport(&buffer, 1));
+  QVERIFY(exporter.exportTrack(ImportTrackData()));
+  QVERIFY(exporter.endExport());
+  QVERIFY(exporter.beginExport(&buffer, -1));
+  QVERIFY(exporter.endExport());
+  QVERIFY(buffer.data().isEmpty());
+}
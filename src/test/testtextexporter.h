@@ -0,0 +1,67 @@
+/**
+ * \file testtextexporter.h
+ * Test exporting tags as text.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTTEXTEXPORTER_H
+#define TESTTEXTEXPORTER_H
+
+#include <QTest>
+
+class QFileSystemModel;
+class FileProxyModel;
+class ITaggedFileFactory;
+class ISettings;
+class ConfigStore;
+
+/**
+ * Test exporting tags as text.
+ */
+class TestTextExporter : public QObject {
+  Q_OBJECT
+public:
+  explicit TestTextExporter(QObject* parent = 0);
+  virtual ~TestTextExporter();
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void cleanup();
+  void testStreamedExport_data();
+  void testStreamedExport();
+  void testInvalidFormatIndex();
+
+private:
+  bool openDirectory(int numFiles);
+  QString filePath(const QString& fileName) const;
+
+  QString m_dirPath;
+  QFileSystemModel* m_fsModel;
+  FileProxyModel* m_model;
+  ITaggedFileFactory* m_factory;
+  ISettings* m_settings;
+  ConfigStore* m_configStore;
+};
+
+#endif
@@ -0,0 +1,206 @@
+/**
+ * \file testtrackdatamatcher.cpp
+ * Test matching of imported track data with files.
+ *
+ * \b Project: Kid3
+ * \author Urs Fleisch
+ * \date 18 Oct 2026
+ *
+ * Copyright (C) 2026  Urs Fleisch
+ *
+ * This file is part of Kid3.
+ *
+ * Kid3 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Kid3 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testtrackdatamatcher.h"
+#include <QStringList>
+#include "trackdatamatcher.h"
+
+using namespace TrackDataMatcher;
+
+namespace {
+
+/** Number of tracks used for benchmarks. */
+const int NumTracks = 1000;
+
+/**
+ * Create a set of words.
+ * @param str words separated by spaces
+ * @return set of words.
+ */
+QSet<QString> words(const char* str)
+{
+  return QString(QLatin1String(str)).split(QLatin1Char(' ')).toSet();
+}
+
+/**
+ * Create track properties.
+ * @param fileWords words in file name separated by spaces
+ * @param titleWords words in title separated by spaces
+ * @param fileDuration duration of file
+ * @param importDuration imported duration
+ * @return track properties.
+ */
+TrackProperties track(const char* fileWords, const char* titleWords,
+                      int fileDuration = 0, int importDuration = 0)
+{
+  TrackProperties props;
+  props.fileWords = words(fileWords);
+  props.titleWords = words(titleWords);
+  props.fileDuration = fileDuration;
+  props.importDuration = importDuration;
+  return props;
+}
+
+/**
+ * Create a synthetic import where the imported data is shuffled.
+ * Every track has a title with three words from a small vocabulary and
+ * a word which is unique to the track, the file names additionally
+ * contain the artist and some miss a word of the title.
+ *
+ * @param tracks the properties of the tracks are returned here
+ * @return index of the track whose imported data belongs to each track.
+ */
+QVector<int> createShuffledImport(QVector<TrackProperties>& tracks)
+{
+  quint32 seed = 12345;
+  QVector<QSet<QString> > titles(NumTracks);
+  QVector<int> durations(NumTracks);
+  QVector<int> expected(NumTracks);
+  for (int i = 0; i < NumTracks; ++i) {
+    for (int w = 0; w < 3; ++w) {
+      seed = seed * 1103515245 + 12345;
+      titles[i].insert(
+            QString(QLatin1String("word%1")).arg((seed >> 16) % 300));
+    }
+    titles[i].insert(QString(QLatin1String("unique%1")).arg(i));
+    seed = seed * 1103515245 + 12345;
+    durations[i] = 120 + (seed >> 16) % 360;
+    expected[i] = i;
+  }
+  for (int i = NumTracks - 1; i > 0; --i) {
+    seed = seed * 1103515245 + 12345;
+    qSwap(expected[i], expected[(seed >> 16) % (i + 1)]);
+  }
+
+  tracks.resize(NumTracks);
+  for (int i = 0; i < NumTracks; ++i) {
+    TrackProperties& props = tracks[i];
+    props.fileWords = titles.at(i);
+    if (i % 5 == 0) {
+      foreach (const QString& word, titles.at(i)) {
+        if (word.startsWith(QLatin1String("word"))) {
+          props.fileWords.remove(word);
+          break;
+        }
+      }
+    }
+    props.fileWords << QLatin1String("various") << QLatin1String("artists");
+    props.fileDuration = durations.at(i);
+  }
+  // The imported data of track i is found at position expected[i].
+  for (int i = 0; i < NumTracks; ++i) {
+    tracks[expected.at(i)].titleWords = titles.at(i);
+    tracks[expected.at(i)].importDuration = durations.at(i);
+  }
+  return expected;
+}
+
+}
+
+void TestTrackDataMatcher::testTitleOptimal()
+{
+  // A greedy assignment would give the import with most common words to
+  // the first file and leave nothing in common for the second file.
+  QVector<TrackProperties> tracks;
+  tracks << track("x y", "x y z")
+         << track("y z", "x");
+  QCOMPARE(findAssignment(tracks, MatchTitle), QVector<int>() << 1 << 0);
+}
+
+void TestTrackDataMatcher::testTitleDurationTieBreak()
+{
+  QVector<TrackProperties> tracks;
+  tracks << track("intro", "intro", 60, 200)
+         << track("intro", "intro", 200, 60);
+  QCOMPARE(findAssignment(tracks, MatchTitle), QVector<int>() << 1 << 0);
+}
+
+void TestTrackDataMatcher::testLength()
+{
+  QVector<TrackProperties> tracks;
+  tracks << track("a", "a", 100, 300)
+         << track("b", "b", 200, 100)
+         << track("c", "c", 300, 201);
+  QCOMPARE(findAssignment(tracks, MatchLength),
+           QVector<int>() << 1 << 2 << 0);
+
+  // Equal durations are assigned using the words.
+  tracks.clear();
+  tracks << track("one", "two", 180, 180)
+         << track("two", "one", 180, 180);
+  QCOMPARE(findAssignment(tracks, MatchLength), QVector<int>() << 1 << 0);
+}
+
+void TestTrackDataMatcher::testLengthMaxDiff()
+{
+  QVector<TrackProperties> tracks;
+  tracks << track("a", "a", 100, 102)
+         << track("b", "b", 102, 100)
+         << track("c", "c", 300, 400)
+         << track("d", "d", 400, 300);
+  QCOMPARE(findAssignment(tracks, MatchLength, 3),
+           QVector<int>() << 0 << 1 << 3 << 2);
+  QCOMPARE(findAssignment(tracks, MatchLength),
+           QVector<int>() << 1 << 0 << 3 << 2);
+}
+
+void TestTrackDataMatcher::testKeepOrderOnTies()
+{
+  QVector<TrackProperties> tracks;
+  for (int i = 0; i < 5; ++i) {
+    tracks << TrackProperties();
+  }
+  QCOMPARE(findAssignment(tracks, MatchTitle),
+           QVector<int>() << 0 << 1 << 2 << 3 << 4);
+  QCOMPARE(findAssignment(tracks, MatchLength),
+           QVector<int>() << 0 << 1 << 2 << 3 << 4);
+  QVERIFY(findAssignment(QVector<TrackProperties>(), MatchTitle).isEmpty());
+}
+
+void TestTrackDataMatcher::benchmarkTitle()
+{
+  QVector<TrackProperties> tracks;
+  const QVector<int> expected = createShuffledImport(tracks);
+  for (int i = 0; i < NumTracks; ++i) {
+    tracks[i].importDuration = 0;
+  }
+  QVector<int> assignedFrom;
+  QBENCHMARK {
+    assignedFrom = findAssignment(tracks, MatchTitle);
+  }
+  QCOMPARE(assignedFrom, expected);
+}
+
+void TestTrackDataMatcher::benchmarkLength()
+{
+  QVector<TrackProperties> tracks;
+  const QVector<int> expected = createShuffledImport(tracks);
+  QVector<int> assignedFrom;
+  QBENCHMARK {
+    assignedFrom = findAssignment(tracks, MatchLength);
+  }
+  QCOMPARE(assignedFrom, expected);
+}